@@ -151,6 +151,9 @@ typedef struct FFX_CACAO_Constants {
 	float                   DeinterleavedDepthBufferNormalisedOffset[2];
 
 	FFX_CACAO_Matrix4x4       NormalsWorldToViewspaceMatrix;
+
+	float                   DeinterleavedDepthBufferMaxUV[2];
+	float                   Dummy1[2];
 } FFX_CACAO_Constants;
 
 /**
@@ -223,6 +226,36 @@ extern "C"
 	*/
 	void FFX_CACAO_UpdateConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Settings* settings, const FFX_CACAO_BufferSizeInfo* bufferSizeInfo, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView);
 
+	/**
+		Update the constants of an FFX_CACAO_Constants struct which depend only on the settings. Together with
+		FFX_CACAO_UpdateSizeConstants and FFX_CACAO_UpdateProjectionConstants this writes the same values as
+		FFX_CACAO_UpdateConstants, letting applications recompute only the part invalidated since the last frame.
+
+		\param consts FFX_CACAO_Constants constant buffer.
+		\param settings FFX_CACAO_Settings settings.
+	*/
+	void FFX_CACAO_UpdateSettingsConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Settings* settings);
+
+	/**
+		Update the constants of an FFX_CACAO_Constants struct which depend only on the buffer sizes.
+
+		\param consts FFX_CACAO_Constants constant buffer.
+		\param bufferSizeInfo FFX_CACAO_BufferSizeInfo buffer size info.
+	*/
+	void FFX_CACAO_UpdateSizeConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_BufferSizeInfo* bufferSizeInfo);
+
+	/**
+		Update the constants of an FFX_CACAO_Constants struct which depend on the projection and normals matrices. These
+		also depend on the settings and buffer sizes, so must be updated whenever either changes.
+
+		\param consts FFX_CACAO_Constants constant buffer.
+		\param settings FFX_CACAO_Settings settings.
+		\param bufferSizeInfo FFX_CACAO_BufferSizeInfo buffer size info.
+		\param proj Projection matrix for the frame.
+		\param normalsToView Normals world space to view space matrix for the frame.
+	*/
+	void FFX_CACAO_UpdateProjectionConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Settings* settings, const FFX_CACAO_BufferSizeInfo* bufferSizeInfo, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView);
+
 	/**
 		Update the contents of the FFX CACAO constant buffer (an FFX_CACAO_Constants struct) with per pass constants.
 		FFX CACAO runs 4 passes which use different constants. It is recommended to have four separate FFX_CACAO_Constants structs
@@ -246,6 +279,26 @@ extern "C"
 	*/
 	void FFX_CACAO_UpdatePerPassConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Settings* settings, const FFX_CACAO_BufferSizeInfo* bufferSizeInfo, int pass);
 
+	/**
+		Update the constants of an FFX_CACAO_Constants struct, computed by FFX_CACAO_UpdateConstants for the buffer sizes of
+		the screen size dependent resources, to draw only a render area in their top left corner, such as the part of the
+		resources rendered to under dynamic resolution. The textures are still addressed with coordinates normalised to the
+		size of the resources, so only the constants relating them to the screen follow the render area. This must be called
+		again whenever FFX_CACAO_UpdateConstants or FFX_CACAO_UpdateProjectionConstants is.
+
+		\code{.cpp}
+		FFX_CACAO_BufferSizeInfo renderAreaSizeInfo = {};
+		FFX_CACAO_UpdateBufferSizeInfo(renderWidth, renderHeight, useDownsampledSsao, &renderAreaSizeInfo);
+		FFX_CACAO_UpdateConstants(&constants, &settings, &bufferSizeInfo, &proj, &normalsToView);
+		FFX_CACAO_UpdateRenderAreaConstants(&constants, &bufferSizeInfo, &renderAreaSizeInfo);
+		\endcode
+
+		\param consts FFX_CACAO_Constants constant buffer.
+		\param bufferSizeInfo FFX_CACAO_BufferSizeInfo buffer size info of the resources.
+		\param renderAreaSizeInfo FFX_CACAO_BufferSizeInfo buffer size info of the render area, no larger than the resources.
+	*/
+	void FFX_CACAO_UpdateRenderAreaConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_BufferSizeInfo* bufferSizeInfo, const FFX_CACAO_BufferSizeInfo* renderAreaSizeInfo);
+
 #ifdef __cplusplus
 }
 #endif
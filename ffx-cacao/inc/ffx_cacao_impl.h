@@ -27,6 +27,7 @@
 // #define FFX_CACAO_ENABLE_PROFILING
 // #define FFX_CACAO_ENABLE_D3D12
 // #define FFX_CACAO_ENABLE_VULKAN
+// #define FFX_CACAO_ENABLE_CPU
 
 #ifdef FFX_CACAO_ENABLE_D3D12
 #include <d3d12.h>
@@ -34,6 +35,9 @@
 #ifdef FFX_CACAO_ENABLE_VULKAN
 #include <vulkan/vulkan.h>
 #endif
+#if defined(FFX_CACAO_ENABLE_CPU) || defined(FFX_CACAO_ENABLE_PROFILING)
+#include <stddef.h>
+#endif
 
 /**
 	The return codes for the API functions.
@@ -76,6 +80,12 @@ typedef struct FFX_CACAO_D3D12ScreenSizeInfo {
 */
 typedef struct FFX_CACAO_VkContext FFX_CACAO_VkContext;
 
+/**
+	The objects used by FidelityFX-CACAO which depend only on the VkDevice: samplers, descriptor set layouts, pipeline layouts, shader modules and pipelines.
+	They may be shared by any number of contexts on the same VkDevice, each of which holds a reference.
+*/
+typedef struct FFX_CACAO_VkDeviceObjects FFX_CACAO_VkDeviceObjects;
+
 /**
 	Miscellaneous flags for used for Vulkan context creation by FidelityFX-CACAO
  */
@@ -83,9 +93,41 @@ typedef enum FFX_CACAO_VkCreateFlagsBits {
 	FFX_CACAO_VK_CREATE_USE_16_BIT        = 0x00000001, ///< Flag controlling whether 16-bit optimisations are enabled in shaders.
 	FFX_CACAO_VK_CREATE_USE_DEBUG_MARKERS = 0x00000002, ///< Flag controlling whether debug markers should be used.
 	FFX_CACAO_VK_CREATE_NAME_OBJECTS      = 0x00000004, ///< Flag controlling whether Vulkan objects should be named.
+	FFX_CACAO_VK_CREATE_LAZY_PIPELINES    = 0x00000008, ///< Flag controlling whether pipelines are created when first drawn with or pre-warmed by FFX_CACAO_VkPrewarmPipelines, instead of all up front.
 } FFX_CACAO_VkCreateFlagsBits;
 typedef uint32_t FFX_CACAO_VkCreateFlags;
 
+/**
+	The maximum number of frames the constant buffer ring of a Vulkan context can hold.
+*/
+#define FFX_CACAO_VK_MAX_FRAMES_IN_FLIGHT 8
+
+/**
+	The maximum number of views drawn together by FFX_CACAO_VkDrawViews.
+*/
+#define FFX_CACAO_VK_MAX_VIEWS 4
+
+/**
+	Allocates device memory with the given requirements and memory properties, returning the VkDeviceMemory and the offset within it.
+	The offset must be a multiple of requirements->alignment. Returns VK_SUCCESS, or the error of the failed allocation.
+*/
+typedef VkResult (*FFX_CACAO_VkAllocateMemoryFunc)(void* userData, const VkMemoryRequirements* requirements, VkMemoryPropertyFlags properties, VkDeviceMemory* memory, VkDeviceSize* offset);
+
+/**
+	Frees an allocation made by the corresponding FFX_CACAO_VkAllocateMemoryFunc.
+*/
+typedef void (*FFX_CACAO_VkFreeMemoryFunc)(void* userData, VkDeviceMemory memory, VkDeviceSize offset);
+
+/**
+	An external allocator, such as the memory allocator of an engine, for FidelityFX-CACAO to place its screen size dependent textures in.
+	All of the textures share one allocation, made by FFX_CACAO_VkInitScreenSizeDependentResources and freed by FFX_CACAO_VkDestroyScreenSizeDependentResources.
+*/
+typedef struct FFX_CACAO_VkMemoryAllocator {
+	FFX_CACAO_VkAllocateMemoryFunc    allocateMemory;       ///< Function allocating device memory
+	FFX_CACAO_VkFreeMemoryFunc        freeMemory;           ///< Function freeing device memory allocated by allocateMemory
+	void*                             userData;             ///< User data passed to allocateMemory and freeMemory
+} FFX_CACAO_VkMemoryAllocator;
+
 /**
 	The parameters for creating a context.
 */
@@ -93,6 +135,10 @@ typedef struct FFX_CACAO_VkCreateInfo {
 	VkPhysicalDevice                 physicalDevice; ///< The VkPhysicalDevice corresponding to the VkDevice in use
 	VkDevice                         device;         ///< The VkDevice to use FFX CACAO with
 	FFX_CACAO_VkCreateFlags            flags;          ///< Miscellaneous flags for context creation
+	uint32_t                         numFramesInFlight; ///< The number of frames the constant buffer ring holds before reusing the constants of a frame, at least the number of frames in flight and at most FFX_CACAO_VK_MAX_FRAMES_IN_FLIGHT. 0 selects the default of 3
+	const FFX_CACAO_VkMemoryAllocator* memoryAllocator; ///< An optional external allocator (may be NULL) for the memory of the screen size dependent textures, which are otherwise placed in a single allocation made by FFX CACAO. The struct is copied.
+	VkPipelineCache                  pipelineCache;  ///< An optional pipeline cache (may be VK_NULL_HANDLE) used when creating the pipelines, see FFX_CACAO_VkCreatePipelineCache. Unused if deviceObjects is set. With FFX_CACAO_VK_CREATE_LAZY_PIPELINES it must outlive the device objects.
+	FFX_CACAO_VkDeviceObjects*       deviceObjects;  ///< Optional device objects (may be NULL) to share with other contexts, created for device with FFX_CACAO_VkCreateDeviceObjects. The flags they were created with take precedence. If NULL, the context creates its own.
 } FFX_CACAO_VkCreateInfo;
 
 /**
@@ -105,8 +151,143 @@ typedef struct FFX_CACAO_VkScreenSizeInfo {
 	VkImageView                       normalsView;          ///< An optional image view for the normal buffer (may be VK_NULL_HANDLE). Should be in layout VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL when used with FFX CACAO
 	VkImage                           output;               ///< An image for writing output from FFX CACAO, must have the same dimensions as the input
 	VkImageView                       outputView;           ///< An image view corresponding to the output image.
+	uint32_t                          outputArrayLayer;     ///< The array layer of the output image viewed by outputView, the only layer transitioned by a draw, so that the views drawn by FFX_CACAO_VkDrawViews may write the layers of one array image. Zero for an image with a single layer.
 	FFX_CACAO_Bool                      useDownsampledSsao;   ///< Whether SSAO should be generated at native resolution or half resolution. It is recommended to enable this setting for improved performance.
+	FFX_CACAO_Bool                      disableHighestQuality; ///< Whether the context is only drawn below FFX_CACAO_QUALITY_HIGHEST, whose adaptive base pass keeps textures alive that could otherwise share memory. FFX_CACAO_VkDraw fails with FFX_CACAO_STATUS_INVALID_ARGUMENT at FFX_CACAO_QUALITY_HIGHEST if set.
 } FFX_CACAO_VkScreenSizeInfo;
+
+/**
+	The device memory used by the screen size dependent textures of a Vulkan context.
+	Textures which are never live in the same phase of a draw, for any of the settings the context may be drawn with, share memory.
+*/
+typedef struct FFX_CACAO_VkMemoryUsage {
+	VkDeviceSize                      arenaSize;            ///< size in bytes of the allocation holding the textures, their largest peak footprint since it was allocated
+	VkDeviceSize                      usedSize;             ///< size in bytes of the part of the allocation used by the textures at their current size
+	VkDeviceSize                      unaliasedSize;        ///< size in bytes the textures would occupy if none of them shared memory
+} FFX_CACAO_VkMemoryUsage;
+
+/**
+	A view drawn by FFX_CACAO_VkDrawViews.
+*/
+typedef struct FFX_CACAO_VkDrawViewInfo {
+	FFX_CACAO_VkContext              *context;              ///< The context the view is drawn with, whose screen size dependent resources hold the depth, normals and output of the view
+	const FFX_CACAO_Matrix4x4        *proj;                 ///< The projection matrix of the view
+	const FFX_CACAO_Matrix4x4        *normalsToView;        ///< An optional matrix for transforming the normals of the view to viewspace (may be NULL)
+	uint32_t                          renderWidth;          ///< The width of the render area of the view, as in FFX_CACAO_VkDrawRenderArea, or zero for the width of the screen of the context
+	uint32_t                          renderHeight;         ///< The height of the render area of the view, or zero for the height of the screen of the context
+} FFX_CACAO_VkDrawViewInfo;
+
+/**
+	The phases of a draw, recorded by FFX_CACAO_VkDrawPhase in this order, each into any command buffer, possibly on
+	different queues. All the work of a phase is done by compute shaders, so a semaphore between two phases only needs to be
+	waited on at VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT. The resources of the caller are in these states:
+
+	- before FFX_CACAO_VK_PHASE_PREPARE, the depth and normal buffers are in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, and
+	  are read by the phase. The normal buffer is not read by the later phases, and the depth buffer is only read again by
+	  FFX_CACAO_VK_PHASE_RESOLVE with useDownsampledSsao.
+	- FFX_CACAO_VK_PHASE_RESOLVE transitions the output from VK_IMAGE_LAYOUT_UNDEFINED, discarding its contents, and leaves
+	  it in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, as FFX_CACAO_VkDraw does.
+
+	The textures of the context written by a phase and read by the next are left by the phase in the layouts of the barriers
+	returned by FFX_CACAO_VkGetPhaseTransferBarriers, with their writes made available to the compute shader stage of the
+	same queue. Textures first used by the next phase are transitioned from VK_IMAGE_LAYOUT_UNDEFINED, so need no transfer.
+*/
+typedef enum FFX_CACAO_VkPhase {
+	FFX_CACAO_VK_PHASE_PREPARE,   ///< Downsampling and deinterleaving of the depths and normals, and the depth mips.
+	FFX_CACAO_VK_PHASE_GENERATE,  ///< The base pass and importance map at FFX_CACAO_QUALITY_HIGHEST, and the generation of SSAO.
+	FFX_CACAO_VK_PHASE_RESOLVE,   ///< The blur of the SSAO, and its reinterleaving or bilateral upsampling to the output.
+	FFX_CACAO_VK_NUM_PHASES
+} FFX_CACAO_VkPhase;
+
+/**
+	The maximum number of barriers returned by FFX_CACAO_VkGetPhaseTransferBarriers.
+*/
+#define FFX_CACAO_VK_MAX_PHASE_TRANSFER_BARRIERS 8
+#endif
+
+#ifdef FFX_CACAO_ENABLE_CPU
+/**
+	A struct containing all of the data used by FidelityFX-CACAO.
+	A context corresponds to a pool of worker threads executing the effect on the CPU.
+*/
+typedef struct FFX_CACAO_CpuContext FFX_CACAO_CpuContext;
+
+/**
+	Miscellaneous flags used for CPU context creation by FidelityFX-CACAO
+ */
+typedef enum FFX_CACAO_CpuCreateFlagsBits {
+	FFX_CACAO_CPU_CREATE_DISABLE_SIMD     = 0x00000001, ///< Flag forcing the scalar SSAO tap loop, blur and bilateral upscale, rather than the AVX2, AVX-512 or NEON kernels selected for the host.
+	FFX_CACAO_CPU_CREATE_DISABLE_AVX512   = 0x00000002, ///< Flag preventing selection of the AVX-512 SSAO tap and bilateral upscale kernels, for hosts which lower their clocks when executing them.
+	FFX_CACAO_CPU_CREATE_REFERENCE        = 0x00000004, ///< Flag selecting the scalar reference transcription of every shader, run one thread group at a time on the thread calling FFX_CACAO_CpuDraw with the dispatch sizes of the GPU. The other flags, numThreads and jobSystem are ignored.
+} FFX_CACAO_CpuCreateFlagsBits;
+typedef uint32_t FFX_CACAO_CpuCreateFlags;
+
+/**
+	A task of a parallel for loop submitted to a job system, taskIndex is in [0, numTasks).
+*/
+typedef void (*FFX_CACAO_CpuTaskFunc)(void* taskData, uint32_t taskIndex);
+
+/**
+	Executes task(taskData, i) for every i in [0, numTasks) and returns once all of them have completed.
+	The tasks may run in any order, on any threads including the calling thread, and concurrently or one after another.
+*/
+typedef void (*FFX_CACAO_CpuParallelForFunc)(void* userData, FFX_CACAO_CpuTaskFunc task, void* taskData, uint32_t numTasks);
+
+/**
+	An external job system, such as the task graph of an engine, for FidelityFX-CACAO to execute its thread groups on.
+*/
+typedef struct FFX_CACAO_CpuJobSystem {
+	FFX_CACAO_CpuParallelForFunc      parallelFor;          ///< Function executing the tasks of a dispatch, called from the thread calling FFX_CACAO_CpuDraw
+	void*                             userData;             ///< User data passed to parallelFor
+	uint32_t                          numTasks;             ///< The maximum number of tasks per parallel for loop, usually the number of threads of the job system. Each task owns its own scratch memory.
+} FFX_CACAO_CpuJobSystem;
+
+/**
+	The parameters for creating a CPU context.
+*/
+typedef struct FFX_CACAO_CpuCreateInfo {
+	uint32_t                          numThreads;           ///< The number of threads to execute the effect on, including the thread calling FFX_CACAO_CpuDraw. Zero selects the number of hardware threads. Ignored if jobSystem is provided.
+	FFX_CACAO_CpuCreateFlags          flags;                ///< Miscellaneous flags for context creation
+	const FFX_CACAO_CpuJobSystem*     jobSystem;            ///< An optional external job system (may be NULL), in which case FFX CACAO creates no threads of its own. The struct is copied.
+} FFX_CACAO_CpuCreateInfo;
+
+/**
+	The parameters necessary when changing the screen size of FidelityFX CACAO.
+	All buffers are in host memory and must remain valid until the screen size dependent resources are destroyed.
+*/
+typedef struct FFX_CACAO_CpuScreenSizeInfo {
+	uint32_t                          width;                ///< width of the input/output buffers
+	uint32_t                          height;               ///< height of the input/output buffers
+	const float                      *depth;                ///< pointer to the depth buffer, one float per pixel
+	uint32_t                          depthRowPitch;        ///< size in bytes of a row of the depth buffer (0 for tightly packed rows)
+	const float                      *normals;              ///< optional pointer to the normal buffer (may be NULL), four floats per pixel of which xyz are used
+	uint32_t                          normalsRowPitch;      ///< size in bytes of a row of the normal buffer (0 for tightly packed rows)
+	float                            *output;               ///< pointer to the output buffer FFX CACAO writes to, one float per pixel
+	uint32_t                          outputRowPitch;       ///< size in bytes of a row of the output buffer (0 for tightly packed rows)
+	FFX_CACAO_Bool                      useDownsampledSsao;   ///< Whether SSAO should be generated at native resolution or half resolution. It is recommended to enable this setting for improved performance.
+} FFX_CACAO_CpuScreenSizeInfo;
+
+/**
+	The difference between the textures written by a stage of the effect on two CPU contexts.
+	The difference of a texel is the largest absolute difference of any of its channels, as stored in the texture.
+*/
+typedef struct FFX_CACAO_CpuStageDifference {
+	const char                       *label;                ///< name of the stage, as in FFX_CACAO_DetailedTiming
+	float                             maxError;             ///< largest difference of any texel, infinite if a texel is NaN in only one of the contexts
+	float                             meanError;            ///< mean difference over all texels written by the stage
+	uint32_t                          numTexels;            ///< number of texels compared
+	uint32_t                          numDifferentTexels;   ///< number of texels with a nonzero difference
+} FFX_CACAO_CpuStageDifference;
+
+/**
+	The per stage differences of a context from a reference, as computed by FFX_CACAO_CpuDrawDifferential.
+*/
+typedef struct FFX_CACAO_CpuDifferentialReport {
+	uint32_t                          numStages;                  ///< number of stages in the array stages
+	FFX_CACAO_CpuStageDifference      stages[8];                  ///< the differences of each stage run for the current settings, in order
+	float                             averageImportance;          ///< the average importance the adaptive quality level of the context used, zero at other quality levels
+	float                             referenceAverageImportance; ///< the average importance the adaptive quality level of the reference used, zero at other quality levels
+} FFX_CACAO_CpuDifferentialReport;
 #endif
 
 #ifdef FFX_CACAO_ENABLE_PROFILING
@@ -126,6 +307,59 @@ typedef struct FFX_CACAO_DetailedTiming {
 	uint32_t          numTimestamps;  ///< number of timetstamps in the array timestamps
 	FFX_CACAO_Timestamp timestamps[32]; ///< array of timestamps for each FFX CACAO stage
 } FFX_CACAO_DetailedTiming;
+
+/**
+	The largest number of presets an FFX_CACAO_QualityController steps through.
+*/
+#define FFX_CACAO_QUALITY_CONTROLLER_MAX_PRESETS 32
+
+/**
+	A struct containing the state of an automatic quality controller, which chooses the settings of FFX CACAO
+	from a ladder of presets to keep the time it takes within a budget.
+*/
+typedef struct FFX_CACAO_QualityController FFX_CACAO_QualityController;
+
+/**
+	A rung of the ladder of presets of an FFX_CACAO_QualityController.
+*/
+typedef struct FFX_CACAO_QualityPreset {
+	FFX_CACAO_Settings                settings;             ///< the settings to run FFX CACAO with
+	FFX_CACAO_Bool                    useDownsampledSsao;   ///< whether SSAO is generated at half resolution, which selects the screen size dependent resources to draw with
+} FFX_CACAO_QualityPreset;
+
+/**
+	A change of preset made by an FFX_CACAO_QualityController.
+*/
+typedef struct FFX_CACAO_QualityDecision {
+	uint32_t                          frame;                 ///< the number of timings given to the controller when it made the decision
+	uint32_t                          previousPreset;        ///< index of the preset in use until now
+	uint32_t                          preset;                ///< index of the preset to use from now on
+	float                             smoothedMilliseconds;  ///< the smoothed total time of the previous preset
+	float                             predictedMilliseconds; ///< the expected total time of the new preset, from the cost ratios of the presets measured at earlier changes
+} FFX_CACAO_QualityDecision;
+
+/**
+	A function called by an FFX_CACAO_QualityController whenever it changes preset.
+*/
+typedef void (*FFX_CACAO_QualityCallback)(void* userData, const FFX_CACAO_QualityDecision* decision, const FFX_CACAO_QualityPreset* preset);
+
+/**
+	The parameters for initialising an FFX_CACAO_QualityController.
+*/
+typedef struct FFX_CACAO_QualityControllerCreateInfo {
+	const FFX_CACAO_QualityPreset    *presets;              ///< the ladder of presets, ordered from the most to the least expensive. The presets are copied.
+	uint32_t                          numPresets;           ///< number of presets in the array presets, at most FFX_CACAO_QUALITY_CONTROLLER_MAX_PRESETS
+	uint32_t                          initialPreset;        ///< index of the preset in use when the controller is initialised
+	float                             budgetMilliseconds;   ///< the time FFX CACAO should take per frame
+	float                             millisecondsPerTick;  ///< the length of a tick of the timings, for example VkPhysicalDeviceLimits::timestampPeriod * 1e-6f for a Vulkan context, or 1e-6f for a CPU context
+	float                             smoothing;            ///< weight of each new timing in the exponential moving average of the timings, in (0, 1]. Zero selects 0.1.
+	float                             downgradeThreshold;   ///< fraction of the budget above which the smoothed time moves to the next cheaper preset. Zero selects 1.0.
+	float                             upgradeThreshold;     ///< fraction of the budget the predicted time of the next more expensive preset must stay below to move to it. Zero selects 0.85.
+	uint32_t                          holdFrames;           ///< number of timings of a preset measured before the controller may change preset again. Zero selects 30.
+	uint32_t                          latencyFrames;        ///< number of timings discarded after a change of preset, because they still measure frames drawn with the previous preset, for example the frames in flight of a Vulkan context less one
+	FFX_CACAO_QualityCallback         callback;             ///< an optional function called on every change of preset (may be NULL)
+	void                             *userData;             ///< passed to the callback
+} FFX_CACAO_QualityControllerCreateInfo;
 #endif
 
 #ifdef __cplusplus
@@ -239,6 +473,79 @@ extern "C"
 	*/
 	size_t FFX_CACAO_VkGetContextSize();
 
+	/**
+		Creates the device objects of FidelityFX-CACAO, to be shared by several contexts on the same device.
+		For example, with one context per viewport:
+
+		\code{.cpp}
+		FFX_CACAO_VkDeviceObjects *deviceObjects;
+		FFX_CACAO_VkCreateDeviceObjects(&info, &deviceObjects);
+		info.deviceObjects = deviceObjects;
+		for (uint32_t i = 0; i < numViewports; ++i)
+		{
+			FFX_CACAO_VkInitContext(contexts[i], &info);
+		}
+		FFX_CACAO_VkReleaseDeviceObjects(deviceObjects); // the contexts keep the objects alive
+		\endcode
+
+		\param info A pointer to an FFX_CACAO_VkCreateInfo struct, of which the device, physical device and flags are used.
+		\param objects A pointer to write the new device objects to, holding one reference for the caller.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_VkCreateDeviceObjects(const FFX_CACAO_VkCreateInfo* info, FFX_CACAO_VkDeviceObjects** objects);
+
+	/**
+		Releases the reference to the device objects returned by FFX_CACAO_VkCreateDeviceObjects.
+		The objects are destroyed once they are also no longer used by any context.
+
+		\param objects A pointer to the device objects.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_VkReleaseDeviceObjects(FFX_CACAO_VkDeviceObjects* objects);
+
+	/**
+		Creates a VkPipelineCache, initialised from the data of a previous run if it was produced by the same device and driver.
+		Data from another device or driver version, or which is truncated or corrupted, is ignored and the cache starts out empty.
+		For example, to skip the compilation of the shaders of FidelityFX-CACAO on the second launch:
+
+		\code{.cpp}
+		VkPipelineCache pipelineCache;
+		FFX_CACAO_VkCreatePipelineCache(physicalDevice, device, fileData, fileSize, &pipelineCache, NULL);
+		info.pipelineCache = pipelineCache;
+		FFX_CACAO_VkInitContext(context, &info);
+
+		// ...
+
+		size_t size;
+		FFX_CACAO_VkGetPipelineCacheData(physicalDevice, device, pipelineCache, NULL, &size);
+		std::vector<uint8_t> data(size);
+		FFX_CACAO_VkGetPipelineCacheData(physicalDevice, device, pipelineCache, data.data(), &size);
+		// write size bytes of data to the file
+		vkDestroyPipelineCache(device, pipelineCache, NULL);
+		\endcode
+
+		\param physicalDevice The VkPhysicalDevice corresponding to device.
+		\param device The VkDevice to create the cache on.
+		\param data Data previously returned by FFX_CACAO_VkGetPipelineCacheData, or NULL.
+		\param dataSize The size in bytes of data.
+		\param pipelineCache A pointer to write the new VkPipelineCache to. It is owned by the caller.
+		\param dataUsed An optional pointer (may be NULL) set to whether the cache was initialised from data.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_VkCreatePipelineCache(VkPhysicalDevice physicalDevice, VkDevice device, const void* data, size_t dataSize, VkPipelineCache* pipelineCache, FFX_CACAO_Bool* dataUsed);
+
+	/**
+		Gets the contents of a VkPipelineCache, prefixed with the pipeline cache UUID, vendor, device and driver version of the physical device, to be saved and passed to FFX_CACAO_VkCreatePipelineCache on a later run.
+
+		\param physicalDevice The VkPhysicalDevice corresponding to device.
+		\param device The VkDevice the cache was created on.
+		\param pipelineCache The VkPipelineCache to read.
+		\param data A pointer to write the data to, or NULL to query its size.
+		\param dataSize A pointer to the size in bytes of data, set to the size of the data written or required.
+		\return The corresponding error code, FFX_CACAO_STATUS_INVALID_ARGUMENT if data is too small.
+	*/
+	FFX_CACAO_Status FFX_CACAO_VkGetPipelineCacheData(VkPhysicalDevice physicalDevice, VkDevice device, VkPipelineCache pipelineCache, void* data, size_t* dataSize);
+
 	/**
 		Initialises an FFX_CACAO_VkContext.
 
@@ -267,6 +574,30 @@ extern "C"
 	*/
 	FFX_CACAO_Status FFX_CACAO_VkInitScreenSizeDependentResources(FFX_CACAO_VkContext* context, const FFX_CACAO_VkScreenSizeInfo* info);
 
+	/**
+		Changes the screen size, inputs and output of an FFX_CACAO_VkContext with initialised screen size dependent resources.
+
+		The textures are kept at the largest size they have had. A new size which fits in them, with the same useDownsampledSsao
+		and disableHighestQuality, creates and allocates nothing: only the descriptors of the inputs and output are rewritten,
+		and the draws cover the new size as a render area in the top left corner of the textures, as FFX_CACAO_VkDrawRenderArea
+		does. Otherwise the textures are recreated, at no less than their previous size, in the same memory if it is large
+		enough, and the descriptor sets are rewritten in place rather than reallocated. The textures only shrink when the
+		screen size dependent resources are destroyed and initialised again. As with
+		FFX_CACAO_VkDestroyScreenSizeDependentResources, the context must not be in use by the GPU.
+
+		\code{.cpp}
+		// dynamic resolution, with the resources initialised at the largest resolution
+		screenSizeInfo.width = renderWidth;
+		screenSizeInfo.height = renderHeight;
+		FFX_CACAO_VkResize(context, &screenSizeInfo);
+		\endcode
+
+		\param context A pointer to the FFX_CACAO_VkContext.
+		\param info A pointer to an FFX_CACAO_VkScreenSizeInfo struct containing the new screen size info.
+		\return FFX_CACAO_STATUS_INVALID_ARGUMENT if the screen size dependent resources are not initialised, otherwise the corresponding error code. On failure the screen size dependent resources are destroyed.
+	*/
+	FFX_CACAO_Status FFX_CACAO_VkResize(FFX_CACAO_VkContext* context, const FFX_CACAO_VkScreenSizeInfo* info);
+
 	/**
 		Destroys screen size dependent resources for the FFX_CACAO_VkContext.
 
@@ -295,6 +626,138 @@ extern "C"
 	*/
 	FFX_CACAO_Status FFX_CACAO_VkDraw(FFX_CACAO_VkContext* context, VkCommandBuffer commandList, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView);
 
+	/**
+		Append commands for drawing FFX CACAO over a render area in the top left corner of the screen, as last given to
+		FFX_CACAO_VkInitScreenSizeDependentResources or FFX_CACAO_VkResize, to the provided VkCommandBuffer, such as the part
+		of the depth buffer rendered to under dynamic resolution. The work
+		of the draw scales with the render area, and nothing is reallocated when it changes from frame to frame. The output
+		is written over the render area, though texels just beyond it may be written too. The depth and normals beyond the
+		render area, up to a small band around it, are read for the neighbourhoods of the pixels at its edges.
+
+		\code{.cpp}
+		// dynamic resolution, with the resources initialised at the largest resolution
+		FFX_CACAO_VkDrawRenderArea(context, commandBuffer, &proj, &normalsToView, renderWidth, renderHeight);
+		\endcode
+
+		\param context A pointer to the FFX_CACAO_VkContext.
+		\param commandList The VkCommandBuffer to append commands to.
+		\param proj A pointer to the projection matrix of the render area.
+		\param normalsToView An optional pointer to a matrix for transforming normals to in the normal buffer to viewspace.
+		\param renderWidth The width of the render area, at most the width of the screen.
+		\param renderHeight The height of the render area, at most the height of the screen.
+		\return FFX_CACAO_STATUS_INVALID_ARGUMENT if the render area is empty or larger than the screen, or if a draw recorded in phases is incomplete, otherwise the corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_VkDrawRenderArea(FFX_CACAO_VkContext* context, VkCommandBuffer commandList, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView, uint32_t renderWidth, uint32_t renderHeight);
+
+	/**
+		Append commands for drawing FFX CACAO for several views, such as the eyes of a stereo camera, to the provided
+		VkCommandBuffer. Each view is drawn with its own context, whose screen size dependent resources hold the depth, normals
+		and output of the view, and all the contexts must have the same settings and useDownsampledSsao. Every pass is recorded
+		for all the views between the same pipeline barriers, so the passes of one view overlap with those of the others and
+		the draw has as many barriers as the draw of a single view. Only the barriers are shared: each view records its own
+		dispatches over its own textures, with its own descriptor sets and constants, so the recording cost of the dispatches
+		and constant updates is that of drawing the views one after the other. The contexts may share their device objects,
+		and their outputs may be the layers of one array image, see FFX_CACAO_VkScreenSizeInfo::outputArrayLayer.
+
+		\code{.cpp}
+		// stereo, with a context per eye
+		FFX_CACAO_VkDrawViewInfo views[2] = {};
+		for (uint32_t eye = 0; eye < 2; ++eye)
+		{
+			views[eye].context = eyeContexts[eye];
+			views[eye].proj = &eyeProj[eye];
+			views[eye].normalsToView = &eyeNormalsToView[eye];
+		}
+		FFX_CACAO_VkDrawViews(commandBuffer, views, 2);
+		\endcode
+
+		The timestamps of the draw are those of the context of the first view, FFX_CACAO_VkGetDetailedTimings returns no
+		timings for the other contexts.
+
+		\param commandList The VkCommandBuffer to append commands to.
+		\param views An array of the views to draw.
+		\param numViews The number of views, at most FFX_CACAO_VK_MAX_VIEWS.
+		\return FFX_CACAO_STATUS_INVALID_ARGUMENT if there are no views or too many, if the contexts differ in their settings or a context is given twice, if a render area is invalid, or if a draw of a context recorded in phases is incomplete, otherwise the corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_VkDrawViews(VkCommandBuffer commandList, const FFX_CACAO_VkDrawViewInfo* views, uint32_t numViews);
+
+	/**
+		Append commands for one phase of drawing FFX CACAO to the provided VkCommandBuffer, so that the phases of a draw may be
+		recorded into different command buffers and submitted to different queues, such as running the generation of SSAO on a
+		compute queue while the graphics queue renders shadow maps. FFX_CACAO_VK_PHASE_PREPARE starts the draw of a frame, and
+		is followed by the other phases in order, which together record the same work as FFX_CACAO_VkDrawRenderArea. The caller
+		orders the phases with semaphores if they are submitted to different queues, and transfers the ownership of the
+		textures of the context with the barriers of FFX_CACAO_VkGetPhaseTransferBarriers if the queues are of different
+		families, see FFX_CACAO_VkPhase for the states of the resources at each phase boundary. The settings and screen size of
+		the context must not change between the phases of a draw. Once FFX_CACAO_VK_PHASE_PREPARE is recorded the draw must be
+		completed by its later phases before the context is drawn again, a draw which is not submitted is only abandoned by
+		changing the settings or the screen size of the context.
+
+		\code{.cpp}
+		// prepare on the graphics queue, then generate and resolve on the compute queue
+		FFX_CACAO_VkDrawPhase(context, graphicsCommandBuffer, FFX_CACAO_VK_PHASE_PREPARE, &proj, &normalsToView, 0, 0);
+		VkImageMemoryBarrier barriers[FFX_CACAO_VK_MAX_PHASE_TRANSFER_BARRIERS];
+		uint32_t numBarriers = FFX_CACAO_VK_MAX_PHASE_TRANSFER_BARRIERS;
+		FFX_CACAO_VkGetPhaseTransferBarriers(context, FFX_CACAO_VK_PHASE_PREPARE, graphicsQueueFamily, computeQueueFamily, barriers, &numBarriers);
+		vkCmdPipelineBarrier(graphicsCommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, numBarriers, barriers);
+		// submit graphicsCommandBuffer, signalling a semaphore waited on by the compute queue at VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+
+		vkCmdPipelineBarrier(computeCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, numBarriers, barriers);
+		FFX_CACAO_VkDrawPhase(context, computeCommandBuffer, FFX_CACAO_VK_PHASE_GENERATE, NULL, NULL, 0, 0);
+		FFX_CACAO_VkDrawPhase(context, computeCommandBuffer, FFX_CACAO_VK_PHASE_RESOLVE, NULL, NULL, 0, 0);
+		\endcode
+
+		With profiling, the timestamps of the phases are written to the query pool of the context from each queue, and
+		FFX_CACAO_VkGetDetailedTimings returns those of all the phases of a frame.
+
+		\param context A pointer to the FFX_CACAO_VkContext.
+		\param commandList The VkCommandBuffer to append commands to.
+		\param phase The phase to record.
+		\param proj A pointer to the projection matrix of the render area, only used by FFX_CACAO_VK_PHASE_PREPARE (may be NULL otherwise).
+		\param normalsToView An optional pointer to a matrix for transforming normals to in the normal buffer to viewspace, only used by FFX_CACAO_VK_PHASE_PREPARE.
+		\param renderWidth The width of the render area, as in FFX_CACAO_VkDrawRenderArea, or zero for the width of the screen. Only used by FFX_CACAO_VK_PHASE_PREPARE, the later phases of a draw use its render area.
+		\param renderHeight The height of the render area, or zero for the height of the screen. Only used by FFX_CACAO_VK_PHASE_PREPARE.
+		\return FFX_CACAO_STATUS_INVALID_ARGUMENT if the phase does not follow the previous phase recorded for the context, FFX_CACAO_VK_PHASE_PREPARE following the last phase of a draw, or if the settings or screen size changed since it, or if the render area is invalid, otherwise the corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_VkDrawPhase(FFX_CACAO_VkContext* context, VkCommandBuffer commandList, FFX_CACAO_VkPhase phase, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView, uint32_t renderWidth, uint32_t renderHeight);
+
+	/**
+		Gets the barriers transferring the ownership of the textures of the context which are written by a phase, or an earlier
+		one, and read by the next phase, between queue families. The same barriers are recorded as the release on the queue of
+		the phase and as the acquire on the queue of the next phase, they keep the layouts the textures are left in by the
+		phase. The barriers depend on the settings of the context, and their images on its screen size dependent resources.
+
+		\param context A pointer to the FFX_CACAO_VkContext.
+		\param phase The phase after which the ownership is transferred, FFX_CACAO_VK_PHASE_PREPARE or FFX_CACAO_VK_PHASE_GENERATE.
+		\param srcQueueFamilyIndex The queue family of the phase.
+		\param dstQueueFamilyIndex The queue family of the next phase.
+		\param barriers A pointer to write the barriers to, or NULL to query their number.
+		\param numBarriers A pointer to the number of barriers barriers holds, at most FFX_CACAO_VK_MAX_PHASE_TRANSFER_BARRIERS are needed, set to the number of barriers written or required.
+		\return FFX_CACAO_STATUS_INVALID_ARGUMENT if the phase is the last, or if barriers is too small, otherwise the corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_VkGetPhaseTransferBarriers(FFX_CACAO_VkContext* context, FFX_CACAO_VkPhase phase, uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex, VkImageMemoryBarrier* barriers, uint32_t* numBarriers);
+
+	/**
+		Creates the pipelines for drawing the FFX_CACAO_VkContext at a quality level, with its other current settings and SSAO resolution.
+		This is only needed for contexts created with FFX_CACAO_VK_CREATE_LAZY_PIPELINES, whose pipelines are otherwise created when first drawn with.
+		The pipelines are created on worker threads, and FFX_CACAO_VkDraw only waits for those it needs which a worker has started on.
+
+		\param context A pointer to the FFX_CACAO_VkContext.
+		\param qualityLevel The quality level to create the pipelines for.
+		\param wait Whether to return only once the pipelines are created, rather than leaving them to the worker threads.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_VkPrewarmPipelines(FFX_CACAO_VkContext* context, FFX_CACAO_Quality qualityLevel, FFX_CACAO_Bool wait);
+
+	/**
+		Get the device memory used by the screen size dependent resources of the FFX_CACAO_VkContext.
+
+		\param context A pointer to the FFX_CACAO_VkContext.
+		\param usage A pointer to an FFX_CACAO_VkMemoryUsage struct to fill in.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_VkGetMemoryUsage(FFX_CACAO_VkContext* context, FFX_CACAO_VkMemoryUsage* usage);
+
 #ifdef FFX_CACAO_ENABLE_PROFILING
 	/**
 		Get detailed performance timings from the previous frame.
@@ -307,6 +770,173 @@ extern "C"
 #endif
 #endif
 
+#ifdef FFX_CACAO_ENABLE_CPU
+	/**
+		Gets the size in bytes required by a CPU context. This is to be used to allocate space for the context.
+		For example:
+
+		\code{.cpp}
+		size_t FFX_CACAO_CpuContextSize = FFX_CACAO_CpuGetContextSize();
+		FFX_CACAO_CpuContext *context = (FFX_CACAO_CpuContext*)malloc(FFX_CACAO_CpuContextSize);
+
+		// ...
+
+		FFX_CACAO_CpuDestroyContext(context);
+		free(context);
+		\endcode
+
+		\return The size in bytes of an FFX_CACAO_CpuContext.
+	*/
+	size_t FFX_CACAO_CpuGetContextSize();
+
+	/**
+		Initialises an FFX_CACAO_CpuContext and starts its worker threads.
+
+		\param context A pointer to the context to initialise.
+		\param info A pointer to an FFX_CACAO_CpuCreateInfo struct with parameters such as the number of threads and the SIMD kernels which may be used.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_CpuInitContext(FFX_CACAO_CpuContext* context, const FFX_CACAO_CpuCreateInfo* info);
+
+	/**
+		Destroys an FFX_CACAO_CpuContext and joins its worker threads.
+
+		\param context A pointer to the context to be destroyed.
+		\return The corresponding error code.
+
+		\note This function does not destroy screen size dependent resources, and must be called after FFX_CACAO_CpuDestroyScreenSizeDependentResources.
+	*/
+	FFX_CACAO_Status FFX_CACAO_CpuDestroyContext(FFX_CACAO_CpuContext* context);
+
+	/**
+		Initialises screen size dependent resources for the FFX_CACAO_CpuContext.
+
+		\param context A pointer to the FFX_CACAO_CpuContext.
+		\param info A pointer to an FFX_CACAO_CpuScreenSizeInfo struct containing screen size info.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_CpuInitScreenSizeDependentResources(FFX_CACAO_CpuContext* context, const FFX_CACAO_CpuScreenSizeInfo* info);
+
+	/**
+		Destroys screen size dependent resources for the FFX_CACAO_CpuContext.
+
+		\param context A pointer to the FFX_CACAO_CpuContext.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_CpuDestroyScreenSizeDependentResources(FFX_CACAO_CpuContext* context);
+
+	/**
+		Rebinds the depth, normal and output buffers of the FFX_CACAO_CpuContext without reallocating its screen size dependent resources,
+		for example to run FFX CACAO directly on each frame of a memory mapped sequence.
+
+		\param context A pointer to the FFX_CACAO_CpuContext.
+		\param info A pointer to an FFX_CACAO_CpuScreenSizeInfo struct with the new buffers. The width, height and useDownsampledSsao must be those the screen size dependent resources were initialised with.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_CpuUpdateBuffers(FFX_CACAO_CpuContext* context, const FFX_CACAO_CpuScreenSizeInfo* info);
+
+	/**
+		Update the settings of the FFX_CACAO_CpuContext to those stored in the FFX_CACAO_Settings struct.
+
+		\param context A pointer to the FFX_CACAO_CpuContext to update.
+		\param settings A pointer to the FFX_CACAO_Settings struct containing the new settings.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_CpuUpdateSettings(FFX_CACAO_CpuContext* context, const FFX_CACAO_Settings* settings);
+
+	/**
+		Run FFX CACAO on the CPU, reading the depth (and normal) buffers and writing the output buffer.
+		The function returns once the output buffer has been written.
+
+		\param context A pointer to the FFX_CACAO_CpuContext.
+		\param proj A pointer to the projection matrix.
+		\param normalsToView An optional pointer to a matrix for transforming normals to in the normal buffer to viewspace.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_CpuDraw(FFX_CACAO_CpuContext* context, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView);
+
+	/**
+		Run FFX CACAO on the CPU like FFX_CACAO_CpuDraw, and run every stage of it on a reference context as well, usually
+		created with FFX_CACAO_CPU_CREATE_REFERENCE, to measure the differences of the context from the reference.
+		Before each stage the reference is given the textures the context left, so the differences of a stage are its own
+		rather than accumulated over the previous stages. The reference takes the settings of the context.
+
+		\param context A pointer to the FFX_CACAO_CpuContext to test, which writes its output buffer as FFX_CACAO_CpuDraw would.
+		\param reference A pointer to the reference FFX_CACAO_CpuContext. Its screen size dependent resources must have been initialised with the same size and useDownsampledSsao as those of the context, and with the same depth (and normal) buffers.
+		\param proj A pointer to the projection matrix.
+		\param normalsToView An optional pointer to a matrix for transforming normals to in the normal buffer to viewspace.
+		\param report A pointer to an FFX_CACAO_CpuDifferentialReport struct to fill in with the differences of every stage.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_CpuDrawDifferential(FFX_CACAO_CpuContext* context, FFX_CACAO_CpuContext* reference, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView, FFX_CACAO_CpuDifferentialReport* report);
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	/**
+		Get detailed performance timings from the previous call to FFX_CACAO_CpuDraw. Ticks are measured in nanoseconds.
+
+		\param context A pointer to the FFX_CACAO_CpuContext.
+		\param timings A pointer to an FFX_CACAO_DetailedTiming struct to fill in with detailed timings.
+		\result The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_CpuGetDetailedTimings(FFX_CACAO_CpuContext* context, FFX_CACAO_DetailedTiming* timings);
+#endif
+#endif
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	/**
+		Gets the size in bytes required by a quality controller. The controller holds no resources, so it is freed without
+		being destroyed.
+
+		\return The size in bytes of an FFX_CACAO_QualityController.
+	*/
+	size_t FFX_CACAO_QualityControllerGetSize();
+
+	/**
+		Initialises an FFX_CACAO_QualityController. The controller works with any backend, it is fed the detailed timings
+		of every frame and returns the preset to draw the next frame with. The smoothed total time is compared with the
+		budget: above the downgrade threshold the controller moves one preset cheaper, and it moves one preset more
+		expensive only when the cost of that preset, predicted from the cost ratio measured the last time the two presets
+		were switched between, fits below the upgrade threshold. After each change the controller waits for holdFrames
+		timings of the new preset, so it does not oscillate between two presets either side of the budget.
+
+		\param controller A pointer to the controller to initialise.
+		\param info A pointer to an FFX_CACAO_QualityControllerCreateInfo struct with the presets and the budget.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_QualityControllerInit(FFX_CACAO_QualityController* controller, const FFX_CACAO_QualityControllerCreateInfo* info);
+
+	/**
+		Feeds the detailed timings of a frame to an FFX_CACAO_QualityController, for example those of
+		FFX_CACAO_VkGetDetailedTimings, and gets the preset to draw the next frame with. Timings with no timestamps are
+		ignored. The callback of the controller is called before the function returns if the preset changes.
+
+		\param controller A pointer to the FFX_CACAO_QualityController.
+		\param timings A pointer to the timings of the latest frame.
+		\param preset A pointer to the index of the preset to use, which is written whether or not it changed (may be NULL).
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_QualityControllerUpdate(FFX_CACAO_QualityController* controller, const FFX_CACAO_DetailedTiming* timings, uint32_t* preset);
+
+	/**
+		Changes the budget of an FFX_CACAO_QualityController, keeping the timings it has measured.
+
+		\param controller A pointer to the FFX_CACAO_QualityController.
+		\param budgetMilliseconds The new budget.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_QualityControllerSetBudget(FFX_CACAO_QualityController* controller, float budgetMilliseconds);
+
+	/**
+		Gets the exponential moving averages of the timings of every stage of the current preset, for display. The averages
+		are restarted on every change of preset.
+
+		\param controller A pointer to the FFX_CACAO_QualityController.
+		\param timings A pointer to an FFX_CACAO_DetailedTiming struct to fill in with the smoothed timings, in ticks.
+		\return The corresponding error code.
+	*/
+	FFX_CACAO_Status FFX_CACAO_QualityControllerGetSmoothedTimings(FFX_CACAO_QualityController* controller, FFX_CACAO_DetailedTiming* timings);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
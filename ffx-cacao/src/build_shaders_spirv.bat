@@ -1,103 +1,133 @@
 %echo off
 
+setlocal enabledelayedexpansion
+
 pushd %~dp0
 
+rem the path of the ffx_cacao_pack_shaders executable, built from ffx_cacao_pack_shaders.cpp by the FFX_CACAO_PackShaders
+rem target of the samples, or by hand as described at the top of ffx_cacao_pack_shaders.cpp
+set cacao_pack_shaders=%~1
+if "%cacao_pack_shaders%"=="" (
+	echo usage: build_shaders_spirv.bat ^<path to ffx_cacao_pack_shaders^>
+	popd
+	exit /b 1
+)
+
 set cauldron_dxc_16=..\..\sample\libs\cauldron\libs\DXC\bin\dxc.exe -Wno-conversion -spirv -T cs_6_2 -enable-16bit-types -fspv-target-env=vulkan1.1 -fvk-s-shift 0 0 -fvk-b-shift 10 0 -fvk-t-shift 20 0 -fvk-u-shift 30 0
 set cauldron_dxc_32=..\..\sample\libs\cauldron\libs\DXC\bin\dxc.exe -Wno-conversion -spirv -T cs_6_2 -fspv-target-env=vulkan1.1 -fvk-s-shift 0 0 -fvk-b-shift 10 0 -fvk-t-shift 20 0 -fvk-u-shift 30 0
 
 if not exist "PrecompiledShadersSPIRV" mkdir "PrecompiledShadersSPIRV"
+del /q PrecompiledShadersSPIRV\*.spv 2>nul
+
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOClearLoadCounter_16.spv -E FFX_CACAO_ClearLoadCounter ffx_cacao.hlsl
+
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepths_16.spv                  -E FFX_CACAO_PrepareDownsampledDepths                  ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOClearLoadCounter_16.h -Vn CSClearLoadCounterSPIRV16 -E FFX_CACAO_ClearLoadCounter ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPrepareNativeDepths_16.spv                       -E FFX_CACAO_PrepareNativeDepths                       ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepths_16.h                  -Vn CSPrepareDownsampledDepthsSPIRV16                  -E FFX_CACAO_PrepareDownsampledDepths                  ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsAndMips_16.spv           -E FFX_CACAO_PrepareDownsampledDepthsAndMips           ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsAndMips_16.spv                -E FFX_CACAO_PrepareNativeDepthsAndMips                ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPrepareNativeDepths_16.h                       -Vn CSPrepareNativeDepthsSPIRV16                       -E FFX_CACAO_PrepareNativeDepths                       ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormals_16.spv                 -E FFX_CACAO_PrepareDownsampledNormals                 ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPrepareNativeNormals_16.spv                      -E FFX_CACAO_PrepareNativeNormals                      ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsAndMips_16.h           -Vn CSPrepareDownsampledDepthsAndMipsSPIRV16            -E FFX_CACAO_PrepareDownsampledDepthsAndMips           ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsAndMips_16.h                -Vn CSPrepareNativeDepthsAndMipsSPIRV16                 -E FFX_CACAO_PrepareNativeDepthsAndMips                ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormalsFromInputNormals_16.spv -E FFX_CACAO_PrepareDownsampledNormalsFromInputNormals ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPrepareNativeNormalsFromInputNormals_16.spv      -E FFX_CACAO_PrepareNativeNormalsFromInputNormals      ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormals_16.h                 -Vn CSPrepareDownsampledNormalsSPIRV16                  -E FFX_CACAO_PrepareDownsampledNormals                 ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPrepareNativeNormals_16.h                      -Vn CSPrepareNativeNormalsSPIRV16                       -E FFX_CACAO_PrepareNativeNormals                      ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsHalf_16.spv              -E FFX_CACAO_PrepareDownsampledDepthsHalf              ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsHalf_16.spv                   -E FFX_CACAO_PrepareNativeDepthsHalf                   ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormalsFromInputNormals_16.h -Vn CSPrepareDownsampledNormalsFromInputNormalsSPIRV16  -E FFX_CACAO_PrepareDownsampledNormalsFromInputNormals ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPrepareNativeNormalsFromInputNormals_16.h      -Vn CSPrepareNativeNormalsFromInputNormalsSPIRV16       -E FFX_CACAO_PrepareNativeNormalsFromInputNormals      ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsHalf_16.h              -Vn CSPrepareDownsampledDepthsHalfSPIRV16               -E FFX_CACAO_PrepareDownsampledDepthsHalf              ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsHalf_16.h                   -Vn CSPrepareNativeDepthsHalfSPIRV16                    -E FFX_CACAO_PrepareNativeDepthsHalf                   ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOGenerateSparse_16.spv -E FFX_CACAO_GenerateSparse ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOGenerate_16.spv       -E FFX_CACAO_Generate       ffx_cacao.hlsl
 
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOGenerateImportanceMap_16.spv     -E FFX_CACAO_GenerateImportanceMap     ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapA_16.spv -E FFX_CACAO_PostprocessImportanceMapA ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapB_16.spv -E FFX_CACAO_PostprocessImportanceMapB ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOGenerateQ0_16.h     -Vn CSGenerateQ0SPIRV16      -E FFX_CACAO_GenerateQ0     ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOGenerateQ1_16.h     -Vn CSGenerateQ1SPIRV16      -E FFX_CACAO_GenerateQ1     ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOGenerateQ2_16.h     -Vn CSGenerateQ2SPIRV16      -E FFX_CACAO_GenerateQ2     ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOGenerateQ3_16.h     -Vn CSGenerateQ3SPIRV16      -E FFX_CACAO_GenerateQ3     ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOGenerateQ3Base_16.h -Vn CSGenerateQ3BaseSPIRV16  -E FFX_CACAO_GenerateQ3Base ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur_16.spv -E FFX_CACAO_EdgeSensitiveBlur ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOGenerateImportanceMap_16.h     -Vn CSGenerateImportanceMapSPIRV16      -E FFX_CACAO_GenerateImportanceMap     ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapA_16.h -Vn CSPostprocessImportanceMapASPIRV16  -E FFX_CACAO_PostprocessImportanceMapA ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapB_16.h -Vn CSPostprocessImportanceMapBSPIRV16  -E FFX_CACAO_PostprocessImportanceMapB ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOApply_16.spv             -E FFX_CACAO_Apply             ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAONonSmartApply_16.spv     -E FFX_CACAO_NonSmartApply     ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAONonSmartHalfApply_16.spv -E FFX_CACAO_NonSmartHalfApply ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur1_16.h -Vn CSEdgeSensitiveBlur1SPIRV16  -E FFX_CACAO_EdgeSensitiveBlur1 ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur2_16.h -Vn CSEdgeSensitiveBlur2SPIRV16  -E FFX_CACAO_EdgeSensitiveBlur2 ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur3_16.h -Vn CSEdgeSensitiveBlur3SPIRV16  -E FFX_CACAO_EdgeSensitiveBlur3 ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur4_16.h -Vn CSEdgeSensitiveBlur4SPIRV16  -E FFX_CACAO_EdgeSensitiveBlur4 ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur5_16.h -Vn CSEdgeSensitiveBlur5SPIRV16  -E FFX_CACAO_EdgeSensitiveBlur5 ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur6_16.h -Vn CSEdgeSensitiveBlur6SPIRV16  -E FFX_CACAO_EdgeSensitiveBlur6 ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur7_16.h -Vn CSEdgeSensitiveBlur7SPIRV16  -E FFX_CACAO_EdgeSensitiveBlur7 ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur8_16.h -Vn CSEdgeSensitiveBlur8SPIRV16  -E FFX_CACAO_EdgeSensitiveBlur8 ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Smart_16.spv    -E FFX_CACAO_UpscaleBilateral5x5Smart    ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5NonSmart_16.spv -E FFX_CACAO_UpscaleBilateral5x5NonSmart ffx_cacao.hlsl
+%cauldron_dxc_16% -Fo PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Half_16.spv     -E FFX_CACAO_UpscaleBilateral5x5Half     ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOApply_16.h             -Vn CSApplySPIRV16              -E FFX_CACAO_Apply             ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAONonSmartApply_16.h     -Vn CSNonSmartApplySPIRV16      -E FFX_CACAO_NonSmartApply     ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAONonSmartHalfApply_16.h -Vn CSNonSmartHalfApplySPIRV16  -E FFX_CACAO_NonSmartHalfApply ffx_cacao.hlsl
 
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Smart_16.h    -Vn CSUpscaleBilateral5x5SmartSPIRV16    -E FFX_CACAO_UpscaleBilateral5x5Smart    ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5NonSmart_16.h -Vn CSUpscaleBilateral5x5NonSmartSPIRV16 -E FFX_CACAO_UpscaleBilateral5x5NonSmart ffx_cacao.hlsl
-%cauldron_dxc_16% -Fh PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Half_16.h     -Vn CSUpscaleBilateral5x5HalfSPIRV16     -E FFX_CACAO_UpscaleBilateral5x5Half     ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOClearLoadCounter_32.spv -E FFX_CACAO_ClearLoadCounter ffx_cacao.hlsl
 
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepths_32.spv                  -E FFX_CACAO_PrepareDownsampledDepths                  ffx_cacao.hlsl
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOClearLoadCounter_32.h -Vn CSClearLoadCounterSPIRV32 -E FFX_CACAO_ClearLoadCounter ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPrepareNativeDepths_32.spv                       -E FFX_CACAO_PrepareNativeDepths                       ffx_cacao.hlsl
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepths_32.h                  -Vn CSPrepareDownsampledDepthsSPIRV32                  -E FFX_CACAO_PrepareDownsampledDepths                  ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsAndMips_32.spv           -E FFX_CACAO_PrepareDownsampledDepthsAndMips           ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsAndMips_32.spv                -E FFX_CACAO_PrepareNativeDepthsAndMips                ffx_cacao.hlsl
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPrepareNativeDepths_32.h                       -Vn CSPrepareNativeDepthsSPIRV32                       -E FFX_CACAO_PrepareNativeDepths                       ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormals_32.spv                 -E FFX_CACAO_PrepareDownsampledNormals                 ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPrepareNativeNormals_32.spv                      -E FFX_CACAO_PrepareNativeNormals                      ffx_cacao.hlsl
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsAndMips_32.h           -Vn CSPrepareDownsampledDepthsAndMipsSPIRV32            -E FFX_CACAO_PrepareDownsampledDepthsAndMips           ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsAndMips_32.h                -Vn CSPrepareNativeDepthsAndMipsSPIRV32                 -E FFX_CACAO_PrepareNativeDepthsAndMips                ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormalsFromInputNormals_32.spv -E FFX_CACAO_PrepareDownsampledNormalsFromInputNormals ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPrepareNativeNormalsFromInputNormals_32.spv      -E FFX_CACAO_PrepareNativeNormalsFromInputNormals      ffx_cacao.hlsl
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormals_32.h                 -Vn CSPrepareDownsampledNormalsSPIRV32                  -E FFX_CACAO_PrepareDownsampledNormals                 ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPrepareNativeNormals_32.h                      -Vn CSPrepareNativeNormalsSPIRV32                       -E FFX_CACAO_PrepareNativeNormals                      ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsHalf_32.spv              -E FFX_CACAO_PrepareDownsampledDepthsHalf              ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsHalf_32.spv                   -E FFX_CACAO_PrepareNativeDepthsHalf                   ffx_cacao.hlsl
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormalsFromInputNormals_32.h -Vn CSPrepareDownsampledNormalsFromInputNormalsSPIRV32  -E FFX_CACAO_PrepareDownsampledNormalsFromInputNormals ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPrepareNativeNormalsFromInputNormals_32.h      -Vn CSPrepareNativeNormalsFromInputNormalsSPIRV32       -E FFX_CACAO_PrepareNativeNormalsFromInputNormals      ffx_cacao.hlsl
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsHalf_32.h              -Vn CSPrepareDownsampledDepthsHalfSPIRV32               -E FFX_CACAO_PrepareDownsampledDepthsHalf              ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsHalf_32.h                   -Vn CSPrepareNativeDepthsHalfSPIRV32                    -E FFX_CACAO_PrepareNativeDepthsHalf                   ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOGenerateSparse_32.spv -E FFX_CACAO_GenerateSparse ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOGenerate_32.spv       -E FFX_CACAO_Generate       ffx_cacao.hlsl
 
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOGenerateImportanceMap_32.spv     -E FFX_CACAO_GenerateImportanceMap     ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapA_32.spv -E FFX_CACAO_PostprocessImportanceMapA ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapB_32.spv -E FFX_CACAO_PostprocessImportanceMapB ffx_cacao.hlsl
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOGenerateQ0_32.h     -Vn CSGenerateQ0SPIRV32      -E FFX_CACAO_GenerateQ0     ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOGenerateQ1_32.h     -Vn CSGenerateQ1SPIRV32      -E FFX_CACAO_GenerateQ1     ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOGenerateQ2_32.h     -Vn CSGenerateQ2SPIRV32      -E FFX_CACAO_GenerateQ2     ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOGenerateQ3_32.h     -Vn CSGenerateQ3SPIRV32      -E FFX_CACAO_GenerateQ3     ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOGenerateQ3Base_32.h -Vn CSGenerateQ3BaseSPIRV32  -E FFX_CACAO_GenerateQ3Base ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur_32.spv -E FFX_CACAO_EdgeSensitiveBlur ffx_cacao.hlsl
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOGenerateImportanceMap_32.h     -Vn CSGenerateImportanceMapSPIRV32      -E FFX_CACAO_GenerateImportanceMap     ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapA_32.h -Vn CSPostprocessImportanceMapASPIRV32  -E FFX_CACAO_PostprocessImportanceMapA ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapB_32.h -Vn CSPostprocessImportanceMapBSPIRV32  -E FFX_CACAO_PostprocessImportanceMapB ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOApply_32.spv             -E FFX_CACAO_Apply             ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAONonSmartApply_32.spv     -E FFX_CACAO_NonSmartApply     ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAONonSmartHalfApply_32.spv -E FFX_CACAO_NonSmartHalfApply ffx_cacao.hlsl
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur1_32.h -Vn CSEdgeSensitiveBlur1SPIRV32  -E FFX_CACAO_EdgeSensitiveBlur1 ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur2_32.h -Vn CSEdgeSensitiveBlur2SPIRV32  -E FFX_CACAO_EdgeSensitiveBlur2 ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur3_32.h -Vn CSEdgeSensitiveBlur3SPIRV32  -E FFX_CACAO_EdgeSensitiveBlur3 ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur4_32.h -Vn CSEdgeSensitiveBlur4SPIRV32  -E FFX_CACAO_EdgeSensitiveBlur4 ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur5_32.h -Vn CSEdgeSensitiveBlur5SPIRV32  -E FFX_CACAO_EdgeSensitiveBlur5 ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur6_32.h -Vn CSEdgeSensitiveBlur6SPIRV32  -E FFX_CACAO_EdgeSensitiveBlur6 ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur7_32.h -Vn CSEdgeSensitiveBlur7SPIRV32  -E FFX_CACAO_EdgeSensitiveBlur7 ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur8_32.h -Vn CSEdgeSensitiveBlur8SPIRV32  -E FFX_CACAO_EdgeSensitiveBlur8 ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Smart_32.spv    -E FFX_CACAO_UpscaleBilateral5x5Smart    ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5NonSmart_32.spv -E FFX_CACAO_UpscaleBilateral5x5NonSmart ffx_cacao.hlsl
+%cauldron_dxc_32% -Fo PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Half_32.spv     -E FFX_CACAO_UpscaleBilateral5x5Half     ffx_cacao.hlsl
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOApply_32.h             -Vn CSApplySPIRV32              -E FFX_CACAO_Apply             ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAONonSmartApply_32.h     -Vn CSNonSmartApplySPIRV32      -E FFX_CACAO_NonSmartApply     ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAONonSmartHalfApply_32.h -Vn CSNonSmartHalfApplySPIRV32  -E FFX_CACAO_NonSmartHalfApply ffx_cacao.hlsl
+rem validate every module, and every specialization of the generate and blur modules with its constants frozen
+set spirv_val="%VULKAN_SDK%\Bin\spirv-val.exe" --target-env vulkan1.1
+set spirv_opt="%VULKAN_SDK%\Bin\spirv-opt.exe" --target-env=vulkan1.1
+set spirv_specialized=PrecompiledShadersSPIRV\specialized.spv
+for %%f in (PrecompiledShadersSPIRV\CACAO*.spv) do (
+	%spirv_val% %%f || goto :invalid
+)
+for %%b in (16 32) do (
+	for %%p in (1 2 3 4 5 6 7 8) do (
+		%spirv_opt% --set-spec-const-default-value "0:%%p" --freeze-spec-const -O PrecompiledShadersSPIRV\CACAOEdgeSensitiveBlur_%%b.spv -o %spirv_specialized% || goto :invalid
+		%spirv_val% %spirv_specialized% || goto :invalid
+	)
+	for %%q in (0 1) do (
+		%spirv_opt% --set-spec-const-default-value "1:%%q" --freeze-spec-const -O PrecompiledShadersSPIRV\CACAOGenerateSparse_%%b.spv -o %spirv_specialized% || goto :invalid
+		%spirv_val% %spirv_specialized% || goto :invalid
+	)
+	for %%s in ("1:2 2:false" "1:3 2:false" "1:3 2:true") do (
+		%spirv_opt% --set-spec-const-default-value %%s --freeze-spec-const -O PrecompiledShadersSPIRV\CACAOGenerate_%%b.spv -o %spirv_specialized% || goto :invalid
+		%spirv_val% %spirv_specialized% || goto :invalid
+	)
+)
+del /q %spirv_specialized%
 
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Smart_32.h    -Vn CSUpscaleBilateral5x5SmartSPIRV32    -E FFX_CACAO_UpscaleBilateral5x5Smart    ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5NonSmart_32.h -Vn CSUpscaleBilateral5x5NonSmartSPIRV32 -E FFX_CACAO_UpscaleBilateral5x5NonSmart ffx_cacao.hlsl
-%cauldron_dxc_32% -Fh PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Half_32.h     -Vn CSUpscaleBilateral5x5HalfSPIRV32     -E FFX_CACAO_UpscaleBilateral5x5Half     ffx_cacao.hlsl
+rem pack the modules of each precision into a compressed archive, decompressed by FFX CACAO when creating pipelines
+set modules_16=
+set modules_32=
+for %%f in (PrecompiledShadersSPIRV\CACAO*_16.spv) do set modules_16=!modules_16! %%f
+for %%f in (PrecompiledShadersSPIRV\CACAO*_32.spv) do set modules_32=!modules_32! %%f
+
+"%cacao_pack_shaders%" PrecompiledShadersSPIRV/CACAOShaders_16.h SPIRV16 %modules_16%
+"%cacao_pack_shaders%" PrecompiledShadersSPIRV/CACAOShaders_32.h SPIRV32 %modules_32%
+
+popd
+exit /b 0
 
+:invalid
+echo error: invalid SPIR-V module, see above
 popd
+exit /b 1
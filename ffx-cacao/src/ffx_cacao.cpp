@@ -103,49 +103,11 @@ void FFX_CACAO_UpdateBufferSizeInfo(uint32_t width, uint32_t height, FFX_CACAO_B
 	}
 }
 
-void FFX_CACAO_UpdateConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Settings* settings, const FFX_CACAO_BufferSizeInfo* bufferSizeInfo, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView)
+void FFX_CACAO_UpdateSettingsConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Settings* settings)
 {
 	consts->BilateralSigmaSquared = settings->bilateralSigmaSquared;
 	consts->BilateralSimilarityDistanceSigma = settings->bilateralSimilarityDistanceSigma;
 
-	if (settings->generateNormals)
-	{
-		consts->NormalsWorldToViewspaceMatrix = FFX_CACAO_IDENTITY_MATRIX;
-	}
-	else
-	{
-		consts->NormalsWorldToViewspaceMatrix = *normalsToView;
-	}
-
-	// used to get average load per pixel; 9.0 is there to compensate for only doing every 9th InterlockedAdd in PSPostprocessImportanceMapB for performance reasons
-	consts->LoadCounterAvgDiv = 9.0f / (float)(bufferSizeInfo->importanceMapWidth * bufferSizeInfo->importanceMapHeight * 255.0);
-
-	float depthLinearizeMul = (MATRIX_ROW_MAJOR_ORDER) ? (-proj->elements[3][2]) : (-proj->elements[2][3]);           // float depthLinearizeMul = ( clipFar * clipNear ) / ( clipFar - clipNear );
-	float depthLinearizeAdd = (MATRIX_ROW_MAJOR_ORDER) ? (proj->elements[2][2]) : (proj->elements[2][2]);           // float depthLinearizeAdd = clipFar / ( clipFar - clipNear );
-	// correct the handedness issue. need to make sure this below is correct, but I think it is.
-	if (depthLinearizeMul * depthLinearizeAdd < 0)
-		depthLinearizeAdd = -depthLinearizeAdd;
-	consts->DepthUnpackConsts[0] = depthLinearizeMul;
-	consts->DepthUnpackConsts[1] = depthLinearizeAdd;
-
-	float tanHalfFOVY = 1.0f / proj->elements[1][1];    // = tanf( drawContext.Camera.GetYFOV( ) * 0.5f );
-	float tanHalfFOVX = 1.0F / proj->elements[0][0];    // = tanHalfFOVY * drawContext.Camera.GetAspect( );
-	consts->CameraTanHalfFOV[0] = tanHalfFOVX;
-	consts->CameraTanHalfFOV[1] = tanHalfFOVY;
-
-	consts->NDCToViewMul[0] = consts->CameraTanHalfFOV[0] * 2.0f;
-	consts->NDCToViewMul[1] = consts->CameraTanHalfFOV[1] * -2.0f;
-	consts->NDCToViewAdd[0] = consts->CameraTanHalfFOV[0] * -1.0f;
-	consts->NDCToViewAdd[1] = consts->CameraTanHalfFOV[1] * 1.0f;
-
-	float ratio = ((float)bufferSizeInfo->inputOutputBufferWidth) / ((float)bufferSizeInfo->depthBufferWidth);
-	float border = (1.0f - ratio) / 2.0f;
-	for (int i = 0; i < 2; ++i)
-	{
-		consts->DepthBufferUVToViewMul[i] = consts->NDCToViewMul[i] / ratio;
-		consts->DepthBufferUVToViewAdd[i] = consts->NDCToViewAdd[i] - consts->NDCToViewMul[i] * border / ratio;
-	}
-
 	consts->EffectRadius = FFX_CACAO_CLAMP(settings->radius, 0.0f, 100000.0f);
 	consts->EffectShadowStrength = FFX_CACAO_CLAMP(settings->shadowMultiplier * 4.3f, 0.0f, 10.0f);
 	consts->EffectShadowPow = FFX_CACAO_CLAMP(settings->shadowPower, 0.0f, 10.0f);
@@ -154,27 +116,15 @@ void FFX_CACAO_UpdateConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Sett
 	consts->EffectFadeOutAdd = settings->fadeOutFrom / (settings->fadeOutTo - settings->fadeOutFrom) + 1.0f;
 	consts->EffectHorizonAngleThreshold = FFX_CACAO_CLAMP(settings->horizonAngleThreshold, 0.0f, 1.0f);
 
-	// 1.2 seems to be around the best trade off - 1.0 means on-screen radius will stop/slow growing when the camera is at 1.0 distance, so, depending on FOV, basically filling up most of the screen
-	// This setting is viewspace-dependent and not screen size dependent intentionally, so that when you change FOV the effect stays (relatively) similar.
-	float effectSamplingRadiusNearLimit = (settings->radius * 1.2f);
-
 	// if the depth precision is switched to 32bit float, this can be set to something closer to 1 (0.9999 is fine)
 	consts->DepthPrecisionOffsetMod = 0.9992f;
 
 	// Special settings for lowest quality level - just nerf the effect a tiny bit
-	if (settings->qualityLevel <= FFX_CACAO_QUALITY_LOW)
+	if (settings->qualityLevel == FFX_CACAO_QUALITY_LOWEST)
 	{
-		//consts.EffectShadowStrength     *= 0.9f;
-		effectSamplingRadiusNearLimit *= 1.50f;
-
-		if (settings->qualityLevel == FFX_CACAO_QUALITY_LOWEST)
-			consts->EffectRadius *= 0.8f;
+		consts->EffectRadius *= 0.8f;
 	}
 
-	effectSamplingRadiusNearLimit /= tanHalfFOVY; // to keep the effect same regardless of FOV
-
-	consts->EffectSamplingRadiusNearLimitRec = 1.0f / effectSamplingRadiusNearLimit;
-
 	consts->AdaptiveSampleCountLimit = settings->adaptiveQualityLimit;
 
 	consts->NegRecEffectRadius = -1.0f / consts->EffectRadius;
@@ -183,6 +133,23 @@ void FFX_CACAO_UpdateConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Sett
 
 	consts->DetailAOStrength = settings->detailShadowStrength;
 
+	if (!settings->generateNormals)
+	{
+		consts->NormalsUnpackMul = 2.0f;  // inputs->NormalsUnpackMul;
+		consts->NormalsUnpackAdd = -1.0f; // inputs->NormalsUnpackAdd;
+	}
+	else
+	{
+		consts->NormalsUnpackMul = 2.0f;
+		consts->NormalsUnpackAdd = -1.0f;
+	}
+}
+
+void FFX_CACAO_UpdateSizeConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_BufferSizeInfo* bufferSizeInfo)
+{
+	// used to get average load per pixel; 9.0 is there to compensate for only doing every 9th InterlockedAdd in PSPostprocessImportanceMapB for performance reasons
+	consts->LoadCounterAvgDiv = 9.0f / (float)(bufferSizeInfo->importanceMapWidth * bufferSizeInfo->importanceMapHeight * 255.0);
+
 	// set buffer size constants.
 	consts->SSAOBufferDimensions[0] = (float)bufferSizeInfo->ssaoBufferWidth;
 	consts->SSAOBufferDimensions[1] = (float)bufferSizeInfo->ssaoBufferHeight;
@@ -217,16 +184,101 @@ void FFX_CACAO_UpdateConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Sett
 	consts->DeinterleavedDepthBufferNormalisedOffset[0] = ((float)bufferSizeInfo->deinterleavedDepthBufferXOffset) / ((float)bufferSizeInfo->deinterleavedDepthBufferWidth);
 	consts->DeinterleavedDepthBufferNormalisedOffset[1] = ((float)bufferSizeInfo->deinterleavedDepthBufferYOffset) / ((float)bufferSizeInfo->deinterleavedDepthBufferHeight);
 
-	if (!settings->generateNormals)
+	// the whole of the textures is drawn, so the sampler alone clamps the taps to their edge
+	consts->DeinterleavedDepthBufferMaxUV[0] = 1.0f;
+	consts->DeinterleavedDepthBufferMaxUV[1] = 1.0f;
+}
+
+void FFX_CACAO_UpdateProjectionConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Settings* settings, const FFX_CACAO_BufferSizeInfo* bufferSizeInfo, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView)
+{
+	if (settings->generateNormals)
 	{
-		consts->NormalsUnpackMul = 2.0f;  // inputs->NormalsUnpackMul;
-		consts->NormalsUnpackAdd = -1.0f; // inputs->NormalsUnpackAdd;
+		consts->NormalsWorldToViewspaceMatrix = FFX_CACAO_IDENTITY_MATRIX;
 	}
 	else
 	{
-		consts->NormalsUnpackMul = 2.0f;
-		consts->NormalsUnpackAdd = -1.0f;
+		consts->NormalsWorldToViewspaceMatrix = *normalsToView;
 	}
+
+	float depthLinearizeMul = (MATRIX_ROW_MAJOR_ORDER) ? (-proj->elements[3][2]) : (-proj->elements[2][3]);           // float depthLinearizeMul = ( clipFar * clipNear ) / ( clipFar - clipNear );
+	float depthLinearizeAdd = (MATRIX_ROW_MAJOR_ORDER) ? (proj->elements[2][2]) : (proj->elements[2][2]);           // float depthLinearizeAdd = clipFar / ( clipFar - clipNear );
+	// correct the handedness issue. need to make sure this below is correct, but I think it is.
+	if (depthLinearizeMul * depthLinearizeAdd < 0)
+		depthLinearizeAdd = -depthLinearizeAdd;
+	consts->DepthUnpackConsts[0] = depthLinearizeMul;
+	consts->DepthUnpackConsts[1] = depthLinearizeAdd;
+
+	float tanHalfFOVY = 1.0f / proj->elements[1][1];    // = tanf( drawContext.Camera.GetYFOV( ) * 0.5f );
+	float tanHalfFOVX = 1.0F / proj->elements[0][0];    // = tanHalfFOVY * drawContext.Camera.GetAspect( );
+	consts->CameraTanHalfFOV[0] = tanHalfFOVX;
+	consts->CameraTanHalfFOV[1] = tanHalfFOVY;
+
+	consts->NDCToViewMul[0] = consts->CameraTanHalfFOV[0] * 2.0f;
+	consts->NDCToViewMul[1] = consts->CameraTanHalfFOV[1] * -2.0f;
+	consts->NDCToViewAdd[0] = consts->CameraTanHalfFOV[0] * -1.0f;
+	consts->NDCToViewAdd[1] = consts->CameraTanHalfFOV[1] * 1.0f;
+
+	float ratio = ((float)bufferSizeInfo->inputOutputBufferWidth) / ((float)bufferSizeInfo->depthBufferWidth);
+	float border = (1.0f - ratio) / 2.0f;
+	for (int i = 0; i < 2; ++i)
+	{
+		consts->DepthBufferUVToViewMul[i] = consts->NDCToViewMul[i] / ratio;
+		consts->DepthBufferUVToViewAdd[i] = consts->NDCToViewAdd[i] - consts->NDCToViewMul[i] * border / ratio;
+	}
+
+	// 1.2 seems to be around the best trade off - 1.0 means on-screen radius will stop/slow growing when the camera is at 1.0 distance, so, depending on FOV, basically filling up most of the screen
+	// This setting is viewspace-dependent and not screen size dependent intentionally, so that when you change FOV the effect stays (relatively) similar.
+	float effectSamplingRadiusNearLimit = (settings->radius * 1.2f);
+
+	// Special settings for lowest quality level - just nerf the effect a tiny bit
+	if (settings->qualityLevel <= FFX_CACAO_QUALITY_LOW)
+	{
+		//consts.EffectShadowStrength     *= 0.9f;
+		effectSamplingRadiusNearLimit *= 1.50f;
+	}
+
+	effectSamplingRadiusNearLimit /= tanHalfFOVY; // to keep the effect same regardless of FOV
+
+	consts->EffectSamplingRadiusNearLimitRec = 1.0f / effectSamplingRadiusNearLimit;
+}
+
+void FFX_CACAO_UpdateConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Settings* settings, const FFX_CACAO_BufferSizeInfo* bufferSizeInfo, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView)
+{
+	FFX_CACAO_UpdateSettingsConstants(consts, settings);
+	FFX_CACAO_UpdateSizeConstants(consts, bufferSizeInfo);
+	FFX_CACAO_UpdateProjectionConstants(consts, settings, bufferSizeInfo, proj, normalsToView);
+}
+
+void FFX_CACAO_UpdateRenderAreaConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_BufferSizeInfo* bufferSizeInfo, const FFX_CACAO_BufferSizeInfo* renderAreaSizeInfo)
+{
+	// FFX_CACAO_PostprocessImportanceMapB bounds its sum of the load counter to ImportanceMapDimensions, the render area,
+	// although it runs over the guard band beyond it
+	consts->LoadCounterAvgDiv = 9.0f / (float)(renderAreaSizeInfo->importanceMapWidth * renderAreaSizeInfo->importanceMapHeight * 255.0);
+
+	consts->SSAOBufferDimensions[0] = (float)renderAreaSizeInfo->ssaoBufferWidth;
+	consts->SSAOBufferDimensions[1] = (float)renderAreaSizeInfo->ssaoBufferHeight;
+	consts->DepthBufferDimensions[0] = (float)renderAreaSizeInfo->depthBufferWidth;
+	consts->DepthBufferDimensions[1] = (float)renderAreaSizeInfo->depthBufferHeight;
+	consts->InputOutputBufferDimensions[0] = (float)renderAreaSizeInfo->inputOutputBufferWidth;
+	consts->InputOutputBufferDimensions[1] = (float)renderAreaSizeInfo->inputOutputBufferHeight;
+	consts->ImportanceMapDimensions[0] = (float)renderAreaSizeInfo->importanceMapWidth;
+	consts->ImportanceMapDimensions[1] = (float)renderAreaSizeInfo->importanceMapHeight;
+	consts->DeinterleavedDepthBufferDimensions[0] = (float)renderAreaSizeInfo->deinterleavedDepthBufferWidth;
+	consts->DeinterleavedDepthBufferDimensions[1] = (float)renderAreaSizeInfo->deinterleavedDepthBufferHeight;
+
+	// a coordinate normalised to the resources is scaled to one normalised to the render area before going to viewspace
+	float scale[2];
+	scale[0] = (float)bufferSizeInfo->inputOutputBufferWidth / (float)renderAreaSizeInfo->inputOutputBufferWidth;
+	scale[1] = (float)bufferSizeInfo->inputOutputBufferHeight / (float)renderAreaSizeInfo->inputOutputBufferHeight;
+	for (int i = 0; i < 2; ++i)
+	{
+		consts->NDCToViewMul[i] *= scale[i];
+		consts->DepthBufferUVToViewMul[i] *= scale[i];
+	}
+
+	// taps beyond the render area are clamped to the centre of its last texel
+	consts->DeinterleavedDepthBufferMaxUV[0] = ((float)renderAreaSizeInfo->deinterleavedDepthBufferWidth - 0.5f) / (float)bufferSizeInfo->deinterleavedDepthBufferWidth;
+	consts->DeinterleavedDepthBufferMaxUV[1] = ((float)renderAreaSizeInfo->deinterleavedDepthBufferHeight - 0.5f) / (float)bufferSizeInfo->deinterleavedDepthBufferHeight;
 }
 
 void FFX_CACAO_UpdatePerPassConstants(FFX_CACAO_Constants* consts, const FFX_CACAO_Settings* settings, const FFX_CACAO_BufferSizeInfo* bufferSizeInfo, int pass)
@@ -412,6 +412,29 @@ void FFX_CACAO_EdgeSensitiveBlur8(uint2 tid : SV_GroupThreadID, uint2 gid : SV_G
 	FFX_CACAO_LDSEdgeSensitiveBlur(8, tid, gid);
 }
 
+#ifdef __spirv__
+// Vulkan builds a single blur module, and specializes the number of blur passes when creating each pipeline. Each case
+// passes a literal pass count, so that its loops are unrolled as in the per-variant shaders, and the specialized
+// pipeline keeps only the selected case
+[[vk::constant_id(FFX_CACAO_SPEC_CONSTANT_BLUR_PASSES)]] const uint FFX_CACAO_SpecBlurPasses = 1;
+
+[numthreads(FFX_CACAO_BLUR_WIDTH, FFX_CACAO_BLUR_HEIGHT, 1)]
+void FFX_CACAO_EdgeSensitiveBlur(uint2 tid : SV_GroupThreadID, uint2 gid : SV_GroupID)
+{
+	switch (FFX_CACAO_SpecBlurPasses)
+	{
+	case 1:  FFX_CACAO_LDSEdgeSensitiveBlur(1, tid, gid); break;
+	case 2:  FFX_CACAO_LDSEdgeSensitiveBlur(2, tid, gid); break;
+	case 3:  FFX_CACAO_LDSEdgeSensitiveBlur(3, tid, gid); break;
+	case 4:  FFX_CACAO_LDSEdgeSensitiveBlur(4, tid, gid); break;
+	case 5:  FFX_CACAO_LDSEdgeSensitiveBlur(5, tid, gid); break;
+	case 6:  FFX_CACAO_LDSEdgeSensitiveBlur(6, tid, gid); break;
+	case 7:  FFX_CACAO_LDSEdgeSensitiveBlur(7, tid, gid); break;
+	default: FFX_CACAO_LDSEdgeSensitiveBlur(8, tid, gid); break;
+	}
+}
+#endif
+
 
 #undef FFX_CACAO_TILE_WIDTH
 #undef FFX_CACAO_TILE_HEIGHT
@@ -925,6 +948,66 @@ void FFX_CACAO_GenerateQ3(uint2 coord : SV_DispatchThreadID)
 	FFX_CACAO_SSAOGeneration_StoreOutput(coord, out0);
 }
 
+#ifdef __spirv__
+// Vulkan builds one module for the sparse (Q0 and Q1) and one for the dense (Q2, Q3 and Q3 base) generate passes,
+// and specializes the quality level when creating each pipeline. Each branch passes a literal quality level, so that
+// its taps are unrolled and its disabled features compiled out as in the per-variant shaders, and the specialized
+// pipeline keeps only the selected branch
+[[vk::constant_id(FFX_CACAO_SPEC_CONSTANT_QUALITY_LEVEL)]] const int  FFX_CACAO_SpecQualityLevel = 0;
+[[vk::constant_id(FFX_CACAO_SPEC_CONSTANT_ADAPTIVE_BASE)]] const bool FFX_CACAO_SpecAdaptiveBase = false;
+
+[numthreads(FFX_CACAO_GENERATE_SPARSE_WIDTH, FFX_CACAO_GENERATE_SPARSE_HEIGHT, 1)]
+void FFX_CACAO_GenerateSparse(uint3 tid : SV_DispatchThreadID)
+{
+	uint xOffset = (tid.y * 3 + tid.z) % 5;
+	uint2 coord = uint2(5 * tid.x + xOffset, tid.y);
+	float2 inPos = (float2)coord;
+	float   outShadowTerm;
+	float   outWeight;
+	float4  outEdges;
+	float2 out0;
+	if (FFX_CACAO_SpecQualityLevel == 0)
+	{
+		FFX_CACAO_GenerateSSAOShadowsInternal(outShadowTerm, outEdges, outWeight, inPos.xy, 0, false);
+		out0.y = FFX_CACAO_PackEdges(float4(1, 1, 1, 1)); // no edges in low quality
+	}
+	else
+	{
+		FFX_CACAO_GenerateSSAOShadowsInternal(outShadowTerm, outEdges, outWeight, inPos.xy, 1, false);
+		out0.y = FFX_CACAO_PackEdges(outEdges);
+	}
+	out0.x = outShadowTerm;
+	FFX_CACAO_SSAOGeneration_StoreOutput(coord, out0);
+}
+
+[numthreads(FFX_CACAO_GENERATE_WIDTH, FFX_CACAO_GENERATE_HEIGHT, 1)]
+void FFX_CACAO_Generate(uint2 coord : SV_DispatchThreadID)
+{
+	float2 inPos = (float2)coord;
+	float   outShadowTerm;
+	float   outWeight;
+	float4  outEdges;
+	float2 out0;
+	if (FFX_CACAO_SpecAdaptiveBase)
+	{
+		FFX_CACAO_GenerateSSAOShadowsInternal(outShadowTerm, outEdges, outWeight, inPos.xy, 3, true);
+		out0.y = outWeight / ((float)FFX_CACAO_ADAPTIVE_TAP_BASE_COUNT * 4.0);
+	}
+	else if (FFX_CACAO_SpecQualityLevel == 2)
+	{
+		FFX_CACAO_GenerateSSAOShadowsInternal(outShadowTerm, outEdges, outWeight, inPos.xy, 2, false);
+		out0.y = FFX_CACAO_PackEdges(outEdges);
+	}
+	else
+	{
+		FFX_CACAO_GenerateSSAOShadowsInternal(outShadowTerm, outEdges, outWeight, inPos.xy, 3, false);
+		out0.y = FFX_CACAO_PackEdges(outEdges);
+	}
+	out0.x = outShadowTerm;
+	FFX_CACAO_SSAOGeneration_StoreOutput(coord, out0);
+}
+#endif
+
 // =======================================================
 // Apply
 
@@ -1407,7 +1490,8 @@ void FFX_CACAO_PostprocessImportanceMapB(uint2 tid : SV_DispatchThreadID)
 	uint sum = (uint)(saturate(retVal) * 255.0 + 0.5);
 
 	// save every 9th to avoid InterlockedAdd congestion - since we're blurring, this is good enough; compensated by multiplying LoadCounterAvgDiv by 9
-	if (((tid.x % 3) + (tid.y % 3)) == 0)
+	// only texels of the render area are summed, not those of the guard band beyond it or of the rest of the last thread group
+	if (((tid.x % 3) + (tid.y % 3)) == 0 && all(float2(tid) < g_FFX_CACAO_Consts.ImportanceMapDimensions))
 	{
 		FFX_CACAO_Importance_LoadCounterInterlockedAdd(sum);
 	}
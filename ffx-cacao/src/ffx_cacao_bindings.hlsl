@@ -84,6 +84,9 @@ struct FFX_CACAO_Constants
 	float2                  DeinterleavedDepthBufferNormalisedOffset;
 
 	float4x4                NormalsWorldToViewspaceMatrix;
+
+	float2                  DeinterleavedDepthBufferMaxUV;
+	float2                  Dummy1;
 };
 
 cbuffer SSAOConstantsBuffer : register(b0)
@@ -144,6 +147,8 @@ RWTexture2DArray<float2> g_SSAOOutput                : register(u0);
 
 float FFX_CACAO_SSAOGeneration_SampleViewspaceDepthMip(float2 uv, float mip)
 {
+	// taps beyond a render area smaller than the textures are clamped to its edge, as the sampler clamps them to theirs
+	uv = min(uv, g_FFX_CACAO_Consts.DeinterleavedDepthBufferMaxUV);
 	return g_ViewspaceDepthSource.SampleLevel(g_ViewspaceDepthTapSampler, float3(uv, 0.0f), mip);
 }
 
@@ -80,4 +80,11 @@
 #define FFX_CACAO_BILATERAL_UPSCALE_WIDTH  8
 #define FFX_CACAO_BILATERAL_UPSCALE_HEIGHT 8
 
+// ============================================================================
+// Vulkan Specialization Constants
+
+#define FFX_CACAO_SPEC_CONSTANT_BLUR_PASSES   0
+#define FFX_CACAO_SPEC_CONSTANT_QUALITY_LEVEL 1
+#define FFX_CACAO_SPEC_CONSTANT_ADAPTIVE_BASE 2
+
 #endif
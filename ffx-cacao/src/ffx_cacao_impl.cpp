@@ -27,9 +27,35 @@
 #include <stdio.h>  // snprintf
 
 #ifdef FFX_CACAO_ENABLE_D3D12
+#include <stdlib.h> // malloc, free
 #include <d3dx12.h>
 #endif
 
+#if defined(FFX_CACAO_ENABLE_VULKAN) || defined(FFX_CACAO_ENABLE_CPU)
+#include <stdlib.h> // malloc, free
+#include <new>      // std::nothrow
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#ifdef FFX_CACAO_ENABLE_CPU
+#ifdef FFX_CACAO_ENABLE_PROFILING
+#include <chrono>
+#endif
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>  // __cpuidex
+#else
+#include <cpuid.h>   // __cpuid_count
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#endif
+#endif
+
 // Define symbol to enable DirectX debug markers created using Cauldron
 #define FFX_CACAO_ENABLE_CAULDRON_DEBUG
 
@@ -42,142 +68,19 @@
 #define FFX_CACAO_CLAMP(value, lower, upper) FFX_CACAO_MIN(FFX_CACAO_MAX(value, lower), upper)
 #define FFX_CACAO_OFFSET_OF(T, member) (size_t)(&(((T*)0)->member))
 
-#ifdef FFX_CACAO_ENABLE_D3D12
-#include "PrecompiledShadersDXIL/CACAOClearLoadCounter.h"
-
-#include "PrecompiledShadersDXIL/CACAOPrepareDownsampledDepthsHalf.h"
-#include "PrecompiledShadersDXIL/CACAOPrepareNativeDepthsHalf.h"
-
-#include "PrecompiledShadersDXIL/CACAOPrepareDownsampledDepthsAndMips.h"
-#include "PrecompiledShadersDXIL/CACAOPrepareNativeDepthsAndMips.h"
-
-#include "PrecompiledShadersDXIL/CACAOPrepareDownsampledNormals.h"
-#include "PrecompiledShadersDXIL/CACAOPrepareNativeNormals.h"
-
-#include "PrecompiledShadersDXIL/CACAOPrepareDownsampledNormalsFromInputNormals.h"
-#include "PrecompiledShadersDXIL/CACAOPrepareNativeNormalsFromInputNormals.h"
-
-#include "PrecompiledShadersDXIL/CACAOPrepareDownsampledDepths.h"
-#include "PrecompiledShadersDXIL/CACAOPrepareNativeDepths.h"
-
-#include "PrecompiledShadersDXIL/CACAOGenerateQ0.h"
-#include "PrecompiledShadersDXIL/CACAOGenerateQ1.h"
-#include "PrecompiledShadersDXIL/CACAOGenerateQ2.h"
-#include "PrecompiledShadersDXIL/CACAOGenerateQ3.h"
-#include "PrecompiledShadersDXIL/CACAOGenerateQ3Base.h"
-
-#include "PrecompiledShadersDXIL/CACAOGenerateImportanceMap.h"
-#include "PrecompiledShadersDXIL/CACAOPostprocessImportanceMapA.h"
-#include "PrecompiledShadersDXIL/CACAOPostprocessImportanceMapB.h"
-
-#include "PrecompiledShadersDXIL/CACAOEdgeSensitiveBlur1.h"
-#include "PrecompiledShadersDXIL/CACAOEdgeSensitiveBlur2.h"
-#include "PrecompiledShadersDXIL/CACAOEdgeSensitiveBlur3.h"
-#include "PrecompiledShadersDXIL/CACAOEdgeSensitiveBlur4.h"
-#include "PrecompiledShadersDXIL/CACAOEdgeSensitiveBlur5.h"
-#include "PrecompiledShadersDXIL/CACAOEdgeSensitiveBlur6.h"
-#include "PrecompiledShadersDXIL/CACAOEdgeSensitiveBlur7.h"
-#include "PrecompiledShadersDXIL/CACAOEdgeSensitiveBlur8.h"
-
-#include "PrecompiledShadersDXIL/CACAOApply.h"
-#include "PrecompiledShadersDXIL/CACAONonSmartApply.h"
-#include "PrecompiledShadersDXIL/CACAONonSmartHalfApply.h"
+#if defined(FFX_CACAO_ENABLE_VULKAN) || defined(FFX_CACAO_ENABLE_D3D12)
+#include "ffx_cacao_shader_archive.h"
+#endif
 
-#include "PrecompiledShadersDXIL/CACAOUpscaleBilateral5x5Smart.h"
-#include "PrecompiledShadersDXIL/CACAOUpscaleBilateral5x5NonSmart.h"
-#include "PrecompiledShadersDXIL/CACAOUpscaleBilateral5x5Half.h"
+#ifdef FFX_CACAO_ENABLE_D3D12
+// compressed archive of the DXIL shaders, generated by ffx_cacao_pack_shaders
+#include "PrecompiledShadersDXIL/CACAOShaders.h"
 #endif
 
 #ifdef FFX_CACAO_ENABLE_VULKAN
-// 16 bit versions
-#include "PrecompiledShadersSPIRV/CACAOClearLoadCounter_16.h"
-
-#include "PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsHalf_16.h"
-#include "PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsHalf_16.h"
-
-#include "PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsAndMips_16.h"
-#include "PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsAndMips_16.h"
-
-#include "PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormals_16.h"
-#include "PrecompiledShadersSPIRV/CACAOPrepareNativeNormals_16.h"
-
-#include "PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormalsFromInputNormals_16.h"
-#include "PrecompiledShadersSPIRV/CACAOPrepareNativeNormalsFromInputNormals_16.h"
-
-#include "PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepths_16.h"
-#include "PrecompiledShadersSPIRV/CACAOPrepareNativeDepths_16.h"
-
-#include "PrecompiledShadersSPIRV/CACAOGenerateQ0_16.h"
-#include "PrecompiledShadersSPIRV/CACAOGenerateQ1_16.h"
-#include "PrecompiledShadersSPIRV/CACAOGenerateQ2_16.h"
-#include "PrecompiledShadersSPIRV/CACAOGenerateQ3_16.h"
-#include "PrecompiledShadersSPIRV/CACAOGenerateQ3Base_16.h"
-
-#include "PrecompiledShadersSPIRV/CACAOGenerateImportanceMap_16.h"
-#include "PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapA_16.h"
-#include "PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapB_16.h"
-
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur1_16.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur2_16.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur3_16.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur4_16.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur5_16.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur6_16.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur7_16.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur8_16.h"
-
-#include "PrecompiledShadersSPIRV/CACAOApply_16.h"
-#include "PrecompiledShadersSPIRV/CACAONonSmartApply_16.h"
-#include "PrecompiledShadersSPIRV/CACAONonSmartHalfApply_16.h"
-
-#include "PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Smart_16.h"
-#include "PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5NonSmart_16.h"
-#include "PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Half_16.h"
-
-// 32 bit versions
-#include "PrecompiledShadersSPIRV/CACAOClearLoadCounter_32.h"
-
-#include "PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsHalf_32.h"
-#include "PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsHalf_32.h"
-
-#include "PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepthsAndMips_32.h"
-#include "PrecompiledShadersSPIRV/CACAOPrepareNativeDepthsAndMips_32.h"
-
-#include "PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormals_32.h"
-#include "PrecompiledShadersSPIRV/CACAOPrepareNativeNormals_32.h"
-
-#include "PrecompiledShadersSPIRV/CACAOPrepareDownsampledNormalsFromInputNormals_32.h"
-#include "PrecompiledShadersSPIRV/CACAOPrepareNativeNormalsFromInputNormals_32.h"
-
-#include "PrecompiledShadersSPIRV/CACAOPrepareDownsampledDepths_32.h"
-#include "PrecompiledShadersSPIRV/CACAOPrepareNativeDepths_32.h"
-
-#include "PrecompiledShadersSPIRV/CACAOGenerateQ0_32.h"
-#include "PrecompiledShadersSPIRV/CACAOGenerateQ1_32.h"
-#include "PrecompiledShadersSPIRV/CACAOGenerateQ2_32.h"
-#include "PrecompiledShadersSPIRV/CACAOGenerateQ3_32.h"
-#include "PrecompiledShadersSPIRV/CACAOGenerateQ3Base_32.h"
-
-#include "PrecompiledShadersSPIRV/CACAOGenerateImportanceMap_32.h"
-#include "PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapA_32.h"
-#include "PrecompiledShadersSPIRV/CACAOPostprocessImportanceMapB_32.h"
-
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur1_32.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur2_32.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur3_32.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur4_32.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur5_32.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur6_32.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur7_32.h"
-#include "PrecompiledShadersSPIRV/CACAOEdgeSensitiveBlur8_32.h"
-
-#include "PrecompiledShadersSPIRV/CACAOApply_32.h"
-#include "PrecompiledShadersSPIRV/CACAONonSmartApply_32.h"
-#include "PrecompiledShadersSPIRV/CACAONonSmartHalfApply_32.h"
-
-#include "PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Smart_32.h"
-#include "PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5NonSmart_32.h"
-#include "PrecompiledShadersSPIRV/CACAOUpscaleBilateral5x5Half_32.h"
+// compressed archives of the SPIR-V modules, generated by ffx_cacao_pack_shaders
+#include "PrecompiledShadersSPIRV/CACAOShaders_16.h"
+#include "PrecompiledShadersSPIRV/CACAOShaders_32.h"
 #endif
 
 #define MAX_BLUR_PASSES 8
@@ -223,30 +126,39 @@ static const char *TIMESTAMP_NAMES[NUM_TIMESTAMPS] = {
 #define NUM_TIMESTAMP_BUFFERS 5
 #endif
 
-// TIMESTAMP_FORMAT(name, vulkan_format, d3d12_format)
+// TEXTURE_FORMAT(name, vulkan_format, d3d12_format, texel_size)
 #define TEXTURE_FORMATS \
-	TEXTURE_FORMAT(R16_SFLOAT,          VK_FORMAT_R16_SFLOAT,          DXGI_FORMAT_R16_FLOAT) \
-	TEXTURE_FORMAT(R16G16B16A16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT, DXGI_FORMAT_R16G16B16A16_FLOAT) \
-	TEXTURE_FORMAT(R8G8B8A8_SNORM,      VK_FORMAT_R8G8B8A8_SNORM,      DXGI_FORMAT_R8G8B8A8_SNORM) \
-	TEXTURE_FORMAT(R8G8_UNORM,          VK_FORMAT_R8G8_UNORM,          DXGI_FORMAT_R8G8_UNORM) \
-	TEXTURE_FORMAT(R8_UNORM,            VK_FORMAT_R8_UNORM,            DXGI_FORMAT_R8_UNORM)
+	TEXTURE_FORMAT(R16_SFLOAT,          VK_FORMAT_R16_SFLOAT,          DXGI_FORMAT_R16_FLOAT,          2) \
+	TEXTURE_FORMAT(R16G16B16A16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT, DXGI_FORMAT_R16G16B16A16_FLOAT, 8) \
+	TEXTURE_FORMAT(R8G8B8A8_SNORM,      VK_FORMAT_R8G8B8A8_SNORM,      DXGI_FORMAT_R8G8B8A8_SNORM,     4) \
+	TEXTURE_FORMAT(R8G8_UNORM,          VK_FORMAT_R8G8_UNORM,          DXGI_FORMAT_R8G8_UNORM,         2) \
+	TEXTURE_FORMAT(R8_UNORM,            VK_FORMAT_R8_UNORM,            DXGI_FORMAT_R8_UNORM,           1) \
+	TEXTURE_FORMAT(R32_SFLOAT,          VK_FORMAT_R32_SFLOAT,          DXGI_FORMAT_R32_FLOAT,          4) \
+	TEXTURE_FORMAT(R32G32B32A32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT, DXGI_FORMAT_R32G32B32A32_FLOAT, 16)
 
 typedef enum TextureFormatID {
-#define TEXTURE_FORMAT(name, _vulkan_format, _d3d12_format) TEXTURE_FORMAT_##name,
+#define TEXTURE_FORMAT(name, _vulkan_format, _d3d12_format, _texel_size) TEXTURE_FORMAT_##name,
 	TEXTURE_FORMATS
 #undef TEXTURE_FORMAT
 } TextureFormatID;
 
 #ifdef FFX_CACAO_ENABLE_VULKAN
 static const VkFormat TEXTURE_FORMAT_LOOKUP_VK[] = {
-#define TEXTURE_FORMAT(_name, vulkan_format, _d3d12_format) vulkan_format,
+#define TEXTURE_FORMAT(_name, vulkan_format, _d3d12_format, _texel_size) vulkan_format,
 	TEXTURE_FORMATS
 #undef TEXTURE_FORMAT
 };
 #endif
 #ifdef FFX_CACAO_ENABLE_D3D12
 static const DXGI_FORMAT TEXTURE_FORMAT_LOOKUP_D3D12[] = {
-#define TEXTURE_FORMAT(_name, _vulkan_format, d3d12_format) d3d12_format,
+#define TEXTURE_FORMAT(_name, _vulkan_format, d3d12_format, _texel_size) d3d12_format,
+	TEXTURE_FORMATS
+#undef TEXTURE_FORMAT
+};
+#endif
+#ifdef FFX_CACAO_ENABLE_CPU
+static const uint32_t TEXTURE_FORMAT_TEXEL_SIZE_CPU[] = {
+#define TEXTURE_FORMAT(_name, _vulkan_format, _d3d12_format, texel_size) texel_size,
 	TEXTURE_FORMATS
 #undef TEXTURE_FORMAT
 };
@@ -613,50 +525,51 @@ static const OutputDescriptorBindingMetaData OUTPUT_DESCRIPTOR_BINDING_META_DATA
 };
 
 // define all the data for compute shaders
-// COMPUTE_SHADER(enum_name, pascal_case_name, descriptor_set)
+// COMPUTE_SHADER(enum_name, pascal_case_name, descriptor_set, spirv_module, spirv_specialization)
+// on Vulkan, the variants of the generate and blur shaders share a SPIR-V module, specialized when creating their pipelines
 #define COMPUTE_SHADERS \
-	COMPUTE_SHADER(CLEAR_LOAD_COUNTER,                             ClearLoadCounter,                          CLEAR_LOAD_COUNTER) \
+	COMPUTE_SHADER(CLEAR_LOAD_COUNTER,                             ClearLoadCounter,                          CLEAR_LOAD_COUNTER,                 ClearLoadCounter,                   SPEC_NONE) \
 	\
-	COMPUTE_SHADER(PREPARE_DOWNSAMPLED_DEPTHS,                     PrepareDownsampledDepths,                  PREPARE_DEPTHS) \
-	COMPUTE_SHADER(PREPARE_NATIVE_DEPTHS,                          PrepareNativeDepths,                       PREPARE_DEPTHS) \
-	COMPUTE_SHADER(PREPARE_DOWNSAMPLED_DEPTHS_AND_MIPS,            PrepareDownsampledDepthsAndMips,           PREPARE_DEPTHS_MIPS) \
-	COMPUTE_SHADER(PREPARE_NATIVE_DEPTHS_AND_MIPS,                 PrepareNativeDepthsAndMips,                PREPARE_DEPTHS_MIPS) \
-	COMPUTE_SHADER(PREPARE_DOWNSAMPLED_NORMALS,                    PrepareDownsampledNormals,                 PREPARE_NORMALS) \
-	COMPUTE_SHADER(PREPARE_NATIVE_NORMALS,                         PrepareNativeNormals,                      PREPARE_NORMALS) \
-	COMPUTE_SHADER(PREPARE_DOWNSAMPLED_NORMALS_FROM_INPUT_NORMALS, PrepareDownsampledNormalsFromInputNormals, PREPARE_NORMALS_FROM_INPUT_NORMALS) \
-	COMPUTE_SHADER(PREPARE_NATIVE_NORMALS_FROM_INPUT_NORMALS,      PrepareNativeNormalsFromInputNormals,      PREPARE_NORMALS_FROM_INPUT_NORMALS) \
-	COMPUTE_SHADER(PREPARE_DOWNSAMPLED_DEPTHS_HALF,                PrepareDownsampledDepthsHalf,              PREPARE_DEPTHS) \
-	COMPUTE_SHADER(PREPARE_NATIVE_DEPTHS_HALF,                     PrepareNativeDepthsHalf,                   PREPARE_DEPTHS) \
+	COMPUTE_SHADER(PREPARE_DOWNSAMPLED_DEPTHS,                     PrepareDownsampledDepths,                  PREPARE_DEPTHS,                     PrepareDownsampledDepths,           SPEC_NONE) \
+	COMPUTE_SHADER(PREPARE_NATIVE_DEPTHS,                          PrepareNativeDepths,                       PREPARE_DEPTHS,                     PrepareNativeDepths,                SPEC_NONE) \
+	COMPUTE_SHADER(PREPARE_DOWNSAMPLED_DEPTHS_AND_MIPS,            PrepareDownsampledDepthsAndMips,           PREPARE_DEPTHS_MIPS,                PrepareDownsampledDepthsAndMips,    SPEC_NONE) \
+	COMPUTE_SHADER(PREPARE_NATIVE_DEPTHS_AND_MIPS,                 PrepareNativeDepthsAndMips,                PREPARE_DEPTHS_MIPS,                PrepareNativeDepthsAndMips,         SPEC_NONE) \
+	COMPUTE_SHADER(PREPARE_DOWNSAMPLED_NORMALS,                    PrepareDownsampledNormals,                 PREPARE_NORMALS,                    PrepareDownsampledNormals,          SPEC_NONE) \
+	COMPUTE_SHADER(PREPARE_NATIVE_NORMALS,                         PrepareNativeNormals,                      PREPARE_NORMALS,                    PrepareNativeNormals,               SPEC_NONE) \
+	COMPUTE_SHADER(PREPARE_DOWNSAMPLED_NORMALS_FROM_INPUT_NORMALS, PrepareDownsampledNormalsFromInputNormals, PREPARE_NORMALS_FROM_INPUT_NORMALS, PrepareDownsampledNormalsFromInputNormals, SPEC_NONE) \
+	COMPUTE_SHADER(PREPARE_NATIVE_NORMALS_FROM_INPUT_NORMALS,      PrepareNativeNormalsFromInputNormals,      PREPARE_NORMALS_FROM_INPUT_NORMALS, PrepareNativeNormalsFromInputNormals, SPEC_NONE) \
+	COMPUTE_SHADER(PREPARE_DOWNSAMPLED_DEPTHS_HALF,                PrepareDownsampledDepthsHalf,              PREPARE_DEPTHS,                     PrepareDownsampledDepthsHalf,       SPEC_NONE) \
+	COMPUTE_SHADER(PREPARE_NATIVE_DEPTHS_HALF,                     PrepareNativeDepthsHalf,                   PREPARE_DEPTHS,                     PrepareNativeDepthsHalf,            SPEC_NONE) \
 	\
-	COMPUTE_SHADER(GENERATE_Q0,                                    GenerateQ0,                                GENERATE) \
-	COMPUTE_SHADER(GENERATE_Q1,                                    GenerateQ1,                                GENERATE) \
-	COMPUTE_SHADER(GENERATE_Q2,                                    GenerateQ2,                                GENERATE) \
-	COMPUTE_SHADER(GENERATE_Q3,                                    GenerateQ3,                                GENERATE_ADAPTIVE) \
-	COMPUTE_SHADER(GENERATE_Q3_BASE,                               GenerateQ3Base,                            GENERATE) \
+	COMPUTE_SHADER(GENERATE_Q0,                                    GenerateQ0,                                GENERATE,                           GenerateSparse,                     SPEC_GENERATE(0, 0)) \
+	COMPUTE_SHADER(GENERATE_Q1,                                    GenerateQ1,                                GENERATE,                           GenerateSparse,                     SPEC_GENERATE(1, 0)) \
+	COMPUTE_SHADER(GENERATE_Q2,                                    GenerateQ2,                                GENERATE,                           Generate,                           SPEC_GENERATE(2, 0)) \
+	COMPUTE_SHADER(GENERATE_Q3,                                    GenerateQ3,                                GENERATE_ADAPTIVE,                  Generate,                           SPEC_GENERATE(3, 0)) \
+	COMPUTE_SHADER(GENERATE_Q3_BASE,                               GenerateQ3Base,                            GENERATE,                           Generate,                           SPEC_GENERATE(3, 1)) \
 	\
-	COMPUTE_SHADER(GENERATE_IMPORTANCE_MAP,                        GenerateImportanceMap,                     GENERATE_IMPORTANCE_MAP) \
-	COMPUTE_SHADER(POSTPROCESS_IMPORTANCE_MAP_A,                   PostprocessImportanceMapA,                 POSTPROCESS_IMPORTANCE_MAP_A) \
-	COMPUTE_SHADER(POSTPROCESS_IMPORTANCE_MAP_B,                   PostprocessImportanceMapB,                 POSTPROCESS_IMPORTANCE_MAP_B) \
+	COMPUTE_SHADER(GENERATE_IMPORTANCE_MAP,                        GenerateImportanceMap,                     GENERATE_IMPORTANCE_MAP,            GenerateImportanceMap,              SPEC_NONE) \
+	COMPUTE_SHADER(POSTPROCESS_IMPORTANCE_MAP_A,                   PostprocessImportanceMapA,                 POSTPROCESS_IMPORTANCE_MAP_A,       PostprocessImportanceMapA,          SPEC_NONE) \
+	COMPUTE_SHADER(POSTPROCESS_IMPORTANCE_MAP_B,                   PostprocessImportanceMapB,                 POSTPROCESS_IMPORTANCE_MAP_B,       PostprocessImportanceMapB,          SPEC_NONE) \
 	\
-	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_1,                          EdgeSensitiveBlur1,                        EDGE_SENSITIVE_BLUR) \
-	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_2,                          EdgeSensitiveBlur2,                        EDGE_SENSITIVE_BLUR) \
-	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_3,                          EdgeSensitiveBlur3,                        EDGE_SENSITIVE_BLUR) \
-	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_4,                          EdgeSensitiveBlur4,                        EDGE_SENSITIVE_BLUR) \
-	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_5,                          EdgeSensitiveBlur5,                        EDGE_SENSITIVE_BLUR) \
-	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_6,                          EdgeSensitiveBlur6,                        EDGE_SENSITIVE_BLUR) \
-	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_7,                          EdgeSensitiveBlur7,                        EDGE_SENSITIVE_BLUR) \
-	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_8,                          EdgeSensitiveBlur8,                        EDGE_SENSITIVE_BLUR) \
+	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_1,                          EdgeSensitiveBlur1,                        EDGE_SENSITIVE_BLUR,                EdgeSensitiveBlur,                  SPEC_BLUR(1)) \
+	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_2,                          EdgeSensitiveBlur2,                        EDGE_SENSITIVE_BLUR,                EdgeSensitiveBlur,                  SPEC_BLUR(2)) \
+	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_3,                          EdgeSensitiveBlur3,                        EDGE_SENSITIVE_BLUR,                EdgeSensitiveBlur,                  SPEC_BLUR(3)) \
+	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_4,                          EdgeSensitiveBlur4,                        EDGE_SENSITIVE_BLUR,                EdgeSensitiveBlur,                  SPEC_BLUR(4)) \
+	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_5,                          EdgeSensitiveBlur5,                        EDGE_SENSITIVE_BLUR,                EdgeSensitiveBlur,                  SPEC_BLUR(5)) \
+	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_6,                          EdgeSensitiveBlur6,                        EDGE_SENSITIVE_BLUR,                EdgeSensitiveBlur,                  SPEC_BLUR(6)) \
+	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_7,                          EdgeSensitiveBlur7,                        EDGE_SENSITIVE_BLUR,                EdgeSensitiveBlur,                  SPEC_BLUR(7)) \
+	COMPUTE_SHADER(EDGE_SENSITIVE_BLUR_8,                          EdgeSensitiveBlur8,                        EDGE_SENSITIVE_BLUR,                EdgeSensitiveBlur,                  SPEC_BLUR(8)) \
 	\
-	COMPUTE_SHADER(APPLY,                                          Apply,                                     APPLY) \
-	COMPUTE_SHADER(NON_SMART_APPLY,                                NonSmartApply,                             APPLY) \
-	COMPUTE_SHADER(NON_SMART_HALF_APPLY,                           NonSmartHalfApply,                         APPLY) \
+	COMPUTE_SHADER(APPLY,                                          Apply,                                     APPLY,                              Apply,                              SPEC_NONE) \
+	COMPUTE_SHADER(NON_SMART_APPLY,                                NonSmartApply,                             APPLY,                              NonSmartApply,                      SPEC_NONE) \
+	COMPUTE_SHADER(NON_SMART_HALF_APPLY,                           NonSmartHalfApply,                         APPLY,                              NonSmartHalfApply,                  SPEC_NONE) \
 	\
-	COMPUTE_SHADER(UPSCALE_BILATERAL_5X5_SMART,                    UpscaleBilateral5x5Smart,                  BILATERAL_UPSAMPLE) \
-	COMPUTE_SHADER(UPSCALE_BILATERAL_5X5_NON_SMART,                UpscaleBilateral5x5NonSmart,               BILATERAL_UPSAMPLE) \
-	COMPUTE_SHADER(UPSCALE_BILATERAL_5X5_HALF,                     UpscaleBilateral5x5Half,                   BILATERAL_UPSAMPLE)
+	COMPUTE_SHADER(UPSCALE_BILATERAL_5X5_SMART,                    UpscaleBilateral5x5Smart,                  BILATERAL_UPSAMPLE,                 UpscaleBilateral5x5Smart,           SPEC_NONE) \
+	COMPUTE_SHADER(UPSCALE_BILATERAL_5X5_NON_SMART,                UpscaleBilateral5x5NonSmart,               BILATERAL_UPSAMPLE,                 UpscaleBilateral5x5NonSmart,        SPEC_NONE) \
+	COMPUTE_SHADER(UPSCALE_BILATERAL_5X5_HALF,                     UpscaleBilateral5x5Half,                   BILATERAL_UPSAMPLE,                 UpscaleBilateral5x5Half,            SPEC_NONE)
 
 typedef enum ComputeShaderID {
-#define COMPUTE_SHADER(name, _pascal_name, _descriptor_set) CS_##name,
+#define COMPUTE_SHADER(name, _pascal_name, _descriptor_set, _spirv_module, _spirv_specialization) CS_##name,
 	COMPUTE_SHADERS
 #undef COMPUTE_SHADER
 	NUM_COMPUTE_SHADERS
@@ -669,44 +582,203 @@ typedef struct ComputeShaderMetaData {
 	const char            *rootSignatureName;
 } ComputeShaderMetaData;
 
-typedef struct ComputeShaderSPIRV {
-	const uint32_t *spirv;
-	size_t          len;
-} ComputeShaderSPIRV;
+typedef struct CompressedComputeShader {
+	const uint8_t  *archive; ///< compressed archive holding the module
+	const uint32_t *module;  ///< offset in the archive, compressed size and size of the module, in bytes
+} CompressedComputeShader;
 
-typedef struct ComputeShaderDXIL {
-	const void *dxil;
-	size_t      len;
-} ComputeShaderDXIL;
+typedef struct ComputeShaderSpecialization {
+	FFX_CACAO_Bool specialized;  ///< whether the SPIR-V module of the shader has specialization constants
+	uint32_t       blurPasses;   ///< value of FFX_CACAO_SPEC_CONSTANT_BLUR_PASSES
+	int32_t        qualityLevel; ///< value of FFX_CACAO_SPEC_CONSTANT_QUALITY_LEVEL
+	uint32_t       adaptiveBase; ///< value of FFX_CACAO_SPEC_CONSTANT_ADAPTIVE_BASE, 32 bit as boolean specialization constants are
+} ComputeShaderSpecialization;
 
 #ifdef FFX_CACAO_ENABLE_VULKAN
-static const ComputeShaderSPIRV COMPUTE_SHADER_SPIRV_32[] = {
-#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout) { (uint32_t*)CS##pascal_name##SPIRV32, FFX_CACAO_ARRAY_SIZE(CS##pascal_name##SPIRV32) },
+static const CompressedComputeShader COMPUTE_SHADER_SPIRV_32[] = {
+#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout, spirv_module, spirv_specialization) { CACAOShadersSPIRV32, CS##spirv_module##SPIRV32 },
+	COMPUTE_SHADERS
+#undef COMPUTE_SHADER
+};
+
+static const CompressedComputeShader COMPUTE_SHADER_SPIRV_16[] = {
+#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout, spirv_module, spirv_specialization) { CACAOShadersSPIRV16, CS##spirv_module##SPIRV16 },
+	COMPUTE_SHADERS
+#undef COMPUTE_SHADER
+};
+
+#define SPEC_NONE                                   { FFX_CACAO_FALSE, 0, 0, 0 }
+#define SPEC_BLUR(blur_passes)                      { FFX_CACAO_TRUE, blur_passes, 0, 0 }
+#define SPEC_GENERATE(quality_level, adaptive_base) { FFX_CACAO_TRUE, 1, quality_level, adaptive_base }
+
+static const ComputeShaderSpecialization COMPUTE_SHADER_SPECIALIZATION[] = {
+#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout, spirv_module, spirv_specialization) spirv_specialization,
 	COMPUTE_SHADERS
 #undef COMPUTE_SHADER
 };
 
-static const ComputeShaderSPIRV COMPUTE_SHADER_SPIRV_16[] = {
-#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout) { (uint32_t*)CS##pascal_name##SPIRV16, FFX_CACAO_ARRAY_SIZE(CS##pascal_name##SPIRV16) },
+#undef SPEC_NONE
+#undef SPEC_BLUR
+#undef SPEC_GENERATE
+
+static const char *COMPUTE_SHADER_SPIRV_ENTRY_POINT[] = {
+#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout, spirv_module, spirv_specialization) "FFX_CACAO_"#spirv_module,
 	COMPUTE_SHADERS
 #undef COMPUTE_SHADER
 };
 #endif
 
 #ifdef FFX_CACAO_ENABLE_D3D12
-static const ComputeShaderDXIL COMPUTE_SHADER_DXIL[] = {
-#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout) { CS##pascal_name##DXIL, sizeof(CS##pascal_name##DXIL) },
+static const CompressedComputeShader COMPUTE_SHADER_DXIL[] = {
+#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout, spirv_module, spirv_specialization) { CACAOShadersDXIL, CS##pascal_name##DXIL },
 	COMPUTE_SHADERS
 #undef COMPUTE_SHADER
 };
 #endif
 
+#if defined(FFX_CACAO_ENABLE_VULKAN) || defined(FFX_CACAO_ENABLE_D3D12)
+// buffer into which the shader modules are decompressed, reused for the pipelines created by one thread
+typedef struct ShaderScratch {
+	uint32_t *data;
+	size_t    size;
+} ShaderScratch;
+
+static void shaderScratchDestroy(ShaderScratch* scratch)
+{
+	free(scratch->data);
+	scratch->data = NULL;
+	scratch->size = 0;
+}
+
+// decompresses a module into the scratch buffer, growing it as needed
+static FFX_CACAO_Status shaderScratchDecompress(ShaderScratch* scratch, CompressedComputeShader shader)
+{
+	uint32_t moduleOffset = shader.module[0];
+	uint32_t compressedSize = shader.module[1];
+	uint32_t moduleSize = shader.module[2];
+	if (scratch->size < moduleSize)
+	{
+		uint32_t *data = (uint32_t*)malloc(moduleSize);
+		if (!data)
+		{
+			return FFX_CACAO_STATUS_OUT_OF_MEMORY;
+		}
+		free(scratch->data);
+		scratch->data = data;
+		scratch->size = moduleSize;
+	}
+	if (!decompressShader(shader.archive + moduleOffset, compressedSize, (uint8_t*)scratch->data, moduleSize))
+	{
+		return FFX_CACAO_STATUS_FAILED;
+	}
+	return FFX_CACAO_STATUS_OK;
+}
+#endif
+
 static const ComputeShaderMetaData COMPUTE_SHADER_META_DATA[] = {
-#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout) { "FFX_CACAO_"#pascal_name, DSL_##descriptor_set_layout, "FFX_CACAO_CS_"#name, "FFX_CACAO_RS_"#name },
+#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout, spirv_module, spirv_specialization) { "FFX_CACAO_"#pascal_name, DSL_##descriptor_set_layout, "FFX_CACAO_CS_"#name, "FFX_CACAO_RS_"#name },
 	COMPUTE_SHADERS
 #undef COMPUTE_SHADER
 };
 
+// =================================================================================
+// Constants cache
+// =================================================================================
+
+// the constants are split by what they depend on, so that Draw only recomputes the parts invalidated since the previous frame
+#define CONSTANTS_DIRTY_SETTINGS   0x1
+#define CONSTANTS_DIRTY_SIZE       0x2
+#define CONSTANTS_DIRTY_PROJECTION 0x4
+#define CONSTANTS_DIRTY_ALL        (CONSTANTS_DIRTY_SETTINGS | CONSTANTS_DIRTY_SIZE | CONSTANTS_DIRTY_PROJECTION)
+
+typedef struct ConstantsCache {
+	FFX_CACAO_Constants constants[4]; ///< constants of each of the 4 passes
+	FFX_CACAO_Matrix4x4 proj;
+	FFX_CACAO_Matrix4x4 normalsToView;
+	FFX_CACAO_BufferSizeInfo renderArea; ///< buffer size info of the render area the constants are for
+	uint32_t            dirty;        ///< CONSTANTS_DIRTY_ flags of the parts to recompute
+	uint32_t            version;      ///< incremented whenever the constants change, for backends keeping copies of them
+} ConstantsCache;
+
+static inline void constantsCacheInit(ConstantsCache* cache)
+{
+	memset(cache, 0, sizeof(*cache));
+	cache->dirty = CONSTANTS_DIRTY_ALL;
+}
+
+static inline void constantsCacheInvalidate(ConstantsCache* cache, uint32_t dirty)
+{
+	cache->dirty |= dirty;
+}
+
+// recomputes the parts of the constants invalidated by a change of settings, size, render area or matrices and returns their
+// flags, renderArea being NULL when the whole of the resources is drawn, and inputSizeInfo NULL when the depth input is the
+// size of the resources rather than smaller, which is only the case over a render area
+static inline uint32_t constantsCacheUpdate(ConstantsCache* cache, const FFX_CACAO_Settings* settings, const FFX_CACAO_BufferSizeInfo* bsi, const FFX_CACAO_BufferSizeInfo* renderArea, const FFX_CACAO_BufferSizeInfo* inputSizeInfo, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView)
+{
+	uint32_t dirty = cache->dirty;
+	if (renderArea == NULL)
+	{
+		renderArea = bsi;
+	}
+	if (memcmp(&cache->renderArea, renderArea, sizeof(*renderArea)) != 0)
+	{
+		dirty |= CONSTANTS_DIRTY_SIZE;
+	}
+	if (memcmp(&cache->proj, proj, sizeof(*proj)) != 0)
+	{
+		dirty |= CONSTANTS_DIRTY_PROJECTION;
+	}
+	// the normals matrix is ignored by UpdateProjectionConstants when normals are generated
+	if (!settings->generateNormals && memcmp(&cache->normalsToView, normalsToView, sizeof(*normalsToView)) != 0)
+	{
+		dirty |= CONSTANTS_DIRTY_PROJECTION;
+	}
+	if (!dirty)
+	{
+		return 0;
+	}
+
+	for (int i = 0; i < 4; ++i)
+	{
+		FFX_CACAO_Constants *consts = &cache->constants[i];
+		if (dirty & CONSTANTS_DIRTY_SETTINGS)
+		{
+			FFX_CACAO_UpdateSettingsConstants(consts, settings);
+		}
+		if (dirty & CONSTANTS_DIRTY_SIZE)
+		{
+			FFX_CACAO_UpdateSizeConstants(consts, bsi);
+		}
+		// the projection part also depends on the settings and sizes
+		FFX_CACAO_UpdateProjectionConstants(consts, settings, bsi, proj, normalsToView);
+		if (renderArea != bsi)
+		{
+			FFX_CACAO_UpdateRenderAreaConstants(consts, bsi, renderArea);
+		}
+		// the depth input is only sampled by the prepare passes, with coordinates normalised to its size
+		if (inputSizeInfo != NULL)
+		{
+			consts->DepthBufferInverseDimensions[0] = 1.0f / (float)inputSizeInfo->depthBufferWidth;
+			consts->DepthBufferInverseDimensions[1] = 1.0f / (float)inputSizeInfo->depthBufferHeight;
+		}
+		if (dirty & (CONSTANTS_DIRTY_SETTINGS | CONSTANTS_DIRTY_SIZE))
+		{
+			FFX_CACAO_UpdatePerPassConstants(consts, settings, bsi, i);
+		}
+	}
+
+	cache->proj = *proj;
+	cache->renderArea = *renderArea;
+	if (!settings->generateNormals)
+	{
+		cache->normalsToView = *normalsToView;
+	}
+	cache->dirty = 0;
+	++cache->version;
+	return dirty;
+}
+
 
 // =================================================================================
 // DirectX 12
@@ -1250,6 +1322,7 @@ struct FFX_CACAO_D3D12Context {
 #endif
 
 	ConstantBufferRing constantBufferRing;
+	ConstantsCache     constantsCache;
 	FFX_CACAO_BufferSizeInfo     bufferSizeInfo;
 	ID3D12Resource    *outputResource;
 
@@ -1282,14 +1355,275 @@ static inline FFX_CACAO_D3D12Context* getAlignedD3D12ContextPointer(FFX_CACAO_D3
 
 #define MAX_DESCRIPTOR_BINDINGS 32
 
+// the phases of a draw, separated by pipeline barriers
+typedef enum DrawPhaseID {
+	DRAW_PHASE_PREPARE,
+	DRAW_PHASE_BASE,
+	DRAW_PHASE_GENERATE,
+	DRAW_PHASE_BLUR,
+	DRAW_PHASE_APPLY,
+	NUM_DRAW_PHASES
+} DrawPhaseID;
+
+// the phases between the first and last use of a texture in a draw, firstPhase is NUM_DRAW_PHASES for unused textures
+typedef struct TextureLifetime {
+	uint32_t firstPhase;
+	uint32_t lastPhase;
+} TextureLifetime;
+
+#define MAX_PHASE_DESCRIPTOR_SETS 8
+
+static uint32_t getDrawPhaseDescriptorSets(const FFX_CACAO_Settings* settings, FFX_CACAO_Bool useDownsampledSsao, DrawPhaseID phase, DescriptorSetID descriptorSets[MAX_PHASE_DESCRIPTOR_SETS])
+{
+	uint32_t numDescriptorSets = 0;
+	FFX_CACAO_Bool highest = settings->qualityLevel == FFX_CACAO_QUALITY_HIGHEST;
+	FFX_CACAO_Bool blurred = settings->blurPassCount > 0;
+	switch (phase)
+	{
+	case DRAW_PHASE_PREPARE:
+		descriptorSets[numDescriptorSets++] = DS_CLEAR_LOAD_COUNTER;
+		descriptorSets[numDescriptorSets++] = settings->qualityLevel <= FFX_CACAO_QUALITY_LOW ? DS_PREPARE_DEPTHS : DS_PREPARE_DEPTHS_MIPS;
+		descriptorSets[numDescriptorSets++] = settings->generateNormals ? DS_PREPARE_NORMALS : DS_PREPARE_NORMALS_FROM_INPUT_NORMALS;
+		break;
+	case DRAW_PHASE_BASE:
+		if (highest)
+		{
+			for (uint32_t pass = 0; pass < 4; ++pass)
+			{
+				descriptorSets[numDescriptorSets++] = (DescriptorSetID)(DS_GENERATE_ADAPTIVE_BASE_0 + pass);
+			}
+			descriptorSets[numDescriptorSets++] = DS_GENERATE_IMPORTANCE_MAP;
+			descriptorSets[numDescriptorSets++] = DS_POSTPROCESS_IMPORTANCE_MAP_A;
+			descriptorSets[numDescriptorSets++] = DS_POSTPROCESS_IMPORTANCE_MAP_B;
+		}
+		break;
+	case DRAW_PHASE_GENERATE:
+	case DRAW_PHASE_BLUR:
+		if (phase == DRAW_PHASE_GENERATE || blurred)
+		{
+			for (uint32_t pass = 0; pass < 4; ++pass)
+			{
+				if (settings->qualityLevel == FFX_CACAO_QUALITY_LOWEST && (pass == 1 || pass == 2))
+				{
+					continue;
+				}
+				DescriptorSetID first = phase == DRAW_PHASE_BLUR ? DS_EDGE_SENSITIVE_BLUR_0 : highest ? DS_GENERATE_ADAPTIVE_0 : DS_GENERATE_0;
+				descriptorSets[numDescriptorSets++] = (DescriptorSetID)(first + pass);
+			}
+		}
+		break;
+	case DRAW_PHASE_APPLY:
+		if (useDownsampledSsao)
+		{
+			descriptorSets[numDescriptorSets++] = blurred ? DS_BILATERAL_UPSAMPLE_PONG : DS_BILATERAL_UPSAMPLE_PING;
+		}
+		else
+		{
+			descriptorSets[numDescriptorSets++] = blurred ? DS_APPLY_PONG : DS_APPLY_PING;
+		}
+		break;
+	default:
+		break;
+	}
+	return numDescriptorSets;
+}
+
+#define MAX_DRAW_COMPUTE_SHADERS 12
+
+// the compute shaders dispatched by a draw with the given settings, in the order of the draw
+static uint32_t getDrawComputeShaders(const FFX_CACAO_Settings* settings, FFX_CACAO_Bool useDownsampledSsao, ComputeShaderID computeShaders[MAX_DRAW_COMPUTE_SHADERS])
+{
+	uint32_t numComputeShaders = 0;
+	uint32_t blurPassCount = FFX_CACAO_CLAMP(settings->blurPassCount, 0, MAX_BLUR_PASSES);
+
+	computeShaders[numComputeShaders++] = CS_CLEAR_LOAD_COUNTER;
+	switch (settings->qualityLevel)
+	{
+	case FFX_CACAO_QUALITY_LOWEST:
+		computeShaders[numComputeShaders++] = useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS_HALF : CS_PREPARE_NATIVE_DEPTHS_HALF;
+		break;
+	case FFX_CACAO_QUALITY_LOW:
+		computeShaders[numComputeShaders++] = useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS : CS_PREPARE_NATIVE_DEPTHS;
+		break;
+	default:
+		computeShaders[numComputeShaders++] = useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS_AND_MIPS : CS_PREPARE_NATIVE_DEPTHS_AND_MIPS;
+		break;
+	}
+	if (settings->generateNormals)
+	{
+		computeShaders[numComputeShaders++] = useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_NORMALS : CS_PREPARE_NATIVE_NORMALS;
+	}
+	else
+	{
+		computeShaders[numComputeShaders++] = useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_NORMALS_FROM_INPUT_NORMALS : CS_PREPARE_NATIVE_NORMALS_FROM_INPUT_NORMALS;
+	}
+
+	if (settings->qualityLevel == FFX_CACAO_QUALITY_HIGHEST)
+	{
+		computeShaders[numComputeShaders++] = CS_GENERATE_Q3_BASE;
+		computeShaders[numComputeShaders++] = CS_GENERATE_IMPORTANCE_MAP;
+		computeShaders[numComputeShaders++] = CS_POSTPROCESS_IMPORTANCE_MAP_A;
+		computeShaders[numComputeShaders++] = CS_POSTPROCESS_IMPORTANCE_MAP_B;
+	}
+
+	computeShaders[numComputeShaders++] = (ComputeShaderID)(CS_GENERATE_Q0 + FFX_CACAO_MAX(0, settings->qualityLevel - 1));
+
+	if (blurPassCount)
+	{
+		computeShaders[numComputeShaders++] = (ComputeShaderID)(CS_EDGE_SENSITIVE_BLUR_1 + blurPassCount - 1);
+	}
+
+	if (useDownsampledSsao)
+	{
+		switch (settings->qualityLevel)
+		{
+		case FFX_CACAO_QUALITY_LOWEST:
+			computeShaders[numComputeShaders++] = CS_UPSCALE_BILATERAL_5X5_HALF;
+			break;
+		case FFX_CACAO_QUALITY_LOW:
+		case FFX_CACAO_QUALITY_MEDIUM:
+			computeShaders[numComputeShaders++] = CS_UPSCALE_BILATERAL_5X5_NON_SMART;
+			break;
+		default:
+			computeShaders[numComputeShaders++] = CS_UPSCALE_BILATERAL_5X5_SMART;
+			break;
+		}
+	}
+	else
+	{
+		switch (settings->qualityLevel)
+		{
+		case FFX_CACAO_QUALITY_LOWEST:
+			computeShaders[numComputeShaders++] = CS_NON_SMART_HALF_APPLY;
+			break;
+		case FFX_CACAO_QUALITY_LOW:
+			computeShaders[numComputeShaders++] = CS_NON_SMART_APPLY;
+			break;
+		default:
+			computeShaders[numComputeShaders++] = CS_APPLY;
+			break;
+		}
+	}
+
+	FFX_CACAO_ASSERT(numComputeShaders <= MAX_DRAW_COMPUTE_SHADERS);
+	return numComputeShaders;
+}
+
+static inline void markTextureUse(TextureLifetime* lifetime, uint32_t phase)
+{
+	lifetime->firstPhase = FFX_CACAO_MIN(lifetime->firstPhase, phase);
+	lifetime->lastPhase = FFX_CACAO_MAX(lifetime->lastPhase, phase);
+}
+
+// derives the lifetime of every texture from the descriptor sets a draw with the given settings dispatches
+static void getTextureLifetimes(const FFX_CACAO_Settings* settings, FFX_CACAO_Bool useDownsampledSsao, TextureLifetime lifetimes[NUM_TEXTURES])
+{
+	for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+	{
+		lifetimes[i].firstPhase = NUM_DRAW_PHASES;
+		lifetimes[i].lastPhase = 0;
+	}
+
+	for (uint32_t phase = 0; phase < NUM_DRAW_PHASES; ++phase)
+	{
+		DescriptorSetID descriptorSets[MAX_PHASE_DESCRIPTOR_SETS];
+		uint32_t numDescriptorSets = getDrawPhaseDescriptorSets(settings, useDownsampledSsao, (DrawPhaseID)phase, descriptorSets);
+		for (uint32_t j = 0; j < numDescriptorSets; ++j)
+		{
+			for (uint32_t k = 0; k < NUM_INPUT_DESCRIPTOR_BINDINGS; ++k)
+			{
+				if (INPUT_DESCRIPTOR_BINDING_META_DATA[k].descriptorID == descriptorSets[j])
+				{
+					markTextureUse(&lifetimes[SRV_META_DATA[INPUT_DESCRIPTOR_BINDING_META_DATA[k].srvID].texture], phase);
+				}
+			}
+			for (uint32_t k = 0; k < NUM_OUTPUT_DESCRIPTOR_BINDINGS; ++k)
+			{
+				if (OUTPUT_DESCRIPTOR_BINDING_META_DATA[k].descriptorID == descriptorSets[j])
+				{
+					markTextureUse(&lifetimes[UAV_META_DATA[OUTPUT_DESCRIPTOR_BINDING_META_DATA[k].uavID].textureID], phase);
+				}
+			}
+		}
+	}
+}
+
+// bit j of conflicts[i] is set if textures i and j are live in the same phase of a draw with any of the settings a context may use
+static void getTextureConflicts(FFX_CACAO_Bool useDownsampledSsao, FFX_CACAO_Bool disableHighestQuality, uint32_t conflicts[NUM_TEXTURES])
+{
+	memset(conflicts, 0, NUM_TEXTURES * sizeof(*conflicts));
+
+	FFX_CACAO_Quality maxQualityLevel = disableHighestQuality ? FFX_CACAO_QUALITY_HIGH : FFX_CACAO_QUALITY_HIGHEST;
+	for (uint32_t variant = 0; variant < (maxQualityLevel + 1u) * 4; ++variant)
+	{
+		FFX_CACAO_Settings settings = FFX_CACAO_DEFAULT_SETTINGS;
+		settings.qualityLevel = (FFX_CACAO_Quality)(variant / 4);
+		settings.blurPassCount = variant & 1;
+		settings.generateNormals = variant & 2 ? FFX_CACAO_TRUE : FFX_CACAO_FALSE;
+
+		TextureLifetime lifetimes[NUM_TEXTURES];
+		getTextureLifetimes(&settings, useDownsampledSsao, lifetimes);
+		for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+		{
+			for (uint32_t j = 0; j < NUM_TEXTURES; ++j)
+			{
+				if (lifetimes[i].firstPhase <= lifetimes[j].lastPhase && lifetimes[j].firstPhase <= lifetimes[i].lastPhase)
+				{
+					conflicts[i] |= 1u << j;
+				}
+			}
+		}
+	}
+}
+
 
 
-#define NUM_BACK_BUFFERS 3
+#define DEFAULT_FRAMES_IN_FLIGHT 3
 #define NUM_SAMPLERS 5
+#define MAX_PIPELINE_WORKERS 4
+
+// creation state of a pipeline, pipelines are created when queued for a worker thread or first needed by a draw
+typedef enum PipelineState {
+	PIPELINE_STATE_NONE,
+	PIPELINE_STATE_QUEUED,
+	PIPELINE_STATE_CREATING,
+	PIPELINE_STATE_READY,
+	PIPELINE_STATE_FAILED,
+} PipelineState;
+
+struct FFX_CACAO_VkDeviceObjects {
+	std::atomic<uint32_t> refCount;         ///< one reference for the creator and one for each context using the objects
+
+	VkPhysicalDevice                 physicalDevice;
+	VkDevice                         device;
+	FFX_CACAO_VkCreateFlags          flags;
+	PFN_vkCmdDebugMarkerBeginEXT     vkCmdDebugMarkerBegin;
+	PFN_vkCmdDebugMarkerEndEXT       vkCmdDebugMarkerEnd;
+	PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectName;
+
+	VkSampler             samplers[NUM_SAMPLERS];
+
+	VkDescriptorSetLayout descriptorSetLayouts[NUM_DESCRIPTOR_SET_LAYOUTS];
+	VkPipelineLayout      pipelineLayouts[NUM_DESCRIPTOR_SET_LAYOUTS];
+
+	FFX_CACAO_Bool        use16Bit;
+	VkPipelineCache       pipelineCache;
+	VkPipeline            computePipelines[NUM_COMPUTE_SHADERS]; ///< valid once the state of the pipeline is PIPELINE_STATE_READY
+
+	std::atomic<uint32_t>   pipelineStates[NUM_COMPUTE_SHADERS]; ///< PipelineState of each pipeline, changed under pipelineMutex
+	std::mutex              pipelineMutex;
+	std::condition_variable pipelineCondition;  ///< signalled when a pipeline is queued or finished, or the workers are to stop
+	uint32_t                numQueuedPipelines;
+	std::thread             pipelineWorkers[MAX_PIPELINE_WORKERS]; ///< threads creating queued pipelines in the background, started by the first queued pipeline
+	uint32_t                numPipelineWorkers;
+	bool                    stopPipelineWorkers;
+};
+
 typedef struct FFX_CACAO_VkContext {
 	FFX_CACAO_Settings   settings;
 	FFX_CACAO_Bool       useDownsampledSsao;
-	FFX_CACAO_BufferSizeInfo     bufferSizeInfo;
+	FFX_CACAO_BufferSizeInfo     bufferSizeInfo;   ///< size of the textures, the largest screen size since they were created
+	FFX_CACAO_BufferSizeInfo     screenSizeInfo;   ///< size of the inputs and output, no larger than bufferSizeInfo
 
 #ifdef FFX_CACAO_ENABLE_PROFILING
 	VkQueryPool timestampQueryPool;
@@ -1298,7 +1632,7 @@ typedef struct FFX_CACAO_VkContext {
 		TimestampID timestamps[NUM_TIMESTAMPS];
 		uint64_t    timings[NUM_TIMESTAMPS];
 		uint32_t    numTimestamps;
-	} timestampQueries[NUM_BACK_BUFFERS];
+	} timestampQueries[FFX_CACAO_VK_MAX_FRAMES_IN_FLIGHT];
 #endif
 
 	VkPhysicalDevice                 physicalDevice;
@@ -1307,32 +1641,44 @@ typedef struct FFX_CACAO_VkContext {
 	PFN_vkCmdDebugMarkerEndEXT       vkCmdDebugMarkerEnd;
 	PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectName;
 
+	FFX_CACAO_VkDeviceObjects *deviceObjects; ///< shaders and pipelines, possibly shared with other contexts, the context holds a reference
 
-	VkDescriptorSetLayout descriptorSetLayouts[NUM_DESCRIPTOR_SET_LAYOUTS];
-	VkPipelineLayout      pipelineLayouts[NUM_DESCRIPTOR_SET_LAYOUTS];
-
-	VkShaderModule        computeShaders[NUM_COMPUTE_SHADERS];
-	VkPipeline            computePipelines[NUM_COMPUTE_SHADERS];
-
-	VkDescriptorSet       descriptorSets[NUM_BACK_BUFFERS][NUM_DESCRIPTOR_SETS];
+	VkDescriptorSet       descriptorSets[NUM_DESCRIPTOR_SETS];
 	VkDescriptorPool      descriptorPool;
 
-	VkSampler      samplers[NUM_SAMPLERS];
-
 	VkImage        textures[NUM_TEXTURES];
-	VkDeviceMemory textureMemory[NUM_TEXTURES];
 	VkImageView    shaderResourceViews[NUM_SHADER_RESOURCE_VIEWS];
 	VkImageView    unorderedAccessViews[NUM_UNORDERED_ACCESS_VIEWS];
 
 	VkImage        loadCounter;
-	VkDeviceMemory loadCounterMemory;
 	VkImageView    loadCounterView;
 
+	FFX_CACAO_VkMemoryAllocator memoryAllocator; ///< external allocator of the arena, allocateMemory is NULL if none was provided
+	VkDeviceMemory arenaMemory;            ///< memory of the single allocation holding textures and loadCounter
+	VkDeviceSize   arenaOffset;            ///< offset of the arena in arenaMemory, nonzero only for memory from memoryAllocator
+	VkDeviceSize   arenaSize;              ///< size of the arena, the largest peak footprint of the textures since it was allocated
+	VkDeviceSize   arenaAlignment;         ///< alignment the arena was allocated with
+	uint32_t       arenaMemoryTypeBits;    ///< memory types the arena may be of, a single one unless from memoryAllocator
+	VkDeviceSize   arenaUsedSize;          ///< peak footprint of the textures at the current size, with those of disjoint lifetimes sharing memory
+	VkDeviceSize   unaliasedArenaSize;     ///< size the arena would have if no textures shared memory
+	FFX_CACAO_Bool disableHighestQuality;
+	TextureLifetime textureLifetimes[NUM_TEXTURES]; ///< lifetimes for the current settings, a texture is transitioned from undefined contents before its first phase
+
 	VkImage        output;
+	uint32_t       outputArrayLayer;       ///< the layer of output written, the only one transitioned by a draw
+
+	uint32_t       nextPhase;              ///< the FFX_CACAO_VkPhase which may be recorded next, FFX_CACAO_VK_PHASE_PREPARE unless a draw recorded in phases is incomplete
+	FFX_CACAO_BufferSizeInfo phaseSizeInfo;       ///< size covered by the passes writing intermediate textures in the draw being recorded in phases
+	FFX_CACAO_BufferSizeInfo phaseOutputSizeInfo; ///< size covered by the passes writing the output in the draw being recorded in phases
 
+	uint32_t       numFramesInFlight;
 	uint32_t       currentConstantBuffer;
-	VkBuffer       constantBuffer[NUM_BACK_BUFFERS][4];
-	VkDeviceMemory constantBufferMemory[NUM_BACK_BUFFERS][4];
+	VkBuffer       constantBuffer;         ///< ring of numFramesInFlight frames of 4 per pass constant blocks
+	VkDeviceMemory constantBufferMemory;
+	uint8_t       *constantBufferData;     ///< persistent mapping of constantBuffer
+	VkDeviceSize   constantBufferStride;   ///< size of a block, aligned for use as a dynamic offset
+	ConstantsCache constantsCache;
+	uint32_t       constantBufferVersion[FFX_CACAO_VK_MAX_FRAMES_IN_FLIGHT]; ///< version of constantsCache last written to the blocks of each frame
 } FFX_CACAO_VkContext;
 
 static inline FFX_CACAO_VkContext* getAlignedVkContextPointer(FFX_CACAO_VkContext* ptr)
@@ -1343,2194 +1689,8751 @@ static inline FFX_CACAO_VkContext* getAlignedVkContextPointer(FFX_CACAO_VkContex
 }
 #endif
 
-// =================================================================================
-// Interface
-// =================================================================================
+#ifdef FFX_CACAO_ENABLE_CPU
+// =================================================================================================
+// CACAO cpu implementation
+// =================================================================================================
 
-#ifdef __cplusplus
-extern "C"
-{
-#endif
+#define CPU_MAX_TEXTURE_MIPS 4
+#define CPU_MAX_DESCRIPTOR_BINDINGS 8
 
-#ifdef FFX_CACAO_ENABLE_D3D12
-size_t FFX_CACAO_D3D12GetContextSize()
-{
-	return sizeof(FFX_CACAO_D3D12Context) + alignof(FFX_CACAO_D3D12Context) - 1;
-}
+// emulation of the texture resources, views and samplers used by the shaders in ffx_cacao.hlsl
 
-FFX_CACAO_Status FFX_CACAO_D3D12InitContext(FFX_CACAO_D3D12Context* context, ID3D12Device* device)
+typedef struct CpuFloat3 {
+	float x, y, z;
+} CpuFloat3;
+
+typedef struct CpuFloat4 {
+	float x, y, z, w;
+} CpuFloat4;
+
+typedef struct CpuTexture {
+	uint8_t        *data;
+	TextureFormatID format;
+	uint32_t        texelSize;
+	uint32_t        arraySize;
+	uint32_t        numMips;
+	uint32_t        widths[CPU_MAX_TEXTURE_MIPS];
+	uint32_t        heights[CPU_MAX_TEXTURE_MIPS];
+	size_t          rowPitches[CPU_MAX_TEXTURE_MIPS];
+	size_t          mipOffsets[CPU_MAX_TEXTURE_MIPS];
+	size_t          slicePitch;
+} CpuTexture;
+
+typedef struct CpuImageView {
+	CpuTexture *texture;
+	uint32_t    mostDetailedMip;
+	uint32_t    mipLevels;
+	uint32_t    firstArraySlice;
+	uint32_t    arraySize;
+} CpuImageView;
+
+typedef struct CpuDescriptorSet {
+	const FFX_CACAO_Constants *constants;
+	CpuImageView               inputs[CPU_MAX_DESCRIPTOR_BINDINGS];
+	CpuImageView               outputs[CPU_MAX_DESCRIPTOR_BINDINGS];
+} CpuDescriptorSet;
+
+// the cpu blurs tiles larger than the thread groups of FFX_CACAO_EdgeSensitiveBlur, so that less of a tile is spent on
+// the halo. the ping pong buffers have a border of zeros, the left one is 8 texels wide to keep rows aligned for SIMD
+#define CPU_BLUR_TILE_WIDTH   128
+#define CPU_BLUR_TILE_HEIGHT  64
+#define CPU_BLUR_ARRAY_BORDER 8
+#define CPU_BLUR_ARRAY_WIDTH  (CPU_BLUR_TILE_WIDTH + 2 * CPU_BLUR_ARRAY_BORDER)
+#define CPU_BLUR_ARRAY_HEIGHT (CPU_BLUR_TILE_HEIGHT + 2)
+
+#define CPU_PREPARE_DEPTHS_STRIPE_HEIGHT FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT
+#define CPU_PREPARE_DEPTHS_BLOCK_WIDTH   32
+
+// the cpu upscales rows of 32 quads, four times as wide as the thread groups of FFX_CACAO_BilateralUpscaleNxN, so that
+// less of the buffer is spent on the halo. the shader allocates 4 more rows of groupshared memory than it reads
+#define CPU_BILATERAL_UPSCALE_WIDTH         32
+#define CPU_BILATERAL_UPSCALE_HEIGHT        FFX_CACAO_BILATERAL_UPSCALE_HEIGHT
+#define CPU_BILATERAL_UPSCALE_BUFFER_WIDTH  (CPU_BILATERAL_UPSCALE_WIDTH  + 4)
+#define CPU_BILATERAL_UPSCALE_BUFFER_HEIGHT (CPU_BILATERAL_UPSCALE_HEIGHT + 4)
+
+// the cpu generates and postprocesses the importance map in one pass over tiles. each postprocess pass reads
+// CPU_IMPORTANCE_MAP_HALO texels around the texels it writes, so the generated values cover twice that halo
+#define CPU_IMPORTANCE_MAP_TILE_WIDTH  64
+#define CPU_IMPORTANCE_MAP_TILE_HEIGHT 32
+#define CPU_IMPORTANCE_MAP_HALO        2
+
+// a tile of the edge sensitive blur, see the blur kernels
+typedef struct CpuBlurTile {
+	alignas(32) uint16_t front[CPU_BLUR_ARRAY_HEIGHT][CPU_BLUR_ARRAY_WIDTH]; ///< s_FFX_CACAO_BlurF16Front_4, f16 values
+	alignas(32) uint16_t back[CPU_BLUR_ARRAY_HEIGHT][CPU_BLUR_ARRAY_WIDTH];  ///< s_FFX_CACAO_BlurF16Back_4, f16 values
+	alignas(32) uint8_t  ssao[CPU_BLUR_TILE_HEIGHT][CPU_BLUR_TILE_WIDTH];    ///< the unorm8 ssao values read from the input, replaced by the blurred values
+	alignas(32) uint8_t  edges[CPU_BLUR_TILE_HEIGHT][CPU_BLUR_TILE_WIDTH];   ///< the unorm8 packed edges read from the input
+	alignas(32) uint8_t  packedEdges[CPU_BLUR_TILE_HEIGHT][CPU_BLUR_TILE_WIDTH]; ///< the edges each blur thread keeps in registers, as FFX_CACAO_UnpackEdges sees them
+} CpuBlurTile;
+
+// a thread group of the bilateral upscale, see the bilateral upscale kernels
+typedef struct CpuBilateralUpscaleTile {
+	alignas(32) float depths[CPU_BILATERAL_UPSCALE_BUFFER_HEIGHT][CPU_BILATERAL_UPSCALE_BUFFER_WIDTH];   ///< s_FFX_CACAO_BilateralUpscaleBuffer packedDepths
+	alignas(32) float ssaoVals[CPU_BILATERAL_UPSCALE_BUFFER_HEIGHT][CPU_BILATERAL_UPSCALE_BUFFER_WIDTH]; ///< s_FFX_CACAO_BilateralUpscaleBuffer packedSsaoVals
+	alignas(32) float viewDepths[4][CPU_BILATERAL_UPSCALE_HEIGHT][CPU_BILATERAL_UPSCALE_WIDTH];          ///< view space depths of the 4 output pixels of each thread
+	alignas(32) float outputs[4][CPU_BILATERAL_UPSCALE_HEIGHT][CPU_BILATERAL_UPSCALE_WIDTH];             ///< the upscaled ssao of the 4 output pixels of each thread
+	float             spatialExponents[25][4];                                                           ///< log2 of wx1 and wx2 of each tap of the 5x5 filter for each output pixel
+} CpuBilateralUpscaleTile;
+
+// a tile of the importance map, see cpuGenerateImportanceMap
+typedef struct CpuImportanceMapTile {
+	uint8_t  generated[CPU_IMPORTANCE_MAP_TILE_HEIGHT + 4 * CPU_IMPORTANCE_MAP_HALO][CPU_IMPORTANCE_MAP_TILE_WIDTH + 4 * CPU_IMPORTANCE_MAP_HALO];      ///< unorm8 output of FFX_CACAO_GenerateImportanceMap
+	uint8_t  postprocessedA[CPU_IMPORTANCE_MAP_TILE_HEIGHT + 2 * CPU_IMPORTANCE_MAP_HALO][CPU_IMPORTANCE_MAP_TILE_WIDTH + 2 * CPU_IMPORTANCE_MAP_HALO]; ///< unorm8 output of FFX_CACAO_PostprocessImportanceMapA
+	uint32_t loadCounter; ///< sum of the final importance of every texel of every tile the owning task ran, reduced by FFX_CACAO_CpuDraw
+} CpuImportanceMapTile;
+
+// emulated groupshared memory. every task of the scheduler owns one, and runs one thread group at a time on it
+typedef union CpuGroupShared {
+	CpuBlurTile             blur;
+	float                   prepareDepths[4][CPU_PREPARE_DEPTHS_STRIPE_HEIGHT][CPU_PREPARE_DEPTHS_BLOCK_WIDTH];                            ///< s_FFX_CACAO_PrepareDepthsAndMipsBuffer, for a block of a stripe
+	CpuBilateralUpscaleTile bilateralUpscale;
+	CpuImportanceMapTile    importanceMap;
+} CpuGroupShared;
+
+typedef struct CpuSSAOTapBatch CpuSSAOTapBatch;
+
+// evaluates the SSAO taps of a batch of pixels, see the SSAO tap kernels
+typedef void (*CpuSSAOTapKernel)(const struct CpuDispatchInfo *info, int qualityLevel, CpuSSAOTapBatch *batch);
+
+// runs the passes of the edge sensitive blur over a tile, see the blur kernels
+typedef void (*CpuBlurKernel)(const struct CpuDispatchInfo *info, uint32_t blurPasses, CpuBlurTile *tile);
+
+// runs the 5x5 filter of the bilateral upscale over a thread group, see the bilateral upscale kernels
+typedef void (*CpuBilateralUpscaleKernel)(const struct CpuDispatchInfo *info, CpuBilateralUpscaleTile *tile);
+
+typedef struct CpuDispatchInfo {
+	const FFX_CACAO_Constants *constants;
+	const CpuDescriptorSet    *descriptorSet;
+	uint32_t                  *loadCounter;
+	CpuSSAOTapKernel           ssaoTapKernel;
+	CpuBlurKernel              blurKernel;
+	CpuBilateralUpscaleKernel  bilateralUpscaleKernel;
+	CpuGroupShared            *groupShared;
+} CpuDispatchInfo;
+
+typedef enum CpuAddressMode {
+	CPU_ADDRESS_MODE_CLAMP,
+	CPU_ADDRESS_MODE_MIRROR,
+} CpuAddressMode;
+
+static inline uint16_t cpuFloatToHalf(float value)
 {
-	if (context == NULL)
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t absBits = bits & 0x7FFFFFFF;
+
+	if (absBits >= 0x7F800000) // inf or nan
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
+		return (uint16_t)(sign | (absBits > 0x7F800000 ? 0x7E00 : 0x7C00));
 	}
-	if (device == NULL)
+	if (absBits >= 0x477FF000) // rounds to inf
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
+		return (uint16_t)(sign | 0x7C00);
+	}
+	if (absBits < 0x38800000) // denormal or zero
+	{
+		if (absBits < 0x33000000)
+		{
+			return (uint16_t)sign;
+		}
+		uint32_t mantissa = (absBits & 0x007FFFFF) | 0x00800000;
+		uint32_t shift = 126 - (absBits >> 23);
+		uint32_t half = mantissa >> shift;
+		uint32_t remainder = mantissa & ((1u << shift) - 1);
+		uint32_t halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1)))
+		{
+			++half;
+		}
+		return (uint16_t)(sign | half);
 	}
-	context = getAlignedD3D12ContextPointer(context);
-
-	uint32_t numInputDescriptorsInited = 0;
-	uint32_t numOutputDescriptorsInited = 0;
-	uint32_t numRootSignaturesInited = 0;
-	uint32_t numComputeShadersInited = 0;
 
-#define COMPUTE_SHADER_INIT(name, entryPoint, uavSize, srvSize) \
-	errorStatus = computeShaderInit(&context->name, device, #entryPoint, entryPoint ## DXIL, sizeof(entryPoint ## DXIL), uavSize, srvSize, samplers, FFX_CACAO_ARRAY_SIZE(samplers)); \
-	if (errorStatus) \
-	{ \
-		goto error_create_ ## entryPoint; \
+	uint32_t half = (absBits - 0x38000000) >> 13;
+	uint32_t remainder = absBits & 0x1FFF;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+	{
+		++half;
 	}
-#define ERROR_COMPUTE_SHADER_DESTROY(name, entryPoint) \
-	computeShaderDestroy(&context->name); \
-error_create_ ## entryPoint:
+	return (uint16_t)(sign | half);
+}
 
-	FFX_CACAO_Status errorStatus = FFX_CACAO_STATUS_FAILED;
+static inline float cpuHalfToFloat(uint16_t value)
+{
+	uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+	uint32_t exponent = (value >> 10) & 0x1F;
+	uint32_t mantissa = value & 0x3FF;
+	uint32_t bits;
 
-	context->device = device;
-	CbvSrvUavHeap *cbvSrvUavHeap = &context->cbvSrvUavHeap;
-	errorStatus = cbvSrvUavHeapInit(cbvSrvUavHeap, device, 512);
-	if (errorStatus)
+	if (exponent == 0x1F)
 	{
-		goto error_create_cbv_srv_uav_heap;
+		bits = sign | 0x7F800000 | (mantissa << 13);
 	}
-	errorStatus = constantBufferRingInit(&context->constantBufferRing, device, 5, 1024 * 5);
-	if (errorStatus)
+	else if (exponent)
 	{
-		goto error_create_constant_buffer_ring;
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
 	}
-#ifdef FFX_CACAO_ENABLE_PROFILING
-	errorStatus = gpuTimerInit(&context->gpuTimer, device);
-	if (errorStatus)
+	else
 	{
-		goto error_create_gpu_timer;
+		float denormal = (float)mantissa * (1.0f / 16777216.0f);
+		memcpy(&bits, &denormal, sizeof(bits));
+		bits |= sign;
 	}
-#endif
 
-	D3D12_STATIC_SAMPLER_DESC samplers[5] = { };
+	float result;
+	memcpy(&result, &bits, sizeof(result));
+	return result;
+}
 
-	samplers[0].Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
-	samplers[0].AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-	samplers[0].AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-	samplers[0].AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-	samplers[0].ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
-	samplers[0].BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
-	samplers[0].MinLOD = 0.0f;
-	samplers[0].MaxLOD = D3D12_FLOAT32_MAX;
-	samplers[0].MipLODBias = 0;
-	samplers[0].MaxAnisotropy = 1;
-	samplers[0].ShaderRegister = 0;
-	samplers[0].RegisterSpace = 0;
-	samplers[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+// emulates f32tof16/f16tof32 round trips through groupshared memory
+static inline float cpuQuantizeHalf(float value)
+{
+	return cpuHalfToFloat(cpuFloatToHalf(value));
+}
 
-	samplers[1].Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
-	samplers[1].AddressU = D3D12_TEXTURE_ADDRESS_MODE_MIRROR;
-	samplers[1].AddressV = D3D12_TEXTURE_ADDRESS_MODE_MIRROR;
-	samplers[1].AddressW = D3D12_TEXTURE_ADDRESS_MODE_MIRROR;
-	samplers[1].ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
-	samplers[1].BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
-	samplers[1].MinLOD = 0.0f;
-	samplers[1].MaxLOD = D3D12_FLOAT32_MAX;
-	samplers[1].MipLODBias = 0;
-	samplers[1].MaxAnisotropy = 1;
-	samplers[1].ShaderRegister = 1;
-	samplers[1].RegisterSpace = 0;
-	samplers[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+static inline float cpuSaturate(float value)
+{
+	return FFX_CACAO_CLAMP(value, 0.0f, 1.0f);
+}
 
-	samplers[2].Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
-	samplers[2].AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-	samplers[2].AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-	samplers[2].AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-	samplers[2].ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
-	samplers[2].BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
-	samplers[2].MinLOD = 0.0f;
-	samplers[2].MaxLOD = D3D12_FLOAT32_MAX;
-	samplers[2].MipLODBias = 0;
-	samplers[2].MaxAnisotropy = 1;
-	samplers[2].ShaderRegister = 2;
-	samplers[2].RegisterSpace = 0;
-	samplers[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+static inline float cpuLerp(float a, float b, float t)
+{
+	return a + (b - a) * t;
+}
 
-	samplers[3].Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
-	samplers[3].AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-	samplers[3].AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-	samplers[3].AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
-	samplers[3].ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
-	samplers[3].BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
-	samplers[3].MinLOD = 0.0f;
-	samplers[3].MaxLOD = D3D12_FLOAT32_MAX;
-	samplers[3].MipLODBias = 0;
-	samplers[3].MaxAnisotropy = 1;
-	samplers[3].ShaderRegister = 3;
-	samplers[3].RegisterSpace = 0;
-	samplers[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+// HLSL round() rounds halfway cases to even
+static inline float cpuRound(float value)
+{
+	return nearbyintf(value);
+}
 
-	samplers[4].Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
-	samplers[4].AddressU = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
-	samplers[4].AddressV = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
-	samplers[4].AddressW = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
-	samplers[4].ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
-	samplers[4].BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
-	samplers[4].MinLOD = 0.0f;
-	samplers[4].MaxLOD = D3D12_FLOAT32_MAX;
-	samplers[4].MipLODBias = 0;
-	samplers[4].MaxAnisotropy = 1;
-	samplers[4].ShaderRegister = 4;
-	samplers[4].RegisterSpace = 0;
-	samplers[4].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+static inline uint8_t cpuEncodeUnorm8(float value)
+{
+	return (uint8_t)(cpuSaturate(value) * 255.0f + 0.5f);
+}
 
-	errorStatus = textureInit(&context->loadCounter, device, "CACAO::m_loadCounter", &CD3DX12_RESOURCE_DESC::Tex1D(DXGI_FORMAT_R32_UINT, 1, 1, 1, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, NULL);
-	if (errorStatus)
+static inline int8_t cpuEncodeSnorm8(float value)
+{
+	value = FFX_CACAO_CLAMP(value, -1.0f, 1.0f) * 127.0f;
+	return (int8_t)(value < 0.0f ? value - 0.5f : value + 0.5f);
+}
+
+static inline CpuFloat4 cpuDecodeTexel(TextureFormatID format, const uint8_t *texel)
+{
+	CpuFloat4 result = { 0.0f, 0.0f, 0.0f, 1.0f };
+	switch (format)
 	{
-		goto error_create_load_counter_texture;
+	case TEXTURE_FORMAT_R16_SFLOAT: {
+		uint16_t value;
+		memcpy(&value, texel, sizeof(value));
+		result.x = cpuHalfToFloat(value);
+		break;
+	}
+	case TEXTURE_FORMAT_R16G16B16A16_SFLOAT: {
+		uint16_t values[4];
+		memcpy(values, texel, sizeof(values));
+		result.x = cpuHalfToFloat(values[0]);
+		result.y = cpuHalfToFloat(values[1]);
+		result.z = cpuHalfToFloat(values[2]);
+		result.w = cpuHalfToFloat(values[3]);
+		break;
 	}
+	case TEXTURE_FORMAT_R8G8B8A8_SNORM: {
+		const int8_t *values = (const int8_t*)texel;
+		result.x = FFX_CACAO_MAX((float)values[0] / 127.0f, -1.0f);
+		result.y = FFX_CACAO_MAX((float)values[1] / 127.0f, -1.0f);
+		result.z = FFX_CACAO_MAX((float)values[2] / 127.0f, -1.0f);
+		result.w = FFX_CACAO_MAX((float)values[3] / 127.0f, -1.0f);
+		break;
+	}
+	case TEXTURE_FORMAT_R8G8_UNORM:
+		result.x = (float)texel[0] / 255.0f;
+		result.y = (float)texel[1] / 255.0f;
+		break;
+	case TEXTURE_FORMAT_R8_UNORM:
+		result.x = (float)texel[0] / 255.0f;
+		break;
+	case TEXTURE_FORMAT_R32_SFLOAT:
+		memcpy(&result.x, texel, sizeof(float));
+		break;
+	case TEXTURE_FORMAT_R32G32B32A32_SFLOAT:
+		memcpy(&result, texel, sizeof(result));
+		break;
+	}
+	return result;
+}
 
-	// create uav for load counter
+static inline void cpuEncodeTexel(TextureFormatID format, uint8_t *texel, CpuFloat4 value)
+{
+	switch (format)
 	{
-		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
-		uavDesc.Format = DXGI_FORMAT_R32_UINT;
-		uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE1D;
-		uavDesc.Texture1D.MipSlice = 0;
-
-		cbvSrvUavHeapAllocDescriptor(cbvSrvUavHeap, &context->loadCounterUav, 1); // required for clearing the load counter
-		textureCreateUavFromDesc(&context->loadCounter, 0, &context->loadCounterUav, &uavDesc);
+	case TEXTURE_FORMAT_R16_SFLOAT: {
+		uint16_t half = cpuFloatToHalf(value.x);
+		memcpy(texel, &half, sizeof(half));
+		break;
+	}
+	case TEXTURE_FORMAT_R16G16B16A16_SFLOAT: {
+		uint16_t halves[4] = { cpuFloatToHalf(value.x), cpuFloatToHalf(value.y), cpuFloatToHalf(value.z), cpuFloatToHalf(value.w) };
+		memcpy(texel, halves, sizeof(halves));
+		break;
+	}
+	case TEXTURE_FORMAT_R8G8B8A8_SNORM: {
+		int8_t *values = (int8_t*)texel;
+		values[0] = cpuEncodeSnorm8(value.x);
+		values[1] = cpuEncodeSnorm8(value.y);
+		values[2] = cpuEncodeSnorm8(value.z);
+		values[3] = cpuEncodeSnorm8(value.w);
+		break;
+	}
+	case TEXTURE_FORMAT_R8G8_UNORM:
+		texel[0] = cpuEncodeUnorm8(value.x);
+		texel[1] = cpuEncodeUnorm8(value.y);
+		break;
+	case TEXTURE_FORMAT_R8_UNORM:
+		texel[0] = cpuEncodeUnorm8(value.x);
+		break;
+	case TEXTURE_FORMAT_R32_SFLOAT:
+		memcpy(texel, &value.x, sizeof(float));
+		break;
+	case TEXTURE_FORMAT_R32G32B32A32_SFLOAT:
+		memcpy(texel, &value, sizeof(value));
+		break;
 	}
+}
 
-	for (; numInputDescriptorsInited < NUM_DESCRIPTOR_SETS; ++numInputDescriptorsInited)
+static size_t cpuTextureInit(CpuTexture *texture, TextureFormatID format, uint32_t width, uint32_t height, uint32_t arraySize, uint32_t numMips)
+{
+	FFX_CACAO_ASSERT(numMips <= CPU_MAX_TEXTURE_MIPS);
+
+	texture->data = NULL;
+	texture->format = format;
+	texture->texelSize = TEXTURE_FORMAT_TEXEL_SIZE_CPU[format];
+	texture->arraySize = arraySize;
+	texture->numMips = numMips;
+
+	size_t offset = 0;
+	for (uint32_t i = 0; i < numMips; ++i)
 	{
-		uint32_t size = DESCRIPTOR_SET_LAYOUT_META_DATA[DESCRIPTOR_SET_META_DATA[numInputDescriptorsInited].descriptorSetLayoutID].numInputs;
-		cbvSrvUavHeapAllocDescriptor(cbvSrvUavHeap, &context->inputDescriptors[numInputDescriptorsInited], size);
+		texture->widths[i] = FFX_CACAO_MAX(width >> i, 1u);
+		texture->heights[i] = FFX_CACAO_MAX(height >> i, 1u);
+		texture->rowPitches[i] = (size_t)texture->widths[i] * texture->texelSize;
+		texture->mipOffsets[i] = offset;
+		offset += texture->rowPitches[i] * texture->heights[i];
 	}
+	texture->slicePitch = offset;
 
-	for (; numOutputDescriptorsInited < NUM_DESCRIPTOR_SETS; ++numOutputDescriptorsInited)
+	return texture->slicePitch * arraySize;
+}
+
+static void cpuTextureWrap(CpuTexture *texture, TextureFormatID format, uint32_t width, uint32_t height, const void *data, uint32_t rowPitch)
+{
+	cpuTextureInit(texture, format, width, height, 1, 1);
+	if (rowPitch)
 	{
-		uint32_t size = DESCRIPTOR_SET_LAYOUT_META_DATA[DESCRIPTOR_SET_META_DATA[numOutputDescriptorsInited].descriptorSetLayoutID].numOutputs;
-		cbvSrvUavHeapAllocDescriptor(cbvSrvUavHeap, &context->outputDescriptors[numOutputDescriptorsInited], size);
+		texture->rowPitches[0] = rowPitch;
+		texture->slicePitch = (size_t)rowPitch * height;
 	}
+	texture->data = (uint8_t*)data;
+}
 
-	for (; numRootSignaturesInited < NUM_COMPUTE_SHADERS; ++numRootSignaturesInited)
+static inline CpuImageView cpuImageView(CpuTexture *texture, uint32_t mostDetailedMip, uint32_t mipLevels, uint32_t firstArraySlice, uint32_t arraySize)
+{
+	CpuImageView view;
+	view.texture = texture;
+	view.mostDetailedMip = mostDetailedMip;
+	view.mipLevels = mipLevels;
+	view.firstArraySlice = firstArraySlice;
+	view.arraySize = arraySize;
+	return view;
+}
+
+static inline uint8_t *cpuTexelAddress(const CpuTexture *texture, uint32_t x, uint32_t y, uint32_t slice, uint32_t mip)
+{
+	return texture->data + slice * texture->slicePitch + texture->mipOffsets[mip] + y * texture->rowPitches[mip] + x * texture->texelSize;
+}
+
+// Texture.Load and RWTexture[] reads: out of bounds accesses return zero
+static inline CpuFloat4 cpuLoad(const CpuImageView *view, int32_t x, int32_t y, int32_t slice, int32_t mip)
+{
+	CpuFloat4 zero = { 0.0f, 0.0f, 0.0f, 0.0f };
+	if (slice < 0 || (uint32_t)slice >= view->arraySize || mip < 0 || (uint32_t)mip >= view->mipLevels)
 	{
-		ComputeShaderMetaData metaData = COMPUTE_SHADER_META_DATA[numRootSignaturesInited];
-		DescriptorSetLayoutMetaData dslMetaData = DESCRIPTOR_SET_LAYOUT_META_DATA[metaData.descriptorSetLayoutID];
+		return zero;
+	}
+	const CpuTexture *texture = view->texture;
+	uint32_t textureMip = view->mostDetailedMip + mip;
+	if (x < 0 || y < 0 || (uint32_t)x >= texture->widths[textureMip] || (uint32_t)y >= texture->heights[textureMip])
+	{
+		return zero;
+	}
+	return cpuDecodeTexel(texture->format, cpuTexelAddress(texture, x, y, view->firstArraySlice + slice, textureMip));
+}
 
-		CD3DX12_DESCRIPTOR_RANGE DescRange[4];
-		CD3DX12_ROOT_PARAMETER RTSlot[4];
+// RWTexture[] writes: out of bounds accesses are dropped
+static inline void cpuStore(const CpuImageView *view, int32_t x, int32_t y, int32_t slice, CpuFloat4 value)
+{
+	if (slice < 0 || (uint32_t)slice >= view->arraySize)
+	{
+		return;
+	}
+	const CpuTexture *texture = view->texture;
+	uint32_t textureMip = view->mostDetailedMip;
+	if (x < 0 || y < 0 || (uint32_t)x >= texture->widths[textureMip] || (uint32_t)y >= texture->heights[textureMip])
+	{
+		return;
+	}
+	cpuEncodeTexel(texture->format, cpuTexelAddress(texture, x, y, view->firstArraySlice + slice, textureMip), value);
+}
 
-		// we'll always have a constant buffer
-		int parameterCount = 0;
-		DescRange[parameterCount].Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);
-		RTSlot[parameterCount++].InitAsConstantBufferView(0, 0, D3D12_SHADER_VISIBILITY_ALL);
+static inline void cpuStoreFloat(const CpuImageView *view, int32_t x, int32_t y, int32_t slice, float value)
+{
+	CpuFloat4 texel = { value, 0.0f, 0.0f, 0.0f };
+	cpuStore(view, x, y, slice, texel);
+}
 
-		// if we have a UAV table
-		if (dslMetaData.numOutputs > 0)
-		{
-			DescRange[parameterCount].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, dslMetaData.numOutputs, 0);
-			RTSlot[parameterCount].InitAsDescriptorTable(1, &DescRange[parameterCount], D3D12_SHADER_VISIBILITY_ALL);
-			++parameterCount;
-		}
+static inline void cpuStoreFloat2(const CpuImageView *view, int32_t x, int32_t y, int32_t slice, float a, float b)
+{
+	CpuFloat4 texel = { a, b, 0.0f, 0.0f };
+	cpuStore(view, x, y, slice, texel);
+}
 
-		// if we have a SRV table
-		if (dslMetaData.numInputs > 0)
-		{
-			DescRange[parameterCount].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, dslMetaData.numInputs, 0);
-			RTSlot[parameterCount].InitAsDescriptorTable(1, &DescRange[parameterCount], D3D12_SHADER_VISIBILITY_ALL);
-			++parameterCount;
-		}
+// texture coordinates are snapped to 8 bits of sub-texel precision as the samplers on the gpu do
+static inline float cpuTexelSpace(float uv, uint32_t size)
+{
+	float coord = uv * (float)size;
+	coord = FFX_CACAO_CLAMP(coord, -16777216.0f, 16777216.0f);
+	return floorf(coord * 256.0f + 0.5f) * (1.0f / 256.0f);
+}
 
-		// the root signature contains 3 slots to be used
-		CD3DX12_ROOT_SIGNATURE_DESC descRootSignature = CD3DX12_ROOT_SIGNATURE_DESC();
-		descRootSignature.NumParameters = parameterCount;
-		descRootSignature.pParameters = RTSlot;
-		descRootSignature.NumStaticSamplers = FFX_CACAO_ARRAY_SIZE(samplers);
-		descRootSignature.pStaticSamplers = samplers;
+static inline int32_t cpuAddress(int32_t coord, int32_t size, CpuAddressMode addressMode)
+{
+	if (addressMode == CPU_ADDRESS_MODE_CLAMP)
+	{
+		return FFX_CACAO_CLAMP(coord, 0, size - 1);
+	}
+	int32_t period = 2 * size;
+	int32_t m = coord % period;
+	m = m < 0 ? m + period : m;
+	return m < size ? m : period - 1 - m;
+}
 
-		// deny uneccessary access to certain pipeline stages
-		descRootSignature.Flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+static inline uint32_t cpuSampleSlice(const CpuImageView *view, float slice)
+{
+	float s = cpuRound(slice);
+	s = FFX_CACAO_CLAMP(s, 0.0f, (float)(view->arraySize - 1));
+	return view->firstArraySlice + (uint32_t)s;
+}
 
-		ID3DBlob *outBlob, *errorBlob = NULL;
+static inline CpuFloat4 cpuFetch(const CpuImageView *view, int32_t x, int32_t y, uint32_t slice, uint32_t mip, CpuAddressMode addressMode)
+{
+	const CpuTexture *texture = view->texture;
+	x = cpuAddress(x, (int32_t)texture->widths[mip], addressMode);
+	y = cpuAddress(y, (int32_t)texture->heights[mip], addressMode);
+	return cpuDecodeTexel(texture->format, cpuTexelAddress(texture, x, y, slice, mip));
+}
 
-		HRESULT hr = D3D12SerializeRootSignature(&descRootSignature, D3D_ROOT_SIGNATURE_VERSION_1, &outBlob, &errorBlob);
-		if (FAILED(hr))
-		{
-			errorStatus = hresultToFFX_CACAO_Status(hr);
-			goto error_init_root_signature;
-		}
+static inline float cpuFetchRed(const CpuImageView *view, int32_t x, int32_t y, uint32_t slice, uint32_t mip, CpuAddressMode addressMode)
+{
+	return cpuFetch(view, x, y, slice, mip, addressMode).x;
+}
 
-		if (errorBlob)
-		{
-			errorBlob->Release();
-			if (outBlob)
-			{
-				outBlob->Release();
-			}
-			errorStatus = FFX_CACAO_STATUS_FAILED;
-			goto error_init_root_signature;
-		}
+// SampleLevel with a MIN_MAG_MIP_POINT sampler
+static inline CpuFloat4 cpuSamplePoint4(const CpuImageView *view, float u, float v, float slice, float mip, int32_t offsetX, int32_t offsetY, CpuAddressMode addressMode)
+{
+	uint32_t level = 0;
+	if (mip > 0.0f)
+	{
+		level = (uint32_t)FFX_CACAO_MIN(floorf(mip + 0.5f), (float)(view->mipLevels - 1));
+	}
+	uint32_t textureMip = view->mostDetailedMip + level;
+	const CpuTexture *texture = view->texture;
+	int32_t x = (int32_t)floorf(cpuTexelSpace(u, texture->widths[textureMip])) + offsetX;
+	int32_t y = (int32_t)floorf(cpuTexelSpace(v, texture->heights[textureMip])) + offsetY;
+	return cpuFetch(view, x, y, cpuSampleSlice(view, slice), textureMip, addressMode);
+}
 
-		hr = device->CreateRootSignature(0, outBlob->GetBufferPointer(), outBlob->GetBufferSize(), IID_PPV_ARGS(&context->csRootSignatures[numRootSignaturesInited]));
-		if (FAILED(hr))
-		{
-			outBlob->Release();
-			errorStatus = hresultToFFX_CACAO_Status(hr);
-			goto error_init_root_signature;
-		}
+static inline float cpuSamplePoint(const CpuImageView *view, float u, float v, float slice, float mip, int32_t offsetX, int32_t offsetY, CpuAddressMode addressMode)
+{
+	return cpuSamplePoint4(view, u, v, slice, mip, offsetX, offsetY, addressMode).x;
+}
 
-		SetName(context->csRootSignatures[numRootSignaturesInited], metaData.rootSignatureName);
+// SampleLevel with a MIN_MAG_MIP_LINEAR clamp sampler at mip 0, red channel only
+static inline float cpuSampleLinear(const CpuImageView *view, float u, float v, float slice)
+{
+	uint32_t textureMip = view->mostDetailedMip;
+	const CpuTexture *texture = view->texture;
+	uint32_t s = cpuSampleSlice(view, slice);
+	float tx = cpuTexelSpace(u, texture->widths[textureMip]) - 0.5f;
+	float ty = cpuTexelSpace(v, texture->heights[textureMip]) - 0.5f;
+	float x0 = floorf(tx);
+	float y0 = floorf(ty);
+	float fx = tx - x0;
+	float fy = ty - y0;
+	int32_t x = (int32_t)x0;
+	int32_t y = (int32_t)y0;
+	float a = cpuFetchRed(view, x + 0, y + 0, s, textureMip, CPU_ADDRESS_MODE_CLAMP);
+	float b = cpuFetchRed(view, x + 1, y + 0, s, textureMip, CPU_ADDRESS_MODE_CLAMP);
+	float c = cpuFetchRed(view, x + 0, y + 1, s, textureMip, CPU_ADDRESS_MODE_CLAMP);
+	float d = cpuFetchRed(view, x + 1, y + 1, s, textureMip, CPU_ADDRESS_MODE_CLAMP);
+	return cpuLerp(cpuLerp(a, b, fx), cpuLerp(c, d, fx), fy);
+}
 
-		outBlob->Release();
-	}
+// GatherRed at mip 0; components are ordered (0,1), (1,1), (1,0), (0,0) relative to the footprint
+static inline CpuFloat4 cpuGatherRed(const CpuImageView *view, float u, float v, float slice, int32_t offsetX, int32_t offsetY, CpuAddressMode addressMode)
+{
+	uint32_t textureMip = view->mostDetailedMip;
+	const CpuTexture *texture = view->texture;
+	uint32_t s = cpuSampleSlice(view, slice);
+	int32_t x = (int32_t)floorf(cpuTexelSpace(u, texture->widths[textureMip]) - 0.5f) + offsetX;
+	int32_t y = (int32_t)floorf(cpuTexelSpace(v, texture->heights[textureMip]) - 0.5f) + offsetY;
+	CpuFloat4 result;
+	result.x = cpuFetchRed(view, x + 0, y + 1, s, textureMip, addressMode);
+	result.y = cpuFetchRed(view, x + 1, y + 1, s, textureMip, addressMode);
+	result.z = cpuFetchRed(view, x + 1, y + 0, s, textureMip, addressMode);
+	result.w = cpuFetchRed(view, x + 0, y + 0, s, textureMip, addressMode);
+	return result;
+}
 
-	for (; numComputeShadersInited < NUM_COMPUTE_SHADERS; ++numComputeShadersInited)
-	{
-		ComputeShaderMetaData metaData = COMPUTE_SHADER_META_DATA[numComputeShadersInited];
+static inline CpuFloat3 cpuFloat3(float x, float y, float z)
+{
+	CpuFloat3 result = { x, y, z };
+	return result;
+}
 
-		D3D12_SHADER_BYTECODE shaderByteCode = {};
-		shaderByteCode.pShaderBytecode = COMPUTE_SHADER_DXIL[numComputeShadersInited].dxil;
-		shaderByteCode.BytecodeLength = COMPUTE_SHADER_DXIL[numComputeShadersInited].len;
+static inline CpuFloat3 cpuAdd3(CpuFloat3 a, CpuFloat3 b)
+{
+	return cpuFloat3(a.x + b.x, a.y + b.y, a.z + b.z);
+}
 
-		D3D12_COMPUTE_PIPELINE_STATE_DESC descPso = {};
-		descPso.CS = shaderByteCode;
-		descPso.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
-		descPso.pRootSignature = context->csRootSignatures[numComputeShadersInited];
-		descPso.NodeMask = 0;
+static inline CpuFloat3 cpuSub3(CpuFloat3 a, CpuFloat3 b)
+{
+	return cpuFloat3(a.x - b.x, a.y - b.y, a.z - b.z);
+}
 
-		HRESULT hr = device->CreateComputePipelineState(&descPso, IID_PPV_ARGS(&context->computeShader[numComputeShadersInited]));
-		if (FAILED(hr))
-		{
-			goto error_init_compute_shader;
-		}
+static inline CpuFloat3 cpuScale3(CpuFloat3 a, float s)
+{
+	return cpuFloat3(a.x * s, a.y * s, a.z * s);
+}
 
-		SetName(context->computeShader[numComputeShadersInited], metaData.objectName);
-	}
+static inline float cpuDot3(CpuFloat3 a, CpuFloat3 b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
 
-	return FFX_CACAO_STATUS_OK;
+static inline CpuFloat3 cpuCross3(CpuFloat3 a, CpuFloat3 b)
+{
+	return cpuFloat3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
 
-error_init_compute_shader:
-	for (uint32_t i = 0; i < numComputeShadersInited; ++i)
-	{
-		context->computeShader[i]->Release();
-	}
+static inline CpuFloat3 cpuNormalize3(CpuFloat3 a)
+{
+	return cpuScale3(a, 1.0f / sqrtf(cpuDot3(a, a)));
+}
 
-error_init_root_signature:
-	for (uint32_t i = 0; i < numRootSignaturesInited; ++i)
-	{
-		context->csRootSignatures[i]->Release();
-	}
+// =================================================================================================
+// CPU ports of the compute shaders in ffx_cacao.hlsl
+// =================================================================================================
 
-error_create_load_counter_texture:
+static const float CPU_SAMPLE_PATTERN_MAIN[32][4] = {
+	{  0.78488064f,  0.56661671f,  1.500000f, -0.126083f }, {  0.26022232f, -0.29575172f,  1.500000f, -1.064030f }, {  0.10459357f,  0.08372527f,  1.110000f, -2.730563f }, { -0.68286800f,  0.04963045f,  1.090000f, -0.498827f },
+	{ -0.13570161f, -0.64190155f,  1.250000f, -0.532765f }, { -0.26193795f, -0.08205118f,  0.670000f, -1.783245f }, { -0.61177456f,  0.66664219f,  0.710000f, -0.044234f }, {  0.43675563f,  0.25119025f,  0.610000f, -1.167283f },
+	{  0.07884444f,  0.86618668f,  0.640000f, -0.459002f }, { -0.12790935f, -0.29869005f,  0.600000f, -1.729424f }, { -0.04031125f,  0.02413622f,  0.600000f, -4.792042f }, {  0.16201244f, -0.52851415f,  0.790000f, -1.067055f },
+	{ -0.70991218f,  0.47301072f,  0.640000f, -0.335236f }, {  0.03277707f, -0.22349690f,  0.600000f, -1.982384f }, {  0.68921727f,  0.36800742f,  0.630000f, -0.266718f }, {  0.29251814f,  0.37775412f,  0.610000f, -1.422520f },
+	{ -0.12224089f,  0.96582592f,  0.600000f, -0.426142f }, {  0.11071457f, -0.16131058f,  0.600000f, -2.165947f }, {  0.46562141f, -0.59747696f,  0.600000f, -0.189760f }, { -0.51548797f,  0.11804193f,  0.600000f, -1.246800f },
+	{  0.89141309f, -0.42090443f,  0.600000f,  0.028192f }, { -0.32402530f, -0.01591529f,  0.600000f, -1.543018f }, {  0.60771245f,  0.41635221f,  0.600000f, -0.605411f }, {  0.02379565f, -0.08239821f,  0.600000f, -3.809046f },
+	{  0.48951152f, -0.23657045f,  0.600000f, -1.189011f }, { -0.17611565f, -0.81696892f,  0.600000f, -0.513724f }, { -0.33930185f, -0.20732205f,  0.600000f, -1.698047f }, { -0.91974425f,  0.05403209f,  0.600000f,  0.062246f },
+	{ -0.15064627f, -0.14949332f,  0.600000f, -1.896062f }, {  0.53180975f, -0.35210401f,  0.600000f, -0.758838f }, {  0.41487166f,  0.81442589f,  0.600000f, -0.505648f }, { -0.24106961f, -0.32721516f,  0.600000f, -1.665244f },
+};
 
+#define CPU_MAX_TAPS 32
+#define CPU_ADAPTIVE_TAP_BASE_COUNT 5
+#define CPU_ADAPTIVE_TAP_FLEXIBLE_COUNT (CPU_MAX_TAPS - CPU_ADAPTIVE_TAP_BASE_COUNT)
+
+static const uint32_t CPU_NUM_TAPS[5] = { 3, 5, 12, 0, 0 };
+
+// quality preset thresholds, these must match the values in ffx_cacao.hlsl
+#define CPU_TILT_SAMPLES_ENABLE_AT_QUALITY_PRESET                     99
+#define CPU_TILT_SAMPLES_AMOUNT                                       0.4f
+#define CPU_HALOING_REDUCTION_ENABLE_AT_QUALITY_PRESET                1
+#define CPU_HALOING_REDUCTION_AMOUNT                                  0.6f
+#define CPU_NORMAL_BASED_EDGES_ENABLE_AT_QUALITY_PRESET               2
+#define CPU_NORMAL_BASED_EDGES_DOT_THRESHOLD                          0.5f
+#define CPU_DETAIL_AO_ENABLE_AT_QUALITY_PRESET                        1
+#define CPU_DEPTH_MIPS_ENABLE_AT_QUALITY_PRESET                       2
+#define CPU_DEPTH_MIPS_GLOBAL_OFFSET                                  -4.3f
+#define CPU_DEPTH_BASED_EDGES_ENABLE_AT_QUALITY_PRESET                1
+#define CPU_REDUCE_RADIUS_NEAR_SCREEN_BORDER_ENABLE_AT_QUALITY_PRESET 99
+
+static inline float cpuPackEdges(float left, float right, float top, float bottom)
+{
+	left = cpuRound(cpuSaturate(left) * 3.05f);
+	right = cpuRound(cpuSaturate(right) * 3.05f);
+	top = cpuRound(cpuSaturate(top) * 3.05f);
+	bottom = cpuRound(cpuSaturate(bottom) * 3.05f);
+	return left * (64.0f / 255.0f) + right * (16.0f / 255.0f) + top * (4.0f / 255.0f) + bottom * (1.0f / 255.0f);
+}
 
-#ifdef FFX_CACAO_ENABLE_PROFILING
-	gpuTimerDestroy(&context->gpuTimer);
-error_create_gpu_timer:
-#endif
-	constantBufferRingDestroy(&context->constantBufferRing);
-error_create_constant_buffer_ring:
-	cbvSrvUavHeapDestroy(&context->cbvSrvUavHeap);
-error_create_cbv_srv_uav_heap:
+static inline CpuFloat4 cpuUnpackEdges(const FFX_CACAO_Constants *consts, float packedValue)
+{
+	uint32_t packed = (uint32_t)(packedValue * 255.5f);
+	CpuFloat4 edgesLRTB;
+	edgesLRTB.x = cpuSaturate((float)((packed >> 6) & 0x03) / 3.0f + consts->InvSharpness);
+	edgesLRTB.y = cpuSaturate((float)((packed >> 4) & 0x03) / 3.0f + consts->InvSharpness);
+	edgesLRTB.z = cpuSaturate((float)((packed >> 2) & 0x03) / 3.0f + consts->InvSharpness);
+	edgesLRTB.w = cpuSaturate((float)((packed >> 0) & 0x03) / 3.0f + consts->InvSharpness);
+	return edgesLRTB;
+}
 
-	return errorStatus;
+static inline float cpuScreenSpaceToViewSpaceDepth(const FFX_CACAO_Constants *consts, float screenDepth)
+{
+	return consts->DepthUnpackConsts[0] / (consts->DepthUnpackConsts[1] - screenDepth);
 }
 
-FFX_CACAO_Status FFX_CACAO_D3D12DestroyContext(FFX_CACAO_D3D12Context* context)
+static inline CpuFloat4 cpuCalculateEdges(float centerZ, float leftZ, float rightZ, float topZ, float bottomZ)
 {
-	if (context == NULL)
-	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
-	}
-	context = getAlignedD3D12ContextPointer(context);
+	// slope-sensitive depth-based edge detection
+	float l = leftZ - centerZ;
+	float r = rightZ - centerZ;
+	float t = topZ - centerZ;
+	float b = bottomZ - centerZ;
+	float scale = 1.0f / (centerZ * 0.040f);
+	CpuFloat4 edgesLRTB;
+	edgesLRTB.x = cpuSaturate(1.3f - FFX_CACAO_MIN(fabsf(l), fabsf(l + r)) * scale);
+	edgesLRTB.y = cpuSaturate(1.3f - FFX_CACAO_MIN(fabsf(r), fabsf(r + l)) * scale);
+	edgesLRTB.z = cpuSaturate(1.3f - FFX_CACAO_MIN(fabsf(t), fabsf(t + b)) * scale);
+	edgesLRTB.w = cpuSaturate(1.3f - FFX_CACAO_MIN(fabsf(b), fabsf(b + t)) * scale);
+	return edgesLRTB;
+}
 
-	for (uint32_t i = 0; i < NUM_COMPUTE_SHADERS; ++i)
-	{
-		context->computeShader[i]->Release();
-	}
+static inline CpuFloat3 cpuNDCToViewSpace(const FFX_CACAO_Constants *consts, float x, float y, float viewspaceDepth)
+{
+	return cpuFloat3((consts->NDCToViewMul[0] * x + consts->NDCToViewAdd[0]) * viewspaceDepth, (consts->NDCToViewMul[1] * y + consts->NDCToViewAdd[1]) * viewspaceDepth, viewspaceDepth);
+}
 
-	for (uint32_t i = 0; i < NUM_COMPUTE_SHADERS; ++i)
-	{
-		context->csRootSignatures[i]->Release();
+static inline CpuFloat3 cpuDepthBufferUVToViewSpace(const FFX_CACAO_Constants *consts, float u, float v, float viewspaceDepth)
+{
+	return cpuFloat3((consts->DepthBufferUVToViewMul[0] * u + consts->DepthBufferUVToViewAdd[0]) * viewspaceDepth, (consts->DepthBufferUVToViewMul[1] * v + consts->DepthBufferUVToViewAdd[1]) * viewspaceDepth, viewspaceDepth);
+}
+
+static inline CpuFloat3 cpuCalculateNormal(CpuFloat4 edgesLRTB, CpuFloat3 pixCenterPos, CpuFloat3 pixLPos, CpuFloat3 pixRPos, CpuFloat3 pixTPos, CpuFloat3 pixBPos)
+{
+	float acceptedNormals[4] = { edgesLRTB.x * edgesLRTB.z, edgesLRTB.z * edgesLRTB.y, edgesLRTB.y * edgesLRTB.w, edgesLRTB.w * edgesLRTB.x };
+
+	pixLPos = cpuNormalize3(cpuSub3(pixLPos, pixCenterPos));
+	pixRPos = cpuNormalize3(cpuSub3(pixRPos, pixCenterPos));
+	pixTPos = cpuNormalize3(cpuSub3(pixTPos, pixCenterPos));
+	pixBPos = cpuNormalize3(cpuSub3(pixBPos, pixCenterPos));
+
+	CpuFloat3 pixelNormal = cpuFloat3(0.0f, 0.0f, -0.0005f);
+	pixelNormal = cpuAdd3(pixelNormal, cpuScale3(cpuCross3(pixLPos, pixTPos), acceptedNormals[0]));
+	pixelNormal = cpuAdd3(pixelNormal, cpuScale3(cpuCross3(pixTPos, pixRPos), acceptedNormals[1]));
+	pixelNormal = cpuAdd3(pixelNormal, cpuScale3(cpuCross3(pixRPos, pixBPos), acceptedNormals[2]));
+	pixelNormal = cpuAdd3(pixelNormal, cpuScale3(cpuCross3(pixBPos, pixLPos), acceptedNormals[3]));
+	return cpuNormalize3(pixelNormal);
+}
+
+// runs a compute shader thread function over every thread of a thread group
+#define CPU_THREAD_GROUP(group_width, group_height, thread_function) \
+	for (uint32_t threadY = 0; threadY < (group_height); ++threadY) \
+	{ \
+		for (uint32_t threadX = 0; threadX < (group_width); ++threadX) \
+		{ \
+			thread_function(info, groupX * (group_width) + threadX, groupY * (group_height) + threadY, groupZ); \
+		} \
 	}
 
-	textureDestroy(&context->loadCounter);
+// =============================================================================
+// Clear Load Counter
 
-#ifdef FFX_CACAO_ENABLE_PROFILING
-	gpuTimerDestroy(&context->gpuTimer);
-#endif
-	constantBufferRingDestroy(&context->constantBufferRing);
-	cbvSrvUavHeapDestroy(&context->cbvSrvUavHeap);
+// the cpu load counter is the reduction of the partial sums of cpuGenerateImportanceMap, which overwrites it
+static void cpuClearLoadCounter(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+}
 
-	return FFX_CACAO_STATUS_OK;
+// =============================================================================
+// Prepare
+
+static inline float cpuMipSmartAverage(const FFX_CACAO_Constants *consts, float a, float b, float c, float d)
+{
+	float closest = FFX_CACAO_MIN(FFX_CACAO_MIN(a, b), FFX_CACAO_MIN(c, d));
+	// matches the operator precedence of the shader: (-1 / r) * r
+	float falloffCalcMulSq = -1.0f / consts->EffectRadius * consts->EffectRadius;
+	float weightA = cpuSaturate((a - closest) * (a - closest) * falloffCalcMulSq + 1.0f);
+	float weightB = cpuSaturate((b - closest) * (b - closest) * falloffCalcMulSq + 1.0f);
+	float weightC = cpuSaturate((c - closest) * (c - closest) * falloffCalcMulSq + 1.0f);
+	float weightD = cpuSaturate((d - closest) * (d - closest) * falloffCalcMulSq + 1.0f);
+	return (weightA * a + weightB * b + weightC * c + weightD * d) / (weightA + weightB + weightC + weightD);
 }
 
-FFX_CACAO_Status FFX_CACAO_D3D12InitScreenSizeDependentResources(FFX_CACAO_D3D12Context* context, const FFX_CACAO_D3D12ScreenSizeInfo* info)
+// the cpu runs the depth prepare passes over stripes of CPU_PREPARE_DEPTHS_STRIPE_HEIGHT rows of the deinterleaved
+// depth buffer spanning its whole width, so that every input row is read once and all four slices and mips are
+// written from the same pass. a stripe is walked in blocks of CPU_PREPARE_DEPTHS_BLOCK_WIDTH columns, which keeps
+// the linearized depths of a block in groupshared memory until its mips are built.
+
+static_assert(FFX_CACAO_PREPARE_DEPTHS_HEIGHT == CPU_PREPARE_DEPTHS_STRIPE_HEIGHT, "the prepare depths passes must share the stripe height");
+static_assert(FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH == 8 && FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT == 8, "the mip chain is built over 8x8 blocks");
+static_assert(CPU_PREPARE_DEPTHS_BLOCK_WIDTH % FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH == 0, "a block must hold whole thread groups");
+
+// the two input texels along one axis that feed a deinterleaved depth, matching the GatherRed of
+// FFX_CACAO_PrepareNativeDepths and the SampleLevel offsets of FFX_CACAO_PrepareDownsampledDepths
+static inline void cpuPrepareDepthsSourceCoords(uint32_t coord, float inverseSize, uint32_t size, bool downsampled, int32_t *first, int32_t *second)
 {
-	if (context == NULL)
+	float scale = downsampled ? 4.0f : 2.0f;
+	float texel = cpuTexelSpace(((float)coord * scale + 0.5f) * inverseSize, size);
+	int32_t base = downsampled ? (int32_t)floorf(texel) : (int32_t)floorf(texel - 0.5f);
+	*first = cpuAddress(base, (int32_t)size, CPU_ADDRESS_MODE_CLAMP);
+	*second = cpuAddress(base + (downsampled ? 2 : 1), (int32_t)size, CPU_ADDRESS_MODE_CLAMP);
+}
+
+static inline void cpuPrepareDepthsStore(const CpuImageView *view, uint32_t x, uint32_t y, uint32_t slice, float value)
+{
+	const CpuTexture *texture = view->texture;
+	uint32_t mip = view->mostDetailedMip;
+	if (x < texture->widths[mip] && y < texture->heights[mip])
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
+		uint16_t half = cpuFloatToHalf(value);
+		memcpy(cpuTexelAddress(texture, x, y, view->firstArraySlice + slice, mip), &half, sizeof(half));
 	}
-	if (info == NULL)
+}
+
+// builds mips 1 to numMips - 1 of the 8x8 thread group at column group of a block, as FFX_CACAO_PrepareDepthsAndMips
+// does in groupshared memory: every mip averages the 2x2 results of the previous one in place
+static void cpuPrepareDepthsBuildMips(const CpuDispatchInfo *info, float (*block)[CPU_PREPARE_DEPTHS_STRIPE_HEIGHT][CPU_PREPARE_DEPTHS_BLOCK_WIDTH], uint32_t group, uint32_t baseX, uint32_t baseY, uint32_t numMips)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *outMips = info->descriptorSet->outputs;
+
+	for (uint32_t mip = 1; mip < numMips; ++mip)
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
+		uint32_t step = 1u << (mip - 1);
+		for (uint32_t slice = 0; slice < 4; ++slice)
+		{
+			for (uint32_t y = 0; y < FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT; y += 2 * step)
+			{
+				for (uint32_t x = 0; x < FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH; x += 2 * step)
+				{
+					uint32_t bx = group * FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH + x;
+					float avg = cpuMipSmartAverage(consts,
+						block[slice][y][bx],
+						block[slice][y + step][bx],
+						block[slice][y][bx + step],
+						block[slice][y + step][bx + step]);
+					cpuPrepareDepthsStore(&outMips[mip], (baseX + bx) >> mip, (baseY + y) >> mip, slice, avg);
+					block[slice][y][bx] = avg;
+				}
+			}
+		}
 	}
-	context = getAlignedD3D12ContextPointer(context);
-
-	uint32_t numTexturesInited = 0;
-	uint32_t numInputBindingsInited = 0;
-	uint32_t numOutputBindingsInited = 0;
+}
 
-	FFX_CACAO_Bool useDownsampledSsao = info->useDownsampledSsao;
-	context->useDownsampledSsao = useDownsampledSsao;
-	FFX_CACAO_Status errorStatus;
+// one thread group per stripe: linearizes and deinterleaves the depths of the stripe and builds numMips mips of it
+static void cpuPrepareDepthsStripe(const CpuDispatchInfo *info, uint32_t stripe, bool downsampled, uint32_t numMips)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *depthIn = &info->descriptorSet->inputs[0];
+	const CpuImageView *outMips = info->descriptorSet->outputs;
+	const CpuTexture *input = depthIn->texture;
+	const CpuTexture *output = outMips[0].texture;
+	float (*block)[CPU_PREPARE_DEPTHS_STRIPE_HEIGHT][CPU_PREPARE_DEPTHS_BLOCK_WIDTH] = info->groupShared->prepareDepths;
+
+	FFX_CACAO_ASSERT(input->format == TEXTURE_FORMAT_R32_SFLOAT);
+	FFX_CACAO_ASSERT(output->format == TEXTURE_FORMAT_R16_SFLOAT);
+
+	uint32_t inputMip = depthIn->mostDetailedMip;
+	uint32_t inputSlice = depthIn->firstArraySlice;
+	uint32_t inputWidth = input->widths[inputMip];
+	uint32_t inputHeight = input->heights[inputMip];
+	uint32_t outputWidth = output->widths[outMips[0].mostDetailedMip];
+	uint32_t baseY = stripe * CPU_PREPARE_DEPTHS_STRIPE_HEIGHT;
+	float depthUnpackMul = consts->DepthUnpackConsts[0];
+	float depthUnpackAdd = consts->DepthUnpackConsts[1];
+
+	const float *rows[CPU_PREPARE_DEPTHS_STRIPE_HEIGHT][2];
+	for (uint32_t y = 0; y < CPU_PREPARE_DEPTHS_STRIPE_HEIGHT; ++y)
+	{
+		int32_t first, second;
+		cpuPrepareDepthsSourceCoords(baseY + y, consts->DepthBufferInverseDimensions[1], inputHeight, downsampled, &first, &second);
+		rows[y][0] = (const float*)cpuTexelAddress(input, 0, first, inputSlice, inputMip);
+		rows[y][1] = (const float*)cpuTexelAddress(input, 0, second, inputSlice, inputMip);
+	}
 
-	ID3D12Device *device = context->device;
+	for (uint32_t baseX = 0; baseX < outputWidth; baseX += CPU_PREPARE_DEPTHS_BLOCK_WIDTH)
+	{
+		// thread groups which lie entirely outside of the output do nothing on the gpu
+		uint32_t blockWidth = FFX_CACAO_MIN(dispatchSize(FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH, outputWidth - baseX) * FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH, (uint32_t)CPU_PREPARE_DEPTHS_BLOCK_WIDTH);
 
-	FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
-	FFX_CACAO_UpdateBufferSizeInfo(info->width, info->height, useDownsampledSsao, bsi);
+		int32_t columns[2][CPU_PREPARE_DEPTHS_BLOCK_WIDTH];
+		for (uint32_t x = 0; x < blockWidth; ++x)
+		{
+			cpuPrepareDepthsSourceCoords(baseX + x, consts->DepthBufferInverseDimensions[0], inputWidth, downsampled, &columns[0][x], &columns[1][x]);
+		}
 
-	// =======================================
-	// Init debug SRVs/UAVs
+		// slice 2 * j + i holds the depths at the input texel offset by (i, j) from the top left of the footprint
+		for (uint32_t y = 0; y < CPU_PREPARE_DEPTHS_STRIPE_HEIGHT; ++y)
+		{
+			for (uint32_t slice = 0; slice < 4; ++slice)
+			{
+				const float *row = rows[y][slice >> 1];
+				const int32_t *column = columns[slice & 1];
+				float *linear = block[slice][y];
+				for (uint32_t x = 0; x < blockWidth; ++x)
+				{
+					linear[x] = depthUnpackMul / (depthUnpackAdd - row[column[x]]);
+				}
+				for (uint32_t x = 0; x < blockWidth; ++x)
+				{
+					cpuPrepareDepthsStore(&outMips[0], baseX + x, baseY + y, slice, linear[x]);
+				}
+			}
+		}
 
-	context->outputResource = info->outputResource;
+		for (uint32_t group = 0; group < blockWidth / FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH; ++group)
+		{
+			cpuPrepareDepthsBuildMips(info, block, group, baseX, baseY, numMips);
+		}
+	}
+}
 
-	// =======================================
-	// Init textures
+static void cpuPrepareDownsampledDepths(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuPrepareDepthsStripe(info, groupY, true, 1);
+}
 
-	for (; numTexturesInited < NUM_TEXTURES; ++numTexturesInited)
-	{
-		TextureMetaData metaData = TEXTURE_META_DATA[numTexturesInited];
+static void cpuPrepareNativeDepths(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuPrepareDepthsStripe(info, groupY, false, 1);
+}
 
-		DXGI_FORMAT format = TEXTURE_FORMAT_LOOKUP_D3D12[metaData.format];
-		uint32_t width = *(uint32_t*)(((uint8_t*)bsi) + metaData.widthOffset);
-		uint32_t height = *(uint32_t*)(((uint8_t*)bsi) + metaData.heightOffset);
+static void cpuPrepareDownsampledDepthsAndMips(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuPrepareDepthsStripe(info, groupY, true, 4);
+}
 
-		D3D12_HEAP_PROPERTIES heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
-		D3D12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(format, width, height, metaData.arraySize, metaData.numMips, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+static void cpuPrepareNativeDepthsAndMips(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuPrepareDepthsStripe(info, groupY, false, 4);
+}
 
-		HRESULT hr = device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, NULL, IID_PPV_ARGS(&context->textures[numTexturesInited]));
+static inline void cpuPrepareDownsampledDepthsHalfThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *depthIn = &info->descriptorSet->inputs[0];
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
+	float sample00 = cpuLoad(depthIn, 4 * x + 0, 4 * y + 0, 0, 0).x;
+	float sample11 = cpuLoad(depthIn, 4 * x + 2, 4 * y + 2, 0, 0).x;
+	cpuStoreFloat(output, x, y, 0, cpuScreenSpaceToViewSpaceDepth(consts, sample00));
+	cpuStoreFloat(output, x, y, 3, cpuScreenSpaceToViewSpaceDepth(consts, sample11));
+}
 
-		if (FAILED(hr))
-		{
-			errorStatus = hresultToFFX_CACAO_Status(hr);
-			goto error_init_textures;
-		}
+static inline void cpuPrepareNativeDepthsHalfThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *depthIn = &info->descriptorSet->inputs[0];
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
+	float sample00 = cpuLoad(depthIn, 2 * x + 0, 2 * y + 0, 0, 0).x;
+	float sample11 = cpuLoad(depthIn, 2 * x + 1, 2 * y + 1, 0, 0).x;
+	cpuStoreFloat(output, x, y, 0, cpuScreenSpaceToViewSpaceDepth(consts, sample00));
+	cpuStoreFloat(output, x, y, 3, cpuScreenSpaceToViewSpaceDepth(consts, sample11));
+}
 
-		SetName(context->textures[numTexturesInited], metaData.name);
-	}
+static void cpuPrepareDownsampledDepthsHalf(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_PREPARE_DEPTHS_HALF_WIDTH, FFX_CACAO_PREPARE_DEPTHS_HALF_HEIGHT, cpuPrepareDownsampledDepthsHalfThread)
+}
 
-	for (; numInputBindingsInited < NUM_INPUT_DESCRIPTOR_BINDINGS; ++numInputBindingsInited)
-	{
-		InputDescriptorBindingMetaData metaData = INPUT_DESCRIPTOR_BINDING_META_DATA[numInputBindingsInited];
-		DescriptorSetID ds = metaData.descriptorID;
-		ShaderResourceViewMetaData srvMetaData = SRV_META_DATA[metaData.srvID];
+static void cpuPrepareNativeDepthsHalf(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_PREPARE_DEPTHS_HALF_WIDTH, FFX_CACAO_PREPARE_DEPTHS_HALF_HEIGHT, cpuPrepareNativeDepthsHalfThread)
+}
 
-		D3D12_CPU_DESCRIPTOR_HANDLE descriptor = context->inputDescriptors[ds].cpuDescriptor;
-		descriptor.ptr += metaData.bindingNumber * context->inputDescriptors[ds].descriptorSize;
+// depths[y][x] holds the 4x4 neighbourhood used by FFX_CACAO_PrepareNormals, the corners are unused
+static inline void cpuPrepareNormals(const CpuDispatchInfo *info, const float depths[4][4], float u, float v, float pixelSizeX, float pixelSizeY, uint32_t x, uint32_t y)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
 
-		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-		srvDesc.Format = TEXTURE_FORMAT_LOOKUP_D3D12[TEXTURE_META_DATA[srvMetaData.texture].format];
-		srvDesc.ViewDimension = VIEW_TYPE_LOOKUP_D3D12_SRV[srvMetaData.viewType];
-		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-		switch (srvDesc.ViewDimension)
+	CpuFloat3 p[4][4];
+	for (int j = 0; j < 4; ++j)
+	{
+		for (int i = 0; i < 4; ++i)
 		{
-		case D3D12_SRV_DIMENSION_TEXTURE2D:
-			srvDesc.Texture2D.MostDetailedMip = srvMetaData.mostDetailedMip;
-			srvDesc.Texture2D.MipLevels = srvMetaData.mipLevels;
-			break;
-		case D3D12_SRV_DIMENSION_TEXTURE2DARRAY:
-			srvDesc.Texture2DArray.MostDetailedMip = srvMetaData.mostDetailedMip;
-			srvDesc.Texture2DArray.MipLevels = srvMetaData.mipLevels;
-			srvDesc.Texture2DArray.FirstArraySlice = srvMetaData.firstArraySlice;
-			srvDesc.Texture2DArray.ArraySize = srvMetaData.arraySize;
-			break;
-		default:
-			FFX_CACAO_ASSERT(0);
-			break;
+			p[j][i] = cpuNDCToViewSpace(consts, u + (float)(i - 1) * pixelSizeX, v + (float)(j - 1) * pixelSizeY, depths[j][i]);
 		}
-		device->CreateShaderResourceView(context->textures[srvMetaData.texture], &srvDesc, descriptor);
 	}
 
-	for (; numOutputBindingsInited < NUM_OUTPUT_DESCRIPTOR_BINDINGS; ++numOutputBindingsInited)
+	for (int index = 0; index < 4; ++index)
 	{
-		OutputDescriptorBindingMetaData metaData = OUTPUT_DESCRIPTOR_BINDING_META_DATA[numOutputBindingsInited];
-		DescriptorSetID ds = metaData.descriptorID;
-		UnorderedAccessViewMetaData uavMetaData = UAV_META_DATA[metaData.uavID];
+		int i = 1 + (index % 2);
+		int j = 1 + (index / 2);
+		CpuFloat4 edges = cpuCalculateEdges(p[j][i].z, p[j][i - 1].z, p[j][i + 1].z, p[j - 1][i].z, p[j + 1][i].z);
+		CpuFloat3 normal = cpuCalculateNormal(edges, p[j][i], p[j][i - 1], p[j][i + 1], p[j - 1][i], p[j + 1][i]);
+		CpuFloat4 texel = { normal.x, normal.y, normal.z, 1.0f };
+		cpuStore(output, x, y, index, texel);
+	}
+}
 
-		D3D12_CPU_DESCRIPTOR_HANDLE descriptor = context->outputDescriptors[ds].cpuDescriptor;
-		descriptor.ptr += metaData.bindingNumber * context->outputDescriptors[ds].descriptorSize;
+static inline void cpuPrepareDownsampledNormalsThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *depthIn = &info->descriptorSet->inputs[0];
+	int32_t depthX = 4 * (int32_t)x + consts->DepthBufferOffset[0];
+	int32_t depthY = 4 * (int32_t)y + consts->DepthBufferOffset[1];
 
-		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
-		uavDesc.Format = TEXTURE_FORMAT_LOOKUP_D3D12[TEXTURE_META_DATA[uavMetaData.textureID].format];
-		uavDesc.ViewDimension = VIEW_TYPE_LOOKUP_D3D12_UAV[uavMetaData.viewType];
-		switch (uavDesc.ViewDimension)
+	float depths[4][4] = {};
+	for (int j = 0; j < 4; ++j)
+	{
+		for (int i = 0; i < 4; ++i)
 		{
-		case D3D12_UAV_DIMENSION_TEXTURE2D:
-			uavDesc.Texture2D.MipSlice = uavMetaData.mostDetailedMip;
-			break;
-		case D3D12_UAV_DIMENSION_TEXTURE2DARRAY:
-			uavDesc.Texture2DArray.MipSlice = uavMetaData.mostDetailedMip;
-			uavDesc.Texture2DArray.FirstArraySlice = uavMetaData.firstArraySlice;
-			uavDesc.Texture2DArray.ArraySize = uavMetaData.arraySize;
-			break;
-		default:
-			FFX_CACAO_ASSERT(0);
-			break;
+			if ((i == 0 || i == 3) && (j == 0 || j == 3))
+			{
+				continue;
+			}
+			depths[j][i] = cpuScreenSpaceToViewSpaceDepth(consts, cpuLoad(depthIn, depthX + 2 * (i - 1), depthY + 2 * (j - 1), 0, 0).x);
 		}
-		device->CreateUnorderedAccessView(context->textures[uavMetaData.textureID], NULL, &uavDesc, descriptor);
 	}
 
-	// misc inputs
-	{
-		D3D12_CPU_DESCRIPTOR_HANDLE descriptor;
-		
-		// depth buffer input
-		descriptor = context->inputDescriptors[DS_PREPARE_DEPTHS].cpuDescriptor;
-		device->CreateShaderResourceView(info->depthBufferResource, &info->depthBufferSrvDesc, descriptor);
+	float pixelSizeX = 2.0f * consts->InputOutputBufferInverseDimensions[0];
+	float pixelSizeY = 2.0f * consts->InputOutputBufferInverseDimensions[1];
+	float u = ((float)(4 * x) + 0.5f) * consts->InputOutputBufferInverseDimensions[0];
+	float v = ((float)(4 * y) + 0.5f) * consts->InputOutputBufferInverseDimensions[1];
 
-		descriptor = context->inputDescriptors[DS_PREPARE_DEPTHS_MIPS].cpuDescriptor;
-		device->CreateShaderResourceView(info->depthBufferResource, &info->depthBufferSrvDesc, descriptor);
+	cpuPrepareNormals(info, depths, u, v, pixelSizeX, pixelSizeY, x, y);
+}
 
-		descriptor = context->inputDescriptors[DS_PREPARE_NORMALS].cpuDescriptor;
-		device->CreateShaderResourceView(info->depthBufferResource, &info->depthBufferSrvDesc, descriptor);
+static inline void cpuPrepareNativeNormalsThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *depthIn = &info->descriptorSet->inputs[0];
+	int32_t depthX = 2 * (int32_t)x + consts->DepthBufferOffset[0];
+	int32_t depthY = 2 * (int32_t)y + consts->DepthBufferOffset[1];
+	float depthU = ((float)depthX - 0.5f) * consts->DepthBufferInverseDimensions[0];
+	float depthV = ((float)depthY - 0.5f) * consts->DepthBufferInverseDimensions[1];
+	CpuFloat4 samples00 = cpuGatherRed(depthIn, depthU, depthV, 0.0f, 0, 0, CPU_ADDRESS_MODE_CLAMP);
+	CpuFloat4 samples10 = cpuGatherRed(depthIn, depthU, depthV, 0.0f, 2, 0, CPU_ADDRESS_MODE_CLAMP);
+	CpuFloat4 samples01 = cpuGatherRed(depthIn, depthU, depthV, 0.0f, 0, 2, CPU_ADDRESS_MODE_CLAMP);
+	CpuFloat4 samples11 = cpuGatherRed(depthIn, depthU, depthV, 0.0f, 2, 2, CPU_ADDRESS_MODE_CLAMP);
+
+	float depths[4][4] = {};
+	depths[0][1] = cpuScreenSpaceToViewSpaceDepth(consts, samples00.z);
+	depths[0][2] = cpuScreenSpaceToViewSpaceDepth(consts, samples10.w);
+
+	depths[1][0] = cpuScreenSpaceToViewSpaceDepth(consts, samples00.x);
+	depths[1][1] = cpuScreenSpaceToViewSpaceDepth(consts, samples00.y);
+	depths[1][2] = cpuScreenSpaceToViewSpaceDepth(consts, samples10.x);
+	depths[1][3] = cpuScreenSpaceToViewSpaceDepth(consts, samples10.y);
+
+	depths[2][0] = cpuScreenSpaceToViewSpaceDepth(consts, samples01.w);
+	depths[2][1] = cpuScreenSpaceToViewSpaceDepth(consts, samples01.z);
+	depths[2][2] = cpuScreenSpaceToViewSpaceDepth(consts, samples11.w);
+	depths[2][3] = cpuScreenSpaceToViewSpaceDepth(consts, samples11.z);
+
+	depths[3][1] = cpuScreenSpaceToViewSpaceDepth(consts, samples01.y);
+	depths[3][2] = cpuScreenSpaceToViewSpaceDepth(consts, samples11.x);
+
+	float epsilon = (samples00.w + samples10.z + samples01.x + samples11.y) * 1e-20f;
+
+	float pixelSizeX = consts->InputOutputBufferInverseDimensions[0];
+	float pixelSizeY = consts->InputOutputBufferInverseDimensions[1];
+	float u = ((float)(2 * x) + 0.5f + epsilon) * consts->InputOutputBufferInverseDimensions[0];
+	float v = ((float)(2 * y) + 0.5f + epsilon) * consts->InputOutputBufferInverseDimensions[1];
+
+	cpuPrepareNormals(info, depths, u, v, pixelSizeX, pixelSizeY, x, y);
+}
 
-		descriptor = context->inputDescriptors[DS_BILATERAL_UPSAMPLE_PING].cpuDescriptor;
-		descriptor.ptr += context->cbvSrvUavHeap.descriptorElementSize;
-		device->CreateShaderResourceView(info->depthBufferResource, &info->depthBufferSrvDesc, descriptor);
+static void cpuPrepareDownsampledNormals(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_PREPARE_NORMALS_WIDTH, FFX_CACAO_PREPARE_NORMALS_HEIGHT, cpuPrepareDownsampledNormalsThread)
+}
 
-		descriptor = context->inputDescriptors[DS_BILATERAL_UPSAMPLE_PONG].cpuDescriptor;
-		descriptor.ptr += context->cbvSrvUavHeap.descriptorElementSize;
-		device->CreateShaderResourceView(info->depthBufferResource, &info->depthBufferSrvDesc, descriptor);
+static void cpuPrepareNativeNormals(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_PREPARE_NORMALS_WIDTH, FFX_CACAO_PREPARE_NORMALS_HEIGHT, cpuPrepareNativeNormalsThread)
+}
 
-		// normal buffer input
-		if (info->normalBufferResource)
-		{
-			descriptor = context->inputDescriptors[DS_PREPARE_NORMALS_FROM_INPUT_NORMALS].cpuDescriptor;
-			device->CreateShaderResourceView(info->normalBufferResource, &info->normalBufferSrvDesc, descriptor);
-		}
+static inline CpuFloat4 cpuPrepareLoadNormal(const CpuDispatchInfo *info, int32_t x, int32_t y)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	CpuFloat4 normal = cpuLoad(&info->descriptorSet->inputs[0], x, y, 0, 0);
+	normal.x = normal.x * consts->NormalsUnpackMul + consts->NormalsUnpackAdd;
+	normal.y = normal.y * consts->NormalsUnpackMul + consts->NormalsUnpackAdd;
+	normal.z = normal.z * consts->NormalsUnpackMul + consts->NormalsUnpackAdd;
+
+	// the constant buffer matrix is column major in the shader, so mul(normal, M) multiplies by the rows of elements
+	const float (*m)[4] = consts->NormalsWorldToViewspaceMatrix.elements;
+	CpuFloat4 result;
+	result.x = m[0][0] * normal.x + m[0][1] * normal.y + m[0][2] * normal.z;
+	result.y = m[1][0] * normal.x + m[1][1] * normal.y + m[1][2] * normal.z;
+	result.z = m[2][0] * normal.x + m[2][1] * normal.y + m[2][2] * normal.z;
+	result.w = 1.0f;
+	return result;
+}
 
-		// ssao buffer output
-		descriptor = context->outputDescriptors[DS_BILATERAL_UPSAMPLE_PING].cpuDescriptor;
-		device->CreateUnorderedAccessView(info->outputResource, NULL, &info->outputUavDesc, descriptor);
+static inline void cpuPrepareDownsampledNormalsFromInputNormalsThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
+	int32_t baseX = 4 * (int32_t)x;
+	int32_t baseY = 4 * (int32_t)y;
+	cpuStore(output, x, y, 0, cpuPrepareLoadNormal(info, baseX + 0, baseY + 0));
+	cpuStore(output, x, y, 1, cpuPrepareLoadNormal(info, baseX + 2, baseY + 0));
+	cpuStore(output, x, y, 2, cpuPrepareLoadNormal(info, baseX + 0, baseY + 2));
+	cpuStore(output, x, y, 3, cpuPrepareLoadNormal(info, baseX + 2, baseY + 2));
+}
 
-		descriptor = context->outputDescriptors[DS_BILATERAL_UPSAMPLE_PONG].cpuDescriptor;
-		device->CreateUnorderedAccessView(info->outputResource, NULL, &info->outputUavDesc, descriptor);
+static inline void cpuPrepareNativeNormalsFromInputNormalsThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
+	int32_t baseX = 2 * (int32_t)x;
+	int32_t baseY = 2 * (int32_t)y;
+	cpuStore(output, x, y, 0, cpuPrepareLoadNormal(info, baseX + 0, baseY + 0));
+	cpuStore(output, x, y, 1, cpuPrepareLoadNormal(info, baseX + 1, baseY + 0));
+	cpuStore(output, x, y, 2, cpuPrepareLoadNormal(info, baseX + 0, baseY + 1));
+	cpuStore(output, x, y, 3, cpuPrepareLoadNormal(info, baseX + 1, baseY + 1));
+}
 
-		descriptor = context->outputDescriptors[DS_APPLY_PING].cpuDescriptor;
-		device->CreateUnorderedAccessView(info->outputResource, NULL, &info->outputUavDesc, descriptor);
+static void cpuPrepareDownsampledNormalsFromInputNormals(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(PREPARE_NORMALS_FROM_INPUT_NORMALS_WIDTH, PREPARE_NORMALS_FROM_INPUT_NORMALS_HEIGHT, cpuPrepareDownsampledNormalsFromInputNormalsThread)
+}
 
-		descriptor = context->outputDescriptors[DS_APPLY_PONG].cpuDescriptor;
-		device->CreateUnorderedAccessView(info->outputResource, NULL, &info->outputUavDesc, descriptor);
+static void cpuPrepareNativeNormalsFromInputNormals(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(PREPARE_NORMALS_FROM_INPUT_NORMALS_WIDTH, PREPARE_NORMALS_FROM_INPUT_NORMALS_HEIGHT, cpuPrepareNativeNormalsFromInputNormalsThread)
+}
 
-		// load counter input
-		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-		srvDesc.Format = context->loadCounter.format;
-		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE1D;
-		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-		srvDesc.Texture1D.MostDetailedMip = 0;
-		srvDesc.Texture1D.MipLevels = 1;
-		
-		for (uint32_t pass = 0; pass < 4; ++pass)
-		{
-			descriptor = context->inputDescriptors[DS_GENERATE_ADAPTIVE_0 + pass].cpuDescriptor;
-			descriptor.ptr += 2 * context->cbvSrvUavHeap.descriptorElementSize;
-			device->CreateShaderResourceView(context->loadCounter.resource, &srvDesc, descriptor);
-		}
+// =============================================================================
+// SSAO Generation
 
-		// load counter output
-		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
-		uavDesc.Format = context->loadCounter.format;
-		uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE1D;
-		uavDesc.Texture1D.MipSlice = 0;
+static inline float cpuCalculatePixelObscurance(const FFX_CACAO_Constants *consts, CpuFloat3 pixelNormal, CpuFloat3 hitDelta, float falloffCalcMulSq)
+{
+	float lengthSq = cpuDot3(hitDelta, hitDelta);
+	float NdotD = cpuDot3(pixelNormal, hitDelta) / sqrtf(lengthSq);
+	float falloffMult = FFX_CACAO_MAX(0.0f, lengthSq * falloffCalcMulSq + 1.0f);
+	return FFX_CACAO_MAX(0.0f, NdotD - consts->EffectHorizonAngleThreshold) * falloffMult;
+}
 
-		descriptor = context->outputDescriptors[DS_POSTPROCESS_IMPORTANCE_MAP_B].cpuDescriptor;
-		descriptor.ptr += 1 * context->cbvSrvUavHeap.descriptorElementSize;
-		device->CreateUnorderedAccessView(context->loadCounter.resource, NULL, &uavDesc, descriptor);
+static inline float cpuSampleViewspaceDepthMip(const CpuDispatchInfo *info, float u, float v, float mipLevel)
+{
+	return cpuSamplePoint(&info->descriptorSet->inputs[0], u, v, 0.0f, mipLevel, 0, 0, CPU_ADDRESS_MODE_CLAMP);
+}
 
-		descriptor = context->outputDescriptors[DS_CLEAR_LOAD_COUNTER].cpuDescriptor;
-		device->CreateUnorderedAccessView(context->loadCounter.resource, NULL, &uavDesc, descriptor);
+static inline CpuFloat3 cpuGetNormalPass(const CpuDispatchInfo *info, int32_t x, int32_t y, int32_t pass)
+{
+	CpuFloat4 normal = cpuLoad(&info->descriptorSet->inputs[1], x, y, pass, 0);
+	return cpuFloat3(normal.x, normal.y, normal.z);
+}
+
+// the hit weighting shared by FFX_CACAO_SSAOTapInner and FFX_CACAO_SSAOAddHits, returns the weight applied to the hit
+static inline float cpuSSAOAddHit(const FFX_CACAO_Constants *consts, int qualityLevel, float *obscuranceSum, float *weightSum, CpuFloat3 hitDelta, CpuFloat3 pixelNormal, float falloffCalcMulSq, float weight)
+{
+	float obscurance = cpuCalculatePixelObscurance(consts, pixelNormal, hitDelta, falloffCalcMulSq);
+
+	if (qualityLevel >= CPU_HALOING_REDUCTION_ENABLE_AT_QUALITY_PRESET)
+	{
+		float reduct = FFX_CACAO_MAX(0.0f, -hitDelta.z); // cheaper, less correct version
+		reduct = cpuSaturate(reduct * consts->NegRecEffectRadius + 2.0f);
+		weight = CPU_HALOING_REDUCTION_AMOUNT * reduct + (1.0f - CPU_HALOING_REDUCTION_AMOUNT);
 	}
+	*obscuranceSum += obscurance * weight;
+	*weightSum += weight;
+	return weight;
+}
 
+static inline void cpuSSAOTapInner(const CpuDispatchInfo *info, int qualityLevel, float *obscuranceSum, float *weightSum, float samplingU, float samplingV, float mipLevel, CpuFloat3 pixCenterPos, CpuFloat3 pixelNormal, float falloffCalcMulSq, float weightMod)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
 
-	return FFX_CACAO_STATUS_OK;
+	// get depth at sample
+	float viewspaceSampleZ = cpuSampleViewspaceDepthMip(info, samplingU, samplingV, mipLevel);
 
-error_init_textures:
-	for (uint32_t i = 0; i < numTexturesInited; ++i)
+	// convert to viewspace
+	CpuFloat3 hitPos = cpuDepthBufferUVToViewSpace(consts, samplingU, samplingV, viewspaceSampleZ);
+	CpuFloat3 hitDelta = cpuSub3(hitPos, pixCenterPos);
+
+	float obscurance = cpuCalculatePixelObscurance(consts, pixelNormal, hitDelta, falloffCalcMulSq);
+	float weight = 1.0f;
+
+	if (qualityLevel >= CPU_HALOING_REDUCTION_ENABLE_AT_QUALITY_PRESET)
 	{
-		context->textures[i]->Release();
+		float reduct = FFX_CACAO_MAX(0.0f, -hitDelta.z); // cheaper, less correct version
+		reduct = cpuSaturate(reduct * consts->NegRecEffectRadius + 2.0f);
+		weight = CPU_HALOING_REDUCTION_AMOUNT * reduct + (1.0f - CPU_HALOING_REDUCTION_AMOUNT);
 	}
+	weight *= weightMod;
+	*obscuranceSum += obscurance * weight;
+	*weightSum += weight;
+}
 
-	return errorStatus;
+static inline void cpuSSAOTap(const CpuDispatchInfo *info, int qualityLevel, float *obscuranceSum, float *weightSum, int tapIndex, const float rotScale[4], CpuFloat3 pixCenterPos, CpuFloat3 pixelNormal, float depthBufferU, float depthBufferV, float mipOffset, float falloffCalcMulSq, float weightMod)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+
+	// patterns
+	const float *newSample = CPU_SAMPLE_PATTERN_MAIN[tapIndex];
+	float sampleOffsetX = rotScale[0] * newSample[0] + rotScale[1] * newSample[1];
+	float sampleOffsetY = rotScale[2] * newSample[0] + rotScale[3] * newSample[1];
+	float samplePow2Len = newSample[3];
+	weightMod *= newSample[2];
+
+	// snap to pixel center (more correct obscurance math, avoids artifacts)
+	sampleOffsetX = cpuRound(sampleOffsetX);
+	sampleOffsetY = cpuRound(sampleOffsetY);
+
+	float mipLevel = (qualityLevel < CPU_DEPTH_MIPS_ENABLE_AT_QUALITY_PRESET) ? 0.0f : (samplePow2Len + mipOffset);
+
+	float samplingU = sampleOffsetX * consts->DeinterleavedDepthBufferInverseDimensions[0] + depthBufferU;
+	float samplingV = sampleOffsetY * consts->DeinterleavedDepthBufferInverseDimensions[1] + depthBufferV;
+	cpuSSAOTapInner(info, qualityLevel, obscuranceSum, weightSum, samplingU, samplingV, mipLevel, pixCenterPos, pixelNormal, falloffCalcMulSq, weightMod);
+
+	// for the second tap, just use the mirrored offset; sample tilting is disabled at every quality preset
+	float samplingMirroredU = -sampleOffsetX * consts->DeinterleavedDepthBufferInverseDimensions[0] + depthBufferU;
+	float samplingMirroredV = -sampleOffsetY * consts->DeinterleavedDepthBufferInverseDimensions[1] + depthBufferV;
+	cpuSSAOTapInner(info, qualityLevel, obscuranceSum, weightSum, samplingMirroredU, samplingMirroredV, mipLevel, pixCenterPos, pixelNormal, falloffCalcMulSq, weightMod);
 }
 
-FFX_CACAO_Status FFX_CACAO_D3D12DestroyScreenSizeDependentResources(FFX_CACAO_D3D12Context* context)
+typedef struct CpuSSAOHits {
+	float u[2];
+	float v[2];
+	float z[2];
+	float weightMod;
+} CpuSSAOHits;
+
+static inline CpuSSAOHits cpuSSAOGetHits2(const CpuDispatchInfo *info, int qualityLevel, const float rotScale[4], const float newSample[4], float mipOffset, float depthBufferU, float depthBufferV)
 {
-	if (context == NULL)
+	const FFX_CACAO_Constants *consts = info->constants;
+	float offsetU = cpuRound(rotScale[0] * newSample[0] + rotScale[1] * newSample[1]) * consts->DeinterleavedDepthBufferInverseDimensions[0];
+	float offsetV = cpuRound(rotScale[2] * newSample[0] + rotScale[3] * newSample[1]) * consts->DeinterleavedDepthBufferInverseDimensions[1];
+	float mipLevel = (qualityLevel < CPU_DEPTH_MIPS_ENABLE_AT_QUALITY_PRESET) ? 0.0f : (newSample[3] + mipOffset);
+
+	CpuSSAOHits hits;
+	hits.weightMod = newSample[2];
+	hits.u[0] = depthBufferU + offsetU;
+	hits.v[0] = depthBufferV + offsetV;
+	hits.z[0] = cpuSampleViewspaceDepthMip(info, hits.u[0], hits.v[0], mipLevel);
+	hits.u[1] = depthBufferU - offsetU;
+	hits.v[1] = depthBufferV - offsetV;
+	hits.z[1] = cpuSampleViewspaceDepthMip(info, hits.u[1], hits.v[1], mipLevel);
+	return hits;
+}
+
+static inline void cpuSSAOAddHits(const FFX_CACAO_Constants *consts, int qualityLevel, CpuFloat3 pixCenterPos, CpuFloat3 pixelNormal, float falloffCalcMulSq, float *weightSum, float *obscuranceSum, const CpuSSAOHits *hits)
+{
+	float weight = hits->weightMod;
+	for (int hitIndex = 0; hitIndex < 2; ++hitIndex)
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
+		CpuFloat3 hitPos = cpuDepthBufferUVToViewSpace(consts, hits->u[hitIndex], hits->v[hitIndex], hits->z[hitIndex]);
+		weight = cpuSSAOAddHit(consts, qualityLevel, obscuranceSum, weightSum, cpuSub3(hitPos, pixCenterPos), pixelNormal, falloffCalcMulSq, weight);
 	}
-	context = getAlignedD3D12ContextPointer(context);
+}
 
-	for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+// FFX_CACAO_GenerateSSAOShadowsInternal is split into a per pixel setup, the tap loop and a per pixel resolve.
+// the tap loop runs over all pixels of a thread group at once in structure of arrays form, so that it can be
+// evaluated by the widest SIMD kernel the host supports (see the SSAO tap kernels below).
+
+#define CPU_SSAO_BATCH_SIZE 64
+
+static_assert(FFX_CACAO_GENERATE_WIDTH * FFX_CACAO_GENERATE_HEIGHT <= CPU_SSAO_BATCH_SIZE, "a generate thread group must fit in an SSAO tap batch");
+static_assert(FFX_CACAO_GENERATE_SPARSE_WIDTH * FFX_CACAO_GENERATE_SPARSE_HEIGHT <= CPU_SSAO_BATCH_SIZE, "a sparse generate thread group must fit in an SSAO tap batch");
+
+typedef struct CpuSSAOTapBatch {
+	alignas(64) float depthBufferU[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float depthBufferV[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float pixCenterPosX[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float pixCenterPosY[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float pixCenterPosZ[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float pixelNormalX[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float pixelNormalY[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float pixelNormalZ[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float rotScale0[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float rotScale1[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float rotScale2[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float rotScale3[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float mipOffset[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float falloffCalcMulSq[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float obscuranceSum[CPU_SSAO_BATCH_SIZE];
+	alignas(64) float weightSum[CPU_SSAO_BATCH_SIZE];
+	alignas(64) int32_t tapEnd[CPU_SSAO_BATCH_SIZE];
+	uint32_t count;    ///< number of pixels in the batch
+	int32_t  tapBegin; ///< index of the first tap evaluated for every pixel
+	bool     adaptive; ///< taps are accumulated as in FFX_CACAO_SSAOAddHits rather than FFX_CACAO_SSAOTap
+} CpuSSAOTapBatch;
+
+// the per pixel values the resolve needs which are not part of the tap batch
+typedef struct CpuSSAOResolveBatch {
+	uint32_t  x[CPU_SSAO_BATCH_SIZE];
+	uint32_t  y[CPU_SSAO_BATCH_SIZE];
+	CpuFloat4 edgesLRTB[CPU_SSAO_BATCH_SIZE];
+} CpuSSAOResolveBatch;
+
+static void cpuGenerateSSAOShadowsSetup(const CpuDispatchInfo *info, CpuSSAOTapBatch *batch, CpuSSAOResolveBatch *resolve, uint32_t lane, int qualityLevel, bool adaptiveBase)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *depthSource = &info->descriptorSet->inputs[0];
+
+	float svPosX = (float)resolve->x[lane];
+	float svPosY = (float)resolve->y[lane];
+	float svPosRoundedX = truncf(svPosX);
+	float svPosRoundedY = truncf(svPosY);
+	int32_t svPosUiX = (int32_t)svPosRoundedX;
+	int32_t svPosUiY = (int32_t)svPosRoundedY;
+
+	const int numberOfTaps = adaptiveBase ? CPU_ADAPTIVE_TAP_BASE_COUNT : (int)CPU_NUM_TAPS[qualityLevel];
+
+	float depthBufferU = (svPosX + 0.5f) * consts->DeinterleavedDepthBufferInverseDimensions[0] + consts->DeinterleavedDepthBufferNormalisedOffset[0];
+	float depthBufferV = (svPosY + 0.5f) * consts->DeinterleavedDepthBufferInverseDimensions[1] + consts->DeinterleavedDepthBufferNormalisedOffset[1];
+	CpuFloat4 valuesUL = cpuGatherRed(depthSource, depthBufferU, depthBufferV, 0.0f, -1, -1, CPU_ADDRESS_MODE_MIRROR);
+	CpuFloat4 valuesBR = cpuGatherRed(depthSource, depthBufferU, depthBufferV, 0.0f, 0, 0, CPU_ADDRESS_MODE_MIRROR);
+
+	// get this pixel's viewspace depth
+	float pixZ = valuesUL.y;
+
+	// get left right top bottom neighbouring pixels for edge detection
+	float pixLZ = valuesUL.x;
+	float pixTZ = valuesUL.z;
+	float pixRZ = valuesBR.z;
+	float pixBZ = valuesBR.x;
+
+	float normalizedScreenPosX = (svPosRoundedX + 0.5f) * consts->SSAOBufferInverseDimensions[0];
+	float normalizedScreenPosY = (svPosRoundedY + 0.5f) * consts->SSAOBufferInverseDimensions[1];
+	CpuFloat3 pixCenterPos = cpuNDCToViewSpace(consts, normalizedScreenPosX, normalizedScreenPosY, pixZ);
+
+	// Load this pixel's viewspace normal
+	CpuFloat3 pixelNormal = cpuGetNormalPass(info, svPosUiX, svPosUiY, consts->PassIndex);
+
+	const float pixelDirRBViewspaceSizeAtCenterZX = pixCenterPos.z * consts->NDCToViewMul[0] * consts->SSAOBufferInverseDimensions[0];
+	const float pixelDirRBViewspaceSizeAtCenterZY = pixCenterPos.z * consts->NDCToViewMul[1] * consts->SSAOBufferInverseDimensions[1];
+
+	// calculate effect radius and fit our screen sampling pattern inside it
+	float effectViewspaceRadius = consts->EffectRadius;
+	const float tooCloseLimitMod = cpuSaturate(sqrtf(cpuDot3(pixCenterPos, pixCenterPos)) * consts->EffectSamplingRadiusNearLimitRec) * 0.8f + 0.2f;
+	effectViewspaceRadius *= tooCloseLimitMod;
+	float pixLookupRadiusMod = (0.85f * effectViewspaceRadius) / pixelDirRBViewspaceSizeAtCenterZX;
+	float falloffCalcMulSq = -1.0f / (effectViewspaceRadius * effectViewspaceRadius);
+
+	// calculate samples rotation/scaling
+	float rotScale[4];
 	{
-		context->textures[i]->Release();
+		if (!adaptiveBase && (qualityLevel >= CPU_REDUCE_RADIUS_NEAR_SCREEN_BORDER_ENABLE_AT_QUALITY_PRESET))
+		{
+			float nearScreenBorder = FFX_CACAO_MIN(FFX_CACAO_MIN(depthBufferU, 1.0f - depthBufferU), FFX_CACAO_MIN(depthBufferV, 1.0f - depthBufferV));
+			nearScreenBorder = cpuSaturate(10.0f * nearScreenBorder + 0.6f);
+			pixLookupRadiusMod *= nearScreenBorder;
+		}
+
+		// load & update pseudo-random rotation matrix
+		uint32_t pseudoRandomIndex = (uint32_t)(svPosRoundedY * 2.0f + svPosRoundedX) % 5;
+		const float *rs = consts->PatternRotScaleMatrices[pseudoRandomIndex];
+		rotScale[0] = rs[0] * pixLookupRadiusMod;
+		rotScale[1] = rs[1] * pixLookupRadiusMod;
+		rotScale[2] = rs[2] * pixLookupRadiusMod;
+		rotScale[3] = rs[3] * pixLookupRadiusMod;
 	}
 
-	return FFX_CACAO_STATUS_OK;
-}
+	// the main obscurance & sample weight storage
+	float obscuranceSum = 0.0f;
+	float weightSum = 0.0f;
 
-FFX_CACAO_Status FFX_CACAO_D3D12UpdateSettings(FFX_CACAO_D3D12Context* context, const FFX_CACAO_Settings* settings)
-{
-	if (context == NULL || settings == NULL)
+	// edge mask for between this and left/right/top/bottom neighbour pixels - not used in quality level 0 so initialize to "no edge" (1 is no edge, 0 is edge)
+	CpuFloat4 edgesLRTB = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	// Move center pixel slightly towards camera to avoid imprecision artifacts due to using of 16bit depth buffer
+	pixCenterPos = cpuScale3(pixCenterPos, consts->DepthPrecisionOffsetMod);
+
+	if (!adaptiveBase && (qualityLevel >= CPU_DEPTH_BASED_EDGES_ENABLE_AT_QUALITY_PRESET))
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
+		edgesLRTB = cpuCalculateEdges(pixZ, pixLZ, pixRZ, pixTZ, pixBZ);
 	}
-	context = getAlignedD3D12ContextPointer(context);
 
-	memcpy(&context->settings, settings, sizeof(*settings));
+	// adds a more high definition sharp effect, which gets blurred out (reuses left/right/top/bottom samples that we used for edge detection)
+	if (!adaptiveBase && (qualityLevel >= CPU_DETAIL_AO_ENABLE_AT_QUALITY_PRESET))
+	{
+		// disable in case of quality level 4 (reference)
+		if (qualityLevel != 4)
+		{
+			//approximate neighbouring pixels positions (actually just deltas or "positions - pixCenterPos" )
+			CpuFloat3 viewspaceDirZNormalized = cpuFloat3(pixCenterPos.x / pixCenterPos.z, pixCenterPos.y / pixCenterPos.z, 1.0f);
 
-	return FFX_CACAO_STATUS_OK;
-}
+			CpuFloat3 pixLDelta = cpuAdd3(cpuFloat3(-pixelDirRBViewspaceSizeAtCenterZX, 0.0f, 0.0f), cpuScale3(viewspaceDirZNormalized, pixLZ - pixCenterPos.z));
+			CpuFloat3 pixRDelta = cpuAdd3(cpuFloat3(+pixelDirRBViewspaceSizeAtCenterZX, 0.0f, 0.0f), cpuScale3(viewspaceDirZNormalized, pixRZ - pixCenterPos.z));
+			CpuFloat3 pixTDelta = cpuAdd3(cpuFloat3(0.0f, -pixelDirRBViewspaceSizeAtCenterZY, 0.0f), cpuScale3(viewspaceDirZNormalized, pixTZ - pixCenterPos.z));
+			CpuFloat3 pixBDelta = cpuAdd3(cpuFloat3(0.0f, +pixelDirRBViewspaceSizeAtCenterZY, 0.0f), cpuScale3(viewspaceDirZNormalized, pixBZ - pixCenterPos.z));
 
-static inline void computeShaderDraw(FFX_CACAO_D3D12Context* context, ComputeShaderID computeShaderID, ID3D12GraphicsCommandList* commandList, D3D12_GPU_VIRTUAL_ADDRESS constantBuffer, DescriptorSetID descriptorSetID, uint32_t width, uint32_t height, uint32_t depth)
-{
-	FFX_CACAO_ASSERT(computeShaderID);
-	FFX_CACAO_ASSERT(commandList);
+			const float rangeReductionConst = 4.0f; // this is to avoid various artifacts
+			const float modifiedFalloffCalcMulSq = rangeReductionConst * falloffCalcMulSq;
 
-	DescriptorSetMetaData dsMetaData = DESCRIPTOR_SET_META_DATA[descriptorSetID];
-	DescriptorSetLayoutMetaData dslMetaData = DESCRIPTOR_SET_LAYOUT_META_DATA[dsMetaData.descriptorSetLayoutID];
+			float additionalObscurance = 0.0f;
+			additionalObscurance += cpuCalculatePixelObscurance(consts, pixelNormal, pixLDelta, modifiedFalloffCalcMulSq) * edgesLRTB.x;
+			additionalObscurance += cpuCalculatePixelObscurance(consts, pixelNormal, pixRDelta, modifiedFalloffCalcMulSq) * edgesLRTB.y;
+			additionalObscurance += cpuCalculatePixelObscurance(consts, pixelNormal, pixTDelta, modifiedFalloffCalcMulSq) * edgesLRTB.z;
+			additionalObscurance += cpuCalculatePixelObscurance(consts, pixelNormal, pixBDelta, modifiedFalloffCalcMulSq) * edgesLRTB.w;
 
-	commandList->SetComputeRootSignature(context->csRootSignatures[computeShaderID]);
+			obscuranceSum += consts->DetailAOStrength * additionalObscurance;
+		}
+	}
 
-	int params = 0;
-	commandList->SetComputeRootConstantBufferView(params++, constantBuffer);
-	if (dslMetaData.numOutputs)
+	// Sharp normals also create edges - but this adds to the cost as well
+	if (!adaptiveBase && (qualityLevel >= CPU_NORMAL_BASED_EDGES_ENABLE_AT_QUALITY_PRESET))
 	{
-		commandList->SetComputeRootDescriptorTable(params++, context->outputDescriptors[descriptorSetID].gpuDescriptor);
+		CpuFloat3 neighbourNormalL = cpuGetNormalPass(info, svPosUiX - 1, svPosUiY + 0, consts->PassIndex);
+		CpuFloat3 neighbourNormalR = cpuGetNormalPass(info, svPosUiX + 1, svPosUiY + 0, consts->PassIndex);
+		CpuFloat3 neighbourNormalT = cpuGetNormalPass(info, svPosUiX + 0, svPosUiY - 1, consts->PassIndex);
+		CpuFloat3 neighbourNormalB = cpuGetNormalPass(info, svPosUiX + 0, svPosUiY + 1, consts->PassIndex);
+
+		const float dotThreshold = CPU_NORMAL_BASED_EDGES_DOT_THRESHOLD;
+
+		edgesLRTB.x *= cpuSaturate(cpuDot3(pixelNormal, neighbourNormalL) + dotThreshold);
+		edgesLRTB.y *= cpuSaturate(cpuDot3(pixelNormal, neighbourNormalR) + dotThreshold);
+		edgesLRTB.z *= cpuSaturate(cpuDot3(pixelNormal, neighbourNormalT) + dotThreshold);
+		edgesLRTB.w *= cpuSaturate(cpuDot3(pixelNormal, neighbourNormalB) + dotThreshold);
 	}
-	if (dslMetaData.numInputs)
+
+	const float globalMipOffset = CPU_DEPTH_MIPS_GLOBAL_OFFSET;
+	float mipOffset = (qualityLevel < CPU_DEPTH_MIPS_ENABLE_AT_QUALITY_PRESET) ? 0.0f : (log2f(pixLookupRadiusMod) + globalMipOffset);
+
+	int32_t tapEnd = numberOfTaps;
+
+	// adaptive approach: the number of taps past the base ones depends on the importance map
+	if ((qualityLevel == 3) && !adaptiveBase)
 	{
-		commandList->SetComputeRootDescriptorTable(params++, context->inputDescriptors[descriptorSetID].gpuDescriptor);
+		// add new ones if needed
+		float fullResU = normalizedScreenPosX + consts->PerPassFullResUVOffset[0];
+		float fullResV = normalizedScreenPosY + consts->PerPassFullResUVOffset[1];
+		float importance = cpuSampleLinear(&info->descriptorSet->inputs[3], fullResU, fullResV, 0.0f);
+
+		// this is to normalize FFX_CACAO_DETAIL_AO_AMOUNT across all pixel regardless of importance
+		obscuranceSum *= (CPU_ADAPTIVE_TAP_BASE_COUNT / (float)CPU_MAX_TAPS) + (importance * CPU_ADAPTIVE_TAP_FLEXIBLE_COUNT / (float)CPU_MAX_TAPS);
+
+		// load existing base values
+		CpuFloat4 baseValues = cpuLoad(&info->descriptorSet->inputs[4], svPosUiX, svPosUiY, consts->PassIndex, 0);
+		weightSum += baseValues.y * (float)(CPU_ADAPTIVE_TAP_BASE_COUNT * 4.0f);
+		obscuranceSum += baseValues.x * weightSum;
+
+		float avgTotalImportance = (float)*info->loadCounter * consts->LoadCounterAvgDiv;
+
+		float importanceLimiter = cpuSaturate(consts->AdaptiveSampleCountLimit / avgTotalImportance);
+		importance *= importanceLimiter;
+
+		float additionalSampleCountFlt = CPU_ADAPTIVE_TAP_FLEXIBLE_COUNT * importance;
+
+		additionalSampleCountFlt += 1.5f;
+		uint32_t additionalSamples = (uint32_t)additionalSampleCountFlt;
+		tapEnd = (int32_t)FFX_CACAO_MIN((uint32_t)CPU_MAX_TAPS, additionalSamples + CPU_ADAPTIVE_TAP_BASE_COUNT);
 	}
 
-	commandList->SetPipelineState(context->computeShader[computeShaderID]);
-	commandList->Dispatch(width, height, depth);
+	batch->depthBufferU[lane] = depthBufferU;
+	batch->depthBufferV[lane] = depthBufferV;
+	batch->pixCenterPosX[lane] = pixCenterPos.x;
+	batch->pixCenterPosY[lane] = pixCenterPos.y;
+	batch->pixCenterPosZ[lane] = pixCenterPos.z;
+	batch->pixelNormalX[lane] = pixelNormal.x;
+	batch->pixelNormalY[lane] = pixelNormal.y;
+	batch->pixelNormalZ[lane] = pixelNormal.z;
+	batch->rotScale0[lane] = rotScale[0];
+	batch->rotScale1[lane] = rotScale[1];
+	batch->rotScale2[lane] = rotScale[2];
+	batch->rotScale3[lane] = rotScale[3];
+	batch->mipOffset[lane] = mipOffset;
+	batch->falloffCalcMulSq[lane] = falloffCalcMulSq;
+	batch->obscuranceSum[lane] = obscuranceSum;
+	batch->weightSum[lane] = weightSum;
+	batch->tapEnd[lane] = tapEnd;
+	resolve->edgesLRTB[lane] = edgesLRTB;
 }
 
-FFX_CACAO_Status FFX_CACAO_D3D12Draw(FFX_CACAO_D3D12Context* context, ID3D12GraphicsCommandList* commandList, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView)
+static void cpuGenerateSSAOShadowsResolve(const CpuDispatchInfo *info, const CpuSSAOTapBatch *batch, const CpuSSAOResolveBatch *resolve, uint32_t lane, int qualityLevel, bool adaptiveBase, float *outShadowTerm, CpuFloat4 *outEdges, float *outWeight)
 {
-	if (context == NULL || commandList == NULL || proj == NULL)
+	const FFX_CACAO_Constants *consts = info->constants;
+
+	float obscuranceSum = batch->obscuranceSum[lane];
+	float weightSum = batch->weightSum[lane];
+	CpuFloat4 edgesLRTB = resolve->edgesLRTB[lane];
+
+	// early out for adaptive base - just output weight (used for the next pass)
+	if (adaptiveBase)
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
+		float obscurance = obscuranceSum / weightSum;
+
+		*outShadowTerm = obscurance;
+		outEdges->x = outEdges->y = outEdges->z = outEdges->w = 0.0f;
+		*outWeight = weightSum;
+		return;
 	}
-	context = getAlignedD3D12ContextPointer(context);
 
-	
-#ifdef FFX_CACAO_ENABLE_PROFILING
-#define GET_TIMESTAMP(name) gpuTimerGetTimestamp(&context->gpuTimer, commandList, TIMESTAMP_##name)
-#else
-#define GET_TIMESTAMP(name)
-#endif
-	FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
+	// calculate weighted average
+	float obscurance = obscuranceSum / weightSum;
 
+	// calculate fadeout (1 close, gradient, 0 far)
+	float fadeOut = cpuSaturate(batch->pixCenterPosZ[lane] * consts->EffectFadeOutMul + consts->EffectFadeOutAdd);
 
-	USER_MARKER("FidelityFX CACAO");
+	// Reduce the SSAO shadowing if we're on the edge to remove artifacts on edges (we don't care for the lower quality one)
+	if (!adaptiveBase && (qualityLevel >= CPU_DEPTH_BASED_EDGES_ENABLE_AT_QUALITY_PRESET))
+	{
+		// when there's more than 2 opposite edges, start fading out the occlusion to reduce aliasing artifacts
+		float edgeFadeoutFactor = cpuSaturate((1.0f - edgesLRTB.x - edgesLRTB.y) * 0.35f) + cpuSaturate((1.0f - edgesLRTB.z - edgesLRTB.w) * 0.35f);
 
-	constantBufferRingStartFrame(&context->constantBufferRing);
+		fadeOut *= cpuSaturate(1.0f - edgeFadeoutFactor);
+	}
 
-#ifdef FFX_CACAO_ENABLE_PROFILING
-	gpuTimerStartFrame(&context->gpuTimer);
-#endif
+	// strength
+	obscurance = consts->EffectShadowStrength * obscurance;
 
-	GET_TIMESTAMP(BEGIN);
+	// clamp
+	obscurance = FFX_CACAO_MIN(obscurance, consts->EffectShadowClamp);
 
-	// set the descriptor heaps
+	// fadeout
+	obscurance *= fadeOut;
+
+	// conceptually switch to occlusion with the meaning being visibility (grows with visibility, occlusion == 1 implies full visibility),
+	// to be in line with what is more commonly used.
+	float occlusion = 1.0f - obscurance;
+
+	// modify the gradient
+	// note: this cannot be moved to a later pass because of loss of precision after storing in the render target
+	occlusion = powf(cpuSaturate(occlusion), consts->EffectShadowPow);
+
+	// outputs!
+	*outShadowTerm = occlusion;
+	*outEdges = edgesLRTB;
+	*outWeight = weightSum;
+}
+
+// the reference tap loop, one pixel at a time using the scalar ports of FFX_CACAO_SSAOTap and FFX_CACAO_SSAOAddHits
+static void cpuSSAOTapsScalar(const CpuDispatchInfo *info, int qualityLevel, CpuSSAOTapBatch *batch)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+
+	for (uint32_t lane = 0; lane < batch->count; ++lane)
 	{
-		ID3D12DescriptorHeap *descriptorHeaps[] = { context->cbvSrvUavHeap.heap };
-		commandList->SetDescriptorHeaps(FFX_CACAO_ARRAY_SIZE(descriptorHeaps), descriptorHeaps);
+		CpuFloat3 pixCenterPos = cpuFloat3(batch->pixCenterPosX[lane], batch->pixCenterPosY[lane], batch->pixCenterPosZ[lane]);
+		CpuFloat3 pixelNormal = cpuFloat3(batch->pixelNormalX[lane], batch->pixelNormalY[lane], batch->pixelNormalZ[lane]);
+		float rotScale[4] = { batch->rotScale0[lane], batch->rotScale1[lane], batch->rotScale2[lane], batch->rotScale3[lane] };
+		float depthBufferU = batch->depthBufferU[lane];
+		float depthBufferV = batch->depthBufferV[lane];
+		float mipOffset = batch->mipOffset[lane];
+		float falloffCalcMulSq = batch->falloffCalcMulSq[lane];
+		float obscuranceSum = batch->obscuranceSum[lane];
+		float weightSum = batch->weightSum[lane];
+
+		for (int32_t i = batch->tapBegin; i < batch->tapEnd[lane]; ++i)
+		{
+			if (batch->adaptive)
+			{
+				CpuSSAOHits hits = cpuSSAOGetHits2(info, qualityLevel, rotScale, CPU_SAMPLE_PATTERN_MAIN[i], mipOffset, depthBufferU, depthBufferV);
+				cpuSSAOAddHits(consts, qualityLevel, pixCenterPos, pixelNormal, falloffCalcMulSq, &weightSum, &obscuranceSum, &hits);
+			}
+			else
+			{
+				cpuSSAOTap(info, qualityLevel, &obscuranceSum, &weightSum, i, rotScale, pixCenterPos, pixelNormal, depthBufferU, depthBufferV, mipOffset, falloffCalcMulSq, 1.0f);
+			}
+		}
+
+		batch->obscuranceSum[lane] = obscuranceSum;
+		batch->weightSum[lane] = weightSum;
 	}
+}
 
-	// clear load counter
+// fills the unused lanes of a batch with copies of the first pixel, so SIMD kernels can always process whole vectors
+static void cpuSSAOTapBatchPad(CpuSSAOTapBatch *batch)
+{
+	for (uint32_t lane = batch->count; lane < CPU_SSAO_BATCH_SIZE; ++lane)
 	{
-		UINT clearValue[] = { 0, 0, 0, 0 };
-		commandList->ClearUnorderedAccessViewUint(context->loadCounterUav.gpuDescriptor, context->loadCounterUav.cpuVisibleCpuDescriptor, context->loadCounter.resource, clearValue, 0, NULL);
+		batch->depthBufferU[lane] = batch->depthBufferU[0];
+		batch->depthBufferV[lane] = batch->depthBufferV[0];
+		batch->pixCenterPosX[lane] = batch->pixCenterPosX[0];
+		batch->pixCenterPosY[lane] = batch->pixCenterPosY[0];
+		batch->pixCenterPosZ[lane] = batch->pixCenterPosZ[0];
+		batch->pixelNormalX[lane] = batch->pixelNormalX[0];
+		batch->pixelNormalY[lane] = batch->pixelNormalY[0];
+		batch->pixelNormalZ[lane] = batch->pixelNormalZ[0];
+		batch->rotScale0[lane] = batch->rotScale0[0];
+		batch->rotScale1[lane] = batch->rotScale1[0];
+		batch->rotScale2[lane] = batch->rotScale2[0];
+		batch->rotScale3[lane] = batch->rotScale3[0];
+		batch->mipOffset[lane] = batch->mipOffset[0];
+		batch->falloffCalcMulSq[lane] = batch->falloffCalcMulSq[0];
+		batch->obscuranceSum[lane] = 0.0f;
+		batch->weightSum[lane] = 0.0f;
+		batch->tapEnd[lane] = batch->tapBegin;
 	}
+}
 
-	// move this to initialisation
-	D3D12_GPU_VIRTUAL_ADDRESS cbCACAOHandle;
-	FFX_CACAO_Constants *pCACAOConsts;
-	D3D12_GPU_VIRTUAL_ADDRESS cbCACAOPerPassHandle[4];
-	FFX_CACAO_Constants *pPerPassConsts[4];
-
-	// upload constant buffers
+static void cpuGenerateSSAOShadowsBatch(const CpuDispatchInfo *info, CpuSSAOTapBatch *batch, CpuSSAOResolveBatch *resolve, int qualityLevel, bool adaptiveBase)
+{
+	if (batch->count == 0)
 	{
-		constantBufferRingAlloc(&context->constantBufferRing, sizeof(*pCACAOConsts), (void**)&pCACAOConsts, &cbCACAOHandle);
-		FFX_CACAO_UpdateConstants(pCACAOConsts, &context->settings, bsi, proj, normalsToView);
-
-		for (int i = 0; i < 4; ++i)
-		{
-			constantBufferRingAlloc(&context->constantBufferRing, sizeof(*pPerPassConsts[0]), (void**)&pPerPassConsts[i], &cbCACAOPerPassHandle[i]);
-			FFX_CACAO_UpdateConstants(pPerPassConsts[i], &context->settings, bsi, proj, normalsToView);
-			FFX_CACAO_UpdatePerPassConstants(pPerPassConsts[i], &context->settings, &context->bufferSizeInfo, i);
-		}
+		return;
 	}
 
-	// prepare depths, normals and mips
+	bool adaptive = (qualityLevel == 3) && !adaptiveBase;
+	batch->tapBegin = adaptive ? CPU_ADAPTIVE_TAP_BASE_COUNT : 0;
+	batch->adaptive = adaptive;
+
+	for (uint32_t lane = 0; lane < batch->count; ++lane)
 	{
-		USER_MARKER("Prepare downsampled depths, normals and mips");
+		cpuGenerateSSAOShadowsSetup(info, batch, resolve, lane, qualityLevel, adaptiveBase);
+	}
+	cpuSSAOTapBatchPad(batch);
 
+	info->ssaoTapKernel(info, qualityLevel, batch);
 
-		switch (context->settings.qualityLevel)
-		{
-		case FFX_CACAO_QUALITY_LOWEST: {
-			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HALF_WIDTH, bsi->deinterleavedDepthBufferWidth);
-			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HALF_HEIGHT, bsi->deinterleavedDepthBufferHeight);
-			ComputeShaderID prepareDepthsHalf = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS_HALF : CS_PREPARE_NATIVE_DEPTHS_HALF;
-			computeShaderDraw(context, prepareDepthsHalf, commandList, cbCACAOHandle, DS_PREPARE_DEPTHS, dispatchWidth, dispatchHeight, 1);
-			break;
-		}
-		case FFX_CACAO_QUALITY_LOW: {
-			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_WIDTH, bsi->deinterleavedDepthBufferWidth);
-			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HEIGHT, bsi->deinterleavedDepthBufferHeight);
-			ComputeShaderID prepareDepths = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS : CS_PREPARE_NATIVE_DEPTHS;
-			computeShaderDraw(context, prepareDepths, commandList, cbCACAOHandle, DS_PREPARE_DEPTHS, dispatchWidth, dispatchHeight, 1);
-			break;
-		}
-		default: {
-			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH, bsi->deinterleavedDepthBufferWidth);
-			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT, bsi->deinterleavedDepthBufferHeight);
-			ComputeShaderID prepareDepthsAndMips = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS_AND_MIPS : CS_PREPARE_NATIVE_DEPTHS_AND_MIPS;
-			computeShaderDraw(context, prepareDepthsAndMips, commandList, cbCACAOHandle, DS_PREPARE_DEPTHS_MIPS, dispatchWidth, dispatchHeight, 1);
-			break;
-		}
-		}
+	for (uint32_t lane = 0; lane < batch->count; ++lane)
+	{
+		float outShadowTerm;
+		float outWeight;
+		CpuFloat4 outEdges;
+		cpuGenerateSSAOShadowsResolve(info, batch, resolve, lane, qualityLevel, adaptiveBase, &outShadowTerm, &outEdges, &outWeight);
 
-		if (context->settings.generateNormals)
+		float outY;
+		if (adaptiveBase)
 		{
-			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_NORMALS_WIDTH, bsi->ssaoBufferWidth);
-			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_NORMALS_HEIGHT, bsi->ssaoBufferHeight);
-			ComputeShaderID prepareNormals = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_NORMALS : CS_PREPARE_NATIVE_NORMALS;
-			computeShaderDraw(context, prepareNormals, commandList, cbCACAOHandle, DS_PREPARE_NORMALS, dispatchWidth, dispatchHeight, 1);
+			outY = outWeight / ((float)CPU_ADAPTIVE_TAP_BASE_COUNT * 4.0f);
 		}
 		else
 		{
-			uint32_t dispatchWidth = dispatchSize(PREPARE_NORMALS_FROM_INPUT_NORMALS_WIDTH, bsi->ssaoBufferWidth);
-			uint32_t dispatchHeight = dispatchSize(PREPARE_NORMALS_FROM_INPUT_NORMALS_HEIGHT, bsi->ssaoBufferHeight);
-			ComputeShaderID prepareNormalsFromInputNormals = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_NORMALS_FROM_INPUT_NORMALS : CS_PREPARE_NATIVE_NORMALS_FROM_INPUT_NORMALS;
-			computeShaderDraw(context, prepareNormalsFromInputNormals, commandList, cbCACAOHandle, DS_PREPARE_NORMALS_FROM_INPUT_NORMALS, dispatchWidth, dispatchHeight, 1);
+			outY = qualityLevel == 0 ? cpuPackEdges(1.0f, 1.0f, 1.0f, 1.0f) : cpuPackEdges(outEdges.x, outEdges.y, outEdges.z, outEdges.w);
 		}
-
-		GET_TIMESTAMP(PREPARE);
+		cpuStoreFloat2(&info->descriptorSet->outputs[0], resolve->x[lane], resolve->y[lane], 0, outShadowTerm, outY);
 	}
+}
 
-	// deinterleaved depths and normals are now read only resources, also used in the next stage
+// threads whose output would be dropped are skipped, as the generate shaders have no other side effects
+static inline bool cpuGenerateOutputInBounds(const CpuDispatchInfo *info, uint32_t x, uint32_t y)
+{
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
+	const CpuTexture *texture = output->texture;
+	return x < texture->widths[output->mostDetailedMip] && y < texture->heights[output->mostDetailedMip];
+}
+
+static void cpuGenerateSparse(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ, int qualityLevel)
+{
+	CpuSSAOTapBatch batch;
+	CpuSSAOResolveBatch resolve;
+	batch.count = 0;
+
+	for (uint32_t threadY = 0; threadY < FFX_CACAO_GENERATE_SPARSE_HEIGHT; ++threadY)
 	{
-		D3D12_RESOURCE_BARRIER resourceBarriers[] = {
-			CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_DEINTERLEAVED_DEPTHS], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
-			CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_DEINTERLEAVED_NORMALS], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
-		};
-		commandList->ResourceBarrier(FFX_CACAO_ARRAY_SIZE(resourceBarriers), resourceBarriers);
+		for (uint32_t threadX = 0; threadX < FFX_CACAO_GENERATE_SPARSE_WIDTH; ++threadX)
+		{
+			uint32_t tidX = groupX * FFX_CACAO_GENERATE_SPARSE_WIDTH + threadX;
+			uint32_t tidY = groupY * FFX_CACAO_GENERATE_SPARSE_HEIGHT + threadY;
+			uint32_t xOffset = (tidY * 3 + groupZ) % 5;
+			uint32_t x = 5 * tidX + xOffset;
+			uint32_t y = tidY;
+			if (cpuGenerateOutputInBounds(info, x, y))
+			{
+				resolve.x[batch.count] = x;
+				resolve.y[batch.count] = y;
+				++batch.count;
+			}
+		}
 	}
 
-	// base pass for highest quality setting
-	if (context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST)
-	{
-		USER_MARKER("Generate High Quality Base Pass");
+	cpuGenerateSSAOShadowsBatch(info, &batch, &resolve, qualityLevel, false);
+}
 
-		// SSAO
-		{
-			USER_MARKER("SSAO");
+static void cpuGenerate(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, int qualityLevel, bool adaptiveBase)
+{
+	CpuSSAOTapBatch batch;
+	CpuSSAOResolveBatch resolve;
+	batch.count = 0;
 
-			for (int pass = 0; pass < 4; ++pass)
+	for (uint32_t threadY = 0; threadY < FFX_CACAO_GENERATE_HEIGHT; ++threadY)
+	{
+		for (uint32_t threadX = 0; threadX < FFX_CACAO_GENERATE_WIDTH; ++threadX)
+		{
+			uint32_t x = groupX * FFX_CACAO_GENERATE_WIDTH + threadX;
+			uint32_t y = groupY * FFX_CACAO_GENERATE_HEIGHT + threadY;
+			if (cpuGenerateOutputInBounds(info, x, y))
 			{
-				uint32_t dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_WIDTH, bsi->ssaoBufferWidth);
-				uint32_t dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_HEIGHT, bsi->ssaoBufferHeight);
-				DescriptorSetID ds = (DescriptorSetID)(DS_GENERATE_ADAPTIVE_BASE_0 + pass);
-				computeShaderDraw(context, CS_GENERATE_Q3_BASE, commandList, cbCACAOPerPassHandle[pass], ds, dispatchWidth, dispatchHeight, 1);
+				resolve.x[batch.count] = x;
+				resolve.y[batch.count] = y;
+				++batch.count;
 			}
-			GET_TIMESTAMP(BASE_SSAO_PASS);
 		}
+	}
 
-		// results written by base pass are now a reaad only resource, used in next stage
-		commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PONG], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+	cpuGenerateSSAOShadowsBatch(info, &batch, &resolve, qualityLevel, adaptiveBase);
+}
 
-		// generate importance map
-		{
-			USER_MARKER("Importance Map");
+static void cpuGenerateQ0(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuGenerateSparse(info, groupX, groupY, groupZ, 0);
+}
 
-			CD3DX12_RESOURCE_BARRIER barriers[2];
-			UINT barrierCount;
+static void cpuGenerateQ1(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuGenerateSparse(info, groupX, groupY, groupZ, 1);
+}
 
-			uint32_t dispatchWidth = dispatchSize(IMPORTANCE_MAP_WIDTH, bsi->importanceMapWidth);
-			uint32_t dispatchHeight = dispatchSize(IMPORTANCE_MAP_HEIGHT, bsi->importanceMapHeight);
+static void cpuGenerateQ2(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuGenerate(info, groupX, groupY, 2, false);
+}
 
-			computeShaderDraw(context, CS_GENERATE_IMPORTANCE_MAP, commandList, cbCACAOHandle, DS_GENERATE_IMPORTANCE_MAP, dispatchWidth, dispatchHeight, 1);
+static void cpuGenerateQ3(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuGenerate(info, groupX, groupY, 3, false);
+}
 
-			barrierCount = 0;
-			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-			commandList->ResourceBarrier(barrierCount, barriers);
+static void cpuGenerateQ3Base(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuGenerate(info, groupX, groupY, 3, true);
+}
 
-			computeShaderDraw(context, CS_POSTPROCESS_IMPORTANCE_MAP_A, commandList, cbCACAOHandle, DS_POSTPROCESS_IMPORTANCE_MAP_A, dispatchWidth, dispatchHeight, 1);
+// =============================================================================
+// SSAO tap kernels
+//
+// SIMD versions of the tap loop, evaluating CPU_SSAO_BATCH_SIZE pixels 8 (AVX2), 16 (AVX-512) or 4 (NEON) at a time.
+// They perform the same sequence of IEEE operations per pixel as cpuSSAOTapsScalar, the only differences come from
+// the compiler contracting multiplies and adds into fused multiply-adds where the instruction set has them.
+
+// point sampling of the R16_SFLOAT deinterleaved depths with a clamp sampler, flattened for SIMD lookups
+typedef struct CpuSSAODepthSource {
+	const uint8_t *data;                 ///< first texel of the array slice viewed
+	float          widths[16];           ///< mip widths, indexed by mip level
+	float          heights[16];          ///< mip heights, indexed by mip level
+	int32_t        maxX[16];             ///< mip widths - 1
+	int32_t        maxY[16];             ///< mip heights - 1
+	int32_t        rowPitches[16];       ///< mip row pitches in bytes
+	int32_t        mipOffsets[16];       ///< mip offsets in bytes from data
+	float          maxLevel;             ///< number of mip levels in the view - 1
+} CpuSSAODepthSource;
+
+static void cpuSSAODepthSourceInit(CpuSSAODepthSource *source, const CpuImageView *view)
+{
+	const CpuTexture *texture = view->texture;
+	FFX_CACAO_ASSERT(texture->format == TEXTURE_FORMAT_R16_SFLOAT);
+	FFX_CACAO_ASSERT(texture->slicePitch * texture->arraySize < 0x7FFFFFFF);
+
+	memset(source, 0, sizeof(*source));
+	source->data = texture->data + view->firstArraySlice * texture->slicePitch + texture->mipOffsets[view->mostDetailedMip];
+	source->maxLevel = (float)(view->mipLevels - 1);
+	for (uint32_t i = 0; i < view->mipLevels; ++i)
+	{
+		uint32_t mip = view->mostDetailedMip + i;
+		source->widths[i] = (float)texture->widths[mip];
+		source->heights[i] = (float)texture->heights[mip];
+		source->maxX[i] = (int32_t)texture->widths[mip] - 1;
+		source->maxY[i] = (int32_t)texture->heights[mip] - 1;
+		source->rowPitches[i] = (int32_t)texture->rowPitches[mip];
+		source->mipOffsets[i] = (int32_t)(texture->mipOffsets[mip] - texture->mipOffsets[view->mostDetailedMip]);
+	}
+}
 
-			barrierCount = 0;
-			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP_PONG], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-			commandList->ResourceBarrier(barrierCount, barriers);
+// textures are allocated with this many bytes of padding, so that 16-bit texels can be fetched with 32-bit gathers
+#define CPU_TEXTURE_PADDING 16
 
-			computeShaderDraw(context, CS_POSTPROCESS_IMPORTANCE_MAP_B, commandList, cbCACAOHandle, DS_POSTPROCESS_IMPORTANCE_MAP_B, dispatchWidth, dispatchHeight, 1);
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPU_SIMD_X86
 
-			barrierCount = 0;
-			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(context->loadCounter.resource, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
-			commandList->ResourceBarrier(barrierCount, barriers);
+#if defined(__GNUC__) || defined(__clang__)
+#define CPU_TARGET_AVX2   __attribute__((target("avx2,f16c")))
+#define CPU_TARGET_AVX512 __attribute__((target("avx512f")))
+#else
+#define CPU_TARGET_AVX2
+#define CPU_TARGET_AVX512
+#endif
 
-			GET_TIMESTAMP(IMPORTANCE_MAP);
-		}
-	}
+static void cpuCpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+{
+#ifdef _MSC_VER
+	int tmp[4];
+	__cpuidex(tmp, (int)leaf, (int)subleaf);
+	regs[0] = (uint32_t)tmp[0]; regs[1] = (uint32_t)tmp[1]; regs[2] = (uint32_t)tmp[2]; regs[3] = (uint32_t)tmp[3];
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
 
-	int blurPassCount = context->settings.blurPassCount;
-	blurPassCount = FFX_CACAO_CLAMP(blurPassCount, 0, MAX_BLUR_PASSES);
-	
-	// main ssao generation
+// the register state the OS saves on context switches
+static uint64_t cpuXgetbv()
+{
+#ifdef _MSC_VER
+	return _xgetbv(0);
+#else
+	uint32_t lo, hi;
+	__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+static bool cpuHostSupportsAvx2()
+{
+	uint32_t regs[4];
+	cpuCpuid(0, 0, regs);
+	if (regs[0] < 7)
 	{
-		USER_MARKER("Generate SSAO");
+		return false;
+	}
+	cpuCpuid(1, 0, regs);
+	bool osxsave = (regs[2] >> 27) & 1;
+	bool f16c = (regs[2] >> 29) & 1;
+	if (!osxsave || !f16c || (cpuXgetbv() & 0x06) != 0x06)
+	{
+		return false;
+	}
+	cpuCpuid(7, 0, regs);
+	return (regs[1] >> 5) & 1;
+}
 
-		// ComputeShader *generate = &context->generateSSAO[FFX_CACAO_MAX(0, context->settings.qualityLevel - 1)];
-		ComputeShaderID generate = (ComputeShaderID)(CS_GENERATE_Q0 + FFX_CACAO_MAX(0, context->settings.qualityLevel - 1));
+static bool cpuHostSupportsAvx512()
+{
+	if (!cpuHostSupportsAvx2() || (cpuXgetbv() & 0xE6) != 0xE6)
+	{
+		return false;
+	}
+	uint32_t regs[4];
+	cpuCpuid(7, 0, regs);
+	return (regs[1] >> 16) & 1;
+}
 
-		uint32_t dispatchWidth, dispatchHeight, dispatchDepth;
+CPU_TARGET_AVX2 static inline __m256 cpuSSAOSampleDepthAvx2(const CpuSSAODepthSource *source, __m256 u, __m256 v, __m256 mip)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 coordMin = _mm256_set1_ps(-16777216.0f);
+	const __m256 coordMax = _mm256_set1_ps(16777216.0f);
+	const __m256 subTexel = _mm256_set1_ps(256.0f);
+	const __m256 subTexelRcp = _mm256_set1_ps(1.0f / 256.0f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+
+	__m256 level = _mm256_min_ps(_mm256_floor_ps(_mm256_add_ps(mip, half)), _mm256_set1_ps(source->maxLevel));
+	level = _mm256_and_ps(level, _mm256_cmp_ps(mip, zero, _CMP_GT_OQ));
+	__m256i levelIndex = _mm256_cvttps_epi32(level);
+
+	__m256 width = _mm256_permutevar8x32_ps(_mm256_loadu_ps(source->widths), levelIndex);
+	__m256 height = _mm256_permutevar8x32_ps(_mm256_loadu_ps(source->heights), levelIndex);
+
+	__m256 texelX = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(u, width), coordMin), coordMax);
+	__m256 texelY = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(v, height), coordMin), coordMax);
+	texelX = _mm256_mul_ps(_mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(texelX, subTexel), half)), subTexelRcp);
+	texelY = _mm256_mul_ps(_mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(texelY, subTexel), half)), subTexelRcp);
+
+	__m256i x = _mm256_cvttps_epi32(_mm256_floor_ps(texelX));
+	__m256i y = _mm256_cvttps_epi32(_mm256_floor_ps(texelY));
+	x = _mm256_min_epi32(_mm256_max_epi32(x, _mm256_setzero_si256()), _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)source->maxX), levelIndex));
+	y = _mm256_min_epi32(_mm256_max_epi32(y, _mm256_setzero_si256()), _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)source->maxY), levelIndex));
+
+	__m256i offset = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)source->mipOffsets), levelIndex);
+	offset = _mm256_add_epi32(offset, _mm256_mullo_epi32(y, _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)source->rowPitches), levelIndex)));
+	offset = _mm256_add_epi32(offset, _mm256_slli_epi32(x, 1));
+
+	__m256i texels = _mm256_and_si256(_mm256_i32gather_epi32((const int*)source->data, offset, 1), _mm256_set1_epi32(0xFFFF));
+	texels = _mm256_permute4x64_epi64(_mm256_packus_epi32(texels, texels), 0x08);
+	return _mm256_cvtph_ps(_mm256_castsi256_si128(texels));
+}
 
-		switch (context->settings.qualityLevel)
+CPU_TARGET_AVX2 static void cpuSSAOTapsAvx2(const CpuDispatchInfo *info, int qualityLevel, CpuSSAOTapBatch *batch)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	CpuSSAODepthSource source;
+	cpuSSAODepthSourceInit(&source, &info->descriptorSet->inputs[0]);
+
+	const bool haloingReduction = qualityLevel >= CPU_HALOING_REDUCTION_ENABLE_AT_QUALITY_PRESET;
+	const bool depthMips = qualityLevel >= CPU_DEPTH_MIPS_ENABLE_AT_QUALITY_PRESET;
+
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 two = _mm256_set1_ps(2.0f);
+	const __m256 signMask = _mm256_set1_ps(-0.0f);
+	const __m256 invWidth = _mm256_set1_ps(consts->DeinterleavedDepthBufferInverseDimensions[0]);
+	const __m256 invHeight = _mm256_set1_ps(consts->DeinterleavedDepthBufferInverseDimensions[1]);
+	const __m256 uvToViewMulX = _mm256_set1_ps(consts->DepthBufferUVToViewMul[0]);
+	const __m256 uvToViewMulY = _mm256_set1_ps(consts->DepthBufferUVToViewMul[1]);
+	const __m256 uvToViewAddX = _mm256_set1_ps(consts->DepthBufferUVToViewAdd[0]);
+	const __m256 uvToViewAddY = _mm256_set1_ps(consts->DepthBufferUVToViewAdd[1]);
+	const __m256 horizonAngleThreshold = _mm256_set1_ps(consts->EffectHorizonAngleThreshold);
+	const __m256 negRecEffectRadius = _mm256_set1_ps(consts->NegRecEffectRadius);
+	const __m256 haloingAmount = _mm256_set1_ps(CPU_HALOING_REDUCTION_AMOUNT);
+	const __m256 haloingBase = _mm256_set1_ps(1.0f - CPU_HALOING_REDUCTION_AMOUNT);
+
+	for (uint32_t base = 0; base < batch->count; base += 8)
+	{
+		__m256 depthBufferU = _mm256_load_ps(batch->depthBufferU + base);
+		__m256 depthBufferV = _mm256_load_ps(batch->depthBufferV + base);
+		__m256 pixCenterPosX = _mm256_load_ps(batch->pixCenterPosX + base);
+		__m256 pixCenterPosY = _mm256_load_ps(batch->pixCenterPosY + base);
+		__m256 pixCenterPosZ = _mm256_load_ps(batch->pixCenterPosZ + base);
+		__m256 pixelNormalX = _mm256_load_ps(batch->pixelNormalX + base);
+		__m256 pixelNormalY = _mm256_load_ps(batch->pixelNormalY + base);
+		__m256 pixelNormalZ = _mm256_load_ps(batch->pixelNormalZ + base);
+		__m256 rotScale0 = _mm256_load_ps(batch->rotScale0 + base);
+		__m256 rotScale1 = _mm256_load_ps(batch->rotScale1 + base);
+		__m256 rotScale2 = _mm256_load_ps(batch->rotScale2 + base);
+		__m256 rotScale3 = _mm256_load_ps(batch->rotScale3 + base);
+		__m256 mipOffset = _mm256_load_ps(batch->mipOffset + base);
+		__m256 falloffCalcMulSq = _mm256_load_ps(batch->falloffCalcMulSq + base);
+		__m256 obscuranceSum = _mm256_load_ps(batch->obscuranceSum + base);
+		__m256 weightSum = _mm256_load_ps(batch->weightSum + base);
+		__m256i tapEnd = _mm256_load_si256((const __m256i*)(batch->tapEnd + base));
+
+		int32_t maxTapEnd = batch->tapBegin;
+		for (uint32_t lane = 0; lane < 8; ++lane)
 		{
-		case FFX_CACAO_QUALITY_LOWEST:
-		case FFX_CACAO_QUALITY_LOW:
-		case FFX_CACAO_QUALITY_MEDIUM:
-			dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_SPARSE_WIDTH, bsi->ssaoBufferWidth);
-			dispatchWidth = (dispatchWidth + 4) / 5;
-			dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_SPARSE_HEIGHT, bsi->ssaoBufferHeight);
-			dispatchDepth = 5;
-			break;
-		case FFX_CACAO_QUALITY_HIGH:
-		case FFX_CACAO_QUALITY_HIGHEST:
-			dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_WIDTH, bsi->ssaoBufferWidth);
-			dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_HEIGHT, bsi->ssaoBufferHeight);
-			dispatchDepth = 1;
-			break;
+			maxTapEnd = FFX_CACAO_MAX(maxTapEnd, batch->tapEnd[base + lane]);
 		}
 
-		for (int pass = 0; pass < 4; ++pass)
+		for (int32_t i = batch->tapBegin; i < maxTapEnd; ++i)
 		{
-			if (context->settings.qualityLevel == FFX_CACAO_QUALITY_LOWEST && (pass == 1 || pass == 2))
+			const float *newSample = CPU_SAMPLE_PATTERN_MAIN[i];
+			__m256 active = _mm256_castsi256_ps(_mm256_cmpgt_epi32(tapEnd, _mm256_set1_epi32(i)));
+			__m256 sampleX = _mm256_set1_ps(newSample[0]);
+			__m256 sampleY = _mm256_set1_ps(newSample[1]);
+			__m256 weightMod = _mm256_set1_ps(newSample[2]);
+
+			// snap to pixel center (more correct obscurance math, avoids artifacts)
+			__m256 sampleOffsetX = _mm256_round_ps(_mm256_add_ps(_mm256_mul_ps(rotScale0, sampleX), _mm256_mul_ps(rotScale1, sampleY)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m256 sampleOffsetY = _mm256_round_ps(_mm256_add_ps(_mm256_mul_ps(rotScale2, sampleX), _mm256_mul_ps(rotScale3, sampleY)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m256 offsetU = _mm256_mul_ps(sampleOffsetX, invWidth);
+			__m256 offsetV = _mm256_mul_ps(sampleOffsetY, invHeight);
+			__m256 mipLevel = depthMips ? _mm256_add_ps(_mm256_set1_ps(newSample[3]), mipOffset) : zero;
+
+			// the tap and its mirrored counterpart
+			for (int hitIndex = 0; hitIndex < 2; ++hitIndex)
 			{
-				continue;
+				__m256 samplingU = hitIndex == 0 ? _mm256_add_ps(depthBufferU, offsetU) : _mm256_sub_ps(depthBufferU, offsetU);
+				__m256 samplingV = hitIndex == 0 ? _mm256_add_ps(depthBufferV, offsetV) : _mm256_sub_ps(depthBufferV, offsetV);
+				__m256 viewspaceSampleZ = cpuSSAOSampleDepthAvx2(&source, samplingU, samplingV, mipLevel);
+
+				__m256 hitDeltaX = _mm256_sub_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(uvToViewMulX, samplingU), uvToViewAddX), viewspaceSampleZ), pixCenterPosX);
+				__m256 hitDeltaY = _mm256_sub_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(uvToViewMulY, samplingV), uvToViewAddY), viewspaceSampleZ), pixCenterPosY);
+				__m256 hitDeltaZ = _mm256_sub_ps(viewspaceSampleZ, pixCenterPosZ);
+
+				// FFX_CACAO_CalculatePixelObscurance
+				__m256 lengthSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(hitDeltaX, hitDeltaX), _mm256_mul_ps(hitDeltaY, hitDeltaY)), _mm256_mul_ps(hitDeltaZ, hitDeltaZ));
+				__m256 NdotD = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(pixelNormalX, hitDeltaX), _mm256_mul_ps(pixelNormalY, hitDeltaY)), _mm256_mul_ps(pixelNormalZ, hitDeltaZ));
+				NdotD = _mm256_div_ps(NdotD, _mm256_sqrt_ps(lengthSq));
+				__m256 falloffMult = _mm256_max_ps(zero, _mm256_add_ps(_mm256_mul_ps(lengthSq, falloffCalcMulSq), one));
+				__m256 obscurance = _mm256_mul_ps(_mm256_max_ps(zero, _mm256_sub_ps(NdotD, horizonAngleThreshold)), falloffMult);
+
+				__m256 weight = weightMod;
+				if (haloingReduction)
+				{
+					__m256 reduct = _mm256_max_ps(zero, _mm256_xor_ps(hitDeltaZ, signMask));
+					reduct = _mm256_min_ps(_mm256_max_ps(_mm256_add_ps(_mm256_mul_ps(reduct, negRecEffectRadius), two), zero), one);
+					weight = _mm256_add_ps(_mm256_mul_ps(haloingAmount, reduct), haloingBase);
+					weight = batch->adaptive ? weight : _mm256_mul_ps(weight, weightMod);
+				}
+
+				obscuranceSum = _mm256_blendv_ps(obscuranceSum, _mm256_add_ps(obscuranceSum, _mm256_mul_ps(obscurance, weight)), active);
+				weightSum = _mm256_blendv_ps(weightSum, _mm256_add_ps(weightSum, weight), active);
 			}
-
-			DescriptorSetID ds = context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST ? (DescriptorSetID)(DS_GENERATE_ADAPTIVE_0 + pass) : (DescriptorSetID)(DS_GENERATE_0 + pass);
-			computeShaderDraw(context, generate, commandList, cbCACAOPerPassHandle[pass], ds, dispatchWidth, dispatchHeight, dispatchDepth);
 		}
 
-		GET_TIMESTAMP(GENERATE_SSAO);
+		_mm256_store_ps(batch->obscuranceSum + base, obscuranceSum);
+		_mm256_store_ps(batch->weightSum + base, weightSum);
 	}
-	
-	// de-interleaved blur
-	if (blurPassCount)
-	{
-		// only need to transition pong to writable if we didn't already use it in the base pass
-		CD3DX12_RESOURCE_BARRIER barriers[] = {
-			CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PING], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
-			CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PONG], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
-		};
-		commandList->ResourceBarrier(context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST ? 2 : 1, barriers);
-
-		USER_MARKER("Deinterleaved blur");
+}
 
-		for (int pass = 0; pass < 4; ++pass)
-		{
-			if (context->settings.qualityLevel == FFX_CACAO_QUALITY_LOWEST && (pass == 1 || pass == 2))
-			{
-				continue;
-			}
+// the avx512f intrinsics of some gcc versions initialise their pass-through operands with themselves
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
 
-			uint32_t w = 4 * FFX_CACAO_BLUR_WIDTH - 2 * blurPassCount;
-			uint32_t h = 3 * FFX_CACAO_BLUR_HEIGHT - 2 * blurPassCount;
-			uint32_t blurPassIndex = blurPassCount - 1;
-			uint32_t dispatchWidth = dispatchSize(w, bsi->ssaoBufferWidth);
-			uint32_t dispatchHeight = dispatchSize(h, bsi->ssaoBufferHeight);
-			ComputeShaderID edgeSensitiveBlur = (ComputeShaderID)(CS_EDGE_SENSITIVE_BLUR_1 + blurPassCount - 1);
-			DescriptorSetID ds = (DescriptorSetID)(DS_EDGE_SENSITIVE_BLUR_0 + pass);
-			computeShaderDraw(context, edgeSensitiveBlur, commandList, cbCACAOPerPassHandle[pass], ds, dispatchWidth, dispatchHeight, 1);
-		}
+// avx512f implies fma, the embedded rounding stops the compiler from contracting products into fused multiply-adds,
+// keeping the results identical to the scalar and AVX2 kernels
+CPU_TARGET_AVX512 static inline __m512 cpuMulAvx512(__m512 a, __m512 b)
+{
+	return _mm512_mul_round_ps(a, b, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
 
-		GET_TIMESTAMP(EDGE_SENSITIVE_BLUR);
+CPU_TARGET_AVX512 static inline __m512 cpuFloorAvx512(__m512 value)
+{
+	return _mm512_roundscale_ps(value, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+}
 
-		commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PONG], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
-	}
-	else
-	{
-		commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PING], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
-	}
+CPU_TARGET_AVX512 static inline __m512 cpuRoundAvx512(__m512 value)
+{
+	return _mm512_roundscale_ps(value, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
 
+CPU_TARGET_AVX512 static inline __m512 cpuSSAOSampleDepthAvx512(const CpuSSAODepthSource *source, __m512 u, __m512 v, __m512 mip)
+{
+	const __m512 zero = _mm512_setzero_ps();
+	const __m512 coordMin = _mm512_set1_ps(-16777216.0f);
+	const __m512 coordMax = _mm512_set1_ps(16777216.0f);
+	const __m512 subTexel = _mm512_set1_ps(256.0f);
+	const __m512 subTexelRcp = _mm512_set1_ps(1.0f / 256.0f);
+	const __m512 half = _mm512_set1_ps(0.5f);
+
+	__m512 level = _mm512_min_ps(cpuFloorAvx512(_mm512_add_ps(mip, half)), _mm512_set1_ps(source->maxLevel));
+	level = _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(mip, zero, _CMP_GT_OQ), level);
+	__m512i levelIndex = _mm512_cvttps_epi32(level);
+
+	__m512 width = _mm512_permutexvar_ps(levelIndex, _mm512_loadu_ps(source->widths));
+	__m512 height = _mm512_permutexvar_ps(levelIndex, _mm512_loadu_ps(source->heights));
+
+	__m512 texelX = _mm512_min_ps(_mm512_max_ps(cpuMulAvx512(u, width), coordMin), coordMax);
+	__m512 texelY = _mm512_min_ps(_mm512_max_ps(cpuMulAvx512(v, height), coordMin), coordMax);
+	texelX = cpuMulAvx512(cpuFloorAvx512(_mm512_add_ps(cpuMulAvx512(texelX, subTexel), half)), subTexelRcp);
+	texelY = cpuMulAvx512(cpuFloorAvx512(_mm512_add_ps(cpuMulAvx512(texelY, subTexel), half)), subTexelRcp);
+
+	__m512i x = _mm512_cvttps_epi32(cpuFloorAvx512(texelX));
+	__m512i y = _mm512_cvttps_epi32(cpuFloorAvx512(texelY));
+	x = _mm512_min_epi32(_mm512_max_epi32(x, _mm512_setzero_si512()), _mm512_permutexvar_epi32(levelIndex, _mm512_loadu_si512(source->maxX)));
+	y = _mm512_min_epi32(_mm512_max_epi32(y, _mm512_setzero_si512()), _mm512_permutexvar_epi32(levelIndex, _mm512_loadu_si512(source->maxY)));
+
+	__m512i offset = _mm512_permutexvar_epi32(levelIndex, _mm512_loadu_si512(source->mipOffsets));
+	offset = _mm512_add_epi32(offset, _mm512_mullo_epi32(y, _mm512_permutexvar_epi32(levelIndex, _mm512_loadu_si512(source->rowPitches))));
+	offset = _mm512_add_epi32(offset, _mm512_slli_epi32(x, 1));
+
+	__m512i texels = _mm512_i32gather_epi32(offset, source->data, 1);
+	return _mm512_cvtph_ps(_mm512_cvtepi32_epi16(texels));
+}
 
-	if (context->useDownsampledSsao)
+CPU_TARGET_AVX512 static void cpuSSAOTapsAvx512(const CpuDispatchInfo *info, int qualityLevel, CpuSSAOTapBatch *batch)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	CpuSSAODepthSource source;
+	cpuSSAODepthSourceInit(&source, &info->descriptorSet->inputs[0]);
+
+	const bool haloingReduction = qualityLevel >= CPU_HALOING_REDUCTION_ENABLE_AT_QUALITY_PRESET;
+	const bool depthMips = qualityLevel >= CPU_DEPTH_MIPS_ENABLE_AT_QUALITY_PRESET;
+
+	const __m512 zero = _mm512_setzero_ps();
+	const __m512 one = _mm512_set1_ps(1.0f);
+	const __m512 two = _mm512_set1_ps(2.0f);
+	const __m512 invWidth = _mm512_set1_ps(consts->DeinterleavedDepthBufferInverseDimensions[0]);
+	const __m512 invHeight = _mm512_set1_ps(consts->DeinterleavedDepthBufferInverseDimensions[1]);
+	const __m512 uvToViewMulX = _mm512_set1_ps(consts->DepthBufferUVToViewMul[0]);
+	const __m512 uvToViewMulY = _mm512_set1_ps(consts->DepthBufferUVToViewMul[1]);
+	const __m512 uvToViewAddX = _mm512_set1_ps(consts->DepthBufferUVToViewAdd[0]);
+	const __m512 uvToViewAddY = _mm512_set1_ps(consts->DepthBufferUVToViewAdd[1]);
+	const __m512 horizonAngleThreshold = _mm512_set1_ps(consts->EffectHorizonAngleThreshold);
+	const __m512 negRecEffectRadius = _mm512_set1_ps(consts->NegRecEffectRadius);
+	const __m512 haloingAmount = _mm512_set1_ps(CPU_HALOING_REDUCTION_AMOUNT);
+	const __m512 haloingBase = _mm512_set1_ps(1.0f - CPU_HALOING_REDUCTION_AMOUNT);
+
+	for (uint32_t base = 0; base < batch->count; base += 16)
 	{
-		USER_MARKER("Upscale");
-
-		DescriptorSetID ds = blurPassCount ? DS_BILATERAL_UPSAMPLE_PONG : DS_BILATERAL_UPSAMPLE_PING;
-		ComputeShaderID upscaler;
-		switch (context->settings.qualityLevel)
+		__m512 depthBufferU = _mm512_load_ps(batch->depthBufferU + base);
+		__m512 depthBufferV = _mm512_load_ps(batch->depthBufferV + base);
+		__m512 pixCenterPosX = _mm512_load_ps(batch->pixCenterPosX + base);
+		__m512 pixCenterPosY = _mm512_load_ps(batch->pixCenterPosY + base);
+		__m512 pixCenterPosZ = _mm512_load_ps(batch->pixCenterPosZ + base);
+		__m512 pixelNormalX = _mm512_load_ps(batch->pixelNormalX + base);
+		__m512 pixelNormalY = _mm512_load_ps(batch->pixelNormalY + base);
+		__m512 pixelNormalZ = _mm512_load_ps(batch->pixelNormalZ + base);
+		__m512 rotScale0 = _mm512_load_ps(batch->rotScale0 + base);
+		__m512 rotScale1 = _mm512_load_ps(batch->rotScale1 + base);
+		__m512 rotScale2 = _mm512_load_ps(batch->rotScale2 + base);
+		__m512 rotScale3 = _mm512_load_ps(batch->rotScale3 + base);
+		__m512 mipOffset = _mm512_load_ps(batch->mipOffset + base);
+		__m512 falloffCalcMulSq = _mm512_load_ps(batch->falloffCalcMulSq + base);
+		__m512 obscuranceSum = _mm512_load_ps(batch->obscuranceSum + base);
+		__m512 weightSum = _mm512_load_ps(batch->weightSum + base);
+		__m512i tapEnd = _mm512_load_si512(batch->tapEnd + base);
+
+		int32_t maxTapEnd = batch->tapBegin;
+		for (uint32_t lane = 0; lane < 16; ++lane)
 		{
-		case FFX_CACAO_QUALITY_LOWEST:
-			upscaler = CS_UPSCALE_BILATERAL_5X5_HALF;
-			break;
-		case FFX_CACAO_QUALITY_LOW:
-		case FFX_CACAO_QUALITY_MEDIUM:
-			upscaler = CS_UPSCALE_BILATERAL_5X5_NON_SMART;
-			break;
-		case FFX_CACAO_QUALITY_HIGH:
-		case FFX_CACAO_QUALITY_HIGHEST:
-			upscaler = CS_UPSCALE_BILATERAL_5X5_SMART;
-			break;
+			maxTapEnd = FFX_CACAO_MAX(maxTapEnd, batch->tapEnd[base + lane]);
 		}
-		uint32_t dispatchWidth = dispatchSize(2 * FFX_CACAO_BILATERAL_UPSCALE_WIDTH, bsi->inputOutputBufferWidth);
-		uint32_t dispatchHeight = dispatchSize(2 * FFX_CACAO_BILATERAL_UPSCALE_HEIGHT, bsi->inputOutputBufferHeight);
-		computeShaderDraw(context, upscaler, commandList, cbCACAOHandle, ds, dispatchWidth, dispatchHeight, 1);
 
-		GET_TIMESTAMP(BILATERAL_UPSAMPLE);
-	}
-	else
-	{
-		USER_MARKER("Create Output");
-		DescriptorSetID ds = blurPassCount ? DS_APPLY_PONG : DS_APPLY_PING;
-		uint32_t dispatchWidth = dispatchSize(FFX_CACAO_APPLY_WIDTH, bsi->inputOutputBufferWidth);
-		uint32_t dispatchHeight = dispatchSize(FFX_CACAO_APPLY_HEIGHT, bsi->inputOutputBufferHeight);
-		switch (context->settings.qualityLevel)
+		for (int32_t i = batch->tapBegin; i < maxTapEnd; ++i)
 		{
-		case FFX_CACAO_QUALITY_LOWEST:
-			computeShaderDraw(context, CS_NON_SMART_HALF_APPLY, commandList, cbCACAOHandle, ds, dispatchWidth, dispatchHeight, 1);
-			break;
-		case FFX_CACAO_QUALITY_LOW:
-			computeShaderDraw(context, CS_NON_SMART_APPLY, commandList, cbCACAOHandle, ds, dispatchWidth, dispatchHeight, 1);
-			break;
-		default:
-			computeShaderDraw(context, CS_APPLY, commandList, cbCACAOHandle, ds, dispatchWidth, dispatchHeight, 1);
-			break;
+			const float *newSample = CPU_SAMPLE_PATTERN_MAIN[i];
+			__mmask16 active = _mm512_cmpgt_epi32_mask(tapEnd, _mm512_set1_epi32(i));
+			__m512 sampleX = _mm512_set1_ps(newSample[0]);
+			__m512 sampleY = _mm512_set1_ps(newSample[1]);
+			__m512 weightMod = _mm512_set1_ps(newSample[2]);
+
+			// snap to pixel center (more correct obscurance math, avoids artifacts)
+			__m512 sampleOffsetX = cpuRoundAvx512(_mm512_add_ps(cpuMulAvx512(rotScale0, sampleX), cpuMulAvx512(rotScale1, sampleY)));
+			__m512 sampleOffsetY = cpuRoundAvx512(_mm512_add_ps(cpuMulAvx512(rotScale2, sampleX), cpuMulAvx512(rotScale3, sampleY)));
+			__m512 offsetU = cpuMulAvx512(sampleOffsetX, invWidth);
+			__m512 offsetV = cpuMulAvx512(sampleOffsetY, invHeight);
+			__m512 mipLevel = depthMips ? _mm512_add_ps(_mm512_set1_ps(newSample[3]), mipOffset) : zero;
+
+			// the tap and its mirrored counterpart
+			for (int hitIndex = 0; hitIndex < 2; ++hitIndex)
+			{
+				__m512 samplingU = hitIndex == 0 ? _mm512_add_ps(depthBufferU, offsetU) : _mm512_sub_ps(depthBufferU, offsetU);
+				__m512 samplingV = hitIndex == 0 ? _mm512_add_ps(depthBufferV, offsetV) : _mm512_sub_ps(depthBufferV, offsetV);
+				__m512 viewspaceSampleZ = cpuSSAOSampleDepthAvx512(&source, samplingU, samplingV, mipLevel);
+
+				__m512 hitDeltaX = _mm512_sub_ps(cpuMulAvx512(_mm512_add_ps(cpuMulAvx512(uvToViewMulX, samplingU), uvToViewAddX), viewspaceSampleZ), pixCenterPosX);
+				__m512 hitDeltaY = _mm512_sub_ps(cpuMulAvx512(_mm512_add_ps(cpuMulAvx512(uvToViewMulY, samplingV), uvToViewAddY), viewspaceSampleZ), pixCenterPosY);
+				__m512 hitDeltaZ = _mm512_sub_ps(viewspaceSampleZ, pixCenterPosZ);
+
+				// FFX_CACAO_CalculatePixelObscurance
+				__m512 lengthSq = _mm512_add_ps(_mm512_add_ps(cpuMulAvx512(hitDeltaX, hitDeltaX), cpuMulAvx512(hitDeltaY, hitDeltaY)), cpuMulAvx512(hitDeltaZ, hitDeltaZ));
+				__m512 NdotD = _mm512_add_ps(_mm512_add_ps(cpuMulAvx512(pixelNormalX, hitDeltaX), cpuMulAvx512(pixelNormalY, hitDeltaY)), cpuMulAvx512(pixelNormalZ, hitDeltaZ));
+				NdotD = _mm512_div_ps(NdotD, _mm512_sqrt_ps(lengthSq));
+				__m512 falloffMult = _mm512_max_ps(zero, _mm512_add_ps(cpuMulAvx512(lengthSq, falloffCalcMulSq), one));
+				__m512 obscurance = cpuMulAvx512(_mm512_max_ps(zero, _mm512_sub_ps(NdotD, horizonAngleThreshold)), falloffMult);
+
+				__m512 weight = weightMod;
+				if (haloingReduction)
+				{
+					__m512 reduct = _mm512_max_ps(zero, _mm512_sub_ps(zero, hitDeltaZ));
+					reduct = _mm512_min_ps(_mm512_max_ps(_mm512_add_ps(cpuMulAvx512(reduct, negRecEffectRadius), two), zero), one);
+					weight = _mm512_add_ps(cpuMulAvx512(haloingAmount, reduct), haloingBase);
+					weight = batch->adaptive ? weight : cpuMulAvx512(weight, weightMod);
+				}
+
+				obscuranceSum = _mm512_mask_add_ps(obscuranceSum, active, obscuranceSum, cpuMulAvx512(obscurance, weight));
+				weightSum = _mm512_mask_add_ps(weightSum, active, weightSum, weight);
+			}
 		}
-		GET_TIMESTAMP(APPLY);
-	}
 
-	// end frame resource barrier
-	{
-		uint32_t numBarriers = 0;
-		D3D12_RESOURCE_BARRIER resourceBarriers[10] = {};
-		resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_DEINTERLEAVED_DEPTHS], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-		resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_DEINTERLEAVED_NORMALS], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-		resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->outputResource, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ);
-		resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PING], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-		if (context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST || blurPassCount)
-		{
-			resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PONG], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-		}
-		if (context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST)
-		{
-			resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-			resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP_PONG], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-			resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->loadCounter.resource, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
-		}
-		commandList->ResourceBarrier(numBarriers, resourceBarriers);
+		_mm512_store_ps(batch->obscuranceSum + base, obscuranceSum);
+		_mm512_store_ps(batch->weightSum + base, weightSum);
 	}
+}
 
-#ifdef FFX_CACAO_ENABLE_PROFILING
-	gpuTimerEndFrame(&context->gpuTimer, commandList);
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
 #endif
+#endif // CPU_SIMD_X86
 
-	return FFX_CACAO_STATUS_OK;
-
-#undef GET_TIMESTAMP
-}
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define CPU_SIMD_NEON
 
-#ifdef FFX_CACAO_ENABLE_PROFILING
-FFX_CACAO_Status FFX_CACAO_D3D12GetDetailedTimings(FFX_CACAO_D3D12Context* context, FFX_CACAO_DetailedTiming* timings)
+// neon has no gathers, the four taps are fetched one at a time
+static inline float32x4_t cpuSSAOSampleDepthNeon(const CpuSSAODepthSource *source, float32x4_t u, float32x4_t v, float32x4_t mip)
 {
-	if (context == NULL || timings == NULL)
+	float us[4], vs[4], mips[4];
+	uint16_t texels[4];
+	vst1q_f32(us, u);
+	vst1q_f32(vs, v);
+	vst1q_f32(mips, mip);
+	for (int lane = 0; lane < 4; ++lane)
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
+		uint32_t level = 0;
+		if (mips[lane] > 0.0f)
+		{
+			level = (uint32_t)FFX_CACAO_MIN(floorf(mips[lane] + 0.5f), source->maxLevel);
+		}
+		float texelX = FFX_CACAO_CLAMP(us[lane] * source->widths[level], -16777216.0f, 16777216.0f);
+		float texelY = FFX_CACAO_CLAMP(vs[lane] * source->heights[level], -16777216.0f, 16777216.0f);
+		int32_t x = (int32_t)floorf(floorf(texelX * 256.0f + 0.5f) * (1.0f / 256.0f));
+		int32_t y = (int32_t)floorf(floorf(texelY * 256.0f + 0.5f) * (1.0f / 256.0f));
+		x = FFX_CACAO_CLAMP(x, 0, source->maxX[level]);
+		y = FFX_CACAO_CLAMP(y, 0, source->maxY[level]);
+		memcpy(&texels[lane], source->data + source->mipOffsets[level] + y * source->rowPitches[level] + x * 2, sizeof(uint16_t));
 	}
-	context = getAlignedD3D12ContextPointer(context);
+	return vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(texels)));
+}
 
-	gpuTimerCollectTimings(&context->gpuTimer, timings);
+static void cpuSSAOTapsNeon(const CpuDispatchInfo *info, int qualityLevel, CpuSSAOTapBatch *batch)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	CpuSSAODepthSource source;
+	cpuSSAODepthSourceInit(&source, &info->descriptorSet->inputs[0]);
+
+	const bool haloingReduction = qualityLevel >= CPU_HALOING_REDUCTION_ENABLE_AT_QUALITY_PRESET;
+	const bool depthMips = qualityLevel >= CPU_DEPTH_MIPS_ENABLE_AT_QUALITY_PRESET;
+
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t two = vdupq_n_f32(2.0f);
+	const float32x4_t invWidth = vdupq_n_f32(consts->DeinterleavedDepthBufferInverseDimensions[0]);
+	const float32x4_t invHeight = vdupq_n_f32(consts->DeinterleavedDepthBufferInverseDimensions[1]);
+	const float32x4_t uvToViewMulX = vdupq_n_f32(consts->DepthBufferUVToViewMul[0]);
+	const float32x4_t uvToViewMulY = vdupq_n_f32(consts->DepthBufferUVToViewMul[1]);
+	const float32x4_t uvToViewAddX = vdupq_n_f32(consts->DepthBufferUVToViewAdd[0]);
+	const float32x4_t uvToViewAddY = vdupq_n_f32(consts->DepthBufferUVToViewAdd[1]);
+	const float32x4_t horizonAngleThreshold = vdupq_n_f32(consts->EffectHorizonAngleThreshold);
+	const float32x4_t negRecEffectRadius = vdupq_n_f32(consts->NegRecEffectRadius);
+	const float32x4_t haloingAmount = vdupq_n_f32(CPU_HALOING_REDUCTION_AMOUNT);
+	const float32x4_t haloingBase = vdupq_n_f32(1.0f - CPU_HALOING_REDUCTION_AMOUNT);
+
+	for (uint32_t base = 0; base < batch->count; base += 4)
+	{
+		float32x4_t depthBufferU = vld1q_f32(batch->depthBufferU + base);
+		float32x4_t depthBufferV = vld1q_f32(batch->depthBufferV + base);
+		float32x4_t pixCenterPosX = vld1q_f32(batch->pixCenterPosX + base);
+		float32x4_t pixCenterPosY = vld1q_f32(batch->pixCenterPosY + base);
+		float32x4_t pixCenterPosZ = vld1q_f32(batch->pixCenterPosZ + base);
+		float32x4_t pixelNormalX = vld1q_f32(batch->pixelNormalX + base);
+		float32x4_t pixelNormalY = vld1q_f32(batch->pixelNormalY + base);
+		float32x4_t pixelNormalZ = vld1q_f32(batch->pixelNormalZ + base);
+		float32x4_t rotScale0 = vld1q_f32(batch->rotScale0 + base);
+		float32x4_t rotScale1 = vld1q_f32(batch->rotScale1 + base);
+		float32x4_t rotScale2 = vld1q_f32(batch->rotScale2 + base);
+		float32x4_t rotScale3 = vld1q_f32(batch->rotScale3 + base);
+		float32x4_t mipOffset = vld1q_f32(batch->mipOffset + base);
+		float32x4_t falloffCalcMulSq = vld1q_f32(batch->falloffCalcMulSq + base);
+		float32x4_t obscuranceSum = vld1q_f32(batch->obscuranceSum + base);
+		float32x4_t weightSum = vld1q_f32(batch->weightSum + base);
+		int32x4_t tapEnd = vld1q_s32(batch->tapEnd + base);
+
+		int32_t maxTapEnd = FFX_CACAO_MAX(batch->tapBegin, vmaxvq_s32(tapEnd));
+
+		for (int32_t i = batch->tapBegin; i < maxTapEnd; ++i)
+		{
+			const float *newSample = CPU_SAMPLE_PATTERN_MAIN[i];
+			uint32x4_t active = vcgtq_s32(tapEnd, vdupq_n_s32(i));
+			float32x4_t sampleX = vdupq_n_f32(newSample[0]);
+			float32x4_t sampleY = vdupq_n_f32(newSample[1]);
+			float32x4_t weightMod = vdupq_n_f32(newSample[2]);
+
+			// snap to pixel center (more correct obscurance math, avoids artifacts)
+			float32x4_t sampleOffsetX = vrndnq_f32(vaddq_f32(vmulq_f32(rotScale0, sampleX), vmulq_f32(rotScale1, sampleY)));
+			float32x4_t sampleOffsetY = vrndnq_f32(vaddq_f32(vmulq_f32(rotScale2, sampleX), vmulq_f32(rotScale3, sampleY)));
+			float32x4_t offsetU = vmulq_f32(sampleOffsetX, invWidth);
+			float32x4_t offsetV = vmulq_f32(sampleOffsetY, invHeight);
+			float32x4_t mipLevel = depthMips ? vaddq_f32(vdupq_n_f32(newSample[3]), mipOffset) : zero;
+
+			// the tap and its mirrored counterpart
+			for (int hitIndex = 0; hitIndex < 2; ++hitIndex)
+			{
+				float32x4_t samplingU = hitIndex == 0 ? vaddq_f32(depthBufferU, offsetU) : vsubq_f32(depthBufferU, offsetU);
+				float32x4_t samplingV = hitIndex == 0 ? vaddq_f32(depthBufferV, offsetV) : vsubq_f32(depthBufferV, offsetV);
+				float32x4_t viewspaceSampleZ = cpuSSAOSampleDepthNeon(&source, samplingU, samplingV, mipLevel);
+
+				float32x4_t hitDeltaX = vsubq_f32(vmulq_f32(vaddq_f32(vmulq_f32(uvToViewMulX, samplingU), uvToViewAddX), viewspaceSampleZ), pixCenterPosX);
+				float32x4_t hitDeltaY = vsubq_f32(vmulq_f32(vaddq_f32(vmulq_f32(uvToViewMulY, samplingV), uvToViewAddY), viewspaceSampleZ), pixCenterPosY);
+				float32x4_t hitDeltaZ = vsubq_f32(viewspaceSampleZ, pixCenterPosZ);
+
+				// FFX_CACAO_CalculatePixelObscurance
+				float32x4_t lengthSq = vaddq_f32(vaddq_f32(vmulq_f32(hitDeltaX, hitDeltaX), vmulq_f32(hitDeltaY, hitDeltaY)), vmulq_f32(hitDeltaZ, hitDeltaZ));
+				float32x4_t NdotD = vaddq_f32(vaddq_f32(vmulq_f32(pixelNormalX, hitDeltaX), vmulq_f32(pixelNormalY, hitDeltaY)), vmulq_f32(pixelNormalZ, hitDeltaZ));
+				NdotD = vdivq_f32(NdotD, vsqrtq_f32(lengthSq));
+				float32x4_t falloffMult = vmaxq_f32(zero, vaddq_f32(vmulq_f32(lengthSq, falloffCalcMulSq), one));
+				float32x4_t obscurance = vmulq_f32(vmaxq_f32(zero, vsubq_f32(NdotD, horizonAngleThreshold)), falloffMult);
+
+				float32x4_t weight = weightMod;
+				if (haloingReduction)
+				{
+					float32x4_t reduct = vmaxq_f32(zero, vnegq_f32(hitDeltaZ));
+					reduct = vminq_f32(vmaxq_f32(vaddq_f32(vmulq_f32(reduct, negRecEffectRadius), two), zero), one);
+					weight = vaddq_f32(vmulq_f32(haloingAmount, reduct), haloingBase);
+					weight = batch->adaptive ? weight : vmulq_f32(weight, weightMod);
+				}
+
+				obscuranceSum = vbslq_f32(active, vaddq_f32(obscuranceSum, vmulq_f32(obscurance, weight)), obscuranceSum);
+				weightSum = vbslq_f32(active, vaddq_f32(weightSum, weight), weightSum);
+			}
+		}
 
-	return FFX_CACAO_STATUS_OK;
+		vst1q_f32(batch->obscuranceSum + base, obscuranceSum);
+		vst1q_f32(batch->weightSum + base, weightSum);
+	}
 }
-#endif
-#endif
+#endif // CPU_SIMD_NEON
 
-#ifdef FFX_CACAO_ENABLE_VULKAN
-inline static void setObjectName(VkDevice device, FFX_CACAO_VkContext* context, VkObjectType type, uint64_t handle, const char* name)
+// picks the widest tap kernel the host supports, the scalar loop is the reference and the fallback
+static CpuSSAOTapKernel cpuSelectSSAOTapKernel(FFX_CACAO_CpuCreateFlags flags)
 {
-	if (!context->vkSetDebugUtilsObjectName)
+	if (flags & FFX_CACAO_CPU_CREATE_DISABLE_SIMD)
 	{
-		return;
+		return cpuSSAOTapsScalar;
 	}
+#ifdef CPU_SIMD_X86
+	if (!(flags & FFX_CACAO_CPU_CREATE_DISABLE_AVX512) && cpuHostSupportsAvx512())
+	{
+		return cpuSSAOTapsAvx512;
+	}
+	if (cpuHostSupportsAvx2())
+	{
+		return cpuSSAOTapsAvx2;
+	}
+#endif
+#ifdef CPU_SIMD_NEON
+	return cpuSSAOTapsNeon;
+#else
+	return cpuSSAOTapsScalar;
+#endif
+}
 
-	VkDebugUtilsObjectNameInfoEXT info = {};
-	info.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
-	info.pNext = NULL;
-	info.objectType = type;
-	info.objectHandle = handle;
-	info.pObjectName = name;
+// =============================================================================
+// Importance Map
 
-	VkResult result = context->vkSetDebugUtilsObjectName(device, &info);
-	FFX_CACAO_ASSERT(result == VK_SUCCESS);
+// the cpu runs FFX_CACAO_GenerateImportanceMap, FFX_CACAO_PostprocessImportanceMapA and FFX_CACAO_PostprocessImportanceMapB
+// as one pass over tiles of CPU_IMPORTANCE_MAP_TILE_WIDTH x CPU_IMPORTANCE_MAP_TILE_HEIGHT texels. the intermediate maps of
+// a tile and its halo stay in groupshared memory as the unorm8 values the R8 textures would hold. rather than the
+// InterlockedAdd of every ninth texel of the shader, each task sums the importance of every texel it writes into its own
+// counter, and FFX_CACAO_CpuDraw adds the counters up once after the pass.
+
+static const float CPU_SMOOTHEN_IMPORTANCE = 1.0f;
+
+// an intermediate importance map of a tile, addressed by image coordinates clamped to the image as the samplers do
+typedef struct CpuImportanceMapSource {
+	const uint8_t *data;
+	uint32_t       pitch;
+	int32_t        originX;
+	int32_t        originY;
+	int32_t        width;
+	int32_t        height;
+} CpuImportanceMapSource;
+
+static inline float cpuImportanceMapFetch(const CpuImportanceMapSource *source, int32_t x, int32_t y)
+{
+	x = FFX_CACAO_CLAMP(x, 0, source->width - 1) - source->originX;
+	y = FFX_CACAO_CLAMP(y, 0, source->height - 1) - source->originY;
+	return (float)source->data[y * source->pitch + x] / 255.0f;
 }
 
-inline static uint32_t getBestMemoryHeapIndex(VkPhysicalDevice physicalDevice,  VkMemoryRequirements memoryRequirements, VkMemoryPropertyFlags desiredProperties)
+// the postprocess passes sample halfway between texels, the bilinear sample of the 2x2 footprint at (x, y)
+static inline float cpuImportanceMapSample(const CpuImportanceMapSource *source, int32_t x, int32_t y)
 {
-	VkPhysicalDeviceMemoryProperties memoryProperties;
-	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+	float a = cpuImportanceMapFetch(source, x + 0, y + 0);
+	float b = cpuImportanceMapFetch(source, x + 1, y + 0);
+	float c = cpuImportanceMapFetch(source, x + 0, y + 1);
+	float d = cpuImportanceMapFetch(source, x + 1, y + 1);
+	return cpuLerp(cpuLerp(a, b, 0.5f), cpuLerp(c, d, 0.5f), 0.5f);
+}
 
-	uint32_t chosenMemoryTypeIndex = VK_MAX_MEMORY_TYPES;
-	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+static inline float cpuImportanceMapShadow(const FFX_CACAO_Constants *consts, float value)
+{
+	// apply the same modifications that would have been applied in the main shader
+	float val = consts->EffectShadowStrength * value;
+	val = 1.0f - val;
+	return powf(cpuSaturate(val), consts->EffectShadowPow);
+}
+
+// FFX_CACAO_GenerateImportanceMap at texel (x, y)
+static inline uint8_t cpuGenerateImportance(const FFX_CACAO_Constants *consts, const CpuImageView *finalSsao, int32_t x, int32_t y)
+{
+	const CpuTexture *texture = finalSsao->texture;
+	uint32_t mip = finalSsao->mostDetailedMip;
+	uint32_t x0 = FFX_CACAO_MIN((uint32_t)(2 * x + 0), texture->widths[mip] - 1);
+	uint32_t x1 = FFX_CACAO_MIN((uint32_t)(2 * x + 1), texture->widths[mip] - 1);
+	uint32_t y0 = FFX_CACAO_MIN((uint32_t)(2 * y + 0), texture->heights[mip] - 1);
+	uint32_t y1 = FFX_CACAO_MIN((uint32_t)(2 * y + 1), texture->heights[mip] - 1);
+
+	uint8_t minSsao = 255;
+	uint8_t maxSsao = 0;
+	for (uint32_t i = 0; i < 4; ++i)
 	{
-		uint32_t typeBit = 1 << i;
-		// can we allocate to memory of this type
-		if (memoryRequirements.memoryTypeBits & typeBit)
+		uint32_t slice = finalSsao->firstArraySlice + FFX_CACAO_MIN(i, finalSsao->arraySize - 1);
+		uint8_t vals[4] = {
+			cpuTexelAddress(texture, x0, y0, slice, mip)[0],
+			cpuTexelAddress(texture, x1, y0, slice, mip)[0],
+			cpuTexelAddress(texture, x0, y1, slice, mip)[0],
+			cpuTexelAddress(texture, x1, y1, slice, mip)[0],
+		};
+		for (int j = 0; j < 4; ++j)
 		{
-			VkMemoryType currentMemoryType = memoryProperties.memoryTypes[i];
-			// do we want to allocate to memory of this type
-			if ((currentMemoryType.propertyFlags & desiredProperties) == desiredProperties)
-			{
-				chosenMemoryTypeIndex = i;
-				break;
-			}
+			minSsao = FFX_CACAO_MIN(minSsao, vals[j]);
+			maxSsao = FFX_CACAO_MAX(maxSsao, vals[j]);
 		}
 	}
-	return chosenMemoryTypeIndex;
-}
 
-size_t FFX_CACAO_VkGetContextSize()
-{
-	return sizeof(FFX_CACAO_VkContext) + alignof(FFX_CACAO_VkContext) - 1;
+	// the modifications are monotonic in the ssao value, so the extremes of the 16 modified values are the modified extremes
+	float a = cpuImportanceMapShadow(consts, (float)minSsao / 255.0f);
+	float b = cpuImportanceMapShadow(consts, (float)maxSsao / 255.0f);
+	float maxV = FFX_CACAO_MAX(0.0f, FFX_CACAO_MAX(a, b));
+	float minV = FFX_CACAO_MIN(1.0f, FFX_CACAO_MIN(a, b));
+
+	float minMaxDiff = maxV - minV;
+
+	return cpuEncodeUnorm8(powf(cpuSaturate(minMaxDiff * 2.0f), 0.8f));
 }
 
-FFX_CACAO_Status FFX_CACAO_VkInitContext(FFX_CACAO_VkContext* context, const FFX_CACAO_VkCreateInfo* info)
+// FFX_CACAO_PostprocessImportanceMapA or FFX_CACAO_PostprocessImportanceMapB at texel (x, y)
+static inline uint8_t cpuPostprocessImportance(const CpuImportanceMapSource *source, int32_t x, int32_t y, bool passB)
 {
-	if (context == NULL)
+	float centre = cpuImportanceMapFetch(source, x, y);
+
+	float valsX, valsY, valsZ, valsW;
+	if (!passB)
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
+		valsX = cpuImportanceMapSample(source, x - 2, y - 1);
+		valsY = cpuImportanceMapSample(source, x + 0, y - 2);
+		valsZ = cpuImportanceMapSample(source, x + 1, y + 0);
+		valsW = cpuImportanceMapSample(source, x - 1, y + 1);
 	}
-	if (info == NULL)
+	else
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
+		valsX = cpuImportanceMapSample(source, x - 1, y - 2);
+		valsY = cpuImportanceMapSample(source, x + 1, y - 1);
+		valsZ = cpuImportanceMapSample(source, x + 0, y + 1);
+		valsW = cpuImportanceMapSample(source, x - 2, y + 0);
 	}
-	context = getAlignedVkContextPointer(context);
-	memset(context, 0, sizeof(*context));
 
-	VkDevice device = info->device;
-	VkPhysicalDevice physicalDevice = info->physicalDevice;
-	VkResult result;
-	FFX_CACAO_Bool use16Bit = info->flags & FFX_CACAO_VK_CREATE_USE_16_BIT ? FFX_CACAO_TRUE : FFX_CACAO_FALSE;
-	FFX_CACAO_Status errorStatus = FFX_CACAO_STATUS_FAILED;
+	float avgVal = (valsX + valsY + valsZ + valsW) * 0.25f;
+	valsX = FFX_CACAO_MAX(valsX, valsZ);
+	valsY = FFX_CACAO_MAX(valsY, valsW);
+	float maxVal = FFX_CACAO_MAX(centre, FFX_CACAO_MAX(valsX, valsY));
 
-	context->device = device;
-	context->physicalDevice = physicalDevice;
+	return cpuEncodeUnorm8(cpuLerp(maxVal, avgVal, CPU_SMOOTHEN_IMPORTANCE));
+}
 
-	if (info->flags & FFX_CACAO_VK_CREATE_USE_DEBUG_MARKERS)
+static void cpuGenerateImportanceMap(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *finalSsao = &info->descriptorSet->inputs[0];
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
+	CpuImportanceMapTile *tile = &info->groupShared->importanceMap;
+
+	const CpuTexture *texture = output->texture;
+	int32_t width = (int32_t)texture->widths[output->mostDetailedMip];
+	int32_t height = (int32_t)texture->heights[output->mostDetailedMip];
+	int32_t tileX = (int32_t)(groupX * CPU_IMPORTANCE_MAP_TILE_WIDTH);
+	int32_t tileY = (int32_t)(groupY * CPU_IMPORTANCE_MAP_TILE_HEIGHT);
+
+	// generate the tile with the halos of both postprocess passes
+	CpuImportanceMapSource generated = { &tile->generated[0][0], CPU_IMPORTANCE_MAP_TILE_WIDTH + 4 * CPU_IMPORTANCE_MAP_HALO, tileX - 2 * CPU_IMPORTANCE_MAP_HALO, tileY - 2 * CPU_IMPORTANCE_MAP_HALO, width, height };
+	int32_t beginX = FFX_CACAO_MAX(tileX - 2 * CPU_IMPORTANCE_MAP_HALO, 0);
+	int32_t beginY = FFX_CACAO_MAX(tileY - 2 * CPU_IMPORTANCE_MAP_HALO, 0);
+	int32_t endX = FFX_CACAO_MIN(tileX + CPU_IMPORTANCE_MAP_TILE_WIDTH + 2 * CPU_IMPORTANCE_MAP_HALO, width);
+	int32_t endY = FFX_CACAO_MIN(tileY + CPU_IMPORTANCE_MAP_TILE_HEIGHT + 2 * CPU_IMPORTANCE_MAP_HALO, height);
+	for (int32_t y = beginY; y < endY; ++y)
 	{
-		context->vkCmdDebugMarkerBegin = (PFN_vkCmdDebugMarkerBeginEXT)vkGetDeviceProcAddr(device, "vkCmdDebugMarkerBeginEXT");
-		context->vkCmdDebugMarkerEnd = (PFN_vkCmdDebugMarkerEndEXT)vkGetDeviceProcAddr(device, "vkCmdDebugMarkerEndEXT");
+		for (int32_t x = beginX; x < endX; ++x)
+		{
+			tile->generated[y - generated.originY][x - generated.originX] = cpuGenerateImportance(consts, finalSsao, x, y);
+		}
 	}
-	if (info->flags & FFX_CACAO_VK_CREATE_USE_DEBUG_MARKERS)
+
+	// postprocess pass A over the tile with the halo of pass B
+	CpuImportanceMapSource postprocessedA = { &tile->postprocessedA[0][0], CPU_IMPORTANCE_MAP_TILE_WIDTH + 2 * CPU_IMPORTANCE_MAP_HALO, tileX - CPU_IMPORTANCE_MAP_HALO, tileY - CPU_IMPORTANCE_MAP_HALO, width, height };
+	beginX = FFX_CACAO_MAX(tileX - CPU_IMPORTANCE_MAP_HALO, 0);
+	beginY = FFX_CACAO_MAX(tileY - CPU_IMPORTANCE_MAP_HALO, 0);
+	endX = FFX_CACAO_MIN(tileX + CPU_IMPORTANCE_MAP_TILE_WIDTH + CPU_IMPORTANCE_MAP_HALO, width);
+	endY = FFX_CACAO_MIN(tileY + CPU_IMPORTANCE_MAP_TILE_HEIGHT + CPU_IMPORTANCE_MAP_HALO, height);
+	for (int32_t y = beginY; y < endY; ++y)
 	{
-		context->vkSetDebugUtilsObjectName = (PFN_vkSetDebugUtilsObjectNameEXT)vkGetDeviceProcAddr(device, "vkSetDebugUtilsObjectNameEXT");
+		for (int32_t x = beginX; x < endX; ++x)
+		{
+			tile->postprocessedA[y - postprocessedA.originY][x - postprocessedA.originX] = cpuPostprocessImportance(&generated, x, y, false);
+		}
 	}
 
-	uint32_t numSamplersInited = 0;
-	uint32_t numDescriptorSetLayoutsInited = 0;
-	uint32_t numPipelineLayoutsInited = 0;
-	uint32_t numShaderModulesInited = 0;
-	uint32_t numPipelinesInited = 0;
-	uint32_t numConstantBackBuffersInited = 0;
-
-	VkSampler samplers[NUM_SAMPLERS];
+	// postprocess pass B over the tile, written out and summed
+	uint32_t loadCounter = 0;
+	endX = FFX_CACAO_MIN(tileX + CPU_IMPORTANCE_MAP_TILE_WIDTH, width);
+	endY = FFX_CACAO_MIN(tileY + CPU_IMPORTANCE_MAP_TILE_HEIGHT, height);
+	for (int32_t y = tileY; y < endY; ++y)
 	{
-		VkSamplerCreateInfo samplerCreateInfo = {};
-		samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-		samplerCreateInfo.pNext = NULL;
-		samplerCreateInfo.flags = 0;
-		samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
-		samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
-		samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
-		samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-		samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-		samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-		samplerCreateInfo.mipLodBias = 0.0f;
-		samplerCreateInfo.anisotropyEnable = VK_FALSE;
-		samplerCreateInfo.compareEnable = VK_FALSE;
-		samplerCreateInfo.minLod = -1000.0f;
-		samplerCreateInfo.maxLod = 1000.0f;
-		samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
-
-		result = vkCreateSampler(device, &samplerCreateInfo, NULL, &samplers[numSamplersInited]);
-		if (result != VK_SUCCESS)
+		uint8_t *row = cpuTexelAddress(texture, 0, (uint32_t)y, output->firstArraySlice, output->mostDetailedMip);
+		for (int32_t x = tileX; x < endX; ++x)
 		{
-			goto error_init_samplers;
+			uint8_t importance = cpuPostprocessImportance(&postprocessedA, x, y, true);
+			row[x] = importance;
+			loadCounter += importance;
 		}
-		setObjectName(device, context, VK_OBJECT_TYPE_SAMPLER, (uint64_t)samplers[numSamplersInited], "FFX_CACAO_POINT_CLAMP_SAMPLER");
-		++numSamplersInited;
+	}
+	tile->loadCounter += loadCounter;
+}
 
-		samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
-		samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
-		samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+// both postprocess passes run as part of cpuGenerateImportanceMap
+static void cpuPostprocessImportanceMapA(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+}
 
-		result = vkCreateSampler(device, &samplerCreateInfo, NULL, &samplers[numSamplersInited]);
-		if (result != VK_SUCCESS)
-		{
-			goto error_init_samplers;
-		}
-		setObjectName(device, context, VK_OBJECT_TYPE_SAMPLER, (uint64_t)samplers[numSamplersInited], "FFX_CACAO_POINT_MIRROR_SAMPLER");
-		++numSamplersInited;
+static void cpuPostprocessImportanceMapB(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+}
 
-		samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
-		samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
-		samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-		samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-		samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-		samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+// =============================================================================
+// Edge Sensitive Blur
 
-		result = vkCreateSampler(device, &samplerCreateInfo, NULL, &samplers[numSamplersInited]);
-		if (result != VK_SUCCESS)
-		{
-			goto error_init_samplers;
-		}
-		setObjectName(device, context, VK_OBJECT_TYPE_SAMPLER, (uint64_t)samplers[numSamplersInited], "FFX_CACAO_LINEAR_CLAMP_SAMPLER");
-		++numSamplersInited;
+// the tile of a thread group is read into groupshared memory once, blurPasses iterations of the blur then run on it
+// while it stays in cache, and the interior which all passes saw in full is written out. pass k of a tile only needs
+// to produce the texels at least k texels away from the tile edges; the SIMD kernels round that region out to whole
+// vectors, the texels they compute beyond it may read stale values but never reach the output.
 
-		samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
-		samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
-		samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+#define CPU_BLUR_SSAO_SCALE 255.0f
+#define CPU_BLUR_EDGES_SCALE 255.5f
 
-		result = vkCreateSampler(device, &samplerCreateInfo, NULL, &samplers[numSamplersInited]);
-		if (result != VK_SUCCESS)
-		{
-			goto error_init_samplers;
-		}
-		setObjectName(device, context, VK_OBJECT_TYPE_SAMPLER, (uint64_t)samplers[numSamplersInited], "FFX_CACAO_VIEWSPACE_DEPTH_TAP_SAMPLER");
-		++numSamplersInited;
+static_assert(CPU_BLUR_TILE_WIDTH % 8 == 0 && CPU_BLUR_ARRAY_BORDER == 8, "the blur kernels process rows 8 texels at a time");
+static_assert(CPU_BLUR_TILE_WIDTH > 2 * MAX_BLUR_PASSES && CPU_BLUR_TILE_HEIGHT > 2 * MAX_BLUR_PASSES, "a blur tile must be larger than its halo");
 
-		samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
-		samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
-		samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
-		samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
-		samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
-		samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+// the edge weights of FFX_CACAO_UnpackEdges for each of the four values of a 2 bit edge
+static inline void cpuBlurEdgeWeights(const FFX_CACAO_Constants *consts, float weights[4])
+{
+	for (uint32_t i = 0; i < 4; ++i)
+	{
+		weights[i] = cpuSaturate((float)i / 3.0f + consts->InvSharpness);
+	}
+}
 
-		result = vkCreateSampler(device, &samplerCreateInfo, NULL, &samplers[numSamplersInited]);
-		if (result != VK_SUCCESS)
-		{
-			goto error_init_samplers;
-		}
-		setObjectName(device, context, VK_OBJECT_TYPE_SAMPLER, (uint64_t)samplers[numSamplersInited], "FFX_CACAO_REAL_POINT_CLAMP_SAMPLER");
-		++numSamplersInited;
+// first column of pass (1 based) which a kernel processing 8 texels at a time starts at
+static inline uint32_t cpuBlurPassBegin(uint32_t pass)
+{
+	return pass & ~7u;
+}
 
-		for (uint32_t i = 0; i < FFX_CACAO_ARRAY_SIZE(samplers); ++i)
+static void cpuEdgeSensitiveBlurScalar(const CpuDispatchInfo *info, uint32_t blurPasses, CpuBlurTile *tile)
+{
+	float edgeWeights[4];
+	cpuBlurEdgeWeights(info->constants, edgeWeights);
+
+	for (uint32_t y = 0; y < CPU_BLUR_TILE_HEIGHT; ++y)
+	{
+		for (uint32_t x = 0; x < CPU_BLUR_TILE_WIDTH; ++x)
 		{
-			context->samplers[i] = samplers[i];
+			tile->front[y + 1][x + CPU_BLUR_ARRAY_BORDER] = cpuFloatToHalf((float)tile->ssao[y][x] / CPU_BLUR_SSAO_SCALE);
+			tile->packedEdges[y][x] = (uint8_t)(cpuQuantizeHalf((float)tile->edges[y][x] / CPU_BLUR_SSAO_SCALE) * CPU_BLUR_EDGES_SCALE);
 		}
 	}
 
-	// create descriptor set layouts
-	for ( ; numDescriptorSetLayoutsInited < NUM_DESCRIPTOR_SET_LAYOUTS; ++numDescriptorSetLayoutsInited)
+	for (uint32_t pass = 1; pass <= blurPasses; ++pass)
 	{
-		VkDescriptorSetLayout descriptorSetLayout;
-		DescriptorSetLayoutMetaData dslMetaData = DESCRIPTOR_SET_LAYOUT_META_DATA[numDescriptorSetLayoutsInited];
-
-		VkDescriptorSetLayoutBinding bindings[MAX_DESCRIPTOR_BINDINGS] = {};
-		uint32_t numBindings = 0;
-		for (uint32_t samplerBinding = 0; samplerBinding < FFX_CACAO_ARRAY_SIZE(samplers); ++samplerBinding)
+		uint16_t (*src)[CPU_BLUR_ARRAY_WIDTH] = pass % 2 ? tile->front : tile->back;
+		uint16_t (*dst)[CPU_BLUR_ARRAY_WIDTH] = pass % 2 ? tile->back : tile->front;
+		for (uint32_t y = pass; y < CPU_BLUR_TILE_HEIGHT - pass; ++y)
 		{
-			VkDescriptorSetLayoutBinding binding = {};
-			binding.binding = samplerBinding;
-			binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
-			binding.descriptorCount = 1;
-			binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-			binding.pImmutableSamplers = &samplers[samplerBinding];
-			bindings[numBindings++] = binding;
+			for (uint32_t x = pass; x < CPU_BLUR_TILE_WIDTH - pass; ++x)
+			{
+				uint32_t packed = tile->packedEdges[y][x];
+				const uint16_t *centre = &src[y + 1][x + CPU_BLUR_ARRAY_BORDER];
+				float edgeL = edgeWeights[(packed >> 6) & 0x03];
+				float edgeR = edgeWeights[(packed >> 4) & 0x03];
+				float edgeT = edgeWeights[(packed >> 2) & 0x03];
+				float edgeB = edgeWeights[(packed >> 0) & 0x03];
+				float sum = cpuHalfToFloat(centre[0]) * 0.5f;
+				float weight = 0.5f;
+				sum += cpuHalfToFloat(centre[-1]) * edgeL;
+				weight += edgeL;
+				sum += cpuHalfToFloat(centre[1]) * edgeR;
+				weight += edgeR;
+				sum += cpuHalfToFloat(centre[-CPU_BLUR_ARRAY_WIDTH]) * edgeT;
+				weight += edgeT;
+				sum += cpuHalfToFloat(centre[CPU_BLUR_ARRAY_WIDTH]) * edgeB;
+				weight += edgeB;
+				dst[y + 1][x + CPU_BLUR_ARRAY_BORDER] = cpuFloatToHalf(sum / weight);
+			}
 		}
+	}
 
-		// constant buffer binding
+	uint16_t (*result)[CPU_BLUR_ARRAY_WIDTH] = blurPasses % 2 ? tile->back : tile->front;
+	for (uint32_t y = blurPasses; y < CPU_BLUR_TILE_HEIGHT - blurPasses; ++y)
+	{
+		for (uint32_t x = blurPasses; x < CPU_BLUR_TILE_WIDTH - blurPasses; ++x)
 		{
-			VkDescriptorSetLayoutBinding binding = {};
-			binding.binding = 10;
-			binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			binding.descriptorCount = 1;
-			binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-			binding.pImmutableSamplers = NULL;
-			bindings[numBindings++] = binding;
+			tile->ssao[y][x] = cpuEncodeUnorm8(cpuHalfToFloat(result[y + 1][x + CPU_BLUR_ARRAY_BORDER]));
 		}
+	}
+}
 
-		for (uint32_t inputBinding = 0; inputBinding < dslMetaData.numInputs; ++inputBinding)
+#ifdef CPU_SIMD_X86
+// 8 texels of FFX_CACAO_CalcBlurredSampleF16_4
+CPU_TARGET_AVX2 static inline __m128i cpuBlurTexelsAvx2(const uint16_t *centre, const uint8_t *packedEdges, __m256 edgeWeights)
+{
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256i mask = _mm256_set1_epi32(0x03);
+
+	__m256i packed = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)packedEdges));
+	__m256 edgeL = _mm256_permutevar8x32_ps(edgeWeights, _mm256_and_si256(_mm256_srli_epi32(packed, 6), mask));
+	__m256 edgeR = _mm256_permutevar8x32_ps(edgeWeights, _mm256_and_si256(_mm256_srli_epi32(packed, 4), mask));
+	__m256 edgeT = _mm256_permutevar8x32_ps(edgeWeights, _mm256_and_si256(_mm256_srli_epi32(packed, 2), mask));
+	__m256 edgeB = _mm256_permutevar8x32_ps(edgeWeights, _mm256_and_si256(packed, mask));
+
+	__m256 sum = _mm256_mul_ps(_mm256_cvtph_ps(_mm_load_si128((const __m128i*)centre)), half);
+	__m256 weight = half;
+	sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(centre - 1))), edgeL));
+	weight = _mm256_add_ps(weight, edgeL);
+	sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(centre + 1))), edgeR));
+	weight = _mm256_add_ps(weight, edgeR);
+	sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_cvtph_ps(_mm_load_si128((const __m128i*)(centre - CPU_BLUR_ARRAY_WIDTH))), edgeT));
+	weight = _mm256_add_ps(weight, edgeT);
+	sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_cvtph_ps(_mm_load_si128((const __m128i*)(centre + CPU_BLUR_ARRAY_WIDTH))), edgeB));
+	weight = _mm256_add_ps(weight, edgeB);
+	return _mm256_cvtps_ph(_mm256_div_ps(sum, weight), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+}
+
+CPU_TARGET_AVX2 static inline __m256 cpuBlurUnpackUnorm8Avx2(const uint8_t *values)
+{
+	return _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)values))), _mm256_set1_ps(CPU_BLUR_SSAO_SCALE));
+}
+
+CPU_TARGET_AVX2 static void cpuEdgeSensitiveBlurAvx2(const CpuDispatchInfo *info, uint32_t blurPasses, CpuBlurTile *tile)
+{
+	float weights[8] = {};
+	cpuBlurEdgeWeights(info->constants, weights);
+	const __m256 edgeWeights = _mm256_loadu_ps(weights);
+	const __m256 edgesScale = _mm256_set1_ps(CPU_BLUR_EDGES_SCALE);
+
+	for (uint32_t y = 0; y < CPU_BLUR_TILE_HEIGHT; ++y)
+	{
+		for (uint32_t x = 0; x < CPU_BLUR_TILE_WIDTH; x += 8)
 		{
-			VkDescriptorSetLayoutBinding binding = {};
-			binding.binding = 20 + inputBinding;
-			binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-			binding.descriptorCount = 1;
-			binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-			binding.pImmutableSamplers = NULL;
-			bindings[numBindings++] = binding;
+			__m128i ssao = _mm256_cvtps_ph(cpuBlurUnpackUnorm8Avx2(&tile->ssao[y][x]), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			_mm_store_si128((__m128i*)&tile->front[y + 1][x + CPU_BLUR_ARRAY_BORDER], ssao);
+
+			__m128i edges = _mm256_cvtps_ph(cpuBlurUnpackUnorm8Avx2(&tile->edges[y][x]), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+			__m256i packed = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtph_ps(edges), edgesScale));
+			__m128i packed16 = _mm_packus_epi32(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+			_mm_storel_epi64((__m128i*)&tile->packedEdges[y][x], _mm_packus_epi16(packed16, packed16));
 		}
+	}
 
-		for (uint32_t outputBinding = 0; outputBinding < dslMetaData.numOutputs; ++outputBinding)
+	for (uint32_t pass = 1; pass <= blurPasses; ++pass)
+	{
+		uint16_t (*src)[CPU_BLUR_ARRAY_WIDTH] = pass % 2 ? tile->front : tile->back;
+		uint16_t (*dst)[CPU_BLUR_ARRAY_WIDTH] = pass % 2 ? tile->back : tile->front;
+		uint32_t begin = cpuBlurPassBegin(pass);
+		for (uint32_t y = pass; y < CPU_BLUR_TILE_HEIGHT - pass; ++y)
 		{
-			VkDescriptorSetLayoutBinding binding = {};
-			binding.binding = 30 + outputBinding; // g_PrepareDepthsOut register(u0)
-			binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-			binding.descriptorCount = 1;
-			binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-			binding.pImmutableSamplers = NULL;
-			bindings[numBindings++] = binding;
+			for (uint32_t x = begin; x < CPU_BLUR_TILE_WIDTH - begin; x += 8)
+			{
+				__m128i blurred = cpuBlurTexelsAvx2(&src[y + 1][x + CPU_BLUR_ARRAY_BORDER], &tile->packedEdges[y][x], edgeWeights);
+				_mm_store_si128((__m128i*)&dst[y + 1][x + CPU_BLUR_ARRAY_BORDER], blurred);
+			}
 		}
+	}
 
-		VkDescriptorSetLayoutCreateInfo info = {};
-		info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		info.pNext = NULL;
-		info.flags = 0;
-		info.bindingCount = numBindings;
-		info.pBindings = bindings;
-
-		result = vkCreateDescriptorSetLayout(device, &info, NULL, &descriptorSetLayout);
-		if (result != VK_SUCCESS)
+	// cpuEncodeUnorm8
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 ssaoScale = _mm256_set1_ps(CPU_BLUR_SSAO_SCALE);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	uint16_t (*result)[CPU_BLUR_ARRAY_WIDTH] = blurPasses % 2 ? tile->back : tile->front;
+	for (uint32_t y = blurPasses; y < CPU_BLUR_TILE_HEIGHT - blurPasses; ++y)
+	{
+		for (uint32_t x = 0; x < CPU_BLUR_TILE_WIDTH; x += 8)
 		{
-			goto error_init_descriptor_set_layouts;
+			__m256 value = _mm256_cvtph_ps(_mm_load_si128((const __m128i*)&result[y + 1][x + CPU_BLUR_ARRAY_BORDER]));
+			value = _mm256_min_ps(_mm256_max_ps(value, zero), one);
+			__m256i encoded = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, ssaoScale), half));
+			__m128i encoded16 = _mm_packus_epi32(_mm256_castsi256_si128(encoded), _mm256_extracti128_si256(encoded, 1));
+			_mm_storel_epi64((__m128i*)&tile->ssao[y][x], _mm_packus_epi16(encoded16, encoded16));
 		}
-		setObjectName(device, context, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (uint64_t)descriptorSetLayout, dslMetaData.name);
-
-		context->descriptorSetLayouts[numDescriptorSetLayoutsInited] = descriptorSetLayout;
 	}
+}
+#endif // CPU_SIMD_X86
 
-	// create pipeline layouts
-	for ( ; numPipelineLayoutsInited < NUM_DESCRIPTOR_SET_LAYOUTS; ++numPipelineLayoutsInited)
-	{
-		VkPipelineLayout pipelineLayout;
+#ifdef CPU_SIMD_NEON
+// 4 texels of FFX_CACAO_CalcBlurredSampleF16_4
+static inline float16x4_t cpuBlurTexelsNeon(const uint16_t *centre, const uint8_t *packedEdges, uint8x16_t edgeWeights)
+{
+	const float32x4_t half = vdupq_n_f32(0.5f);
+	const uint32x4_t mask = vdupq_n_u32(0x03);
+	// byte indices into edgeWeights selecting the float of each lane
+	const uint32x4_t byteBase = vdupq_n_u32(0x03020100);
+	const uint32_t byteScale = 0x04040404;
+
+	uint32_t packedBits;
+	memcpy(&packedBits, packedEdges, sizeof(packedBits));
+	uint32x4_t packed = vmovl_u16(vget_low_u16(vmovl_u8(vcreate_u8(packedBits))));
+	float32x4_t edgeL = vreinterpretq_f32_u8(vqtbl1q_u8(edgeWeights, vreinterpretq_u8_u32(vmlaq_n_u32(byteBase, vandq_u32(vshrq_n_u32(packed, 6), mask), byteScale))));
+	float32x4_t edgeR = vreinterpretq_f32_u8(vqtbl1q_u8(edgeWeights, vreinterpretq_u8_u32(vmlaq_n_u32(byteBase, vandq_u32(vshrq_n_u32(packed, 4), mask), byteScale))));
+	float32x4_t edgeT = vreinterpretq_f32_u8(vqtbl1q_u8(edgeWeights, vreinterpretq_u8_u32(vmlaq_n_u32(byteBase, vandq_u32(vshrq_n_u32(packed, 2), mask), byteScale))));
+	float32x4_t edgeB = vreinterpretq_f32_u8(vqtbl1q_u8(edgeWeights, vreinterpretq_u8_u32(vmlaq_n_u32(byteBase, vandq_u32(packed, mask), byteScale))));
+
+	float32x4_t sum = vmulq_f32(vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(centre))), half);
+	float32x4_t weight = half;
+	sum = vaddq_f32(sum, vmulq_f32(vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(centre - 1))), edgeL));
+	weight = vaddq_f32(weight, edgeL);
+	sum = vaddq_f32(sum, vmulq_f32(vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(centre + 1))), edgeR));
+	weight = vaddq_f32(weight, edgeR);
+	sum = vaddq_f32(sum, vmulq_f32(vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(centre - CPU_BLUR_ARRAY_WIDTH))), edgeT));
+	weight = vaddq_f32(weight, edgeT);
+	sum = vaddq_f32(sum, vmulq_f32(vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(centre + CPU_BLUR_ARRAY_WIDTH))), edgeB));
+	weight = vaddq_f32(weight, edgeB);
+	return vcvt_f16_f32(vdivq_f32(sum, weight));
+}
 
-		DescriptorSetLayoutMetaData dslMetaData = DESCRIPTOR_SET_LAYOUT_META_DATA[numPipelineLayoutsInited];
+static inline float32x4_t cpuBlurUnpackUnorm8Neon(uint16x8_t values, bool high)
+{
+	uint32x4_t wide = high ? vmovl_high_u16(values) : vmovl_u16(vget_low_u16(values));
+	return vdivq_f32(vcvtq_f32_u32(wide), vdupq_n_f32(CPU_BLUR_SSAO_SCALE));
+}
 
-		VkPipelineLayoutCreateInfo info = {};
-		info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		info.pNext = NULL;
-		info.flags = 0;
-		info.setLayoutCount = 1;
-		info.pSetLayouts = &context->descriptorSetLayouts[numPipelineLayoutsInited];
-		info.pushConstantRangeCount = 0;
-		info.pPushConstantRanges = NULL;
+static void cpuEdgeSensitiveBlurNeon(const CpuDispatchInfo *info, uint32_t blurPasses, CpuBlurTile *tile)
+{
+	float weights[4];
+	cpuBlurEdgeWeights(info->constants, weights);
+	const uint8x16_t edgeWeights = vreinterpretq_u8_f32(vld1q_f32(weights));
+	const float32x4_t edgesScale = vdupq_n_f32(CPU_BLUR_EDGES_SCALE);
 
-		result = vkCreatePipelineLayout(device, &info, NULL, &pipelineLayout);
-		if (result != VK_SUCCESS)
+	for (uint32_t y = 0; y < CPU_BLUR_TILE_HEIGHT; ++y)
+	{
+		for (uint32_t x = 0; x < CPU_BLUR_TILE_WIDTH; x += 8)
 		{
-			goto error_init_pipeline_layouts;
+			uint16x8_t ssao = vmovl_u8(vld1_u8(&tile->ssao[y][x]));
+			uint16_t *front = &tile->front[y + 1][x + CPU_BLUR_ARRAY_BORDER];
+			vst1_u16(front + 0, vreinterpret_u16_f16(vcvt_f16_f32(cpuBlurUnpackUnorm8Neon(ssao, false))));
+			vst1_u16(front + 4, vreinterpret_u16_f16(vcvt_f16_f32(cpuBlurUnpackUnorm8Neon(ssao, true))));
+
+			uint16x8_t edges = vmovl_u8(vld1_u8(&tile->edges[y][x]));
+			uint32x4_t packedLow = vcvtq_u32_f32(vmulq_f32(vcvt_f32_f16(vcvt_f16_f32(cpuBlurUnpackUnorm8Neon(edges, false))), edgesScale));
+			uint32x4_t packedHigh = vcvtq_u32_f32(vmulq_f32(vcvt_f32_f16(vcvt_f16_f32(cpuBlurUnpackUnorm8Neon(edges, true))), edgesScale));
+			vst1_u8(&tile->packedEdges[y][x], vmovn_u16(vcombine_u16(vmovn_u32(packedLow), vmovn_u32(packedHigh))));
 		}
-		setObjectName(device, context, VK_OBJECT_TYPE_PIPELINE_LAYOUT, (uint64_t)pipelineLayout, dslMetaData.name);
-
-		context->pipelineLayouts[numPipelineLayoutsInited] = pipelineLayout;
 	}
 
-	for ( ; numShaderModulesInited < NUM_COMPUTE_SHADERS; ++numShaderModulesInited)
+	for (uint32_t pass = 1; pass <= blurPasses; ++pass)
 	{
-		VkShaderModule shaderModule;
-		ComputeShaderMetaData csMetaData = COMPUTE_SHADER_META_DATA[numShaderModulesInited];
+		uint16_t (*src)[CPU_BLUR_ARRAY_WIDTH] = pass % 2 ? tile->front : tile->back;
+		uint16_t (*dst)[CPU_BLUR_ARRAY_WIDTH] = pass % 2 ? tile->back : tile->front;
+		uint32_t begin = cpuBlurPassBegin(pass);
+		for (uint32_t y = pass; y < CPU_BLUR_TILE_HEIGHT - pass; ++y)
+		{
+			for (uint32_t x = begin; x < CPU_BLUR_TILE_WIDTH - begin; x += 4)
+			{
+				float16x4_t blurred = cpuBlurTexelsNeon(&src[y + 1][x + CPU_BLUR_ARRAY_BORDER], &tile->packedEdges[y][x], edgeWeights);
+				vst1_u16(&dst[y + 1][x + CPU_BLUR_ARRAY_BORDER], vreinterpret_u16_f16(blurred));
+			}
+		}
+	}
 
-		VkShaderModuleCreateInfo info = {};
-		info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		info.pNext = 0;
-		info.flags = 0;
-		ComputeShaderSPIRV spirv = use16Bit ? COMPUTE_SHADER_SPIRV_16[numShaderModulesInited] : COMPUTE_SHADER_SPIRV_32[numShaderModulesInited];
-		info.codeSize = spirv.len;
-		info.pCode = spirv.spirv;
-
-		result = vkCreateShaderModule(device, &info, NULL, &shaderModule);
-		if (result != VK_SUCCESS)
+	// cpuEncodeUnorm8
+	const float32x4_t zero = vdupq_n_f32(0.0f);
+	const float32x4_t one = vdupq_n_f32(1.0f);
+	const float32x4_t ssaoScale = vdupq_n_f32(CPU_BLUR_SSAO_SCALE);
+	const float32x4_t half = vdupq_n_f32(0.5f);
+	uint16_t (*result)[CPU_BLUR_ARRAY_WIDTH] = blurPasses % 2 ? tile->back : tile->front;
+	for (uint32_t y = blurPasses; y < CPU_BLUR_TILE_HEIGHT - blurPasses; ++y)
+	{
+		for (uint32_t x = 0; x < CPU_BLUR_TILE_WIDTH; x += 8)
 		{
-			goto error_init_shader_modules;
+			uint32x4_t encoded[2];
+			for (uint32_t i = 0; i < 2; ++i)
+			{
+				float32x4_t value = vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(&result[y + 1][x + 4 * i + CPU_BLUR_ARRAY_BORDER])));
+				value = vminq_f32(vmaxq_f32(value, zero), one);
+				encoded[i] = vcvtq_u32_f32(vaddq_f32(vmulq_f32(value, ssaoScale), half));
+			}
+			vst1_u8(&tile->ssao[y][x], vmovn_u16(vcombine_u16(vmovn_u32(encoded[0]), vmovn_u32(encoded[1]))));
 		}
-		setObjectName(device, context, VK_OBJECT_TYPE_SHADER_MODULE, (uint64_t)shaderModule, csMetaData.objectName);
-
-		context->computeShaders[numShaderModulesInited] = shaderModule;
 	}
+}
+#endif // CPU_SIMD_NEON
 
-	for ( ; numPipelinesInited < NUM_COMPUTE_SHADERS; ++numPipelinesInited)
+// picks the blur kernel for the host, as cpuSelectSSAOTapKernel does
+static CpuBlurKernel cpuSelectBlurKernel(FFX_CACAO_CpuCreateFlags flags)
+{
+	if (flags & FFX_CACAO_CPU_CREATE_DISABLE_SIMD)
 	{
-		VkPipeline pipeline;
-		ComputeShaderMetaData csMetaData = COMPUTE_SHADER_META_DATA[numPipelinesInited];
-
-		VkPipelineShaderStageCreateInfo stageInfo = {};
-		stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		stageInfo.pNext = NULL;
-		stageInfo.flags = 0;
-		stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
-		stageInfo.module = context->computeShaders[numPipelinesInited];
-		stageInfo.pName = csMetaData.name;
-		stageInfo.pSpecializationInfo = NULL;
-
-		VkComputePipelineCreateInfo info = {};
-		info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-		info.pNext = NULL;
-		info.flags = 0;
-		info.stage = stageInfo;
-		info.layout = context->pipelineLayouts[csMetaData.descriptorSetLayoutID];
-		info.basePipelineHandle = VK_NULL_HANDLE;
-		info.basePipelineIndex = 0;
-
-		result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &info, NULL, &pipeline);
-		if (result != VK_SUCCESS)
-		{
-			goto error_init_pipelines;
-		}
-		setObjectName(device, context, VK_OBJECT_TYPE_PIPELINE, (uint64_t)pipeline, csMetaData.objectName);
-
-		context->computePipelines[numPipelinesInited] = pipeline;
+		return cpuEdgeSensitiveBlurScalar;
 	}
-
-	// create descriptor pool
+#ifdef CPU_SIMD_X86
+	if (cpuHostSupportsAvx2())
 	{
-		VkDescriptorPool descriptorPool;
-
-		VkDescriptorPoolSize poolSizes[4] = {};
-		poolSizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLER;
-		poolSizes[0].descriptorCount = NUM_BACK_BUFFERS * NUM_DESCRIPTOR_SETS * 5;
-		poolSizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-		poolSizes[1].descriptorCount = NUM_BACK_BUFFERS * NUM_DESCRIPTOR_SETS * 7;
-		poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-		poolSizes[2].descriptorCount = NUM_BACK_BUFFERS * NUM_DESCRIPTOR_SETS * 4;
-		poolSizes[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolSizes[3].descriptorCount = NUM_BACK_BUFFERS * NUM_DESCRIPTOR_SETS * 1;
-
-		VkDescriptorPoolCreateInfo info = {};
-		info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		info.pNext = NULL;
-		info.flags = 0;
-		info.maxSets = NUM_BACK_BUFFERS * NUM_DESCRIPTOR_SETS;
-		info.poolSizeCount = FFX_CACAO_ARRAY_SIZE(poolSizes);
-		info.pPoolSizes = poolSizes;
+		return cpuEdgeSensitiveBlurAvx2;
+	}
+#endif
+#ifdef CPU_SIMD_NEON
+	return cpuEdgeSensitiveBlurNeon;
+#else
+	return cpuEdgeSensitiveBlurScalar;
+#endif
+}
 
-		result = vkCreateDescriptorPool(device, &info, NULL, &descriptorPool);
-		if (result != VK_SUCCESS)
-		{
-			goto error_init_descriptor_pool;
-		}
-		setObjectName(device, context, VK_OBJECT_TYPE_DESCRIPTOR_POOL, (uint64_t)descriptorPool, "FFX_CACAO_DESCRIPTOR_POOL");
+// the input texel FFX_CACAO_EdgeSensitiveBlur_SampleInput reads for an image coordinate, through a mirror sampler
+static inline int32_t cpuBlurSourceCoord(int32_t coord, float inverseSize, uint32_t size)
+{
+	float texel = cpuTexelSpace(((float)coord + 0.5f) * inverseSize, size);
+	return cpuAddress((int32_t)floorf(texel), (int32_t)size, CPU_ADDRESS_MODE_MIRROR);
+}
 
-		context->descriptorPool = descriptorPool;
-	}
+// emulates FFX_CACAO_LDSEdgeSensitiveBlur over a tile of CPU_BLUR_TILE_WIDTH x CPU_BLUR_TILE_HEIGHT texels
+static void cpuEdgeSensitiveBlur(const CpuDispatchInfo *info, uint32_t blurPasses, uint32_t groupX, uint32_t groupY)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *input = &info->descriptorSet->inputs[0];
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
+	const CpuTexture *inputTexture = input->texture;
+	const CpuTexture *outputTexture = output->texture;
+	CpuBlurTile *tile = &info->groupShared->blur;
 
-	// allocate descriptor sets
-	{
-		VkDescriptorSetLayout descriptorSetLayouts[NUM_DESCRIPTOR_SETS];
-		for (uint32_t i = 0; i < NUM_DESCRIPTOR_SETS; ++i) {
-			descriptorSetLayouts[i] = context->descriptorSetLayouts[DESCRIPTOR_SET_META_DATA[i].descriptorSetLayoutID];
-		}
+	FFX_CACAO_ASSERT(inputTexture->format == TEXTURE_FORMAT_R8G8_UNORM && outputTexture->format == TEXTURE_FORMAT_R8G8_UNORM);
 
-		for (uint32_t i = 0; i < NUM_BACK_BUFFERS; ++i) {
-			VkDescriptorSetAllocateInfo info = {};
-			info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-			info.pNext = NULL;
-			info.descriptorPool = context->descriptorPool;
-			info.descriptorSetCount = FFX_CACAO_ARRAY_SIZE(descriptorSetLayouts); // FFX_CACAO_ARRAY_SIZE(context->descriptorSetLayouts);
-			info.pSetLayouts = descriptorSetLayouts; // context->descriptorSetLayouts;
+	int32_t imageX = (int32_t)groupX * (CPU_BLUR_TILE_WIDTH - 2 * (int32_t)blurPasses) - (int32_t)blurPasses;
+	int32_t imageY = (int32_t)groupY * (CPU_BLUR_TILE_HEIGHT - 2 * (int32_t)blurPasses) - (int32_t)blurPasses;
 
-			result = vkAllocateDescriptorSets(device, &info, context->descriptorSets[i]);
-			if (result != VK_SUCCESS)
-			{
-				goto error_allocate_descriptor_sets;
-			}
-		}
+	uint32_t inputMip = input->mostDetailedMip;
+	uint32_t inputSlice = input->firstArraySlice;
+	uint32_t inputWidth = inputTexture->widths[inputMip];
+	uint32_t inputHeight = inputTexture->heights[inputMip];
 
-		char name[1024];
-		for (uint32_t j = 0; j < NUM_BACK_BUFFERS; ++j) {
-			for (uint32_t i = 0; i < NUM_DESCRIPTOR_SETS; ++i) {
-				DescriptorSetMetaData dsMetaData = DESCRIPTOR_SET_META_DATA[i];
-				snprintf(name, FFX_CACAO_ARRAY_SIZE(name), "%s_%u", dsMetaData.name, j);
-				setObjectName(device, context, VK_OBJECT_TYPE_DESCRIPTOR_SET, (uint64_t)context->descriptorSets[j][i], name);
-			}
-		}
+	int32_t columns[CPU_BLUR_TILE_WIDTH];
+	for (int32_t x = 0; x < CPU_BLUR_TILE_WIDTH; ++x)
+	{
+		columns[x] = cpuBlurSourceCoord(imageX + x, consts->SSAOBufferInverseDimensions[0], inputWidth);
 	}
+	bool contiguous = columns[CPU_BLUR_TILE_WIDTH - 1] - columns[0] == CPU_BLUR_TILE_WIDTH - 1;
 
-	// assign memory to constant buffers
-	for ( ; numConstantBackBuffersInited < NUM_BACK_BUFFERS; ++numConstantBackBuffersInited)
+	for (int32_t y = 0; y < CPU_BLUR_TILE_HEIGHT; ++y)
 	{
-		for (uint32_t j = 0; j < 4; ++j)
+		int32_t row = cpuBlurSourceCoord(imageY + y, consts->SSAOBufferInverseDimensions[1], inputHeight);
+		const uint8_t *texels = cpuTexelAddress(inputTexture, 0, row, inputSlice, inputMip);
+		if (contiguous)
 		{
-			VkBuffer buffer = context->constantBuffer[numConstantBackBuffersInited][j];
-
-			VkBufferCreateInfo info = {};
-			info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-			info.pNext = NULL;
-			info.flags = 0;
-			info.size = sizeof(FFX_CACAO_Constants);
-			info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-			info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-			info.queueFamilyIndexCount = 0;
-			info.pQueueFamilyIndices = NULL;
-
-			result = vkCreateBuffer(device, &info, NULL, &buffer);
-			if (result != VK_SUCCESS)
-			{
-				goto error_init_constant_buffers;
-			}
-			char name[1024];
-			snprintf(name, FFX_CACAO_ARRAY_SIZE(name), "FFX_CACAO_CONSTANT_BUFFER_PASS_%u_BACK_BUFFER_%u", j, numConstantBackBuffersInited);
-			setObjectName(device, context, VK_OBJECT_TYPE_BUFFER, (uint64_t)buffer, name);
-
-			VkMemoryRequirements memoryRequirements;
-			vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
-
-			uint32_t chosenMemoryTypeIndex = getBestMemoryHeapIndex(physicalDevice, memoryRequirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-			if (chosenMemoryTypeIndex == VK_MAX_MEMORY_TYPES)
-			{
-				vkDestroyBuffer(device, buffer, NULL);
-				goto error_init_constant_buffers;
-			}
-
-			VkMemoryAllocateInfo allocationInfo = {};
-			allocationInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-			allocationInfo.pNext = NULL;
-			allocationInfo.allocationSize = memoryRequirements.size;
-			allocationInfo.memoryTypeIndex = chosenMemoryTypeIndex;
-
-			VkDeviceMemory memory;
-			result = vkAllocateMemory(device, &allocationInfo, NULL, &memory);
-			if (result != VK_SUCCESS)
+			texels += 2 * columns[0];
+			for (int32_t x = 0; x < CPU_BLUR_TILE_WIDTH; ++x)
 			{
-				vkDestroyBuffer(device, buffer, NULL);
-				goto error_init_constant_buffers;
+				tile->ssao[y][x] = texels[2 * x + 0];
+				tile->edges[y][x] = texels[2 * x + 1];
 			}
-
-			result = vkBindBufferMemory(device, buffer, memory, 0);
-			if (result != VK_SUCCESS)
+		}
+		else
+		{
+			for (int32_t x = 0; x < CPU_BLUR_TILE_WIDTH; ++x)
 			{
-				vkDestroyBuffer(device, buffer, NULL);
-				goto error_init_constant_buffers;
+				tile->ssao[y][x] = texels[2 * columns[x] + 0];
+				tile->edges[y][x] = texels[2 * columns[x] + 1];
 			}
-
-			context->constantBufferMemory[numConstantBackBuffersInited][j] = memory;
-			context->constantBuffer[numConstantBackBuffersInited][j] = buffer;
 		}
 	}
 
-	// create load counter VkImage
+	// the zero border the texels at the tile edges read
+	uint16_t (*buffers[2])[CPU_BLUR_ARRAY_WIDTH] = { tile->front, tile->back };
+	for (uint32_t i = 0; i < 2; ++i)
 	{
-		VkImage image = VK_NULL_HANDLE;
-
-		VkImageCreateInfo info = {};
-		info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-		info.pNext = NULL;
-		info.flags = 0;
-		info.imageType = VK_IMAGE_TYPE_1D;
-		info.format = VK_FORMAT_R32_UINT;
-		info.extent.width = 1;
-		info.extent.height = 1;
-		info.extent.depth = 1;
-		info.mipLevels = 1;
-		info.arrayLayers = 1;
-		info.samples = VK_SAMPLE_COUNT_1_BIT;
-		info.tiling = VK_IMAGE_TILING_OPTIMAL;
-		info.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-		info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		info.queueFamilyIndexCount = 0;
-		info.pQueueFamilyIndices = NULL;
-		info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-
-		result = vkCreateImage(device, &info, NULL, &image);
-		if (result != VK_SUCCESS)
-		{
-			goto error_init_load_counter_image;
-		}
-
-		setObjectName(device, context, VK_OBJECT_TYPE_IMAGE, (uint64_t)image, "FFX_CACAO_LOAD_COUNTER");
-
-		VkMemoryRequirements memoryRequirements;
-		vkGetImageMemoryRequirements(device, image, &memoryRequirements);
-
-		uint32_t chosenMemoryTypeIndex = getBestMemoryHeapIndex(physicalDevice, memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-		if (chosenMemoryTypeIndex == VK_MAX_MEMORY_TYPES)
-		{
-			vkDestroyImage(device, image, NULL);
-			goto error_init_load_counter_image;
-		}
-
-		VkMemoryAllocateInfo allocationInfo = {};
-		allocationInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocationInfo.pNext = NULL;
-		allocationInfo.allocationSize = memoryRequirements.size;
-		allocationInfo.memoryTypeIndex = chosenMemoryTypeIndex;
-
-		VkDeviceMemory memory;
-		result = vkAllocateMemory(device, &allocationInfo, NULL, &memory);
-		if (result != VK_SUCCESS)
+		uint16_t (*buffer)[CPU_BLUR_ARRAY_WIDTH] = buffers[i];
+		memset(buffer[0], 0, sizeof(buffer[0]));
+		memset(buffer[CPU_BLUR_ARRAY_HEIGHT - 1], 0, sizeof(buffer[0]));
+		for (uint32_t y = 1; y < CPU_BLUR_ARRAY_HEIGHT - 1; ++y)
 		{
-			vkDestroyImage(device, image, NULL);
-			goto error_init_load_counter_image;
+			buffer[y][CPU_BLUR_ARRAY_BORDER - 1] = 0;
+			buffer[y][CPU_BLUR_ARRAY_BORDER + CPU_BLUR_TILE_WIDTH] = 0;
 		}
+	}
 
-		result = vkBindImageMemory(device, image, memory, 0);
-		if (result != VK_SUCCESS)
+	info->blurKernel(info, blurPasses, tile);
+
+	// the edges pass through the f16 round trip unchanged, so the input texels are stored back as they are
+	uint32_t outputMip = output->mostDetailedMip;
+	int32_t outputWidth = (int32_t)outputTexture->widths[outputMip];
+	int32_t outputHeight = (int32_t)outputTexture->heights[outputMip];
+	int32_t beginX = FFX_CACAO_MAX((int32_t)blurPasses, -imageX);
+	int32_t endX = FFX_CACAO_MIN(CPU_BLUR_TILE_WIDTH - (int32_t)blurPasses, outputWidth - imageX);
+	int32_t beginY = FFX_CACAO_MAX((int32_t)blurPasses, -imageY);
+	int32_t endY = FFX_CACAO_MIN(CPU_BLUR_TILE_HEIGHT - (int32_t)blurPasses, outputHeight - imageY);
+	for (int32_t y = beginY; y < endY; ++y)
+	{
+		uint8_t *texels = cpuTexelAddress(outputTexture, 0, imageY + y, output->firstArraySlice, outputMip);
+		for (int32_t x = beginX; x < endX; ++x)
 		{
-			vkDestroyImage(device, image, NULL);
-			goto error_init_load_counter_image;
+			texels[2 * (imageX + x) + 0] = tile->ssao[y][x];
+			texels[2 * (imageX + x) + 1] = tile->edges[y][x];
 		}
-
-		context->loadCounter = image;
-		context->loadCounterMemory = memory;
 	}
+}
 
-	// create load counter view
-	{
-		VkImageView imageView;
+#define CPU_EDGE_SENSITIVE_BLUR(blur_passes) \
+	static void cpuEdgeSensitiveBlur##blur_passes(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ) \
+	{ \
+		cpuEdgeSensitiveBlur(info, blur_passes, groupX, groupY); \
+	}
 
-		VkImageViewCreateInfo info = {};
-		info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		info.pNext = NULL;
-		info.flags = 0;
-		info.image = context->loadCounter;
-		info.viewType = VK_IMAGE_VIEW_TYPE_1D;
-		info.format = VK_FORMAT_R32_UINT;
-		info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		info.subresourceRange.baseMipLevel = 0;
-		info.subresourceRange.levelCount = 1;
-		info.subresourceRange.baseArrayLayer = 0;
-		info.subresourceRange.layerCount = 1;
+CPU_EDGE_SENSITIVE_BLUR(1)
+CPU_EDGE_SENSITIVE_BLUR(2)
+CPU_EDGE_SENSITIVE_BLUR(3)
+CPU_EDGE_SENSITIVE_BLUR(4)
+CPU_EDGE_SENSITIVE_BLUR(5)
+CPU_EDGE_SENSITIVE_BLUR(6)
+CPU_EDGE_SENSITIVE_BLUR(7)
+CPU_EDGE_SENSITIVE_BLUR(8)
 
-		result = vkCreateImageView(device, &info, NULL, &imageView);
-		if (result != VK_SUCCESS)
-		{
-			goto error_init_load_counter_view;
-		}
+#undef CPU_EDGE_SENSITIVE_BLUR
 
-		context->loadCounterView = imageView;
-	}
+// =============================================================================
+// Apply
 
-#ifdef FFX_CACAO_ENABLE_PROFILING
-	// create timestamp query pool
-	{
-		VkQueryPool queryPool = VK_NULL_HANDLE;
+static inline void cpuApplyThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *finalSsao = &info->descriptorSet->inputs[0];
+
+	// calculate index in the four deinterleaved source array texture
+	int mx = (int)(x % 2);
+	int my = (int)(y % 2);
+	int ic = mx + my * 2;             // center index
+	int ih = (1 - mx) + my * 2;       // neighbouring, horizontal
+	int iv = mx + (1 - my) * 2;       // neighbouring, vertical
+	int id = (1 - mx) + (1 - my) * 2; // diagonal
+
+	CpuFloat4 centerVal = cpuLoad(finalSsao, x / 2, y / 2, ic, 0);
+
+	float ao = centerVal.x;
+
+	CpuFloat4 edgesLRTB = cpuUnpackEdges(consts, centerVal.y);
+
+	// convert index shifts to sampling offsets
+	float fmx = (float)mx;
+	float fmy = (float)my;
+
+	// in case of an edge, push sampling offsets away from the edge (towards pixel center)
+	float fmxe = (edgesLRTB.y - edgesLRTB.x);
+	float fmye = (edgesLRTB.w - edgesLRTB.z);
+
+	// calculate final sampling offsets and sample using bilinear filter
+	float px = (float)x;
+	float py = (float)y;
+	float scaleX = 0.5f * consts->SSAOBufferInverseDimensions[0];
+	float scaleY = 0.5f * consts->SSAOBufferInverseDimensions[1];
+	float aoH = cpuSampleLinear(finalSsao, (px + fmx + fmxe - 0.5f) * scaleX, (py + 0.5f - fmy) * scaleY, (float)ih);
+	float aoV = cpuSampleLinear(finalSsao, (px + 0.5f - fmx) * scaleX, (py + fmy - 0.5f + fmye) * scaleY, (float)iv);
+	float aoD = cpuSampleLinear(finalSsao, (px + fmx - 0.5f + fmxe) * scaleX, (py + fmy - 0.5f + fmye) * scaleY, (float)id);
+
+	// reduce weight for samples near edge - if the edge is on both sides, weight goes to 0
+	float blendWeightsX = 1.0f;
+	float blendWeightsY = (edgesLRTB.x + edgesLRTB.y) * 0.5f;
+	float blendWeightsZ = (edgesLRTB.z + edgesLRTB.w) * 0.5f;
+	float blendWeightsW = (blendWeightsY + blendWeightsZ) * 0.5f;
+
+	// calculate weighted average
+	float blendWeightsSum = blendWeightsX + blendWeightsY + blendWeightsZ + blendWeightsW;
+	ao = (ao * blendWeightsX + aoH * blendWeightsY + aoV * blendWeightsZ + aoD * blendWeightsW) / blendWeightsSum;
+
+	cpuStoreFloat(&info->descriptorSet->outputs[0], x, y, 0, ao);
+}
 
-		VkQueryPoolCreateInfo info = {};
-		info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
-		info.pNext = NULL;
-		info.flags = 0;
-		info.queryType = VK_QUERY_TYPE_TIMESTAMP;
-		info.queryCount = NUM_TIMESTAMPS * NUM_BACK_BUFFERS;
+static inline void cpuNonSmartApplyThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *finalSsao = &info->descriptorSet->inputs[0];
+	float u = (float)x * consts->InputOutputBufferInverseDimensions[0];
+	float v = (float)y * consts->InputOutputBufferInverseDimensions[1];
+	float a = cpuSampleLinear(finalSsao, u, v, 0.0f);
+	float b = cpuSampleLinear(finalSsao, u, v, 1.0f);
+	float c = cpuSampleLinear(finalSsao, u, v, 2.0f);
+	float d = cpuSampleLinear(finalSsao, u, v, 3.0f);
+	float avg = (a + b + c + d) * 0.25f;
+
+	cpuStoreFloat(&info->descriptorSet->outputs[0], x, y, 0, avg);
+}
 
-		result = vkCreateQueryPool(device, &info, NULL, &queryPool);
-		if (result != VK_SUCCESS)
-		{
-			goto error_init_query_pool;
-		}
+static inline void cpuNonSmartHalfApplyThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *finalSsao = &info->descriptorSet->inputs[0];
+	float u = (float)x * consts->InputOutputBufferInverseDimensions[0];
+	float v = (float)y * consts->InputOutputBufferInverseDimensions[1];
+	float a = cpuSampleLinear(finalSsao, u, v, 0.0f);
+	float d = cpuSampleLinear(finalSsao, u, v, 3.0f);
+	float avg = (a + d) * 0.5f;
+
+	cpuStoreFloat(&info->descriptorSet->outputs[0], x, y, 0, avg);
+}
 
-		context->timestampQueryPool = queryPool;
-	}
-#endif
+static void cpuApply(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_APPLY_WIDTH, FFX_CACAO_APPLY_HEIGHT, cpuApplyThread)
+}
 
-	return FFX_CACAO_STATUS_OK;
+static void cpuNonSmartApply(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_APPLY_WIDTH, FFX_CACAO_APPLY_HEIGHT, cpuNonSmartApplyThread)
+}
 
-#ifdef FFX_CACAO_ENABLE_PROFILING
-	vkDestroyQueryPool(device, context->timestampQueryPool, NULL);
-error_init_query_pool:
-#endif
+static void cpuNonSmartHalfApply(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_APPLY_WIDTH, FFX_CACAO_APPLY_HEIGHT, cpuNonSmartHalfApplyThread)
+}
 
-	vkDestroyImageView(device, context->loadCounterView, NULL);
-error_init_load_counter_view:
-	vkDestroyImage(device, context->loadCounter, NULL);
-	vkFreeMemory(device, context->loadCounterMemory, NULL);
-error_init_load_counter_image:
+// =============================================================================
+// Bilateral Upscale
+
+typedef enum CpuBilateralUpscaleMode {
+	CPU_BILATERAL_UPSCALE_MODE_SMART,
+	CPU_BILATERAL_UPSCALE_MODE_NON_SMART,
+	CPU_BILATERAL_UPSCALE_MODE_HALF,
+} CpuBilateralUpscaleMode;
+
+// the ssao and deinterleaved depth arrays the bilateral upscale reads, addressed directly
+typedef struct CpuBilateralUpscaleSource {
+	const uint8_t *ssaoSlices[4];  ///< first texel of each R8G8 ssao slice
+	const uint8_t *depthSlices[4]; ///< first texel of each R16F deinterleaved depth slice, at the most detailed mip
+	size_t         ssaoRowPitch;
+	size_t         depthRowPitch;
+	int32_t        ssaoWidth;
+	int32_t        ssaoHeight;
+	int32_t        depthWidth;
+	int32_t        depthHeight;
+	float          unorm8[256];    ///< the values of the unorm8 ssao texels
+} CpuBilateralUpscaleSource;
+
+static void cpuBilateralUpscaleSourceInit(CpuBilateralUpscaleSource *source, const CpuImageView *ssaoInput, const CpuImageView *downscaledDepth)
+{
+	const CpuTexture *ssaoTexture = ssaoInput->texture;
+	const CpuTexture *depthTexture = downscaledDepth->texture;
+	FFX_CACAO_ASSERT(ssaoTexture->format == TEXTURE_FORMAT_R8G8_UNORM && ssaoInput->arraySize == 4);
+	FFX_CACAO_ASSERT(depthTexture->format == TEXTURE_FORMAT_R16_SFLOAT && downscaledDepth->arraySize == 4);
 
-error_init_constant_buffers:
-	for (uint32_t i = 0; i < numConstantBackBuffersInited; ++i)
+	for (uint32_t i = 0; i < 4; ++i)
 	{
-		for (uint32_t j = 0; j < 4; ++j)
-		{
-			vkDestroyBuffer(device, context->constantBuffer[i][j], NULL);
-			vkFreeMemory(device, context->constantBufferMemory[i][j], NULL);
-		}
+		source->ssaoSlices[i] = cpuTexelAddress(ssaoTexture, 0, 0, ssaoInput->firstArraySlice + i, ssaoInput->mostDetailedMip);
+		source->depthSlices[i] = cpuTexelAddress(depthTexture, 0, 0, downscaledDepth->firstArraySlice + i, downscaledDepth->mostDetailedMip);
 	}
-	
-error_allocate_descriptor_sets:
-	vkDestroyDescriptorPool(device, context->descriptorPool, NULL);
-error_init_descriptor_pool:
-
-error_init_pipelines:
-	for (uint32_t i = 0; i < numPipelinesInited; ++i)
+	source->ssaoRowPitch = ssaoTexture->rowPitches[ssaoInput->mostDetailedMip];
+	source->depthRowPitch = depthTexture->rowPitches[downscaledDepth->mostDetailedMip];
+	source->ssaoWidth = (int32_t)ssaoTexture->widths[ssaoInput->mostDetailedMip];
+	source->ssaoHeight = (int32_t)ssaoTexture->heights[ssaoInput->mostDetailedMip];
+	source->depthWidth = (int32_t)depthTexture->widths[downscaledDepth->mostDetailedMip];
+	source->depthHeight = (int32_t)depthTexture->heights[downscaledDepth->mostDetailedMip];
+	for (uint32_t i = 0; i < 256; ++i)
 	{
-		vkDestroyPipeline(device, context->computePipelines[i], NULL);
+		source->unorm8[i] = (float)i / 255.0f;
 	}
+}
 
-error_init_shader_modules:
-	for (uint32_t i = 0; i < numShaderModulesInited; ++i)
-	{
-		vkDestroyShaderModule(device, context->computeShaders[i], NULL);
-	}
+static inline const uint8_t *cpuBilateralUpscaleSsaoTexel(const CpuBilateralUpscaleSource *source, int32_t x, int32_t y, int32_t slice)
+{
+	return source->ssaoSlices[slice] + (size_t)y * source->ssaoRowPitch + 2 * (size_t)x;
+}
 
-error_init_pipeline_layouts:
-	for (uint32_t i = 0; i < numPipelineLayoutsInited; ++i)
-	{
-		vkDestroyPipelineLayout(device, context->pipelineLayouts[i], NULL);
-	}
+// the red channel of an ssao texel
+static inline float cpuBilateralUpscaleSsao(const CpuBilateralUpscaleSource *source, int32_t x, int32_t y, int32_t slice)
+{
+	return source->unorm8[cpuBilateralUpscaleSsaoTexel(source, x, y, slice)[0]];
+}
 
-error_init_descriptor_set_layouts:
-	for (uint32_t i = 0; i < numDescriptorSetLayoutsInited; ++i)
+// floorf of the finite texture coordinates of the upscale, which compilers targeting baseline x86-64 call out to libm for
+static inline float cpuBilateralUpscaleFloor(float value)
+{
+	if (!(fabsf(value) < 8388608.0f))
 	{
-		vkDestroyDescriptorSetLayout(device, context->descriptorSetLayouts[i], NULL);
+		return value;
 	}
+	float truncated = (float)(int32_t)value;
+	return truncated - (float)(truncated > value);
+}
 
+// cpuTexelSpace with cpuBilateralUpscaleFloor
+static inline float cpuBilateralUpscaleTexelSpace(float uv, int32_t size)
+{
+	float coord = uv * (float)size;
+	coord = FFX_CACAO_CLAMP(coord, -16777216.0f, 16777216.0f);
+	return cpuBilateralUpscaleFloor(coord * 256.0f + 0.5f) * (1.0f / 256.0f);
+}
 
-error_init_samplers:
-	for (uint32_t i = 0; i < numSamplersInited; ++i)
+// Texture.Load of a deinterleaved depth, out of bounds accesses return zero
+static inline float cpuBilateralUpscaleLoadDepth(const CpuBilateralUpscaleSource *source, int32_t x, int32_t y, int32_t slice)
+{
+	if (x < 0 || y < 0 || x >= source->depthWidth || y >= source->depthHeight)
 	{
-		vkDestroySampler(device, context->samplers[i], NULL);
+		return 0.0f;
 	}
+	uint16_t depth;
+	memcpy(&depth, source->depthSlices[slice] + (size_t)y * source->depthRowPitch + 2 * (size_t)x, sizeof(depth));
+	return cpuHalfToFloat(depth);
+}
 
-	return errorStatus;
+// cpuSampleLinear of an ssao slice
+static inline float cpuBilateralUpscaleSampleLinear(const CpuBilateralUpscaleSource *source, float u, float v, int32_t slice)
+{
+	float tx = cpuBilateralUpscaleTexelSpace(u, source->ssaoWidth) - 0.5f;
+	float ty = cpuBilateralUpscaleTexelSpace(v, source->ssaoHeight) - 0.5f;
+	float x0 = cpuBilateralUpscaleFloor(tx);
+	float y0 = cpuBilateralUpscaleFloor(ty);
+	float fx = tx - x0;
+	float fy = ty - y0;
+	int32_t xa = cpuAddress((int32_t)x0 + 0, source->ssaoWidth, CPU_ADDRESS_MODE_CLAMP);
+	int32_t xb = cpuAddress((int32_t)x0 + 1, source->ssaoWidth, CPU_ADDRESS_MODE_CLAMP);
+	int32_t ya = cpuAddress((int32_t)y0 + 0, source->ssaoHeight, CPU_ADDRESS_MODE_CLAMP);
+	int32_t yb = cpuAddress((int32_t)y0 + 1, source->ssaoHeight, CPU_ADDRESS_MODE_CLAMP);
+	float a = cpuBilateralUpscaleSsao(source, xa, ya, slice);
+	float b = cpuBilateralUpscaleSsao(source, xb, ya, slice);
+	float c = cpuBilateralUpscaleSsao(source, xa, yb, slice);
+	float d = cpuBilateralUpscaleSsao(source, xb, yb, slice);
+	return cpuLerp(cpuLerp(a, b, fx), cpuLerp(c, d, fx), fy);
 }
 
-FFX_CACAO_Status FFX_CACAO_VkDestroyContext(FFX_CACAO_VkContext* context)
+// the texel cpuSamplePoint with a clamp sampler reads for a texture coordinate
+static inline int32_t cpuBilateralUpscalePointTexel(float uv, int32_t size)
 {
-	if (context == NULL)
+	return cpuAddress((int32_t)floorf(cpuTexelSpace(uv, (uint32_t)size)), size, CPU_ADDRESS_MODE_CLAMP);
+}
+
+// the sample locations of a column or row of the groupshared buffer
+typedef struct CpuBilateralUpscaleLine {
+	uint32_t image;       ///< image coordinate, wrapped around for the first group as in the shader
+	int32_t  center;      ///< smart: texel of the center value, the shader converts the image coordinate to int
+	int32_t  centerSlice; ///< smart: signed remainder of the image coordinate the slice of the center value is computed from
+	int32_t  depth;       ///< texel of the deinterleaved depth
+	int32_t  pointA;      ///< non smart and half: texel of the point samples offset by half a texel on odd coordinates
+	int32_t  pointB;      ///< non smart and half: texel of the point samples offset by minus half a texel on even coordinates
+} CpuBilateralUpscaleLine;
+
+static void cpuBilateralUpscaleLineInit(CpuBilateralUpscaleLine *line, uint32_t image, uint32_t depthImage, float inverseSize, int32_t size, float depthOffset)
+{
+	line->image = image;
+	line->center = (int32_t)image / 2;
+	line->centerSlice = (int32_t)image % 2;
+	line->depth = (int32_t)(uint32_t)((float)(depthImage / 2) + depthOffset);
+
+	float sampleLoc = ((float)(image / 2) + 0.5f) * inverseSize;
+	float sampleLocA = sampleLoc, sampleLocB = sampleLoc;
+	if (image % 2)
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
+		sampleLocA += 0.5f * inverseSize;
 	}
-	context = getAlignedVkContextPointer(context);
-
-	VkDevice device = context->device;
+	else
+	{
+		sampleLocB -= 0.5f * inverseSize;
+	}
+	line->pointA = cpuBilateralUpscalePointTexel(sampleLocA, size);
+	line->pointB = cpuBilateralUpscalePointTexel(sampleLocB, size);
+}
 
-#ifdef FFX_CACAO_ENABLE_PROFILING
-	vkDestroyQueryPool(device, context->timestampQueryPool, NULL);
-#endif
+// computes the groupshared values of FFX_CACAO_BilateralUpscaleNxN (or FFX_CACAO_UpscaleBilateral5x5Half) for a thread group
+static void cpuBilateralUpscaleFillBuffer(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, CpuBilateralUpscaleMode mode, CpuBilateralUpscaleTile *tile)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	float invW = consts->SSAOBufferInverseDimensions[0];
+	float invH = consts->SSAOBufferInverseDimensions[1];
+	bool smart = mode == CPU_BILATERAL_UPSCALE_MODE_SMART;
 
-	vkDestroyImageView(device, context->loadCounterView, NULL);
-	vkDestroyImage(device, context->loadCounter, NULL);
-	vkFreeMemory(device, context->loadCounterMemory, NULL);
+	CpuBilateralUpscaleSource source;
+	cpuBilateralUpscaleSourceInit(&source, &info->descriptorSet->inputs[0], &info->descriptorSet->inputs[2]);
 
-	for (uint32_t i = 0; i < NUM_BACK_BUFFERS; ++i)
+	CpuBilateralUpscaleLine columns[CPU_BILATERAL_UPSCALE_BUFFER_WIDTH];
+	CpuBilateralUpscaleLine rows[CPU_BILATERAL_UPSCALE_BUFFER_HEIGHT];
+	for (uint32_t bufferX = 0; bufferX < CPU_BILATERAL_UPSCALE_BUFFER_WIDTH; ++bufferX)
 	{
-		for (uint32_t j = 0; j < 4; ++j)
-		{
-			vkDestroyBuffer(device, context->constantBuffer[i][j], NULL);
-			vkFreeMemory(device, context->constantBufferMemory[i][j], NULL);
-		}
+		uint32_t imageX = groupX * CPU_BILATERAL_UPSCALE_WIDTH + bufferX - 2;
+		// the smart upscale increments the image coordinate before computing the depth location
+		uint32_t depthX = smart ? imageX + 1 : imageX;
+		cpuBilateralUpscaleLineInit(&columns[bufferX], imageX, depthX, invW, source.ssaoWidth, consts->DeinterleavedDepthBufferOffset[0]);
 	}
-
-	vkDestroyDescriptorPool(device, context->descriptorPool, NULL);
-
-	for (uint32_t i = 0; i < NUM_COMPUTE_SHADERS; ++i)
+	for (uint32_t bufferY = 0; bufferY < CPU_BILATERAL_UPSCALE_BUFFER_HEIGHT; ++bufferY)
 	{
-		vkDestroyPipeline(device, context->computePipelines[i], NULL);
+		uint32_t imageY = groupY * CPU_BILATERAL_UPSCALE_HEIGHT + bufferY - 2;
+		cpuBilateralUpscaleLineInit(&rows[bufferY], imageY, imageY, invH, source.ssaoHeight, consts->DeinterleavedDepthBufferOffset[1]);
 	}
 
-	for (uint32_t i = 0; i < NUM_COMPUTE_SHADERS; ++i)
+	for (uint32_t bufferY = 0; bufferY < CPU_BILATERAL_UPSCALE_BUFFER_HEIGHT; ++bufferY)
 	{
-		vkDestroyShaderModule(device, context->computeShaders[i], NULL);
-	}
+		const CpuBilateralUpscaleLine *row = &rows[bufferY];
+		for (uint32_t bufferX = 0; bufferX < CPU_BILATERAL_UPSCALE_BUFFER_WIDTH; ++bufferX)
+		{
+			const CpuBilateralUpscaleLine *column = &columns[bufferX];
+			float depth, ssaoVal;
 
-	for (uint32_t i = 0; i < NUM_DESCRIPTOR_SET_LAYOUTS; ++i)
-	{
-		vkDestroyPipelineLayout(device, context->pipelineLayouts[i], NULL);
-	}
+			if (smart)
+			{
+				// out of bounds texels, and those of negative slices, read zero
+				int32_t centerSlice = column->centerSlice + 2 * row->centerSlice;
+				float ao = 0.0f, packedEdges = 0.0f;
+				if (column->center >= 0 && row->center >= 0 && column->center < source.ssaoWidth && row->center < source.ssaoHeight && centerSlice >= 0)
+				{
+					const uint8_t *centerVal = cpuBilateralUpscaleSsaoTexel(&source, column->center, row->center, centerSlice);
+					ao = source.unorm8[centerVal[0]];
+					packedEdges = source.unorm8[centerVal[1]];
+				}
+
+				int mx = (int)(column->image % 2);
+				int my = (int)(row->image % 2);
+
+				int ic = mx + my * 2;             // center index
+				int ih = (1 - mx) + my * 2;       // neighbouring, horizontal
+				int iv = mx + (1 - my) * 2;       // neighbouring, vertical
+				int id = (1 - mx) + (1 - my) * 2; // diagonal
+
+				CpuFloat4 edgesLRTB = cpuUnpackEdges(consts, packedEdges);
+
+				// convert index shifts to sampling offsets
+				float fmx = (float)mx;
+				float fmy = (float)my;
+
+				// in case of an edge, push sampling offsets away from the edge (towards pixel center)
+				float fmxe = (edgesLRTB.y - edgesLRTB.x);
+				float fmye = (edgesLRTB.w - edgesLRTB.z);
+
+				// calculate final sampling offsets and sample using bilinear filter
+				float pX = (float)column->image;
+				float pY = (float)row->image;
+				float aoH = cpuBilateralUpscaleSampleLinear(&source, (pX + fmx + fmxe - 0.5f) * 0.5f * invW, (pY + 0.5f - fmy) * 0.5f * invH, ih);
+				float aoV = cpuBilateralUpscaleSampleLinear(&source, (pX + 0.5f - fmx) * 0.5f * invW, (pY + fmy - 0.5f + fmye) * 0.5f * invH, iv);
+				float aoD = cpuBilateralUpscaleSampleLinear(&source, (pX + fmx - 0.5f + fmxe) * 0.5f * invW, (pY + fmy - 0.5f + fmye) * 0.5f * invH, id);
+
+				// reduce weight for samples near edge - if the edge is on both sides, weight goes to 0
+				float blendWeightsX = 1.0f;
+				float blendWeightsY = (edgesLRTB.x + edgesLRTB.y) * 0.5f;
+				float blendWeightsZ = (edgesLRTB.z + edgesLRTB.w) * 0.5f;
+				float blendWeightsW = (blendWeightsY + blendWeightsZ) * 0.5f;
+
+				// calculate weighted average
+				float blendWeightsSum = blendWeightsX + blendWeightsY + blendWeightsZ + blendWeightsW;
+				ssaoVal = (ao * blendWeightsX + aoH * blendWeightsY + aoV * blendWeightsZ + aoD * blendWeightsW) / blendWeightsSum;
+				depth = cpuBilateralUpscaleLoadDepth(&source, column->depth, row->depth, ic);
+			}
+			else if (mode == CPU_BILATERAL_UPSCALE_MODE_NON_SMART)
+			{
+				float ssaoVal0 = cpuBilateralUpscaleSsao(&source, column->pointA, row->pointA, 0);
+				float ssaoVal1 = cpuBilateralUpscaleSsao(&source, column->pointB, row->pointA, 1);
+				float ssaoVal2 = cpuBilateralUpscaleSsao(&source, column->pointA, row->pointB, 2);
+				float ssaoVal3 = cpuBilateralUpscaleSsao(&source, column->pointB, row->pointB, 3);
+				ssaoVal = (ssaoVal0 + ssaoVal1 + ssaoVal2 + ssaoVal3) * 0.25f;
+				depth = cpuBilateralUpscaleLoadDepth(&source, column->depth, row->depth, (int32_t)(2 * (row->image % 2) + column->image % 2));
+			}
+			else
+			{
+				float ssaoVal0 = cpuBilateralUpscaleSsao(&source, column->pointA, row->pointA, 0);
+				float ssaoVal1 = cpuBilateralUpscaleSsao(&source, column->pointB, row->pointB, 3);
+				ssaoVal = (ssaoVal0 + ssaoVal1) * 0.5f;
+				depth = cpuBilateralUpscaleLoadDepth(&source, column->depth, row->depth, (int32_t)((row->image % 2) * 3));
+			}
 
-	for(uint32_t i = 0; i < NUM_DESCRIPTOR_SET_LAYOUTS; ++i)
-	{
-		vkDestroyDescriptorSetLayout(device, context->descriptorSetLayouts[i], NULL);
+			// groupshared values are packed to f16 by the shader
+			tile->depths[bufferY][bufferX] = cpuQuantizeHalf(depth);
+			tile->ssaoVals[bufferY][bufferX] = cpuQuantizeHalf(ssaoVal);
+		}
 	}
+}
 
+// FFX_CACAO_BilateralUpscaleNxN runs a thread per 2x2 quad of output pixels. the kernels below evaluate the 5x5 filter
+// for a row of threads at once, sharing the groupshared value of each tap across the quad of a thread. the weights are
+// evaluated as a single power of two, exp(-dist * sigma) * exp(-diff * distSigma) = 2^(spatialExponent + rangeExponent),
+// where the spatial exponents only depend on the tap and are computed once per thread group.
 
-	for (uint32_t i = 0; i < FFX_CACAO_ARRAY_SIZE(context->samplers); ++i)
-	{
-		vkDestroySampler(device, context->samplers[i], NULL);
-	}
+#define CPU_LOG2_E 1.44269504f
 
-	return FFX_CACAO_STATUS_OK;
+// 2^x with a relative error of 5e-7, far below the min16float precision the shader evaluates the weights at. the
+// kernels evaluate the same sequence of operations, so that every kernel computes the same weights
+static inline float cpuBilateralExp2(float x)
+{
+	// x + 127.5 is positive, so the conversion rounds it down to the biased exponent of the nearest power of two
+	x = FFX_CACAO_CLAMP(x, -126.0f, 127.0f);
+	int32_t biased = (int32_t)(x + 127.5f);
+	float f = x - ((float)biased - 127.0f);
+	float p = 1.112550730e-3f;
+	p = p * f + 9.666282684e-3f;
+	p = p * f + 5.557400361e-2f;
+	p = p * f + 2.402235121e-1f;
+	p = p * f + 6.931428313e-1f;
+	p = p * f + 1.0f;
+	uint32_t scaleBits = (uint32_t)biased << 23;
+	float scale;
+	memcpy(&scale, &scaleBits, sizeof(scale));
+	return p * scale;
 }
 
-FFX_CACAO_Status FFX_CACAO_VkInitScreenSizeDependentResources(FFX_CACAO_VkContext* context, const FFX_CACAO_VkScreenSizeInfo* info)
+static void cpuBilateralUpscaleScalar(const CpuDispatchInfo *info, CpuBilateralUpscaleTile *tile)
 {
-	if (context == NULL)
-	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
-	}
-	if (info == NULL)
+	const float epsilonWeight = 1e-3f;
+	float rangeScale = -(1.0f / info->constants->BilateralSimilarityDistanceSigma) * CPU_LOG2_E;
+
+	for (uint32_t y = 0; y < CPU_BILATERAL_UPSCALE_HEIGHT; ++y)
 	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
-	}
-	context = getAlignedVkContextPointer(context);
+		for (uint32_t x = 0; x < CPU_BILATERAL_UPSCALE_WIDTH; ++x)
+		{
+			float nearestSsaoVal = tile->ssaoVals[y + 2][x + 2];
+			float totals[4], totalWeights[4];
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				totals[i] = epsilonWeight * nearestSsaoVal;
+				totalWeights[i] = epsilonWeight;
+			}
 
-	FFX_CACAO_Bool useDownsampledSsao = info->useDownsampledSsao;
-	context->useDownsampledSsao = useDownsampledSsao;
-	context->output = info->output;
+			for (uint32_t tap = 0; tap < 25; ++tap)
+			{
+				float bufferDepth = tile->depths[y + tap % 5][x + tap / 5];
+				float bufferSsaoVal = tile->ssaoVals[y + tap % 5][x + tap / 5];
+				for (uint32_t i = 0; i < 4; ++i)
+				{
+					float diff = tile->viewDepths[i][y][x] - bufferDepth;
+					diff *= diff;
+					float weight = cpuBilateralExp2(diff * rangeScale + tile->spatialExponents[tap][i]);
+					totals[i] += bufferSsaoVal * weight;
+					totalWeights[i] += weight;
+				}
+			}
 
-	VkDevice device = context->device;
-	VkPhysicalDevice physicalDevice = context->physicalDevice;
-	VkPhysicalDeviceMemoryProperties memoryProperties;
-	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
-	VkResult result;
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				tile->outputs[i][y][x] = totals[i] / totalWeights[i];
+			}
+		}
+	}
+}
 
-	FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
-	FFX_CACAO_UpdateBufferSizeInfo(info->width, info->height, useDownsampledSsao, bsi);
+#ifdef CPU_SIMD_X86
+CPU_TARGET_AVX2 static inline __m256 cpuBilateralExp2Avx2(__m256 x)
+{
+	x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-126.0f)), _mm256_set1_ps(127.0f));
+	__m256i biased = _mm256_cvttps_epi32(_mm256_add_ps(x, _mm256_set1_ps(127.5f)));
+	__m256 f = _mm256_sub_ps(x, _mm256_sub_ps(_mm256_cvtepi32_ps(biased), _mm256_set1_ps(127.0f)));
+	__m256 p = _mm256_set1_ps(1.112550730e-3f);
+	p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(9.666282684e-3f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(5.557400361e-2f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(2.402235121e-1f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(6.931428313e-1f));
+	p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(1.0f));
+	return _mm256_mul_ps(p, _mm256_castsi256_ps(_mm256_slli_epi32(biased, 23)));
+}
 
-	FFX_CACAO_Status errorStatus = FFX_CACAO_STATUS_FAILED;
-	uint32_t numTextureImagesInited = 0;
-	uint32_t numTextureMemoriesInited = 0;
-	uint32_t numSrvsInited = 0;
-	uint32_t numUavsInited = 0;
+// 8 threads of a row at a time
+CPU_TARGET_AVX2 static void cpuBilateralUpscaleAvx2(const CpuDispatchInfo *info, CpuBilateralUpscaleTile *tile)
+{
+	const __m256 epsilonWeight = _mm256_set1_ps(1e-3f);
+	const __m256 rangeScale = _mm256_set1_ps(-(1.0f / info->constants->BilateralSimilarityDistanceSigma) * CPU_LOG2_E);
 
-	// create images for textures
-	for ( ; numTextureImagesInited < NUM_TEXTURES; ++numTextureImagesInited)
+	for (uint32_t y = 0; y < CPU_BILATERAL_UPSCALE_HEIGHT; ++y)
 	{
-		TextureMetaData metaData = TEXTURE_META_DATA[numTextureImagesInited];
-		VkImage image = VK_NULL_HANDLE;
+		for (uint32_t x = 0; x < CPU_BILATERAL_UPSCALE_WIDTH; x += 8)
+		{
+			__m256 nearestSsaoVal = _mm256_loadu_ps(&tile->ssaoVals[y + 2][x + 2]);
+			__m256 depths[4], totals[4], totalWeights[4];
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				depths[i] = _mm256_load_ps(&tile->viewDepths[i][y][x]);
+				totals[i] = _mm256_mul_ps(epsilonWeight, nearestSsaoVal);
+				totalWeights[i] = epsilonWeight;
+			}
 
-		VkImageCreateInfo info = {};
-		info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-		info.pNext = NULL;
-		info.flags = 0;
-		info.imageType = VK_IMAGE_TYPE_2D;
-		info.format = TEXTURE_FORMAT_LOOKUP_VK[metaData.format];
-		info.extent.width = *(uint32_t*)((uint8_t*)bsi + metaData.widthOffset);
-		info.extent.height = *(uint32_t*)((uint8_t*)bsi + metaData.heightOffset);
-		info.extent.depth = 1;
-		info.mipLevels = metaData.numMips;
-		info.arrayLayers = metaData.arraySize;
-		info.samples = VK_SAMPLE_COUNT_1_BIT;
-		info.tiling = VK_IMAGE_TILING_OPTIMAL;
-		info.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
-		info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		info.queueFamilyIndexCount = 0;
-		info.pQueueFamilyIndices = NULL;
-		info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			for (uint32_t tap = 0; tap < 25; ++tap)
+			{
+				__m256 bufferDepth = _mm256_loadu_ps(&tile->depths[y + tap % 5][x + tap / 5]);
+				__m256 bufferSsaoVal = _mm256_loadu_ps(&tile->ssaoVals[y + tap % 5][x + tap / 5]);
+				for (uint32_t i = 0; i < 4; ++i)
+				{
+					__m256 diff = _mm256_sub_ps(depths[i], bufferDepth);
+					diff = _mm256_mul_ps(diff, diff);
+					__m256 weight = cpuBilateralExp2Avx2(_mm256_add_ps(_mm256_mul_ps(diff, rangeScale), _mm256_set1_ps(tile->spatialExponents[tap][i])));
+					totals[i] = _mm256_add_ps(totals[i], _mm256_mul_ps(bufferSsaoVal, weight));
+					totalWeights[i] = _mm256_add_ps(totalWeights[i], weight);
+				}
+			}
 
-		result = vkCreateImage(device, &info, NULL, &image);
-		if (result != VK_SUCCESS)
-		{
-			goto error_init_texture_images;
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				_mm256_store_ps(&tile->outputs[i][y][x], _mm256_div_ps(totals[i], totalWeights[i]));
+			}
 		}
+	}
+}
 
-		setObjectName(device, context, VK_OBJECT_TYPE_IMAGE, (uint64_t)image, metaData.name);
+// the avx512f intrinsics of some gcc versions initialise their pass-through operands with themselves
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
 
-		context->textures[numTextureImagesInited] = image;
-	}
+CPU_TARGET_AVX512 static inline __m512 cpuBilateralExp2Avx512(__m512 x)
+{
+	x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(-126.0f)), _mm512_set1_ps(127.0f));
+	__m512i biased = _mm512_cvttps_epi32(_mm512_add_ps(x, _mm512_set1_ps(127.5f)));
+	__m512 f = _mm512_sub_ps(x, _mm512_sub_ps(_mm512_cvtepi32_ps(biased), _mm512_set1_ps(127.0f)));
+	__m512 p = _mm512_set1_ps(1.112550730e-3f);
+	p = _mm512_add_ps(cpuMulAvx512(p, f), _mm512_set1_ps(9.666282684e-3f));
+	p = _mm512_add_ps(cpuMulAvx512(p, f), _mm512_set1_ps(5.557400361e-2f));
+	p = _mm512_add_ps(cpuMulAvx512(p, f), _mm512_set1_ps(2.402235121e-1f));
+	p = _mm512_add_ps(cpuMulAvx512(p, f), _mm512_set1_ps(6.931428313e-1f));
+	p = _mm512_add_ps(cpuMulAvx512(p, f), _mm512_set1_ps(1.0f));
+	return cpuMulAvx512(p, _mm512_castsi512_ps(_mm512_slli_epi32(biased, 23)));
+}
+
+// 16 threads of a row at a time
+CPU_TARGET_AVX512 static void cpuBilateralUpscaleAvx512(const CpuDispatchInfo *info, CpuBilateralUpscaleTile *tile)
+{
+	const __m512 epsilonWeight = _mm512_set1_ps(1e-3f);
+	const __m512 rangeScale = _mm512_set1_ps(-(1.0f / info->constants->BilateralSimilarityDistanceSigma) * CPU_LOG2_E);
 
-	// allocate memory for textures
-	for ( ; numTextureMemoriesInited < NUM_TEXTURES; ++numTextureMemoriesInited)
+	for (uint32_t y = 0; y < CPU_BILATERAL_UPSCALE_HEIGHT; ++y)
 	{
-		VkImage image = context->textures[numTextureMemoriesInited];
+		for (uint32_t x = 0; x < CPU_BILATERAL_UPSCALE_WIDTH; x += 16)
+		{
+			__m512 nearestSsaoVal = _mm512_loadu_ps(&tile->ssaoVals[y + 2][x + 2]);
+			__m512 depths[4], totals[4], totalWeights[4];
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				depths[i] = _mm512_loadu_ps(&tile->viewDepths[i][y][x]);
+				totals[i] = cpuMulAvx512(epsilonWeight, nearestSsaoVal);
+				totalWeights[i] = epsilonWeight;
+			}
 
-		VkMemoryRequirements memoryRequirements;
-		vkGetImageMemoryRequirements(device, image, &memoryRequirements);
+			for (uint32_t tap = 0; tap < 25; ++tap)
+			{
+				__m512 bufferDepth = _mm512_loadu_ps(&tile->depths[y + tap % 5][x + tap / 5]);
+				__m512 bufferSsaoVal = _mm512_loadu_ps(&tile->ssaoVals[y + tap % 5][x + tap / 5]);
+				for (uint32_t i = 0; i < 4; ++i)
+				{
+					__m512 diff = _mm512_sub_ps(depths[i], bufferDepth);
+					diff = cpuMulAvx512(diff, diff);
+					__m512 weight = cpuBilateralExp2Avx512(_mm512_add_ps(cpuMulAvx512(diff, rangeScale), _mm512_set1_ps(tile->spatialExponents[tap][i])));
+					totals[i] = _mm512_add_ps(totals[i], cpuMulAvx512(bufferSsaoVal, weight));
+					totalWeights[i] = _mm512_add_ps(totalWeights[i], weight);
+				}
+			}
 
-		uint32_t chosenMemoryTypeIndex = getBestMemoryHeapIndex(physicalDevice, memoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-		if (chosenMemoryTypeIndex == VK_MAX_MEMORY_TYPES)
-		{
-			goto error_init_texture_memories;
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				_mm512_storeu_ps(&tile->outputs[i][y][x], _mm512_div_ps(totals[i], totalWeights[i]));
+			}
 		}
+	}
+}
 
-		VkMemoryAllocateInfo allocationInfo = {};
-		allocationInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-		allocationInfo.pNext = NULL;
-		allocationInfo.allocationSize = memoryRequirements.size;
-		allocationInfo.memoryTypeIndex = chosenMemoryTypeIndex;
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif // CPU_SIMD_X86
 
-		VkDeviceMemory memory;
-		result = vkAllocateMemory(device, &allocationInfo, NULL, &memory);
-		if (result != VK_SUCCESS)
-		{
-			goto error_init_texture_memories;
-		}
+#ifdef CPU_SIMD_NEON
+static inline float32x4_t cpuBilateralExp2Neon(float32x4_t x)
+{
+	x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-126.0f)), vdupq_n_f32(127.0f));
+	int32x4_t biased = vcvtq_s32_f32(vaddq_f32(x, vdupq_n_f32(127.5f)));
+	float32x4_t f = vsubq_f32(x, vsubq_f32(vcvtq_f32_s32(biased), vdupq_n_f32(127.0f)));
+	float32x4_t p = vdupq_n_f32(1.112550730e-3f);
+	p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(9.666282684e-3f));
+	p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(5.557400361e-2f));
+	p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(2.402235121e-1f));
+	p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(6.931428313e-1f));
+	p = vaddq_f32(vmulq_f32(p, f), vdupq_n_f32(1.0f));
+	return vmulq_f32(p, vreinterpretq_f32_s32(vshlq_n_s32(biased, 23)));
+}
 
-		result = vkBindImageMemory(device, image, memory, 0);
-		if (result != VK_SUCCESS)
+// 4 threads of a row at a time
+static void cpuBilateralUpscaleNeon(const CpuDispatchInfo *info, CpuBilateralUpscaleTile *tile)
+{
+	const float32x4_t epsilonWeight = vdupq_n_f32(1e-3f);
+	const float32x4_t rangeScale = vdupq_n_f32(-(1.0f / info->constants->BilateralSimilarityDistanceSigma) * CPU_LOG2_E);
+
+	for (uint32_t y = 0; y < CPU_BILATERAL_UPSCALE_HEIGHT; ++y)
+	{
+		for (uint32_t x = 0; x < CPU_BILATERAL_UPSCALE_WIDTH; x += 4)
 		{
-			vkFreeMemory(device, memory, NULL);
-			goto  error_init_texture_memories;
-		}
+			float32x4_t nearestSsaoVal = vld1q_f32(&tile->ssaoVals[y + 2][x + 2]);
+			float32x4_t depths[4], totals[4], totalWeights[4];
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				depths[i] = vld1q_f32(&tile->viewDepths[i][y][x]);
+				totals[i] = vmulq_f32(epsilonWeight, nearestSsaoVal);
+				totalWeights[i] = epsilonWeight;
+			}
 
-		context->textureMemory[numTextureMemoriesInited] = memory;
+			for (uint32_t tap = 0; tap < 25; ++tap)
+			{
+				float32x4_t bufferDepth = vld1q_f32(&tile->depths[y + tap % 5][x + tap / 5]);
+				float32x4_t bufferSsaoVal = vld1q_f32(&tile->ssaoVals[y + tap % 5][x + tap / 5]);
+				for (uint32_t i = 0; i < 4; ++i)
+				{
+					float32x4_t diff = vsubq_f32(depths[i], bufferDepth);
+					diff = vmulq_f32(diff, diff);
+					float32x4_t weight = cpuBilateralExp2Neon(vaddq_f32(vmulq_f32(diff, rangeScale), vdupq_n_f32(tile->spatialExponents[tap][i])));
+					totals[i] = vaddq_f32(totals[i], vmulq_f32(bufferSsaoVal, weight));
+					totalWeights[i] = vaddq_f32(totalWeights[i], weight);
+				}
+			}
+
+			for (uint32_t i = 0; i < 4; ++i)
+			{
+				vst1q_f32(&tile->outputs[i][y][x], vdivq_f32(totals[i], totalWeights[i]));
+			}
+		}
 	}
+}
+#endif // CPU_SIMD_NEON
 
-	// create srv image views
-	for ( ; numSrvsInited < NUM_SHADER_RESOURCE_VIEWS; ++numSrvsInited)
+// picks the bilateral upscale kernel for the host, as cpuSelectSSAOTapKernel does
+static CpuBilateralUpscaleKernel cpuSelectBilateralUpscaleKernel(FFX_CACAO_CpuCreateFlags flags)
+{
+	if (flags & FFX_CACAO_CPU_CREATE_DISABLE_SIMD)
 	{
-		VkImageView imageView;
-		ShaderResourceViewMetaData srvMetaData = SRV_META_DATA[numSrvsInited];
+		return cpuBilateralUpscaleScalar;
+	}
+#ifdef CPU_SIMD_X86
+	if (!(flags & FFX_CACAO_CPU_CREATE_DISABLE_AVX512) && cpuHostSupportsAvx512())
+	{
+		return cpuBilateralUpscaleAvx512;
+	}
+	if (cpuHostSupportsAvx2())
+	{
+		return cpuBilateralUpscaleAvx2;
+	}
+#endif
+#ifdef CPU_SIMD_NEON
+	return cpuBilateralUpscaleNeon;
+#else
+	return cpuBilateralUpscaleScalar;
+#endif
+}
 
-		VkImageViewCreateInfo info = {};
-		info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		info.pNext = NULL;
-		info.flags = 0;
-		info.image = context->textures[srvMetaData.texture];
-		info.viewType = VIEW_TYPE_LOOKUP_VK[srvMetaData.viewType];
-		info.format = TEXTURE_FORMAT_LOOKUP_VK[TEXTURE_META_DATA[srvMetaData.texture].format];
-		info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		info.subresourceRange.baseMipLevel = srvMetaData.mostDetailedMip;
-		info.subresourceRange.levelCount = srvMetaData.mipLevels;
-		info.subresourceRange.baseArrayLayer = srvMetaData.firstArraySlice;
-		info.subresourceRange.layerCount = srvMetaData.arraySize;
+// emulates FFX_CACAO_BilateralUpscaleNxN over a thread group of CPU_BILATERAL_UPSCALE_WIDTH x CPU_BILATERAL_UPSCALE_HEIGHT threads
+static void cpuBilateralUpscale(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, CpuBilateralUpscaleMode mode)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *depthIn = &info->descriptorSet->inputs[1];
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
+	const CpuTexture *depthTexture = depthIn->texture;
+	const CpuTexture *outputTexture = output->texture;
+	CpuBilateralUpscaleTile *tile = &info->groupShared->bilateralUpscale;
 
-		result = vkCreateImageView(device, &info, NULL, &imageView);
-		if (result != VK_SUCCESS)
+	FFX_CACAO_ASSERT(depthTexture->format == TEXTURE_FORMAT_R32_SFLOAT && outputTexture->format == TEXTURE_FORMAT_R32_SFLOAT);
+
+	cpuBilateralUpscaleFillBuffer(info, groupX, groupY, mode, tile);
+
+	float spatialScale = -(1.0f / consts->BilateralSigmaSquared) * CPU_LOG2_E;
+	for (int x = -2; x <= 2; ++x)
+	{
+		for (int y = -2; y <= 2; ++y)
 		{
-			goto error_init_srvs;
-		}
+			float u[2] = { (float)x - 0.0f, (float)x - 0.5f };
+			float v1 = (float)y;
+			float v2 = (float)y - 0.5f;
 
-		context->shaderResourceViews[numSrvsInited] = imageView;
+			float *spatialExponents = tile->spatialExponents[(x + 2) * 5 + (y + 2)];
+			for (int i = 0; i < 2; ++i)
+			{
+				float dist1 = u[i] * u[i] + v1 * v1;
+				float dist2 = u[i] * u[i] + v2 * v2;
+				spatialExponents[i] = dist1 * spatialScale;
+				spatialExponents[2 + i] = dist2 * spatialScale;
+			}
+		}
 	}
 
-	// create uav image views
-	for ( ; numUavsInited < NUM_UNORDERED_ACCESS_VIEWS; ++numUavsInited)
+	// load depths, out of bounds texels read zero
+	int32_t depthWidth = (int32_t)depthTexture->widths[depthIn->mostDetailedMip];
+	int32_t depthHeight = (int32_t)depthTexture->heights[depthIn->mostDetailedMip];
+	for (uint32_t gtidY = 0; gtidY < CPU_BILATERAL_UPSCALE_HEIGHT; ++gtidY)
 	{
-		VkImageView imageView;
-		UnorderedAccessViewMetaData uavMetaData = UAV_META_DATA[numUavsInited];
+		int32_t tidY = (int32_t)(groupY * CPU_BILATERAL_UPSCALE_HEIGHT + gtidY);
+		for (int32_t j = 0; j < 2; ++j)
+		{
+			int32_t fullDepthY = 2 * tidY + consts->DepthBufferOffset[1] + j;
+			bool rowInBounds = fullDepthY >= 0 && fullDepthY < depthHeight;
+			const float *depths = rowInBounds ? (const float*)cpuTexelAddress(depthTexture, 0, fullDepthY, depthIn->firstArraySlice, depthIn->mostDetailedMip) : NULL;
+			for (uint32_t gtidX = 0; gtidX < CPU_BILATERAL_UPSCALE_WIDTH; ++gtidX)
+			{
+				int32_t tidX = (int32_t)(groupX * CPU_BILATERAL_UPSCALE_WIDTH + gtidX);
+				for (int32_t i = 0; i < 2; ++i)
+				{
+					int32_t fullDepthX = 2 * tidX + consts->DepthBufferOffset[0] + i;
+					float depth = rowInBounds && fullDepthX >= 0 && fullDepthX < depthWidth ? depths[fullDepthX] : 0.0f;
+					tile->viewDepths[2 * j + i][gtidY][gtidX] = cpuScreenSpaceToViewSpaceDepth(consts, depth);
+				}
+			}
+		}
+	}
 
-		VkImageViewCreateInfo info = {};
-		info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-		info.pNext = NULL;
-		info.flags = 0;
-		info.image = context->textures[uavMetaData.textureID];
-		info.viewType = VIEW_TYPE_LOOKUP_VK[uavMetaData.viewType];
-		info.format = TEXTURE_FORMAT_LOOKUP_VK[TEXTURE_META_DATA[uavMetaData.textureID].format];
-		info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
-		info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		info.subresourceRange.baseMipLevel = uavMetaData.mostDetailedMip;
-		info.subresourceRange.levelCount = 1;
-		info.subresourceRange.baseArrayLayer = uavMetaData.firstArraySlice;
-		info.subresourceRange.layerCount = uavMetaData.arraySize;
+	info->bilateralUpscaleKernel(info, tile);
 
-		result = vkCreateImageView(device, &info, NULL, &imageView);
-		if (result != VK_SUCCESS)
+	int32_t outputWidth = (int32_t)outputTexture->widths[output->mostDetailedMip];
+	int32_t outputHeight = (int32_t)outputTexture->heights[output->mostDetailedMip];
+	for (uint32_t gtidY = 0; gtidY < CPU_BILATERAL_UPSCALE_HEIGHT; ++gtidY)
+	{
+		int32_t tidY = (int32_t)(groupY * CPU_BILATERAL_UPSCALE_HEIGHT + gtidY);
+		for (int32_t j = 0; j < 2 && 2 * tidY + j < outputHeight; ++j)
 		{
-			goto error_init_uavs;
+			float *outputs = (float*)cpuTexelAddress(outputTexture, 0, 2 * tidY + j, output->firstArraySlice, output->mostDetailedMip);
+			for (uint32_t gtidX = 0; gtidX < CPU_BILATERAL_UPSCALE_WIDTH; ++gtidX)
+			{
+				int32_t tidX = (int32_t)(groupX * CPU_BILATERAL_UPSCALE_WIDTH + gtidX);
+				for (int32_t i = 0; i < 2 && 2 * tidX + i < outputWidth; ++i)
+				{
+					outputs[2 * tidX + i] = tile->outputs[2 * j + i][gtidY][gtidX];
+				}
+			}
 		}
-
-		context->unorderedAccessViews[numUavsInited] = imageView;
 	}
+}
 
-	// update descriptor sets from table
-	for (uint32_t i = 0; i < NUM_BACK_BUFFERS; ++i) {
-		VkDescriptorImageInfo  imageInfos[NUM_INPUT_DESCRIPTOR_BINDINGS + NUM_OUTPUT_DESCRIPTOR_BINDINGS] = {};
-		VkDescriptorImageInfo *curImageInfo = imageInfos;
-		VkWriteDescriptorSet   writes[NUM_INPUT_DESCRIPTOR_BINDINGS + NUM_OUTPUT_DESCRIPTOR_BINDINGS] = {};
-		VkWriteDescriptorSet  *curWrite = writes;
-		
-		// write input descriptor bindings
-		for (uint32_t j = 0; j < NUM_INPUT_DESCRIPTOR_BINDINGS; ++j)
-		{
-			InputDescriptorBindingMetaData bindingMetaData = INPUT_DESCRIPTOR_BINDING_META_DATA[j];
+static void cpuUpscaleBilateral5x5Smart(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuBilateralUpscale(info, groupX, groupY, CPU_BILATERAL_UPSCALE_MODE_SMART);
+}
 
-			curImageInfo->sampler = VK_NULL_HANDLE;
-			curImageInfo->imageView = context->shaderResourceViews[bindingMetaData.srvID];
-			curImageInfo->imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+static void cpuUpscaleBilateral5x5NonSmart(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuBilateralUpscale(info, groupX, groupY, CPU_BILATERAL_UPSCALE_MODE_NON_SMART);
+}
 
-			curWrite->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			curWrite->pNext = NULL;
-			curWrite->dstSet = context->descriptorSets[i][bindingMetaData.descriptorID];
-			curWrite->dstBinding = 20 + bindingMetaData.bindingNumber;
-			curWrite->descriptorCount = 1;
-			curWrite->descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-			curWrite->pImageInfo = curImageInfo;
+static void cpuUpscaleBilateral5x5Half(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuBilateralUpscale(info, groupX, groupY, CPU_BILATERAL_UPSCALE_MODE_HALF);
+}
 
-			++curWrite; ++curImageInfo;
-		}
+typedef void (*CpuComputeShader)(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ);
 
-		// write output descriptor bindings
-		for (uint32_t j = 0; j < NUM_OUTPUT_DESCRIPTOR_BINDINGS; ++j)
-		{
-			OutputDescriptorBindingMetaData bindingMetaData = OUTPUT_DESCRIPTOR_BINDING_META_DATA[j];
+static const CpuComputeShader COMPUTE_SHADER_CPU[] = {
+#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout, spirv_module, spirv_specialization) cpu##pascal_name,
+	COMPUTE_SHADERS
+#undef COMPUTE_SHADER
+};
 
-			curImageInfo->sampler = VK_NULL_HANDLE;
-			curImageInfo->imageView = context->unorderedAccessViews[bindingMetaData.uavID];
-			curImageInfo->imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+// =================================================================================================
+// CPU reference ports of the compute shaders in ffx_cacao.hlsl
+// =================================================================================================
+
+// plain transcriptions of the shaders, run by contexts created with FFX_CACAO_CPU_CREATE_REFERENCE one thread group at a
+// time with the dispatch sizes of the GPU. each barrier separated phase of a thread group runs for every thread in turn,
+// groupshared memory lives on the stack and every texture access goes through the emulated Load, SampleLevel and
+// GatherRed. the ports above are checked against these by FFX_CACAO_CpuDrawDifferential.
+
+// =============================================================================
+// Clear Load Counter
+
+static void cpuReferenceClearLoadCounter(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	*info->loadCounter = 0;
+}
+
+// =============================================================================
+// Prepare
+
+static inline void cpuReferencePrepareDepths(const CpuDispatchInfo *info, CpuFloat4 samples, uint32_t x, uint32_t y)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
+	cpuStoreFloat(output, x, y, 0, cpuScreenSpaceToViewSpaceDepth(consts, samples.w));
+	cpuStoreFloat(output, x, y, 1, cpuScreenSpaceToViewSpaceDepth(consts, samples.z));
+	cpuStoreFloat(output, x, y, 2, cpuScreenSpaceToViewSpaceDepth(consts, samples.x));
+	cpuStoreFloat(output, x, y, 3, cpuScreenSpaceToViewSpaceDepth(consts, samples.y));
+}
+
+static inline CpuFloat4 cpuReferencePrepareDownsampledDepthSamples(const CpuDispatchInfo *info, uint32_t x, uint32_t y)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *depthIn = &info->descriptorSet->inputs[0];
+	float u = ((float)(4 * x) + 0.5f) * consts->DepthBufferInverseDimensions[0];
+	float v = ((float)(4 * y) + 0.5f) * consts->DepthBufferInverseDimensions[1];
+	CpuFloat4 samples;
+	samples.x = cpuSamplePoint(depthIn, u, v, 0.0f, 0.0f, 0, 2, CPU_ADDRESS_MODE_CLAMP);
+	samples.y = cpuSamplePoint(depthIn, u, v, 0.0f, 0.0f, 2, 2, CPU_ADDRESS_MODE_CLAMP);
+	samples.z = cpuSamplePoint(depthIn, u, v, 0.0f, 0.0f, 2, 0, CPU_ADDRESS_MODE_CLAMP);
+	samples.w = cpuSamplePoint(depthIn, u, v, 0.0f, 0.0f, 0, 0, CPU_ADDRESS_MODE_CLAMP);
+	return samples;
+}
+
+static inline CpuFloat4 cpuReferencePrepareNativeDepthSamples(const CpuDispatchInfo *info, uint32_t x, uint32_t y)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	float u = ((float)(2 * x) + 0.5f) * consts->DepthBufferInverseDimensions[0];
+	float v = ((float)(2 * y) + 0.5f) * consts->DepthBufferInverseDimensions[1];
+	return cpuGatherRed(&info->descriptorSet->inputs[0], u, v, 0.0f, 0, 0, CPU_ADDRESS_MODE_CLAMP);
+}
+
+static inline void cpuReferencePrepareDownsampledDepthsThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	cpuReferencePrepareDepths(info, cpuReferencePrepareDownsampledDepthSamples(info, x, y), x, y);
+}
+
+static inline void cpuReferencePrepareNativeDepthsThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	cpuReferencePrepareDepths(info, cpuReferencePrepareNativeDepthSamples(info, x, y), x, y);
+}
+
+static void cpuReferencePrepareDownsampledDepths(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_PREPARE_DEPTHS_WIDTH, FFX_CACAO_PREPARE_DEPTHS_HEIGHT, cpuReferencePrepareDownsampledDepthsThread)
+}
+
+static void cpuReferencePrepareNativeDepths(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_PREPARE_DEPTHS_WIDTH, FFX_CACAO_PREPARE_DEPTHS_HEIGHT, cpuReferencePrepareNativeDepthsThread)
+}
+// emulates the thread group of FFX_CACAO_PrepareDepthsAndMips, each barrier separated phase runs for every thread in turn
+static void cpuReferencePrepareDepthsAndMips(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, CpuFloat4 (*loadSamples)(const CpuDispatchInfo*, uint32_t, uint32_t))
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *outMips = info->descriptorSet->outputs;
+	float lds[4][FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH][FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT];
+
+	for (uint32_t gtidY = 0; gtidY < FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT; ++gtidY)
+	{
+		for (uint32_t gtidX = 0; gtidX < FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH; ++gtidX)
+		{
+			uint32_t x = groupX * FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH + gtidX;
+			uint32_t y = groupY * FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT + gtidY;
+			CpuFloat4 samples = loadSamples(info, x, y);
+			samples.x = cpuScreenSpaceToViewSpaceDepth(consts, samples.x);
+			samples.y = cpuScreenSpaceToViewSpaceDepth(consts, samples.y);
+			samples.z = cpuScreenSpaceToViewSpaceDepth(consts, samples.z);
+			samples.w = cpuScreenSpaceToViewSpaceDepth(consts, samples.w);
+
+			lds[0][gtidX][gtidY] = samples.w;
+			lds[1][gtidX][gtidY] = samples.z;
+			lds[2][gtidX][gtidY] = samples.x;
+			lds[3][gtidX][gtidY] = samples.y;
+
+			cpuStoreFloat(&outMips[0], x, y, 0, samples.w);
+			cpuStoreFloat(&outMips[0], x, y, 1, samples.z);
+			cpuStoreFloat(&outMips[0], x, y, 2, samples.x);
+			cpuStoreFloat(&outMips[0], x, y, 3, samples.y);
+		}
+	}
+
+	for (uint32_t mip = 1; mip < 4; ++mip)
+	{
+		uint32_t aliveMask = (1u << mip) - 1;
+		uint32_t step = 1u << (mip - 1);
+		for (uint32_t gtidY = 0; gtidY < FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT; ++gtidY)
+		{
+			for (uint32_t gtidX = 0; gtidX < FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH; ++gtidX)
+			{
+				uint32_t depthArrayIndex = 2 * (gtidY % 2) + (gtidX % 2);
+				uint32_t bufferX = gtidX - (gtidX % 2);
+				uint32_t bufferY = gtidY - (gtidY % 2);
+				if ((bufferX & aliveMask) || (bufferY & aliveMask))
+				{
+					continue;
+				}
+
+				float avg = cpuMipSmartAverage(consts,
+					lds[depthArrayIndex][bufferX][bufferY],
+					lds[depthArrayIndex][bufferX][bufferY + step],
+					lds[depthArrayIndex][bufferX + step][bufferY],
+					lds[depthArrayIndex][bufferX + step][bufferY + step]);
+
+				uint32_t x = (groupX * FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH + gtidX) >> mip;
+				uint32_t y = (groupY * FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT + gtidY) >> mip;
+				cpuStoreFloat(&outMips[mip], x, y, depthArrayIndex, avg);
+				lds[depthArrayIndex][bufferX][bufferY] = avg;
+			}
+		}
+	}
+}
+
+static void cpuReferencePrepareDownsampledDepthsAndMips(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuReferencePrepareDepthsAndMips(info, groupX, groupY, cpuReferencePrepareDownsampledDepthSamples);
+}
+
+static void cpuReferencePrepareNativeDepthsAndMips(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuReferencePrepareDepthsAndMips(info, groupX, groupY, cpuReferencePrepareNativeDepthSamples);
+}
+
+static void cpuReferenceGenerateSSAOShadowsInternal(const CpuDispatchInfo *info, float *outShadowTerm, CpuFloat4 *outEdges, float *outWeight, float svPosX, float svPosY, int qualityLevel, bool adaptiveBase)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *depthSource = &info->descriptorSet->inputs[0];
+
+	float svPosRoundedX = truncf(svPosX);
+	float svPosRoundedY = truncf(svPosY);
+	int32_t svPosUiX = (int32_t)svPosRoundedX;
+	int32_t svPosUiY = (int32_t)svPosRoundedY;
+
+	const int numberOfTaps = adaptiveBase ? CPU_ADAPTIVE_TAP_BASE_COUNT : (int)CPU_NUM_TAPS[qualityLevel];
+
+	float depthBufferU = (svPosX + 0.5f) * consts->DeinterleavedDepthBufferInverseDimensions[0] + consts->DeinterleavedDepthBufferNormalisedOffset[0];
+	float depthBufferV = (svPosY + 0.5f) * consts->DeinterleavedDepthBufferInverseDimensions[1] + consts->DeinterleavedDepthBufferNormalisedOffset[1];
+	CpuFloat4 valuesUL = cpuGatherRed(depthSource, depthBufferU, depthBufferV, 0.0f, -1, -1, CPU_ADDRESS_MODE_MIRROR);
+	CpuFloat4 valuesBR = cpuGatherRed(depthSource, depthBufferU, depthBufferV, 0.0f, 0, 0, CPU_ADDRESS_MODE_MIRROR);
+
+	// get this pixel's viewspace depth
+	float pixZ = valuesUL.y;
+
+	// get left right top bottom neighbouring pixels for edge detection
+	float pixLZ = valuesUL.x;
+	float pixTZ = valuesUL.z;
+	float pixRZ = valuesBR.z;
+	float pixBZ = valuesBR.x;
+
+	float normalizedScreenPosX = (svPosRoundedX + 0.5f) * consts->SSAOBufferInverseDimensions[0];
+	float normalizedScreenPosY = (svPosRoundedY + 0.5f) * consts->SSAOBufferInverseDimensions[1];
+	CpuFloat3 pixCenterPos = cpuNDCToViewSpace(consts, normalizedScreenPosX, normalizedScreenPosY, pixZ);
+
+	// Load this pixel's viewspace normal
+	CpuFloat3 pixelNormal = cpuGetNormalPass(info, svPosUiX, svPosUiY, consts->PassIndex);
+
+	const float pixelDirRBViewspaceSizeAtCenterZX = pixCenterPos.z * consts->NDCToViewMul[0] * consts->SSAOBufferInverseDimensions[0];
+	const float pixelDirRBViewspaceSizeAtCenterZY = pixCenterPos.z * consts->NDCToViewMul[1] * consts->SSAOBufferInverseDimensions[1];
+
+	// calculate effect radius and fit our screen sampling pattern inside it
+	float effectViewspaceRadius = consts->EffectRadius;
+	const float tooCloseLimitMod = cpuSaturate(sqrtf(cpuDot3(pixCenterPos, pixCenterPos)) * consts->EffectSamplingRadiusNearLimitRec) * 0.8f + 0.2f;
+	effectViewspaceRadius *= tooCloseLimitMod;
+	float pixLookupRadiusMod = (0.85f * effectViewspaceRadius) / pixelDirRBViewspaceSizeAtCenterZX;
+	float falloffCalcMulSq = -1.0f / (effectViewspaceRadius * effectViewspaceRadius);
+
+	// calculate samples rotation/scaling
+	float rotScale[4];
+	{
+		if (!adaptiveBase && (qualityLevel >= CPU_REDUCE_RADIUS_NEAR_SCREEN_BORDER_ENABLE_AT_QUALITY_PRESET))
+		{
+			float nearScreenBorder = FFX_CACAO_MIN(FFX_CACAO_MIN(depthBufferU, 1.0f - depthBufferU), FFX_CACAO_MIN(depthBufferV, 1.0f - depthBufferV));
+			nearScreenBorder = cpuSaturate(10.0f * nearScreenBorder + 0.6f);
+			pixLookupRadiusMod *= nearScreenBorder;
+		}
+
+		// load & update pseudo-random rotation matrix
+		uint32_t pseudoRandomIndex = (uint32_t)(svPosRoundedY * 2.0f + svPosRoundedX) % 5;
+		const float *rs = consts->PatternRotScaleMatrices[pseudoRandomIndex];
+		rotScale[0] = rs[0] * pixLookupRadiusMod;
+		rotScale[1] = rs[1] * pixLookupRadiusMod;
+		rotScale[2] = rs[2] * pixLookupRadiusMod;
+		rotScale[3] = rs[3] * pixLookupRadiusMod;
+	}
+
+	// the main obscurance & sample weight storage
+	float obscuranceSum = 0.0f;
+	float weightSum = 0.0f;
+
+	// edge mask for between this and left/right/top/bottom neighbour pixels - not used in quality level 0 so initialize to "no edge" (1 is no edge, 0 is edge)
+	CpuFloat4 edgesLRTB = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	// Move center pixel slightly towards camera to avoid imprecision artifacts due to using of 16bit depth buffer
+	pixCenterPos = cpuScale3(pixCenterPos, consts->DepthPrecisionOffsetMod);
+
+	if (!adaptiveBase && (qualityLevel >= CPU_DEPTH_BASED_EDGES_ENABLE_AT_QUALITY_PRESET))
+	{
+		edgesLRTB = cpuCalculateEdges(pixZ, pixLZ, pixRZ, pixTZ, pixBZ);
+	}
+
+	// adds a more high definition sharp effect, which gets blurred out (reuses left/right/top/bottom samples that we used for edge detection)
+	if (!adaptiveBase && (qualityLevel >= CPU_DETAIL_AO_ENABLE_AT_QUALITY_PRESET))
+	{
+		// disable in case of quality level 4 (reference)
+		if (qualityLevel != 4)
+		{
+			//approximate neighbouring pixels positions (actually just deltas or "positions - pixCenterPos" )
+			CpuFloat3 viewspaceDirZNormalized = cpuFloat3(pixCenterPos.x / pixCenterPos.z, pixCenterPos.y / pixCenterPos.z, 1.0f);
+
+			CpuFloat3 pixLDelta = cpuAdd3(cpuFloat3(-pixelDirRBViewspaceSizeAtCenterZX, 0.0f, 0.0f), cpuScale3(viewspaceDirZNormalized, pixLZ - pixCenterPos.z));
+			CpuFloat3 pixRDelta = cpuAdd3(cpuFloat3(+pixelDirRBViewspaceSizeAtCenterZX, 0.0f, 0.0f), cpuScale3(viewspaceDirZNormalized, pixRZ - pixCenterPos.z));
+			CpuFloat3 pixTDelta = cpuAdd3(cpuFloat3(0.0f, -pixelDirRBViewspaceSizeAtCenterZY, 0.0f), cpuScale3(viewspaceDirZNormalized, pixTZ - pixCenterPos.z));
+			CpuFloat3 pixBDelta = cpuAdd3(cpuFloat3(0.0f, +pixelDirRBViewspaceSizeAtCenterZY, 0.0f), cpuScale3(viewspaceDirZNormalized, pixBZ - pixCenterPos.z));
+
+			const float rangeReductionConst = 4.0f; // this is to avoid various artifacts
+			const float modifiedFalloffCalcMulSq = rangeReductionConst * falloffCalcMulSq;
+
+			float additionalObscurance = 0.0f;
+			additionalObscurance += cpuCalculatePixelObscurance(consts, pixelNormal, pixLDelta, modifiedFalloffCalcMulSq) * edgesLRTB.x;
+			additionalObscurance += cpuCalculatePixelObscurance(consts, pixelNormal, pixRDelta, modifiedFalloffCalcMulSq) * edgesLRTB.y;
+			additionalObscurance += cpuCalculatePixelObscurance(consts, pixelNormal, pixTDelta, modifiedFalloffCalcMulSq) * edgesLRTB.z;
+			additionalObscurance += cpuCalculatePixelObscurance(consts, pixelNormal, pixBDelta, modifiedFalloffCalcMulSq) * edgesLRTB.w;
+
+			obscuranceSum += consts->DetailAOStrength * additionalObscurance;
+		}
+	}
+
+	// Sharp normals also create edges - but this adds to the cost as well
+	if (!adaptiveBase && (qualityLevel >= CPU_NORMAL_BASED_EDGES_ENABLE_AT_QUALITY_PRESET))
+	{
+		CpuFloat3 neighbourNormalL = cpuGetNormalPass(info, svPosUiX - 1, svPosUiY + 0, consts->PassIndex);
+		CpuFloat3 neighbourNormalR = cpuGetNormalPass(info, svPosUiX + 1, svPosUiY + 0, consts->PassIndex);
+		CpuFloat3 neighbourNormalT = cpuGetNormalPass(info, svPosUiX + 0, svPosUiY - 1, consts->PassIndex);
+		CpuFloat3 neighbourNormalB = cpuGetNormalPass(info, svPosUiX + 0, svPosUiY + 1, consts->PassIndex);
+
+		const float dotThreshold = CPU_NORMAL_BASED_EDGES_DOT_THRESHOLD;
+
+		edgesLRTB.x *= cpuSaturate(cpuDot3(pixelNormal, neighbourNormalL) + dotThreshold);
+		edgesLRTB.y *= cpuSaturate(cpuDot3(pixelNormal, neighbourNormalR) + dotThreshold);
+		edgesLRTB.z *= cpuSaturate(cpuDot3(pixelNormal, neighbourNormalT) + dotThreshold);
+		edgesLRTB.w *= cpuSaturate(cpuDot3(pixelNormal, neighbourNormalB) + dotThreshold);
+	}
+
+	const float globalMipOffset = CPU_DEPTH_MIPS_GLOBAL_OFFSET;
+	float mipOffset = (qualityLevel < CPU_DEPTH_MIPS_ENABLE_AT_QUALITY_PRESET) ? 0.0f : (log2f(pixLookupRadiusMod) + globalMipOffset);
+
+	// standard, non-adaptive approach
+	if ((qualityLevel != 3) || adaptiveBase)
+	{
+		for (int i = 0; i < numberOfTaps; i++)
+		{
+			cpuSSAOTap(info, qualityLevel, &obscuranceSum, &weightSum, i, rotScale, pixCenterPos, pixelNormal, depthBufferU, depthBufferV, mipOffset, falloffCalcMulSq, 1.0f);
+		}
+	}
+	else // if( qualityLevel == 3 ) adaptive approach
+	{
+		// add new ones if needed
+		float fullResU = normalizedScreenPosX + consts->PerPassFullResUVOffset[0];
+		float fullResV = normalizedScreenPosY + consts->PerPassFullResUVOffset[1];
+		float importance = cpuSampleLinear(&info->descriptorSet->inputs[3], fullResU, fullResV, 0.0f);
+
+		// this is to normalize FFX_CACAO_DETAIL_AO_AMOUNT across all pixel regardless of importance
+		obscuranceSum *= (CPU_ADAPTIVE_TAP_BASE_COUNT / (float)CPU_MAX_TAPS) + (importance * CPU_ADAPTIVE_TAP_FLEXIBLE_COUNT / (float)CPU_MAX_TAPS);
+
+		// load existing base values
+		CpuFloat4 baseValues = cpuLoad(&info->descriptorSet->inputs[4], svPosUiX, svPosUiY, consts->PassIndex, 0);
+		weightSum += baseValues.y * (float)(CPU_ADAPTIVE_TAP_BASE_COUNT * 4.0f);
+		obscuranceSum += baseValues.x * weightSum;
+
+		float avgTotalImportance = (float)*info->loadCounter * consts->LoadCounterAvgDiv;
+
+		float importanceLimiter = cpuSaturate(consts->AdaptiveSampleCountLimit / avgTotalImportance);
+		importance *= importanceLimiter;
+
+		float additionalSampleCountFlt = CPU_ADAPTIVE_TAP_FLEXIBLE_COUNT * importance;
+
+		additionalSampleCountFlt += 1.5f;
+		uint32_t additionalSamples = (uint32_t)additionalSampleCountFlt;
+		uint32_t additionalSamplesTo = FFX_CACAO_MIN((uint32_t)CPU_MAX_TAPS, additionalSamples + CPU_ADAPTIVE_TAP_BASE_COUNT);
+
+		// sample loop
+		for (uint32_t i = CPU_ADAPTIVE_TAP_BASE_COUNT; i < additionalSamplesTo; ++i)
+		{
+			CpuSSAOHits hits = cpuSSAOGetHits2(info, qualityLevel, rotScale, CPU_SAMPLE_PATTERN_MAIN[i], mipOffset, depthBufferU, depthBufferV);
+			cpuSSAOAddHits(consts, qualityLevel, pixCenterPos, pixelNormal, falloffCalcMulSq, &weightSum, &obscuranceSum, &hits);
+		}
+	}
+
+	// early out for adaptive base - just output weight (used for the next pass)
+	if (adaptiveBase)
+	{
+		float obscurance = obscuranceSum / weightSum;
+
+		*outShadowTerm = obscurance;
+		outEdges->x = outEdges->y = outEdges->z = outEdges->w = 0.0f;
+		*outWeight = weightSum;
+		return;
+	}
+
+	// calculate weighted average
+	float obscurance = obscuranceSum / weightSum;
+
+	// calculate fadeout (1 close, gradient, 0 far)
+	float fadeOut = cpuSaturate(pixCenterPos.z * consts->EffectFadeOutMul + consts->EffectFadeOutAdd);
+
+	// Reduce the SSAO shadowing if we're on the edge to remove artifacts on edges (we don't care for the lower quality one)
+	if (!adaptiveBase && (qualityLevel >= CPU_DEPTH_BASED_EDGES_ENABLE_AT_QUALITY_PRESET))
+	{
+		// when there's more than 2 opposite edges, start fading out the occlusion to reduce aliasing artifacts
+		float edgeFadeoutFactor = cpuSaturate((1.0f - edgesLRTB.x - edgesLRTB.y) * 0.35f) + cpuSaturate((1.0f - edgesLRTB.z - edgesLRTB.w) * 0.35f);
+
+		fadeOut *= cpuSaturate(1.0f - edgeFadeoutFactor);
+	}
+
+	// strength
+	obscurance = consts->EffectShadowStrength * obscurance;
+
+	// clamp
+	obscurance = FFX_CACAO_MIN(obscurance, consts->EffectShadowClamp);
+
+	// fadeout
+	obscurance *= fadeOut;
+
+	// conceptually switch to occlusion with the meaning being visibility (grows with visibility, occlusion == 1 implies full visibility),
+	// to be in line with what is more commonly used.
+	float occlusion = 1.0f - obscurance;
+
+	// modify the gradient
+	// note: this cannot be moved to a later pass because of loss of precision after storing in the render target
+	occlusion = powf(cpuSaturate(occlusion), consts->EffectShadowPow);
+
+	// outputs!
+	*outShadowTerm = occlusion;
+	*outEdges = edgesLRTB;
+	*outWeight = weightSum;
+}
+
+static inline void cpuReferenceGenerateSparseThread(const CpuDispatchInfo *info, uint32_t tidX, uint32_t tidY, uint32_t tidZ, int qualityLevel)
+{
+	uint32_t xOffset = (tidY * 3 + tidZ) % 5;
+	uint32_t x = 5 * tidX + xOffset;
+	uint32_t y = tidY;
+	if (!cpuGenerateOutputInBounds(info, x, y))
+	{
+		return;
+	}
+
+	float outShadowTerm;
+	float outWeight;
+	CpuFloat4 outEdges;
+	cpuReferenceGenerateSSAOShadowsInternal(info, &outShadowTerm, &outEdges, &outWeight, (float)x, (float)y, qualityLevel, false);
+	float packedEdges = qualityLevel == 0 ? cpuPackEdges(1.0f, 1.0f, 1.0f, 1.0f) : cpuPackEdges(outEdges.x, outEdges.y, outEdges.z, outEdges.w);
+	cpuStoreFloat2(&info->descriptorSet->outputs[0], x, y, 0, outShadowTerm, packedEdges);
+}
+
+static inline void cpuReferenceGenerateQ0Thread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	cpuReferenceGenerateSparseThread(info, x, y, z, 0);
+}
+
+static inline void cpuReferenceGenerateQ1Thread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	cpuReferenceGenerateSparseThread(info, x, y, z, 1);
+}
+
+static inline void cpuReferenceGenerateThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, int qualityLevel, bool adaptiveBase)
+{
+	if (!cpuGenerateOutputInBounds(info, x, y))
+	{
+		return;
+	}
+
+	float outShadowTerm;
+	float outWeight;
+	CpuFloat4 outEdges;
+	cpuReferenceGenerateSSAOShadowsInternal(info, &outShadowTerm, &outEdges, &outWeight, (float)x, (float)y, qualityLevel, adaptiveBase);
+	float outY = adaptiveBase ? outWeight / ((float)CPU_ADAPTIVE_TAP_BASE_COUNT * 4.0f) : cpuPackEdges(outEdges.x, outEdges.y, outEdges.z, outEdges.w);
+	cpuStoreFloat2(&info->descriptorSet->outputs[0], x, y, 0, outShadowTerm, outY);
+}
+
+static inline void cpuReferenceGenerateQ2Thread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	cpuReferenceGenerateThread(info, x, y, 2, false);
+}
+
+static inline void cpuReferenceGenerateQ3BaseThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	cpuReferenceGenerateThread(info, x, y, 3, true);
+}
+
+static inline void cpuReferenceGenerateQ3Thread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	cpuReferenceGenerateThread(info, x, y, 3, false);
+}
+
+static void cpuReferenceGenerateQ0(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_GENERATE_SPARSE_WIDTH, FFX_CACAO_GENERATE_SPARSE_HEIGHT, cpuReferenceGenerateQ0Thread)
+}
+
+static void cpuReferenceGenerateQ1(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_GENERATE_SPARSE_WIDTH, FFX_CACAO_GENERATE_SPARSE_HEIGHT, cpuReferenceGenerateQ1Thread)
+}
+
+static void cpuReferenceGenerateQ2(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_GENERATE_WIDTH, FFX_CACAO_GENERATE_HEIGHT, cpuReferenceGenerateQ2Thread)
+}
+
+static void cpuReferenceGenerateQ3(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_GENERATE_WIDTH, FFX_CACAO_GENERATE_HEIGHT, cpuReferenceGenerateQ3Thread)
+}
+
+static void cpuReferenceGenerateQ3Base(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(FFX_CACAO_GENERATE_WIDTH, FFX_CACAO_GENERATE_HEIGHT, cpuReferenceGenerateQ3BaseThread)
+}
+
+// =============================================================================
+// Importance Map
+
+static inline void cpuReferenceGenerateImportanceMapThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *finalSsao = &info->descriptorSet->inputs[0];
+
+	float baseU = ((float)(2 * x) + 0.5f) * consts->SSAOBufferInverseDimensions[0];
+	float baseV = ((float)(2 * y) + 0.5f) * consts->SSAOBufferInverseDimensions[1];
+
+	float minV = 1.0f;
+	float maxV = 0.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		CpuFloat4 gathered = cpuGatherRed(finalSsao, baseU, baseV, (float)i, 0, 0, CPU_ADDRESS_MODE_CLAMP);
+		float vals[4] = { gathered.x, gathered.y, gathered.z, gathered.w };
+		for (int j = 0; j < 4; ++j)
+		{
+			// apply the same modifications that would have been applied in the main shader
+			float val = consts->EffectShadowStrength * vals[j];
+			val = 1.0f - val;
+			val = powf(cpuSaturate(val), consts->EffectShadowPow);
+
+			maxV = FFX_CACAO_MAX(maxV, val);
+			minV = FFX_CACAO_MIN(minV, val);
+		}
+	}
+
+	float minMaxDiff = maxV - minV;
+
+	cpuStoreFloat(&info->descriptorSet->outputs[0], x, y, 0, powf(cpuSaturate(minMaxDiff * 2.0f), 0.8f));
+}
+
+
+static inline void cpuReferencePostprocessImportanceMapAThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *importanceIn = &info->descriptorSet->inputs[0];
+
+	float u = ((float)x + 0.5f) * consts->ImportanceMapInverseDimensions[0];
+	float v = ((float)y + 0.5f) * consts->ImportanceMapInverseDimensions[1];
+
+	float centre = cpuSampleLinear(importanceIn, u, v, 0.0f);
+
+	float halfPixelX = 0.5f * consts->ImportanceMapInverseDimensions[0];
+	float halfPixelY = 0.5f * consts->ImportanceMapInverseDimensions[1];
+
+	float valsX = cpuSampleLinear(importanceIn, u - halfPixelX * 3, v - halfPixelY, 0.0f);
+	float valsY = cpuSampleLinear(importanceIn, u + halfPixelX, v - halfPixelY * 3, 0.0f);
+	float valsZ = cpuSampleLinear(importanceIn, u + halfPixelX * 3, v + halfPixelY, 0.0f);
+	float valsW = cpuSampleLinear(importanceIn, u - halfPixelX, v + halfPixelY * 3, 0.0f);
+
+	float avgVal = (valsX + valsY + valsZ + valsW) * 0.25f;
+	valsX = FFX_CACAO_MAX(valsX, valsZ);
+	valsY = FFX_CACAO_MAX(valsY, valsW);
+	float maxVal = FFX_CACAO_MAX(centre, FFX_CACAO_MAX(valsX, valsY));
+
+	cpuStoreFloat(&info->descriptorSet->outputs[0], x, y, 0, cpuLerp(maxVal, avgVal, CPU_SMOOTHEN_IMPORTANCE));
+}
+
+static inline void cpuReferencePostprocessImportanceMapBThread(const CpuDispatchInfo *info, uint32_t x, uint32_t y, uint32_t z)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *importanceIn = &info->descriptorSet->inputs[0];
+
+	float u = ((float)x + 0.5f) * consts->ImportanceMapInverseDimensions[0];
+	float v = ((float)y + 0.5f) * consts->ImportanceMapInverseDimensions[1];
+
+	float centre = cpuSampleLinear(importanceIn, u, v, 0.0f);
+
+	float halfPixelX = 0.5f * consts->ImportanceMapInverseDimensions[0];
+	float halfPixelY = 0.5f * consts->ImportanceMapInverseDimensions[1];
+
+	float valsX = cpuSampleLinear(importanceIn, u - halfPixelX, v - halfPixelY * 3, 0.0f);
+	float valsY = cpuSampleLinear(importanceIn, u + halfPixelX * 3, v - halfPixelY, 0.0f);
+	float valsZ = cpuSampleLinear(importanceIn, u + halfPixelX, v + halfPixelY * 3, 0.0f);
+	float valsW = cpuSampleLinear(importanceIn, u - halfPixelX * 3, v + halfPixelY, 0.0f);
+
+	float avgVal = (valsX + valsY + valsZ + valsW) * 0.25f;
+	valsX = FFX_CACAO_MAX(valsX, valsZ);
+	valsY = FFX_CACAO_MAX(valsY, valsW);
+	float maxVal = FFX_CACAO_MAX(centre, FFX_CACAO_MAX(valsX, valsY));
+
+	float retVal = cpuLerp(maxVal, avgVal, CPU_SMOOTHEN_IMPORTANCE);
+	cpuStoreFloat(&info->descriptorSet->outputs[0], x, y, 0, retVal);
+
+	// sum the average; to avoid overflowing we assume max AO resolution is not bigger than 16384x16384; so quarter res (used here) will be 4096x4096, which leaves us with 8 bits per pixel
+	uint32_t sum = (uint32_t)(cpuSaturate(retVal) * 255.0f + 0.5f);
+
+	// save every 9th to avoid InterlockedAdd congestion - since we're blurring, this is good enough; compensated by multiplying LoadCounterAvgDiv by 9
+	// only texels of the render area are summed, not those of the guard band beyond it or of the rest of the last thread group
+	if (((x % 3) + (y % 3)) == 0 && (float)x < consts->ImportanceMapDimensions[0] && (float)y < consts->ImportanceMapDimensions[1])
+	{
+		*info->loadCounter += sum;
+	}
+}
+
+static void cpuReferenceGenerateImportanceMap(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(IMPORTANCE_MAP_WIDTH, IMPORTANCE_MAP_HEIGHT, cpuReferenceGenerateImportanceMapThread)
+}
+
+static void cpuReferencePostprocessImportanceMapA(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(IMPORTANCE_MAP_A_WIDTH, IMPORTANCE_MAP_A_HEIGHT, cpuReferencePostprocessImportanceMapAThread)
+}
+
+static void cpuReferencePostprocessImportanceMapB(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	CPU_THREAD_GROUP(IMPORTANCE_MAP_B_WIDTH, IMPORTANCE_MAP_B_HEIGHT, cpuReferencePostprocessImportanceMapBThread)
+}
+
+// =============================================================================
+// Edge Sensitive Blur
+
+#define CPU_REFERENCE_BLUR_TILE_WIDTH  4
+#define CPU_REFERENCE_BLUR_TILE_HEIGHT 3
+#define CPU_REFERENCE_BLUR_ARRAY_WIDTH  (CPU_REFERENCE_BLUR_TILE_WIDTH * FFX_CACAO_BLUR_WIDTH + 4)
+#define CPU_REFERENCE_BLUR_ARRAY_HEIGHT (CPU_REFERENCE_BLUR_TILE_HEIGHT * FFX_CACAO_BLUR_HEIGHT + 2)
+
+// emulates FFX_CACAO_LDSEdgeSensitiveBlur; the groupshared buffers hold unpacked (but f16 quantized) values
+static void cpuReferenceEdgeSensitiveBlur(const CpuDispatchInfo *info, uint32_t blurPasses, uint32_t groupX, uint32_t groupY)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *input = &info->descriptorSet->inputs[0];
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
+
+	float front[CPU_REFERENCE_BLUR_ARRAY_HEIGHT][CPU_REFERENCE_BLUR_ARRAY_WIDTH] = {};
+	float back[CPU_REFERENCE_BLUR_ARRAY_HEIGHT][CPU_REFERENCE_BLUR_ARRAY_WIDTH] = {};
+	float packedEdges[CPU_REFERENCE_BLUR_TILE_HEIGHT * FFX_CACAO_BLUR_HEIGHT][CPU_REFERENCE_BLUR_TILE_WIDTH * FFX_CACAO_BLUR_WIDTH];
+
+	int32_t imageX = (int32_t)groupX * (CPU_REFERENCE_BLUR_TILE_WIDTH * FFX_CACAO_BLUR_WIDTH - 2 * (int32_t)blurPasses) - (int32_t)blurPasses;
+	int32_t imageY = (int32_t)groupY * (CPU_REFERENCE_BLUR_TILE_HEIGHT * FFX_CACAO_BLUR_HEIGHT - 2 * (int32_t)blurPasses) - (int32_t)blurPasses;
+
+	for (int32_t y = 0; y < CPU_REFERENCE_BLUR_TILE_HEIGHT * FFX_CACAO_BLUR_HEIGHT; ++y)
+	{
+		for (int32_t x = 0; x < CPU_REFERENCE_BLUR_TILE_WIDTH * FFX_CACAO_BLUR_WIDTH; ++x)
+		{
+			float u = ((float)(imageX + x) + 0.5f) * consts->SSAOBufferInverseDimensions[0];
+			float v = ((float)(imageY + y) + 0.5f) * consts->SSAOBufferInverseDimensions[1];
+			CpuFloat4 ssao = cpuSamplePoint4(input, u, v, 0.0f, 0.0f, 0, 0, CPU_ADDRESS_MODE_MIRROR);
+			front[y + 1][x + 2] = cpuQuantizeHalf(ssao.x);
+			packedEdges[y][x] = cpuQuantizeHalf(ssao.y);
+		}
+	}
+
+	for (uint32_t pass = 0; pass < blurPasses; ++pass)
+	{
+		float (*src)[CPU_REFERENCE_BLUR_ARRAY_WIDTH] = pass % 2 ? back : front;
+		float (*dst)[CPU_REFERENCE_BLUR_ARRAY_WIDTH] = pass % 2 ? front : back;
+		for (int32_t y = 1; y < CPU_REFERENCE_BLUR_TILE_HEIGHT * FFX_CACAO_BLUR_HEIGHT + 1; ++y)
+		{
+			for (int32_t x = 2; x < CPU_REFERENCE_BLUR_TILE_WIDTH * FFX_CACAO_BLUR_WIDTH + 2; ++x)
+			{
+				CpuFloat4 edgesLRTB = cpuUnpackEdges(consts, packedEdges[y - 1][x - 2]);
+				float sum = src[y][x] * 0.5f;
+				float weight = 0.5f;
+				sum += src[y][x - 1] * edgesLRTB.x;
+				weight += edgesLRTB.x;
+				sum += src[y][x + 1] * edgesLRTB.y;
+				weight += edgesLRTB.y;
+				sum += src[y - 1][x] * edgesLRTB.z;
+				weight += edgesLRTB.z;
+				sum += src[y + 1][x] * edgesLRTB.w;
+				weight += edgesLRTB.w;
+				dst[y][x] = cpuQuantizeHalf(sum / weight);
+			}
+		}
+	}
+
+	float (*result)[CPU_REFERENCE_BLUR_ARRAY_WIDTH] = blurPasses % 2 ? back : front;
+	for (int32_t y = (int32_t)blurPasses; y < CPU_REFERENCE_BLUR_TILE_HEIGHT * FFX_CACAO_BLUR_HEIGHT - (int32_t)blurPasses; ++y)
+	{
+		for (int32_t x = (int32_t)blurPasses; x < CPU_REFERENCE_BLUR_TILE_WIDTH * FFX_CACAO_BLUR_WIDTH - (int32_t)blurPasses; ++x)
+		{
+			cpuStoreFloat2(output, imageX + x, imageY + y, 0, result[y + 1][x + 2], packedEdges[y][x]);
+		}
+	}
+}
+
+#define CPU_REFERENCE_EDGE_SENSITIVE_BLUR(blur_passes) \
+	static void cpuReferenceEdgeSensitiveBlur##blur_passes(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ) \
+	{ \
+		cpuReferenceEdgeSensitiveBlur(info, blur_passes, groupX, groupY); \
+	}
+
+CPU_REFERENCE_EDGE_SENSITIVE_BLUR(1)
+CPU_REFERENCE_EDGE_SENSITIVE_BLUR(2)
+CPU_REFERENCE_EDGE_SENSITIVE_BLUR(3)
+CPU_REFERENCE_EDGE_SENSITIVE_BLUR(4)
+CPU_REFERENCE_EDGE_SENSITIVE_BLUR(5)
+CPU_REFERENCE_EDGE_SENSITIVE_BLUR(6)
+CPU_REFERENCE_EDGE_SENSITIVE_BLUR(7)
+CPU_REFERENCE_EDGE_SENSITIVE_BLUR(8)
+
+#undef CPU_REFERENCE_EDGE_SENSITIVE_BLUR
+
+// =============================================================================
+// Bilateral Upscale
+
+#define CPU_REFERENCE_BILATERAL_UPSCALE_BUFFER_WIDTH  (FFX_CACAO_BILATERAL_UPSCALE_WIDTH  + 4)
+#define CPU_REFERENCE_BILATERAL_UPSCALE_BUFFER_HEIGHT (FFX_CACAO_BILATERAL_UPSCALE_HEIGHT + 4 + 4)
+
+typedef struct CpuReferenceBilateralBufferVal {
+	float depth;
+	float ssaoVal;
+} CpuReferenceBilateralBufferVal;
+
+// computes the groupshared value of FFX_CACAO_BilateralUpscaleNxN (or FFX_CACAO_UpscaleBilateral5x5Half) for one image coordinate
+static inline CpuReferenceBilateralBufferVal cpuReferenceBilateralUpscaleBufferVal(const CpuDispatchInfo *info, uint32_t imageX, uint32_t imageY, CpuBilateralUpscaleMode mode)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *ssaoInput = &info->descriptorSet->inputs[0];
+	const CpuImageView *downscaledDepth = &info->descriptorSet->inputs[2];
+	float invW = consts->SSAOBufferInverseDimensions[0];
+	float invH = consts->SSAOBufferInverseDimensions[1];
+	CpuReferenceBilateralBufferVal bufferVal;
+
+	if (mode == CPU_BILATERAL_UPSCALE_MODE_SMART)
+	{
+		// the shader converts the unsigned image coordinate to int2, so coordinates left of or above the image are negative here
+		int32_t px = (int32_t)imageX;
+		int32_t py = (int32_t)imageY;
+		CpuFloat4 centerVal = cpuLoad(ssaoInput, px / 2, py / 2, (px % 2) + 2 * (py % 2), 0);
+
+		int mx = (int)(imageX % 2);
+		int my = (int)(imageY % 2);
+
+		int ic = mx + my * 2;             // center index
+		int ih = (1 - mx) + my * 2;       // neighbouring, horizontal
+		int iv = mx + (1 - my) * 2;       // neighbouring, vertical
+		int id = (1 - mx) + (1 - my) * 2; // diagonal
+
+		float ao = centerVal.x;
+
+		CpuFloat4 edgesLRTB = cpuUnpackEdges(consts, centerVal.y);
+
+		// convert index shifts to sampling offsets
+		float fmx = (float)mx;
+		float fmy = (float)my;
+
+		// in case of an edge, push sampling offsets away from the edge (towards pixel center)
+		float fmxe = (edgesLRTB.y - edgesLRTB.x);
+		float fmye = (edgesLRTB.w - edgesLRTB.z);
+
+		// calculate final sampling offsets and sample using bilinear filter
+		float pX = (float)imageX;
+		float pY = (float)imageY;
+		float aoH = cpuSampleLinear(ssaoInput, (pX + fmx + fmxe - 0.5f) * 0.5f * invW, (pY + 0.5f - fmy) * 0.5f * invH, (float)ih);
+		float aoV = cpuSampleLinear(ssaoInput, (pX + 0.5f - fmx) * 0.5f * invW, (pY + fmy - 0.5f + fmye) * 0.5f * invH, (float)iv);
+		float aoD = cpuSampleLinear(ssaoInput, (pX + fmx - 0.5f + fmxe) * 0.5f * invW, (pY + fmy - 0.5f + fmye) * 0.5f * invH, (float)id);
+
+		// reduce weight for samples near edge - if the edge is on both sides, weight goes to 0
+		float blendWeightsX = 1.0f;
+		float blendWeightsY = (edgesLRTB.x + edgesLRTB.y) * 0.5f;
+		float blendWeightsZ = (edgesLRTB.z + edgesLRTB.w) * 0.5f;
+		float blendWeightsW = (blendWeightsY + blendWeightsZ) * 0.5f;
+
+		// calculate weighted average
+		float blendWeightsSum = blendWeightsX + blendWeightsY + blendWeightsZ + blendWeightsW;
+		ao = (ao * blendWeightsX + aoH * blendWeightsY + aoV * blendWeightsZ + aoD * blendWeightsW) / blendWeightsSum;
+
+		// the shader increments the image coordinate before computing the depth location
+		uint32_t depthX = (uint32_t)((float)((imageX + 1) / 2) + consts->DeinterleavedDepthBufferOffset[0]);
+		uint32_t depthY = (uint32_t)((float)(imageY / 2) + consts->DeinterleavedDepthBufferOffset[1]);
+		bufferVal.depth = cpuLoad(downscaledDepth, (int32_t)depthX, (int32_t)depthY, ic, 0).x;
+		bufferVal.ssaoVal = ao;
+	}
+	else if (mode == CPU_BILATERAL_UPSCALE_MODE_NON_SMART)
+	{
+		float sampleLoc0U = ((float)(imageX / 2) + 0.5f) * invW;
+		float sampleLoc0V = ((float)(imageY / 2) + 0.5f) * invH;
+		float sampleLoc1U = sampleLoc0U, sampleLoc1V = sampleLoc0V;
+		float sampleLoc2U = sampleLoc0U, sampleLoc2V = sampleLoc0V;
+		float sampleLoc3U = sampleLoc0U, sampleLoc3V = sampleLoc0V;
+		switch ((imageY % 2) * 2 + (imageX % 2)) {
+		case 0:
+			sampleLoc1U -= 0.5f * invW;
+			sampleLoc2V -= 0.5f * invH;
+			sampleLoc3U -= 0.5f * invW;
+			sampleLoc3V -= 0.5f * invH;
+			break;
+		case 1:
+			sampleLoc0U += 0.5f * invW;
+			sampleLoc2U += 0.5f * invW;
+			sampleLoc2V -= 0.5f * invH;
+			sampleLoc3V -= 0.5f * invH;
+			break;
+		case 2:
+			sampleLoc0V += 0.5f * invH;
+			sampleLoc1U -= 0.5f * invW;
+			sampleLoc1V += 0.5f * invH;
+			sampleLoc3U -= 0.5f * invW;
+			break;
+		case 3:
+			sampleLoc0U += 0.5f * invW;
+			sampleLoc0V += 0.5f * invH;
+			sampleLoc1V += 0.5f * invH;
+			sampleLoc2U += 0.5f * invW;
+			break;
+		}
+
+		float ssaoVal0 = cpuSamplePoint(ssaoInput, sampleLoc0U, sampleLoc0V, 0.0f, 0.0f, 0, 0, CPU_ADDRESS_MODE_CLAMP);
+		float ssaoVal1 = cpuSamplePoint(ssaoInput, sampleLoc1U, sampleLoc1V, 1.0f, 0.0f, 0, 0, CPU_ADDRESS_MODE_CLAMP);
+		float ssaoVal2 = cpuSamplePoint(ssaoInput, sampleLoc2U, sampleLoc2V, 2.0f, 0.0f, 0, 0, CPU_ADDRESS_MODE_CLAMP);
+		float ssaoVal3 = cpuSamplePoint(ssaoInput, sampleLoc3U, sampleLoc3V, 3.0f, 0.0f, 0, 0, CPU_ADDRESS_MODE_CLAMP);
+
+		uint32_t depthX = (uint32_t)((float)(imageX / 2) + consts->DeinterleavedDepthBufferOffset[0]);
+		uint32_t depthY = (uint32_t)((float)(imageY / 2) + consts->DeinterleavedDepthBufferOffset[1]);
+		int32_t depthIndex = (int32_t)(2 * (imageY % 2) + imageX % 2);
+		bufferVal.depth = cpuLoad(downscaledDepth, (int32_t)depthX, (int32_t)depthY, depthIndex, 0).x;
+		bufferVal.ssaoVal = (ssaoVal0 + ssaoVal1 + ssaoVal2 + ssaoVal3) * 0.25f;
+	}
+	else
+	{
+		float sampleLoc0U = ((float)(imageX / 2) + 0.5f) * invW;
+		float sampleLoc0V = ((float)(imageY / 2) + 0.5f) * invH;
+		float sampleLoc1U = sampleLoc0U, sampleLoc1V = sampleLoc0V;
+		switch ((imageY % 2) * 2 + (imageX % 2)) {
+		case 0:
+			sampleLoc1U -= 0.5f * invW;
+			sampleLoc1V -= 0.5f * invH;
+			break;
+		case 1:
+			sampleLoc0U += 0.5f * invW;
+			sampleLoc1V -= 0.5f * invH;
+			break;
+		case 2:
+			sampleLoc0V += 0.5f * invH;
+			sampleLoc1U -= 0.5f * invW;
+			break;
+		case 3:
+			sampleLoc0U += 0.5f * invW;
+			sampleLoc0V += 0.5f * invH;
+			break;
+		}
+
+		float ssaoVal0 = cpuSamplePoint(ssaoInput, sampleLoc0U, sampleLoc0V, 0.0f, 0.0f, 0, 0, CPU_ADDRESS_MODE_CLAMP);
+		float ssaoVal1 = cpuSamplePoint(ssaoInput, sampleLoc1U, sampleLoc1V, 3.0f, 0.0f, 0, 0, CPU_ADDRESS_MODE_CLAMP);
+
+		uint32_t depthX = (uint32_t)((float)(imageX / 2) + consts->DeinterleavedDepthBufferOffset[0]);
+		uint32_t depthY = (uint32_t)((float)(imageY / 2) + consts->DeinterleavedDepthBufferOffset[1]);
+		int32_t depthIndex = (int32_t)((imageY % 2) * 3);
+		bufferVal.depth = cpuLoad(downscaledDepth, (int32_t)depthX, (int32_t)depthY, depthIndex, 0).x;
+		bufferVal.ssaoVal = (ssaoVal0 + ssaoVal1) * 0.5f;
+	}
+
+	// groupshared values are packed to f16 by the shader
+	bufferVal.depth = cpuQuantizeHalf(bufferVal.depth);
+	bufferVal.ssaoVal = cpuQuantizeHalf(bufferVal.ssaoVal);
+	return bufferVal;
+}
+
+static void cpuReferenceBilateralUpscale(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, CpuBilateralUpscaleMode mode)
+{
+	const FFX_CACAO_Constants *consts = info->constants;
+	const CpuImageView *depthIn = &info->descriptorSet->inputs[1];
+	const CpuImageView *output = &info->descriptorSet->outputs[0];
+	const int width = 2, height = 2;
+
+	// fill in group shared buffer, the image coordinate wraps around for the first group as in the shader
+	CpuReferenceBilateralBufferVal buffer[CPU_REFERENCE_BILATERAL_UPSCALE_BUFFER_WIDTH][CPU_REFERENCE_BILATERAL_UPSCALE_BUFFER_HEIGHT];
+	for (uint32_t bufferY = 0; bufferY < CPU_REFERENCE_BILATERAL_UPSCALE_BUFFER_HEIGHT; ++bufferY)
+	{
+		for (uint32_t bufferX = 0; bufferX < CPU_REFERENCE_BILATERAL_UPSCALE_BUFFER_WIDTH; ++bufferX)
+		{
+			uint32_t imageX = groupX * FFX_CACAO_BILATERAL_UPSCALE_WIDTH + bufferX - 2;
+			uint32_t imageY = groupY * FFX_CACAO_BILATERAL_UPSCALE_HEIGHT + bufferY - 2;
+			buffer[bufferX][bufferY] = cpuReferenceBilateralUpscaleBufferVal(info, imageX, imageY, mode);
+		}
+	}
+
+	float distanceSigma = consts->BilateralSimilarityDistanceSigma;
+	float packedDistSigma = 1.0f / distanceSigma;
+	float sigma = consts->BilateralSigmaSquared;
+	float packedSigma = 1.0f / sigma;
+
+	for (uint32_t gtidY = 0; gtidY < FFX_CACAO_BILATERAL_UPSCALE_HEIGHT; ++gtidY)
+	{
+		for (uint32_t gtidX = 0; gtidX < FFX_CACAO_BILATERAL_UPSCALE_WIDTH; ++gtidX)
+		{
+			int32_t tidX = (int32_t)(groupX * FFX_CACAO_BILATERAL_UPSCALE_WIDTH + gtidX);
+			int32_t tidY = (int32_t)(groupY * FFX_CACAO_BILATERAL_UPSCALE_HEIGHT + gtidY);
+
+			// load depths
+			int32_t fullDepthX = 2 * tidX + consts->DepthBufferOffset[0];
+			int32_t fullDepthY = 2 * tidY + consts->DepthBufferOffset[1];
+			float depths[4];
+			depths[0] = cpuScreenSpaceToViewSpaceDepth(consts, cpuLoad(depthIn, fullDepthX + 0, fullDepthY + 0, 0, 0).x);
+			depths[1] = cpuScreenSpaceToViewSpaceDepth(consts, cpuLoad(depthIn, fullDepthX + 1, fullDepthY + 0, 0, 0).x);
+			depths[2] = cpuScreenSpaceToViewSpaceDepth(consts, cpuLoad(depthIn, fullDepthX + 0, fullDepthY + 1, 0, 0).x);
+			depths[3] = cpuScreenSpaceToViewSpaceDepth(consts, cpuLoad(depthIn, fullDepthX + 1, fullDepthY + 1, 0, 0).x);
+
+			int32_t baseBufferX = (int32_t)gtidX + width;
+			int32_t baseBufferY = (int32_t)gtidY + height;
+
+			const float epsilonWeight = 1e-3f;
+			float nearestSsaoVal = buffer[baseBufferX][baseBufferY].ssaoVal;
+			float totals[4] = { epsilonWeight * nearestSsaoVal, epsilonWeight * nearestSsaoVal, epsilonWeight * nearestSsaoVal, epsilonWeight * nearestSsaoVal };
+			float totalWeights[4] = { epsilonWeight, epsilonWeight, epsilonWeight, epsilonWeight };
+
+			for (int x = -width; x <= width; ++x)
+			{
+				for (int y = -height; y <= height; ++y)
+				{
+					const CpuReferenceBilateralBufferVal *bufferVal = &buffer[baseBufferX + x][baseBufferY + y];
+
+					float u[2] = { (float)x - 0.0f, (float)x - 0.5f };
+					float v1 = (float)y;
+					float v2 = (float)y - 0.5f;
+
+					for (int i = 0; i < 2; ++i)
+					{
+						float dist1 = u[i] * u[i] + v1 * v1;
+						float dist2 = u[i] * u[i] + v2 * v2;
+
+						float wx1 = expf(-dist1 * packedSigma);
+						float wx2 = expf(-dist2 * packedSigma);
+
+						float diff1 = depths[i] - bufferVal->depth;
+						float diff2 = depths[2 + i] - bufferVal->depth;
+						diff1 *= diff1;
+						diff2 *= diff2;
+
+						float wy1 = expf(-diff1 * packedDistSigma);
+						float wy2 = expf(-diff2 * packedDistSigma);
+
+						float weight1 = wx1 * wy1;
+						float weight2 = wx2 * wy2;
+
+						totals[i] += bufferVal->ssaoVal * weight1;
+						totals[2 + i] += bufferVal->ssaoVal * weight2;
+						totalWeights[i] += weight1;
+						totalWeights[2 + i] += weight2;
+					}
+				}
+			}
+
+			int32_t outputX = 2 * tidX;
+			int32_t outputY = 2 * tidY;
+			cpuStoreFloat(output, outputX + 0, outputY + 0, 0, totals[0] / totalWeights[0]);
+			cpuStoreFloat(output, outputX + 1, outputY + 0, 0, totals[1] / totalWeights[1]);
+			cpuStoreFloat(output, outputX + 0, outputY + 1, 0, totals[2] / totalWeights[2]);
+			cpuStoreFloat(output, outputX + 1, outputY + 1, 0, totals[3] / totalWeights[3]);
+		}
+	}
+}
+
+static void cpuReferenceUpscaleBilateral5x5Smart(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuReferenceBilateralUpscale(info, groupX, groupY, CPU_BILATERAL_UPSCALE_MODE_SMART);
+}
+
+static void cpuReferenceUpscaleBilateral5x5NonSmart(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuReferenceBilateralUpscale(info, groupX, groupY, CPU_BILATERAL_UPSCALE_MODE_NON_SMART);
+}
+
+static void cpuReferenceUpscaleBilateral5x5Half(const CpuDispatchInfo *info, uint32_t groupX, uint32_t groupY, uint32_t groupZ)
+{
+	cpuReferenceBilateralUpscale(info, groupX, groupY, CPU_BILATERAL_UPSCALE_MODE_HALF);
+}
+
+
+// the ports above of these shaders are transcriptions already
+#define cpuReferencePrepareDownsampledDepthsHalf                  cpuPrepareDownsampledDepthsHalf
+#define cpuReferencePrepareNativeDepthsHalf                       cpuPrepareNativeDepthsHalf
+#define cpuReferencePrepareDownsampledNormals                     cpuPrepareDownsampledNormals
+#define cpuReferencePrepareNativeNormals                          cpuPrepareNativeNormals
+#define cpuReferencePrepareDownsampledNormalsFromInputNormals     cpuPrepareDownsampledNormalsFromInputNormals
+#define cpuReferencePrepareNativeNormalsFromInputNormals          cpuPrepareNativeNormalsFromInputNormals
+#define cpuReferenceApply                                         cpuApply
+#define cpuReferenceNonSmartApply                                 cpuNonSmartApply
+#define cpuReferenceNonSmartHalfApply                             cpuNonSmartHalfApply
+
+static const CpuComputeShader COMPUTE_SHADER_CPU_REFERENCE[] = {
+#define COMPUTE_SHADER(name, pascal_name, descriptor_set_layout, spirv_module, spirv_specialization) cpuReference##pascal_name,
+	COMPUTE_SHADERS
+#undef COMPUTE_SHADER
+};
+
+#undef cpuReferencePrepareDownsampledDepthsHalf
+#undef cpuReferencePrepareNativeDepthsHalf
+#undef cpuReferencePrepareDownsampledNormals
+#undef cpuReferencePrepareNativeNormals
+#undef cpuReferencePrepareDownsampledNormalsFromInputNormals
+#undef cpuReferencePrepareNativeNormalsFromInputNormals
+#undef cpuReferenceApply
+#undef cpuReferenceNonSmartApply
+#undef cpuReferenceNonSmartHalfApply
+
+#undef CPU_THREAD_GROUP
+
+// =================================================================================================
+// CACAO cpu context
+// =================================================================================================
+
+#define CPU_CACHE_LINE_SIZE 64
+
+static inline size_t cpuAlign(size_t value, size_t alignment)
+{
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// the internal job system: a pool of worker threads executing parallel for loops, with the calling thread participating
+
+typedef struct CpuThreadPool {
+	std::thread             *workers;
+	uint32_t                 numWorkers;
+	std::mutex               mutex;
+	std::condition_variable  wakeCondition;
+	std::condition_variable  doneCondition;
+	uint64_t                 generation;
+	uint32_t                 numActiveWorkers;
+	bool                     shutdown;
+
+	FFX_CACAO_CpuTaskFunc    task;
+	void                    *taskData;
+	uint32_t                 numTasks;
+} CpuThreadPool;
+
+// a range of thread groups [begin, end) of the current dispatch, begin in the low 32 bits.
+// each lane is padded to its own cache line so that owners and thieves only contend when stealing.
+typedef struct CpuSchedulerLane {
+	std::atomic<uint64_t> groups;
+	uint8_t               padding[CPU_CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>)];
+} CpuSchedulerLane;
+
+// executes dispatches as a parallel for loop over tasks of a job system, one task per lane.
+// the groups of a dispatch are split into contiguous ranges, one per lane, and a task whose range runs dry steals half of
+// the remaining range of another lane. each task has its own emulated groupshared memory.
+typedef struct CpuScheduler {
+	FFX_CACAO_CpuJobSystem  jobSystem;
+	CpuThreadPool          *threadPool;       ///< the internal job system, NULL when an external job system is used
+	void                   *memory;
+	CpuSchedulerLane       *lanes;            ///< jobSystem.numTasks lanes
+	CpuGroupShared         *groupShared;      ///< jobSystem.numTasks groupshared memories
+
+	CpuComputeShader        shader;
+	CpuDispatchInfo         dispatchInfo;
+	uint32_t                numGroups[3];
+} CpuScheduler;
+
+// the stages of FFX_CACAO_CpuDraw, in the order of the timestamps of the same names
+#define CPU_STAGES \
+	CPU_STAGE(PREPARE) \
+	CPU_STAGE(BASE_SSAO_PASS) \
+	CPU_STAGE(IMPORTANCE_MAP) \
+	CPU_STAGE(GENERATE_SSAO) \
+	CPU_STAGE(EDGE_SENSITIVE_BLUR) \
+	CPU_STAGE(BILATERAL_UPSAMPLE) \
+	CPU_STAGE(APPLY)
+
+typedef enum CpuStageID {
+#define CPU_STAGE(name) CPU_STAGE_##name,
+	CPU_STAGES
+#undef CPU_STAGE
+	NUM_CPU_STAGES
+} CpuStageID;
+
+static const char *CPU_STAGE_NAMES[NUM_CPU_STAGES] = {
+#define CPU_STAGE(name) "FFX_CACAO_" #name,
+	CPU_STAGES
+#undef CPU_STAGE
+};
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+static_assert(TIMESTAMP_APPLY - TIMESTAMP_PREPARE == CPU_STAGE_APPLY - CPU_STAGE_PREPARE, "the stages must match the timestamps");
+#endif
+
+typedef struct FFX_CACAO_CpuContext {
+	FFX_CACAO_Settings       settings;
+	FFX_CACAO_Bool           useDownsampledSsao;
+	FFX_CACAO_BufferSizeInfo bufferSizeInfo;
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	struct {
+		TimestampID timestamps[NUM_TIMESTAMPS];
+		uint64_t    timings[NUM_TIMESTAMPS];
+		uint32_t    numTimestamps;
+	} timestampQueries;
+#endif
+
+	CpuScheduler         *scheduler;
+	const CpuComputeShader *computeShaders; ///< COMPUTE_SHADER_CPU, or COMPUTE_SHADER_CPU_REFERENCE for reference contexts
+	bool                  reference;
+	CpuSSAOTapKernel      ssaoTapKernel;
+	CpuBlurKernel         blurKernel;
+	CpuBilateralUpscaleKernel bilateralUpscaleKernel;
+
+	CpuTexture            textures[NUM_TEXTURES];
+	CpuTexture            depth;
+	CpuTexture            normals;
+	CpuTexture            output;
+
+	CpuDescriptorSet      descriptorSets[NUM_DESCRIPTOR_SETS];
+
+	uint32_t              loadCounter;
+	uint32_t              writtenTextures; ///< bit i is set by dispatches writing textures[i], bit NUM_TEXTURES by those writing output
+	ConstantsCache        constantsCache;
+} FFX_CACAO_CpuContext;
+
+static_assert(NUM_TEXTURES < 32, "the written textures of a context must fit in a mask");
+
+static inline FFX_CACAO_CpuContext* getAlignedCpuContextPointer(FFX_CACAO_CpuContext* ptr)
+{
+	uintptr_t tmp = (uintptr_t)ptr;
+	tmp = (tmp + alignof(FFX_CACAO_CpuContext) - 1) & (~(alignof(FFX_CACAO_CpuContext) - 1));
+	return (FFX_CACAO_CpuContext*)tmp;
+}
+
+// participant i of numWorkers + 1 runs tasks i, i + numWorkers + 1, ...
+static void cpuThreadPoolRunTasks(CpuThreadPool *pool, uint32_t participant)
+{
+	for (uint32_t taskIndex = participant; taskIndex < pool->numTasks; taskIndex += pool->numWorkers + 1)
+	{
+		pool->task(pool->taskData, taskIndex);
+	}
+}
+
+static void cpuThreadPoolWorker(CpuThreadPool *pool, uint32_t participant)
+{
+	uint64_t generation = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(pool->mutex);
+			while (!pool->shutdown && pool->generation == generation)
+			{
+				pool->wakeCondition.wait(lock);
+			}
+			if (pool->shutdown)
+			{
+				return;
+			}
+			generation = pool->generation;
+		}
+
+		cpuThreadPoolRunTasks(pool, participant);
+
+		{
+			std::unique_lock<std::mutex> lock(pool->mutex);
+			if (--pool->numActiveWorkers == 0)
+			{
+				pool->doneCondition.notify_one();
+			}
+		}
+	}
+}
+
+static void cpuThreadPoolDestroy(CpuThreadPool *pool)
+{
+	{
+		std::unique_lock<std::mutex> lock(pool->mutex);
+		pool->shutdown = true;
+	}
+	pool->wakeCondition.notify_all();
+
+	for (uint32_t i = 0; i < pool->numWorkers; ++i)
+	{
+		pool->workers[i].join();
+	}
+
+	delete[] pool->workers;
+	delete pool;
+}
+
+static FFX_CACAO_Status cpuThreadPoolCreate(uint32_t numThreads, CpuThreadPool **outPool)
+{
+	CpuThreadPool *pool = new (std::nothrow) CpuThreadPool();
+	if (pool == NULL)
+	{
+		return FFX_CACAO_STATUS_OUT_OF_MEMORY;
+	}
+
+	uint32_t numWorkers = numThreads - 1;
+	if (numWorkers)
+	{
+		pool->workers = new (std::nothrow) std::thread[numWorkers];
+		if (pool->workers == NULL)
+		{
+			delete pool;
+			return FFX_CACAO_STATUS_OUT_OF_MEMORY;
+		}
+	}
+
+	for ( ; pool->numWorkers < numWorkers; ++pool->numWorkers)
+	{
+		try
+		{
+			pool->workers[pool->numWorkers] = std::thread(cpuThreadPoolWorker, pool, pool->numWorkers + 1);
+		}
+		catch (...)
+		{
+			cpuThreadPoolDestroy(pool);
+			return FFX_CACAO_STATUS_FAILED;
+		}
+	}
+
+	*outPool = pool;
+	return FFX_CACAO_STATUS_OK;
+}
+
+// FFX_CACAO_CpuParallelForFunc of the internal job system
+static void cpuThreadPoolParallelFor(void *userData, FFX_CACAO_CpuTaskFunc task, void *taskData, uint32_t numTasks)
+{
+	CpuThreadPool *pool = (CpuThreadPool*)userData;
+	{
+		std::unique_lock<std::mutex> lock(pool->mutex);
+		pool->task = task;
+		pool->taskData = taskData;
+		pool->numTasks = numTasks;
+		pool->numActiveWorkers = pool->numWorkers;
+		++pool->generation;
+	}
+	pool->wakeCondition.notify_all();
+
+	cpuThreadPoolRunTasks(pool, 0);
+
+	std::unique_lock<std::mutex> lock(pool->mutex);
+	while (pool->numActiveWorkers)
+	{
+		pool->doneCondition.wait(lock);
+	}
+}
+
+static inline uint64_t cpuSchedulerPackRange(uint32_t begin, uint32_t end)
+{
+	return ((uint64_t)end << 32) | begin;
+}
+
+// takes the first group of the lane's range, returns false if it is empty
+static inline bool cpuSchedulerPop(CpuSchedulerLane *lane, uint32_t *outGroup)
+{
+	uint64_t range = lane->groups.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		uint32_t begin = (uint32_t)range;
+		uint32_t end = (uint32_t)(range >> 32);
+		if (begin >= end)
+		{
+			return false;
+		}
+		if (lane->groups.compare_exchange_weak(range, cpuSchedulerPackRange(begin + 1, end), std::memory_order_relaxed))
+		{
+			*outGroup = begin;
+			return true;
+		}
+	}
+}
+
+// moves the back half of the range of another lane to the empty lane of the thief, returns false if all lanes are empty.
+// groups only ever move between ranges through a successful compare exchange, so each runs exactly once.
+static bool cpuSchedulerSteal(CpuScheduler *scheduler, uint32_t thief, uint32_t numLanes)
+{
+	for (uint32_t i = 1; i < numLanes; ++i)
+	{
+		CpuSchedulerLane *victim = &scheduler->lanes[(thief + i) % numLanes];
+		uint64_t range = victim->groups.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			uint32_t begin = (uint32_t)range;
+			uint32_t end = (uint32_t)(range >> 32);
+			if (begin >= end)
+			{
+				break;
+			}
+			uint32_t middle = begin + (end - begin) / 2;
+			if (victim->groups.compare_exchange_weak(range, cpuSchedulerPackRange(begin, middle), std::memory_order_relaxed))
+			{
+				scheduler->lanes[thief].groups.store(cpuSchedulerPackRange(middle, end), std::memory_order_relaxed);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+// FFX_CACAO_CpuTaskFunc executing the thread groups of the current dispatch
+static void cpuSchedulerTask(void *taskData, uint32_t taskIndex)
+{
+	CpuScheduler *scheduler = (CpuScheduler*)taskData;
+	uint32_t numLanes = FFX_CACAO_MIN(scheduler->jobSystem.numTasks, scheduler->numGroups[0] * scheduler->numGroups[1] * scheduler->numGroups[2]);
+	CpuSchedulerLane *lane = &scheduler->lanes[taskIndex];
+	uint32_t numGroupsXY = scheduler->numGroups[0] * scheduler->numGroups[1];
+
+	CpuDispatchInfo info = scheduler->dispatchInfo;
+	info.groupShared = &scheduler->groupShared[taskIndex];
+
+	for (;;)
+	{
+		uint32_t group;
+		if (!cpuSchedulerPop(lane, &group))
+		{
+			if (!cpuSchedulerSteal(scheduler, taskIndex, numLanes))
+			{
+				return;
+			}
+			continue;
+		}
+		uint32_t groupZ = group / numGroupsXY;
+		uint32_t groupXY = group - groupZ * numGroupsXY;
+		uint32_t groupY = groupXY / scheduler->numGroups[0];
+		uint32_t groupX = groupXY - groupY * scheduler->numGroups[0];
+		scheduler->shader(&info, groupX, groupY, groupZ);
+	}
+}
+
+static void cpuSchedulerDestroy(CpuScheduler *scheduler)
+{
+	if (scheduler->threadPool)
+	{
+		cpuThreadPoolDestroy(scheduler->threadPool);
+	}
+	free(scheduler->memory);
+	free(scheduler);
+}
+
+static FFX_CACAO_Status cpuSchedulerCreate(const FFX_CACAO_CpuCreateInfo *info, CpuScheduler **outScheduler)
+{
+	FFX_CACAO_Status errorStatus = FFX_CACAO_STATUS_FAILED;
+
+	CpuScheduler *scheduler = (CpuScheduler*)calloc(1, sizeof(CpuScheduler));
+	if (scheduler == NULL)
+	{
+		return FFX_CACAO_STATUS_OUT_OF_MEMORY;
+	}
+
+	if (info->jobSystem)
+	{
+		scheduler->jobSystem = *info->jobSystem;
+	}
+	else
+	{
+		uint32_t numThreads = info->numThreads ? info->numThreads : FFX_CACAO_MAX(std::thread::hardware_concurrency(), 1u);
+		errorStatus = cpuThreadPoolCreate(numThreads, &scheduler->threadPool);
+		if (errorStatus != FFX_CACAO_STATUS_OK)
+		{
+			goto error_create_thread_pool;
+		}
+		scheduler->jobSystem.parallelFor = cpuThreadPoolParallelFor;
+		scheduler->jobSystem.userData = scheduler->threadPool;
+		scheduler->jobSystem.numTasks = numThreads;
+	}
+
+	{
+		uint32_t numTasks = scheduler->jobSystem.numTasks;
+		size_t groupSharedOffset = cpuAlign(numTasks * sizeof(CpuSchedulerLane), CPU_CACHE_LINE_SIZE);
+		scheduler->memory = malloc(groupSharedOffset + numTasks * sizeof(CpuGroupShared) + CPU_CACHE_LINE_SIZE - 1);
+		if (scheduler->memory == NULL)
+		{
+			errorStatus = FFX_CACAO_STATUS_OUT_OF_MEMORY;
+			goto error_allocate_memory;
+		}
+
+		uint8_t *memory = (uint8_t*)cpuAlign((uintptr_t)scheduler->memory, CPU_CACHE_LINE_SIZE);
+		scheduler->lanes = (CpuSchedulerLane*)memory;
+		scheduler->groupShared = (CpuGroupShared*)(memory + groupSharedOffset);
+		for (uint32_t i = 0; i < numTasks; ++i)
+		{
+			new (&scheduler->lanes[i].groups) std::atomic<uint64_t>(0);
+		}
+	}
+
+	*outScheduler = scheduler;
+	return FFX_CACAO_STATUS_OK;
+
+error_allocate_memory:
+	if (scheduler->threadPool)
+	{
+		cpuThreadPoolDestroy(scheduler->threadPool);
+	}
+error_create_thread_pool:
+	free(scheduler);
+
+	return errorStatus;
+}
+
+static void cpuSchedulerDispatch(CpuScheduler *scheduler, CpuComputeShader shader, const CpuDispatchInfo *info, uint32_t width, uint32_t height, uint32_t depth)
+{
+	uint32_t numGroups = width * height * depth;
+	if (numGroups == 0)
+	{
+		return;
+	}
+
+	scheduler->shader = shader;
+	scheduler->dispatchInfo = *info;
+	scheduler->numGroups[0] = width;
+	scheduler->numGroups[1] = height;
+	scheduler->numGroups[2] = depth;
+
+	// neighbouring groups touch neighbouring texels, so each lane starts with a contiguous band of the grid
+	uint32_t numLanes = FFX_CACAO_MIN(scheduler->jobSystem.numTasks, numGroups);
+	for (uint32_t i = 0; i < numLanes; ++i)
+	{
+		uint32_t begin = (uint32_t)((uint64_t)numGroups * i / numLanes);
+		uint32_t end = (uint32_t)((uint64_t)numGroups * (i + 1) / numLanes);
+		scheduler->lanes[i].groups.store(cpuSchedulerPackRange(begin, end), std::memory_order_relaxed);
+	}
+
+	if (numLanes == 1)
+	{
+		cpuSchedulerTask(scheduler, 0);
+	}
+	else
+	{
+		scheduler->jobSystem.parallelFor(scheduler->jobSystem.userData, cpuSchedulerTask, scheduler, numLanes);
+	}
+}
+#endif
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+// =================================================================================
+// Quality controller
+// =================================================================================
+
+#define QUALITY_CONTROLLER_DEFAULT_SMOOTHING           0.1f
+#define QUALITY_CONTROLLER_DEFAULT_DOWNGRADE_THRESHOLD 1.0f
+#define QUALITY_CONTROLLER_DEFAULT_UPGRADE_THRESHOLD   0.85f
+#define QUALITY_CONTROLLER_DEFAULT_HOLD_FRAMES         30
+#define QUALITY_CONTROLLER_NO_PRESET                   0xffffffffu
+
+struct FFX_CACAO_QualityController {
+	FFX_CACAO_QualityPreset   presets[FFX_CACAO_QUALITY_CONTROLLER_MAX_PRESETS];
+	uint32_t                  numPresets;
+	float                     budgetMilliseconds;
+	float                     millisecondsPerTick;
+	float                     smoothing;
+	float                     downgradeThreshold;
+	float                     upgradeThreshold;
+	uint32_t                  holdFrames;
+	uint32_t                  latencyFrames;
+	FFX_CACAO_QualityCallback callback;
+	void                     *userData;
+
+	uint32_t                  preset;
+	uint32_t                  frame;
+	uint32_t                  framesToDiscard;
+	uint32_t                  numSamples;            // timings of the current preset in the averages
+	uint32_t                  numStages;
+	const char               *labels[FFX_CACAO_ARRAY_SIZE(((FFX_CACAO_DetailedTiming*)0)->timestamps)];
+	float                     smoothedTicks[FFX_CACAO_ARRAY_SIZE(((FFX_CACAO_DetailedTiming*)0)->timestamps)];
+	// cost of preset i relative to preset i + 1, zero until the controller has switched between them
+	float                     costRatios[FFX_CACAO_QUALITY_CONTROLLER_MAX_PRESETS];
+	uint32_t                  previousPreset;        // the preset before the last change, until its cost ratio is measured
+	float                     previousMilliseconds;  // the smoothed time of previousPreset when it was left
+};
+
+static void qualityControllerSmooth(FFX_CACAO_QualityController* controller, const FFX_CACAO_DetailedTiming* timings)
+{
+	uint32_t numStages = FFX_CACAO_MIN(timings->numTimestamps, (uint32_t)FFX_CACAO_ARRAY_SIZE(controller->smoothedTicks));
+	for (uint32_t i = 0; i < numStages; ++i)
+	{
+		const FFX_CACAO_Timestamp *timestamp = &timings->timestamps[i];
+		float ticks = (float)timestamp->ticks;
+		// the stages of a preset are always the same, restart the average of any stage that is not
+		bool restart = controller->numSamples == 0 || i >= controller->numStages
+			|| (timestamp->label != controller->labels[i] && (!timestamp->label || !controller->labels[i] || strcmp(timestamp->label, controller->labels[i])));
+		controller->smoothedTicks[i] = restart ? ticks : controller->smoothedTicks[i] + controller->smoothing * (ticks - controller->smoothedTicks[i]);
+		controller->labels[i] = timestamp->label;
+	}
+	controller->numStages = numStages;
+	++controller->numSamples;
+}
+
+// the cost ratio of two neighbouring presets is measured once the preset switched to has been averaged for holdFrames
+static void qualityControllerLearnCostRatio(FFX_CACAO_QualityController* controller, float milliseconds)
+{
+	uint32_t previous = controller->previousPreset;
+	uint32_t current = controller->preset;
+	controller->previousPreset = QUALITY_CONTROLLER_NO_PRESET;
+	if (previous == QUALITY_CONTROLLER_NO_PRESET || milliseconds <= 0.0f || controller->previousMilliseconds <= 0.0f)
+	{
+		return;
+	}
+	if (previous + 1 == current)
+	{
+		controller->costRatios[previous] = controller->previousMilliseconds / milliseconds;
+	}
+	else if (current + 1 == previous)
+	{
+		controller->costRatios[current] = milliseconds / controller->previousMilliseconds;
+	}
+}
+
+static void qualityControllerChangePreset(FFX_CACAO_QualityController* controller, uint32_t preset, float milliseconds, float predictedMilliseconds)
+{
+	FFX_CACAO_QualityDecision decision;
+	decision.frame = controller->frame;
+	decision.previousPreset = controller->preset;
+	decision.preset = preset;
+	decision.smoothedMilliseconds = milliseconds;
+	decision.predictedMilliseconds = predictedMilliseconds;
+
+	controller->previousPreset = controller->preset;
+	controller->previousMilliseconds = milliseconds;
+	controller->preset = preset;
+	controller->numSamples = 0;
+	controller->framesToDiscard = controller->latencyFrames;
+
+	if (controller->callback)
+	{
+		controller->callback(controller->userData, &decision, &controller->presets[preset]);
+	}
+}
+#endif
+
+
+// =================================================================================
+// Interface
+// =================================================================================
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef FFX_CACAO_ENABLE_D3D12
+size_t FFX_CACAO_D3D12GetContextSize()
+{
+	return sizeof(FFX_CACAO_D3D12Context) + alignof(FFX_CACAO_D3D12Context) - 1;
+}
+
+FFX_CACAO_Status FFX_CACAO_D3D12InitContext(FFX_CACAO_D3D12Context* context, ID3D12Device* device)
+{
+	if (context == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if (device == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedD3D12ContextPointer(context);
+
+	uint32_t numInputDescriptorsInited = 0;
+	uint32_t numOutputDescriptorsInited = 0;
+	uint32_t numRootSignaturesInited = 0;
+	uint32_t numComputeShadersInited = 0;
+	ShaderScratch scratch = {};
+
+#define COMPUTE_SHADER_INIT(name, entryPoint, uavSize, srvSize) \
+	errorStatus = computeShaderInit(&context->name, device, #entryPoint, entryPoint ## DXIL, sizeof(entryPoint ## DXIL), uavSize, srvSize, samplers, FFX_CACAO_ARRAY_SIZE(samplers)); \
+	if (errorStatus) \
+	{ \
+		goto error_create_ ## entryPoint; \
+	}
+#define ERROR_COMPUTE_SHADER_DESTROY(name, entryPoint) \
+	computeShaderDestroy(&context->name); \
+error_create_ ## entryPoint:
+
+	FFX_CACAO_Status errorStatus = FFX_CACAO_STATUS_FAILED;
+
+	context->device = device;
+	constantsCacheInit(&context->constantsCache);
+	CbvSrvUavHeap *cbvSrvUavHeap = &context->cbvSrvUavHeap;
+	errorStatus = cbvSrvUavHeapInit(cbvSrvUavHeap, device, 512);
+	if (errorStatus)
+	{
+		goto error_create_cbv_srv_uav_heap;
+	}
+	errorStatus = constantBufferRingInit(&context->constantBufferRing, device, 5, 1024 * 5);
+	if (errorStatus)
+	{
+		goto error_create_constant_buffer_ring;
+	}
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	errorStatus = gpuTimerInit(&context->gpuTimer, device);
+	if (errorStatus)
+	{
+		goto error_create_gpu_timer;
+	}
+#endif
+
+	D3D12_STATIC_SAMPLER_DESC samplers[5] = { };
+
+	samplers[0].Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
+	samplers[0].AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplers[0].AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplers[0].AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplers[0].ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
+	samplers[0].BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
+	samplers[0].MinLOD = 0.0f;
+	samplers[0].MaxLOD = D3D12_FLOAT32_MAX;
+	samplers[0].MipLODBias = 0;
+	samplers[0].MaxAnisotropy = 1;
+	samplers[0].ShaderRegister = 0;
+	samplers[0].RegisterSpace = 0;
+	samplers[0].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+	samplers[1].Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
+	samplers[1].AddressU = D3D12_TEXTURE_ADDRESS_MODE_MIRROR;
+	samplers[1].AddressV = D3D12_TEXTURE_ADDRESS_MODE_MIRROR;
+	samplers[1].AddressW = D3D12_TEXTURE_ADDRESS_MODE_MIRROR;
+	samplers[1].ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
+	samplers[1].BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
+	samplers[1].MinLOD = 0.0f;
+	samplers[1].MaxLOD = D3D12_FLOAT32_MAX;
+	samplers[1].MipLODBias = 0;
+	samplers[1].MaxAnisotropy = 1;
+	samplers[1].ShaderRegister = 1;
+	samplers[1].RegisterSpace = 0;
+	samplers[1].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+	samplers[2].Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+	samplers[2].AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplers[2].AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplers[2].AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplers[2].ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
+	samplers[2].BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
+	samplers[2].MinLOD = 0.0f;
+	samplers[2].MaxLOD = D3D12_FLOAT32_MAX;
+	samplers[2].MipLODBias = 0;
+	samplers[2].MaxAnisotropy = 1;
+	samplers[2].ShaderRegister = 2;
+	samplers[2].RegisterSpace = 0;
+	samplers[2].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+	samplers[3].Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
+	samplers[3].AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplers[3].AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplers[3].AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+	samplers[3].ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
+	samplers[3].BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
+	samplers[3].MinLOD = 0.0f;
+	samplers[3].MaxLOD = D3D12_FLOAT32_MAX;
+	samplers[3].MipLODBias = 0;
+	samplers[3].MaxAnisotropy = 1;
+	samplers[3].ShaderRegister = 3;
+	samplers[3].RegisterSpace = 0;
+	samplers[3].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+	samplers[4].Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
+	samplers[4].AddressU = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
+	samplers[4].AddressV = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
+	samplers[4].AddressW = D3D12_TEXTURE_ADDRESS_MODE_BORDER;
+	samplers[4].ComparisonFunc = D3D12_COMPARISON_FUNC_ALWAYS;
+	samplers[4].BorderColor = D3D12_STATIC_BORDER_COLOR_TRANSPARENT_BLACK;
+	samplers[4].MinLOD = 0.0f;
+	samplers[4].MaxLOD = D3D12_FLOAT32_MAX;
+	samplers[4].MipLODBias = 0;
+	samplers[4].MaxAnisotropy = 1;
+	samplers[4].ShaderRegister = 4;
+	samplers[4].RegisterSpace = 0;
+	samplers[4].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+
+	errorStatus = textureInit(&context->loadCounter, device, "CACAO::m_loadCounter", &CD3DX12_RESOURCE_DESC::Tex1D(DXGI_FORMAT_R32_UINT, 1, 1, 1, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, NULL);
+	if (errorStatus)
+	{
+		goto error_create_load_counter_texture;
+	}
+
+	// create uav for load counter
+	{
+		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+		uavDesc.Format = DXGI_FORMAT_R32_UINT;
+		uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE1D;
+		uavDesc.Texture1D.MipSlice = 0;
+
+		cbvSrvUavHeapAllocDescriptor(cbvSrvUavHeap, &context->loadCounterUav, 1); // required for clearing the load counter
+		textureCreateUavFromDesc(&context->loadCounter, 0, &context->loadCounterUav, &uavDesc);
+	}
+
+	for (; numInputDescriptorsInited < NUM_DESCRIPTOR_SETS; ++numInputDescriptorsInited)
+	{
+		uint32_t size = DESCRIPTOR_SET_LAYOUT_META_DATA[DESCRIPTOR_SET_META_DATA[numInputDescriptorsInited].descriptorSetLayoutID].numInputs;
+		cbvSrvUavHeapAllocDescriptor(cbvSrvUavHeap, &context->inputDescriptors[numInputDescriptorsInited], size);
+	}
+
+	for (; numOutputDescriptorsInited < NUM_DESCRIPTOR_SETS; ++numOutputDescriptorsInited)
+	{
+		uint32_t size = DESCRIPTOR_SET_LAYOUT_META_DATA[DESCRIPTOR_SET_META_DATA[numOutputDescriptorsInited].descriptorSetLayoutID].numOutputs;
+		cbvSrvUavHeapAllocDescriptor(cbvSrvUavHeap, &context->outputDescriptors[numOutputDescriptorsInited], size);
+	}
+
+	for (; numRootSignaturesInited < NUM_COMPUTE_SHADERS; ++numRootSignaturesInited)
+	{
+		ComputeShaderMetaData metaData = COMPUTE_SHADER_META_DATA[numRootSignaturesInited];
+		DescriptorSetLayoutMetaData dslMetaData = DESCRIPTOR_SET_LAYOUT_META_DATA[metaData.descriptorSetLayoutID];
+
+		CD3DX12_DESCRIPTOR_RANGE DescRange[4];
+		CD3DX12_ROOT_PARAMETER RTSlot[4];
+
+		// we'll always have a constant buffer
+		int parameterCount = 0;
+		DescRange[parameterCount].Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);
+		RTSlot[parameterCount++].InitAsConstantBufferView(0, 0, D3D12_SHADER_VISIBILITY_ALL);
+
+		// if we have a UAV table
+		if (dslMetaData.numOutputs > 0)
+		{
+			DescRange[parameterCount].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, dslMetaData.numOutputs, 0);
+			RTSlot[parameterCount].InitAsDescriptorTable(1, &DescRange[parameterCount], D3D12_SHADER_VISIBILITY_ALL);
+			++parameterCount;
+		}
+
+		// if we have a SRV table
+		if (dslMetaData.numInputs > 0)
+		{
+			DescRange[parameterCount].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, dslMetaData.numInputs, 0);
+			RTSlot[parameterCount].InitAsDescriptorTable(1, &DescRange[parameterCount], D3D12_SHADER_VISIBILITY_ALL);
+			++parameterCount;
+		}
+
+		// the root signature contains 3 slots to be used
+		CD3DX12_ROOT_SIGNATURE_DESC descRootSignature = CD3DX12_ROOT_SIGNATURE_DESC();
+		descRootSignature.NumParameters = parameterCount;
+		descRootSignature.pParameters = RTSlot;
+		descRootSignature.NumStaticSamplers = FFX_CACAO_ARRAY_SIZE(samplers);
+		descRootSignature.pStaticSamplers = samplers;
+
+		// deny uneccessary access to certain pipeline stages
+		descRootSignature.Flags = D3D12_ROOT_SIGNATURE_FLAG_NONE;
+
+		ID3DBlob *outBlob, *errorBlob = NULL;
+
+		HRESULT hr = D3D12SerializeRootSignature(&descRootSignature, D3D_ROOT_SIGNATURE_VERSION_1, &outBlob, &errorBlob);
+		if (FAILED(hr))
+		{
+			errorStatus = hresultToFFX_CACAO_Status(hr);
+			goto error_init_root_signature;
+		}
+
+		if (errorBlob)
+		{
+			errorBlob->Release();
+			if (outBlob)
+			{
+				outBlob->Release();
+			}
+			errorStatus = FFX_CACAO_STATUS_FAILED;
+			goto error_init_root_signature;
+		}
+
+		hr = device->CreateRootSignature(0, outBlob->GetBufferPointer(), outBlob->GetBufferSize(), IID_PPV_ARGS(&context->csRootSignatures[numRootSignaturesInited]));
+		if (FAILED(hr))
+		{
+			outBlob->Release();
+			errorStatus = hresultToFFX_CACAO_Status(hr);
+			goto error_init_root_signature;
+		}
+
+		SetName(context->csRootSignatures[numRootSignaturesInited], metaData.rootSignatureName);
+
+		outBlob->Release();
+	}
+
+	for (; numComputeShadersInited < NUM_COMPUTE_SHADERS; ++numComputeShadersInited)
+	{
+		ComputeShaderMetaData metaData = COMPUTE_SHADER_META_DATA[numComputeShadersInited];
+
+		errorStatus = shaderScratchDecompress(&scratch, COMPUTE_SHADER_DXIL[numComputeShadersInited]);
+		if (errorStatus != FFX_CACAO_STATUS_OK)
+		{
+			goto error_init_compute_shader;
+		}
+
+		D3D12_SHADER_BYTECODE shaderByteCode = {};
+		shaderByteCode.pShaderBytecode = scratch.data;
+		shaderByteCode.BytecodeLength = COMPUTE_SHADER_DXIL[numComputeShadersInited].module[2];
+
+		D3D12_COMPUTE_PIPELINE_STATE_DESC descPso = {};
+		descPso.CS = shaderByteCode;
+		descPso.Flags = D3D12_PIPELINE_STATE_FLAG_NONE;
+		descPso.pRootSignature = context->csRootSignatures[numComputeShadersInited];
+		descPso.NodeMask = 0;
+
+		HRESULT hr = device->CreateComputePipelineState(&descPso, IID_PPV_ARGS(&context->computeShader[numComputeShadersInited]));
+		if (FAILED(hr))
+		{
+			errorStatus = hresultToFFX_CACAO_Status(hr);
+			goto error_init_compute_shader;
+		}
+
+		SetName(context->computeShader[numComputeShadersInited], metaData.objectName);
+	}
+
+	shaderScratchDestroy(&scratch);
+	return FFX_CACAO_STATUS_OK;
+
+error_init_compute_shader:
+	shaderScratchDestroy(&scratch);
+	for (uint32_t i = 0; i < numComputeShadersInited; ++i)
+	{
+		context->computeShader[i]->Release();
+	}
+
+error_init_root_signature:
+	for (uint32_t i = 0; i < numRootSignaturesInited; ++i)
+	{
+		context->csRootSignatures[i]->Release();
+	}
+
+error_create_load_counter_texture:
+
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	gpuTimerDestroy(&context->gpuTimer);
+error_create_gpu_timer:
+#endif
+	constantBufferRingDestroy(&context->constantBufferRing);
+error_create_constant_buffer_ring:
+	cbvSrvUavHeapDestroy(&context->cbvSrvUavHeap);
+error_create_cbv_srv_uav_heap:
+
+	return errorStatus;
+}
+
+FFX_CACAO_Status FFX_CACAO_D3D12DestroyContext(FFX_CACAO_D3D12Context* context)
+{
+	if (context == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedD3D12ContextPointer(context);
+
+	for (uint32_t i = 0; i < NUM_COMPUTE_SHADERS; ++i)
+	{
+		context->computeShader[i]->Release();
+	}
+
+	for (uint32_t i = 0; i < NUM_COMPUTE_SHADERS; ++i)
+	{
+		context->csRootSignatures[i]->Release();
+	}
+
+	textureDestroy(&context->loadCounter);
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	gpuTimerDestroy(&context->gpuTimer);
+#endif
+	constantBufferRingDestroy(&context->constantBufferRing);
+	cbvSrvUavHeapDestroy(&context->cbvSrvUavHeap);
+
+	return FFX_CACAO_STATUS_OK;
+}
+
+FFX_CACAO_Status FFX_CACAO_D3D12InitScreenSizeDependentResources(FFX_CACAO_D3D12Context* context, const FFX_CACAO_D3D12ScreenSizeInfo* info)
+{
+	if (context == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if (info == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedD3D12ContextPointer(context);
+
+	uint32_t numTexturesInited = 0;
+	uint32_t numInputBindingsInited = 0;
+	uint32_t numOutputBindingsInited = 0;
+
+	FFX_CACAO_Bool useDownsampledSsao = info->useDownsampledSsao;
+	context->useDownsampledSsao = useDownsampledSsao;
+	FFX_CACAO_Status errorStatus;
+
+	ID3D12Device *device = context->device;
+
+	FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
+	FFX_CACAO_UpdateBufferSizeInfo(info->width, info->height, useDownsampledSsao, bsi);
+	constantsCacheInvalidate(&context->constantsCache, CONSTANTS_DIRTY_SIZE);
+
+	// =======================================
+	// Init debug SRVs/UAVs
+
+	context->outputResource = info->outputResource;
+
+	// =======================================
+	// Init textures
+
+	for (; numTexturesInited < NUM_TEXTURES; ++numTexturesInited)
+	{
+		TextureMetaData metaData = TEXTURE_META_DATA[numTexturesInited];
+
+		DXGI_FORMAT format = TEXTURE_FORMAT_LOOKUP_D3D12[metaData.format];
+		uint32_t width = *(uint32_t*)(((uint8_t*)bsi) + metaData.widthOffset);
+		uint32_t height = *(uint32_t*)(((uint8_t*)bsi) + metaData.heightOffset);
+
+		D3D12_HEAP_PROPERTIES heapProperties = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		D3D12_RESOURCE_DESC desc = CD3DX12_RESOURCE_DESC::Tex2D(format, width, height, metaData.arraySize, metaData.numMips, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+
+		HRESULT hr = device->CreateCommittedResource(&heapProperties, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, NULL, IID_PPV_ARGS(&context->textures[numTexturesInited]));
+
+		if (FAILED(hr))
+		{
+			errorStatus = hresultToFFX_CACAO_Status(hr);
+			goto error_init_textures;
+		}
+
+		SetName(context->textures[numTexturesInited], metaData.name);
+	}
+
+	for (; numInputBindingsInited < NUM_INPUT_DESCRIPTOR_BINDINGS; ++numInputBindingsInited)
+	{
+		InputDescriptorBindingMetaData metaData = INPUT_DESCRIPTOR_BINDING_META_DATA[numInputBindingsInited];
+		DescriptorSetID ds = metaData.descriptorID;
+		ShaderResourceViewMetaData srvMetaData = SRV_META_DATA[metaData.srvID];
+
+		D3D12_CPU_DESCRIPTOR_HANDLE descriptor = context->inputDescriptors[ds].cpuDescriptor;
+		descriptor.ptr += metaData.bindingNumber * context->inputDescriptors[ds].descriptorSize;
+
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = TEXTURE_FORMAT_LOOKUP_D3D12[TEXTURE_META_DATA[srvMetaData.texture].format];
+		srvDesc.ViewDimension = VIEW_TYPE_LOOKUP_D3D12_SRV[srvMetaData.viewType];
+		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		switch (srvDesc.ViewDimension)
+		{
+		case D3D12_SRV_DIMENSION_TEXTURE2D:
+			srvDesc.Texture2D.MostDetailedMip = srvMetaData.mostDetailedMip;
+			srvDesc.Texture2D.MipLevels = srvMetaData.mipLevels;
+			break;
+		case D3D12_SRV_DIMENSION_TEXTURE2DARRAY:
+			srvDesc.Texture2DArray.MostDetailedMip = srvMetaData.mostDetailedMip;
+			srvDesc.Texture2DArray.MipLevels = srvMetaData.mipLevels;
+			srvDesc.Texture2DArray.FirstArraySlice = srvMetaData.firstArraySlice;
+			srvDesc.Texture2DArray.ArraySize = srvMetaData.arraySize;
+			break;
+		default:
+			FFX_CACAO_ASSERT(0);
+			break;
+		}
+		device->CreateShaderResourceView(context->textures[srvMetaData.texture], &srvDesc, descriptor);
+	}
+
+	for (; numOutputBindingsInited < NUM_OUTPUT_DESCRIPTOR_BINDINGS; ++numOutputBindingsInited)
+	{
+		OutputDescriptorBindingMetaData metaData = OUTPUT_DESCRIPTOR_BINDING_META_DATA[numOutputBindingsInited];
+		DescriptorSetID ds = metaData.descriptorID;
+		UnorderedAccessViewMetaData uavMetaData = UAV_META_DATA[metaData.uavID];
+
+		D3D12_CPU_DESCRIPTOR_HANDLE descriptor = context->outputDescriptors[ds].cpuDescriptor;
+		descriptor.ptr += metaData.bindingNumber * context->outputDescriptors[ds].descriptorSize;
+
+		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+		uavDesc.Format = TEXTURE_FORMAT_LOOKUP_D3D12[TEXTURE_META_DATA[uavMetaData.textureID].format];
+		uavDesc.ViewDimension = VIEW_TYPE_LOOKUP_D3D12_UAV[uavMetaData.viewType];
+		switch (uavDesc.ViewDimension)
+		{
+		case D3D12_UAV_DIMENSION_TEXTURE2D:
+			uavDesc.Texture2D.MipSlice = uavMetaData.mostDetailedMip;
+			break;
+		case D3D12_UAV_DIMENSION_TEXTURE2DARRAY:
+			uavDesc.Texture2DArray.MipSlice = uavMetaData.mostDetailedMip;
+			uavDesc.Texture2DArray.FirstArraySlice = uavMetaData.firstArraySlice;
+			uavDesc.Texture2DArray.ArraySize = uavMetaData.arraySize;
+			break;
+		default:
+			FFX_CACAO_ASSERT(0);
+			break;
+		}
+		device->CreateUnorderedAccessView(context->textures[uavMetaData.textureID], NULL, &uavDesc, descriptor);
+	}
+
+	// misc inputs
+	{
+		D3D12_CPU_DESCRIPTOR_HANDLE descriptor;
+		
+		// depth buffer input
+		descriptor = context->inputDescriptors[DS_PREPARE_DEPTHS].cpuDescriptor;
+		device->CreateShaderResourceView(info->depthBufferResource, &info->depthBufferSrvDesc, descriptor);
+
+		descriptor = context->inputDescriptors[DS_PREPARE_DEPTHS_MIPS].cpuDescriptor;
+		device->CreateShaderResourceView(info->depthBufferResource, &info->depthBufferSrvDesc, descriptor);
+
+		descriptor = context->inputDescriptors[DS_PREPARE_NORMALS].cpuDescriptor;
+		device->CreateShaderResourceView(info->depthBufferResource, &info->depthBufferSrvDesc, descriptor);
+
+		descriptor = context->inputDescriptors[DS_BILATERAL_UPSAMPLE_PING].cpuDescriptor;
+		descriptor.ptr += context->cbvSrvUavHeap.descriptorElementSize;
+		device->CreateShaderResourceView(info->depthBufferResource, &info->depthBufferSrvDesc, descriptor);
+
+		descriptor = context->inputDescriptors[DS_BILATERAL_UPSAMPLE_PONG].cpuDescriptor;
+		descriptor.ptr += context->cbvSrvUavHeap.descriptorElementSize;
+		device->CreateShaderResourceView(info->depthBufferResource, &info->depthBufferSrvDesc, descriptor);
+
+		// normal buffer input
+		if (info->normalBufferResource)
+		{
+			descriptor = context->inputDescriptors[DS_PREPARE_NORMALS_FROM_INPUT_NORMALS].cpuDescriptor;
+			device->CreateShaderResourceView(info->normalBufferResource, &info->normalBufferSrvDesc, descriptor);
+		}
+
+		// ssao buffer output
+		descriptor = context->outputDescriptors[DS_BILATERAL_UPSAMPLE_PING].cpuDescriptor;
+		device->CreateUnorderedAccessView(info->outputResource, NULL, &info->outputUavDesc, descriptor);
+
+		descriptor = context->outputDescriptors[DS_BILATERAL_UPSAMPLE_PONG].cpuDescriptor;
+		device->CreateUnorderedAccessView(info->outputResource, NULL, &info->outputUavDesc, descriptor);
+
+		descriptor = context->outputDescriptors[DS_APPLY_PING].cpuDescriptor;
+		device->CreateUnorderedAccessView(info->outputResource, NULL, &info->outputUavDesc, descriptor);
+
+		descriptor = context->outputDescriptors[DS_APPLY_PONG].cpuDescriptor;
+		device->CreateUnorderedAccessView(info->outputResource, NULL, &info->outputUavDesc, descriptor);
+
+		// load counter input
+		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+		srvDesc.Format = context->loadCounter.format;
+		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE1D;
+		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		srvDesc.Texture1D.MostDetailedMip = 0;
+		srvDesc.Texture1D.MipLevels = 1;
+		
+		for (uint32_t pass = 0; pass < 4; ++pass)
+		{
+			descriptor = context->inputDescriptors[DS_GENERATE_ADAPTIVE_0 + pass].cpuDescriptor;
+			descriptor.ptr += 2 * context->cbvSrvUavHeap.descriptorElementSize;
+			device->CreateShaderResourceView(context->loadCounter.resource, &srvDesc, descriptor);
+		}
+
+		// load counter output
+		D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+		uavDesc.Format = context->loadCounter.format;
+		uavDesc.ViewDimension = D3D12_UAV_DIMENSION_TEXTURE1D;
+		uavDesc.Texture1D.MipSlice = 0;
+
+		descriptor = context->outputDescriptors[DS_POSTPROCESS_IMPORTANCE_MAP_B].cpuDescriptor;
+		descriptor.ptr += 1 * context->cbvSrvUavHeap.descriptorElementSize;
+		device->CreateUnorderedAccessView(context->loadCounter.resource, NULL, &uavDesc, descriptor);
+
+		descriptor = context->outputDescriptors[DS_CLEAR_LOAD_COUNTER].cpuDescriptor;
+		device->CreateUnorderedAccessView(context->loadCounter.resource, NULL, &uavDesc, descriptor);
+	}
+
+
+	return FFX_CACAO_STATUS_OK;
+
+error_init_textures:
+	for (uint32_t i = 0; i < numTexturesInited; ++i)
+	{
+		context->textures[i]->Release();
+	}
+
+	return errorStatus;
+}
+
+FFX_CACAO_Status FFX_CACAO_D3D12DestroyScreenSizeDependentResources(FFX_CACAO_D3D12Context* context)
+{
+	if (context == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedD3D12ContextPointer(context);
+
+	for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+	{
+		context->textures[i]->Release();
+	}
+
+	return FFX_CACAO_STATUS_OK;
+}
+
+FFX_CACAO_Status FFX_CACAO_D3D12UpdateSettings(FFX_CACAO_D3D12Context* context, const FFX_CACAO_Settings* settings)
+{
+	if (context == NULL || settings == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedD3D12ContextPointer(context);
+
+	if (memcmp(&context->settings, settings, sizeof(*settings)) != 0)
+	{
+		memcpy(&context->settings, settings, sizeof(*settings));
+		constantsCacheInvalidate(&context->constantsCache, CONSTANTS_DIRTY_SETTINGS);
+	}
+
+	return FFX_CACAO_STATUS_OK;
+}
+
+static inline void computeShaderDraw(FFX_CACAO_D3D12Context* context, ComputeShaderID computeShaderID, ID3D12GraphicsCommandList* commandList, D3D12_GPU_VIRTUAL_ADDRESS constantBuffer, DescriptorSetID descriptorSetID, uint32_t width, uint32_t height, uint32_t depth)
+{
+	FFX_CACAO_ASSERT(computeShaderID);
+	FFX_CACAO_ASSERT(commandList);
+
+	DescriptorSetMetaData dsMetaData = DESCRIPTOR_SET_META_DATA[descriptorSetID];
+	DescriptorSetLayoutMetaData dslMetaData = DESCRIPTOR_SET_LAYOUT_META_DATA[dsMetaData.descriptorSetLayoutID];
+
+	commandList->SetComputeRootSignature(context->csRootSignatures[computeShaderID]);
+
+	int params = 0;
+	commandList->SetComputeRootConstantBufferView(params++, constantBuffer);
+	if (dslMetaData.numOutputs)
+	{
+		commandList->SetComputeRootDescriptorTable(params++, context->outputDescriptors[descriptorSetID].gpuDescriptor);
+	}
+	if (dslMetaData.numInputs)
+	{
+		commandList->SetComputeRootDescriptorTable(params++, context->inputDescriptors[descriptorSetID].gpuDescriptor);
+	}
+
+	commandList->SetPipelineState(context->computeShader[computeShaderID]);
+	commandList->Dispatch(width, height, depth);
+}
+
+FFX_CACAO_Status FFX_CACAO_D3D12Draw(FFX_CACAO_D3D12Context* context, ID3D12GraphicsCommandList* commandList, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView)
+{
+	if (context == NULL || commandList == NULL || proj == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedD3D12ContextPointer(context);
+
+	
+#ifdef FFX_CACAO_ENABLE_PROFILING
+#define GET_TIMESTAMP(name) gpuTimerGetTimestamp(&context->gpuTimer, commandList, TIMESTAMP_##name)
+#else
+#define GET_TIMESTAMP(name)
+#endif
+	FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
+
+
+	USER_MARKER("FidelityFX CACAO");
+
+	constantBufferRingStartFrame(&context->constantBufferRing);
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	gpuTimerStartFrame(&context->gpuTimer);
+#endif
+
+	GET_TIMESTAMP(BEGIN);
+
+	// set the descriptor heaps
+	{
+		ID3D12DescriptorHeap *descriptorHeaps[] = { context->cbvSrvUavHeap.heap };
+		commandList->SetDescriptorHeaps(FFX_CACAO_ARRAY_SIZE(descriptorHeaps), descriptorHeaps);
+	}
+
+	// clear load counter
+	{
+		UINT clearValue[] = { 0, 0, 0, 0 };
+		commandList->ClearUnorderedAccessViewUint(context->loadCounterUav.gpuDescriptor, context->loadCounterUav.cpuVisibleCpuDescriptor, context->loadCounter.resource, clearValue, 0, NULL);
+	}
+
+	// move this to initialisation
+	D3D12_GPU_VIRTUAL_ADDRESS cbCACAOHandle;
+	FFX_CACAO_Constants *pCACAOConsts;
+	D3D12_GPU_VIRTUAL_ADDRESS cbCACAOPerPassHandle[4];
+	FFX_CACAO_Constants *pPerPassConsts[4];
+
+	// upload constant buffers
+	{
+		ConstantsCache *constantsCache = &context->constantsCache;
+		constantsCacheUpdate(constantsCache, &context->settings, bsi, NULL, NULL, proj, normalsToView);
+
+		// the pass independent constants are those of any pass
+		constantBufferRingAlloc(&context->constantBufferRing, sizeof(*pCACAOConsts), (void**)&pCACAOConsts, &cbCACAOHandle);
+		memcpy(pCACAOConsts, &constantsCache->constants[0], sizeof(*pCACAOConsts));
+
+		for (int i = 0; i < 4; ++i)
+		{
+			constantBufferRingAlloc(&context->constantBufferRing, sizeof(*pPerPassConsts[0]), (void**)&pPerPassConsts[i], &cbCACAOPerPassHandle[i]);
+			memcpy(pPerPassConsts[i], &constantsCache->constants[i], sizeof(*pPerPassConsts[i]));
+		}
+	}
+
+	// prepare depths, normals and mips
+	{
+		USER_MARKER("Prepare downsampled depths, normals and mips");
+
+
+		switch (context->settings.qualityLevel)
+		{
+		case FFX_CACAO_QUALITY_LOWEST: {
+			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HALF_WIDTH, bsi->deinterleavedDepthBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HALF_HEIGHT, bsi->deinterleavedDepthBufferHeight);
+			ComputeShaderID prepareDepthsHalf = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS_HALF : CS_PREPARE_NATIVE_DEPTHS_HALF;
+			computeShaderDraw(context, prepareDepthsHalf, commandList, cbCACAOHandle, DS_PREPARE_DEPTHS, dispatchWidth, dispatchHeight, 1);
+			break;
+		}
+		case FFX_CACAO_QUALITY_LOW: {
+			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_WIDTH, bsi->deinterleavedDepthBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HEIGHT, bsi->deinterleavedDepthBufferHeight);
+			ComputeShaderID prepareDepths = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS : CS_PREPARE_NATIVE_DEPTHS;
+			computeShaderDraw(context, prepareDepths, commandList, cbCACAOHandle, DS_PREPARE_DEPTHS, dispatchWidth, dispatchHeight, 1);
+			break;
+		}
+		default: {
+			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH, bsi->deinterleavedDepthBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT, bsi->deinterleavedDepthBufferHeight);
+			ComputeShaderID prepareDepthsAndMips = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS_AND_MIPS : CS_PREPARE_NATIVE_DEPTHS_AND_MIPS;
+			computeShaderDraw(context, prepareDepthsAndMips, commandList, cbCACAOHandle, DS_PREPARE_DEPTHS_MIPS, dispatchWidth, dispatchHeight, 1);
+			break;
+		}
+		}
+
+		if (context->settings.generateNormals)
+		{
+			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_NORMALS_WIDTH, bsi->ssaoBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_NORMALS_HEIGHT, bsi->ssaoBufferHeight);
+			ComputeShaderID prepareNormals = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_NORMALS : CS_PREPARE_NATIVE_NORMALS;
+			computeShaderDraw(context, prepareNormals, commandList, cbCACAOHandle, DS_PREPARE_NORMALS, dispatchWidth, dispatchHeight, 1);
+		}
+		else
+		{
+			uint32_t dispatchWidth = dispatchSize(PREPARE_NORMALS_FROM_INPUT_NORMALS_WIDTH, bsi->ssaoBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(PREPARE_NORMALS_FROM_INPUT_NORMALS_HEIGHT, bsi->ssaoBufferHeight);
+			ComputeShaderID prepareNormalsFromInputNormals = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_NORMALS_FROM_INPUT_NORMALS : CS_PREPARE_NATIVE_NORMALS_FROM_INPUT_NORMALS;
+			computeShaderDraw(context, prepareNormalsFromInputNormals, commandList, cbCACAOHandle, DS_PREPARE_NORMALS_FROM_INPUT_NORMALS, dispatchWidth, dispatchHeight, 1);
+		}
+
+		GET_TIMESTAMP(PREPARE);
+	}
+
+	// deinterleaved depths and normals are now read only resources, also used in the next stage
+	{
+		D3D12_RESOURCE_BARRIER resourceBarriers[] = {
+			CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_DEINTERLEAVED_DEPTHS], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
+			CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_DEINTERLEAVED_NORMALS], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
+		};
+		commandList->ResourceBarrier(FFX_CACAO_ARRAY_SIZE(resourceBarriers), resourceBarriers);
+	}
+
+	// base pass for highest quality setting
+	if (context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST)
+	{
+		USER_MARKER("Generate High Quality Base Pass");
+
+		// SSAO
+		{
+			USER_MARKER("SSAO");
+
+			for (int pass = 0; pass < 4; ++pass)
+			{
+				uint32_t dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_WIDTH, bsi->ssaoBufferWidth);
+				uint32_t dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_HEIGHT, bsi->ssaoBufferHeight);
+				DescriptorSetID ds = (DescriptorSetID)(DS_GENERATE_ADAPTIVE_BASE_0 + pass);
+				computeShaderDraw(context, CS_GENERATE_Q3_BASE, commandList, cbCACAOPerPassHandle[pass], ds, dispatchWidth, dispatchHeight, 1);
+			}
+			GET_TIMESTAMP(BASE_SSAO_PASS);
+		}
+
+		// results written by base pass are now a reaad only resource, used in next stage
+		commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PONG], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+
+		// generate importance map
+		{
+			USER_MARKER("Importance Map");
+
+			CD3DX12_RESOURCE_BARRIER barriers[2];
+			UINT barrierCount;
+
+			uint32_t dispatchWidth = dispatchSize(IMPORTANCE_MAP_WIDTH, bsi->importanceMapWidth);
+			uint32_t dispatchHeight = dispatchSize(IMPORTANCE_MAP_HEIGHT, bsi->importanceMapHeight);
+
+			computeShaderDraw(context, CS_GENERATE_IMPORTANCE_MAP, commandList, cbCACAOHandle, DS_GENERATE_IMPORTANCE_MAP, dispatchWidth, dispatchHeight, 1);
+
+			barrierCount = 0;
+			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+			commandList->ResourceBarrier(barrierCount, barriers);
+
+			computeShaderDraw(context, CS_POSTPROCESS_IMPORTANCE_MAP_A, commandList, cbCACAOHandle, DS_POSTPROCESS_IMPORTANCE_MAP_A, dispatchWidth, dispatchHeight, 1);
+
+			barrierCount = 0;
+			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP_PONG], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+			commandList->ResourceBarrier(barrierCount, barriers);
+
+			computeShaderDraw(context, CS_POSTPROCESS_IMPORTANCE_MAP_B, commandList, cbCACAOHandle, DS_POSTPROCESS_IMPORTANCE_MAP_B, dispatchWidth, dispatchHeight, 1);
+
+			barrierCount = 0;
+			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+			barriers[barrierCount++] = CD3DX12_RESOURCE_BARRIER::Transition(context->loadCounter.resource, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+			commandList->ResourceBarrier(barrierCount, barriers);
+
+			GET_TIMESTAMP(IMPORTANCE_MAP);
+		}
+	}
+
+	int blurPassCount = context->settings.blurPassCount;
+	blurPassCount = FFX_CACAO_CLAMP(blurPassCount, 0, MAX_BLUR_PASSES);
+	
+	// main ssao generation
+	{
+		USER_MARKER("Generate SSAO");
+
+		// ComputeShader *generate = &context->generateSSAO[FFX_CACAO_MAX(0, context->settings.qualityLevel - 1)];
+		ComputeShaderID generate = (ComputeShaderID)(CS_GENERATE_Q0 + FFX_CACAO_MAX(0, context->settings.qualityLevel - 1));
+
+		uint32_t dispatchWidth, dispatchHeight, dispatchDepth;
+
+		switch (context->settings.qualityLevel)
+		{
+		case FFX_CACAO_QUALITY_LOWEST:
+		case FFX_CACAO_QUALITY_LOW:
+		case FFX_CACAO_QUALITY_MEDIUM:
+			dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_SPARSE_WIDTH, bsi->ssaoBufferWidth);
+			dispatchWidth = (dispatchWidth + 4) / 5;
+			dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_SPARSE_HEIGHT, bsi->ssaoBufferHeight);
+			dispatchDepth = 5;
+			break;
+		case FFX_CACAO_QUALITY_HIGH:
+		case FFX_CACAO_QUALITY_HIGHEST:
+			dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_WIDTH, bsi->ssaoBufferWidth);
+			dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_HEIGHT, bsi->ssaoBufferHeight);
+			dispatchDepth = 1;
+			break;
+		}
+
+		for (int pass = 0; pass < 4; ++pass)
+		{
+			if (context->settings.qualityLevel == FFX_CACAO_QUALITY_LOWEST && (pass == 1 || pass == 2))
+			{
+				continue;
+			}
+
+			DescriptorSetID ds = context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST ? (DescriptorSetID)(DS_GENERATE_ADAPTIVE_0 + pass) : (DescriptorSetID)(DS_GENERATE_0 + pass);
+			computeShaderDraw(context, generate, commandList, cbCACAOPerPassHandle[pass], ds, dispatchWidth, dispatchHeight, dispatchDepth);
+		}
+
+		GET_TIMESTAMP(GENERATE_SSAO);
+	}
+	
+	// de-interleaved blur
+	if (blurPassCount)
+	{
+		// only need to transition pong to writable if we didn't already use it in the base pass
+		CD3DX12_RESOURCE_BARRIER barriers[] = {
+			CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PING], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE),
+			CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PONG], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+		};
+		commandList->ResourceBarrier(context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST ? 2 : 1, barriers);
+
+		USER_MARKER("Deinterleaved blur");
+
+		for (int pass = 0; pass < 4; ++pass)
+		{
+			if (context->settings.qualityLevel == FFX_CACAO_QUALITY_LOWEST && (pass == 1 || pass == 2))
+			{
+				continue;
+			}
+
+			uint32_t w = 4 * FFX_CACAO_BLUR_WIDTH - 2 * blurPassCount;
+			uint32_t h = 3 * FFX_CACAO_BLUR_HEIGHT - 2 * blurPassCount;
+			uint32_t blurPassIndex = blurPassCount - 1;
+			uint32_t dispatchWidth = dispatchSize(w, bsi->ssaoBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(h, bsi->ssaoBufferHeight);
+			ComputeShaderID edgeSensitiveBlur = (ComputeShaderID)(CS_EDGE_SENSITIVE_BLUR_1 + blurPassCount - 1);
+			DescriptorSetID ds = (DescriptorSetID)(DS_EDGE_SENSITIVE_BLUR_0 + pass);
+			computeShaderDraw(context, edgeSensitiveBlur, commandList, cbCACAOPerPassHandle[pass], ds, dispatchWidth, dispatchHeight, 1);
+		}
+
+		GET_TIMESTAMP(EDGE_SENSITIVE_BLUR);
+
+		commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PONG], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+	}
+	else
+	{
+		commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PING], D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+	}
+
+
+	if (context->useDownsampledSsao)
+	{
+		USER_MARKER("Upscale");
+
+		DescriptorSetID ds = blurPassCount ? DS_BILATERAL_UPSAMPLE_PONG : DS_BILATERAL_UPSAMPLE_PING;
+		ComputeShaderID upscaler;
+		switch (context->settings.qualityLevel)
+		{
+		case FFX_CACAO_QUALITY_LOWEST:
+			upscaler = CS_UPSCALE_BILATERAL_5X5_HALF;
+			break;
+		case FFX_CACAO_QUALITY_LOW:
+		case FFX_CACAO_QUALITY_MEDIUM:
+			upscaler = CS_UPSCALE_BILATERAL_5X5_NON_SMART;
+			break;
+		case FFX_CACAO_QUALITY_HIGH:
+		case FFX_CACAO_QUALITY_HIGHEST:
+			upscaler = CS_UPSCALE_BILATERAL_5X5_SMART;
+			break;
+		}
+		uint32_t dispatchWidth = dispatchSize(2 * FFX_CACAO_BILATERAL_UPSCALE_WIDTH, bsi->inputOutputBufferWidth);
+		uint32_t dispatchHeight = dispatchSize(2 * FFX_CACAO_BILATERAL_UPSCALE_HEIGHT, bsi->inputOutputBufferHeight);
+		computeShaderDraw(context, upscaler, commandList, cbCACAOHandle, ds, dispatchWidth, dispatchHeight, 1);
+
+		GET_TIMESTAMP(BILATERAL_UPSAMPLE);
+	}
+	else
+	{
+		USER_MARKER("Create Output");
+		DescriptorSetID ds = blurPassCount ? DS_APPLY_PONG : DS_APPLY_PING;
+		uint32_t dispatchWidth = dispatchSize(FFX_CACAO_APPLY_WIDTH, bsi->inputOutputBufferWidth);
+		uint32_t dispatchHeight = dispatchSize(FFX_CACAO_APPLY_HEIGHT, bsi->inputOutputBufferHeight);
+		switch (context->settings.qualityLevel)
+		{
+		case FFX_CACAO_QUALITY_LOWEST:
+			computeShaderDraw(context, CS_NON_SMART_HALF_APPLY, commandList, cbCACAOHandle, ds, dispatchWidth, dispatchHeight, 1);
+			break;
+		case FFX_CACAO_QUALITY_LOW:
+			computeShaderDraw(context, CS_NON_SMART_APPLY, commandList, cbCACAOHandle, ds, dispatchWidth, dispatchHeight, 1);
+			break;
+		default:
+			computeShaderDraw(context, CS_APPLY, commandList, cbCACAOHandle, ds, dispatchWidth, dispatchHeight, 1);
+			break;
+		}
+		GET_TIMESTAMP(APPLY);
+	}
+
+	// end frame resource barrier
+	{
+		uint32_t numBarriers = 0;
+		D3D12_RESOURCE_BARRIER resourceBarriers[10] = {};
+		resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_DEINTERLEAVED_DEPTHS], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+		resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_DEINTERLEAVED_NORMALS], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+		resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->outputResource, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ);
+		resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PING], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+		if (context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST || blurPassCount)
+		{
+			resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_SSAO_BUFFER_PONG], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+		}
+		if (context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST)
+		{
+			resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+			resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->textures[TEXTURE_IMPORTANCE_MAP_PONG], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+			resourceBarriers[numBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(context->loadCounter.resource, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
+		}
+		commandList->ResourceBarrier(numBarriers, resourceBarriers);
+	}
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	gpuTimerEndFrame(&context->gpuTimer, commandList);
+#endif
+
+	return FFX_CACAO_STATUS_OK;
+
+#undef GET_TIMESTAMP
+}
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+FFX_CACAO_Status FFX_CACAO_D3D12GetDetailedTimings(FFX_CACAO_D3D12Context* context, FFX_CACAO_DetailedTiming* timings)
+{
+	if (context == NULL || timings == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedD3D12ContextPointer(context);
+
+	gpuTimerCollectTimings(&context->gpuTimer, timings);
+
+	return FFX_CACAO_STATUS_OK;
+}
+#endif
+#endif
+
+#ifdef FFX_CACAO_ENABLE_VULKAN
+inline static void setObjectName(VkDevice device, PFN_vkSetDebugUtilsObjectNameEXT vkSetDebugUtilsObjectName, VkObjectType type, uint64_t handle, const char* name)
+{
+	if (!vkSetDebugUtilsObjectName)
+	{
+		return;
+	}
+
+	VkDebugUtilsObjectNameInfoEXT info = {};
+	info.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+	info.pNext = NULL;
+	info.objectType = type;
+	info.objectHandle = handle;
+	info.pObjectName = name;
+
+	VkResult result = vkSetDebugUtilsObjectName(device, &info);
+	FFX_CACAO_ASSERT(result == VK_SUCCESS);
+}
+
+inline static uint32_t getBestMemoryHeapIndex(VkPhysicalDevice physicalDevice,  VkMemoryRequirements memoryRequirements, VkMemoryPropertyFlags desiredProperties)
+{
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+	uint32_t chosenMemoryTypeIndex = VK_MAX_MEMORY_TYPES;
+	for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+	{
+		uint32_t typeBit = 1 << i;
+		// can we allocate to memory of this type
+		if (memoryRequirements.memoryTypeBits & typeBit)
+		{
+			VkMemoryType currentMemoryType = memoryProperties.memoryTypes[i];
+			// do we want to allocate to memory of this type
+			if ((currentMemoryType.propertyFlags & desiredProperties) == desiredProperties)
+			{
+				chosenMemoryTypeIndex = i;
+				break;
+			}
+		}
+	}
+	return chosenMemoryTypeIndex;
+}
+
+static void freeTextureArena(FFX_CACAO_VkContext* context)
+{
+	if (context->memoryAllocator.freeMemory)
+	{
+		context->memoryAllocator.freeMemory(context->memoryAllocator.userData, context->arenaMemory, context->arenaOffset);
+	}
+	else
+	{
+		vkFreeMemory(context->device, context->arenaMemory, NULL);
+	}
+	context->arenaMemory = VK_NULL_HANDLE;
+	context->arenaOffset = 0;
+	context->arenaSize = 0;
+	context->arenaUsedSize = 0;
+}
+
+size_t FFX_CACAO_VkGetContextSize()
+{
+	return sizeof(FFX_CACAO_VkContext) + alignof(FFX_CACAO_VkContext) - 1;
+}
+
+// decompresses a module of an archive written by ffx_cacao_pack_shaders, see ffx_cacao_pack_shaders.cpp for the format
+static VkResult createPipeline(FFX_CACAO_VkDeviceObjects* objects, ComputeShaderID computeShader, ShaderScratch* scratch)
+{
+	VkDevice device = objects->device;
+	ComputeShaderMetaData csMetaData = COMPUTE_SHADER_META_DATA[computeShader];
+	VkResult result;
+
+	// the variants of the generate and blur shaders share a module, see COMPUTE_SHADERS
+	CompressedComputeShader spirv = objects->use16Bit ? COMPUTE_SHADER_SPIRV_16[computeShader] : COMPUTE_SHADER_SPIRV_32[computeShader];
+	FFX_CACAO_Status status = shaderScratchDecompress(scratch, spirv);
+	if (status != FFX_CACAO_STATUS_OK)
+	{
+		return status == FFX_CACAO_STATUS_OUT_OF_MEMORY ? VK_ERROR_OUT_OF_HOST_MEMORY : VK_ERROR_INITIALIZATION_FAILED;
+	}
+	uint32_t moduleSize = spirv.module[2];
+
+	// the shader module is only needed while the pipeline is created
+	VkShaderModule shaderModule;
+	{
+		VkShaderModuleCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		info.pNext = 0;
+		info.flags = 0;
+		info.codeSize = moduleSize;
+		info.pCode = scratch->data;
+
+		result = vkCreateShaderModule(device, &info, NULL, &shaderModule);
+		if (result != VK_SUCCESS)
+		{
+			return result;
+		}
+		setObjectName(device, objects->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_SHADER_MODULE, (uint64_t)shaderModule, csMetaData.objectName);
+	}
+
+	// constant IDs absent from a module are ignored, so every specialized module is given all the constants
+	const ComputeShaderSpecialization *specialization = &COMPUTE_SHADER_SPECIALIZATION[computeShader];
+	VkSpecializationMapEntry specializationMapEntries[3];
+	specializationMapEntries[0].constantID = FFX_CACAO_SPEC_CONSTANT_BLUR_PASSES;
+	specializationMapEntries[0].offset = offsetof(ComputeShaderSpecialization, blurPasses);
+	specializationMapEntries[0].size = sizeof(specialization->blurPasses);
+	specializationMapEntries[1].constantID = FFX_CACAO_SPEC_CONSTANT_QUALITY_LEVEL;
+	specializationMapEntries[1].offset = offsetof(ComputeShaderSpecialization, qualityLevel);
+	specializationMapEntries[1].size = sizeof(specialization->qualityLevel);
+	specializationMapEntries[2].constantID = FFX_CACAO_SPEC_CONSTANT_ADAPTIVE_BASE;
+	specializationMapEntries[2].offset = offsetof(ComputeShaderSpecialization, adaptiveBase);
+	specializationMapEntries[2].size = sizeof(specialization->adaptiveBase);
+
+	VkSpecializationInfo specializationInfo = {};
+	specializationInfo.mapEntryCount = FFX_CACAO_ARRAY_SIZE(specializationMapEntries);
+	specializationInfo.pMapEntries = specializationMapEntries;
+	specializationInfo.dataSize = sizeof(*specialization);
+	specializationInfo.pData = specialization;
+
+	VkPipelineShaderStageCreateInfo stageInfo = {};
+	stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stageInfo.pNext = NULL;
+	stageInfo.flags = 0;
+	stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	stageInfo.module = shaderModule;
+	stageInfo.pName = COMPUTE_SHADER_SPIRV_ENTRY_POINT[computeShader];
+	stageInfo.pSpecializationInfo = specialization->specialized ? &specializationInfo : NULL;
+
+	VkComputePipelineCreateInfo info = {};
+	info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	info.pNext = NULL;
+	info.flags = 0;
+	info.stage = stageInfo;
+	info.layout = objects->pipelineLayouts[csMetaData.descriptorSetLayoutID];
+	info.basePipelineHandle = VK_NULL_HANDLE;
+	info.basePipelineIndex = 0;
+
+	VkPipeline pipeline;
+	result = vkCreateComputePipelines(device, objects->pipelineCache, 1, &info, NULL, &pipeline);
+	vkDestroyShaderModule(device, shaderModule, NULL);
+	if (result != VK_SUCCESS)
+	{
+		return result;
+	}
+	setObjectName(device, objects->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_PIPELINE, (uint64_t)pipeline, csMetaData.objectName);
+
+	objects->computePipelines[computeShader] = pipeline;
+	return VK_SUCCESS;
+}
+
+// creates a pipeline claimed by the calling thread, which has set its state to PIPELINE_STATE_CREATING
+static VkResult createClaimedPipeline(FFX_CACAO_VkDeviceObjects* objects, ComputeShaderID computeShader, ShaderScratch* scratch)
+{
+	VkResult result = createPipeline(objects, computeShader, scratch);
+
+	std::lock_guard<std::mutex> lock(objects->pipelineMutex);
+	objects->pipelineStates[computeShader] = result == VK_SUCCESS ? PIPELINE_STATE_READY : PIPELINE_STATE_FAILED;
+	objects->pipelineCondition.notify_all();
+	return result;
+}
+
+static void pipelineWorker(FFX_CACAO_VkDeviceObjects* objects)
+{
+	ShaderScratch scratch = {};
+	std::unique_lock<std::mutex> lock(objects->pipelineMutex);
+	for (;;)
+	{
+		objects->pipelineCondition.wait(lock, [objects] { return objects->stopPipelineWorkers || objects->numQueuedPipelines; });
+		if (objects->stopPipelineWorkers)
+		{
+			shaderScratchDestroy(&scratch);
+			return;
+		}
+
+		for (uint32_t i = 0; i < NUM_COMPUTE_SHADERS; ++i)
+		{
+			if (objects->pipelineStates[i] == PIPELINE_STATE_QUEUED)
+			{
+				objects->pipelineStates[i] = PIPELINE_STATE_CREATING;
+				--objects->numQueuedPipelines;
+				lock.unlock();
+				createClaimedPipeline(objects, (ComputeShaderID)i, &scratch);
+				lock.lock();
+				break;
+			}
+		}
+	}
+}
+
+// queues the pipelines which are not yet created for the worker threads, starting them if need be
+static void queuePipelines(FFX_CACAO_VkDeviceObjects* objects, const ComputeShaderID* computeShaders, uint32_t numComputeShaders)
+{
+	std::lock_guard<std::mutex> lock(objects->pipelineMutex);
+	for (uint32_t i = 0; i < numComputeShaders; ++i)
+	{
+		if (objects->pipelineStates[computeShaders[i]] == PIPELINE_STATE_NONE)
+		{
+			objects->pipelineStates[computeShaders[i]] = PIPELINE_STATE_QUEUED;
+			++objects->numQueuedPipelines;
+		}
+	}
+
+	if (objects->numQueuedPipelines && objects->numPipelineWorkers == 0)
+	{
+		// leave a core for the thread calling into FFX CACAO, which creates the pipelines it needs itself
+		uint32_t numWorkers = std::thread::hardware_concurrency();
+		numWorkers = FFX_CACAO_CLAMP(numWorkers, 2, MAX_PIPELINE_WORKERS + 1) - 1;
+		for (uint32_t i = 0; i < numWorkers; ++i)
+		{
+			objects->pipelineWorkers[i] = std::thread(pipelineWorker, objects);
+		}
+		objects->numPipelineWorkers = numWorkers;
+	}
+	objects->pipelineCondition.notify_all();
+}
+
+// makes sure the given pipelines are created, creating those not yet started on the calling thread and waiting for those being created by a worker
+static FFX_CACAO_Status getPipelines(FFX_CACAO_VkDeviceObjects* objects, const ComputeShaderID* computeShaders, uint32_t numComputeShaders)
+{
+	FFX_CACAO_Status status = FFX_CACAO_STATUS_OK;
+	ShaderScratch scratch = {};
+	for (uint32_t i = 0; i < numComputeShaders && status == FFX_CACAO_STATUS_OK; ++i)
+	{
+		ComputeShaderID computeShader = computeShaders[i];
+		if (objects->pipelineStates[computeShader] == PIPELINE_STATE_READY)
+		{
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(objects->pipelineMutex);
+		objects->pipelineCondition.wait(lock, [objects, computeShader] { return objects->pipelineStates[computeShader] != PIPELINE_STATE_CREATING; });
+		switch (objects->pipelineStates[computeShader])
+		{
+		case PIPELINE_STATE_READY:
+			break;
+		case PIPELINE_STATE_QUEUED:
+			--objects->numQueuedPipelines;
+			// fall through
+		case PIPELINE_STATE_NONE:
+			objects->pipelineStates[computeShader] = PIPELINE_STATE_CREATING;
+			lock.unlock();
+			if (createClaimedPipeline(objects, computeShader, &scratch) != VK_SUCCESS)
+			{
+				status = FFX_CACAO_STATUS_FAILED;
+			}
+			break;
+		default:
+			status = FFX_CACAO_STATUS_FAILED;
+			break;
+		}
+	}
+	shaderScratchDestroy(&scratch);
+	return status;
+}
+
+static void stopPipelineWorkers(FFX_CACAO_VkDeviceObjects* objects)
+{
+	{
+		std::lock_guard<std::mutex> lock(objects->pipelineMutex);
+		objects->stopPipelineWorkers = true;
+		objects->pipelineCondition.notify_all();
+	}
+
+	for (uint32_t i = 0; i < objects->numPipelineWorkers; ++i)
+	{
+		objects->pipelineWorkers[i].join();
+	}
+	objects->numPipelineWorkers = 0;
+	objects->stopPipelineWorkers = false;
+}
+
+static void destroyPipelines(FFX_CACAO_VkDeviceObjects* objects)
+{
+	for (uint32_t i = 0; i < NUM_COMPUTE_SHADERS; ++i)
+	{
+		if (objects->pipelineStates[i] == PIPELINE_STATE_READY)
+		{
+			vkDestroyPipeline(objects->device, objects->computePipelines[i], NULL);
+		}
+		objects->pipelineStates[i] = PIPELINE_STATE_NONE;
+	}
+	objects->numQueuedPipelines = 0;
+}
+
+static FFX_CACAO_Status initDeviceObjects(FFX_CACAO_VkDeviceObjects* objects, const FFX_CACAO_VkCreateInfo* info)
+{
+	VkDevice device = info->device;
+	VkPipelineCache pipelineCache = info->pipelineCache;
+	VkResult result;
+	FFX_CACAO_Bool use16Bit = info->flags & FFX_CACAO_VK_CREATE_USE_16_BIT ? FFX_CACAO_TRUE : FFX_CACAO_FALSE;
+	FFX_CACAO_Status errorStatus = FFX_CACAO_STATUS_FAILED;
+
+	objects->device = device;
+	objects->physicalDevice = info->physicalDevice;
+	objects->flags = info->flags;
+
+	if (info->flags & FFX_CACAO_VK_CREATE_USE_DEBUG_MARKERS)
+	{
+		objects->vkCmdDebugMarkerBegin = (PFN_vkCmdDebugMarkerBeginEXT)vkGetDeviceProcAddr(device, "vkCmdDebugMarkerBeginEXT");
+		objects->vkCmdDebugMarkerEnd = (PFN_vkCmdDebugMarkerEndEXT)vkGetDeviceProcAddr(device, "vkCmdDebugMarkerEndEXT");
+	}
+	if (info->flags & FFX_CACAO_VK_CREATE_USE_DEBUG_MARKERS)
+	{
+		objects->vkSetDebugUtilsObjectName = (PFN_vkSetDebugUtilsObjectNameEXT)vkGetDeviceProcAddr(device, "vkSetDebugUtilsObjectNameEXT");
+	}
+
+	uint32_t numSamplersInited = 0;
+	uint32_t numDescriptorSetLayoutsInited = 0;
+	uint32_t numPipelineLayoutsInited = 0;
+
+	VkSampler samplers[NUM_SAMPLERS];
+	{
+		VkSamplerCreateInfo samplerCreateInfo = {};
+		samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerCreateInfo.pNext = NULL;
+		samplerCreateInfo.flags = 0;
+		samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+		samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+		samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		samplerCreateInfo.mipLodBias = 0.0f;
+		samplerCreateInfo.anisotropyEnable = VK_FALSE;
+		samplerCreateInfo.compareEnable = VK_FALSE;
+		samplerCreateInfo.minLod = -1000.0f;
+		samplerCreateInfo.maxLod = 1000.0f;
+		samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+
+		result = vkCreateSampler(device, &samplerCreateInfo, NULL, &samplers[numSamplersInited]);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_samplers;
+		}
+		setObjectName(device, objects->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_SAMPLER, (uint64_t)samplers[numSamplersInited], "FFX_CACAO_POINT_CLAMP_SAMPLER");
+		++numSamplersInited;
+
+		samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+		samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+		samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+
+		result = vkCreateSampler(device, &samplerCreateInfo, NULL, &samplers[numSamplersInited]);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_samplers;
+		}
+		setObjectName(device, objects->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_SAMPLER, (uint64_t)samplers[numSamplersInited], "FFX_CACAO_POINT_MIRROR_SAMPLER");
+		++numSamplersInited;
+
+		samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+		samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+		samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+
+		result = vkCreateSampler(device, &samplerCreateInfo, NULL, &samplers[numSamplersInited]);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_samplers;
+		}
+		setObjectName(device, objects->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_SAMPLER, (uint64_t)samplers[numSamplersInited], "FFX_CACAO_LINEAR_CLAMP_SAMPLER");
+		++numSamplersInited;
+
+		samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+		samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+		samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+
+		result = vkCreateSampler(device, &samplerCreateInfo, NULL, &samplers[numSamplersInited]);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_samplers;
+		}
+		setObjectName(device, objects->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_SAMPLER, (uint64_t)samplers[numSamplersInited], "FFX_CACAO_VIEWSPACE_DEPTH_TAP_SAMPLER");
+		++numSamplersInited;
+
+		samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+		samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+		samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+		samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+		samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+
+		result = vkCreateSampler(device, &samplerCreateInfo, NULL, &samplers[numSamplersInited]);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_samplers;
+		}
+		setObjectName(device, objects->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_SAMPLER, (uint64_t)samplers[numSamplersInited], "FFX_CACAO_REAL_POINT_CLAMP_SAMPLER");
+		++numSamplersInited;
+
+		for (uint32_t i = 0; i < FFX_CACAO_ARRAY_SIZE(samplers); ++i)
+		{
+			objects->samplers[i] = samplers[i];
+		}
+	}
+
+	// create descriptor set layouts
+	for ( ; numDescriptorSetLayoutsInited < NUM_DESCRIPTOR_SET_LAYOUTS; ++numDescriptorSetLayoutsInited)
+	{
+		VkDescriptorSetLayout descriptorSetLayout;
+		DescriptorSetLayoutMetaData dslMetaData = DESCRIPTOR_SET_LAYOUT_META_DATA[numDescriptorSetLayoutsInited];
+
+		VkDescriptorSetLayoutBinding bindings[MAX_DESCRIPTOR_BINDINGS] = {};
+		uint32_t numBindings = 0;
+		for (uint32_t samplerBinding = 0; samplerBinding < FFX_CACAO_ARRAY_SIZE(samplers); ++samplerBinding)
+		{
+			VkDescriptorSetLayoutBinding binding = {};
+			binding.binding = samplerBinding;
+			binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+			binding.descriptorCount = 1;
+			binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			binding.pImmutableSamplers = &samplers[samplerBinding];
+			bindings[numBindings++] = binding;
+		}
+
+		// constant buffer binding
+		{
+			VkDescriptorSetLayoutBinding binding = {};
+			binding.binding = 10;
+			binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			binding.descriptorCount = 1;
+			binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			binding.pImmutableSamplers = NULL;
+			bindings[numBindings++] = binding;
+		}
+
+		for (uint32_t inputBinding = 0; inputBinding < dslMetaData.numInputs; ++inputBinding)
+		{
+			VkDescriptorSetLayoutBinding binding = {};
+			binding.binding = 20 + inputBinding;
+			binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			binding.descriptorCount = 1;
+			binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			binding.pImmutableSamplers = NULL;
+			bindings[numBindings++] = binding;
+		}
+
+		for (uint32_t outputBinding = 0; outputBinding < dslMetaData.numOutputs; ++outputBinding)
+		{
+			VkDescriptorSetLayoutBinding binding = {};
+			binding.binding = 30 + outputBinding; // g_PrepareDepthsOut register(u0)
+			binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			binding.descriptorCount = 1;
+			binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			binding.pImmutableSamplers = NULL;
+			bindings[numBindings++] = binding;
+		}
+
+		VkDescriptorSetLayoutCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		info.pNext = NULL;
+		info.flags = 0;
+		info.bindingCount = numBindings;
+		info.pBindings = bindings;
+
+		result = vkCreateDescriptorSetLayout(device, &info, NULL, &descriptorSetLayout);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_descriptor_set_layouts;
+		}
+		setObjectName(device, objects->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, (uint64_t)descriptorSetLayout, dslMetaData.name);
+
+		objects->descriptorSetLayouts[numDescriptorSetLayoutsInited] = descriptorSetLayout;
+	}
+
+	// create pipeline layouts
+	for ( ; numPipelineLayoutsInited < NUM_DESCRIPTOR_SET_LAYOUTS; ++numPipelineLayoutsInited)
+	{
+		VkPipelineLayout pipelineLayout;
+
+		DescriptorSetLayoutMetaData dslMetaData = DESCRIPTOR_SET_LAYOUT_META_DATA[numPipelineLayoutsInited];
+
+		VkPipelineLayoutCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		info.pNext = NULL;
+		info.flags = 0;
+		info.setLayoutCount = 1;
+		info.pSetLayouts = &objects->descriptorSetLayouts[numPipelineLayoutsInited];
+		info.pushConstantRangeCount = 0;
+		info.pPushConstantRanges = NULL;
+
+		result = vkCreatePipelineLayout(device, &info, NULL, &pipelineLayout);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_pipeline_layouts;
+		}
+		setObjectName(device, objects->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_PIPELINE_LAYOUT, (uint64_t)pipelineLayout, dslMetaData.name);
+
+		objects->pipelineLayouts[numPipelineLayoutsInited] = pipelineLayout;
+	}
+
+	objects->use16Bit = use16Bit;
+	objects->pipelineCache = pipelineCache;
+
+	// unless they are created lazily, create all pipelines up front, spread over the worker threads
+	if (!(info->flags & FFX_CACAO_VK_CREATE_LAZY_PIPELINES))
+	{
+		ComputeShaderID computeShaders[NUM_COMPUTE_SHADERS];
+		for (uint32_t i = 0; i < NUM_COMPUTE_SHADERS; ++i)
+		{
+			computeShaders[i] = (ComputeShaderID)i;
+		}
+		queuePipelines(objects, computeShaders, NUM_COMPUTE_SHADERS);
+		FFX_CACAO_Status status = getPipelines(objects, computeShaders, NUM_COMPUTE_SHADERS);
+		stopPipelineWorkers(objects);
+		if (status != FFX_CACAO_STATUS_OK)
+		{
+			goto error_init_pipelines;
+		}
+	}
+
+	return FFX_CACAO_STATUS_OK;
+
+error_init_pipelines:
+	destroyPipelines(objects);
+
+error_init_pipeline_layouts:
+	for (uint32_t i = 0; i < numPipelineLayoutsInited; ++i)
+	{
+		vkDestroyPipelineLayout(device, objects->pipelineLayouts[i], NULL);
+	}
+
+error_init_descriptor_set_layouts:
+	for (uint32_t i = 0; i < numDescriptorSetLayoutsInited; ++i)
+	{
+		vkDestroyDescriptorSetLayout(device, objects->descriptorSetLayouts[i], NULL);
+	}
+
+
+error_init_samplers:
+	for (uint32_t i = 0; i < numSamplersInited; ++i)
+	{
+		vkDestroySampler(device, samplers[i], NULL);
+	}
+
+	return errorStatus;
+}
+
+static void destroyDeviceObjects(FFX_CACAO_VkDeviceObjects* objects)
+{
+	VkDevice device = objects->device;
+
+	stopPipelineWorkers(objects);
+	destroyPipelines(objects);
+
+	for (uint32_t i = 0; i < NUM_DESCRIPTOR_SET_LAYOUTS; ++i)
+	{
+		vkDestroyPipelineLayout(device, objects->pipelineLayouts[i], NULL);
+	}
+
+	for(uint32_t i = 0; i < NUM_DESCRIPTOR_SET_LAYOUTS; ++i)
+	{
+		vkDestroyDescriptorSetLayout(device, objects->descriptorSetLayouts[i], NULL);
+	}
+
+	for (uint32_t i = 0; i < FFX_CACAO_ARRAY_SIZE(objects->samplers); ++i)
+	{
+		vkDestroySampler(device, objects->samplers[i], NULL);
+	}
+}
+
+static void releaseDeviceObjects(FFX_CACAO_VkDeviceObjects* objects)
+{
+	if (objects->refCount.fetch_sub(1) == 1)
+	{
+		destroyDeviceObjects(objects);
+		delete objects;
+	}
+}
+
+FFX_CACAO_Status FFX_CACAO_VkCreateDeviceObjects(const FFX_CACAO_VkCreateInfo* info, FFX_CACAO_VkDeviceObjects** objects)
+{
+	if (info == NULL || objects == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+
+	FFX_CACAO_VkDeviceObjects *newObjects = new (std::nothrow) FFX_CACAO_VkDeviceObjects();
+	if (newObjects == NULL)
+	{
+		return FFX_CACAO_STATUS_OUT_OF_MEMORY;
+	}
+
+	FFX_CACAO_Status status = initDeviceObjects(newObjects, info);
+	if (status != FFX_CACAO_STATUS_OK)
+	{
+		delete newObjects;
+		return status;
+	}
+
+	newObjects->refCount = 1;
+	*objects = newObjects;
+	return FFX_CACAO_STATUS_OK;
+}
+
+FFX_CACAO_Status FFX_CACAO_VkReleaseDeviceObjects(FFX_CACAO_VkDeviceObjects* objects)
+{
+	if (objects == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+
+	releaseDeviceObjects(objects);
+	return FFX_CACAO_STATUS_OK;
+}
+
+#define PIPELINE_CACHE_BLOB_MAGIC   0x4f414346 // "FCAO"
+#define PIPELINE_CACHE_BLOB_VERSION 1
+
+// prefix of a pipeline cache blob, identifying the device and driver the cache data was produced by
+typedef struct PipelineCacheBlobHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t  pipelineCacheUUID[VK_UUID_SIZE];
+	uint64_t dataSize;
+	uint64_t dataHash;                          ///< FNV-1a hash of the cache data, to reject truncated or corrupted files
+} PipelineCacheBlobHeader;
+
+static uint64_t hashPipelineCacheData(const uint8_t* data, size_t size)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < size; ++i)
+	{
+		hash = (hash ^ data[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static void initPipelineCacheBlobHeader(PipelineCacheBlobHeader* header, VkPhysicalDevice physicalDevice)
+{
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	memset(header, 0, sizeof(*header));
+	header->magic = PIPELINE_CACHE_BLOB_MAGIC;
+	header->version = PIPELINE_CACHE_BLOB_VERSION;
+	header->vendorID = properties.vendorID;
+	header->deviceID = properties.deviceID;
+	header->driverVersion = properties.driverVersion;
+	memcpy(header->pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+}
+
+FFX_CACAO_Status FFX_CACAO_VkCreatePipelineCache(VkPhysicalDevice physicalDevice, VkDevice device, const void* data, size_t dataSize, VkPipelineCache* pipelineCache, FFX_CACAO_Bool* dataUsed)
+{
+	if (pipelineCache == NULL || (data == NULL && dataSize != 0))
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+
+	// only pass on cache data produced by this device and driver, the rest is discarded and the cache starts out empty
+	PipelineCacheBlobHeader expected;
+	initPipelineCacheBlobHeader(&expected, physicalDevice);
+
+	const uint8_t *cacheData = NULL;
+	size_t cacheDataSize = 0;
+	if (dataSize >= sizeof(PipelineCacheBlobHeader))
+	{
+		PipelineCacheBlobHeader header;
+		memcpy(&header, data, sizeof(header));
+		const uint8_t *payload = (const uint8_t*)data + sizeof(header);
+		expected.dataSize = header.dataSize;
+		expected.dataHash = header.dataHash;
+		if (memcmp(&header, &expected, sizeof(header)) == 0 && header.dataSize == dataSize - sizeof(header) && hashPipelineCacheData(payload, (size_t)header.dataSize) == header.dataHash)
+		{
+			cacheData = payload;
+			cacheDataSize = (size_t)header.dataSize;
+		}
+	}
+
+	VkPipelineCacheCreateInfo info = {};
+	info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	info.pNext = NULL;
+	info.flags = 0;
+	info.initialDataSize = cacheDataSize;
+	info.pInitialData = cacheData;
+
+	VkResult result = vkCreatePipelineCache(device, &info, NULL, pipelineCache);
+	if (result != VK_SUCCESS)
+	{
+		return FFX_CACAO_STATUS_FAILED;
+	}
+
+	if (dataUsed)
+	{
+		*dataUsed = cacheData ? FFX_CACAO_TRUE : FFX_CACAO_FALSE;
+	}
+	return FFX_CACAO_STATUS_OK;
+}
+
+FFX_CACAO_Status FFX_CACAO_VkGetPipelineCacheData(VkPhysicalDevice physicalDevice, VkDevice device, VkPipelineCache pipelineCache, void* data, size_t* dataSize)
+{
+	if (dataSize == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+
+	size_t cacheDataSize = 0;
+	if (data == NULL)
+	{
+		VkResult result = vkGetPipelineCacheData(device, pipelineCache, &cacheDataSize, NULL);
+		if (result != VK_SUCCESS)
+		{
+			return FFX_CACAO_STATUS_FAILED;
+		}
+		*dataSize = sizeof(PipelineCacheBlobHeader) + cacheDataSize;
+		return FFX_CACAO_STATUS_OK;
+	}
+
+	if (*dataSize < sizeof(PipelineCacheBlobHeader))
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+
+	// VK_INCOMPLETE if the cache grew since the size was queried, the caller should query it again
+	uint8_t *payload = (uint8_t*)data + sizeof(PipelineCacheBlobHeader);
+	cacheDataSize = *dataSize - sizeof(PipelineCacheBlobHeader);
+	VkResult result = vkGetPipelineCacheData(device, pipelineCache, &cacheDataSize, payload);
+	if (result == VK_INCOMPLETE)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+	if (result != VK_SUCCESS)
+	{
+		return FFX_CACAO_STATUS_FAILED;
+	}
+
+	PipelineCacheBlobHeader header;
+	initPipelineCacheBlobHeader(&header, physicalDevice);
+	header.dataSize = cacheDataSize;
+	header.dataHash = hashPipelineCacheData(payload, cacheDataSize);
+	memcpy(data, &header, sizeof(header));
+
+	*dataSize = sizeof(PipelineCacheBlobHeader) + cacheDataSize;
+	return FFX_CACAO_STATUS_OK;
+}
+
+FFX_CACAO_Status FFX_CACAO_VkInitContext(FFX_CACAO_VkContext* context, const FFX_CACAO_VkCreateInfo* info)
+{
+	if (context == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if (info == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if (info->numFramesInFlight > FFX_CACAO_VK_MAX_FRAMES_IN_FLIGHT)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+	if (info->memoryAllocator && (info->memoryAllocator->allocateMemory == NULL || info->memoryAllocator->freeMemory == NULL))
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+	if (info->deviceObjects && info->deviceObjects->device != info->device)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+	context = getAlignedVkContextPointer(context);
+	memset(context, 0, sizeof(*context));
+	constantsCacheInit(&context->constantsCache);
+	context->numFramesInFlight = info->numFramesInFlight ? info->numFramesInFlight : DEFAULT_FRAMES_IN_FLIGHT;
+	if (info->memoryAllocator)
+	{
+		context->memoryAllocator = *info->memoryAllocator;
+	}
+
+	// share the given device objects, or create objects private to this context
+	FFX_CACAO_VkDeviceObjects *deviceObjects = info->deviceObjects;
+	if (deviceObjects)
+	{
+		deviceObjects->refCount.fetch_add(1);
+	}
+	else
+	{
+		FFX_CACAO_Status status = FFX_CACAO_VkCreateDeviceObjects(info, &deviceObjects);
+		if (status != FFX_CACAO_STATUS_OK)
+		{
+			return status;
+		}
+	}
+	context->deviceObjects = deviceObjects;
+
+	VkDevice device = deviceObjects->device;
+	VkPhysicalDevice physicalDevice = deviceObjects->physicalDevice;
+	VkResult result;
+	FFX_CACAO_Status errorStatus = FFX_CACAO_STATUS_FAILED;
+
+	context->device = device;
+	context->physicalDevice = physicalDevice;
+	context->vkCmdDebugMarkerBegin = deviceObjects->vkCmdDebugMarkerBegin;
+	context->vkCmdDebugMarkerEnd = deviceObjects->vkCmdDebugMarkerEnd;
+	context->vkSetDebugUtilsObjectName = deviceObjects->vkSetDebugUtilsObjectName;
+
+	// create descriptor pool
+	{
+		VkDescriptorPool descriptorPool;
+
+		VkDescriptorPoolSize poolSizes[4] = {};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLER;
+		poolSizes[0].descriptorCount = NUM_DESCRIPTOR_SETS * 5;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		poolSizes[1].descriptorCount = NUM_DESCRIPTOR_SETS * 7;
+		poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		poolSizes[2].descriptorCount = NUM_DESCRIPTOR_SETS * 4;
+		poolSizes[3].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		poolSizes[3].descriptorCount = NUM_DESCRIPTOR_SETS * 1;
+
+		VkDescriptorPoolCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		info.pNext = NULL;
+		info.flags = 0;
+		info.maxSets = NUM_DESCRIPTOR_SETS;
+		info.poolSizeCount = FFX_CACAO_ARRAY_SIZE(poolSizes);
+		info.pPoolSizes = poolSizes;
+
+		result = vkCreateDescriptorPool(device, &info, NULL, &descriptorPool);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_descriptor_pool;
+		}
+		setObjectName(device, context->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_DESCRIPTOR_POOL, (uint64_t)descriptorPool, "FFX_CACAO_DESCRIPTOR_POOL");
+
+		context->descriptorPool = descriptorPool;
+	}
+
+	// allocate descriptor sets, shared by all frames as the constants of a frame are selected with dynamic offsets
+	{
+		VkDescriptorSetLayout descriptorSetLayouts[NUM_DESCRIPTOR_SETS];
+		for (uint32_t i = 0; i < NUM_DESCRIPTOR_SETS; ++i) {
+			descriptorSetLayouts[i] = deviceObjects->descriptorSetLayouts[DESCRIPTOR_SET_META_DATA[i].descriptorSetLayoutID];
+		}
+
+		VkDescriptorSetAllocateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		info.pNext = NULL;
+		info.descriptorPool = context->descriptorPool;
+		info.descriptorSetCount = FFX_CACAO_ARRAY_SIZE(descriptorSetLayouts);
+		info.pSetLayouts = descriptorSetLayouts;
+
+		result = vkAllocateDescriptorSets(device, &info, context->descriptorSets);
+		if (result != VK_SUCCESS)
+		{
+			goto error_allocate_descriptor_sets;
+		}
+
+		for (uint32_t i = 0; i < NUM_DESCRIPTOR_SETS; ++i) {
+			setObjectName(device, context->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_DESCRIPTOR_SET, (uint64_t)context->descriptorSets[i], DESCRIPTOR_SET_META_DATA[i].name);
+		}
+	}
+
+	// create the constant buffer ring, persistently mapped
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+		VkDeviceSize alignment = properties.limits.minUniformBufferOffsetAlignment;
+		context->constantBufferStride = (sizeof(FFX_CACAO_Constants) + alignment - 1) / alignment * alignment;
+
+		VkBuffer buffer;
+
+		VkBufferCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		info.pNext = NULL;
+		info.flags = 0;
+		info.size = context->constantBufferStride * 4 * context->numFramesInFlight;
+		info.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+		info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		info.queueFamilyIndexCount = 0;
+		info.pQueueFamilyIndices = NULL;
+
+		result = vkCreateBuffer(device, &info, NULL, &buffer);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_constant_buffer;
+		}
+		setObjectName(device, context->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_BUFFER, (uint64_t)buffer, "FFX_CACAO_CONSTANT_BUFFER");
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetBufferMemoryRequirements(device, buffer, &memoryRequirements);
+
+		uint32_t chosenMemoryTypeIndex = getBestMemoryHeapIndex(physicalDevice, memoryRequirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		if (chosenMemoryTypeIndex == VK_MAX_MEMORY_TYPES)
+		{
+			vkDestroyBuffer(device, buffer, NULL);
+			goto error_init_constant_buffer;
+		}
+
+		VkMemoryAllocateInfo allocationInfo = {};
+		allocationInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocationInfo.pNext = NULL;
+		allocationInfo.allocationSize = memoryRequirements.size;
+		allocationInfo.memoryTypeIndex = chosenMemoryTypeIndex;
+
+		VkDeviceMemory memory;
+		result = vkAllocateMemory(device, &allocationInfo, NULL, &memory);
+		if (result != VK_SUCCESS)
+		{
+			vkDestroyBuffer(device, buffer, NULL);
+			goto error_init_constant_buffer;
+		}
+
+		void *data = NULL;
+		result = vkBindBufferMemory(device, buffer, memory, 0);
+		if (result == VK_SUCCESS)
+		{
+			result = vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+		}
+		if (result != VK_SUCCESS)
+		{
+			vkDestroyBuffer(device, buffer, NULL);
+			vkFreeMemory(device, memory, NULL);
+			goto error_init_constant_buffer;
+		}
+
+		context->constantBuffer = buffer;
+		context->constantBufferMemory = memory;
+		context->constantBufferData = (uint8_t*)data;
+	}
+
+	// point the descriptor sets at the first block of the constant buffer, the block read is selected by the dynamic offset
+	{
+		VkDescriptorBufferInfo bufferInfo = {};
+		bufferInfo.buffer = context->constantBuffer;
+		bufferInfo.offset = 0;
+		bufferInfo.range = sizeof(FFX_CACAO_Constants);
+
+		VkWriteDescriptorSet writes[NUM_DESCRIPTOR_SETS] = {};
+		for (uint32_t i = 0; i < NUM_DESCRIPTOR_SETS; ++i)
+		{
+			writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[i].pNext = NULL;
+			writes[i].dstSet = context->descriptorSets[i];
+			writes[i].dstBinding = 10;
+			writes[i].dstArrayElement = 0;
+			writes[i].descriptorCount = 1;
+			writes[i].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+			writes[i].pBufferInfo = &bufferInfo;
+		}
+
+		vkUpdateDescriptorSets(device, FFX_CACAO_ARRAY_SIZE(writes), writes, 0, NULL);
+	}
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	// create timestamp query pool
+	{
+		VkQueryPool queryPool = VK_NULL_HANDLE;
+
+		VkQueryPoolCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		info.pNext = NULL;
+		info.flags = 0;
+		info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+		info.queryCount = NUM_TIMESTAMPS * context->numFramesInFlight;
+
+		result = vkCreateQueryPool(device, &info, NULL, &queryPool);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_query_pool;
+		}
+
+		context->timestampQueryPool = queryPool;
+	}
+#endif
+
+	return FFX_CACAO_STATUS_OK;
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	vkDestroyQueryPool(device, context->timestampQueryPool, NULL);
+error_init_query_pool:
+#endif
+
+	vkUnmapMemory(device, context->constantBufferMemory);
+	vkDestroyBuffer(device, context->constantBuffer, NULL);
+	vkFreeMemory(device, context->constantBufferMemory, NULL);
+error_init_constant_buffer:
+
+error_allocate_descriptor_sets:
+	vkDestroyDescriptorPool(device, context->descriptorPool, NULL);
+error_init_descriptor_pool:
+
+	releaseDeviceObjects(context->deviceObjects);
+	context->deviceObjects = NULL;
+
+	return errorStatus;
+}
+
+FFX_CACAO_Status FFX_CACAO_VkDestroyContext(FFX_CACAO_VkContext* context)
+{
+	if (context == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedVkContextPointer(context);
+
+	VkDevice device = context->device;
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	vkDestroyQueryPool(device, context->timestampQueryPool, NULL);
+#endif
+
+	vkUnmapMemory(device, context->constantBufferMemory);
+	vkDestroyBuffer(device, context->constantBuffer, NULL);
+	vkFreeMemory(device, context->constantBufferMemory, NULL);
+
+	vkDestroyDescriptorPool(device, context->descriptorPool, NULL);
+
+	releaseDeviceObjects(context->deviceObjects);
+	context->deviceObjects = NULL;
+
+	return FFX_CACAO_STATUS_OK;
+}
+
+// creates the textures at the sizes of the current buffer size info, and the load counter, without binding memory to them
+static VkResult createTextureImages(FFX_CACAO_VkContext* context)
+{
+	VkDevice device = context->device;
+	const FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
+	VkResult result;
+	uint32_t numTextureImagesInited = 0;
+
+	// create images for textures
+	for ( ; numTextureImagesInited < NUM_TEXTURES; ++numTextureImagesInited)
+	{
+		TextureMetaData metaData = TEXTURE_META_DATA[numTextureImagesInited];
+		VkImage image = VK_NULL_HANDLE;
+
+		VkImageCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		info.pNext = NULL;
+		info.flags = 0;
+		info.imageType = VK_IMAGE_TYPE_2D;
+		info.format = TEXTURE_FORMAT_LOOKUP_VK[metaData.format];
+		info.extent.width = *(uint32_t*)((uint8_t*)bsi + metaData.widthOffset);
+		info.extent.height = *(uint32_t*)((uint8_t*)bsi + metaData.heightOffset);
+		info.extent.depth = 1;
+		info.mipLevels = metaData.numMips;
+		info.arrayLayers = metaData.arraySize;
+		info.samples = VK_SAMPLE_COUNT_1_BIT;
+		info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		info.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		info.queueFamilyIndexCount = 0;
+		info.pQueueFamilyIndices = NULL;
+		info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		result = vkCreateImage(device, &info, NULL, &image);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_texture_images;
+		}
+
+		setObjectName(device, context->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_IMAGE, (uint64_t)image, metaData.name);
+
+		context->textures[numTextureImagesInited] = image;
+	}
+
+	// create load counter VkImage
+	{
+		VkImage image = VK_NULL_HANDLE;
+
+		VkImageCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		info.pNext = NULL;
+		info.flags = 0;
+		info.imageType = VK_IMAGE_TYPE_1D;
+		info.format = VK_FORMAT_R32_UINT;
+		info.extent.width = 1;
+		info.extent.height = 1;
+		info.extent.depth = 1;
+		info.mipLevels = 1;
+		info.arrayLayers = 1;
+		info.samples = VK_SAMPLE_COUNT_1_BIT;
+		info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		info.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+		info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		info.queueFamilyIndexCount = 0;
+		info.pQueueFamilyIndices = NULL;
+		info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		result = vkCreateImage(device, &info, NULL, &image);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_texture_images;
+		}
+
+		setObjectName(device, context->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_IMAGE, (uint64_t)image, "FFX_CACAO_LOAD_COUNTER");
+
+		context->loadCounter = image;
+	}
+
+	return VK_SUCCESS;
+
+error_init_texture_images:
+	for (uint32_t i = 0; i < numTextureImagesInited; ++i)
+	{
+		vkDestroyImage(device, context->textures[i], NULL);
+	}
+	return result;
+}
+
+// places the textures and the load counter in a single arena allocation, textures with disjoint lifetimes sharing memory
+static VkResult bindTextureArena(FFX_CACAO_VkContext* context)
+{
+	VkDevice device = context->device;
+	VkPhysicalDevice physicalDevice = context->physicalDevice;
+	FFX_CACAO_Bool useDownsampledSsao = context->useDownsampledSsao;
+	VkResult result;
+
+	VkImage images[NUM_TEXTURES + 1];
+	memcpy(images, context->textures, sizeof(context->textures));
+	images[NUM_TEXTURES] = context->loadCounter;
+
+	// the load counter is live for the whole draw
+	uint32_t conflicts[NUM_TEXTURES + 1];
+	getTextureConflicts(useDownsampledSsao, context->disableHighestQuality, conflicts);
+	conflicts[NUM_TEXTURES] = ~0u;
+	for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+	{
+		conflicts[i] |= 1u << NUM_TEXTURES;
+	}
+
+	VkMemoryRequirements requirements[NUM_TEXTURES + 1];
+	VkMemoryRequirements arenaRequirements = {};
+	arenaRequirements.alignment = 1;
+	arenaRequirements.memoryTypeBits = ~0u;
+	VkDeviceSize unaliasedSize = 0;
+	uint32_t order[NUM_TEXTURES + 1];
+	for (uint32_t i = 0; i < FFX_CACAO_ARRAY_SIZE(images); ++i)
+	{
+		vkGetImageMemoryRequirements(device, images[i], &requirements[i]);
+		unaliasedSize = (unaliasedSize + requirements[i].alignment - 1) / requirements[i].alignment * requirements[i].alignment + requirements[i].size;
+		arenaRequirements.alignment = FFX_CACAO_MAX(arenaRequirements.alignment, requirements[i].alignment);
+		arenaRequirements.memoryTypeBits &= requirements[i].memoryTypeBits;
+
+		// largest images are placed first
+		uint32_t j = i;
+		for ( ; j > 0 && requirements[order[j - 1]].size < requirements[i].size; --j)
+		{
+			order[j] = order[j - 1];
+		}
+		order[j] = i;
+	}
+
+	// each image goes at the lowest offset not overlapping an already placed image it conflicts with
+	VkDeviceSize offsets[NUM_TEXTURES + 1];
+	for (uint32_t i = 0; i < FFX_CACAO_ARRAY_SIZE(images); ++i)
+	{
+		uint32_t image = order[i];
+		VkDeviceSize alignment = requirements[image].alignment;
+		VkDeviceSize size = requirements[image].size;
+		VkDeviceSize offset = 0;
+		for (uint32_t placed = 0; placed < i; )
+		{
+			uint32_t other = order[placed];
+			if ((conflicts[image] & (1u << other)) && offset < offsets[other] + requirements[other].size && offsets[other] < offset + size)
+			{
+				offset = (offsets[other] + requirements[other].size + alignment - 1) / alignment * alignment;
+				placed = 0;
+				continue;
+			}
+			++placed;
+		}
+		offsets[image] = offset;
+		arenaRequirements.size = FFX_CACAO_MAX(arenaRequirements.size, offset + size);
+	}
+	if (arenaRequirements.memoryTypeBits == 0)
+	{
+		return VK_ERROR_INITIALIZATION_FAILED;
+	}
+
+	// the arena is kept at the largest size the textures have needed, so that resizing within it allocates no memory
+	FFX_CACAO_Bool arenaFits = context->arenaMemory != VK_NULL_HANDLE
+		&& arenaRequirements.size <= context->arenaSize
+		&& (arenaRequirements.memoryTypeBits & context->arenaMemoryTypeBits) == context->arenaMemoryTypeBits
+		&& context->arenaAlignment % arenaRequirements.alignment == 0;
+	if (!arenaFits)
+	{
+		if (context->arenaMemory != VK_NULL_HANDLE)
+		{
+			freeTextureArena(context);
+		}
+
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize memoryOffset = 0;
+		uint32_t memoryTypeBits;
+		if (context->memoryAllocator.allocateMemory)
+		{
+			result = context->memoryAllocator.allocateMemory(context->memoryAllocator.userData, &arenaRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memory, &memoryOffset);
+			if (result != VK_SUCCESS)
+			{
+				return result;
+			}
+			memoryTypeBits = arenaRequirements.memoryTypeBits;
+		}
+		else
+		{
+			uint32_t chosenMemoryTypeIndex = getBestMemoryHeapIndex(physicalDevice, arenaRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+			if (chosenMemoryTypeIndex == VK_MAX_MEMORY_TYPES)
+			{
+				return VK_ERROR_INITIALIZATION_FAILED;
+			}
+
+			VkMemoryAllocateInfo allocationInfo = {};
+			allocationInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			allocationInfo.pNext = NULL;
+			allocationInfo.allocationSize = arenaRequirements.size;
+			allocationInfo.memoryTypeIndex = chosenMemoryTypeIndex;
+
+			result = vkAllocateMemory(device, &allocationInfo, NULL, &memory);
+			if (result != VK_SUCCESS)
+			{
+				return result;
+			}
+			setObjectName(device, context->vkSetDebugUtilsObjectName, VK_OBJECT_TYPE_DEVICE_MEMORY, (uint64_t)memory, "FFX_CACAO_TEXTURE_ARENA");
+			memoryTypeBits = 1u << chosenMemoryTypeIndex;
+		}
+
+		context->arenaMemory = memory;
+		context->arenaOffset = memoryOffset;
+		context->arenaSize = arenaRequirements.size;
+		context->arenaAlignment = arenaRequirements.alignment;
+		context->arenaMemoryTypeBits = memoryTypeBits;
+	}
+	context->unaliasedArenaSize = unaliasedSize;
+	context->arenaUsedSize = arenaRequirements.size;
+
+	for (uint32_t i = 0; i < FFX_CACAO_ARRAY_SIZE(images); ++i)
+	{
+		result = vkBindImageMemory(device, images[i], context->arenaMemory, context->arenaOffset + offsets[i]);
+		if (result != VK_SUCCESS)
+		{
+			return result;
+		}
+	}
+
+	return VK_SUCCESS;
+}
+
+static VkResult createTextureViews(FFX_CACAO_VkContext* context)
+{
+	VkDevice device = context->device;
+	VkResult result;
+	uint32_t numSrvsInited = 0;
+	uint32_t numUavsInited = 0;
+
+	// create load counter view
+	{
+		VkImageView imageView;
+
+		VkImageViewCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		info.pNext = NULL;
+		info.flags = 0;
+		info.image = context->loadCounter;
+		info.viewType = VK_IMAGE_VIEW_TYPE_1D;
+		info.format = VK_FORMAT_R32_UINT;
+		info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		info.subresourceRange.baseMipLevel = 0;
+		info.subresourceRange.levelCount = 1;
+		info.subresourceRange.baseArrayLayer = 0;
+		info.subresourceRange.layerCount = 1;
+
+		result = vkCreateImageView(device, &info, NULL, &imageView);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_load_counter_view;
+		}
+
+		context->loadCounterView = imageView;
+	}
+
+
+	// create srv image views
+	for ( ; numSrvsInited < NUM_SHADER_RESOURCE_VIEWS; ++numSrvsInited)
+	{
+		VkImageView imageView;
+		ShaderResourceViewMetaData srvMetaData = SRV_META_DATA[numSrvsInited];
+
+		VkImageViewCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		info.pNext = NULL;
+		info.flags = 0;
+		info.image = context->textures[srvMetaData.texture];
+		info.viewType = VIEW_TYPE_LOOKUP_VK[srvMetaData.viewType];
+		info.format = TEXTURE_FORMAT_LOOKUP_VK[TEXTURE_META_DATA[srvMetaData.texture].format];
+		info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		info.subresourceRange.baseMipLevel = srvMetaData.mostDetailedMip;
+		info.subresourceRange.levelCount = srvMetaData.mipLevels;
+		info.subresourceRange.baseArrayLayer = srvMetaData.firstArraySlice;
+		info.subresourceRange.layerCount = srvMetaData.arraySize;
+
+		result = vkCreateImageView(device, &info, NULL, &imageView);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_srvs;
+		}
+
+		context->shaderResourceViews[numSrvsInited] = imageView;
+	}
+
+	// create uav image views
+	for ( ; numUavsInited < NUM_UNORDERED_ACCESS_VIEWS; ++numUavsInited)
+	{
+		VkImageView imageView;
+		UnorderedAccessViewMetaData uavMetaData = UAV_META_DATA[numUavsInited];
+
+		VkImageViewCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		info.pNext = NULL;
+		info.flags = 0;
+		info.image = context->textures[uavMetaData.textureID];
+		info.viewType = VIEW_TYPE_LOOKUP_VK[uavMetaData.viewType];
+		info.format = TEXTURE_FORMAT_LOOKUP_VK[TEXTURE_META_DATA[uavMetaData.textureID].format];
+		info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+		info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		info.subresourceRange.baseMipLevel = uavMetaData.mostDetailedMip;
+		info.subresourceRange.levelCount = 1;
+		info.subresourceRange.baseArrayLayer = uavMetaData.firstArraySlice;
+		info.subresourceRange.layerCount = uavMetaData.arraySize;
+
+		result = vkCreateImageView(device, &info, NULL, &imageView);
+		if (result != VK_SUCCESS)
+		{
+			goto error_init_uavs;
+		}
+
+		context->unorderedAccessViews[numUavsInited] = imageView;
+	}
+
+	return VK_SUCCESS;
+
+error_init_uavs:
+	for (uint32_t i = 0; i < numUavsInited; ++i)
+	{
+		vkDestroyImageView(device, context->unorderedAccessViews[i], NULL);
+	}
+
+error_init_srvs:
+	for (uint32_t i = 0; i < numSrvsInited; ++i)
+	{
+		vkDestroyImageView(device, context->shaderResourceViews[i], NULL);
+	}
+
+	vkDestroyImageView(device, context->loadCounterView, NULL);
+error_init_load_counter_view:
+	return result;
+}
+
+static void destroyTexturesAndViews(FFX_CACAO_VkContext* context)
+{
+	VkDevice device = context->device;
+
+	for (uint32_t i = 0; i < NUM_UNORDERED_ACCESS_VIEWS; ++i)
+	{
+		vkDestroyImageView(device, context->unorderedAccessViews[i], NULL);
+	}
+
+	for (uint32_t i = 0; i < NUM_SHADER_RESOURCE_VIEWS; ++i)
+	{
+		vkDestroyImageView(device, context->shaderResourceViews[i], NULL);
+	}
+
+	vkDestroyImageView(device, context->loadCounterView, NULL);
+
+	for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+	{
+		vkDestroyImage(device, context->textures[i], NULL);
+	}
+	vkDestroyImage(device, context->loadCounter, NULL);
+}
+
+// writes the views of the textures to the descriptor sets
+static void writeTextureDescriptors(FFX_CACAO_VkContext* context)
+{
+	VkDevice device = context->device;
+
+	// update descriptor sets from table
+	{
+		VkDescriptorImageInfo  imageInfos[NUM_INPUT_DESCRIPTOR_BINDINGS + NUM_OUTPUT_DESCRIPTOR_BINDINGS] = {};
+		VkDescriptorImageInfo *curImageInfo = imageInfos;
+		VkWriteDescriptorSet   writes[NUM_INPUT_DESCRIPTOR_BINDINGS + NUM_OUTPUT_DESCRIPTOR_BINDINGS] = {};
+		VkWriteDescriptorSet  *curWrite = writes;
+		
+		// write input descriptor bindings
+		for (uint32_t j = 0; j < NUM_INPUT_DESCRIPTOR_BINDINGS; ++j)
+		{
+			InputDescriptorBindingMetaData bindingMetaData = INPUT_DESCRIPTOR_BINDING_META_DATA[j];
+
+			curImageInfo->sampler = VK_NULL_HANDLE;
+			curImageInfo->imageView = context->shaderResourceViews[bindingMetaData.srvID];
+			curImageInfo->imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+			curWrite->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			curWrite->pNext = NULL;
+			curWrite->dstSet = context->descriptorSets[bindingMetaData.descriptorID];
+			curWrite->dstBinding = 20 + bindingMetaData.bindingNumber;
+			curWrite->descriptorCount = 1;
+			curWrite->descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			curWrite->pImageInfo = curImageInfo;
+
+			++curWrite; ++curImageInfo;
+		}
+
+		// write output descriptor bindings
+		for (uint32_t j = 0; j < NUM_OUTPUT_DESCRIPTOR_BINDINGS; ++j)
+		{
+			OutputDescriptorBindingMetaData bindingMetaData = OUTPUT_DESCRIPTOR_BINDING_META_DATA[j];
+
+			curImageInfo->sampler = VK_NULL_HANDLE;
+			curImageInfo->imageView = context->unorderedAccessViews[bindingMetaData.uavID];
+			curImageInfo->imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+			curWrite->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			curWrite->pNext = VK_NULL_HANDLE;
+			curWrite->dstSet = context->descriptorSets[bindingMetaData.descriptorID];
+			curWrite->dstBinding = 30 + bindingMetaData.bindingNumber;
+			curWrite->descriptorCount = 1;
+			curWrite->descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			curWrite->pImageInfo = curImageInfo;
+
+			++curWrite; ++curImageInfo;
+		}
+
+		vkUpdateDescriptorSets(device, FFX_CACAO_ARRAY_SIZE(writes), writes, 0, NULL);
+	}
+}
+
+// writes the views of the inputs, the output and the load counter to the descriptor sets
+static void writeInputOutputDescriptors(FFX_CACAO_VkContext* context, const FFX_CACAO_VkScreenSizeInfo* info)
+{
+	VkDevice device = context->device;
+
+	// update descriptor sets with inputs
+	{
+#define MAX_NUM_MISC_INPUT_DESCRIPTORS 32
+
+		VkDescriptorImageInfo imageInfos[MAX_NUM_MISC_INPUT_DESCRIPTORS] = {};
+		VkWriteDescriptorSet writes[MAX_NUM_MISC_INPUT_DESCRIPTORS] = {};
+
+		for (uint32_t i = 0; i < FFX_CACAO_ARRAY_SIZE(writes); ++i)
+		{
+			VkDescriptorImageInfo *imageInfo = imageInfos + i;
+			VkWriteDescriptorSet *write = writes + i;
+
+			imageInfo->sampler = VK_NULL_HANDLE;
+
+			write->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			write->pNext = NULL;
+			write->descriptorCount = 1;
+			write->pImageInfo = imageInfo;
+		}
+
+		uint32_t cur = 0;
+
+		// register(t0) -> 20
+		// register(u0) -> 30
+		imageInfos[cur].imageView = info->depthView;
+		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		writes[cur].dstSet = context->descriptorSets[DS_PREPARE_DEPTHS];
+		writes[cur].dstBinding = 20;
+		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		++cur;
+
+		imageInfos[cur].imageView = info->depthView;
+		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		writes[cur].dstSet = context->descriptorSets[DS_PREPARE_DEPTHS_MIPS];
+		writes[cur].dstBinding = 20;
+		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		++cur;
+
+		imageInfos[cur].imageView = info->depthView;
+		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		writes[cur].dstSet = context->descriptorSets[DS_PREPARE_NORMALS];
+		writes[cur].dstBinding = 20;
+		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		++cur;
+
+		imageInfos[cur].imageView = info->depthView;
+		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		writes[cur].dstSet = context->descriptorSets[DS_BILATERAL_UPSAMPLE_PING];
+		writes[cur].dstBinding = 21;
+		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		++cur;
+
+		imageInfos[cur].imageView = info->depthView;
+		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		writes[cur].dstSet = context->descriptorSets[DS_BILATERAL_UPSAMPLE_PONG];
+		writes[cur].dstBinding = 21;
+		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		++cur;
+
+		imageInfos[cur].imageView = info->outputView;
+		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		writes[cur].dstSet = context->descriptorSets[DS_BILATERAL_UPSAMPLE_PING];
+		writes[cur].dstBinding = 30;
+		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		++cur;
+
+		imageInfos[cur].imageView = info->outputView;
+		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		writes[cur].dstSet = context->descriptorSets[DS_BILATERAL_UPSAMPLE_PONG];
+		writes[cur].dstBinding = 30;
+		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		++cur;
+
+		imageInfos[cur].imageView = info->outputView;
+		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		writes[cur].dstSet = context->descriptorSets[DS_APPLY_PING];
+		writes[cur].dstBinding = 30;
+		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		++cur;
+
+		imageInfos[cur].imageView = info->outputView;
+		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		writes[cur].dstSet = context->descriptorSets[DS_APPLY_PONG];
+		writes[cur].dstBinding = 30;
+		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		++cur;
+
+		imageInfos[cur].imageView = context->loadCounterView;
+		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		writes[cur].dstSet = context->descriptorSets[DS_POSTPROCESS_IMPORTANCE_MAP_B];
+		writes[cur].dstBinding = 31;
+		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		++cur;
+
+		imageInfos[cur].imageView = context->loadCounterView;
+		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		writes[cur].dstSet = context->descriptorSets[DS_CLEAR_LOAD_COUNTER];
+		writes[cur].dstBinding = 30;
+		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		++cur;
+
+		for (uint32_t pass = 0; pass < 4; ++pass)
+		{
+			imageInfos[cur].imageView = context->loadCounterView;
+			imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			writes[cur].dstSet = context->descriptorSets[(DescriptorSetID)(DS_GENERATE_ADAPTIVE_0 + pass)];
+			writes[cur].dstBinding = 22;
+			writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			++cur;
+		}
+
+		if (info->normalsView) {
+			imageInfos[cur].imageView = info->normalsView;
+			imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			writes[cur].dstSet = context->descriptorSets[DS_PREPARE_NORMALS_FROM_INPUT_NORMALS];
+			writes[cur].dstBinding = 20;
+			writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+			++cur;
+		}
+
+		FFX_CACAO_ASSERT(cur <= MAX_NUM_MISC_INPUT_DESCRIPTORS);
+		vkUpdateDescriptorSets(device, cur, writes, 0, NULL);
+	}
+}
+
+// sets the screen size, inputs and output, which the textures must be at least as large as
+static void setScreenSize(FFX_CACAO_VkContext* context, const FFX_CACAO_VkScreenSizeInfo* info)
+{
+	context->useDownsampledSsao = info->useDownsampledSsao;
+	context->disableHighestQuality = info->disableHighestQuality;
+	context->output = info->output;
+	context->outputArrayLayer = info->outputArrayLayer;
+	context->nextPhase = FFX_CACAO_VK_PHASE_PREPARE;
+	getTextureLifetimes(&context->settings, context->useDownsampledSsao, context->textureLifetimes);
+
+	FFX_CACAO_UpdateBufferSizeInfo(info->width, info->height, context->useDownsampledSsao, &context->screenSizeInfo);
+	constantsCacheInvalidate(&context->constantsCache, CONSTANTS_DIRTY_SIZE);
+}
+
+// creates the textures and views at a size no smaller than the screen size, in the existing arena if they fit in it, and
+// writes the descriptor sets
+static FFX_CACAO_Status createScreenSizeDependentResources(FFX_CACAO_VkContext* context, const FFX_CACAO_VkScreenSizeInfo* info, uint32_t textureWidth, uint32_t textureHeight)
+{
+	setScreenSize(context, info);
+	FFX_CACAO_UpdateBufferSizeInfo(textureWidth, textureHeight, context->useDownsampledSsao, &context->bufferSizeInfo);
+
+	if (createTextureImages(context) != VK_SUCCESS)
+	{
+		goto error_init_texture_images;
+	}
+	if (bindTextureArena(context) != VK_SUCCESS)
+	{
+		goto error_init_arena;
+	}
+	if (createTextureViews(context) != VK_SUCCESS)
+	{
+		goto error_init_arena;
+	}
+	writeTextureDescriptors(context);
+	writeInputOutputDescriptors(context, info);
+
+	return FFX_CACAO_STATUS_OK;
+
+error_init_arena:
+	for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+	{
+		vkDestroyImage(context->device, context->textures[i], NULL);
+	}
+	vkDestroyImage(context->device, context->loadCounter, NULL);
+error_init_texture_images:
+	if (context->arenaMemory != VK_NULL_HANDLE)
+	{
+		freeTextureArena(context);
+	}
+	return FFX_CACAO_STATUS_FAILED;
+}
+
+FFX_CACAO_Status FFX_CACAO_VkInitScreenSizeDependentResources(FFX_CACAO_VkContext* context, const FFX_CACAO_VkScreenSizeInfo* info)
+{
+	if (context == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if (info == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedVkContextPointer(context);
+
+	return createScreenSizeDependentResources(context, info, info->width, info->height);
+}
+
+FFX_CACAO_Status FFX_CACAO_VkResize(FFX_CACAO_VkContext* context, const FFX_CACAO_VkScreenSizeInfo* info)
+{
+	if (context == NULL || info == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedVkContextPointer(context);
+	if (context->arenaMemory == VK_NULL_HANDLE)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+
+	// the textures are kept when the screen fits in them and their memory is laid out the same way, the screen then being
+	// drawn as a render area in the top left corner of them
+	FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
+	if (info->width <= bsi->inputOutputBufferWidth && info->height <= bsi->inputOutputBufferHeight && info->useDownsampledSsao == context->useDownsampledSsao && info->disableHighestQuality == context->disableHighestQuality)
+	{
+		setScreenSize(context, info);
+		writeInputOutputDescriptors(context, info);
+		return FFX_CACAO_STATUS_OK;
+	}
+
+	// otherwise they are recreated at no less than their previous size, the arena and the descriptor sets being kept
+	uint32_t textureWidth = FFX_CACAO_MAX(info->width, bsi->inputOutputBufferWidth);
+	uint32_t textureHeight = FFX_CACAO_MAX(info->height, bsi->inputOutputBufferHeight);
+	destroyTexturesAndViews(context);
+	return createScreenSizeDependentResources(context, info, textureWidth, textureHeight);
+}
+
+FFX_CACAO_Status FFX_CACAO_VkDestroyScreenSizeDependentResources(FFX_CACAO_VkContext* context)
+{
+	if (context == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedVkContextPointer(context);
+
+	destroyTexturesAndViews(context);
+	freeTextureArena(context);
+
+	return FFX_CACAO_STATUS_OK;
+}
+
+FFX_CACAO_Status FFX_CACAO_VkUpdateSettings(FFX_CACAO_VkContext* context, const FFX_CACAO_Settings* settings)
+{
+	if (context == NULL || settings == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedVkContextPointer(context);
+
+	if (memcmp(&context->settings, settings, sizeof(*settings)) != 0)
+	{
+		memcpy(&context->settings, settings, sizeof(*settings));
+		constantsCacheInvalidate(&context->constantsCache, CONSTANTS_DIRTY_SETTINGS);
+		getTextureLifetimes(&context->settings, context->useDownsampledSsao, context->textureLifetimes);
+		context->nextPhase = FFX_CACAO_VK_PHASE_PREPARE;
+	}
+
+	return FFX_CACAO_STATUS_OK;
+}
+
+// binds the descriptor set and, unless it is already bound, the pipeline of a dispatch
+static inline void computeDispatch(FFX_CACAO_VkContext* context, VkCommandBuffer cb, DescriptorSetID ds, ComputeShaderID cs, uint32_t width, uint32_t height, uint32_t depth, VkPipeline* boundPipeline)
+{
+	DescriptorSetLayoutID dsl = DESCRIPTOR_SET_META_DATA[ds].descriptorSetLayoutID;
+	uint32_t constantBufferOffset = (uint32_t)((context->currentConstantBuffer * 4 + DESCRIPTOR_SET_META_DATA[ds].pass) * context->constantBufferStride);
+	vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, context->deviceObjects->pipelineLayouts[dsl], 0, 1, &context->descriptorSets[ds], 1, &constantBufferOffset);
+	VkPipeline pipeline = context->deviceObjects->computePipelines[cs];
+	if (*boundPipeline != pipeline)
+	{
+		vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+		*boundPipeline = pipeline;
+	}
+	vkCmdDispatch(cb, width, height, depth);
+}
+
+typedef struct BarrierList
+{
+	uint32_t len;
+	VkImageMemoryBarrier barriers[16 * FFX_CACAO_VK_MAX_VIEWS];
+} BarrierList;
+
+static inline void pushBarrier(BarrierList* barrierList, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessFlags, VkAccessFlags dstAccessFlags)
+{
+	FFX_CACAO_ASSERT(barrierList->len < FFX_CACAO_ARRAY_SIZE(barrierList->barriers));
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.pNext = NULL;
+	barrier.srcAccessMask = srcAccessFlags;
+	barrier.dstAccessMask = dstAccessFlags;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+	barrier.image = image;
+	barrierList->barriers[barrierList->len++] = barrier;
+}
+
+// the output is only transitioned in the layer written by the context, so that the views of a multi-view draw may write the
+// layers of one array image
+static inline void pushOutputBarrier(BarrierList* barrierList, const FFX_CACAO_VkContext* context, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessFlags, VkAccessFlags dstAccessFlags)
+{
+	pushBarrier(barrierList, context->output, oldLayout, newLayout, srcAccessFlags, dstAccessFlags);
+	barrierList->barriers[barrierList->len - 1].subresourceRange.baseArrayLayer = context->outputArrayLayer;
+	barrierList->barriers[barrierList->len - 1].subresourceRange.layerCount = 1;
+}
+
+// transitions the textures first used in the given phase from undefined contents, after the writes of any texture sharing their memory
+static inline void pushFirstUseBarriers(BarrierList* barrierList, const FFX_CACAO_VkContext* context, DrawPhaseID phase)
+{
+	for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+	{
+		if (context->textureLifetimes[i].firstPhase == (uint32_t)phase)
+		{
+			pushBarrier(barrierList, context->textures[i], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+		}
+	}
+}
+
+static inline void beginDebugMarker(FFX_CACAO_VkContext* context, VkCommandBuffer cb, const char* name)
+{
+	if (context->vkCmdDebugMarkerBegin)
+	{
+		VkDebugMarkerMarkerInfoEXT info = {};
+		info.sType = VK_STRUCTURE_TYPE_DEBUG_MARKER_MARKER_INFO_EXT;
+		info.pNext = NULL;
+		info.pMarkerName = name;
+		info.color[0] = 1.0f;
+		info.color[1] = 0.0f;
+		info.color[2] = 0.0f;
+		info.color[3] = 1.0f;
+
+		context->vkCmdDebugMarkerBegin(cb, &info);
+	}
+}
+
+static inline void endDebugMarker(FFX_CACAO_VkContext* context, VkCommandBuffer cb)
+{
+	if (context->vkCmdDebugMarkerEnd)
+	{
+		context->vkCmdDebugMarkerEnd(cb);
+	}
+}
+
+// the steps of a draw, each recorded after a pipeline barrier. A draw of several views records the dispatches of all of
+// them in each step, after a single barrier for all of them
+typedef enum DrawStepID {
+	DRAW_STEP_PREPARE,
+	DRAW_STEP_BASE_SSAO,
+	DRAW_STEP_IMPORTANCE_MAP,
+	DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_A,
+	DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_B,
+	DRAW_STEP_GENERATE,
+	DRAW_STEP_BLUR,
+	DRAW_STEP_APPLY,
+	DRAW_STEP_END, ///< only the barrier making the output readable
+	NUM_DRAW_STEPS
+} DrawStepID;
+
+// a view of a draw, the context it is drawn with and the sizes its dispatches cover
+typedef struct VkDrawView {
+	FFX_CACAO_VkContext     *context;
+	FFX_CACAO_Bool           hasRenderArea;   ///< whether the view is drawn over a render area smaller than the resources
+	FFX_CACAO_BufferSizeInfo bsi;             ///< size covered by the passes writing intermediate textures
+	FFX_CACAO_BufferSizeInfo outputSizeInfo;  ///< size covered by the passes writing the output, the render area if there is one
+} VkDrawView;
+
+// pixels beyond a render area smaller than the resources which the passes writing intermediate textures also cover, so that
+// the neighbourhoods read around its edges are written by the same draw rather than left with the contents of textures
+// sharing their memory
+#define RENDER_AREA_GUARD_BAND 32
+
+// validates a view and creates the pipelines of its settings which are not created yet, before anything is recorded or updated
+static FFX_CACAO_Status initVkDrawView(FFX_CACAO_VkContext* context, const FFX_CACAO_Matrix4x4* proj, uint32_t renderWidth, uint32_t renderHeight, VkDrawView* view)
+{
+	if (context == NULL || proj == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedVkContextPointer(context);
+
+	FFX_CACAO_Settings *settings = &context->settings;
+	if (context->disableHighestQuality && settings->qualityLevel == FFX_CACAO_QUALITY_HIGHEST)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+	// a draw recorded in phases must record its later phases before the context is drawn again, the constants ring
+	// advanced by its first phase is still read by them
+	if (context->nextPhase != FFX_CACAO_VK_PHASE_PREPARE)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+
+	// the render area is in the top left corner of the screen, and the whole of the resources when it is as large. The
+	// screen is smaller than the resources after a resize keeping larger textures
+	FFX_CACAO_BufferSizeInfo *resourceSizeInfo = &context->bufferSizeInfo;
+	FFX_CACAO_BufferSizeInfo *screenSizeInfo = &context->screenSizeInfo;
+	if (renderWidth == 0 || renderHeight == 0 || renderWidth > screenSizeInfo->inputOutputBufferWidth || renderHeight > screenSizeInfo->inputOutputBufferHeight)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+	view->context = context;
+	view->hasRenderArea = renderWidth != resourceSizeInfo->inputOutputBufferWidth || renderHeight != resourceSizeInfo->inputOutputBufferHeight;
+	if (view->hasRenderArea)
+	{
+		// the output is only written over the render area
+		FFX_CACAO_UpdateBufferSizeInfo(renderWidth, renderHeight, context->useDownsampledSsao, &view->outputSizeInfo);
+
+		uint32_t guardedWidth = FFX_CACAO_MIN(renderWidth + RENDER_AREA_GUARD_BAND, resourceSizeInfo->inputOutputBufferWidth);
+		uint32_t guardedHeight = FFX_CACAO_MIN(renderHeight + RENDER_AREA_GUARD_BAND, resourceSizeInfo->inputOutputBufferHeight);
+		FFX_CACAO_UpdateBufferSizeInfo(guardedWidth, guardedHeight, context->useDownsampledSsao, &view->bsi);
+	}
+	else
+	{
+		view->bsi = *resourceSizeInfo;
+		view->outputSizeInfo = *resourceSizeInfo;
+	}
+
+	ComputeShaderID computeShaders[MAX_DRAW_COMPUTE_SHADERS];
+	uint32_t numComputeShaders = getDrawComputeShaders(settings, context->useDownsampledSsao, computeShaders);
+	return getPipelines(context->deviceObjects, computeShaders, numComputeShaders);
+}
+
+// advances the constant buffer ring of the context of a view and writes the constants of this frame
+static void beginVkDrawView(VkDrawView* view, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView)
+{
+	FFX_CACAO_VkContext *context = view->context;
+
+	uint32_t curBuffer = context->currentConstantBuffer;
+	curBuffer = (curBuffer + 1) % context->numFramesInFlight;
+	context->currentConstantBuffer = curBuffer;
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	{
+		uint32_t collectBuffer = context->collectBuffer = (curBuffer + 1) % context->numFramesInFlight;
+		if (uint32_t numQueries = context->timestampQueries[collectBuffer].numTimestamps)
+		{
+			uint32_t offset = collectBuffer * NUM_TIMESTAMPS;
+			vkGetQueryPoolResults(context->device, context->timestampQueryPool, offset, numQueries, numQueries * sizeof(uint64_t), context->timestampQueries[collectBuffer].timings, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		}
+		// only the context recording the timestamps of a draw has any this frame
+		context->timestampQueries[curBuffer].numTimestamps = 0;
+	}
+#endif
+
+	// update constant buffer, the blocks of this frame are only written when they are older than the cached constants
+	ConstantsCache *constantsCache = &context->constantsCache;
+	FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
+	FFX_CACAO_BufferSizeInfo *screenSizeInfo = &context->screenSizeInfo;
+	FFX_CACAO_Bool smallerInputs = screenSizeInfo->inputOutputBufferWidth != bsi->inputOutputBufferWidth || screenSizeInfo->inputOutputBufferHeight != bsi->inputOutputBufferHeight;
+	constantsCacheUpdate(constantsCache, &context->settings, bsi, view->hasRenderArea ? &view->outputSizeInfo : NULL, smallerInputs ? screenSizeInfo : NULL, proj, normalsToView);
+	if (context->constantBufferVersion[curBuffer] != constantsCache->version)
+	{
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			uint8_t *data = context->constantBufferData + (curBuffer * 4 + i) * context->constantBufferStride;
+			memcpy(data, &constantsCache->constants[i], sizeof(FFX_CACAO_Constants));
+		}
+		context->constantBufferVersion[curBuffer] = constantsCache->version;
+	}
+}
+
+static FFX_CACAO_Bool drawStepEnabled(const FFX_CACAO_Settings* settings, DrawStepID step)
+{
+	switch (step)
+	{
+	case DRAW_STEP_BASE_SSAO:
+	case DRAW_STEP_IMPORTANCE_MAP:
+	case DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_A:
+	case DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_B:
+		return settings->qualityLevel == FFX_CACAO_QUALITY_HIGHEST;
+	case DRAW_STEP_BLUR:
+		return FFX_CACAO_CLAMP(settings->blurPassCount, 0, MAX_BLUR_PASSES) != 0;
+	default:
+		return FFX_CACAO_TRUE;
+	}
+}
+
+static const char* drawStepName(const FFX_CACAO_VkContext* context, DrawStepID step)
+{
+	switch (step)
+	{
+	case DRAW_STEP_PREPARE:                      return "Prepare downsampled depths, normals and mips";
+	case DRAW_STEP_BASE_SSAO:                    return "Base SSAO";
+	case DRAW_STEP_IMPORTANCE_MAP:               return "Importance Map";
+	case DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_A: return "Postprocess Importance Map A";
+	case DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_B: return "Postprocess Importance Map B";
+	case DRAW_STEP_GENERATE:                     return "Generate SSAO";
+	case DRAW_STEP_BLUR:                         return "Deinterleaved Blur";
+	case DRAW_STEP_APPLY:                        return context->useDownsampledSsao ? "Bilateral Upsample" : "Reinterleave";
+	default:                                     return NULL;
+	}
+}
+
+// the barriers of a view before a step: textures are transitioned from undefined contents before the phase of their first
+// use, so that textures sharing memory only do so once the previous occupant is dead, the source stage also orders this
+// against the previous draw
+static void pushDrawStepBarriers(BarrierList* barrierList, const VkDrawView* view, DrawStepID step)
+{
+	const FFX_CACAO_VkContext *context = view->context;
+	const VkImage *tex = context->textures;
+	FFX_CACAO_Bool highest = context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST;
+	FFX_CACAO_Bool blur = drawStepEnabled(&context->settings, DRAW_STEP_BLUR);
+
+	switch (step)
+	{
+	case DRAW_STEP_PREPARE:
+		pushFirstUseBarriers(barrierList, context, DRAW_PHASE_PREPARE);
+		pushBarrier(barrierList, context->loadCounter, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
+		break;
+	case DRAW_STEP_BASE_SSAO:
+		pushBarrier(barrierList, tex[TEXTURE_DEINTERLEAVED_DEPTHS], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		pushBarrier(barrierList, tex[TEXTURE_DEINTERLEAVED_NORMALS], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		pushBarrier(barrierList, context->loadCounter, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT);
+		pushFirstUseBarriers(barrierList, context, DRAW_PHASE_BASE);
+		break;
+	case DRAW_STEP_IMPORTANCE_MAP:
+		pushBarrier(barrierList, tex[TEXTURE_SSAO_BUFFER_PONG], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		break;
+	case DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_A:
+		pushBarrier(barrierList, tex[TEXTURE_IMPORTANCE_MAP], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		break;
+	case DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_B:
+		pushBarrier(barrierList, tex[TEXTURE_IMPORTANCE_MAP], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT);
+		pushBarrier(barrierList, tex[TEXTURE_IMPORTANCE_MAP_PONG], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		break;
+	case DRAW_STEP_GENERATE:
+		if (highest)
+		{
+			pushBarrier(barrierList, tex[TEXTURE_IMPORTANCE_MAP], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+			pushBarrier(barrierList, context->loadCounter, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_READ_BIT);
+		}
+		else
+		{
+			pushBarrier(barrierList, tex[TEXTURE_DEINTERLEAVED_DEPTHS], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+			pushBarrier(barrierList, tex[TEXTURE_DEINTERLEAVED_NORMALS], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+			pushBarrier(barrierList, context->loadCounter, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT);
+		}
+		pushFirstUseBarriers(barrierList, context, DRAW_PHASE_GENERATE);
+		break;
+	case DRAW_STEP_BLUR:
+		pushBarrier(barrierList, tex[TEXTURE_SSAO_BUFFER_PING], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		if (context->textureLifetimes[TEXTURE_SSAO_BUFFER_PONG].firstPhase < DRAW_PHASE_BLUR)
+		{
+			pushBarrier(barrierList, tex[TEXTURE_SSAO_BUFFER_PONG], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
+		}
+		pushFirstUseBarriers(barrierList, context, DRAW_PHASE_BLUR);
+		break;
+	case DRAW_STEP_APPLY:
+		pushBarrier(barrierList, tex[blur ? TEXTURE_SSAO_BUFFER_PONG : TEXTURE_SSAO_BUFFER_PING], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		pushOutputBarrier(barrierList, context, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
+		pushFirstUseBarriers(barrierList, context, DRAW_PHASE_APPLY);
+		break;
+	case DRAW_STEP_END:
+		pushOutputBarrier(barrierList, context, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+		break;
+	default:
+		break;
+	}
+}
+
+// the dispatches of a view in a step
+static void recordDrawStep(VkCommandBuffer cb, const VkDrawView* view, DrawStepID step, VkPipeline* boundPipeline)
+{
+	FFX_CACAO_VkContext *context = view->context;
+	const FFX_CACAO_BufferSizeInfo *bsi = &view->bsi;
+	const FFX_CACAO_BufferSizeInfo *outputSizeInfo = &view->outputSizeInfo;
+	uint32_t blurPassCount = context->settings.blurPassCount;
+	blurPassCount = FFX_CACAO_CLAMP(blurPassCount, 0, MAX_BLUR_PASSES);
+
+	switch (step)
+	{
+	// prepare depths, normals and mips
+	case DRAW_STEP_PREPARE: {
+		// clear load counter
+		computeDispatch(context, cb, DS_CLEAR_LOAD_COUNTER, CS_CLEAR_LOAD_COUNTER, 1, 1, 1, boundPipeline);
+
+		switch (context->settings.qualityLevel)
+		{
+		case FFX_CACAO_QUALITY_LOWEST: {
+			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HALF_WIDTH, bsi->deinterleavedDepthBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HALF_HEIGHT, bsi->deinterleavedDepthBufferHeight);
+			ComputeShaderID csPrepareDepthsHalf = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS_HALF : CS_PREPARE_NATIVE_DEPTHS_HALF;
+			computeDispatch(context, cb, DS_PREPARE_DEPTHS, csPrepareDepthsHalf, dispatchWidth, dispatchHeight, 1, boundPipeline);
+			break;
+		}
+		case FFX_CACAO_QUALITY_LOW: {
+			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_WIDTH, bsi->deinterleavedDepthBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HEIGHT, bsi->deinterleavedDepthBufferHeight);
+			ComputeShaderID csPrepareDepths = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS : CS_PREPARE_NATIVE_DEPTHS;
+			computeDispatch(context, cb, DS_PREPARE_DEPTHS, csPrepareDepths, dispatchWidth, dispatchHeight, 1, boundPipeline);
+			break;
+		}
+		default: {
+			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH, bsi->deinterleavedDepthBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT, bsi->deinterleavedDepthBufferHeight);
+			ComputeShaderID csPrepareDepthsAndMips = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS_AND_MIPS : CS_PREPARE_NATIVE_DEPTHS_AND_MIPS;
+			computeDispatch(context, cb, DS_PREPARE_DEPTHS_MIPS, csPrepareDepthsAndMips, dispatchWidth, dispatchHeight, 1, boundPipeline);
+			break;
+		}
+		}
+
+		if (context->settings.generateNormals)
+		{
+			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_NORMALS_WIDTH, bsi->ssaoBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_NORMALS_HEIGHT, bsi->ssaoBufferHeight);
+			ComputeShaderID csPrepareNormals = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_NORMALS : CS_PREPARE_NATIVE_NORMALS;
+			computeDispatch(context, cb, DS_PREPARE_NORMALS, csPrepareNormals, dispatchWidth, dispatchHeight, 1, boundPipeline);
+		}
+		else
+		{
+			uint32_t dispatchWidth = dispatchSize(PREPARE_NORMALS_FROM_INPUT_NORMALS_WIDTH, bsi->ssaoBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(PREPARE_NORMALS_FROM_INPUT_NORMALS_HEIGHT, bsi->ssaoBufferHeight);
+			ComputeShaderID csPrepareNormalsFromInputNormals = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_NORMALS_FROM_INPUT_NORMALS : CS_PREPARE_NATIVE_NORMALS_FROM_INPUT_NORMALS;
+			computeDispatch(context, cb, DS_PREPARE_NORMALS_FROM_INPUT_NORMALS, csPrepareNormalsFromInputNormals, dispatchWidth, dispatchHeight, 1, boundPipeline);
+		}
+		break;
+	}
+
+	// base pass for highest quality setting
+	case DRAW_STEP_BASE_SSAO: {
+		uint32_t dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_WIDTH, bsi->ssaoBufferWidth);
+		uint32_t dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_HEIGHT, bsi->ssaoBufferHeight);
+
+		for (int pass = 0; pass < 4; ++pass)
+		{
+			computeDispatch(context, cb, (DescriptorSetID)(DS_GENERATE_ADAPTIVE_BASE_0 + pass), CS_GENERATE_Q3_BASE, dispatchWidth, dispatchHeight, 1, boundPipeline);
+		}
+		break;
+	}
+
+	// generate and postprocess importance map
+	case DRAW_STEP_IMPORTANCE_MAP:
+	case DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_A:
+	case DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_B: {
+		uint32_t dispatchWidth = dispatchSize(IMPORTANCE_MAP_WIDTH, bsi->importanceMapWidth);
+		uint32_t dispatchHeight = dispatchSize(IMPORTANCE_MAP_HEIGHT, bsi->importanceMapHeight);
+
+		if (step == DRAW_STEP_IMPORTANCE_MAP)
+		{
+			computeDispatch(context, cb, DS_GENERATE_IMPORTANCE_MAP, CS_GENERATE_IMPORTANCE_MAP, dispatchWidth, dispatchHeight, 1, boundPipeline);
+		}
+		else if (step == DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_A)
+		{
+			computeDispatch(context, cb, DS_POSTPROCESS_IMPORTANCE_MAP_A, CS_POSTPROCESS_IMPORTANCE_MAP_A, dispatchWidth, dispatchHeight, 1, boundPipeline);
+		}
+		else
+		{
+			computeDispatch(context, cb, DS_POSTPROCESS_IMPORTANCE_MAP_B, CS_POSTPROCESS_IMPORTANCE_MAP_B, dispatchWidth, dispatchHeight, 1, boundPipeline);
+		}
+		break;
+	}
+
+	// main ssao generation
+	case DRAW_STEP_GENERATE: {
+		ComputeShaderID generateCS = (ComputeShaderID)(CS_GENERATE_Q0 + FFX_CACAO_MAX(0, context->settings.qualityLevel - 1));
+
+		uint32_t dispatchWidth, dispatchHeight, dispatchDepth;
+
+		switch (context->settings.qualityLevel)
+		{
+		case FFX_CACAO_QUALITY_LOWEST:
+		case FFX_CACAO_QUALITY_LOW:
+		case FFX_CACAO_QUALITY_MEDIUM:
+			dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_SPARSE_WIDTH, bsi->ssaoBufferWidth);
+			dispatchWidth = (dispatchWidth + 4) / 5;
+			dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_SPARSE_HEIGHT, bsi->ssaoBufferHeight);
+			dispatchDepth = 5;
+			break;
+		case FFX_CACAO_QUALITY_HIGH:
+		case FFX_CACAO_QUALITY_HIGHEST:
+			dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_WIDTH, bsi->ssaoBufferWidth);
+			dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_HEIGHT, bsi->ssaoBufferHeight);
+			dispatchDepth = 1;
+			break;
+		}
+
+		for (int pass = 0; pass < 4; ++pass)
+		{
+			if (context->settings.qualityLevel == FFX_CACAO_QUALITY_LOWEST && (pass == 1 || pass == 2))
+			{
+				continue;
+			}
+
+			DescriptorSetID descriptorSetID = context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST ? DS_GENERATE_ADAPTIVE_0 : DS_GENERATE_0;
+			descriptorSetID = (DescriptorSetID)(descriptorSetID + pass);
+
+			computeDispatch(context, cb, descriptorSetID, generateCS, dispatchWidth, dispatchHeight, dispatchDepth, boundPipeline);
+		}
+		break;
+	}
+
+	// de-interleaved blur
+	case DRAW_STEP_BLUR: {
+		uint32_t w = 4 * FFX_CACAO_BLUR_WIDTH - 2 * blurPassCount;
+		uint32_t h = 3 * FFX_CACAO_BLUR_HEIGHT - 2 * blurPassCount;
+		uint32_t dispatchWidth = dispatchSize(w, bsi->ssaoBufferWidth);
+		uint32_t dispatchHeight = dispatchSize(h, bsi->ssaoBufferHeight);
 
-			curWrite->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			curWrite->pNext = VK_NULL_HANDLE;
-			curWrite->dstSet = context->descriptorSets[i][bindingMetaData.descriptorID];
-			curWrite->dstBinding = 30 + bindingMetaData.bindingNumber;
-			curWrite->descriptorCount = 1;
-			curWrite->descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-			curWrite->pImageInfo = curImageInfo;
+		for (int pass = 0; pass < 4; ++pass)
+		{
+			if (context->settings.qualityLevel == FFX_CACAO_QUALITY_LOWEST && (pass == 1 || pass == 2))
+			{
+				continue;
+			}
 
-			++curWrite; ++curImageInfo;
+			ComputeShaderID blurShaderID = (ComputeShaderID)(CS_EDGE_SENSITIVE_BLUR_1 + blurPassCount - 1);
+			DescriptorSetID descriptorSetID = (DescriptorSetID)(DS_EDGE_SENSITIVE_BLUR_0 + pass);
+			computeDispatch(context, cb, descriptorSetID, blurShaderID, dispatchWidth, dispatchHeight, 1, boundPipeline);
+		}
+		break;
+	}
+
+	case DRAW_STEP_APPLY:
+		if (context->useDownsampledSsao)
+		{
+			uint32_t dispatchWidth = dispatchSize(2 * FFX_CACAO_BILATERAL_UPSCALE_WIDTH, outputSizeInfo->inputOutputBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(2 * FFX_CACAO_BILATERAL_UPSCALE_HEIGHT, outputSizeInfo->inputOutputBufferHeight);
+
+			DescriptorSetID descriptorSetID = blurPassCount ? DS_BILATERAL_UPSAMPLE_PONG : DS_BILATERAL_UPSAMPLE_PING;
+			ComputeShaderID upscaler;
+			switch (context->settings.qualityLevel)
+			{
+			case FFX_CACAO_QUALITY_LOWEST:
+				upscaler = CS_UPSCALE_BILATERAL_5X5_HALF;
+				break;
+			case FFX_CACAO_QUALITY_LOW:
+			case FFX_CACAO_QUALITY_MEDIUM:
+				upscaler = CS_UPSCALE_BILATERAL_5X5_NON_SMART;
+				break;
+			case FFX_CACAO_QUALITY_HIGH:
+			case FFX_CACAO_QUALITY_HIGHEST:
+				upscaler = CS_UPSCALE_BILATERAL_5X5_SMART;
+				break;
+			}
+
+			computeDispatch(context, cb, descriptorSetID, upscaler, dispatchWidth, dispatchHeight, 1, boundPipeline);
 		}
+		else
+		{
+			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_APPLY_WIDTH, outputSizeInfo->inputOutputBufferWidth);
+			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_APPLY_HEIGHT, outputSizeInfo->inputOutputBufferHeight);
 
-		vkUpdateDescriptorSets(device, FFX_CACAO_ARRAY_SIZE(writes), writes, 0, NULL);
+			DescriptorSetID descriptorSetID = blurPassCount ? DS_APPLY_PONG : DS_APPLY_PING;
+
+			switch (context->settings.qualityLevel)
+			{
+			case FFX_CACAO_QUALITY_LOWEST:
+				computeDispatch(context, cb, descriptorSetID, CS_NON_SMART_HALF_APPLY, dispatchWidth, dispatchHeight, 1, boundPipeline);
+				break;
+			case FFX_CACAO_QUALITY_LOW:
+				computeDispatch(context, cb, descriptorSetID, CS_NON_SMART_APPLY, dispatchWidth, dispatchHeight, 1, boundPipeline);
+				break;
+			default:
+				computeDispatch(context, cb, descriptorSetID, CS_APPLY, dispatchWidth, dispatchHeight, 1, boundPipeline);
+				break;
+			}
+		}
+		break;
+
+	default:
+		break;
 	}
+}
 
-	// update descriptor sets with inputs
-	for (uint32_t i = 0; i < NUM_BACK_BUFFERS; ++i) {
-#define MAX_NUM_MISC_INPUT_DESCRIPTORS 32
+#ifdef FFX_CACAO_ENABLE_PROFILING
+// the timestamp written after a step, NUM_TIMESTAMPS if none is
+static TimestampID drawStepTimestamp(const FFX_CACAO_VkContext* context, DrawStepID step)
+{
+	switch (step)
+	{
+	case DRAW_STEP_PREPARE:                      return TIMESTAMP_PREPARE;
+	case DRAW_STEP_BASE_SSAO:                    return TIMESTAMP_BASE_SSAO_PASS;
+	case DRAW_STEP_POSTPROCESS_IMPORTANCE_MAP_B: return TIMESTAMP_IMPORTANCE_MAP;
+	case DRAW_STEP_GENERATE:                     return TIMESTAMP_GENERATE_SSAO;
+	case DRAW_STEP_BLUR:                         return TIMESTAMP_EDGE_SENSITIVE_BLUR;
+	case DRAW_STEP_APPLY:                        return context->useDownsampledSsao ? TIMESTAMP_BILATERAL_UPSAMPLE : TIMESTAMP_APPLY;
+	default:                                     return NUM_TIMESTAMPS;
+	}
+}
+#endif
 
-		VkDescriptorImageInfo imageInfos[MAX_NUM_MISC_INPUT_DESCRIPTORS] = {};
-		VkWriteDescriptorSet writes[MAX_NUM_MISC_INPUT_DESCRIPTORS] = {};
+// the first and last steps of each phase of a draw
+static const DrawStepID PHASE_STEPS[FFX_CACAO_VK_NUM_PHASES][2] = {
+	{ DRAW_STEP_PREPARE,   DRAW_STEP_PREPARE  }, // FFX_CACAO_VK_PHASE_PREPARE
+	{ DRAW_STEP_BASE_SSAO, DRAW_STEP_GENERATE }, // FFX_CACAO_VK_PHASE_GENERATE
+	{ DRAW_STEP_BLUR,      DRAW_STEP_END      }, // FFX_CACAO_VK_PHASE_RESOLVE
+};
 
-		for (uint32_t i = 0; i < FFX_CACAO_ARRAY_SIZE(writes); ++i)
+// records the steps of the phases firstPhase to lastPhase of the draw of the views, which all have the same settings. The
+// debug markers and timestamps are those of the first view
+static void recordVkDraw(VkCommandBuffer cb, const VkDrawView* views, uint32_t numViews, FFX_CACAO_VkPhase firstPhase, FFX_CACAO_VkPhase lastPhase)
+{
+	FFX_CACAO_VkContext *context = views[0].context;
+	BarrierList barrierList;
+	VkPipeline boundPipeline = VK_NULL_HANDLE;
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	uint32_t curBuffer = context->currentConstantBuffer;
+	uint32_t queryPoolOffset = curBuffer * NUM_TIMESTAMPS;
+	// the timestamps of a phase follow those of the earlier phases of the draw
+	uint32_t numTimestamps = context->timestampQueries[curBuffer].numTimestamps;
+	if (firstPhase == FFX_CACAO_VK_PHASE_PREPARE)
+	{
+		numTimestamps = 0;
+		vkCmdResetQueryPool(cb, context->timestampQueryPool, queryPoolOffset, NUM_TIMESTAMPS);
+	}
+#define GET_TIMESTAMP(name) \
+		context->timestampQueries[curBuffer].timestamps[numTimestamps] = name; \
+		vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, context->timestampQueryPool, queryPoolOffset + numTimestamps++);
+#else
+#define GET_TIMESTAMP(name)
+#endif
+
+	beginDebugMarker(context, cb, "FidelityFX CACAO");
+
+	if (firstPhase == FFX_CACAO_VK_PHASE_PREPARE)
+	{
+		GET_TIMESTAMP(TIMESTAMP_BEGIN)
+	}
+
+	for (uint32_t step = PHASE_STEPS[firstPhase][0]; step <= (uint32_t)PHASE_STEPS[lastPhase][1]; ++step)
+	{
+		if (!drawStepEnabled(&context->settings, (DrawStepID)step))
 		{
-			VkDescriptorImageInfo *imageInfo = imageInfos + i;
-			VkWriteDescriptorSet *write = writes + i;
+			continue;
+		}
+		if (step == DRAW_STEP_END)
+		{
+			endDebugMarker(context, cb);
+		}
 
-			imageInfo->sampler = VK_NULL_HANDLE;
+		barrierList.len = 0;
+		for (uint32_t i = 0; i < numViews; ++i)
+		{
+			pushDrawStepBarriers(&barrierList, &views[i], (DrawStepID)step);
+		}
+		vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, barrierList.len, barrierList.barriers);
 
-			write->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			write->pNext = NULL;
-			write->descriptorCount = 1;
-			write->pImageInfo = imageInfo;
+		if (step == DRAW_STEP_END)
+		{
+			break;
 		}
 
-		uint32_t cur = 0;
+		beginDebugMarker(context, cb, drawStepName(context, (DrawStepID)step));
+		for (uint32_t i = 0; i < numViews; ++i)
+		{
+			recordDrawStep(cb, &views[i], (DrawStepID)step, &boundPipeline);
+		}
+		endDebugMarker(context, cb);
 
-		// register(t0) -> 20
-		// register(u0) -> 30
-		imageInfos[cur].imageView = info->depthView;
-		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		writes[cur].dstSet = context->descriptorSets[i][DS_PREPARE_DEPTHS];
-		writes[cur].dstBinding = 20;
-		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-		++cur;
+#ifdef FFX_CACAO_ENABLE_PROFILING
+		TimestampID timestamp = drawStepTimestamp(context, (DrawStepID)step);
+		if (timestamp != NUM_TIMESTAMPS)
+		{
+			GET_TIMESTAMP(timestamp)
+		}
+#endif
+	}
 
-		imageInfos[cur].imageView = info->depthView;
-		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		writes[cur].dstSet = context->descriptorSets[i][DS_PREPARE_DEPTHS_MIPS];
-		writes[cur].dstBinding = 20;
-		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-		++cur;
+	if (PHASE_STEPS[lastPhase][1] != DRAW_STEP_END)
+	{
+		endDebugMarker(context, cb);
+	}
 
-		imageInfos[cur].imageView = info->depthView;
-		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		writes[cur].dstSet = context->descriptorSets[i][DS_PREPARE_NORMALS];
-		writes[cur].dstBinding = 20;
-		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-		++cur;
+#undef GET_TIMESTAMP
 
-		imageInfos[cur].imageView = info->depthView;
-		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		writes[cur].dstSet = context->descriptorSets[i][DS_BILATERAL_UPSAMPLE_PING];
-		writes[cur].dstBinding = 21;
-		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-		++cur;
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	context->timestampQueries[curBuffer].numTimestamps = numTimestamps;
+#endif
 
-		imageInfos[cur].imageView = info->depthView;
-		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		writes[cur].dstSet = context->descriptorSets[i][DS_BILATERAL_UPSAMPLE_PONG];
-		writes[cur].dstBinding = 21;
-		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-		++cur;
+	for (uint32_t i = 0; i < numViews; ++i)
+	{
+		views[i].context->nextPhase = (lastPhase + 1) % FFX_CACAO_VK_NUM_PHASES;
+	}
+}
 
-		imageInfos[cur].imageView = info->outputView;
-		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-		writes[cur].dstSet = context->descriptorSets[i][DS_BILATERAL_UPSAMPLE_PING];
-		writes[cur].dstBinding = 30;
-		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-		++cur;
+FFX_CACAO_Status FFX_CACAO_VkDraw(FFX_CACAO_VkContext* context, VkCommandBuffer cb, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView)
+{
+	if (context == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	FFX_CACAO_BufferSizeInfo *screenSizeInfo = &getAlignedVkContextPointer(context)->screenSizeInfo;
+	return FFX_CACAO_VkDrawRenderArea(context, cb, proj, normalsToView, screenSizeInfo->inputOutputBufferWidth, screenSizeInfo->inputOutputBufferHeight);
+}
 
-		imageInfos[cur].imageView = info->outputView;
-		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-		writes[cur].dstSet = context->descriptorSets[i][DS_BILATERAL_UPSAMPLE_PONG];
-		writes[cur].dstBinding = 30;
-		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-		++cur;
+FFX_CACAO_Status FFX_CACAO_VkDrawRenderArea(FFX_CACAO_VkContext* context, VkCommandBuffer cb, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView, uint32_t renderWidth, uint32_t renderHeight)
+{
+	if (cb == VK_NULL_HANDLE)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
 
-		imageInfos[cur].imageView = info->outputView;
-		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-		writes[cur].dstSet = context->descriptorSets[i][DS_APPLY_PING];
-		writes[cur].dstBinding = 30;
-		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-		++cur;
+	VkDrawView view;
+	FFX_CACAO_Status status = initVkDrawView(context, proj, renderWidth, renderHeight, &view);
+	if (status != FFX_CACAO_STATUS_OK)
+	{
+		return status;
+	}
 
-		imageInfos[cur].imageView = info->outputView;
-		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-		writes[cur].dstSet = context->descriptorSets[i][DS_APPLY_PONG];
-		writes[cur].dstBinding = 30;
-		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-		++cur;
+	beginVkDrawView(&view, proj, normalsToView);
+	recordVkDraw(cb, &view, 1, FFX_CACAO_VK_PHASE_PREPARE, FFX_CACAO_VK_PHASE_RESOLVE);
 
-		imageInfos[cur].imageView = context->loadCounterView;
-		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-		writes[cur].dstSet = context->descriptorSets[i][DS_POSTPROCESS_IMPORTANCE_MAP_B];
-		writes[cur].dstBinding = 31;
-		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-		++cur;
+	return FFX_CACAO_STATUS_OK;
+}
 
-		imageInfos[cur].imageView = context->loadCounterView;
-		imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-		writes[cur].dstSet = context->descriptorSets[i][DS_CLEAR_LOAD_COUNTER];
-		writes[cur].dstBinding = 30;
-		writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-		++cur;
+FFX_CACAO_Status FFX_CACAO_VkDrawViews(VkCommandBuffer cb, const FFX_CACAO_VkDrawViewInfo* views, uint32_t numViews)
+{
+	if (cb == VK_NULL_HANDLE || views == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if (numViews == 0 || numViews > FFX_CACAO_VK_MAX_VIEWS)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
 
-		for (uint32_t pass = 0; pass < 4; ++pass)
+	// all views are validated before the constants of any of them are updated
+	VkDrawView drawViews[FFX_CACAO_VK_MAX_VIEWS];
+	for (uint32_t i = 0; i < numViews; ++i)
+	{
+		const FFX_CACAO_VkDrawViewInfo *info = &views[i];
+		if (info->context == NULL)
 		{
-			imageInfos[cur].imageView = context->loadCounterView;
-			imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-			writes[cur].dstSet = context->descriptorSets[i][(DescriptorSetID)(DS_GENERATE_ADAPTIVE_0 + pass)];
-			writes[cur].dstBinding = 22;
-			writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-			++cur;
+			return FFX_CACAO_STATUS_INVALID_POINTER;
+		}
+		const FFX_CACAO_BufferSizeInfo *screenSizeInfo = &getAlignedVkContextPointer(info->context)->screenSizeInfo;
+		uint32_t renderWidth = info->renderWidth ? info->renderWidth : screenSizeInfo->inputOutputBufferWidth;
+		uint32_t renderHeight = info->renderHeight ? info->renderHeight : screenSizeInfo->inputOutputBufferHeight;
+		FFX_CACAO_Status status = initVkDrawView(info->context, info->proj, renderWidth, renderHeight, &drawViews[i]);
+		if (status != FFX_CACAO_STATUS_OK)
+		{
+			return status;
 		}
 
-		if (info->normalsView) {
-			imageInfos[cur].imageView = info->normalsView;
-			imageInfos[cur].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			writes[cur].dstSet = context->descriptorSets[i][DS_PREPARE_NORMALS_FROM_INPUT_NORMALS];
-			writes[cur].dstBinding = 20;
-			writes[cur].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-			++cur;
+		// the steps of all views are recorded together, so they must be the same, and each context is drawn once a frame
+		const FFX_CACAO_VkContext *context = drawViews[i].context;
+		const FFX_CACAO_VkContext *first = drawViews[0].context;
+		if (memcmp(&context->settings, &first->settings, sizeof(context->settings)) != 0 || context->useDownsampledSsao != first->useDownsampledSsao)
+		{
+			return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+		}
+		for (uint32_t j = 0; j < i; ++j)
+		{
+			if (drawViews[j].context == context)
+			{
+				return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+			}
+		}
+	}
+
+	for (uint32_t i = 0; i < numViews; ++i)
+	{
+		beginVkDrawView(&drawViews[i], views[i].proj, views[i].normalsToView);
+	}
+	recordVkDraw(cb, drawViews, numViews, FFX_CACAO_VK_PHASE_PREPARE, FFX_CACAO_VK_PHASE_RESOLVE);
+
+	return FFX_CACAO_STATUS_OK;
+}
+
+FFX_CACAO_Status FFX_CACAO_VkDrawPhase(FFX_CACAO_VkContext* context, VkCommandBuffer cb, FFX_CACAO_VkPhase phase, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView, uint32_t renderWidth, uint32_t renderHeight)
+{
+	if (context == NULL || cb == VK_NULL_HANDLE)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if ((uint32_t)phase >= FFX_CACAO_VK_NUM_PHASES)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+	context = getAlignedVkContextPointer(context);
+
+	VkDrawView view;
+	if (phase == FFX_CACAO_VK_PHASE_PREPARE)
+	{
+		FFX_CACAO_BufferSizeInfo *screenSizeInfo = &context->screenSizeInfo;
+		renderWidth = renderWidth ? renderWidth : screenSizeInfo->inputOutputBufferWidth;
+		renderHeight = renderHeight ? renderHeight : screenSizeInfo->inputOutputBufferHeight;
+		FFX_CACAO_Status status = initVkDrawView(context, proj, renderWidth, renderHeight, &view);
+		if (status != FFX_CACAO_STATUS_OK)
+		{
+			return status;
+		}
+
+		beginVkDrawView(&view, proj, normalsToView);
+		context->phaseSizeInfo = view.bsi;
+		context->phaseOutputSizeInfo = view.outputSizeInfo;
+	}
+	else
+	{
+		// the later phases continue the draw started by the first, with its sizes and constants
+		if ((uint32_t)phase != context->nextPhase)
+		{
+			return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+		}
+		view.context = context;
+		view.hasRenderArea = FFX_CACAO_FALSE;
+		view.bsi = context->phaseSizeInfo;
+		view.outputSizeInfo = context->phaseOutputSizeInfo;
+	}
+
+	recordVkDraw(cb, &view, 1, phase, phase);
+
+	return FFX_CACAO_STATUS_OK;
+}
+
+FFX_CACAO_Status FFX_CACAO_VkGetPhaseTransferBarriers(FFX_CACAO_VkContext* context, FFX_CACAO_VkPhase phase, uint32_t srcQueueFamilyIndex, uint32_t dstQueueFamilyIndex, VkImageMemoryBarrier* barriers, uint32_t* numBarriers)
+{
+	if (context == NULL || numBarriers == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if ((uint32_t)phase >= FFX_CACAO_VK_PHASE_RESOLVE)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+	context = getAlignedVkContextPointer(context);
+
+	// the layouts the textures and load counter are left in by the phase, those of the last barriers of the steps up to its end
+	VkImageLayout layouts[NUM_TEXTURES + 1];
+	for (uint32_t i = 0; i < FFX_CACAO_ARRAY_SIZE(layouts); ++i)
+	{
+		layouts[i] = VK_IMAGE_LAYOUT_UNDEFINED;
+	}
+	VkDrawView view = {};
+	view.context = context;
+	BarrierList barrierList;
+	for (uint32_t step = DRAW_STEP_PREPARE; step <= (uint32_t)PHASE_STEPS[phase][1]; ++step)
+	{
+		if (!drawStepEnabled(&context->settings, (DrawStepID)step))
+		{
+			continue;
+		}
+		barrierList.len = 0;
+		pushDrawStepBarriers(&barrierList, &view, (DrawStepID)step);
+		for (uint32_t i = 0; i < barrierList.len; ++i)
+		{
+			for (uint32_t j = 0; j < NUM_TEXTURES; ++j)
+			{
+				if (barrierList.barriers[i].image == context->textures[j])
+				{
+					layouts[j] = barrierList.barriers[i].newLayout;
+				}
+			}
+			if (barrierList.barriers[i].image == context->loadCounter)
+			{
+				layouts[NUM_TEXTURES] = barrierList.barriers[i].newLayout;
+			}
 		}
+	}
 
-		FFX_CACAO_ASSERT(cur <= MAX_NUM_MISC_INPUT_DESCRIPTORS);
-		vkUpdateDescriptorSets(device, cur, writes, 0, NULL);
+	// the textures used on both sides of the boundary, and the load counter cleared by the first phase
+	uint32_t boundary = phase == FFX_CACAO_VK_PHASE_PREPARE ? DRAW_PHASE_PREPARE : DRAW_PHASE_GENERATE;
+	barrierList.len = 0;
+	for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+	{
+		if (context->textureLifetimes[i].firstPhase <= boundary && context->textureLifetimes[i].lastPhase > boundary)
+		{
+			pushBarrier(&barrierList, context->textures[i], layouts[i], layouts[i], VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+		}
 	}
+	if (phase == FFX_CACAO_VK_PHASE_PREPARE)
+	{
+		pushBarrier(&barrierList, context->loadCounter, layouts[NUM_TEXTURES], layouts[NUM_TEXTURES], VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+	}
+	FFX_CACAO_ASSERT(barrierList.len <= FFX_CACAO_VK_MAX_PHASE_TRANSFER_BARRIERS);
 
-	// update descriptor sets with constant buffers
-	for (uint32_t i = 0; i < NUM_BACK_BUFFERS; ++i) {
-		VkDescriptorBufferInfo  bufferInfos[NUM_DESCRIPTOR_SETS] = {};
-		VkDescriptorBufferInfo *curBufferInfo = bufferInfos;
-		VkWriteDescriptorSet    writes[NUM_DESCRIPTOR_SETS] = {};
-		VkWriteDescriptorSet   *curWrite = writes;
+	if (barriers == NULL)
+	{
+		*numBarriers = barrierList.len;
+		return FFX_CACAO_STATUS_OK;
+	}
+	if (*numBarriers < barrierList.len)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+	for (uint32_t i = 0; i < barrierList.len; ++i)
+	{
+		barriers[i] = barrierList.barriers[i];
+		barriers[i].srcQueueFamilyIndex = srcQueueFamilyIndex;
+		barriers[i].dstQueueFamilyIndex = dstQueueFamilyIndex;
+	}
+	*numBarriers = barrierList.len;
 
-		for (uint32_t j = 0; j < NUM_DESCRIPTOR_SETS; ++j)
-		{
-			DescriptorSetMetaData dsMetaData = DESCRIPTOR_SET_META_DATA[j];
+	return FFX_CACAO_STATUS_OK;
+}
 
-			curBufferInfo->buffer = context->constantBuffer[i][dsMetaData.pass];
-			curBufferInfo->offset = 0;
-			curBufferInfo->range = VK_WHOLE_SIZE;
+FFX_CACAO_Status FFX_CACAO_VkPrewarmPipelines(FFX_CACAO_VkContext* context, FFX_CACAO_Quality qualityLevel, FFX_CACAO_Bool wait)
+{
+	if (context == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if ((uint32_t)qualityLevel > FFX_CACAO_QUALITY_HIGHEST)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+	context = getAlignedVkContextPointer(context);
 
-			curWrite->sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			curWrite->pNext = NULL;
-			curWrite->dstSet = context->descriptorSets[i][j];
-			curWrite->dstBinding = 10;
-			curWrite->dstArrayElement = 0;
-			curWrite->descriptorCount = 1;
-			curWrite->descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			curWrite->pBufferInfo = curBufferInfo;
+	FFX_CACAO_Settings settings = context->settings;
+	settings.qualityLevel = qualityLevel;
+	ComputeShaderID computeShaders[MAX_DRAW_COMPUTE_SHADERS];
+	uint32_t numComputeShaders = getDrawComputeShaders(&settings, context->useDownsampledSsao, computeShaders);
 
-			++curWrite;
-			++curBufferInfo;
-		}
+	queuePipelines(context->deviceObjects, computeShaders, numComputeShaders);
+	if (wait)
+	{
+		return getPipelines(context->deviceObjects, computeShaders, numComputeShaders);
+	}
+	return FFX_CACAO_STATUS_OK;
+}
 
-		vkUpdateDescriptorSets(device, FFX_CACAO_ARRAY_SIZE(writes), writes, 0, NULL);
+FFX_CACAO_Status FFX_CACAO_VkGetMemoryUsage(FFX_CACAO_VkContext* context, FFX_CACAO_VkMemoryUsage* usage)
+{
+	if (context == NULL || usage == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
 	}
+	context = getAlignedVkContextPointer(context);
+
+	usage->arenaSize = context->arenaSize;
+	usage->usedSize = context->arenaUsedSize;
+	usage->unaliasedSize = context->unaliasedArenaSize;
 
 	return FFX_CACAO_STATUS_OK;
+}
 
-error_init_uavs:
-	for (uint32_t i = 0; i < numUavsInited; ++i)
+#ifdef FFX_CACAO_ENABLE_PROFILING
+FFX_CACAO_Status FFX_CACAO_VkGetDetailedTimings(FFX_CACAO_VkContext* context, FFX_CACAO_DetailedTiming* timings)
+{
+	if (context == NULL || timings == NULL)
 	{
-		vkDestroyImageView(device, context->unorderedAccessViews[i], NULL);
+		return FFX_CACAO_STATUS_INVALID_POINTER;
 	}
+	context = getAlignedVkContextPointer(context);
 
-error_init_srvs:
-	for (uint32_t i = 0; i < numSrvsInited; ++i)
+	uint32_t bufferIndex = context->collectBuffer;
+	uint32_t numTimestamps = context->timestampQueries[bufferIndex].numTimestamps;
+	uint64_t prevTime = context->timestampQueries[bufferIndex].timings[0];
+	for (uint32_t i = 1; i < numTimestamps; ++i)
 	{
-		vkDestroyImageView(device, context->shaderResourceViews[i], NULL);
+		TimestampID timestampID = context->timestampQueries[bufferIndex].timestamps[i];
+		timings->timestamps[i].label = TIMESTAMP_NAMES[timestampID];
+		uint64_t time = context->timestampQueries[bufferIndex].timings[i];
+		timings->timestamps[i].ticks = time - prevTime;
+		prevTime = time;
 	}
+	timings->timestamps[0].label = "FFX_CACAO_TOTAL";
+	timings->timestamps[0].ticks = prevTime - context->timestampQueries[bufferIndex].timings[0];
+	timings->numTimestamps = numTimestamps;
+	
+	return FFX_CACAO_STATUS_OK;
+}
+#endif
+#endif
+
+#ifdef FFX_CACAO_ENABLE_CPU
+size_t FFX_CACAO_CpuGetContextSize()
+{
+	return sizeof(FFX_CACAO_CpuContext) + alignof(FFX_CACAO_CpuContext) - 1;
+}
 
-error_init_texture_memories:
-	for (uint32_t i = 0; i < numTextureMemoriesInited; ++i)
+FFX_CACAO_Status FFX_CACAO_CpuInitContext(FFX_CACAO_CpuContext* context, const FFX_CACAO_CpuCreateInfo* info)
+{
+	if (context == NULL)
 	{
-		vkFreeMemory(device, context->textureMemory[i], NULL);
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if (info == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if (info->jobSystem && (info->jobSystem->parallelFor == NULL || info->jobSystem->numTasks == 0))
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
 	}
+	context = getAlignedCpuContextPointer(context);
+	memset((void*)context, 0, sizeof(*context));
+	constantsCacheInit(&context->constantsCache);
 
-error_init_texture_images:
-	for (uint32_t i = 0; i < numTextureImagesInited; ++i)
+	if (info->flags & FFX_CACAO_CPU_CREATE_REFERENCE)
 	{
-		vkDestroyImage(device, context->textures[i], NULL);
+		// the reference runs every thread group in order on the calling thread
+		FFX_CACAO_CpuCreateInfo referenceInfo = {};
+		referenceInfo.numThreads = 1;
+		referenceInfo.flags = info->flags;
+
+		context->computeShaders = COMPUTE_SHADER_CPU_REFERENCE;
+		context->reference = true;
+		return cpuSchedulerCreate(&referenceInfo, &context->scheduler);
 	}
 
-	return errorStatus;
+	context->computeShaders = COMPUTE_SHADER_CPU;
+	context->ssaoTapKernel = cpuSelectSSAOTapKernel(info->flags);
+	context->blurKernel = cpuSelectBlurKernel(info->flags);
+	context->bilateralUpscaleKernel = cpuSelectBilateralUpscaleKernel(info->flags);
+
+	return cpuSchedulerCreate(info, &context->scheduler);
 }
 
-FFX_CACAO_Status FFX_CACAO_VkDestroyScreenSizeDependentResources(FFX_CACAO_VkContext* context)
+FFX_CACAO_Status FFX_CACAO_CpuDestroyContext(FFX_CACAO_CpuContext* context)
 {
 	if (context == NULL)
 	{
 		return FFX_CACAO_STATUS_INVALID_POINTER;
 	}
-	context = getAlignedVkContextPointer(context);
+	context = getAlignedCpuContextPointer(context);
 
-	VkDevice device = context->device;
+	cpuSchedulerDestroy(context->scheduler);
+	context->scheduler = NULL;
 
-	for (uint32_t i = 0; i < NUM_UNORDERED_ACCESS_VIEWS; ++i)
+	return FFX_CACAO_STATUS_OK;
+}
+
+// wraps the depth, normal and output buffers in the textures the descriptor sets view
+static void cpuBindBuffers(FFX_CACAO_CpuContext* context, const FFX_CACAO_CpuScreenSizeInfo* info)
+{
+	cpuTextureWrap(&context->depth, TEXTURE_FORMAT_R32_SFLOAT, info->width, info->height, info->depth, info->depthRowPitch);
+	cpuTextureWrap(&context->normals, TEXTURE_FORMAT_R32G32B32A32_SFLOAT, info->width, info->height, info->normals, info->normalsRowPitch);
+	cpuTextureWrap(&context->output, TEXTURE_FORMAT_R32_SFLOAT, info->width, info->height, info->output, info->outputRowPitch);
+
+	CpuImageView normalsView = {};
+	if (info->normals)
 	{
-		vkDestroyImageView(device, context->unorderedAccessViews[i], NULL);
+		normalsView = cpuImageView(&context->normals, 0, 1, 0, 1);
 	}
+	context->descriptorSets[DS_PREPARE_NORMALS_FROM_INPUT_NORMALS].inputs[0] = normalsView;
+}
 
-	for (uint32_t i = 0; i < NUM_SHADER_RESOURCE_VIEWS; ++i)
+FFX_CACAO_Status FFX_CACAO_CpuInitScreenSizeDependentResources(FFX_CACAO_CpuContext* context, const FFX_CACAO_CpuScreenSizeInfo* info)
+{
+	if (context == NULL)
 	{
-		vkDestroyImageView(device, context->shaderResourceViews[i], NULL);
+		return FFX_CACAO_STATUS_INVALID_POINTER;
 	}
+	if (info == NULL || info->depth == NULL || info->output == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedCpuContextPointer(context);
 
-	for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+	FFX_CACAO_Bool useDownsampledSsao = info->useDownsampledSsao;
+	context->useDownsampledSsao = useDownsampledSsao;
+
+	FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
+	FFX_CACAO_UpdateBufferSizeInfo(info->width, info->height, useDownsampledSsao, bsi);
+	constantsCacheInvalidate(&context->constantsCache, CONSTANTS_DIRTY_SIZE);
+
+	uint32_t numTexturesInited = 0;
+
+	// allocate textures
+	for ( ; numTexturesInited < NUM_TEXTURES; ++numTexturesInited)
 	{
-		vkFreeMemory(device, context->textureMemory[i], NULL);
+		TextureMetaData metaData = TEXTURE_META_DATA[numTexturesInited];
+		CpuTexture *texture = &context->textures[numTexturesInited];
+
+		uint32_t width = *(uint32_t*)((uint8_t*)bsi + metaData.widthOffset);
+		uint32_t height = *(uint32_t*)((uint8_t*)bsi + metaData.heightOffset);
+		size_t size = cpuTextureInit(texture, metaData.format, width, height, metaData.arraySize, metaData.numMips);
+
+		texture->data = (uint8_t*)calloc(1, size + CPU_TEXTURE_PADDING);
+		if (texture->data == NULL)
+		{
+			goto error_init_textures;
+		}
 	}
 
-	for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+	// update descriptor sets from table
+	memset(context->descriptorSets, 0, sizeof(context->descriptorSets));
+
+	for (uint32_t i = 0; i < NUM_DESCRIPTOR_SETS; ++i)
 	{
-		vkDestroyImage(device, context->textures[i], NULL);
+		context->descriptorSets[i].constants = &context->constantsCache.constants[DESCRIPTOR_SET_META_DATA[i].pass];
+	}
+
+	for (uint32_t i = 0; i < NUM_INPUT_DESCRIPTOR_BINDINGS; ++i)
+	{
+		InputDescriptorBindingMetaData bindingMetaData = INPUT_DESCRIPTOR_BINDING_META_DATA[i];
+		ShaderResourceViewMetaData srvMetaData = SRV_META_DATA[bindingMetaData.srvID];
+		FFX_CACAO_ASSERT(bindingMetaData.bindingNumber < CPU_MAX_DESCRIPTOR_BINDINGS);
+
+		context->descriptorSets[bindingMetaData.descriptorID].inputs[bindingMetaData.bindingNumber] =
+			cpuImageView(&context->textures[srvMetaData.texture], srvMetaData.mostDetailedMip, srvMetaData.mipLevels, srvMetaData.firstArraySlice, srvMetaData.arraySize);
+	}
+
+	for (uint32_t i = 0; i < NUM_OUTPUT_DESCRIPTOR_BINDINGS; ++i)
+	{
+		OutputDescriptorBindingMetaData bindingMetaData = OUTPUT_DESCRIPTOR_BINDING_META_DATA[i];
+		UnorderedAccessViewMetaData uavMetaData = UAV_META_DATA[bindingMetaData.uavID];
+		FFX_CACAO_ASSERT(bindingMetaData.bindingNumber < CPU_MAX_DESCRIPTOR_BINDINGS);
+
+		context->descriptorSets[bindingMetaData.descriptorID].outputs[bindingMetaData.bindingNumber] =
+			cpuImageView(&context->textures[uavMetaData.textureID], uavMetaData.mostDetailedMip, 1, uavMetaData.firstArraySlice, uavMetaData.arraySize);
+	}
+
+	// update descriptor sets with inputs
+	{
+		CpuImageView depthView = cpuImageView(&context->depth, 0, 1, 0, 1);
+		CpuImageView outputView = cpuImageView(&context->output, 0, 1, 0, 1);
+		CpuDescriptorSet *ds = context->descriptorSets;
+
+		// register(t0) -> inputs[0]
+		// register(u0) -> outputs[0]
+		ds[DS_PREPARE_DEPTHS].inputs[0] = depthView;
+		ds[DS_PREPARE_DEPTHS_MIPS].inputs[0] = depthView;
+		ds[DS_PREPARE_NORMALS].inputs[0] = depthView;
+		ds[DS_BILATERAL_UPSAMPLE_PING].inputs[1] = depthView;
+		ds[DS_BILATERAL_UPSAMPLE_PONG].inputs[1] = depthView;
+
+		ds[DS_BILATERAL_UPSAMPLE_PING].outputs[0] = outputView;
+		ds[DS_BILATERAL_UPSAMPLE_PONG].outputs[0] = outputView;
+		ds[DS_APPLY_PING].outputs[0] = outputView;
+		ds[DS_APPLY_PONG].outputs[0] = outputView;
 	}
 
+	cpuBindBuffers(context, info);
+
 	return FFX_CACAO_STATUS_OK;
+
+error_init_textures:
+	for (uint32_t i = 0; i < numTexturesInited; ++i)
+	{
+		free(context->textures[i].data);
+		context->textures[i].data = NULL;
+	}
+
+	return FFX_CACAO_STATUS_OUT_OF_MEMORY;
 }
 
-FFX_CACAO_Status FFX_CACAO_VkUpdateSettings(FFX_CACAO_VkContext* context, const FFX_CACAO_Settings* settings)
+FFX_CACAO_Status FFX_CACAO_CpuDestroyScreenSizeDependentResources(FFX_CACAO_CpuContext* context)
 {
-	if (context == NULL || settings == NULL)
+	if (context == NULL)
 	{
 		return FFX_CACAO_STATUS_INVALID_POINTER;
 	}
-	context = getAlignedVkContextPointer(context);
+	context = getAlignedCpuContextPointer(context);
 
-	memcpy(&context->settings, settings, sizeof(*settings));
+	for (uint32_t i = 0; i < NUM_TEXTURES; ++i)
+	{
+		free(context->textures[i].data);
+		context->textures[i].data = NULL;
+	}
 
 	return FFX_CACAO_STATUS_OK;
 }
 
-static inline void computeDispatch(FFX_CACAO_VkContext* context, VkCommandBuffer cb, DescriptorSetID ds, ComputeShaderID cs, uint32_t width, uint32_t height, uint32_t depth)
+FFX_CACAO_Status FFX_CACAO_CpuUpdateBuffers(FFX_CACAO_CpuContext* context, const FFX_CACAO_CpuScreenSizeInfo* info)
 {
-	DescriptorSetLayoutID dsl = DESCRIPTOR_SET_META_DATA[ds].descriptorSetLayoutID;
-	vkCmdBindDescriptorSets(cb, VK_PIPELINE_BIND_POINT_COMPUTE, context->pipelineLayouts[dsl], 0, 1, &context->descriptorSets[context->currentConstantBuffer][ds], 0, NULL);
-	vkCmdBindPipeline(cb, VK_PIPELINE_BIND_POINT_COMPUTE, context->computePipelines[cs]);
-	vkCmdDispatch(cb, width, height, depth);
-}
+	if (context == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if (info == NULL || info->depth == NULL || info->output == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedCpuContextPointer(context);
 
-typedef struct BarrierList
-{
-	uint32_t len;
-	VkImageMemoryBarrier barriers[32];
-} BarrierList;
+	const FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
+	if (info->width != bsi->inputOutputBufferWidth || info->height != bsi->inputOutputBufferHeight || info->useDownsampledSsao != context->useDownsampledSsao)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
 
-static inline void pushBarrier(BarrierList* barrierList, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessFlags, VkAccessFlags dstAccessFlags)
-{
-	FFX_CACAO_ASSERT(barrierList->len < FFX_CACAO_ARRAY_SIZE(barrierList->barriers));
-	VkImageMemoryBarrier barrier = {};
-	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-	barrier.pNext = NULL;
-	barrier.srcAccessMask = srcAccessFlags;
-	barrier.dstAccessMask = dstAccessFlags;
-	barrier.oldLayout = oldLayout;
-	barrier.newLayout = newLayout;
-	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	barrier.subresourceRange.baseMipLevel = 0;
-	barrier.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
-	barrier.subresourceRange.baseArrayLayer = 0;
-	barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
-	barrier.image = image;
-	barrierList->barriers[barrierList->len++] = barrier;
+	cpuBindBuffers(context, info);
+
+	return FFX_CACAO_STATUS_OK;
 }
 
-static inline void beginDebugMarker(FFX_CACAO_VkContext* context, VkCommandBuffer cb, const char* name)
+FFX_CACAO_Status FFX_CACAO_CpuUpdateSettings(FFX_CACAO_CpuContext* context, const FFX_CACAO_Settings* settings)
 {
-	if (context->vkCmdDebugMarkerBegin)
+	if (context == NULL || settings == NULL)
 	{
-		VkDebugMarkerMarkerInfoEXT info = {};
-		info.sType = VK_STRUCTURE_TYPE_DEBUG_MARKER_MARKER_INFO_EXT;
-		info.pNext = NULL;
-		info.pMarkerName = name;
-		info.color[0] = 1.0f;
-		info.color[1] = 0.0f;
-		info.color[2] = 0.0f;
-		info.color[3] = 1.0f;
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedCpuContextPointer(context);
 
-		context->vkCmdDebugMarkerBegin(cb, &info);
+	if (memcmp(&context->settings, settings, sizeof(*settings)) != 0)
+	{
+		memcpy(&context->settings, settings, sizeof(*settings));
+		constantsCacheInvalidate(&context->constantsCache, CONSTANTS_DIRTY_SETTINGS);
 	}
+
+	return FFX_CACAO_STATUS_OK;
 }
 
-static inline void endDebugMarker(FFX_CACAO_VkContext* context, VkCommandBuffer cb)
+static inline void cpuComputeDispatch(FFX_CACAO_CpuContext* context, DescriptorSetID ds, ComputeShaderID cs, uint32_t width, uint32_t height, uint32_t depth)
 {
-	if (context->vkCmdDebugMarkerEnd)
+	CpuDispatchInfo info;
+	info.constants = context->descriptorSets[ds].constants;
+	info.descriptorSet = &context->descriptorSets[ds];
+	info.loadCounter = &context->loadCounter;
+	info.ssaoTapKernel = context->ssaoTapKernel;
+	info.blurKernel = context->blurKernel;
+	info.bilateralUpscaleKernel = context->bilateralUpscaleKernel;
+	info.groupShared = NULL;
+	cpuSchedulerDispatch(context->scheduler, context->computeShaders[cs], &info, width, height, depth);
+
+	for (uint32_t i = 0; i < CPU_MAX_DESCRIPTOR_BINDINGS; ++i)
 	{
-		context->vkCmdDebugMarkerEnd(cb);
+		const CpuTexture *texture = info.descriptorSet->outputs[i].texture;
+		if (texture == &context->output)
+		{
+			context->writtenTextures |= 1u << NUM_TEXTURES;
+		}
+		else if (texture)
+		{
+			context->writtenTextures |= 1u << (uint32_t)(texture - context->textures);
+		}
 	}
 }
 
-FFX_CACAO_Status FFX_CACAO_VkDraw(FFX_CACAO_VkContext* context, VkCommandBuffer cb, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView)
+// the inputs of the prepare normals pass are either generated or given by the normal buffer
+static inline bool cpuNormalsAvailable(const FFX_CACAO_CpuContext* context)
 {
-	if (context == NULL || cb == VK_NULL_HANDLE || proj == NULL)
-	{
-		return FFX_CACAO_STATUS_INVALID_POINTER;
-	}
-	context = getAlignedVkContextPointer(context);
+	return context->settings.generateNormals || context->descriptorSets[DS_PREPARE_NORMALS_FROM_INPUT_NORMALS].inputs[0].texture != NULL;
+}
 
+static void cpuUpdateConstants(FFX_CACAO_CpuContext* context, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView)
+{
 	FFX_CACAO_Settings *settings = &context->settings;
 	FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
-	VkDevice device = context->device;
-	VkDescriptorSet *ds = context->descriptorSets[context->currentConstantBuffer];
-	VkImage *tex = context->textures;
-	VkResult result;
-	BarrierList barrierList;
 
-	uint32_t curBuffer = context->currentConstantBuffer;
-	curBuffer = (curBuffer + 1) % NUM_BACK_BUFFERS;
-	context->currentConstantBuffer = curBuffer;
-#ifdef FFX_CACAO_ENABLE_PROFILING
+	uint32_t dirty = constantsCacheUpdate(&context->constantsCache, settings, bsi, NULL, NULL, proj, normalsToView);
+
+	// the cpu load counter sums the importance of every texel rather than of every ninth one
+	if ((dirty & CONSTANTS_DIRTY_SIZE) && !context->reference)
 	{
-		uint32_t collectBuffer = context->collectBuffer = (curBuffer + 1) % NUM_BACK_BUFFERS;
-		if (uint32_t numQueries = context->timestampQueries[collectBuffer].numTimestamps)
+		for (uint32_t i = 0; i < 4; ++i)
 		{
-			uint32_t offset = collectBuffer * NUM_TIMESTAMPS;
-			vkGetQueryPoolResults(device, context->timestampQueryPool, offset, numQueries, numQueries * sizeof(uint64_t), context->timestampQueries[collectBuffer].timings, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+			context->constantsCache.constants[i].LoadCounterAvgDiv = 1.0f / (float)(bsi->importanceMapWidth * bsi->importanceMapHeight * 255.0);
 		}
 	}
-#endif
-
-	beginDebugMarker(context, cb, "FidelityFX CACAO");
+}
 
-	// update constant buffer
+// fills stages with the stages run for the current settings, in order, and returns their number
+static uint32_t cpuGetStages(const FFX_CACAO_CpuContext* context, CpuStageID stages[NUM_CPU_STAGES])
+{
+	uint32_t numStages = 0;
 
-	for (uint32_t i = 0; i < 4; ++i)
+	stages[numStages++] = CPU_STAGE_PREPARE;
+	if (context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST)
 	{
-		VkDeviceMemory memory = context->constantBufferMemory[curBuffer][i];
-		void *data = NULL;
-		result = vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data);
-		FFX_CACAO_ASSERT(result == VK_SUCCESS);
-		FFX_CACAO_UpdateConstants((FFX_CACAO_Constants*)data, settings, bsi, proj, normalsToView);
-		FFX_CACAO_UpdatePerPassConstants((FFX_CACAO_Constants*)data, settings, bsi, i);
-		vkUnmapMemory(device, memory);
+		stages[numStages++] = CPU_STAGE_BASE_SSAO_PASS;
+		stages[numStages++] = CPU_STAGE_IMPORTANCE_MAP;
+	}
+	stages[numStages++] = CPU_STAGE_GENERATE_SSAO;
+	if (FFX_CACAO_CLAMP(context->settings.blurPassCount, 0, MAX_BLUR_PASSES))
+	{
+		stages[numStages++] = CPU_STAGE_EDGE_SENSITIVE_BLUR;
 	}
+	stages[numStages++] = context->useDownsampledSsao ? CPU_STAGE_BILATERAL_UPSAMPLE : CPU_STAGE_APPLY;
 
-#ifdef FFX_CACAO_ENABLE_PROFILING
-	uint32_t queryPoolOffset = curBuffer * NUM_TIMESTAMPS;
-	uint32_t numTimestamps = 0;
-	vkCmdResetQueryPool(cb, context->timestampQueryPool, queryPoolOffset, NUM_TIMESTAMPS);
-#define GET_TIMESTAMP(name) \
-		context->timestampQueries[curBuffer].timestamps[numTimestamps] = TIMESTAMP_##name; \
-		vkCmdWriteTimestamp(cb, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, context->timestampQueryPool, queryPoolOffset + numTimestamps++);
-#else
-#define GET_TIMESTAMP(name)
-#endif
-	
-	GET_TIMESTAMP(BEGIN)
+	return numStages;
+}
+
+static void cpuDrawStage(FFX_CACAO_CpuContext* context, CpuStageID stage)
+{
+	FFX_CACAO_BufferSizeInfo *bsi = &context->bufferSizeInfo;
 
-	barrierList.len = 0;
-	pushBarrier(&barrierList, tex[TEXTURE_DEINTERLEAVED_DEPTHS], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
-	pushBarrier(&barrierList, tex[TEXTURE_DEINTERLEAVED_NORMALS], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
-	pushBarrier(&barrierList, tex[TEXTURE_SSAO_BUFFER_PING], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
-	pushBarrier(&barrierList, tex[TEXTURE_SSAO_BUFFER_PONG], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
-	pushBarrier(&barrierList, tex[TEXTURE_IMPORTANCE_MAP], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
-	pushBarrier(&barrierList, tex[TEXTURE_IMPORTANCE_MAP_PONG], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
-	pushBarrier(&barrierList, context->loadCounter, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
-	vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, barrierList.len, barrierList.barriers);
+	uint32_t blurPassCount = context->settings.blurPassCount;
+	blurPassCount = FFX_CACAO_CLAMP(blurPassCount, 0, MAX_BLUR_PASSES);
 
-	// prepare depths, normals and mips
+	switch (stage)
 	{
-		beginDebugMarker(context, cb, "Prepare downsampled depths, normals and mips");
-
-		// clear load counter
-		computeDispatch(context, cb, DS_CLEAR_LOAD_COUNTER, CS_CLEAR_LOAD_COUNTER, 1, 1, 1);
+	// prepare depths, normals and mips
+	case CPU_STAGE_PREPARE: {
+		if (context->reference)
+		{
+			cpuComputeDispatch(context, DS_CLEAR_LOAD_COUNTER, CS_CLEAR_LOAD_COUNTER, 1, 1, 1);
+		}
 
 		switch (context->settings.qualityLevel)
 		{
@@ -3538,21 +10441,23 @@ FFX_CACAO_Status FFX_CACAO_VkDraw(FFX_CACAO_VkContext* context, VkCommandBuffer
 			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HALF_WIDTH, bsi->deinterleavedDepthBufferWidth);
 			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HALF_HEIGHT, bsi->deinterleavedDepthBufferHeight);
 			ComputeShaderID csPrepareDepthsHalf = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS_HALF : CS_PREPARE_NATIVE_DEPTHS_HALF;
-			computeDispatch(context, cb, DS_PREPARE_DEPTHS, csPrepareDepthsHalf, dispatchWidth, dispatchHeight, 1);
+			cpuComputeDispatch(context, DS_PREPARE_DEPTHS, csPrepareDepthsHalf, dispatchWidth, dispatchHeight, 1);
 			break;
 		}
 		case FFX_CACAO_QUALITY_LOW: {
-			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_WIDTH, bsi->deinterleavedDepthBufferWidth);
-			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_HEIGHT, bsi->deinterleavedDepthBufferHeight);
+			// one thread group per stripe, see cpuPrepareDepthsStripe, or the thread groups of the shader for the reference
+			uint32_t dispatchWidth = context->reference ? dispatchSize(FFX_CACAO_PREPARE_DEPTHS_WIDTH, bsi->deinterleavedDepthBufferWidth) : 1;
+			uint32_t dispatchHeight = dispatchSize(CPU_PREPARE_DEPTHS_STRIPE_HEIGHT, bsi->deinterleavedDepthBufferHeight);
 			ComputeShaderID csPrepareDepths = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS : CS_PREPARE_NATIVE_DEPTHS;
-			computeDispatch(context, cb, DS_PREPARE_DEPTHS, csPrepareDepths, dispatchWidth, dispatchHeight, 1);
+			cpuComputeDispatch(context, DS_PREPARE_DEPTHS, csPrepareDepths, dispatchWidth, dispatchHeight, 1);
 			break;
 		}
 		default: {
-			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH, bsi->deinterleavedDepthBufferWidth);
-			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_HEIGHT, bsi->deinterleavedDepthBufferHeight);
+			// one thread group per stripe, see cpuPrepareDepthsStripe, or the thread groups of the shader for the reference
+			uint32_t dispatchWidth = context->reference ? dispatchSize(FFX_CACAO_PREPARE_DEPTHS_AND_MIPS_WIDTH, bsi->deinterleavedDepthBufferWidth) : 1;
+			uint32_t dispatchHeight = dispatchSize(CPU_PREPARE_DEPTHS_STRIPE_HEIGHT, bsi->deinterleavedDepthBufferHeight);
 			ComputeShaderID csPrepareDepthsAndMips = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_DEPTHS_AND_MIPS : CS_PREPARE_NATIVE_DEPTHS_AND_MIPS;
-			computeDispatch(context, cb, DS_PREPARE_DEPTHS_MIPS, csPrepareDepthsAndMips, dispatchWidth, dispatchHeight, 1);
+			cpuComputeDispatch(context, DS_PREPARE_DEPTHS_MIPS, csPrepareDepthsAndMips, dispatchWidth, dispatchHeight, 1);
 			break;
 		}
 		}
@@ -3562,90 +10467,64 @@ FFX_CACAO_Status FFX_CACAO_VkDraw(FFX_CACAO_VkContext* context, VkCommandBuffer
 			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_PREPARE_NORMALS_WIDTH, bsi->ssaoBufferWidth);
 			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_PREPARE_NORMALS_HEIGHT, bsi->ssaoBufferHeight);
 			ComputeShaderID csPrepareNormals = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_NORMALS : CS_PREPARE_NATIVE_NORMALS;
-			computeDispatch(context, cb, DS_PREPARE_NORMALS, csPrepareNormals, dispatchWidth, dispatchHeight, 1);
+			cpuComputeDispatch(context, DS_PREPARE_NORMALS, csPrepareNormals, dispatchWidth, dispatchHeight, 1);
 		}
 		else
 		{
 			uint32_t dispatchWidth = dispatchSize(PREPARE_NORMALS_FROM_INPUT_NORMALS_WIDTH, bsi->ssaoBufferWidth);
 			uint32_t dispatchHeight = dispatchSize(PREPARE_NORMALS_FROM_INPUT_NORMALS_HEIGHT, bsi->ssaoBufferHeight);
 			ComputeShaderID csPrepareNormalsFromInputNormals = context->useDownsampledSsao ? CS_PREPARE_DOWNSAMPLED_NORMALS_FROM_INPUT_NORMALS : CS_PREPARE_NATIVE_NORMALS_FROM_INPUT_NORMALS;
-			computeDispatch(context, cb, DS_PREPARE_NORMALS_FROM_INPUT_NORMALS, csPrepareNormalsFromInputNormals, dispatchWidth, dispatchHeight, 1);
+			cpuComputeDispatch(context, DS_PREPARE_NORMALS_FROM_INPUT_NORMALS, csPrepareNormalsFromInputNormals, dispatchWidth, dispatchHeight, 1);
 		}
-
-		endDebugMarker(context, cb);
-		GET_TIMESTAMP(PREPARE)
+		break;
 	}
 
-	barrierList.len = 0;
-	pushBarrier(&barrierList, tex[TEXTURE_DEINTERLEAVED_DEPTHS], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
-	pushBarrier(&barrierList, tex[TEXTURE_DEINTERLEAVED_NORMALS], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
-	pushBarrier(&barrierList, context->loadCounter, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT);
-	vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, barrierList.len, barrierList.barriers);
-
 	// base pass for highest quality setting
-	if (context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST)
-	{
-		beginDebugMarker(context, cb, "Generate High Quality Base Pass");
+	case CPU_STAGE_BASE_SSAO_PASS: {
+		uint32_t dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_WIDTH, bsi->ssaoBufferWidth);
+		uint32_t dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_HEIGHT, bsi->ssaoBufferHeight);
 
-		// SSAO
+		for (int pass = 0; pass < 4; ++pass)
 		{
-			beginDebugMarker(context, cb, "Base SSAO");
-
-			uint32_t dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_WIDTH, bsi->ssaoBufferWidth);
-			uint32_t dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_HEIGHT, bsi->ssaoBufferHeight);
-
-			for (int pass = 0; pass < 4; ++pass)
-			{
-				computeDispatch(context, cb, (DescriptorSetID)(DS_GENERATE_ADAPTIVE_BASE_0 + pass), CS_GENERATE_Q3_BASE, dispatchWidth, dispatchHeight, 1);
-			}
-
-			endDebugMarker(context, cb);
+			cpuComputeDispatch(context, (DescriptorSetID)(DS_GENERATE_ADAPTIVE_BASE_0 + pass), CS_GENERATE_Q3_BASE, dispatchWidth, dispatchHeight, 1);
 		}
+		break;
+	}
 
-		GET_TIMESTAMP(BASE_SSAO_PASS)
-
-		barrierList.len = 0;
-		pushBarrier(&barrierList, tex[TEXTURE_SSAO_BUFFER_PONG], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
-		vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, barrierList.len, barrierList.barriers);
-
-		// generate importance map
+	case CPU_STAGE_IMPORTANCE_MAP: {
+		if (context->reference)
 		{
-			beginDebugMarker(context, cb, "Importance Map");
-
 			uint32_t dispatchWidth = dispatchSize(IMPORTANCE_MAP_WIDTH, bsi->importanceMapWidth);
 			uint32_t dispatchHeight = dispatchSize(IMPORTANCE_MAP_HEIGHT, bsi->importanceMapHeight);
 
-			computeDispatch(context, cb, DS_GENERATE_IMPORTANCE_MAP, CS_GENERATE_IMPORTANCE_MAP, dispatchWidth, dispatchHeight, 1);
-
-			barrierList.len = 0;
-			pushBarrier(&barrierList, tex[TEXTURE_IMPORTANCE_MAP], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
-			vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, barrierList.len, barrierList.barriers);
-
-			computeDispatch(context, cb, DS_POSTPROCESS_IMPORTANCE_MAP_A, CS_POSTPROCESS_IMPORTANCE_MAP_A, dispatchWidth, dispatchHeight, 1);
-
-			barrierList.len = 0;
-			pushBarrier(&barrierList, tex[TEXTURE_IMPORTANCE_MAP], VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT);
-			pushBarrier(&barrierList, tex[TEXTURE_IMPORTANCE_MAP_PONG], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
-			vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, barrierList.len, barrierList.barriers);
+			cpuComputeDispatch(context, DS_GENERATE_IMPORTANCE_MAP, CS_GENERATE_IMPORTANCE_MAP, dispatchWidth, dispatchHeight, 1);
+			cpuComputeDispatch(context, DS_POSTPROCESS_IMPORTANCE_MAP_A, CS_POSTPROCESS_IMPORTANCE_MAP_A, dispatchWidth, dispatchHeight, 1);
+			cpuComputeDispatch(context, DS_POSTPROCESS_IMPORTANCE_MAP_B, CS_POSTPROCESS_IMPORTANCE_MAP_B, dispatchWidth, dispatchHeight, 1);
+			break;
+		}
 
-			computeDispatch(context, cb, DS_POSTPROCESS_IMPORTANCE_MAP_B, CS_POSTPROCESS_IMPORTANCE_MAP_B, dispatchWidth, dispatchHeight, 1);
+		// generate and postprocess the importance map in one pass, then reduce the load counters of the tasks
+		uint32_t dispatchWidth = dispatchSize(CPU_IMPORTANCE_MAP_TILE_WIDTH, bsi->importanceMapWidth);
+		uint32_t dispatchHeight = dispatchSize(CPU_IMPORTANCE_MAP_TILE_HEIGHT, bsi->importanceMapHeight);
 
-			endDebugMarker(context, cb);
+		CpuScheduler *scheduler = context->scheduler;
+		for (uint32_t i = 0; i < scheduler->jobSystem.numTasks; ++i)
+		{
+			scheduler->groupShared[i].importanceMap.loadCounter = 0;
 		}
 
-		endDebugMarker(context, cb);
-		GET_TIMESTAMP(IMPORTANCE_MAP)
+		cpuComputeDispatch(context, DS_GENERATE_IMPORTANCE_MAP, CS_GENERATE_IMPORTANCE_MAP, dispatchWidth, dispatchHeight, 1);
 
-		barrierList.len = 0;
-		pushBarrier(&barrierList, tex[TEXTURE_IMPORTANCE_MAP], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
-		pushBarrier(&barrierList, context->loadCounter, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL, VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_READ_BIT);
-		vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, barrierList.len, barrierList.barriers);
+		context->loadCounter = 0;
+		for (uint32_t i = 0; i < scheduler->jobSystem.numTasks; ++i)
+		{
+			context->loadCounter += scheduler->groupShared[i].importanceMap.loadCounter;
+		}
+		break;
 	}
 
 	// main ssao generation
-	{
-		beginDebugMarker(context, cb, "Generate SSAO");
-
+	case CPU_STAGE_GENERATE_SSAO: {
 		ComputeShaderID generateCS = (ComputeShaderID)(CS_GENERATE_Q0 + FFX_CACAO_MAX(0, context->settings.qualityLevel - 1));
 
 		uint32_t dispatchWidth, dispatchHeight, dispatchDepth;
@@ -3662,6 +10541,7 @@ FFX_CACAO_Status FFX_CACAO_VkDraw(FFX_CACAO_VkContext* context, VkCommandBuffer
 			break;
 		case FFX_CACAO_QUALITY_HIGH:
 		case FFX_CACAO_QUALITY_HIGHEST:
+		default:
 			dispatchWidth = dispatchSize(FFX_CACAO_GENERATE_WIDTH, bsi->ssaoBufferWidth);
 			dispatchHeight = dispatchSize(FFX_CACAO_GENERATE_HEIGHT, bsi->ssaoBufferHeight);
 			dispatchDepth = 1;
@@ -3678,28 +10558,15 @@ FFX_CACAO_Status FFX_CACAO_VkDraw(FFX_CACAO_VkContext* context, VkCommandBuffer
 			DescriptorSetID descriptorSetID = context->settings.qualityLevel == FFX_CACAO_QUALITY_HIGHEST ? DS_GENERATE_ADAPTIVE_0 : DS_GENERATE_0;
 			descriptorSetID = (DescriptorSetID)(descriptorSetID + pass);
 
-			computeDispatch(context, cb, descriptorSetID, generateCS, dispatchWidth, dispatchHeight, dispatchDepth);
+			cpuComputeDispatch(context, descriptorSetID, generateCS, dispatchWidth, dispatchHeight, dispatchDepth);
 		}
-
-		endDebugMarker(context, cb);
-		GET_TIMESTAMP(GENERATE_SSAO)
+		break;
 	}
 
-	uint32_t blurPassCount = context->settings.blurPassCount;
-	blurPassCount = FFX_CACAO_CLAMP(blurPassCount, 0, MAX_BLUR_PASSES);
-
 	// de-interleaved blur
-	if (blurPassCount)
-	{
-		barrierList.len = 0;
-		pushBarrier(&barrierList, tex[TEXTURE_SSAO_BUFFER_PING], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
-		pushBarrier(&barrierList, tex[TEXTURE_SSAO_BUFFER_PONG], VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
-		vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, barrierList.len, barrierList.barriers);
-
-		beginDebugMarker(context, cb, "Deinterleaved Blur");
-
-		uint32_t w = 4 * FFX_CACAO_BLUR_WIDTH - 2 * blurPassCount;
-		uint32_t h = 3 * FFX_CACAO_BLUR_HEIGHT - 2 * blurPassCount;
+	case CPU_STAGE_EDGE_SENSITIVE_BLUR: {
+		uint32_t w = (context->reference ? 4 * FFX_CACAO_BLUR_WIDTH : CPU_BLUR_TILE_WIDTH) - 2 * blurPassCount;
+		uint32_t h = (context->reference ? 3 * FFX_CACAO_BLUR_HEIGHT : CPU_BLUR_TILE_HEIGHT) - 2 * blurPassCount;
 		uint32_t dispatchWidth = dispatchSize(w, bsi->ssaoBufferWidth);
 		uint32_t dispatchHeight = dispatchSize(h, bsi->ssaoBufferHeight);
 
@@ -3712,32 +10579,16 @@ FFX_CACAO_Status FFX_CACAO_VkDraw(FFX_CACAO_VkContext* context, VkCommandBuffer
 
 			ComputeShaderID blurShaderID = (ComputeShaderID)(CS_EDGE_SENSITIVE_BLUR_1 + blurPassCount - 1);
 			DescriptorSetID descriptorSetID = (DescriptorSetID)(DS_EDGE_SENSITIVE_BLUR_0 + pass);
-			computeDispatch(context, cb, descriptorSetID, blurShaderID, dispatchWidth, dispatchHeight, 1);
+			cpuComputeDispatch(context, descriptorSetID, blurShaderID, dispatchWidth, dispatchHeight, 1);
 		}
-
-		endDebugMarker(context, cb);
-		GET_TIMESTAMP(EDGE_SENSITIVE_BLUR)
-
-		barrierList.len = 0;
-		pushBarrier(&barrierList, tex[TEXTURE_SSAO_BUFFER_PONG], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
-		pushBarrier(&barrierList, context->output, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
-		vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, barrierList.len, barrierList.barriers);
-	}
-	else
-	{
-		barrierList.len = 0;
-		pushBarrier(&barrierList, tex[TEXTURE_SSAO_BUFFER_PING], VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
-		pushBarrier(&barrierList, context->output, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT);
-		vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, barrierList.len, barrierList.barriers);
+		break;
 	}
 
-
-	if (context->useDownsampledSsao)
-	{
-		beginDebugMarker(context, cb, "Bilateral Upsample");
-
-		uint32_t dispatchWidth = dispatchSize(2 * FFX_CACAO_BILATERAL_UPSCALE_WIDTH, bsi->inputOutputBufferWidth);
-		uint32_t dispatchHeight = dispatchSize(2 * FFX_CACAO_BILATERAL_UPSCALE_HEIGHT, bsi->inputOutputBufferHeight);
+	case CPU_STAGE_BILATERAL_UPSAMPLE: {
+		uint32_t groupWidth = context->reference ? FFX_CACAO_BILATERAL_UPSCALE_WIDTH : CPU_BILATERAL_UPSCALE_WIDTH;
+		uint32_t groupHeight = context->reference ? FFX_CACAO_BILATERAL_UPSCALE_HEIGHT : CPU_BILATERAL_UPSCALE_HEIGHT;
+		uint32_t dispatchWidth = dispatchSize(2 * groupWidth, bsi->inputOutputBufferWidth);
+		uint32_t dispatchHeight = dispatchSize(2 * groupHeight, bsi->inputOutputBufferHeight);
 
 		DescriptorSetID descriptorSetID = blurPassCount ? DS_BILATERAL_UPSAMPLE_PONG : DS_BILATERAL_UPSAMPLE_PING;
 		ComputeShaderID upscaler;
@@ -3752,19 +10603,16 @@ FFX_CACAO_Status FFX_CACAO_VkDraw(FFX_CACAO_VkContext* context, VkCommandBuffer
 			break;
 		case FFX_CACAO_QUALITY_HIGH:
 		case FFX_CACAO_QUALITY_HIGHEST:
+		default:
 			upscaler = CS_UPSCALE_BILATERAL_5X5_SMART;
 			break;
 		}
 
-		computeDispatch(context, cb, descriptorSetID, upscaler, dispatchWidth, dispatchHeight, 1);
-
-		endDebugMarker(context, cb);
-		GET_TIMESTAMP(BILATERAL_UPSAMPLE)
+		cpuComputeDispatch(context, descriptorSetID, upscaler, dispatchWidth, dispatchHeight, 1);
+		break;
 	}
-	else
-	{
-		beginDebugMarker(context, cb, "Reinterleave");
 
+	case CPU_STAGE_APPLY: {
 		uint32_t dispatchWidth = dispatchSize(FFX_CACAO_APPLY_WIDTH, bsi->inputOutputBufferWidth);
 		uint32_t dispatchHeight = dispatchSize(FFX_CACAO_APPLY_HEIGHT, bsi->inputOutputBufferHeight);
 
@@ -3773,62 +10621,358 @@ FFX_CACAO_Status FFX_CACAO_VkDraw(FFX_CACAO_VkContext* context, VkCommandBuffer
 		switch (context->settings.qualityLevel)
 		{
 		case FFX_CACAO_QUALITY_LOWEST:
-			computeDispatch(context, cb, descriptorSetID, CS_NON_SMART_HALF_APPLY, dispatchWidth, dispatchHeight, 1);
+			cpuComputeDispatch(context, descriptorSetID, CS_NON_SMART_HALF_APPLY, dispatchWidth, dispatchHeight, 1);
 			break;
 		case FFX_CACAO_QUALITY_LOW:
-			computeDispatch(context, cb, descriptorSetID, CS_NON_SMART_APPLY, dispatchWidth, dispatchHeight, 1);
+			cpuComputeDispatch(context, descriptorSetID, CS_NON_SMART_APPLY, dispatchWidth, dispatchHeight, 1);
 			break;
 		default:
-			computeDispatch(context, cb, descriptorSetID, CS_APPLY, dispatchWidth, dispatchHeight, 1);
+			cpuComputeDispatch(context, descriptorSetID, CS_APPLY, dispatchWidth, dispatchHeight, 1);
 			break;
 		}
+		break;
+	}
 
-		endDebugMarker(context, cb);
-		GET_TIMESTAMP(APPLY)
+	default:
+		FFX_CACAO_ASSERT(0);
+		break;
 	}
-	
-	endDebugMarker(context, cb);
+}
 
-	barrierList.len = 0;
-	pushBarrier(&barrierList, context->output, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
-	vkCmdPipelineBarrier(cb, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, barrierList.len, barrierList.barriers);
+FFX_CACAO_Status FFX_CACAO_CpuDraw(FFX_CACAO_CpuContext* context, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView)
+{
+	if (context == NULL || proj == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedCpuContextPointer(context);
+
+	if (!cpuNormalsAvailable(context))
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+
+	// update constant buffer
+	cpuUpdateConstants(context, proj, normalsToView);
+
+	CpuStageID stages[NUM_CPU_STAGES];
+	uint32_t numStages = cpuGetStages(context, stages);
 
 #ifdef FFX_CACAO_ENABLE_PROFILING
-	context->timestampQueries[curBuffer].numTimestamps = numTimestamps;
+	uint32_t numTimestamps = 0;
+#define GET_TIMESTAMP(timestamp_id) \
+		context->timestampQueries.timestamps[numTimestamps] = (timestamp_id); \
+		context->timestampQueries.timings[numTimestamps++] = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+#else
+#define GET_TIMESTAMP(timestamp_id)
+#endif
+
+	GET_TIMESTAMP(TIMESTAMP_BEGIN)
+
+	for (uint32_t i = 0; i < numStages; ++i)
+	{
+		cpuDrawStage(context, stages[i]);
+
+		GET_TIMESTAMP((TimestampID)(TIMESTAMP_PREPARE + stages[i]))
+	}
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	context->timestampQueries.numTimestamps = numTimestamps;
 #endif
 
+#undef GET_TIMESTAMP
+
+	return FFX_CACAO_STATUS_OK;
+}
+
+static void cpuCopyTexture(CpuTexture *dst, const CpuTexture *src)
+{
+	for (uint32_t slice = 0; slice < src->arraySize; ++slice)
+	{
+		for (uint32_t mip = 0; mip < src->numMips; ++mip)
+		{
+			for (uint32_t y = 0; y < src->heights[mip]; ++y)
+			{
+				memcpy(cpuTexelAddress(dst, 0, y, slice, mip), cpuTexelAddress(src, 0, y, slice, mip), src->widths[mip] * src->texelSize);
+			}
+		}
+	}
+}
+
+// accumulates the differences of every texel of a texture, the difference of a texel being the largest absolute
+// difference of any of its channels. a NaN differs infinitely from any number
+static void cpuCompareTexture(const CpuTexture *texture, const CpuTexture *reference, FFX_CACAO_CpuStageDifference *difference, double *errorSum)
+{
+	for (uint32_t slice = 0; slice < texture->arraySize; ++slice)
+	{
+		for (uint32_t mip = 0; mip < texture->numMips; ++mip)
+		{
+			for (uint32_t y = 0; y < texture->heights[mip]; ++y)
+			{
+				for (uint32_t x = 0; x < texture->widths[mip]; ++x)
+				{
+					CpuFloat4 a = cpuDecodeTexel(texture->format, cpuTexelAddress(texture, x, y, slice, mip));
+					CpuFloat4 b = cpuDecodeTexel(reference->format, cpuTexelAddress(reference, x, y, slice, mip));
+					float valuesA[4] = { a.x, a.y, a.z, a.w };
+					float valuesB[4] = { b.x, b.y, b.z, b.w };
+
+					float error = 0.0f;
+					for (uint32_t i = 0; i < 4; ++i)
+					{
+						float channelError = fabsf(valuesA[i] - valuesB[i]);
+						if (isnan(valuesA[i]) || isnan(valuesB[i]))
+						{
+							channelError = isnan(valuesA[i]) && isnan(valuesB[i]) ? 0.0f : INFINITY;
+						}
+						error = FFX_CACAO_MAX(error, channelError);
+					}
+
+					difference->maxError = FFX_CACAO_MAX(difference->maxError, error);
+					difference->numTexels += 1;
+					difference->numDifferentTexels += error != 0.0f ? 1 : 0;
+					*errorSum += error;
+				}
+			}
+		}
+	}
+}
+
+static float cpuAverageImportance(const FFX_CACAO_CpuContext* context)
+{
+	if (context->settings.qualityLevel != FFX_CACAO_QUALITY_HIGHEST)
+	{
+		return 0.0f;
+	}
+	return (float)context->loadCounter * context->constantsCache.constants[0].LoadCounterAvgDiv;
+}
+
+FFX_CACAO_Status FFX_CACAO_CpuDrawDifferential(FFX_CACAO_CpuContext* context, FFX_CACAO_CpuContext* reference, const FFX_CACAO_Matrix4x4* proj, const FFX_CACAO_Matrix4x4* normalsToView, FFX_CACAO_CpuDifferentialReport* report)
+{
+	if (context == NULL || reference == NULL || proj == NULL || report == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	context = getAlignedCpuContextPointer(context);
+	reference = getAlignedCpuContextPointer(reference);
+
+	if (reference->useDownsampledSsao != context->useDownsampledSsao || memcmp(&reference->bufferSizeInfo, &context->bufferSizeInfo, sizeof(FFX_CACAO_BufferSizeInfo)) != 0)
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+
+	if (memcmp(&reference->settings, &context->settings, sizeof(FFX_CACAO_Settings)) != 0)
+	{
+		memcpy(&reference->settings, &context->settings, sizeof(FFX_CACAO_Settings));
+		constantsCacheInvalidate(&reference->constantsCache, CONSTANTS_DIRTY_SETTINGS);
+	}
+
+	if (!cpuNormalsAvailable(context) || !cpuNormalsAvailable(reference))
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+
+	cpuUpdateConstants(context, proj, normalsToView);
+	cpuUpdateConstants(reference, proj, normalsToView);
+
+	CpuStageID stages[NUM_CPU_STAGES];
+	uint32_t numStages = cpuGetStages(context, stages);
+	FFX_CACAO_ASSERT(numStages <= FFX_CACAO_ARRAY_SIZE(report->stages));
+
+	memset(report, 0, sizeof(*report));
+	report->numStages = numStages;
+
+	for (uint32_t i = 0; i < numStages; ++i)
+	{
+		// both contexts start each stage from the textures the context left, so that the differences of a stage are its own.
+		// the load counters are not copied, as the context and the reference may count differently
+		for (uint32_t j = 0; j < NUM_TEXTURES; ++j)
+		{
+			cpuCopyTexture(&reference->textures[j], &context->textures[j]);
+		}
+		cpuCopyTexture(&reference->output, &context->output);
+
+		context->writtenTextures = 0;
+		cpuDrawStage(context, stages[i]);
+		cpuDrawStage(reference, stages[i]);
+
+		FFX_CACAO_CpuStageDifference *difference = &report->stages[i];
+		difference->label = CPU_STAGE_NAMES[stages[i]];
+
+		double errorSum = 0.0;
+		for (uint32_t j = 0; j < NUM_TEXTURES; ++j)
+		{
+			if (context->writtenTextures & (1u << j))
+			{
+				cpuCompareTexture(&context->textures[j], &reference->textures[j], difference, &errorSum);
+			}
+		}
+		if (context->writtenTextures & (1u << NUM_TEXTURES))
+		{
+			cpuCompareTexture(&context->output, &reference->output, difference, &errorSum);
+		}
+		difference->meanError = difference->numTexels ? (float)(errorSum / difference->numTexels) : 0.0f;
+	}
+
+	report->averageImportance = cpuAverageImportance(context);
+	report->referenceAverageImportance = cpuAverageImportance(reference);
+
 	return FFX_CACAO_STATUS_OK;
 }
 
 #ifdef FFX_CACAO_ENABLE_PROFILING
-FFX_CACAO_Status FFX_CACAO_VkGetDetailedTimings(FFX_CACAO_VkContext* context, FFX_CACAO_DetailedTiming* timings)
+FFX_CACAO_Status FFX_CACAO_CpuGetDetailedTimings(FFX_CACAO_CpuContext* context, FFX_CACAO_DetailedTiming* timings)
 {
 	if (context == NULL || timings == NULL)
 	{
 		return FFX_CACAO_STATUS_INVALID_POINTER;
 	}
-	context = getAlignedVkContextPointer(context);
+	context = getAlignedCpuContextPointer(context);
 
-	uint32_t bufferIndex = context->collectBuffer;
-	uint32_t numTimestamps = context->timestampQueries[bufferIndex].numTimestamps;
-	uint64_t prevTime = context->timestampQueries[bufferIndex].timings[0];
+	uint32_t numTimestamps = context->timestampQueries.numTimestamps;
+	uint64_t prevTime = context->timestampQueries.timings[0];
 	for (uint32_t i = 1; i < numTimestamps; ++i)
 	{
-		TimestampID timestampID = context->timestampQueries[bufferIndex].timestamps[i];
+		TimestampID timestampID = context->timestampQueries.timestamps[i];
 		timings->timestamps[i].label = TIMESTAMP_NAMES[timestampID];
-		uint64_t time = context->timestampQueries[bufferIndex].timings[i];
+		uint64_t time = context->timestampQueries.timings[i];
 		timings->timestamps[i].ticks = time - prevTime;
 		prevTime = time;
 	}
 	timings->timestamps[0].label = "FFX_CACAO_TOTAL";
-	timings->timestamps[0].ticks = prevTime - context->timestampQueries[bufferIndex].timings[0];
+	timings->timestamps[0].ticks = prevTime - context->timestampQueries.timings[0];
 	timings->numTimestamps = numTimestamps;
-	
+
 	return FFX_CACAO_STATUS_OK;
 }
 #endif
 #endif
 
+#ifdef FFX_CACAO_ENABLE_PROFILING
+size_t FFX_CACAO_QualityControllerGetSize()
+{
+	return sizeof(FFX_CACAO_QualityController);
+}
+
+FFX_CACAO_Status FFX_CACAO_QualityControllerInit(FFX_CACAO_QualityController* controller, const FFX_CACAO_QualityControllerCreateInfo* info)
+{
+	if (controller == NULL || info == NULL || info->presets == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+
+	float smoothing = info->smoothing ? info->smoothing : QUALITY_CONTROLLER_DEFAULT_SMOOTHING;
+	float downgradeThreshold = info->downgradeThreshold ? info->downgradeThreshold : QUALITY_CONTROLLER_DEFAULT_DOWNGRADE_THRESHOLD;
+	float upgradeThreshold = info->upgradeThreshold ? info->upgradeThreshold : QUALITY_CONTROLLER_DEFAULT_UPGRADE_THRESHOLD;
+	// an upgrade threshold above the downgrade threshold would move back and forth between two presets
+	if (info->numPresets == 0 || info->numPresets > FFX_CACAO_QUALITY_CONTROLLER_MAX_PRESETS || info->initialPreset >= info->numPresets
+		|| !(info->budgetMilliseconds > 0.0f) || !(info->millisecondsPerTick > 0.0f) || !(smoothing > 0.0f && smoothing <= 1.0f)
+		|| !(upgradeThreshold > 0.0f && upgradeThreshold <= downgradeThreshold))
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+
+	memset(controller, 0, sizeof(*controller));
+	memcpy(controller->presets, info->presets, info->numPresets * sizeof(info->presets[0]));
+	controller->numPresets = info->numPresets;
+	controller->budgetMilliseconds = info->budgetMilliseconds;
+	controller->millisecondsPerTick = info->millisecondsPerTick;
+	controller->smoothing = smoothing;
+	controller->downgradeThreshold = downgradeThreshold;
+	controller->upgradeThreshold = upgradeThreshold;
+	controller->holdFrames = info->holdFrames ? info->holdFrames : QUALITY_CONTROLLER_DEFAULT_HOLD_FRAMES;
+	controller->latencyFrames = info->latencyFrames;
+	controller->callback = info->callback;
+	controller->userData = info->userData;
+	controller->preset = info->initialPreset;
+	controller->previousPreset = QUALITY_CONTROLLER_NO_PRESET;
+
+	return FFX_CACAO_STATUS_OK;
+}
+
+FFX_CACAO_Status FFX_CACAO_QualityControllerUpdate(FFX_CACAO_QualityController* controller, const FFX_CACAO_DetailedTiming* timings, uint32_t* preset)
+{
+	if (controller == NULL || timings == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+
+	if (timings->numTimestamps)
+	{
+		++controller->frame;
+		if (controller->framesToDiscard)
+		{
+			--controller->framesToDiscard;
+		}
+		else
+		{
+			qualityControllerSmooth(controller, timings);
+		}
+	}
+
+	if (controller->numSamples >= controller->holdFrames)
+	{
+		uint32_t current = controller->preset;
+		float milliseconds = controller->smoothedTicks[0] * controller->millisecondsPerTick;
+		if (controller->previousPreset != QUALITY_CONTROLLER_NO_PRESET)
+		{
+			qualityControllerLearnCostRatio(controller, milliseconds);
+		}
+
+		if (milliseconds > controller->downgradeThreshold * controller->budgetMilliseconds && current + 1 < controller->numPresets)
+		{
+			float ratio = controller->costRatios[current];
+			qualityControllerChangePreset(controller, current + 1, milliseconds, ratio ? milliseconds / ratio : milliseconds);
+		}
+		else if (current > 0)
+		{
+			// without a measured ratio the more expensive preset is tried, and its ratio is measured for next time
+			float ratio = controller->costRatios[current - 1];
+			float predictedMilliseconds = ratio ? milliseconds * ratio : milliseconds;
+			if (predictedMilliseconds < controller->upgradeThreshold * controller->budgetMilliseconds)
+			{
+				qualityControllerChangePreset(controller, current - 1, milliseconds, predictedMilliseconds);
+			}
+		}
+	}
+
+	if (preset)
+	{
+		*preset = controller->preset;
+	}
+	return FFX_CACAO_STATUS_OK;
+}
+
+FFX_CACAO_Status FFX_CACAO_QualityControllerSetBudget(FFX_CACAO_QualityController* controller, float budgetMilliseconds)
+{
+	if (controller == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	if (!(budgetMilliseconds > 0.0f))
+	{
+		return FFX_CACAO_STATUS_INVALID_ARGUMENT;
+	}
+	controller->budgetMilliseconds = budgetMilliseconds;
+	return FFX_CACAO_STATUS_OK;
+}
+
+FFX_CACAO_Status FFX_CACAO_QualityControllerGetSmoothedTimings(FFX_CACAO_QualityController* controller, FFX_CACAO_DetailedTiming* timings)
+{
+	if (controller == NULL || timings == NULL)
+	{
+		return FFX_CACAO_STATUS_INVALID_POINTER;
+	}
+	uint32_t numStages = controller->numSamples ? controller->numStages : 0;
+	for (uint32_t i = 0; i < numStages; ++i)
+	{
+		timings->timestamps[i].label = controller->labels[i];
+		timings->timestamps[i].ticks = (uint64_t)(controller->smoothedTicks[i] + 0.5f);
+	}
+	timings->numTimestamps = numStages;
+	return FFX_CACAO_STATUS_OK;
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
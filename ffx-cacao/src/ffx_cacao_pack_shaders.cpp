@@ -0,0 +1,245 @@
+// AMD Sample sample code
+//
+// Copyright(c) 2021 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Packs the SPIR-V modules built by build_shaders_spirv.bat, or the DXIL shaders built by build_shaders_dxil.bat, into a
+// compressed archive, written as a header included by ffx_cacao_impl.cpp. Each module is compressed separately, so that
+// FFX CACAO can decompress only the modules of the pipelines it creates.
+//
+// usage: ffx_cacao_pack_shaders <output header> <suffix> <module>...
+//
+// The archive is named CACAOShaders<suffix>. Each module CACAO<Name>_<bits>.spv or CACAO<Name>.cso gets a table
+// CS<Name><suffix> holding its offset in the archive, its compressed size and its size, in bytes. Every module is
+// decompressed again with the decompressShader of FFX CACAO, and the packer fails if it does not round trip.
+//
+// The packer is a single file with no dependencies other than ffx_cacao_shader_archive.h. It is built by the
+// FFX_CACAO_PackShaders target of the Vulkan and D3D12 samples, or by hand, e.g. cl /O2 /EHsc ffx_cacao_pack_shaders.cpp
+//
+// The compression is a byte oriented LZ77 in the style of an LZ4 block, a sequence of
+//   token             literal length in the high 4 bits, match length - 4 in the low 4 bits
+//   [literal length]  if the length in the token is 15, bytes of 255 followed by a final byte below 255, all added to it
+//   literals
+//   offset            2 bytes, little endian, distance back from the current output position to the match
+//   [match length]    extended like the literal length
+// where the last sequence of a module ends after its literals. It is decompressed by decompressShader in
+// ffx_cacao_impl.cpp.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "ffx_cacao_shader_archive.h"
+
+#define MIN_MATCH   4
+#define MAX_OFFSET  65535
+#define HASH_BITS   16
+#define MAX_CHAIN   256
+
+static void writeLength(std::vector<uint8_t>& out, size_t length)
+{
+	for (; length >= 255; length -= 255)
+	{
+		out.push_back(255);
+	}
+	out.push_back((uint8_t)length);
+}
+
+static void writeSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t numLiterals, size_t offset, size_t matchLength)
+{
+	size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+	out.push_back((uint8_t)(((numLiterals < 15 ? numLiterals : 15) << 4) | (matchCode < 15 ? matchCode : 15)));
+	if (numLiterals >= 15)
+	{
+		writeLength(out, numLiterals - 15);
+	}
+	out.insert(out.end(), literals, literals + numLiterals);
+	if (matchLength)
+	{
+		out.push_back((uint8_t)offset);
+		out.push_back((uint8_t)(offset >> 8));
+		if (matchCode >= 15)
+		{
+			writeLength(out, matchCode - 15);
+		}
+	}
+}
+
+static inline uint32_t hash(const uint8_t* p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// greedy compression with hash chains, which finds most of the repetition of SPIR-V at a fraction of a second per module
+static std::vector<uint8_t> compress(const std::vector<uint8_t>& in)
+{
+	std::vector<uint8_t> out;
+	std::vector<int32_t> head(1 << HASH_BITS, -1);
+	std::vector<int32_t> chain(in.size(), -1);
+
+	size_t size = in.size();
+	size_t literalStart = 0;
+	size_t pos = 0;
+	while (pos + MIN_MATCH <= size)
+	{
+		uint32_t h = hash(&in[pos]);
+		size_t bestLength = 0;
+		size_t bestOffset = 0;
+		int32_t candidate = head[h];
+		for (uint32_t i = 0; candidate >= 0 && pos - candidate <= MAX_OFFSET && i < MAX_CHAIN; ++i, candidate = chain[candidate])
+		{
+			size_t length = 0;
+			while (pos + length < size && in[candidate + length] == in[pos + length])
+			{
+				++length;
+			}
+			if (length > bestLength)
+			{
+				bestLength = length;
+				bestOffset = pos - candidate;
+			}
+		}
+
+		if (bestLength < MIN_MATCH)
+		{
+			chain[pos] = head[h];
+			head[h] = (int32_t)pos;
+			++pos;
+			continue;
+		}
+
+		writeSequence(out, &in[literalStart], pos - literalStart, bestOffset, bestLength);
+		for (size_t end = pos + bestLength; pos < end; ++pos)
+		{
+			if (pos + MIN_MATCH <= size)
+			{
+				h = hash(&in[pos]);
+				chain[pos] = head[h];
+				head[h] = (int32_t)pos;
+			}
+		}
+		literalStart = pos;
+	}
+	writeSequence(out, in.data() + literalStart, size - literalStart, 0, 0);
+	return out;
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>& data)
+{
+	FILE* file = fopen(path, "rb");
+	if (!file)
+	{
+		return false;
+	}
+	uint8_t buffer[4096];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		data.insert(data.end(), buffer, buffer + read);
+	}
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+// CACAO<Name>_<bits>.spv or CACAO<Name>.cso -> <Name>
+static std::string moduleName(const char* path)
+{
+	std::string name = path;
+	size_t slash = name.find_last_of("/\\");
+	if (slash != std::string::npos)
+	{
+		name = name.substr(slash + 1);
+	}
+	name = name.substr(0, name.find_last_of('.'));
+	if (name.compare(0, 5, "CACAO") == 0)
+	{
+		name = name.substr(5);
+	}
+	size_t underscore = name.find_last_of('_');
+	if (underscore != std::string::npos && name.find_first_not_of("0123456789", underscore + 1) == std::string::npos)
+	{
+		name = name.substr(0, underscore);
+	}
+	return name;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 4)
+	{
+		fprintf(stderr, "usage: %s <output header> <suffix> <module>...\n", argv[0]);
+		return 1;
+	}
+	const char* outputPath = argv[1];
+	const char* suffix = argv[2];
+
+	std::vector<uint8_t> archive;
+	std::string tables;
+	size_t totalSize = 0;
+	for (int i = 3; i < argc; ++i)
+	{
+		std::vector<uint8_t> module;
+		if (!readFile(argv[i], module) || module.empty())
+		{
+			fprintf(stderr, "error: cannot read %s\n", argv[i]);
+			return 1;
+		}
+
+		std::vector<uint8_t> compressed = compress(module);
+		std::vector<uint8_t> decompressed(module.size());
+		if (!decompressShader(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()) || decompressed != module)
+		{
+			fprintf(stderr, "error: %s does not decompress to itself\n", argv[i]);
+			return 1;
+		}
+		char table[256];
+		snprintf(table, sizeof(table), "static const uint32_t CS%s%s[3] = { %zu, %zu, %zu };\n", moduleName(argv[i]).c_str(), suffix, archive.size(), compressed.size(), module.size());
+		tables += table;
+		archive.insert(archive.end(), compressed.begin(), compressed.end());
+		totalSize += module.size();
+	}
+
+	FILE* file = fopen(outputPath, "w");
+	if (!file)
+	{
+		fprintf(stderr, "error: cannot write %s\n", outputPath);
+		return 1;
+	}
+	fprintf(file, "// generated by ffx_cacao_pack_shaders from %d modules, %zu bytes compressed to %zu\n\n", argc - 3, totalSize, archive.size());
+	fprintf(file, "static const uint8_t CACAOShaders%s[] = {", suffix);
+	for (size_t i = 0; i < archive.size(); ++i)
+	{
+		fprintf(file, "%s%u,", i % 32 ? " " : "\n\t", archive[i]);
+	}
+	fprintf(file, "\n};\n\n// offset in CACAOShaders%s, compressed size and size of each module\n%s", suffix, tables.c_str());
+	bool ok = !ferror(file);
+	fclose(file);
+	if (!ok)
+	{
+		fprintf(stderr, "error: cannot write %s\n", outputPath);
+		return 1;
+	}
+
+	printf("%s: %d modules, %zu bytes compressed to %zu\n", outputPath, argc - 3, totalSize, archive.size());
+	return 0;
+}
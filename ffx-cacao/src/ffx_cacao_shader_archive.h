@@ -0,0 +1,107 @@
+// AMD Sample sample code
+//
+// Copyright(c) 2021 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Decompression of the shader archives written by ffx_cacao_pack_shaders, see ffx_cacao_pack_shaders.cpp for the format.
+// Shared by ffx_cacao_impl.cpp, which decompresses a module when creating a pipeline using it, and by
+// ffx_cacao_pack_shaders, which checks that every module it compresses decompresses back to itself.
+
+#ifndef FFX_CACAO_SHADER_ARCHIVE_H
+#define FFX_CACAO_SHADER_ARCHIVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// decompresses a module of srcSize bytes into exactly dstSize bytes, false if the module is corrupt
+static bool decompressShader(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+{
+	const uint8_t *srcEnd = src + srcSize;
+	uint8_t *dstStart = dst;
+	uint8_t *dstEnd = dst + dstSize;
+	while (src < srcEnd)
+	{
+		uint8_t token = *src++;
+
+		size_t numLiterals = token >> 4;
+		if (numLiterals == 15)
+		{
+			uint8_t b;
+			do
+			{
+				if (src == srcEnd)
+				{
+					return false;
+				}
+				b = *src++;
+				numLiterals += b;
+			} while (b == 255);
+		}
+		if ((size_t)(srcEnd - src) < numLiterals || (size_t)(dstEnd - dst) < numLiterals)
+		{
+			return false;
+		}
+		if (numLiterals)
+		{
+			memcpy(dst, src, numLiterals);
+		}
+		src += numLiterals;
+		dst += numLiterals;
+
+		// the last sequence has no match
+		if (src == srcEnd)
+		{
+			break;
+		}
+
+		if (srcEnd - src < 2)
+		{
+			return false;
+		}
+		size_t offset = src[0] | (src[1] << 8);
+		src += 2;
+		size_t matchLength = (token & 0xf) + 4;
+		if ((token & 0xf) == 15)
+		{
+			uint8_t b;
+			do
+			{
+				if (src == srcEnd)
+				{
+					return false;
+				}
+				b = *src++;
+				matchLength += b;
+			} while (b == 255);
+		}
+		if (offset == 0 || (size_t)(dst - dstStart) < offset || (size_t)(dstEnd - dst) < matchLength)
+		{
+			return false;
+		}
+		// byte by byte, as a match may overlap the bytes it writes
+		const uint8_t *match = dst - offset;
+		for (size_t i = 0; i < matchLength; ++i)
+		{
+			dst[i] = match[i];
+		}
+		dst += matchLength;
+	}
+	return dst == dstEnd;
+}
+
+#endif
@@ -7,3 +7,8 @@ mkdir VK
 cd VK
 cmake ..\.. -DGFX_API=VK %*
 cd ..
+
+mkdir CPU
+cd CPU
+cmake ..\.. -DGFX_API=CPU %*
+cd ..
@@ -0,0 +1,1468 @@
+// AMD Sample sample code
+//
+// Copyright(c) 2021 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// cacao-cli: offline batch ambient occlusion over depth (and normal) image sequences, or frame
+// containers captured by the Vulkan sample, using the CPU implementation of FFX CACAO. Frames are
+// decoded, computed and encoded on separate threads, with a bounded number of frames in flight
+// between them, so that the I/O of one frame overlaps the effect of another.
+//
+// The detailed timings of every frame can be recorded, and recorded timings replayed through the automatic quality
+// controller of FFX CACAO, to tune its budget and hysteresis offline.
+
+#include "ffx_cacao_impl.h"
+#include "Common.h"
+#include "CacaoFrameFile.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define NUM_PRESETS (sizeof(FFX_CACAO_PRESETS) / sizeof(FFX_CACAO_PRESETS[0]))
+
+struct Options
+{
+	const char *inputPath = NULL;            // input frame container, instead of images
+	const char *depthPattern = NULL;         // input depth images, PFM
+	const char *normalsPattern = NULL;       // optional input normal images, three channel PFM
+	const char *outputPattern = NULL;        // output AO images, PFM or 16 bit PGM by extension
+	const char *projPattern = NULL;          // optional text files of 16 floats, one per frame if the pattern has a frame number
+	int firstFrame = 0;
+	int lastFrame = 0;
+	int frameStep = 1;
+	bool hasFrames = false;
+	uint32_t preset = 1;                     // Native - High Quality
+	bool hasPreset = false;                  // overrides the settings of a frame container
+	uint32_t numJobs = 0;                    // threads executing the effect, 0 for all hardware threads
+	uint32_t framesInFlight = 4;
+	bool linearDepth = false;                // depth images hold positive view space z rather than device depth
+	bool signedNormals = false;              // normal images hold [-1, 1] rather than [0, 1] components
+	bool reference = false;
+	bool differential = false;
+	bool verbose = false;
+	const char *recordTimingsPath = NULL;    // text file the detailed timings of every frame are written to
+	const char *replayTimingsPath = NULL;    // timings replayed through the quality controller, instead of computing AO
+	float budget = 0.0f;                     // milliseconds, for the replay
+	const char *ladder = NULL;               // comma separated preset names, for the replay
+	uint32_t holdFrames = 0;
+	uint32_t latencyFrames = 0;
+	FFX_CACAO_Matrix4x4 proj = {};
+	FFX_CACAO_Matrix4x4 normalsToView = {};
+	bool hasProj = false;
+	float perspective[3] = {};               // vertical fov in degrees, near and far plane
+	bool hasPerspective = false;
+};
+
+struct Frame
+{
+	int index;
+	uint32_t width;
+	uint32_t height;
+	const float *depth;                      // one float per pixel, device depth, in depthStorage or a mapped container
+	const float *normals;                    // four floats per pixel in [0, 1], or NULL without normals
+	std::vector<float> depthStorage;
+	std::vector<float> normalsStorage;
+	std::vector<float> output;               // one float per pixel
+	FFX_CACAO_Matrix4x4 proj;
+	FFX_CACAO_Matrix4x4 normalsToView;
+	FFX_CACAO_Settings settings;
+	bool useDownsampledSsao;
+};
+
+// a bounded hand-off of frames between two stages of the pipeline
+class FrameQueue
+{
+public:
+	void push(Frame *frame)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_frames.push_back(frame);
+		m_cond.notify_one();
+	}
+
+	// returns NULL once the queue is closed and empty, or aborted
+	Frame *pop()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cond.wait(lock, [this] { return m_aborted || m_closed || !m_frames.empty(); });
+		if (m_aborted || m_frames.empty())
+		{
+			return NULL;
+		}
+		Frame *frame = m_frames.front();
+		m_frames.pop_front();
+		return frame;
+	}
+
+	void close()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_closed = true;
+		m_cond.notify_all();
+	}
+
+	void abort()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_aborted = true;
+		m_cond.notify_all();
+	}
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	std::deque<Frame*> m_frames;
+	bool m_closed = false;
+	bool m_aborted = false;
+};
+
+struct Pipeline
+{
+	const Options *options;
+	const CacaoFrameFileReader *input;       // NULL when reading images
+	FrameQueue freeFrames;
+	FrameQueue decodedFrames;
+	FrameQueue computedFrames;
+	std::atomic<bool> failed;
+	double decodeSeconds;
+	double computeSeconds;
+	double encodeSeconds;
+	uint32_t numFrames;
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince(Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static void failPipeline(Pipeline *pipeline)
+{
+	pipeline->failed = true;
+	pipeline->freeFrames.abort();
+	pipeline->decodedFrames.abort();
+	pipeline->computedFrames.abort();
+}
+
+// ============================================================================
+// File formats
+
+// expands a path pattern with an optional printf style frame number (%d or %0Nd)
+static bool framePath(const char *pattern, int index, std::string *path)
+{
+	path->clear();
+	bool hasIndex = false;
+	for (const char *c = pattern; *c; ++c)
+	{
+		if (*c != '%')
+		{
+			path->push_back(*c);
+			continue;
+		}
+		if (c[1] == '%')
+		{
+			path->push_back('%');
+			++c;
+			continue;
+		}
+		const char *spec = c + 1;
+		bool zeroPad = *spec == '0';
+		int width = 0;
+		while (isdigit((unsigned char)*spec))
+		{
+			width = width * 10 + (*spec++ - '0');
+		}
+		if (*spec != 'd' || hasIndex || width > 16)
+		{
+			return false;
+		}
+		char number[32];
+		snprintf(number, sizeof(number), zeroPad ? "%0*d" : "%*d", width, index);
+		path->append(number);
+		hasIndex = true;
+		c = spec;
+	}
+	return true;
+}
+
+static bool hasFrameNumber(const char *pattern)
+{
+	std::string a, b;
+	return framePath(pattern, 0, &a) && framePath(pattern, 1, &b) && a != b;
+}
+
+// reads a PFM image, returning its rows top to bottom with numChannels floats per pixel
+static bool readPfm(const char *path, uint32_t *width, uint32_t *height, uint32_t *numChannels, std::vector<float> *pixels)
+{
+	FILE *file = fopen(path, "rb");
+	if (!file)
+	{
+		fprintf(stderr, "cacao-cli: cannot open %s\n", path);
+		return false;
+	}
+
+	char magic[3] = {};
+	int w = 0, h = 0;
+	float scale = 0.0f;
+	bool ok = fscanf(file, "%2s %d %d %f", magic, &w, &h, &scale) == 4 && fgetc(file) != EOF
+		&& (!strcmp(magic, "Pf") || !strcmp(magic, "PF")) && w > 0 && h > 0 && scale != 0.0f;
+	if (!ok)
+	{
+		fprintf(stderr, "cacao-cli: %s is not a PFM image\n", path);
+		fclose(file);
+		return false;
+	}
+
+	*width = (uint32_t)w;
+	*height = (uint32_t)h;
+	*numChannels = magic[1] == 'F' ? 3 : 1;
+	size_t rowSize = (size_t)*width * *numChannels;
+	pixels->resize(rowSize * *height);
+
+	// rows are stored bottom to top
+	for (uint32_t y = *height; y-- > 0;)
+	{
+		if (fread(&(*pixels)[y * rowSize], sizeof(float), rowSize, file) != rowSize)
+		{
+			fprintf(stderr, "cacao-cli: %s is truncated\n", path);
+			fclose(file);
+			return false;
+		}
+	}
+	fclose(file);
+
+	// a negative scale marks little endian data
+	uint16_t endianTest = 1;
+	bool hostLittleEndian = *(uint8_t*)&endianTest == 1;
+	if ((scale < 0.0f) != hostLittleEndian)
+	{
+		for (float &value : *pixels)
+		{
+			uint8_t *bytes = (uint8_t*)&value;
+			uint8_t swapped[4] = { bytes[3], bytes[2], bytes[1], bytes[0] };
+			memcpy(bytes, swapped, 4);
+		}
+	}
+	return true;
+}
+
+static bool writePfm(const char *path, uint32_t width, uint32_t height, const float *pixels)
+{
+	FILE *file = fopen(path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+	uint16_t endianTest = 1;
+	bool hostLittleEndian = *(uint8_t*)&endianTest == 1;
+	bool ok = fprintf(file, "Pf\n%u %u\n%s\n", width, height, hostLittleEndian ? "-1.0" : "1.0") > 0;
+	for (uint32_t y = height; ok && y-- > 0;)
+	{
+		ok = fwrite(&pixels[(size_t)y * width], sizeof(float), width, file) == width;
+	}
+	return fclose(file) == 0 && ok;
+}
+
+static bool writePgm16(const char *path, uint32_t width, uint32_t height, const float *pixels)
+{
+	FILE *file = fopen(path, "wb");
+	if (!file)
+	{
+		return false;
+	}
+	bool ok = fprintf(file, "P5\n%u %u\n65535\n", width, height) > 0;
+	std::vector<uint8_t> row(width * 2);
+	for (uint32_t y = 0; ok && y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			float value = pixels[(size_t)y * width + x];
+			uint16_t quantised = (uint16_t)(fminf(fmaxf(value, 0.0f), 1.0f) * 65535.0f + 0.5f);
+			row[2 * x + 0] = (uint8_t)(quantised >> 8);
+			row[2 * x + 1] = (uint8_t)(quantised & 0xff);
+		}
+		ok = fwrite(row.data(), 1, row.size(), file) == row.size();
+	}
+	return fclose(file) == 0 && ok;
+}
+
+static bool endsWith(const char *str, const char *suffix)
+{
+	size_t strLen = strlen(str), suffixLen = strlen(suffix);
+	if (strLen < suffixLen)
+	{
+		return false;
+	}
+	for (size_t i = 0; i < suffixLen; ++i)
+	{
+		if (tolower((unsigned char)str[strLen - suffixLen + i]) != tolower((unsigned char)suffix[i]))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool readMatrix(const char *path, FFX_CACAO_Matrix4x4 *matrix)
+{
+	FILE *file = fopen(path, "r");
+	if (!file)
+	{
+		fprintf(stderr, "cacao-cli: cannot open %s\n", path);
+		return false;
+	}
+	bool ok = true;
+	for (int i = 0; ok && i < 16; ++i)
+	{
+		ok = fscanf(file, " %f ,", &matrix->elements[i / 4][i % 4]) == 1;
+	}
+	fclose(file);
+	if (!ok)
+	{
+		fprintf(stderr, "cacao-cli: %s does not hold 16 numbers\n", path);
+	}
+	return ok;
+}
+
+static bool parseMatrix(const char *str, FFX_CACAO_Matrix4x4 *matrix)
+{
+	for (int i = 0; i < 16; ++i)
+	{
+		char *end;
+		matrix->elements[i / 4][i % 4] = strtof(str, &end);
+		if (end == str || (i < 15 && *end != ','))
+		{
+			return false;
+		}
+		str = end + 1;
+	}
+	return true;
+}
+
+// a timings file holds a line "millisecondsPerTick <value>", followed by a line per frame of
+//   <frame> <preset> <label>=<ticks> ...
+// with the preset name in lower case and words joined by '-', as --preset accepts it. Lines starting with # are ignored.
+struct TimingsEntry
+{
+	int frame;
+	uint32_t preset;                         // index in FFX_CACAO_PRESETS
+	FFX_CACAO_DetailedTiming timings;
+};
+
+static bool matchPresetName(const char *name, const char *presetName)
+{
+	// compare alphanumerics only, ignoring case, so "native-high-quality" selects "Native - High Quality"
+	for (;;)
+	{
+		while (*name && !isalnum((unsigned char)*name)) ++name;
+		while (*presetName && !isalnum((unsigned char)*presetName)) ++presetName;
+		if (!*name || !*presetName)
+		{
+			return !*name && !*presetName;
+		}
+		if (tolower((unsigned char)*name++) != tolower((unsigned char)*presetName++))
+		{
+			return false;
+		}
+	}
+}
+
+// "Native - High Quality" -> "native-high-quality"
+static std::string presetSlug(const char *name)
+{
+	std::string slug;
+	for (const char *c = name; *c; ++c)
+	{
+		if (isalnum((unsigned char)*c))
+		{
+			slug.push_back((char)tolower((unsigned char)*c));
+		}
+		else if (!slug.empty() && slug.back() != '-')
+		{
+			slug.push_back('-');
+		}
+	}
+	while (!slug.empty() && slug.back() == '-')
+	{
+		slug.pop_back();
+	}
+	return slug;
+}
+
+static void writeTimings(FILE *file, int index, const char *presetName, const FFX_CACAO_DetailedTiming *timings)
+{
+	fprintf(file, "%d %s", index, presetSlug(presetName).c_str());
+	for (uint32_t i = 0; i < timings->numTimestamps; ++i)
+	{
+		fprintf(file, " %s=%llu", timings->timestamps[i].label, (unsigned long long)timings->timestamps[i].ticks);
+	}
+	fprintf(file, "\n");
+}
+
+// the labels of the timings read point into labels, which only grows
+static bool readTimings(const char *path, float *millisecondsPerTick, std::vector<TimingsEntry> *entries, std::deque<std::string> *labels)
+{
+	FILE *file = fopen(path, "r");
+	if (!file)
+	{
+		fprintf(stderr, "cacao-cli: cannot open %s\n", path);
+		return false;
+	}
+
+	*millisecondsPerTick = 0.0f;
+	char line[4096];
+	int lineNumber = 0;
+	bool ok = true;
+	while (ok && fgets(line, sizeof(line), file))
+	{
+		++lineNumber;
+		char *token = strtok(line, " \t\r\n");
+		if (!token || *token == '#')
+		{
+			continue;
+		}
+		if (!strcmp(token, "millisecondsPerTick"))
+		{
+			token = strtok(NULL, " \t\r\n");
+			*millisecondsPerTick = token ? strtof(token, NULL) : 0.0f;
+			ok = *millisecondsPerTick > 0.0f;
+			continue;
+		}
+
+		TimingsEntry entry = {};
+		char *end;
+		entry.frame = (int)strtol(token, &end, 10);
+		const char *presetName = strtok(NULL, " \t\r\n");
+		ok = *end == '\0' && presetName;
+		entry.preset = NUM_PRESETS + 1;
+		for (uint32_t p = 0; ok && p <= NUM_PRESETS; ++p)
+		{
+			if (matchPresetName(presetName, FFX_CACAO_PRESET_NAMES[p]))
+			{
+				entry.preset = p;
+			}
+		}
+		ok = ok && entry.preset <= NUM_PRESETS;
+		while (ok && (token = strtok(NULL, " \t\r\n")))
+		{
+			char *equals = strchr(token, '=');
+			ok = equals && entry.timings.numTimestamps < sizeof(entry.timings.timestamps) / sizeof(entry.timings.timestamps[0]);
+			if (ok)
+			{
+				*equals = '\0';
+				std::deque<std::string>::iterator label = labels->begin();
+				while (label != labels->end() && *label != token)
+				{
+					++label;
+				}
+				if (label == labels->end())
+				{
+					label = labels->insert(labels->end(), token);
+				}
+				FFX_CACAO_Timestamp *timestamp = &entry.timings.timestamps[entry.timings.numTimestamps++];
+				timestamp->label = label->c_str();
+				timestamp->ticks = strtoull(equals + 1, &end, 10);
+				ok = end != equals + 1 && *end == '\0';
+			}
+		}
+		ok = ok && entry.timings.numTimestamps > 0;
+		// frames with custom settings cannot be a rung of the ladder
+		if (ok && entry.preset < NUM_PRESETS)
+		{
+			entries->push_back(entry);
+		}
+	}
+	fclose(file);
+
+	if (!ok)
+	{
+		fprintf(stderr, "cacao-cli: %s:%d is not a line of timings\n", path, lineNumber);
+		return false;
+	}
+	if (!*millisecondsPerTick || entries->empty())
+	{
+		fprintf(stderr, "cacao-cli: %s holds no millisecondsPerTick or no timings\n", path);
+		return false;
+	}
+	return true;
+}
+
+// ============================================================================
+// Pipeline stages
+
+static float halfToFloat(uint16_t half)
+{
+	uint32_t sign = (uint32_t)(half >> 15) << 31;
+	uint32_t exponent = (half >> 10) & 0x1f;
+	uint32_t mantissa = half & 0x3ff;
+	uint32_t bits;
+	if (exponent == 0x1f)
+	{
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else if (exponent)
+	{
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	else
+	{
+		float denormal = (float)mantissa * (1.0f / 16777216.0f);
+		memcpy(&bits, &denormal, sizeof(bits));
+		bits |= sign;
+	}
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static void applyPreset(const Options *options, Frame *frame)
+{
+	const Preset *preset = &FFX_CACAO_PRESETS[options->preset];
+	frame->settings = preset->settings;
+	frame->useDownsampledSsao = preset->useDownsampledSsao;
+}
+
+// the preset the settings of a frame came from, or custom
+static const char *framePresetName(const Frame *frame)
+{
+	for (uint32_t p = 0; p < NUM_PRESETS; ++p)
+	{
+		const Preset *preset = &FFX_CACAO_PRESETS[p];
+		if (preset->useDownsampledSsao == frame->useDownsampledSsao && !memcmp(&preset->settings, &frame->settings, sizeof(frame->settings)))
+		{
+			return FFX_CACAO_PRESET_NAMES[p];
+		}
+	}
+	return FFX_CACAO_PRESET_NAMES[NUM_PRESETS];
+}
+
+// frames of a container are used in place, except for half depth planes which are widened
+static bool mapFrame(const Options *options, const CacaoFrameFileReader *input, int index, Frame *frame)
+{
+	const void *depth;
+	const CacaoFrameHeader *header = input->GetFrame((uint32_t)index, &depth, &frame->normals);
+	const CacaoFrameFileHeader *fileHeader = input->GetHeader();
+	input->Prefetch((uint32_t)(index + options->frameStep));
+
+	frame->index = index;
+	frame->width = fileHeader->width;
+	frame->height = fileHeader->height;
+	frame->proj = header->proj;
+	frame->normalsToView = header->normalsToView;
+	frame->settings = header->settings;
+	frame->useDownsampledSsao = header->useDownsampledSsao != 0;
+	if (options->hasPreset)
+	{
+		applyPreset(options, frame);
+	}
+
+	size_t numPixels = (size_t)frame->width * frame->height;
+	if (fileHeader->depthFormat == CACAO_FRAME_FILE_DEPTH_HALF)
+	{
+		const uint16_t *halfs = (const uint16_t*)depth;
+		frame->depthStorage.resize(numPixels);
+		for (size_t i = 0; i < numPixels; ++i)
+		{
+			frame->depthStorage[i] = halfToFloat(halfs[i]);
+		}
+		frame->depth = frame->depthStorage.data();
+	}
+	else
+	{
+		frame->depth = (const float*)depth;
+	}
+
+	frame->output.resize(numPixels);
+	return true;
+}
+
+static bool decodeFrame(const Options *options, int index, Frame *frame)
+{
+	std::string path;
+	uint32_t numChannels;
+	std::vector<float> pixels;
+
+	frame->index = index;
+	framePath(options->depthPattern, index, &path);
+	if (!readPfm(path.c_str(), &frame->width, &frame->height, &numChannels, &pixels))
+	{
+		return false;
+	}
+
+	size_t numPixels = (size_t)frame->width * frame->height;
+	frame->depthStorage.resize(numPixels);
+	for (size_t i = 0; i < numPixels; ++i)
+	{
+		frame->depthStorage[i] = pixels[i * numChannels];
+	}
+	frame->depth = frame->depthStorage.data();
+	frame->normalsToView = options->normalsToView;
+	applyPreset(options, frame);
+
+	frame->proj = options->proj;
+	if (options->projPattern)
+	{
+		framePath(options->projPattern, index, &path);
+		if (!readMatrix(path.c_str(), &frame->proj))
+		{
+			return false;
+		}
+	}
+	else if (options->hasPerspective)
+	{
+		float tanHalfFovY = tanf(0.5f * options->perspective[0] * 3.14159265f / 180.0f);
+		float tanHalfFovX = tanHalfFovY * (float)frame->width / (float)frame->height;
+		float zNear = options->perspective[1], zFar = options->perspective[2];
+		memset(&frame->proj, 0, sizeof(frame->proj));
+		frame->proj.elements[0][0] = 1.0f / tanHalfFovX;
+		frame->proj.elements[1][1] = 1.0f / tanHalfFovY;
+		frame->proj.elements[2][2] = zFar / (zFar - zNear);
+		frame->proj.elements[2][3] = 1.0f;
+		frame->proj.elements[3][2] = -zNear * zFar / (zFar - zNear);
+	}
+
+	if (options->linearDepth)
+	{
+		// invert the depth linearisation of FFX_CACAO_UpdateConstants, viewZ = mul / (add - depth)
+		float mul = -frame->proj.elements[3][2];
+		float add = frame->proj.elements[2][2];
+		if (mul * add < 0)
+		{
+			add = -add;
+		}
+		for (float &depth : frame->depthStorage)
+		{
+			depth = add - mul / depth;
+		}
+	}
+
+	frame->normals = NULL;
+	if (options->normalsPattern)
+	{
+		uint32_t width, height;
+		framePath(options->normalsPattern, index, &path);
+		if (!readPfm(path.c_str(), &width, &height, &numChannels, &pixels))
+		{
+			return false;
+		}
+		if (width != frame->width || height != frame->height || numChannels != 3)
+		{
+			fprintf(stderr, "cacao-cli: %s must be a three channel PFM image of %ux%u\n", path.c_str(), frame->width, frame->height);
+			return false;
+		}
+		float mul = options->signedNormals ? 0.5f : 1.0f;
+		float add = options->signedNormals ? 0.5f : 0.0f;
+		frame->normalsStorage.resize(numPixels * 4);
+		for (size_t i = 0; i < numPixels; ++i)
+		{
+			frame->normalsStorage[4 * i + 0] = pixels[3 * i + 0] * mul + add;
+			frame->normalsStorage[4 * i + 1] = pixels[3 * i + 1] * mul + add;
+			frame->normalsStorage[4 * i + 2] = pixels[3 * i + 2] * mul + add;
+			frame->normalsStorage[4 * i + 3] = 0.0f;
+		}
+		frame->normals = frame->normalsStorage.data();
+	}
+
+	frame->output.resize(numPixels);
+	return true;
+}
+
+static void decodeThread(Pipeline *pipeline)
+{
+	const Options *options = pipeline->options;
+	for (int index = options->firstFrame; index <= options->lastFrame; index += options->frameStep)
+	{
+		Frame *frame = pipeline->freeFrames.pop();
+		if (!frame)
+		{
+			return;
+		}
+		Clock::time_point start = Clock::now();
+		bool ok = pipeline->input
+			? mapFrame(options, pipeline->input, index, frame)
+			: decodeFrame(options, index, frame);
+		if (!ok)
+		{
+			failPipeline(pipeline);
+			return;
+		}
+		pipeline->decodeSeconds += secondsSince(start);
+		pipeline->decodedFrames.push(frame);
+	}
+	pipeline->decodedFrames.close();
+}
+
+static void encodeThread(Pipeline *pipeline)
+{
+	const Options *options = pipeline->options;
+	std::string path;
+	while (Frame *frame = pipeline->computedFrames.pop())
+	{
+		Clock::time_point start = Clock::now();
+		framePath(options->outputPattern, frame->index, &path);
+		bool ok = endsWith(path.c_str(), ".pgm")
+			? writePgm16(path.c_str(), frame->width, frame->height, frame->output.data())
+			: writePfm(path.c_str(), frame->width, frame->height, frame->output.data());
+		if (!ok)
+		{
+			fprintf(stderr, "cacao-cli: cannot write %s\n", path.c_str());
+			failPipeline(pipeline);
+			return;
+		}
+		pipeline->encodeSeconds += secondsSince(start);
+		if (options->verbose)
+		{
+			printf("cacao-cli: wrote %s\n", path.c_str());
+		}
+		++pipeline->numFrames;
+		pipeline->freeFrames.push(frame);
+	}
+}
+
+// the state of the effect on the compute thread. The buffers of every frame are bound to the
+// contexts in turn, so frames are not copied.
+struct Compute
+{
+	FFX_CACAO_CpuContext *context = NULL;
+	FFX_CACAO_CpuContext *reference = NULL;
+	bool contextInitialised = false;
+	bool referenceInitialised = false;
+	bool screenSizeInitialised = false;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	bool useDownsampledSsao = false;
+	std::vector<float> referenceOutput;
+	FILE *timingsFile = NULL;
+};
+
+static bool initCompute(const Options *options, Compute *compute)
+{
+	compute->context = (FFX_CACAO_CpuContext*)malloc(FFX_CACAO_CpuGetContextSize());
+	if (!compute->context)
+	{
+		return false;
+	}
+	FFX_CACAO_CpuCreateInfo info = {};
+	info.numThreads = options->numJobs;
+	info.flags = options->reference ? FFX_CACAO_CPU_CREATE_REFERENCE : 0;
+	if (FFX_CACAO_CpuInitContext(compute->context, &info) != FFX_CACAO_STATUS_OK)
+	{
+		return false;
+	}
+	compute->contextInitialised = true;
+
+	if (options->differential)
+	{
+		compute->reference = (FFX_CACAO_CpuContext*)malloc(FFX_CACAO_CpuGetContextSize());
+		if (!compute->reference)
+		{
+			return false;
+		}
+		info.flags = FFX_CACAO_CPU_CREATE_REFERENCE;
+		if (FFX_CACAO_CpuInitContext(compute->reference, &info) != FFX_CACAO_STATUS_OK)
+		{
+			return false;
+		}
+		compute->referenceInitialised = true;
+	}
+	return true;
+}
+
+static void destroyScreenSize(Compute *compute)
+{
+	if (compute->screenSizeInitialised)
+	{
+		FFX_CACAO_CpuDestroyScreenSizeDependentResources(compute->context);
+		if (compute->reference)
+		{
+			FFX_CACAO_CpuDestroyScreenSizeDependentResources(compute->reference);
+		}
+		compute->screenSizeInitialised = false;
+	}
+}
+
+static void destroyCompute(Compute *compute)
+{
+	destroyScreenSize(compute);
+	if (compute->referenceInitialised)
+	{
+		FFX_CACAO_CpuDestroyContext(compute->reference);
+	}
+	if (compute->contextInitialised)
+	{
+		FFX_CACAO_CpuDestroyContext(compute->context);
+	}
+	free(compute->reference);
+	free(compute->context);
+}
+
+static void screenSizeInfo(const Frame *frame, float *output, FFX_CACAO_CpuScreenSizeInfo *info)
+{
+	memset(info, 0, sizeof(*info));
+	info->width = frame->width;
+	info->height = frame->height;
+	info->depth = frame->depth;
+	info->normals = frame->normals;
+	info->output = output;
+	info->useDownsampledSsao = frame->useDownsampledSsao ? FFX_CACAO_TRUE : FFX_CACAO_FALSE;
+}
+
+static bool resizeCompute(Compute *compute, Frame *frame)
+{
+	if (compute->screenSizeInitialised && compute->width == frame->width && compute->height == frame->height && compute->useDownsampledSsao == frame->useDownsampledSsao)
+	{
+		return true;
+	}
+	destroyScreenSize(compute);
+
+	compute->width = frame->width;
+	compute->height = frame->height;
+	compute->useDownsampledSsao = frame->useDownsampledSsao;
+
+	FFX_CACAO_CpuScreenSizeInfo info;
+	screenSizeInfo(frame, frame->output.data(), &info);
+	if (FFX_CACAO_CpuInitScreenSizeDependentResources(compute->context, &info) != FFX_CACAO_STATUS_OK)
+	{
+		return false;
+	}
+	if (compute->reference)
+	{
+		compute->referenceOutput.resize(frame->output.size());
+		info.output = compute->referenceOutput.data();
+		if (FFX_CACAO_CpuInitScreenSizeDependentResources(compute->reference, &info) != FFX_CACAO_STATUS_OK)
+		{
+			FFX_CACAO_CpuDestroyScreenSizeDependentResources(compute->context);
+			return false;
+		}
+	}
+	compute->screenSizeInitialised = true;
+	return true;
+}
+
+static bool computeFrame(const Options *options, Compute *compute, Frame *frame)
+{
+	if (!resizeCompute(compute, frame))
+	{
+		fprintf(stderr, "cacao-cli: cannot initialise FFX CACAO for %ux%u\n", frame->width, frame->height);
+		return false;
+	}
+
+	// without normals they are generated from depth
+	FFX_CACAO_Settings settings = frame->settings;
+	settings.generateNormals = frame->normals ? settings.generateNormals : FFX_CACAO_TRUE;
+
+	FFX_CACAO_CpuScreenSizeInfo info;
+	screenSizeInfo(frame, frame->output.data(), &info);
+	FFX_CACAO_CpuUpdateBuffers(compute->context, &info);
+	FFX_CACAO_CpuUpdateSettings(compute->context, &settings);
+
+	FFX_CACAO_Status status;
+	if (compute->reference)
+	{
+		info.output = compute->referenceOutput.data();
+		FFX_CACAO_CpuUpdateBuffers(compute->reference, &info);
+		FFX_CACAO_CpuUpdateSettings(compute->reference, &settings);
+
+		FFX_CACAO_CpuDifferentialReport report;
+		status = FFX_CACAO_CpuDrawDifferential(compute->context, compute->reference, &frame->proj, &frame->normalsToView, &report);
+		if (status == FFX_CACAO_STATUS_OK)
+		{
+			printf("cacao-cli: frame %d differential, average importance %.4f (reference %.4f)\n", frame->index, report.averageImportance, report.referenceAverageImportance);
+			for (uint32_t i = 0; i < report.numStages; ++i)
+			{
+				const FFX_CACAO_CpuStageDifference *stage = &report.stages[i];
+				printf("    %-40s max %.3g mean %.3g, %u of %u texels differ\n", stage->label, stage->maxError, stage->meanError, stage->numDifferentTexels, stage->numTexels);
+			}
+		}
+	}
+	else
+	{
+		status = FFX_CACAO_CpuDraw(compute->context, &frame->proj, &frame->normalsToView);
+	}
+	if (status != FFX_CACAO_STATUS_OK)
+	{
+		fprintf(stderr, "cacao-cli: FFX CACAO failed on frame %d (%d)\n", frame->index, (int)status);
+		return false;
+	}
+
+	if (compute->timingsFile)
+	{
+		FFX_CACAO_DetailedTiming timings = {};
+		FFX_CACAO_CpuGetDetailedTimings(compute->context, &timings);
+		writeTimings(compute->timingsFile, frame->index, framePresetName(frame), &timings);
+	}
+	return true;
+}
+
+// ============================================================================
+// Timing replay
+
+struct Replay
+{
+	std::vector<uint32_t> ladder;            // indices in FFX_CACAO_PRESETS of the rungs
+	uint32_t numDecisions = 0;
+};
+
+static void replayDecision(void *userData, const FFX_CACAO_QualityDecision *decision, const FFX_CACAO_QualityPreset *preset)
+{
+	Replay *replay = (Replay*)userData;
+	++replay->numDecisions;
+	printf("cacao-cli: frame %u, %s (%.3f ms) -> %s (predicted %.3f ms, quality %d, %u blur passes)\n", decision->frame,
+		FFX_CACAO_PRESET_NAMES[replay->ladder[decision->previousPreset]], decision->smoothedMilliseconds,
+		FFX_CACAO_PRESET_NAMES[replay->ladder[decision->preset]], decision->predictedMilliseconds,
+		(int)preset->settings.qualityLevel, preset->settings.blurPassCount);
+}
+
+// replays the frames of a timings file through a quality controller. Each frame is given the timings recorded for the
+// preset the controller chose, or the latest ones recorded for that preset before it, so timings of each preset of the
+// ladder recorded in separate runs over the same frames replay as if the preset had been switched while drawing.
+static bool replayTimings(const Options *options)
+{
+	float millisecondsPerTick;
+	std::vector<TimingsEntry> entries;
+	std::deque<std::string> labels;
+	if (!readTimings(options->replayTimingsPath, &millisecondsPerTick, &entries, &labels))
+	{
+		return false;
+	}
+
+	Replay replay;
+	if (options->ladder)
+	{
+		std::string names = options->ladder;
+		for (char *name = strtok(&names[0], ","); name; name = strtok(NULL, ","))
+		{
+			uint32_t p = 0;
+			while (p < NUM_PRESETS && !matchPresetName(name, FFX_CACAO_PRESET_NAMES[p]))
+			{
+				++p;
+			}
+			if (p == NUM_PRESETS)
+			{
+				fprintf(stderr, "cacao-cli: unknown preset \"%s\" in the ladder, see --list-presets\n", name);
+				return false;
+			}
+			replay.ladder.push_back(p);
+		}
+	}
+	else
+	{
+		// every preset recorded, from the most to the least expensive
+		for (uint32_t p = 0; p < NUM_PRESETS; ++p)
+		{
+			for (const TimingsEntry &entry : entries)
+			{
+				if (entry.preset == p)
+				{
+					replay.ladder.push_back(p);
+					break;
+				}
+			}
+		}
+	}
+
+	// the timings of each rung, by frame
+	std::vector<std::vector<const TimingsEntry*>> rungs(replay.ladder.size());
+	std::vector<int> frameNumbers;
+	for (const TimingsEntry &entry : entries)
+	{
+		for (size_t r = 0; r < replay.ladder.size(); ++r)
+		{
+			if (entry.preset == replay.ladder[r])
+			{
+				rungs[r].push_back(&entry);
+			}
+		}
+		frameNumbers.push_back(entry.frame);
+	}
+	std::sort(frameNumbers.begin(), frameNumbers.end());
+	frameNumbers.erase(std::unique(frameNumbers.begin(), frameNumbers.end()), frameNumbers.end());
+
+	std::vector<FFX_CACAO_QualityPreset> presets(replay.ladder.size());
+	uint32_t initialPreset = 0;
+	for (size_t r = 0; r < replay.ladder.size(); ++r)
+	{
+		if (rungs[r].empty())
+		{
+			fprintf(stderr, "cacao-cli: %s holds no timings of %s\n", options->replayTimingsPath, FFX_CACAO_PRESET_NAMES[replay.ladder[r]]);
+			return false;
+		}
+		std::stable_sort(rungs[r].begin(), rungs[r].end(), [](const TimingsEntry *a, const TimingsEntry *b) { return a->frame < b->frame; });
+		presets[r].settings = FFX_CACAO_PRESETS[replay.ladder[r]].settings;
+		presets[r].useDownsampledSsao = FFX_CACAO_PRESETS[replay.ladder[r]].useDownsampledSsao ? FFX_CACAO_TRUE : FFX_CACAO_FALSE;
+		initialPreset = options->hasPreset && replay.ladder[r] == options->preset ? (uint32_t)r : initialPreset;
+	}
+	if (options->hasPreset && replay.ladder[initialPreset] != options->preset)
+	{
+		fprintf(stderr, "cacao-cli: the ladder does not hold %s\n", FFX_CACAO_PRESET_NAMES[options->preset]);
+		return false;
+	}
+
+	FFX_CACAO_QualityControllerCreateInfo info = {};
+	info.presets = presets.data();
+	info.numPresets = (uint32_t)presets.size();
+	info.initialPreset = initialPreset;
+	info.budgetMilliseconds = options->budget;
+	info.millisecondsPerTick = millisecondsPerTick;
+	info.holdFrames = options->holdFrames;
+	info.latencyFrames = options->latencyFrames;
+	info.callback = replayDecision;
+	info.userData = &replay;
+
+	FFX_CACAO_QualityController *controller = (FFX_CACAO_QualityController*)malloc(FFX_CACAO_QualityControllerGetSize());
+	if (!controller || FFX_CACAO_QualityControllerInit(controller, &info) != FFX_CACAO_STATUS_OK)
+	{
+		fprintf(stderr, "cacao-cli: cannot create an FFX CACAO quality controller\n");
+		free(controller);
+		return false;
+	}
+
+	// the replayed timings of a frame belong to the preset chosen after the previous frame
+	std::vector<size_t> cursors(rungs.size(), 0);
+	std::vector<uint32_t> framesPerRung(rungs.size(), 0);
+	uint32_t preset = initialPreset;
+	uint32_t framesOverBudget = 0;
+	double totalMilliseconds = 0.0;
+	for (int frame : frameNumbers)
+	{
+		const std::vector<const TimingsEntry*> &rung = rungs[preset];
+		size_t &cursor = cursors[preset];
+		while (cursor + 1 < rung.size() && rung[cursor + 1]->frame <= frame)
+		{
+			++cursor;
+		}
+		const FFX_CACAO_DetailedTiming *timings = &rung[cursor]->timings;
+		double milliseconds = millisecondsPerTick * (double)timings->timestamps[0].ticks;
+		totalMilliseconds += milliseconds;
+		framesOverBudget += milliseconds > options->budget ? 1 : 0;
+		++framesPerRung[preset];
+		if (options->verbose)
+		{
+			printf("cacao-cli: frame %d, %s, %.3f ms\n", frame, FFX_CACAO_PRESET_NAMES[replay.ladder[preset]], milliseconds);
+		}
+		FFX_CACAO_QualityControllerUpdate(controller, timings, &preset);
+	}
+	free(controller);
+
+	size_t n = frameNumbers.size();
+	printf("cacao-cli: replayed %zu frames against a budget of %.3f ms, mean %.3f ms, %u frames over budget, %u changes of preset\n",
+		n, options->budget, totalMilliseconds / n, framesOverBudget, replay.numDecisions);
+	for (size_t r = 0; r < rungs.size(); ++r)
+	{
+		printf("    %-40s %u frames\n", FFX_CACAO_PRESET_NAMES[replay.ladder[r]], framesPerRung[r]);
+	}
+	return true;
+}
+
+// ============================================================================
+// Command line
+
+static void printUsage()
+{
+	printf(
+		"usage: cacao-cli --depth <pattern> --output <pattern> [options]\n"
+		"       cacao-cli --input <file> --output <pattern> [options]\n"
+		"\n"
+		"Computes FFX CACAO ambient occlusion on the CPU for a sequence of depth images, or the frames of a\n"
+		"container captured by the Vulkan sample. Patterns may contain a printf style frame number such as %%04d.\n"
+		"Depth and normal images are PFM, output images are PFM, or 16 bit PGM if the output pattern ends in .pgm.\n"
+		"\n"
+		"  --input <file>               frame container holding depth, normals, matrices and settings per frame\n"
+		"  --depth <pattern>            depth images, device depth unless --linear-depth is given\n"
+		"  --normals <pattern>          optional three channel normal images; normals are generated from depth otherwise\n"
+		"  --output <pattern>           output AO images\n"
+		"  --frames <first>:<last>[:<step>]  frame numbers to process (default 0:0, or every frame of a container)\n"
+		"  --proj <m00,m01,...,m33>     projection matrix, 16 comma separated floats, row major\n"
+		"  --proj-file <pattern>        text files of 16 floats holding the projection matrix, per frame if the pattern has a frame number\n"
+		"  --perspective <fovy,near,far>  projection from a vertical field of view in degrees and clip planes\n"
+		"  --normals-to-view <m00,...,m33>  matrix transforming the normals to view space (default identity)\n"
+		"  --linear-depth               depth images hold positive view space z\n"
+		"  --signed-normals             normal images hold components in [-1, 1] rather than [0, 1]\n"
+		"  --preset <name>              settings preset (default \"%s\"), overriding those of a container, see --list-presets\n"
+		"  --list-presets               list the settings presets\n"
+		"  --jobs <n>                   threads executing the effect (default 0, all hardware threads)\n"
+		"  --frames-in-flight <n>       frames decoded, computed or encoded at once (default 4)\n"
+		"  --reference                  run the scalar reference implementation\n"
+		"  --differential               run the reference alongside and report the per stage differences of every frame\n"
+		"  --record-timings <file>      write the detailed timings of every frame to a file, for --replay-timings\n"
+		"  --verbose                    report every frame written\n"
+		"\n"
+		"       cacao-cli --replay-timings <file> --budget <ms> [options]\n"
+		"\n"
+		"Replays recorded timings through the automatic quality controller of FFX CACAO, reporting every change of preset.\n"
+		"Each frame takes the timings recorded for the preset the controller chose, so the timings of several presets over\n"
+		"the same frames, for example recorded by several runs with --record-timings, may be concatenated into one file.\n"
+		"\n"
+		"  --budget <ms>                the time the effect should take per frame\n"
+		"  --ladder <name,name,...>     the presets stepped through, from the most to the least expensive (default every preset recorded)\n"
+		"  --preset <name>              the initial preset (default the first of the ladder)\n"
+		"  --hold-frames <n>            timings of a preset averaged before changing preset again (default 30)\n"
+		"  --latency-frames <n>         timings discarded after a change of preset (default 0)\n"
+		"  --verbose                    report every frame replayed\n",
+		FFX_CACAO_PRESET_NAMES[1]);
+}
+
+static bool parseOptions(int argc, char **argv, Options *options)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		options->normalsToView.elements[i][i] = 1.0f;
+	}
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char *arg = argv[i];
+		const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+		bool consumesValue = true;
+		bool ok = true;
+
+		if (!strcmp(arg, "--input") && value)
+		{
+			options->inputPath = value;
+		}
+		else if (!strcmp(arg, "--depth") && value)
+		{
+			options->depthPattern = value;
+		}
+		else if (!strcmp(arg, "--normals") && value)
+		{
+			options->normalsPattern = value;
+		}
+		else if (!strcmp(arg, "--output") && value)
+		{
+			options->outputPattern = value;
+		}
+		else if (!strcmp(arg, "--frames") && value)
+		{
+			int n = sscanf(value, "%d:%d:%d", &options->firstFrame, &options->lastFrame, &options->frameStep);
+			ok = n >= 2 && options->frameStep > 0 && options->firstFrame >= 0 && options->lastFrame >= options->firstFrame;
+			options->hasFrames = true;
+		}
+		else if (!strcmp(arg, "--proj") && value)
+		{
+			ok = parseMatrix(value, &options->proj);
+			options->hasProj = true;
+		}
+		else if (!strcmp(arg, "--proj-file") && value)
+		{
+			options->projPattern = value;
+		}
+		else if (!strcmp(arg, "--perspective") && value)
+		{
+			float *p = options->perspective;
+			ok = sscanf(value, "%f,%f,%f", &p[0], &p[1], &p[2]) == 3 && p[0] > 0.0f && p[0] < 180.0f && p[1] > 0.0f && p[2] > p[1];
+			options->hasPerspective = true;
+		}
+		else if (!strcmp(arg, "--normals-to-view") && value)
+		{
+			ok = parseMatrix(value, &options->normalsToView);
+		}
+		else if (!strcmp(arg, "--preset") && value)
+		{
+			options->preset = NUM_PRESETS;
+			for (uint32_t p = 0; p < NUM_PRESETS; ++p)
+			{
+				if (matchPresetName(value, FFX_CACAO_PRESET_NAMES[p]))
+				{
+					options->preset = p;
+				}
+			}
+			if (options->preset == NUM_PRESETS)
+			{
+				fprintf(stderr, "cacao-cli: unknown preset \"%s\", see --list-presets\n", value);
+				return false;
+			}
+			options->hasPreset = true;
+		}
+		else if (!strcmp(arg, "--jobs") && value)
+		{
+			options->numJobs = (uint32_t)strtoul(value, NULL, 10);
+		}
+		else if (!strcmp(arg, "--frames-in-flight") && value)
+		{
+			int n = atoi(value);
+			ok = n > 0;
+			options->framesInFlight = (uint32_t)n;
+		}
+		else if (!strcmp(arg, "--record-timings") && value)
+		{
+			options->recordTimingsPath = value;
+		}
+		else if (!strcmp(arg, "--replay-timings") && value)
+		{
+			options->replayTimingsPath = value;
+		}
+		else if (!strcmp(arg, "--budget") && value)
+		{
+			options->budget = strtof(value, NULL);
+			ok = options->budget > 0.0f;
+		}
+		else if (!strcmp(arg, "--ladder") && value)
+		{
+			options->ladder = value;
+		}
+		else if (!strcmp(arg, "--hold-frames") && value)
+		{
+			options->holdFrames = (uint32_t)strtoul(value, NULL, 10);
+		}
+		else if (!strcmp(arg, "--latency-frames") && value)
+		{
+			options->latencyFrames = (uint32_t)strtoul(value, NULL, 10);
+		}
+		else
+		{
+			consumesValue = false;
+			if (!strcmp(arg, "--linear-depth"))
+			{
+				options->linearDepth = true;
+			}
+			else if (!strcmp(arg, "--signed-normals"))
+			{
+				options->signedNormals = true;
+			}
+			else if (!strcmp(arg, "--reference"))
+			{
+				options->reference = true;
+			}
+			else if (!strcmp(arg, "--differential"))
+			{
+				options->differential = true;
+			}
+			else if (!strcmp(arg, "--verbose"))
+			{
+				options->verbose = true;
+			}
+			else if (!strcmp(arg, "--list-presets"))
+			{
+				for (uint32_t p = 0; p < NUM_PRESETS; ++p)
+				{
+					printf("%s\n", FFX_CACAO_PRESET_NAMES[p]);
+				}
+				exit(0);
+			}
+			else if (!strcmp(arg, "--help") || !strcmp(arg, "-h"))
+			{
+				printUsage();
+				exit(0);
+			}
+			else
+			{
+				fprintf(stderr, "cacao-cli: unknown or incomplete option %s\n", arg);
+				return false;
+			}
+		}
+
+		if (!ok)
+		{
+			fprintf(stderr, "cacao-cli: invalid value for %s: %s\n", arg, value);
+			return false;
+		}
+		i += consumesValue ? 1 : 0;
+	}
+
+	if (options->replayTimingsPath)
+	{
+		if (options->depthPattern || options->inputPath || options->outputPattern || options->recordTimingsPath)
+		{
+			fprintf(stderr, "cacao-cli: --replay-timings computes no AO, and takes no input or output\n");
+			return false;
+		}
+		if (!options->budget)
+		{
+			fprintf(stderr, "cacao-cli: --replay-timings requires --budget\n");
+			return false;
+		}
+		return true;
+	}
+	if (options->budget || options->ladder || options->holdFrames || options->latencyFrames)
+	{
+		fprintf(stderr, "cacao-cli: --budget, --ladder, --hold-frames and --latency-frames are options of --replay-timings\n");
+		return false;
+	}
+
+	std::string path;
+	const char *patterns[] = { options->depthPattern, options->normalsPattern, options->outputPattern, options->projPattern };
+	for (const char *pattern : patterns)
+	{
+		if (pattern && !framePath(pattern, 0, &path))
+		{
+			fprintf(stderr, "cacao-cli: invalid frame number in %s\n", pattern);
+			return false;
+		}
+	}
+	if ((!options->depthPattern == !options->inputPath) || !options->outputPattern)
+	{
+		fprintf(stderr, "cacao-cli: one of --depth and --input, and --output are required, see --help\n");
+		return false;
+	}
+	int numProjections = options->hasProj + options->hasPerspective + (options->projPattern != NULL);
+	if (options->inputPath && (numProjections || options->normalsPattern || options->linearDepth || options->signedNormals))
+	{
+		fprintf(stderr, "cacao-cli: a container holds the depth, normals and matrices of its frames\n");
+		return false;
+	}
+	if (options->depthPattern && numProjections != 1)
+	{
+		fprintf(stderr, "cacao-cli: exactly one of --proj, --proj-file and --perspective is required\n");
+		return false;
+	}
+	if ((options->inputPath || options->lastFrame > options->firstFrame) && !hasFrameNumber(options->outputPattern))
+	{
+		fprintf(stderr, "cacao-cli: the output pattern of a sequence needs a frame number\n");
+		return false;
+	}
+	if (options->reference && options->differential)
+	{
+		fprintf(stderr, "cacao-cli: --reference and --differential are exclusive\n");
+		return false;
+	}
+	if (options->recordTimingsPath && options->differential)
+	{
+		fprintf(stderr, "cacao-cli: --record-timings and --differential are exclusive\n");
+		return false;
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	Options options;
+	if (argc < 2)
+	{
+		printUsage();
+		return 1;
+	}
+	if (!parseOptions(argc, argv, &options))
+	{
+		return 1;
+	}
+	if (options.replayTimingsPath)
+	{
+		return replayTimings(&options) ? 0 : 1;
+	}
+
+	CacaoFrameFileReader input;
+	if (options.inputPath)
+	{
+		if (!input.OnCreate(options.inputPath))
+		{
+			fprintf(stderr, "cacao-cli: %s is not a frame container\n", options.inputPath);
+			return 1;
+		}
+		if (!options.hasFrames)
+		{
+			options.lastFrame = (int)input.GetNumFrames() - 1;
+		}
+		if (options.lastFrame < 0 || options.lastFrame >= (int)input.GetNumFrames())
+		{
+			fprintf(stderr, "cacao-cli: %s holds %u frames\n", options.inputPath, input.GetNumFrames());
+			input.OnDestroy();
+			return 1;
+		}
+	}
+
+	Compute compute;
+	if (!initCompute(&options, &compute))
+	{
+		fprintf(stderr, "cacao-cli: cannot create an FFX CACAO CPU context\n");
+		destroyCompute(&compute);
+		input.OnDestroy();
+		return 1;
+	}
+	if (options.recordTimingsPath)
+	{
+		compute.timingsFile = fopen(options.recordTimingsPath, "w");
+		if (!compute.timingsFile)
+		{
+			fprintf(stderr, "cacao-cli: cannot write %s\n", options.recordTimingsPath);
+			destroyCompute(&compute);
+			input.OnDestroy();
+			return 1;
+		}
+		// the timings of the CPU implementation are in nanoseconds
+		fprintf(compute.timingsFile, "millisecondsPerTick 1e-6\n");
+	}
+
+	Pipeline pipeline;
+	pipeline.options = &options;
+	pipeline.input = options.inputPath ? &input : NULL;
+	pipeline.failed = false;
+	pipeline.decodeSeconds = 0.0;
+	pipeline.computeSeconds = 0.0;
+	pipeline.encodeSeconds = 0.0;
+	pipeline.numFrames = 0;
+
+	std::vector<Frame> frames(options.framesInFlight);
+	for (Frame &frame : frames)
+	{
+		pipeline.freeFrames.push(&frame);
+	}
+
+	Clock::time_point start = Clock::now();
+	std::thread decoder(decodeThread, &pipeline);
+	std::thread encoder(encodeThread, &pipeline);
+
+	while (Frame *frame = pipeline.decodedFrames.pop())
+	{
+		Clock::time_point computeStart = Clock::now();
+		if (!computeFrame(&options, &compute, frame))
+		{
+			failPipeline(&pipeline);
+			break;
+		}
+		pipeline.computeSeconds += secondsSince(computeStart);
+		pipeline.computedFrames.push(frame);
+	}
+	pipeline.computedFrames.close();
+
+	decoder.join();
+	encoder.join();
+	double seconds = secondsSince(start);
+	destroyCompute(&compute);
+	input.OnDestroy();
+
+	if (compute.timingsFile && fclose(compute.timingsFile) != 0)
+	{
+		fprintf(stderr, "cacao-cli: cannot write %s\n", options.recordTimingsPath);
+		return 1;
+	}
+	if (pipeline.failed)
+	{
+		return 1;
+	}
+
+	uint32_t n = pipeline.numFrames;
+	const char *settingsName = options.inputPath && !options.hasPreset ? "settings of the container" : FFX_CACAO_PRESET_NAMES[options.preset];
+	printf("cacao-cli: %u frames of %ux%u (%s) in %.2f s, %.2f fps\n", n, compute.width, compute.height, settingsName, seconds, n / seconds);
+	printf("cacao-cli: per frame decode %.2f ms, compute %.2f ms, encode %.2f ms\n",
+		1000.0 * pipeline.decodeSeconds / n, 1000.0 * pipeline.computeSeconds / n, 1000.0 * pipeline.encodeSeconds / n);
+	return 0;
+}
@@ -0,0 +1,267 @@
+// AMD Sample sample code
+//
+// Copyright(c) 2021 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "CacaoFrameFile.h"
+
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static uint64_t alignFrameFileOffset(uint64_t offset)
+{
+	return (offset + CACAO_FRAME_FILE_ALIGNMENT - 1) & ~(uint64_t)(CACAO_FRAME_FILE_ALIGNMENT - 1);
+}
+
+static uint64_t depthPlaneSize(const CacaoFrameFileHeader *header)
+{
+	uint64_t texelSize = header->depthFormat == CACAO_FRAME_FILE_DEPTH_HALF ? 2 : 4;
+	return (uint64_t)header->width * header->height * texelSize;
+}
+
+static uint64_t normalsPlaneSize(const CacaoFrameFileHeader *header)
+{
+	return (uint64_t)header->width * header->height * 4 * sizeof(float);
+}
+
+// true if a plane of size bytes at offset fits in a frame of frameSize bytes, without overflowing
+static bool planeFits(uint64_t offset, uint64_t size, uint64_t frameSize)
+{
+	return offset <= frameSize && size <= frameSize - offset;
+}
+
+static bool writePadding(FILE *file, uint64_t size)
+{
+	static const uint8_t zeros[CACAO_FRAME_FILE_ALIGNMENT] = {};
+	uint64_t padding = alignFrameFileOffset(size) - size;
+	return fwrite(zeros, 1, (size_t)padding, file) == padding;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// CacaoFrameFileWriter
+//
+//--------------------------------------------------------------------------------------
+bool CacaoFrameFileWriter::OnCreate(const char *path, uint32_t width, uint32_t height, CacaoFrameFileDepthFormat depthFormat, bool hasNormals)
+{
+	if (!width || !height || width > CACAO_FRAME_FILE_MAX_SIZE || height > CACAO_FRAME_FILE_MAX_SIZE)
+	{
+		return false;
+	}
+
+	memset(&m_header, 0, sizeof(m_header));
+	memcpy(m_header.magic, CACAO_FRAME_FILE_MAGIC, sizeof(m_header.magic));
+	m_header.version = CACAO_FRAME_FILE_VERSION;
+	m_header.width = width;
+	m_header.height = height;
+	m_header.depthFormat = depthFormat;
+	m_header.hasNormals = hasNormals ? 1 : 0;
+	m_header.depthOffset = alignFrameFileOffset(sizeof(CacaoFrameHeader));
+	m_header.normalsOffset = hasNormals ? m_header.depthOffset + alignFrameFileOffset(depthPlaneSize(&m_header)) : 0;
+	m_header.frameSize = hasNormals
+		? m_header.normalsOffset + alignFrameFileOffset(normalsPlaneSize(&m_header))
+		: m_header.depthOffset + alignFrameFileOffset(depthPlaneSize(&m_header));
+	m_failed = false;
+
+	m_file = fopen(path, "wb");
+	if (!m_file)
+	{
+		return false;
+	}
+	if (fwrite(&m_header, sizeof(m_header), 1, m_file) != 1 || !writePadding(m_file, sizeof(m_header)))
+	{
+		fclose(m_file);
+		m_file = NULL;
+		return false;
+	}
+	return true;
+}
+
+void CacaoFrameFileWriter::OnDestroy()
+{
+	if (!m_file)
+	{
+		return;
+	}
+
+	// patch the number of frames written
+	if (!m_failed && fseek(m_file, 0, SEEK_SET) == 0)
+	{
+		fwrite(&m_header, sizeof(m_header), 1, m_file);
+	}
+	fclose(m_file);
+	m_file = NULL;
+}
+
+bool CacaoFrameFileWriter::WriteFrame(const CacaoFrameHeader *frame, const void *depth, const float *normals)
+{
+	if (!m_file || m_failed || (m_header.hasNormals && !normals))
+	{
+		return false;
+	}
+
+	bool ok = fwrite(frame, sizeof(*frame), 1, m_file) == 1 && writePadding(m_file, sizeof(*frame));
+	uint64_t size = depthPlaneSize(&m_header);
+	ok = ok && fwrite(depth, 1, (size_t)size, m_file) == size && writePadding(m_file, size);
+	if (m_header.hasNormals)
+	{
+		size = normalsPlaneSize(&m_header);
+		ok = ok && fwrite(normals, 1, (size_t)size, m_file) == size && writePadding(m_file, size);
+	}
+
+	if (!ok)
+	{
+		m_failed = true;
+		return false;
+	}
+	++m_header.numFrames;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// CacaoFrameFileReader
+//
+//--------------------------------------------------------------------------------------
+bool CacaoFrameFileReader::OnCreate(const char *path)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	LARGE_INTEGER size;
+	HANDLE mapping = GetFileSizeEx(file, &size) && size.QuadPart ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+	const void *data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+	if (!data)
+	{
+		if (mapping)
+		{
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return false;
+	}
+	m_file = file;
+	m_mapping = mapping;
+	m_data = (const uint8_t*)data;
+	m_size = (size_t)size.QuadPart;
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+	struct stat st;
+	void *data = fstat(file, &st) == 0 && st.st_size > 0 ? mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, file, 0) : MAP_FAILED;
+	close(file);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	madvise(data, (size_t)st.st_size, MADV_SEQUENTIAL);
+	m_data = (const uint8_t*)data;
+	m_size = (size_t)st.st_size;
+#endif
+
+	// the bounded width and height keep the plane sizes far from overflowing, the offsets and frame size are checked
+	// against each other and the file without adding them
+	const CacaoFrameFileHeader *header = GetHeader();
+	bool valid = m_size >= CACAO_FRAME_FILE_ALIGNMENT
+		&& !memcmp(header->magic, CACAO_FRAME_FILE_MAGIC, sizeof(header->magic))
+		&& header->version == CACAO_FRAME_FILE_VERSION
+		&& header->width && header->height
+		&& header->width <= CACAO_FRAME_FILE_MAX_SIZE && header->height <= CACAO_FRAME_FILE_MAX_SIZE
+		&& (header->depthFormat == CACAO_FRAME_FILE_DEPTH_FLOAT || header->depthFormat == CACAO_FRAME_FILE_DEPTH_HALF)
+		&& header->frameSize && header->frameSize <= m_size - CACAO_FRAME_FILE_ALIGNMENT
+		&& header->depthOffset >= sizeof(CacaoFrameHeader) && header->depthOffset % CACAO_FRAME_FILE_ALIGNMENT == 0
+		&& planeFits(header->depthOffset, depthPlaneSize(header), header->frameSize)
+		&& (!header->hasNormals || (header->normalsOffset % CACAO_FRAME_FILE_ALIGNMENT == 0
+			&& header->normalsOffset >= header->depthOffset
+			&& header->normalsOffset - header->depthOffset >= depthPlaneSize(header)
+			&& planeFits(header->normalsOffset, normalsPlaneSize(header), header->frameSize)));
+	if (!valid)
+	{
+		OnDestroy();
+		return false;
+	}
+
+	uint64_t numCompleteFrames = (m_size - CACAO_FRAME_FILE_ALIGNMENT) / header->frameSize;
+	m_numFrames = header->numFrames && header->numFrames <= numCompleteFrames ? header->numFrames : (uint32_t)numCompleteFrames;
+	return true;
+}
+
+void CacaoFrameFileReader::OnDestroy()
+{
+#ifdef _WIN32
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+		CloseHandle(m_mapping);
+		CloseHandle(m_file);
+	}
+	m_file = NULL;
+	m_mapping = NULL;
+#else
+	if (m_data)
+	{
+		munmap((void*)m_data, m_size);
+	}
+#endif
+	m_data = NULL;
+	m_size = 0;
+	m_numFrames = 0;
+}
+
+const CacaoFrameHeader *CacaoFrameFileReader::GetFrame(uint32_t index, const void **depth, const float **normals) const
+{
+	if (index >= m_numFrames)
+	{
+		return NULL;
+	}
+	const CacaoFrameFileHeader *header = GetHeader();
+	const uint8_t *frame = m_data + CACAO_FRAME_FILE_ALIGNMENT + index * header->frameSize;
+	*depth = frame + header->depthOffset;
+	*normals = header->hasNormals ? (const float*)(frame + header->normalsOffset) : NULL;
+	return (const CacaoFrameHeader*)frame;
+}
+
+void CacaoFrameFileReader::Prefetch(uint32_t index) const
+{
+	if (index >= m_numFrames)
+	{
+		return;
+	}
+	const CacaoFrameFileHeader *header = GetHeader();
+	const uint8_t *frame = m_data + CACAO_FRAME_FILE_ALIGNMENT + index * header->frameSize;
+#ifdef _WIN32
+	WIN32_MEMORY_RANGE_ENTRY range = { (void*)frame, (SIZE_T)header->frameSize };
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+	madvise((void*)frame, (size_t)header->frameSize, MADV_WILLNEED);
+#endif
+}
@@ -0,0 +1,119 @@
+// AMD Sample sample code
+//
+// Copyright(c) 2021 Advanced Micro Devices, Inc.All rights reserved.
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#pragma once
+
+#include "ffx_cacao.h"
+
+#include <stdio.h>
+#include <stddef.h>
+
+//
+// A packed container of the inputs of FFX CACAO for a sequence of frames, laid out so that a memory
+// mapping of it can be handed to the CPU implementation of FFX CACAO without parsing or copying:
+//
+//    CacaoFrameFileHeader, padded to CACAO_FRAME_FILE_ALIGNMENT
+//    numFrames frames of frameSize bytes each, made of
+//        CacaoFrameHeader, padded to CACAO_FRAME_FILE_ALIGNMENT
+//        the depth plane, width * height tightly packed floats or halfs, padded
+//        the optional normal plane, width * height * 4 tightly packed floats in [0, 1], padded
+//
+// All values are little endian. The writer patches numFrames when it is closed, and the reader
+// recovers the frames of a file whose writer did not get to close it from the size of the file.
+//
+
+#define CACAO_FRAME_FILE_MAGIC     "FFXCACAO"
+#define CACAO_FRAME_FILE_VERSION   1
+#define CACAO_FRAME_FILE_ALIGNMENT 4096
+#define CACAO_FRAME_FILE_MAX_SIZE  16384 // largest width and height, the limit of the importance map load counter of FFX CACAO
+
+enum CacaoFrameFileDepthFormat
+{
+	CACAO_FRAME_FILE_DEPTH_FLOAT = 0,
+	CACAO_FRAME_FILE_DEPTH_HALF  = 1,
+};
+
+struct CacaoFrameFileHeader
+{
+	char     magic[8];
+	uint32_t version;
+	uint32_t width;
+	uint32_t height;
+	uint32_t depthFormat;                 // CacaoFrameFileDepthFormat
+	uint32_t hasNormals;
+	uint32_t numFrames;
+	uint64_t frameSize;                   // bytes from one frame to the next
+	uint64_t depthOffset;                 // offset of the depth plane in a frame
+	uint64_t normalsOffset;               // offset of the normal plane in a frame, 0 without normals
+};
+
+struct CacaoFrameHeader
+{
+	FFX_CACAO_Matrix4x4 proj;
+	FFX_CACAO_Matrix4x4 normalsToView;
+	FFX_CACAO_Settings  settings;
+	uint32_t            useDownsampledSsao;
+};
+
+//
+// Appends frames to a container, sequentially with stdio.
+//
+class CacaoFrameFileWriter
+{
+public:
+	bool OnCreate(const char *path, uint32_t width, uint32_t height, CacaoFrameFileDepthFormat depthFormat, bool hasNormals);
+	void OnDestroy();
+
+	// depth is a plane in the depth format of the file, normals NULL if the file has none
+	bool WriteFrame(const CacaoFrameHeader *frame, const void *depth, const float *normals);
+
+	uint32_t GetNumFrames() const { return m_header.numFrames; }
+
+private:
+	FILE                *m_file = NULL;
+	CacaoFrameFileHeader m_header = {};
+	bool                 m_failed = false;
+};
+
+//
+// Maps a container into memory and returns pointers into the mapping.
+//
+class CacaoFrameFileReader
+{
+public:
+	bool OnCreate(const char *path);
+	void OnDestroy();
+
+	const CacaoFrameFileHeader *GetHeader() const { return (const CacaoFrameFileHeader*)m_data; }
+	uint32_t GetNumFrames() const { return m_numFrames; }
+
+	// depth points to a plane in the depth format of the file, normals is NULL if the file has none
+	const CacaoFrameHeader *GetFrame(uint32_t index, const void **depth, const float **normals) const;
+
+	// asks the OS to start reading a frame ahead of its use
+	void Prefetch(uint32_t index) const;
+
+private:
+	const uint8_t *m_data = NULL;
+	size_t         m_size = 0;
+	uint32_t       m_numFrames = 0;
+#ifdef _WIN32
+	void          *m_file = NULL;
+	void          *m_mapping = NULL;
+#endif
+};
@@ -184,6 +184,10 @@ void Sample::OnCreate(HWND hWnd)
 
 	m_state.cacaoSettings = FFX_CACAO_PRESETS[m_presetIndex].settings;
 	m_state.useDownsampledSsao = FFX_CACAO_PRESETS[m_presetIndex].useDownsampledSsao;
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	m_qualityController = (FFX_CACAO_QualityController*)malloc(FFX_CACAO_QualityControllerGetSize());
+#endif
 }
 
 //--------------------------------------------------------------------------------------
@@ -224,8 +228,69 @@ void Sample::OnDestroy()
 
 	m_device.DestroyPipelineCache();
 	m_device.OnDestroy();
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	free(m_qualityController);
+	m_qualityController = NULL;
+#endif
+}
+
+#ifdef FFX_CACAO_ENABLE_PROFILING
+static void OnQualityDecision(void *userData, const FFX_CACAO_QualityDecision *decision, const FFX_CACAO_QualityPreset *preset)
+{
+	Trace("FFX CACAO automatic quality: %s (%.2f ms) -> %s (predicted %.2f ms)\n",
+		FFX_CACAO_PRESET_NAMES[decision->previousPreset], decision->smoothedMilliseconds,
+		FFX_CACAO_PRESET_NAMES[decision->preset], decision->predictedMilliseconds);
+}
+
+//--------------------------------------------------------------------------------------
+//
+// InitQualityController, restarts the automatic quality from the current preset
+//
+//--------------------------------------------------------------------------------------
+void Sample::InitQualityController()
+{
+	// the presets, from the most to the least expensive, are the ladder of the controller
+	FFX_CACAO_QualityPreset presets[_countof(FFX_CACAO_PRESETS)];
+	for (uint32_t i = 0; i < _countof(FFX_CACAO_PRESETS); ++i)
+	{
+		presets[i].settings = FFX_CACAO_PRESETS[i].settings;
+		presets[i].useDownsampledSsao = FFX_CACAO_PRESETS[i].useDownsampledSsao ? FFX_CACAO_TRUE : FFX_CACAO_FALSE;
+	}
+
+	FFX_CACAO_QualityControllerCreateInfo info = {};
+	info.presets = presets;
+	info.numPresets = _countof(FFX_CACAO_PRESETS);
+	info.initialPreset = m_presetIndex < _countof(FFX_CACAO_PRESETS) ? m_presetIndex : 0;
+	info.budgetMilliseconds = m_qualityBudgetMilliseconds;
+	info.millisecondsPerTick = 1e-3f * m_microsecondsPerGpuTick;
+	// the timings read back are those of the oldest frame in flight
+	info.latencyFrames = backBufferCount - 1;
+	info.callback = OnQualityDecision;
+	FFX_CACAO_QualityControllerInit(m_qualityController, &info);
 }
 
+//--------------------------------------------------------------------------------------
+//
+// UpdateQualityController, feeds the timings of FFX CACAO to the controller and applies the preset it chooses
+//
+//--------------------------------------------------------------------------------------
+void Sample::UpdateQualityController()
+{
+	FFX_CACAO_DetailedTiming timings = {};
+	m_node->GetCacaoTimingValues(&m_state, &timings);
+
+	uint32_t preset;
+	FFX_CACAO_QualityControllerUpdate(m_qualityController, &timings, &preset);
+	if ((int)preset != m_presetIndex)
+	{
+		m_presetIndex = preset;
+		m_state.cacaoSettings = FFX_CACAO_PRESETS[preset].settings;
+		m_state.useDownsampledSsao = FFX_CACAO_PRESETS[preset].useDownsampledSsao;
+	}
+}
+#endif
+
 //--------------------------------------------------------------------------------------
 //
 // OnEvent, win32 sends us events and we forward them to ImGUI
@@ -430,6 +495,12 @@ void Sample::BuildUI()
 			Preset preset = FFX_CACAO_PRESETS[m_presetIndex];
 			m_state.cacaoSettings = preset.settings;
 			m_state.useDownsampledSsao = preset.useDownsampledSsao;
+#ifdef FFX_CACAO_ENABLE_PROFILING
+			if (m_automaticQuality)
+			{
+				InitQualityController();
+			}
+#endif
 		}
 
 		FFX_CACAO_Settings *settings = &m_state.cacaoSettings;
@@ -461,6 +532,15 @@ void Sample::BuildUI()
 			ImGui::SliderFloat("Bilateral Similarity Distance Sigma", &settings->bilateralSimilarityDistanceSigma, 0.1f, 1.0f);
 		}
 
+		FFX_CACAO_VkMemoryUsage memoryUsage = {};
+		m_node->GetCacaoMemoryUsage(&m_state, &memoryUsage);
+		ImGui::Text("FFX CACAO Texture Memory: %.1f MB (%.1f MB without aliasing)", (float)memoryUsage.arenaSize / (1024.0f * 1024.0f), (float)memoryUsage.unaliasedSize / (1024.0f * 1024.0f));
+
+		double creationTime;
+		bool warmPipelineCache;
+		m_node->GetCacaoContextCreationTime(&creationTime, &warmPipelineCache);
+		ImGui::Text("FFX CACAO Context Creation: %.1f ms (%s pipeline cache)", creationTime, warmPipelineCache ? "warm" : "cold");
+
 		ImGui::Checkbox("Display FFX CACAO Output Directly", &m_state.dispalyCacaoDirectly);
 		if (!m_state.dispalyCacaoDirectly)
 		{
@@ -468,6 +548,22 @@ void Sample::BuildUI()
 		}
 		m_state.useCacao |= m_state.dispalyCacaoDirectly;
 
+		// capture the inputs of FFX CACAO for replay with cacao-cli
+		if (m_node->IsCapturing())
+		{
+			ImGui::Text("Capturing FFX CACAO Inputs...");
+		}
+		else
+		{
+			ImGui::SliderInt("Frames To Capture", &m_captureFrameCount, 1, 1000);
+			if (ImGui::Button("Capture FFX CACAO Inputs"))
+			{
+				char captureFilename[1024];
+				snprintf(captureFilename, _countof(captureFilename), "FFX_CACAO_Capture_%ux%u.cacao", m_Width, m_Height);
+				m_node->StartCapture(captureFilename, (uint32_t)m_captureFrameCount);
+			}
+		}
+
 		if (m_presetIndex < _countof(FFX_CACAO_PRESETS) && (memcmp(&FFX_CACAO_PRESETS[m_presetIndex].settings, &m_state.cacaoSettings, sizeof(m_state.cacaoSettings)) || (FFX_CACAO_PRESETS[m_presetIndex].useDownsampledSsao != m_state.useDownsampledSsao)))
 		{
 			m_presetIndex = _countof(FFX_CACAO_PRESETS);
@@ -488,11 +584,22 @@ void Sample::BuildUI()
 
 				ImGui::Text("%-32s: %7.1f", name, m_microsecondsPerGpuTick * (float)ticks);
 			}
+
+			// the automatic quality chooses the preset, keeping FFX CACAO within the budget
+			if (ImGui::Checkbox("Automatic Quality", &m_automaticQuality) && m_automaticQuality)
+			{
+				InitQualityController();
+			}
+			if (m_automaticQuality && ImGui::SliderFloat("Budget (ms)", &m_qualityBudgetMilliseconds, 0.1f, 5.0f))
+			{
+				FFX_CACAO_QualityControllerSetBudget(m_qualityController, m_qualityBudgetMilliseconds);
+			}
 		}
 	}
 	else
 	{
 		ImGui::CollapsingHeader("Profiler Disabled (enable CACAO and turn off vsync and validation)");
+		m_automaticQuality = false;
 	}
 #endif
 
@@ -624,6 +731,13 @@ void Sample::OnRender()
 		// Build the UI. Note that the rendering of the UI happens later.
 		BuildUI();
 
+#ifdef FFX_CACAO_ENABLE_PROFILING
+		if (m_automaticQuality)
+		{
+			UpdateQualityController();
+		}
+#endif
+
 		if (m_bPlay)
 		{
 			m_time += (float)deltaTime / 1000.0f;
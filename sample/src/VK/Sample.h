@@ -50,6 +50,11 @@ public:
 	void SetFullScreen(bool fullscreen);
 
 private:
+#ifdef FFX_CACAO_ENABLE_PROFILING
+	void InitQualityController();
+	void UpdateQualityController();
+#endif
+
 	Device m_device;
 	SwapChain                 m_swapChain;
 
@@ -85,6 +90,7 @@ private:
 	bool                      m_bPlay;
 	bool                      m_requiresLoad = true;
 	int                       m_presetIndex = 3;
+	int                       m_captureFrameCount = 100;
 
 #ifdef FFX_CACAO_ENABLE_PROFILING
 	char                      m_benchmarkFilename[1024];
@@ -92,5 +98,9 @@ private:
 	uint32_t                  m_benchmarkScreenWidth;
 	uint32_t                  m_benchmarkScreenHeight;
 	uint32_t                  m_benchmarkWarmUpFramesToRun;
+
+	FFX_CACAO_QualityController *m_qualityController = NULL;
+	bool                      m_automaticQuality = false;
+	float                     m_qualityBudgetMilliseconds = 1.0f;
 #endif
 };
@@ -21,6 +21,9 @@
 
 #include "SampleRenderer.h"
 
+// pipeline cache of FFX CACAO, saved on exit and loaded on startup
+#define CACAO_PIPELINE_CACHE_FILE "FFX_CACAO_PipelineCache.bin"
+
 //--------------------------------------------------------------------------------------
 //
 // OnCreate
@@ -138,14 +141,39 @@ void SampleRenderer::OnCreate(Device *pDevice, SwapChain *pSwapChain)
 	info.physicalDevice = pDevice->GetPhysicalDevice();
 	info.device = pDevice->GetDevice();
 	info.flags = FFX_CACAO_VK_CREATE_USE_DEBUG_MARKERS | FFX_CACAO_VK_CREATE_NAME_OBJECTS;
+	info.numFramesInFlight = backBufferCount;
 	if (pDevice->IsFp16Supported())
 	{
 		info.flags |= FFX_CACAO_VK_CREATE_USE_16_BIT;
 	}
+	// the pipeline cache saved on exit by the previous run skips shader compilation, unless the driver has changed since
+	{
+		std::vector<char> cacheData;
+		std::ifstream f(CACAO_PIPELINE_CACHE_FILE, std::ios::binary);
+		if (f)
+		{
+			cacheData.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+		}
+		FFX_CACAO_Bool warm = FFX_CACAO_FALSE;
+		FFX_CACAO_VkCreatePipelineCache(info.physicalDevice, info.device, cacheData.data(), cacheData.size(), &m_cacaoPipelineCache, &warm);
+		m_cacaoPipelineCacheWarm = warm ? true : false;
+		info.pipelineCache = m_cacaoPipelineCache;
+	}
+	double cacaoCreationStart = MillisecondsNow();
+
+	// both contexts share one set of shaders and pipelines, which lives until the last of them is destroyed
+	FFX_CACAO_VkDeviceObjects *cacaoDeviceObjects;
+	FFX_CACAO_VkCreateDeviceObjects(&info, &cacaoDeviceObjects);
+	info.deviceObjects = cacaoDeviceObjects;
 	m_cacaoContextNative = (FFX_CACAO_VkContext*)malloc(cacaoContextSize);
 	FFX_CACAO_VkInitContext(m_cacaoContextNative, &info);
 	m_cacaoContextDownsampled = (FFX_CACAO_VkContext*)malloc(cacaoContextSize);
 	FFX_CACAO_VkInitContext(m_cacaoContextDownsampled, &info);
+	FFX_CACAO_VkReleaseDeviceObjects(cacaoDeviceObjects);
+	m_cacaoContextCreationTime = MillisecondsNow() - cacaoCreationStart;
+
+	m_capturing = false;
+	m_captureFramesRemaining = 0;
 
 	// create direct output PS descriptor set layout
 	{
@@ -206,6 +234,8 @@ void SampleRenderer::OnCreate(Device *pDevice, SwapChain *pSwapChain)
 //--------------------------------------------------------------------------------------
 void SampleRenderer::OnDestroy()
 {
+	EndCapture();
+
 	m_cacaoApplyDirectPS.OnDestroy();
 	vkDestroySampler(m_pDevice->GetDevice(), m_cacaoApplyDirectSampler, NULL);
 
@@ -214,6 +244,22 @@ void SampleRenderer::OnDestroy()
 	FFX_CACAO_VkDestroyContext(m_cacaoContextNative);
 	free(m_cacaoContextNative);
 
+	{
+		VkPhysicalDevice physicalDevice = m_pDevice->GetPhysicalDevice();
+		VkDevice device = m_pDevice->GetDevice();
+		size_t size = 0;
+		if (FFX_CACAO_VkGetPipelineCacheData(physicalDevice, device, m_cacaoPipelineCache, NULL, &size) == FFX_CACAO_STATUS_OK)
+		{
+			std::vector<char> cacheData(size);
+			if (FFX_CACAO_VkGetPipelineCacheData(physicalDevice, device, m_cacaoPipelineCache, cacheData.data(), &size) == FFX_CACAO_STATUS_OK)
+			{
+				std::ofstream f(CACAO_PIPELINE_CACHE_FILE, std::ios::binary);
+				f.write(cacheData.data(), size);
+			}
+		}
+		vkDestroyPipelineCache(device, m_cacaoPipelineCache, NULL);
+	}
+
 	m_imGUI.OnDestroy();
 	m_colorConversionPS.OnDestroy();
 	m_toneMappingPS.OnDestroy();
@@ -350,10 +396,31 @@ void SampleRenderer::OnCreateWindowSizeDependentResources(SwapChain *pSwapChain,
 	// ==========================================================
 	// CACAO
 
-	m_normalBufferNonMsaa.InitRenderTarget(m_pDevice, m_width, m_height, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_SAMPLE_COUNT_1_BIT, (VkImageUsageFlags)(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT), false, "NormalBufferNonMsaa");
+	// the depth and normal buffers are transfer sources for captures of the inputs of CACAO
+	m_normalBufferNonMsaa.InitRenderTarget(m_pDevice, m_width, m_height, VK_FORMAT_A2B10G10R10_UNORM_PACK32, VK_SAMPLE_COUNT_1_BIT, (VkImageUsageFlags)(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT), false, "NormalBufferNonMsaa");
 	m_normalBufferNonMsaa.CreateRTV(&m_normalBufferNonMsaaView);
 
-	m_depthBufferNonMsaa.InitDepthStencil(m_pDevice, Width, Height, VK_FORMAT_D32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, "DepthBufferNonMsaa");
+	{
+		VkImageCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		info.pNext = NULL;
+		info.flags = 0;
+		info.imageType = VK_IMAGE_TYPE_2D;
+		info.format = VK_FORMAT_D32_SFLOAT;
+		info.extent.width = Width;
+		info.extent.height = Height;
+		info.extent.depth = 1;
+		info.mipLevels = 1;
+		info.arrayLayers = 1;
+		info.samples = VK_SAMPLE_COUNT_1_BIT;
+		info.tiling = VK_IMAGE_TILING_OPTIMAL;
+		info.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+		info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		info.queueFamilyIndexCount = 0;
+		info.pQueueFamilyIndices = NULL;
+		info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		m_depthBufferNonMsaa.Init(m_pDevice, &info, "DepthBufferNonMsaa");
+	}
 	m_depthBufferNonMsaa.CreateSRV(&m_depthBufferNonMsaaView);
 
 	// Create framebuffer for the MSAA RT
@@ -427,6 +494,9 @@ void SampleRenderer::OnCreateWindowSizeDependentResources(SwapChain *pSwapChain,
 //--------------------------------------------------------------------------------------
 void SampleRenderer::OnDestroyWindowSizeDependentResources()
 {
+	// a capture holds frames of a single size
+	EndCapture();
+
 	FFX_CACAO_VkDestroyScreenSizeDependentResources(m_cacaoContextNative);
 	FFX_CACAO_VkDestroyScreenSizeDependentResources(m_cacaoContextDownsampled);
 
@@ -815,6 +885,8 @@ void SampleRenderer::OnRender(State *pState, SwapChain *pSwapChain)
 	}
 
 	// call CACAO
+	CacaoFrameHeader cacaoFrame = {};
+	bool cacaoDrawn = false;
 	if (pState->useCacao && m_gltfPbrNonMsaa && pPerFrame) {
 		FFX_CACAO_Matrix4x4 proj, normalsWorldToView;
 		{
@@ -847,6 +919,12 @@ void SampleRenderer::OnRender(State *pState, SwapChain *pSwapChain)
 			status = FFX_CACAO_VkDraw(m_cacaoContextNative, cmdBuf1, &proj, &normalsWorldToView);
 		}
 		assert(status == FFX_CACAO_STATUS_OK);
+
+		cacaoFrame.proj = proj;
+		cacaoFrame.normalsToView = normalsWorldToView;
+		cacaoFrame.settings = pState->cacaoSettings;
+		cacaoFrame.useDownsampledSsao = pState->useDownsampledSsao ? 1 : 0;
+		cacaoDrawn = status == FFX_CACAO_STATUS_OK;
 	}
 	else
 	{
@@ -1224,6 +1302,27 @@ void SampleRenderer::OnRender(State *pState, SwapChain *pSwapChain)
 		assert(res == VK_SUCCESS);
 	}
 
+	// Capture the inputs of CACAO --------------------------------------------------------
+	//
+	if (m_capturing)
+	{
+		// the frame which last used the capture buffer of this back buffer has completed
+		if (m_capturePending[m_curBackBuffer])
+		{
+			WriteCapturedFrame(m_curBackBuffer);
+		}
+
+		if (m_captureFramesRemaining && cacaoDrawn)
+		{
+			CaptureFrame(cmdBuf2, &cacaoFrame);
+			--m_captureFramesRemaining;
+		}
+		else if (!m_captureFramesRemaining)
+		{
+			EndCapture();
+		}
+	}
+
 	SetPerfMarkerBegin(cmdBuf2, "rendering to swap chain");
 
 	// prepare render pass
@@ -1332,6 +1431,236 @@ void SampleRenderer::OnRender(State *pState, SwapChain *pSwapChain)
 	}
 }
 
+//--------------------------------------------------------------------------------------
+//
+// StartCapture
+//
+//--------------------------------------------------------------------------------------
+static uint32_t findMemoryType(const VkPhysicalDeviceMemoryProperties *pProperties, uint32_t typeBits, VkMemoryPropertyFlags flags)
+{
+	for (uint32_t i = 0; i < pProperties->memoryTypeCount; ++i)
+	{
+		if ((typeBits & (1u << i)) && (pProperties->memoryTypes[i].propertyFlags & flags) == flags)
+		{
+			return i;
+		}
+	}
+	return UINT32_MAX;
+}
+
+bool SampleRenderer::StartCapture(const char *filename, uint32_t numFrames)
+{
+	EndCapture();
+
+	if (!m_captureFile.OnCreate(filename, m_width, m_height, CACAO_FRAME_FILE_DEPTH_FLOAT, true))
+	{
+		Trace("Cannot create capture file\n");
+		return false;
+	}
+
+	VkDevice device = m_pDevice->GetDevice();
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(m_pDevice->GetPhysicalDevice(), &memoryProperties);
+
+	for (uint32_t i = 0; i < backBufferCount; ++i)
+	{
+		// the depth buffer followed by the packed normal buffer
+		VkBufferCreateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		info.size = 2 * (VkDeviceSize)m_width * m_height * sizeof(uint32_t);
+		info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		VkResult res = vkCreateBuffer(device, &info, NULL, &m_captureBuffers[i]);
+		assert(res == VK_SUCCESS);
+
+		VkMemoryRequirements memoryRequirements;
+		vkGetBufferMemoryRequirements(device, m_captureBuffers[i], &memoryRequirements);
+
+		// cached memory is much faster to read on the CPU, where available
+		VkMemoryAllocateInfo allocInfo = {};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = memoryRequirements.size;
+		allocInfo.memoryTypeIndex = findMemoryType(&memoryProperties, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+		if (allocInfo.memoryTypeIndex == UINT32_MAX)
+		{
+			allocInfo.memoryTypeIndex = findMemoryType(&memoryProperties, memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		}
+		res = vkAllocateMemory(device, &allocInfo, NULL, &m_captureMemory[i]);
+		assert(res == VK_SUCCESS);
+		res = vkBindBufferMemory(device, m_captureBuffers[i], m_captureMemory[i], 0);
+		assert(res == VK_SUCCESS);
+		res = vkMapMemory(device, m_captureMemory[i], 0, VK_WHOLE_SIZE, 0, (void**)&m_captureData[i]);
+		assert(res == VK_SUCCESS);
+
+		m_capturePending[i] = false;
+	}
+
+	m_captureNormals.resize(4 * (size_t)m_width * m_height);
+	m_captureFramesRemaining = numFrames;
+	m_capturing = true;
+	return true;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// EndCapture
+//
+//--------------------------------------------------------------------------------------
+void SampleRenderer::EndCapture()
+{
+	if (!m_capturing)
+	{
+		return;
+	}
+
+	bool pending = false;
+	for (uint32_t i = 0; i < backBufferCount; ++i)
+	{
+		pending |= m_capturePending[i];
+	}
+	if (pending)
+	{
+		m_pDevice->GPUFlush();
+	}
+
+	// write the frames still in flight from the oldest
+	VkDevice device = m_pDevice->GetDevice();
+	for (uint32_t i = 1; i <= backBufferCount; ++i)
+	{
+		uint32_t slot = (m_curBackBuffer + i) % backBufferCount;
+		if (m_capturePending[slot])
+		{
+			WriteCapturedFrame(slot);
+		}
+	}
+	for (uint32_t i = 0; i < backBufferCount; ++i)
+	{
+		vkUnmapMemory(device, m_captureMemory[i]);
+		vkDestroyBuffer(device, m_captureBuffers[i], NULL);
+		vkFreeMemory(device, m_captureMemory[i], NULL);
+	}
+
+	m_captureFile.OnDestroy();
+	m_captureNormals.clear();
+	m_captureFramesRemaining = 0;
+	m_capturing = false;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// CaptureFrame
+//
+//--------------------------------------------------------------------------------------
+void SampleRenderer::CaptureFrame(VkCommandBuffer cmdBuf, const CacaoFrameHeader *pFrame)
+{
+	uint32_t slot = m_curBackBuffer;
+
+	VkImageMemoryBarrier barriers[2] = {};
+	for (uint32_t i = 0; i < _countof(barriers); ++i)
+	{
+		barriers[i].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barriers[i].pNext = NULL;
+		barriers[i].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		barriers[i].dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barriers[i].oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barriers[i].newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[i].subresourceRange.baseMipLevel = 0;
+		barriers[i].subresourceRange.levelCount = 1;
+		barriers[i].subresourceRange.baseArrayLayer = 0;
+		barriers[i].subresourceRange.layerCount = 1;
+	}
+	barriers[0].image = m_depthBufferNonMsaa.Resource();
+	barriers[0].subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+	barriers[1].image = m_normalBufferNonMsaa.Resource();
+	barriers[1].subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+
+	VkPipelineStageFlags srcStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	vkCmdPipelineBarrier(cmdBuf, srcStages, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, _countof(barriers), barriers);
+
+	VkBufferImageCopy region = {};
+	region.bufferOffset = 0;
+	region.bufferRowLength = 0;
+	region.bufferImageHeight = 0;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+	region.imageSubresource.mipLevel = 0;
+	region.imageSubresource.baseArrayLayer = 0;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent.width = m_width;
+	region.imageExtent.height = m_height;
+	region.imageExtent.depth = 1;
+	vkCmdCopyImageToBuffer(cmdBuf, m_depthBufferNonMsaa.Resource(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_captureBuffers[slot], 1, &region);
+
+	region.bufferOffset = (VkDeviceSize)m_width * m_height * sizeof(float);
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	vkCmdCopyImageToBuffer(cmdBuf, m_normalBufferNonMsaa.Resource(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_captureBuffers[slot], 1, &region);
+
+	for (uint32_t i = 0; i < _countof(barriers); ++i)
+	{
+		barriers[i].srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barriers[i].oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barriers[i].newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	}
+	vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, _countof(barriers), barriers);
+
+	VkBufferMemoryBarrier bufferBarrier = {};
+	bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	bufferBarrier.pNext = NULL;
+	bufferBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	bufferBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	bufferBarrier.buffer = m_captureBuffers[slot];
+	bufferBarrier.offset = 0;
+	bufferBarrier.size = VK_WHOLE_SIZE;
+	vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &bufferBarrier, 0, NULL);
+
+	m_captureFrames[slot] = *pFrame;
+	m_capturePending[slot] = true;
+}
+
+//--------------------------------------------------------------------------------------
+//
+// WriteCapturedFrame
+//
+//--------------------------------------------------------------------------------------
+void SampleRenderer::WriteCapturedFrame(uint32_t slot)
+{
+	size_t numPixels = (size_t)m_width * m_height;
+	const float *depth = (const float*)m_captureData[slot];
+	const uint32_t *packedNormals = (const uint32_t*)(m_captureData[slot] + numPixels * sizeof(float));
+
+	// unpack A2B10G10R10 to the four floats per pixel the CPU implementation reads
+	for (size_t i = 0; i < numPixels; ++i)
+	{
+		uint32_t packed = packedNormals[i];
+		m_captureNormals[4 * i + 0] = (float)(packed & 0x3ff) / 1023.0f;
+		m_captureNormals[4 * i + 1] = (float)((packed >> 10) & 0x3ff) / 1023.0f;
+		m_captureNormals[4 * i + 2] = (float)((packed >> 20) & 0x3ff) / 1023.0f;
+		m_captureNormals[4 * i + 3] = (float)(packed >> 30) / 3.0f;
+	}
+
+	if (!m_captureFile.WriteFrame(&m_captureFrames[slot], depth, m_captureNormals.data()))
+	{
+		Trace("Cannot write captured frame\n");
+	}
+	m_capturePending[slot] = false;
+}
+
+void SampleRenderer::GetCacaoMemoryUsage(State* pState, FFX_CACAO_VkMemoryUsage* usage)
+{
+	if (pState->useDownsampledSsao)
+	{
+		FFX_CACAO_VkGetMemoryUsage(m_cacaoContextDownsampled, usage);
+	}
+	else
+	{
+		FFX_CACAO_VkGetMemoryUsage(m_cacaoContextNative, usage);
+	}
+}
+
 #ifdef FFX_CACAO_ENABLE_PROFILING
 void SampleRenderer::GetCacaoTimingValues(State* pState, FFX_CACAO_DetailedTiming* timings)
 {
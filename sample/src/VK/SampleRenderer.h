@@ -19,6 +19,7 @@
 #pragma once
 
 #include "ffx_cacao_impl.h"
+#include "CacaoFrameFile.h"
 
 // We are queuing (backBufferCount + 0.5) frames, so we need to triple buffer the resources that get modified each frame
 static const int backBufferCount = 3;
@@ -77,15 +78,28 @@ public:
 #ifdef FFX_CACAO_ENABLE_PROFILING
 	void GetCacaoTimingValues(State* pState, FFX_CACAO_DetailedTiming* timings);
 #endif
+	void GetCacaoMemoryUsage(State* pState, FFX_CACAO_VkMemoryUsage* usage);
+	void GetCacaoContextCreationTime(double* milliseconds, bool* warmPipelineCache) { *milliseconds = m_cacaoContextCreationTime; *warmPipelineCache = m_cacaoPipelineCacheWarm; }
 	const std::vector<TimeStamp> &GetTimingValues() { return m_timeStamps; }
 
 	void OnRender(State *pState, SwapChain *pSwapChain);
 
+	// captures the inputs of FFX CACAO of the next numFrames frames it runs on into a frame container
+	bool StartCapture(const char *filename, uint32_t numFrames);
+	void EndCapture();
+	bool IsCapturing() const { return m_capturing; }
+
 private:
+	void CaptureFrame(VkCommandBuffer cmdBuf, const CacaoFrameHeader *pFrame);
+	void WriteCapturedFrame(uint32_t slot);
+
 	Device *m_pDevice;
 
 	FFX_CACAO_VkContext            *m_cacaoContextNative;
 	FFX_CACAO_VkContext            *m_cacaoContextDownsampled;
+	VkPipelineCache                 m_cacaoPipelineCache;
+	double                          m_cacaoContextCreationTime;
+	bool                            m_cacaoPipelineCacheWarm;
 
 	uint32_t                        m_width;
 	uint32_t                        m_height;
@@ -176,5 +190,16 @@ private:
 	VkFramebuffer                   m_pFrameBufferNonMSAA;
 
 	std::vector<TimeStamp>          m_timeStamps;
+
+	// capture of the inputs of FFX CACAO, read back through a host visible buffer per back buffer
+	bool                            m_capturing;
+	uint32_t                        m_captureFramesRemaining;
+	CacaoFrameFileWriter            m_captureFile;
+	VkBuffer                        m_captureBuffers[backBufferCount];
+	VkDeviceMemory                  m_captureMemory[backBufferCount];
+	uint8_t                        *m_captureData[backBufferCount];
+	bool                            m_capturePending[backBufferCount];
+	CacaoFrameHeader                m_captureFrames[backBufferCount];
+	std::vector<float>              m_captureNormals;
 };
 